@@ -2,6 +2,7 @@
 #define QINDB_AST_H
 
 #include "common.h"
+#include <QHash>
 #include <QList>
 #include <memory>
 #include <vector>
@@ -125,6 +126,15 @@ public:
     std::unique_ptr<class SelectStatement> subquery;
 };
 
+// 值列表表达式（IN (a, b, c) 的右侧）
+class ListExpression : public Expression {
+public:
+    explicit ListExpression(std::vector<std::unique_ptr<Expression>> items)
+        : elements(std::move(items)) {}
+    QString toString() const override;
+    std::vector<std::unique_ptr<Expression>> elements;
+};
+
 // 全文搜索模式
 enum class MatchMode {
     NATURAL_LANGUAGE,  // 自然语言模式（默认）
@@ -160,7 +170,11 @@ struct ColumnDefinition {
 enum class IndexType {
     BTREE,
     HASH,
-    FULLTEXT
+    FULLTEXT,
+    BRIN,
+    BITMAP,
+    RTREE,
+    TRIE
 };
 
 // 索引定义
@@ -318,6 +332,10 @@ public:
     QString tableName;
     IndexType type = IndexType::BTREE;
     QStringList columns;
+    std::vector<std::unique_ptr<Expression>> expressions;  // 与 columns 对应的键表达式（普通列为 nullptr）
+    QStringList includeColumns;   // INCLUDE (...) 中的非键列（覆盖索引）
+    std::unique_ptr<Expression> where;  // WHERE 谓词（部分索引）
+    QHash<QString, QString> options;    // WITH (name = value, ...) 索引选项，名称小写
     bool unique = false;
     bool ifNotExists = false;
 };
@@ -420,12 +438,19 @@ public:
     QString tableName;  // 表名（如果为空则收集所有表的统计信息）
 };
 
+// CALIBRATE 语句（在本机上测量优化器的成本参数并写入配置文件）
+class CalibrateStatement : public ASTNode {
+public:
+    QString toString() const override;
+};
+
 // EXPLAIN 语句（显示执行计划）
 class ExplainStatement : public ASTNode {
 public:
     QString toString() const override;
 
     std::unique_ptr<SelectStatement> query;  // 要解释的查询
+    bool analyze = false;                    // EXPLAIN ANALYZE：实际执行查询，报告每个节点的实际行数和耗时
 };
 
 // CREATE USER 语句
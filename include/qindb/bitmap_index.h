@@ -0,0 +1,120 @@
+#ifndef QINDB_BITMAP_INDEX_H
+#define QINDB_BITMAP_INDEX_H
+
+#include "qindb/buffer_pool_manager.h"
+#include "qindb/common.h"
+#include "qindb/roaring_bitmap.h"
+#include <QByteArray>
+#include <QMap>
+#include <QVariant>
+#include <QVector>
+
+namespace qindb {
+
+/**
+ * @brief 位图索引：索引列的每个不同值对应一个压缩位图（Roaring），保存取该值的行ID
+ *
+ * 适合取值很少的列（状态、地区、类型等）。多个条件的组合
+ * （status = 1 AND region IN (3, 5)）先在位图上做 OR/AND 得到候选行，再回表。
+ *
+ * 存储（页类型均为 BITMAP_INDEX_PAGE）：
+ * - 元数据页：magic、版本、键类型、不同值个数、目录字节流首页
+ * - 目录字节流：按 KeyEncoder 编码升序，每项为 编码、行数、位图字节流首页、位图字节数
+ * - 每个值的位图单独一条字节流（RoaringBitmap::serialize 的结果）
+ *
+ * 修改先作用在内存中的位图上，flush() 时只重写变化过的位图和目录，
+ * 再释放旧位图占用的页。NULL 不进索引。
+ */
+class BitmapIndex {
+public:
+    /**
+     * @brief 构造函数
+     * @param bufferPool 缓冲池管理器
+     * @param keyType 索引列类型
+     * @param metaPageId 元数据页ID（新索引为 INVALID_PAGE_ID，随后调用 create）
+     */
+    BitmapIndex(BufferPoolManager* bufferPool, DataType keyType, PageId metaPageId = INVALID_PAGE_ID);
+
+    /**
+     * @brief 分配元数据页，创建空索引
+     */
+    bool create();
+
+    /**
+     * @brief 从元数据页加载目录（位图在第一次用到时才读入）
+     */
+    bool load();
+
+    /**
+     * @brief 把 rowId 加入 key 的位图（key 为 NULL 时不做任何事）
+     */
+    bool insert(const QVariant& key, RowId rowId);
+
+    /**
+     * @brief 把 rowId 从 key 的位图中删除（key 为 NULL 或不存在时不做任何事）
+     */
+    bool remove(const QVariant& key, RowId rowId);
+
+    /**
+     * @brief 取 key 的位图（没有行取该值时为空位图）
+     * @return key 无法按键类型编码或读取失败时返回 false
+     */
+    bool lookup(const QVariant& key, RoaringBitmap& result);
+
+    /**
+     * @brief 取多个值的位图之并（col IN (...)）
+     */
+    bool lookupAny(const QVector<QVariant>& keys, RoaringBitmap& result);
+
+    /**
+     * @brief 把修改过的位图和目录写回页面
+     */
+    bool flush();
+
+    /**
+     * @brief 释放索引占用的全部页（含元数据页）
+     */
+    void destroy();
+
+    PageId getMetaPageId() const { return metaPageId_; }
+    DataType getKeyType() const { return keyType_; }
+
+    /**
+     * @brief 不同值的个数
+     */
+    int distinctCount() const { return entries_.size(); }
+
+    /**
+     * @brief 索引中的行ID总数
+     */
+    uint64_t totalCardinality() const;
+
+private:
+    /**
+     * @brief 一个值的目录项
+     */
+    struct Entry {
+        uint64_t cardinality = 0;           // 行数
+        PageId firstPageId = INVALID_PAGE_ID;  // 已持久化的位图字节流首页
+        uint32_t byteSize = 0;              // 已持久化的位图字节数
+        bool loaded = false;                // bitmap 是否已读入
+        bool dirty = false;                 // bitmap 是否有未写回的修改
+        RoaringBitmap bitmap;
+    };
+
+    bool encodeKey(const QVariant& key, QByteArray& encoded) const;
+    bool ensureLoaded(Entry& entry);
+    bool writeMeta();
+
+    BufferPoolManager* bufferPool_;
+    DataType keyType_;
+    PageId metaPageId_;
+    PageId directoryPageId_ = INVALID_PAGE_ID;
+    bool dirty_ = false;                    // 有未写回的修改
+
+    QMap<QByteArray, Entry> entries_;       // KeyEncoder 编码 -> 目录项（memcmp 有序）
+};
+
+} // namespace qindb
+
+#endif // QINDB_BITMAP_INDEX_H
@@ -0,0 +1,181 @@
+#ifndef QINDB_BLOCK_RANGE_INDEX_H
+#define QINDB_BLOCK_RANGE_INDEX_H
+
+#include "qindb/buffer_pool_manager.h"
+#include "qindb/common.h"
+#include <QByteArray>
+#include <QHash>
+#include <QVariant>
+#include <QVector>
+
+namespace qindb {
+
+/**
+ * @brief 块范围索引（BRIN / zone map）：每个数据页一条摘要
+ *
+ * 摘要记录该页索引列的最小值、最大值、行数、NULL 行数，可选一个小布隆过滤器。
+ * 顺序扫描前先用摘要排除不可能包含匹配行的页，适合插入顺序与列值相关的大表
+ * （时间戳、自增 ID、日志流水等）。每个数据页只占一条定长摘要，索引大小约为表的 1%，
+ * 远小于 B+ 树。
+ *
+ * 存储：
+ * - 元数据页（根页）：magic、版本、键类型、是否带布隆过滤器、摘要数、首/尾摘要页
+ * - 摘要页按 nextPageId 链接，slotCount 为本页摘要数；只有最后一页未满
+ * - 摘要顺序就是数据页在表链表中的顺序（新页总是挂在链表末尾），候选页按该顺序返回
+ *
+ * 最小/最大值保存 KeyEncoder 编码（memcmp 有序）。编码超过 MAX_BOUND_SIZE 字节时截断：
+ * 最小值取前缀（仍是下界），最大值取前缀后把末字节进位（仍是上界，全 0xFF 时记为无上界）。
+ *
+ * 摘要只会变宽不会变窄：删除、回滚和原地更新都不收缩摘要，因此摘要始终覆盖页内
+ * 所有版本的行（包括其他事务未提交或已删除的版本），按摘要跳页不会漏掉可见行。
+ */
+class BlockRangeIndex {
+public:
+    /**
+     * @brief 最小/最大值编码的最大字节数
+     */
+    static constexpr int MAX_BOUND_SIZE = 32;
+
+    /**
+     * @brief 每条摘要的布隆过滤器字节数（512 位）
+     */
+    static constexpr int BLOOM_BYTES = 64;
+
+    /**
+     * @brief 布隆过滤器的哈希函数个数
+     */
+    static constexpr int BLOOM_HASHES = 3;
+
+    /**
+     * @brief 一个数据页的摘要
+     */
+    struct PageSummary {
+        PageId heapPageId = INVALID_PAGE_ID;  // 数据页ID
+        uint32_t rowCount = 0;                // 写入过的行数（含已删除的版本）
+        uint32_t nullCount = 0;               // 其中索引列为 NULL 的行数
+        bool hasValues = false;               // 是否有非 NULL 值（否则 minKey/maxKey 无意义）
+        bool maxUnbounded = false;            // 最大值截断后无法进位，上界视为无穷大
+        QByteArray minKey;                    // 最小值编码（可能截断，仍是下界）
+        QByteArray maxKey;                    // 最大值编码（可能截断并进位，仍是上界）
+        QByteArray bloom;                     // 布隆过滤器位图（未启用时为空）
+    };
+
+    /**
+     * @brief 扫描条件（WHERE 中作用在索引列上的 AND 合取项）
+     */
+    struct Filter {
+        bool hasLower = false;          // 是否有下界
+        QVariant lower;                 // 下界值
+        bool lowerInclusive = true;     // 下界是否包含（>= 还是 >）
+        bool hasUpper = false;          // 是否有上界
+        QVariant upper;                 // 上界值
+        bool upperInclusive = true;     // 上界是否包含（<= 还是 <）
+        bool hasEquals = false;         // 是否有 col = v / col IN (...) 条件
+        QVector<QVariant> equals;       // 等值候选（为空且 hasEquals 时没有行能匹配）
+        bool isNull = false;            // col IS NULL
+        bool isNotNull = false;         // col IS NOT NULL
+
+        bool isRestrictive() const { return hasLower || hasUpper || hasEquals || isNull || isNotNull; }
+    };
+
+    /**
+     * @brief 构造函数
+     * @param bufferPool 缓冲池管理器
+     * @param keyType 索引列类型
+     * @param metaPageId 元数据页ID（新索引为 INVALID_PAGE_ID，随后调用 create）
+     */
+    BlockRangeIndex(BufferPoolManager* bufferPool, DataType keyType, PageId metaPageId = INVALID_PAGE_ID);
+
+    /**
+     * @brief 分配元数据页，创建空索引
+     * @param bloomEnabled 摘要是否带布隆过滤器（加速等值条件，摘要变大约一倍）
+     */
+    bool create(bool bloomEnabled);
+
+    /**
+     * @brief 从元数据页加载全部摘要
+     */
+    bool load();
+
+    /**
+     * @brief 登记一个数据页（已登记时不做任何事）；CREATE INDEX 用它让空页也有摘要
+     */
+    bool addPage(PageId heapPageId);
+
+    /**
+     * @brief 把一行的索引列值并入所在数据页的摘要（页未登记时自动登记）
+     */
+    bool addValue(PageId heapPageId, const QVariant& value);
+
+    /**
+     * @brief 按摘要找出可能包含匹配行的数据页（按表链表顺序）
+     *
+     * 没有摘要的数据页不会出现在结果里，调用方应保证索引覆盖了表的所有数据页。
+     */
+    QVector<PageId> candidatePages(const Filter& filter) const;
+
+    /**
+     * @brief 单个摘要是否可能包含匹配行
+     */
+    bool mayMatch(const PageSummary& summary, const Filter& filter) const;
+
+    PageId getMetaPageId() const { return metaPageId_; }
+    DataType getKeyType() const { return keyType_; }
+    bool isBloomEnabled() const { return bloomEnabled_; }
+    int summaryCount() const { return summaries_.size(); }
+    const QVector<PageSummary>& summaries() const { return summaries_; }
+
+    /**
+     * @brief 占用的页数（元数据页 + 摘要页）
+     */
+    int pageCount() const { return 1 + dataPages_.size(); }
+
+    /**
+     * @brief 每条摘要在磁盘上的字节数
+     */
+    int entrySize() const;
+
+private:
+    /**
+     * @brief 已编码的扫描条件（每次 candidatePages 只编码一次）
+     */
+    struct EncodedFilter {
+        bool valid = true;              // 常量无法按键类型编码时为 false，不做裁剪
+        bool hasLower = false;
+        QByteArray lower;
+        bool lowerInclusive = true;
+        bool hasUpper = false;
+        QByteArray upper;
+        bool upperInclusive = true;
+        bool hasEquals = false;
+        QVector<QByteArray> equals;
+        bool isNull = false;
+        bool isNotNull = false;
+    };
+
+    EncodedFilter encodeFilter(const Filter& filter) const;
+    bool mayMatchEncoded(const PageSummary& summary, const EncodedFilter& filter) const;
+
+    static void bloomAdd(QByteArray& bloom, const QByteArray& key);
+    static bool bloomMayContain(const QByteArray& bloom, const QByteArray& key);
+
+    int entriesPerPage() const;
+    bool appendSummary(const PageSummary& summary);
+    bool writeSummary(int position);
+    bool writeMeta();
+    void serializeSummary(const PageSummary& summary, char* out) const;
+    void deserializeSummary(const char* in, PageSummary& summary) const;
+
+    BufferPoolManager* bufferPool_;
+    DataType keyType_;
+    PageId metaPageId_;
+    bool bloomEnabled_ = false;
+
+    QVector<PageSummary> summaries_;        // 按表链表顺序
+    QHash<PageId, int> positions_;          // 数据页ID -> summaries_ 下标
+    QVector<PageId> dataPages_;             // 摘要页（第 i 页存放第 i * entriesPerPage() 条起的摘要）
+};
+
+} // namespace qindb
+
+#endif // QINDB_BLOCK_RANGE_INDEX_H
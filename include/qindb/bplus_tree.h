@@ -20,6 +20,16 @@ enum class BPlusTreeNodeType : uint8_t {
     LEAF_NODE       // 叶子节点（数据节点）
 };
 
+/**
+ * @brief B+ 树页格式标志（BPlusTreePageHeader::flags）
+ */
+enum BPlusTreePageFlag : uint8_t {
+    BPTREE_FLAG_NONE = 0x00,               // 原始格式：每个键完整存储
+    BPTREE_FLAG_PREFIX_COMPRESSED = 0x01,  // 节点内公共前缀只存一次，条目只存后缀
+    BPTREE_FLAG_NORMALIZED_KEYS = 0x02,    // 键为 KeyEncoder 保序编码，可直接 memcmp 比较
+    BPTREE_FLAG_TXN_VALUES = 0x04          // 叶子的值槽位存放创建事务ID（复合索引），而不是 rowId
+};
+
 /**
  * @brief B+ 树页头部结构体
  *
@@ -34,7 +44,7 @@ enum class BPlusTreeNodeType : uint8_t {
 #pragma pack(push, 1)  // 设置1字节对齐，确保结构体紧凑排列
 struct BPlusTreePageHeader {
     BPlusTreeNodeType nodeType;    // 节点类型 (1 字节)
-    uint8_t reserved1;              // 保留 (1 字节)
+    uint8_t flags;                  // 页格式标志 BPlusTreePageFlag (1 字节)
     uint16_t numKeys;               // 键的数量 (2 字节)
     uint16_t maxKeys;               // 最大键数量 (2 字节)
     uint16_t reserved2;             // 保留 (2 字节)
@@ -48,7 +58,7 @@ struct BPlusTreePageHeader {
 
     BPlusTreePageHeader()
         : nodeType(BPlusTreeNodeType::INVALID)
-        , reserved1(0)
+        , flags(BPTREE_FLAG_NONE)
         , numKeys(0)
         , maxKeys(0)
         , reserved2(0)
@@ -99,6 +109,7 @@ struct BPlusTreeInternalEntry {
  *
  * 特性：
  * - 支持整数键（int64_t）
+ * - 节点内查找直接在页内条目上进行（IntKeySearch：无分支二分 + AVX2 比较）
  * - 自平衡
  * - 所有数据存储在叶子节点
  * - 叶子节点通过双向链表连接，支持范围查询
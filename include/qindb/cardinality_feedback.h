@@ -0,0 +1,86 @@
+#ifndef QINDB_CARDINALITY_FEEDBACK_H
+#define QINDB_CARDINALITY_FEEDBACK_H
+
+#include "qindb/common.h"
+#include <QHash>
+#include <QMutex>
+#include <QString>
+#include <QStringList>
+
+namespace qindb {
+
+/**
+ * @brief 基数反馈存储：记录执行后的实际行数与优化器估算的行数之比，用于修正之后的估算
+ *
+ * 以谓词签名为键（扫描：表名 + 规范化的 WHERE 条件；连接：两边的表和连接列）。
+ * 执行器在查询结束后按计划节点记录 实际行数 / 修正前的估算行数，比值按对数做指数平滑，
+ * 优化器再次遇到同一签名时把估算乘上这个修正系数。
+ *
+ * 重新 ANALYZE 或删除表时清除涉及该表的条目（统计信息变了，旧的修正不再适用）。
+ * 条目数有上限，满了淘汰最久未用的条目。只在内存中，由同一数据库的所有查询共享。
+ */
+class CardinalityFeedback {
+public:
+    static constexpr int MAX_ENTRIES = 1024;        // 条目数上限
+    static constexpr double SMOOTHING = 0.5;        // 新观测值的权重（对数域）
+
+    /**
+     * @brief 一个签名的反馈
+     */
+    struct Entry {
+        QStringList tables;          // 涉及的表（小写）
+        double correction = 1.0;     // 修正系数：实际行数 / 修正前的估算行数
+        size_t observations = 0;     // 观测次数
+        size_t lastEstimated = 0;    // 最近一次修正前的估算行数
+        size_t lastActual = 0;       // 最近一次的实际行数
+        quint64 lastUsed = 0;        // 最近一次记录的时刻（用于淘汰）
+    };
+
+    CardinalityFeedback() = default;
+
+    /**
+     * @brief 扫描的签名：表名 + 条件的规范文本
+     */
+    static QString scanSignature(const QString& tableName, const QString& predicate);
+
+    /**
+     * @brief 等值连接的签名（两边顺序无关）
+     */
+    static QString joinSignature(const QString& leftTable, const QString& leftColumn,
+                                 const QString& rightTable, const QString& rightColumn);
+
+    /**
+     * @brief 记录一次执行的反馈
+     * @param estimatedRows 修正前的估算行数
+     * @param actualRows 实际行数
+     */
+    void record(const QString& signature, const QStringList& tables,
+                size_t estimatedRows, size_t actualRows);
+
+    /**
+     * @brief 签名的修正系数（没有反馈时为 1.0）
+     */
+    double correction(const QString& signature) const;
+
+    /**
+     * @brief 获取签名的反馈（没有时返回 false）
+     */
+    bool getEntry(const QString& signature, Entry& entry) const;
+
+    /**
+     * @brief 清除涉及该表的条目
+     */
+    void invalidateTable(const QString& tableName);
+
+    void clear();
+    int size() const;
+
+private:
+    mutable QMutex mutex_;
+    QHash<QString, Entry> entries_;
+    quint64 clock_ = 0;
+};
+
+} // namespace qindb
+
+#endif // QINDB_CARDINALITY_FEEDBACK_H
@@ -15,6 +15,8 @@ namespace qindb {      // 定义qindb命名空间，避免命名冲突
 class CatalogDbBackend;  // 目录数据库后端类
 class BufferPoolManager; // 缓冲池管理器类
 class DiskManager;      // 磁盘管理器类
+struct TableStats;      // 表统计信息结构体
+class CardinalityFeedback; // 基数反馈存储类
 
 /**
  * @brief 列定义结构体
@@ -55,6 +57,9 @@ struct IndexDef {
     QString name;               // 索引名
     QString tableName;          // 表名
     QVector<QString> columns;   // 索引列
+    QVector<QString> includeColumns; // INCLUDE 的非键列（只存在 B+ 树叶子项中）
+    QVector<QString> keyExpressions; // 与 columns 对应的键表达式（规范化 SQL，普通列为空串；全为普通列时为空）
+    QString predicate;          // 部分索引的 WHERE 谓词（规范化 SQL），为空表示索引全表
     IndexType indexType;        // 索引类型（B+树/哈希/TRIE/倒排/R树）
     DataType keyType;           // 键的数据类型（用于通用B+树）
     bool unique;                // 是否唯一索引
@@ -69,6 +74,22 @@ struct IndexDef {
         , autoCreated(false)
         , rootPageId(INVALID_PAGE_ID)
     {}
+
+    // 第 i 个键是否为表达式
+    bool isKeyExpression(int i) const {
+        return i < keyExpressions.size() && !keyExpressions[i].isEmpty();
+    }
+
+    // 是否有表达式键
+    bool hasKeyExpressions() const {
+        for (const auto& expr : keyExpressions) {
+            if (!expr.isEmpty()) return true;
+        }
+        return false;
+    }
+
+    // 是否为部分索引
+    bool isPartial() const { return !predicate.isEmpty(); }
 };
 
 /**
@@ -188,6 +209,11 @@ public:
      */
     bool dropIndex(const QString& indexName);
 
+    /**
+     * @brief 更新索引的根页ID（B+树分裂出新根时调用）
+     */
+    bool setIndexRootPageId(const QString& indexName, PageId rootPageId);
+
     /**
      * @brief 获取索引定义
      */
@@ -198,6 +224,34 @@ public:
      */
     QVector<IndexDef> getTableIndexes(const QString& tableName) const;
 
+    /**
+     * @brief 设置表的优化器统计信息（ANALYZE 的结果），随元数据一起持久化
+     */
+    void setTableStats(const TableStats& stats);
+
+    /**
+     * @brief 获取表的统计信息（没有时返回空指针）
+     *
+     * 返回的是不可变快照：更新时整体替换，调用方持有期间不受影响
+     */
+    std::shared_ptr<const TableStats> getTableStats(const QString& tableName) const;
+
+    /**
+     * @brief 把一条已提交 DML 的改动计入表的统计信息（在锁内复制、修改并替换快照）
+     * @return 更新后的快照；表没有统计信息时返回空指针
+     */
+    std::shared_ptr<const TableStats> applyTableModifications(const QString& tableName,
+                                                              size_t rowsInserted,
+                                                              size_t rowsDeleted,
+                                                              size_t rowsUpdated);
+
+    /**
+     * @brief 获取基数反馈存储（执行后的实际行数，用于修正优化器的估算）
+     *
+     * 与 Catalog 同生命周期，不持久化；删除表时清除该表的反馈
+     */
+    CardinalityFeedback* getCardinalityFeedback() const { return cardinalityFeedback_.get(); }
+
     /**
      * @brief 保存元数据（自动选择文件或数据库模式）
      * @param filePath 文件路径（仅在文件模式下使用）
@@ -240,6 +294,8 @@ public:
 private:
     QHash<QString, std::shared_ptr<TableDef>> tables_;  // 表名 -> 表定义
     QHash<QString, IndexDef> indexes_;                  // 索引名 -> 索引定义
+    QHash<QString, std::shared_ptr<const TableStats>> tableStats_;  // 表名 -> 统计信息快照
+    std::unique_ptr<CardinalityFeedback> cardinalityFeedback_;      // 基数反馈（自带锁）
     mutable QMutex mutex_;                              // 线程安全
 
     std::unique_ptr<CatalogDbBackend> dbBackend_;       // 数据库存储后端
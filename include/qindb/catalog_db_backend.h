@@ -22,6 +22,9 @@ class DiskManager;       // 磁盘管理器的前向声明
  * - sys_tables: 存储表定义
  * - sys_columns: 存储列定义
  * - sys_indexes: 存储索引定义
+ *
+ * 表的统计信息（可能有多页大）不放在系统表里，每个表单独写一条 METADATA_PAGE 页链，
+ * sys_tables 的记录中只保存页链首页，统计信息再大也不会挤占表定义的空间。
  */
 class CatalogDbBackend {
 public:
@@ -44,22 +47,26 @@ public:
      * @brief 保存catalog到数据库
      * @param tables 表定义映射
      * @param indexes 索引定义映射
+     * @param stats 表统计信息（表名小写为键，写在各表自己的页链中）
      * @return 是否成功
      */
     bool saveCatalog(
         const QHash<QString, std::shared_ptr<TableDef>>& tables,
-        const QHash<QString, IndexDef>& indexes
+        const QHash<QString, IndexDef>& indexes,
+        const QHash<QString, std::shared_ptr<const TableStats>>& stats
     );
 
     /**
      * @brief 从数据库加载catalog
      * @param tables 输出：表定义映射
      * @param indexes 输出：索引定义映射
+     * @param stats 输出：表统计信息
      * @return 是否成功
      */
     bool loadCatalog(
         QHash<QString, std::shared_ptr<TableDef>>& tables,
-        QHash<QString, IndexDef>& indexes
+        QHash<QString, IndexDef>& indexes,
+        QHash<QString, std::shared_ptr<const TableStats>>& stats
     );
 
     /**
@@ -77,6 +84,17 @@ private:
     PageId sysColumnsFirstPage_;
     PageId sysIndexesFirstPage_;
 
+    /**
+     * @brief 已写入页链的统计信息快照
+     *
+     * 快照不可变，更新时整体替换：保存时快照没变就沿用原页链，不重复写入
+     */
+    struct StatsChain {
+        std::shared_ptr<const TableStats> snapshot;
+        PageId firstPageId = INVALID_PAGE_ID;
+    };
+    QHash<QString, StatsChain> statsChains_;  // 表名（小写）→ 当前记录引用的统计信息页链
+
     /**
      * @brief 创建系统表
      */
@@ -84,8 +102,25 @@ private:
 
     /**
      * @brief 保存表定义
+     * @param statsPageId 统计信息页链首页（没有统计信息时为 INVALID_PAGE_ID）
+     */
+    bool saveTableDef(const TableDef& table, PageId statsPageId);
+
+    /**
+     * @brief 把统计信息写成一条新的页链
+     * @return 首页ID，失败时返回 INVALID_PAGE_ID（已分配的页会释放）
+     */
+    PageId writeStatsChain(const TableStats& stats);
+
+    /**
+     * @brief 从页链读取统计信息
+     */
+    bool readStatsChain(PageId firstPageId, TableStats& stats);
+
+    /**
+     * @brief 释放统计信息页链
      */
-    bool saveTableDef(const TableDef& table);
+    void freeStatsChain(PageId firstPageId);
 
     /**
      * @brief 保存列定义
@@ -100,7 +135,8 @@ private:
     /**
      * @brief 加载所有表定义
      */
-    bool loadTableDefs(QHash<QString, std::shared_ptr<TableDef>>& tables);
+    bool loadTableDefs(QHash<QString, std::shared_ptr<TableDef>>& tables,
+                       QHash<QString, std::shared_ptr<const TableStats>>& stats);
 
     /**
      * @brief 加载所有列定义
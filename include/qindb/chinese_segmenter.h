@@ -0,0 +1,96 @@
+#ifndef QINDB_CHINESE_SEGMENTER_H
+#define QINDB_CHINESE_SEGMENTER_H
+
+#include "qindb/perfect_hash.h"
+#include <QHash>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <cstdint>
+
+namespace qindb {
+
+/**
+ * @brief 基于词典的中文分词（有向无环图 + 一元语言模型）
+ *
+ * 对一段连续的汉字：
+ * - 从每个位置出发，用词典找出所有以该位置开头的词，构成切分 DAG
+ *   （词典同时保存所有词的前缀，前缀不存在时立即停止向后扩展）
+ * - 从右向左动态规划，选出 sum(log(词频 / 总词频)) 最大的切分路径
+ * - 词典中没有的单字按词频 1 处理，所以未登录的字仍会单独成词
+ *
+ * 内置一个常用词词典；loadDictionary 可以追加 jieba 格式（每行 "词 词频 [词性]"）的词典文件。
+ * 分词过程只使用栈上的数组，不分配内存。构建完成后只读，可以被多个线程共享。
+ */
+class ChineseSegmenter {
+public:
+    /**
+     * @brief 一次动态规划处理的最大字数，更长的汉字串分段处理
+     */
+    static constexpr int MAX_RUN_LENGTH = 256;
+
+    /**
+     * @brief 词典中词的最大长度（更长的词被忽略）
+     */
+    static constexpr int MAX_WORD_LENGTH = 16;
+
+    /**
+     * @brief 创建只含内置词典的分词器
+     */
+    ChineseSegmenter();
+
+    /**
+     * @brief 共享的内置词典分词器
+     */
+    static const ChineseSegmenter& builtin();
+
+    /**
+     * @brief 添加词（已存在时累加词频），之后需要调用 rebuild
+     */
+    void addWord(const QString& word, uint32_t frequency);
+
+    /**
+     * @brief 从 jieba 格式的词典文件追加词并重建索引
+     * @return false 文件无法读取
+     */
+    bool loadDictionary(const QString& path);
+
+    /**
+     * @brief 用当前的词表重建查找结构
+     */
+    bool rebuild();
+
+    /**
+     * @brief 切分一段汉字
+     * @param text 汉字串（调用方保证全部是汉字）
+     * @param length 长度（超过 MAX_RUN_LENGTH 时分段切分）
+     * @param wordLengths 输出每个词的长度（按顺序），至少 length 个元素
+     * @return 词的个数
+     */
+    int segment(const QChar* text, int length, uint8_t* wordLengths) const;
+
+    /**
+     * @brief 词是否在词典中
+     */
+    bool containsWord(QStringView word) const;
+
+    /**
+     * @brief 词典中的词数
+     */
+    int wordCount() const { return static_cast<int>(words_.size()); }
+
+private:
+    void loadBuiltinDictionary();
+
+    QStringList words_;                 // 词表（不含前缀）
+    QVector<uint64_t> frequencies_;     // 与 words_ 对应
+    QHash<QString, int> wordIndex_;     // 构建词表时去重
+
+    PerfectHash lookup_;                // 词和所有前缀
+    QVector<float> logProbabilities_;   // lookup_ 的键下标 -> log(词频 / 总词频)，纯前缀为 -inf
+    float unknownLogProbability_;       // 未登录单字的 log(1 / 总词频)
+};
+
+} // namespace qindb
+
+#endif // QINDB_CHINESE_SEGMENTER_H
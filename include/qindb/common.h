@@ -183,7 +183,9 @@ enum class IndexType : uint8_t {
     HASH = 1,          // 哈希索引（仅支持等值查询，O(1)性能）
     TRIE = 2,          // TRIE树（字符串前缀查询）
     INVERTED = 3,      // 倒排索引（全文搜索）
-    RTREE = 4          // R-树（空间索引）
+    RTREE = 4,         // R-树（空间索引）
+    BRIN = 5,          // 块范围索引（每个数据页的最小/最大值摘要）
+    BITMAP = 6         // 位图索引（每个不同值一个压缩位图，适合低基数列）
 };
 
 /**
@@ -196,6 +198,8 @@ inline QString getIndexTypeName(IndexType type) {
         case IndexType::TRIE: return "TRIE";
         case IndexType::INVERTED: return "INVERTED";
         case IndexType::RTREE: return "RTREE";
+        case IndexType::BRIN: return "BRIN";
+        case IndexType::BITMAP: return "BITMAP";
         default: return "UNKNOWN";
     }
 }
@@ -20,20 +20,62 @@ namespace qindb {           // 定义qindb命名空间
  * - 基于 GenericBPlusTree 实现
  * - 支持范围查询
  *
+ * 树中的键 = 各列 KeyEncoder 编码直接拼接 + 8 字节大端 rowId：
+ * - 拼接后的字节序就是各列的字典序，键直接交给 B+ 树（不再包成 BINARY 值）
+ * - rowId 后缀让列值相同的行各占一个键，索引允许重复值，删除时按 (键, rowId) 精确定位
+ * - 前 k 列相等（可再加第 k+1 列的范围）的所有行在叶子上是连续的一段，
+ *   一次 scanEncoded 即可取出
+ *
+ * 覆盖索引（INCLUDE 列）：包含列的编码追加在 rowId 之后，只存在叶子项里，不参与排序；
+ * 内部节点的分隔键做后缀截断，通常不会带上它们。B+ 树的值槽位存放创建该行的事务ID，
+ * 执行器据此做 MVCC 可见性检查，从而不读堆页直接用索引回答查询。这种树的页上带
+ * BPTREE_FLAG_TXN_VALUES；没有该标志的旧树值槽位是 rowId，不能用于仅索引扫描。
+ *
  * 使用示例：
  * CREATE INDEX idx_name_age ON users(name, age);
  */
 class CompositeIndex {      // 复合索引类定义
 public:
+    /**
+     * @brief 前缀之后一列的范围条件
+     */
+    struct ColumnRange {
+        bool hasLower = false;        // 是否有下界
+        QVariant lower;               // 下界值
+        bool lowerInclusive = true;   // 下界是否包含（>= 还是 >）
+        bool hasUpper = false;        // 是否有上界
+        QVariant upper;               // 上界值
+        bool upperInclusive = true;   // 上界是否包含（<= 还是 <）
+
+        bool isBounded() const { return hasLower || hasUpper; }
+    };
+
+    /**
+     * @brief 一个索引项
+     */
+    struct Entry {
+        CompositeKey key;                           // 键列
+        RowId rowId = INVALID_ROW_ID;               // 行ID
+        QVector<QVariant> included;                 // 包含列（没有包含列时为空）
+        TransactionId createTxnId = INVALID_TXN_ID; // 创建该行的事务ID
+    };
+
+    /**
+     * @brief 单个索引项的最大字节数（保证每个叶子页至少能放下几项）
+     */
+    static constexpr int MAX_ENTRY_SIZE = 2048;
+
     /**
      * @brief 构造函数
      * @param bufferPoolManager 缓冲池管理器指针
      * @param columnTypes 复合键各列的数据类型数组
      * @param rootPageId 根节点页ID（如果是新索引则为 INVALID_PAGE_ID）
+     * @param includeTypes 包含列（INCLUDE）的数据类型
      */
     CompositeIndex(BufferPoolManager* bufferPoolManager,
                   const QVector<DataType>& columnTypes,
-                  PageId rootPageId = INVALID_PAGE_ID);
+                  PageId rootPageId = INVALID_PAGE_ID,
+                  const QVector<DataType>& includeTypes = QVector<DataType>());
 
     ~CompositeIndex();      // 析构函数
 
@@ -46,7 +88,23 @@ public:
     bool insert(const CompositeKey& key, RowId rowId);
 
     /**
-     * @brief 删除复合键
+     * @brief 插入带包含列的索引项
+     * @param included 包含列的值（按 includeTypes 的顺序）
+     * @param createTxnId 创建该行的事务ID
+     */
+    bool insert(const CompositeKey& key, RowId rowId,
+                const QVector<QVariant>& included, TransactionId createTxnId);
+
+    /**
+     * @brief 删除某一行的索引项
+     * @param key 复合键
+     * @param rowId 行ID
+     * @return 是否成功
+     */
+    bool remove(const CompositeKey& key, RowId rowId);
+
+    /**
+     * @brief 删除复合键（等于该键的所有行）
      * @param key 要删除的复合键
      * @return 是否成功
      */
@@ -55,7 +113,7 @@ public:
     /**
      * @brief 查找复合键对应的行ID
      * @param key 要查找的复合键
-     * @param rowId 输出参数，找到的行ID
+     * @param rowId 输出参数，找到的行ID（有多行时返回 rowId 最小的一行）
      * @return 是否找到
      */
     bool search(const CompositeKey& key, RowId& rowId);
@@ -83,6 +141,32 @@ public:
     bool prefixSearch(const CompositeKey& prefix,
                      QVector<QPair<CompositeKey, RowId>>& results);
 
+    /**
+     * @brief 前缀等值 + 下一列范围查询
+     * @param prefix 前 k 列的值（可以为空）
+     * @param range 第 k+1 列的范围（无界时等同于前缀查询）
+     * @param results 输出参数，按键升序的 (key, rowId)
+     * @return 是否成功（范围值无法按列类型编码时返回 false）
+     *
+     * 示例：索引 (a, b)，WHERE a = 1 AND b > 5 对应 prefix = (1)、range = (5, +inf)
+     */
+    bool scan(const CompositeKey& prefix, const ColumnRange& range,
+              QVector<QPair<CompositeKey, RowId>>& results);
+
+    /**
+     * @brief 同 scan，同时返回包含列和创建事务ID（用于仅索引扫描）
+     */
+    bool scanEntries(const CompositeKey& prefix, const ColumnRange& range,
+                     QVector<Entry>& results);
+
+    /**
+     * @brief 自底向上批量构建（只能用于空索引）
+     * @param entries 待加载的 (key, rowId)，可以无序
+     * @param fillFactor 页填充因子
+     */
+    bool bulkLoad(const QVector<QPair<CompositeKey, RowId>>& entries, double fillFactor = 1.0);
+    bool bulkLoad(const QVector<Entry>& entries, double fillFactor = 1.0);
+
     /**
      * @brief 获取根节点页ID
      */
@@ -98,20 +182,60 @@ public:
      */
     int getColumnCount() const { return columnTypes_.size(); }
 
+    /**
+     * @brief 值槽位是否存放创建事务ID（旧格式的树存放 rowId，scanEntries 返回的 createTxnId 无效）
+     */
+    bool storesCreateTxnIds() const;
+
+    /**
+     * @brief 获取包含列的类型
+     */
+    const QVector<DataType>& getIncludeTypes() const { return includeTypes_; }
+
 private:
     BufferPoolManager* bufferPoolManager_;
     QVector<DataType> columnTypes_;          // 各列的数据类型
-    std::unique_ptr<GenericBPlusTree> tree_; // 底层B+树（使用BINARY类型存储序列化的CompositeKey）
+    QVector<DataType> includeTypes_;         // 包含列的数据类型
+    std::unique_ptr<GenericBPlusTree> tree_; // 底层B+树（键为 encodeEntry 的输出）
+
+    /**
+     * @brief 校验键的列数和类型
+     */
+    bool validateKey(const CompositeKey& key, const char* operation) const;
+
+    /**
+     * @brief 编码索引项：各列编码 + 大端 rowId + 包含列编码（included 为空时不带包含列）
+     */
+    QByteArray encodeEntry(const CompositeKey& key, RowId rowId, const QVector<QVariant>& included) const;
+
+    /**
+     * @brief 解码索引项（不含 createTxnId）
+     */
+    bool decodeEntry(const QByteArray& data, Entry& entry) const;
+
+    /**
+     * @brief 字节串的后继：大于所有以 prefix 开头的字节串的最小串（全 0xFF 时返回空，表示无上界）
+     */
+    static QByteArray prefixSuccessor(const QByteArray& prefix);
+
+    /**
+     * @brief 扫描 [lower, upper) 并解码结果
+     */
+    bool scanRange(const QByteArray& lower, const QByteArray& upper,
+                   QVector<Entry>& results);
+
+    // ===== 旧格式（TypeSerializer 序列化、不带 rowId 后缀）的树 =====
 
     /**
-     * @brief 将复合键序列化为QVariant（用于传递给GenericBPlusTree）
+     * @brief 将复合键序列化为QVariant（旧格式，传递给GenericBPlusTree）
      */
-    QVariant serializeKey(const CompositeKey& key) const;
+    QVariant serializeLegacyKey(const CompositeKey& key) const;
 
     /**
-     * @brief 从QVariant反序列化复合键
+     * @brief 按底层B+树中的键范围查询并解码结果（旧格式）
      */
-    CompositeKey deserializeKey(const QVariant& variant) const;
+    bool searchLegacyRange(const QVariant& minKey, const QVariant& maxKey,
+                           QVector<QPair<CompositeKey, RowId>>& results);
 };
 
 } // namespace qindb
@@ -77,6 +77,23 @@ public:
      */
     bool deserialize(const QByteArray& data);
 
+    /**
+     * @brief 编码为保序字节串（KeyEncoder 格式，各列编码依次拼接）
+     * @return 编码结果，失败返回空字节数组
+     *
+     * 编码结果可直接用 memcmp 按字典序比较，且某个前缀键的编码
+     * 恰好是所有以它开头的完整键编码的字节前缀
+     */
+    QByteArray encode() const;
+
+    /**
+     * @brief 从保序字节串解码
+     * @param data encode() 产生的字节串
+     * @param types 各列的数据类型（编码本身不含类型信息）
+     * @return 是否成功
+     */
+    bool decode(const QByteArray& data, const QVector<DataType>& types);
+
     /**
      * @brief 比较两个复合键（字典序）
      * @param other 另一个复合键
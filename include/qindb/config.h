@@ -4,6 +4,7 @@
 #include <QString>    // Qt字符串类
 #include <QSettings>  // Qt设置类，用于读写配置文件
 #include <QMutex>     // Qt互斥锁，用于线程同步
+#include "qindb/cost_model.h"  // 优化器成本参数
 #include <memory>     // 智能指针
 
 namespace qindb {    // qinDB命名空间
@@ -34,6 +35,12 @@ public:
      */
     bool save();
 
+    /**
+     * @brief 配置文件路径（save 和 saveCostParams 写入的文件）
+     */
+    QString getConfigPath() const { return configPath_; }
+    void setConfigPath(const QString& configPath) { configPath_ = configPath; }
+
     // ========== 日志配置 ==========
 
     /**
@@ -75,6 +82,12 @@ public:
     QString getSlowQueryLogPath() const { return slowQueryLogPath_; }
     void setSlowQueryLogPath(const QString& path) { slowQueryLogPath_ = path; }
 
+    /**
+     * @brief 基数误估倍数：计划节点的实际行数与估算行数相差超过这个倍数时记入慢查询日志
+     */
+    double getMisestimateFactor() const { return misestimateFactor_; }
+    void setMisestimateFactor(double factor) { misestimateFactor_ = factor; }
+
     // ========== 系统日志配置 ==========
 
     /**
@@ -127,6 +140,26 @@ public:
     QString getWalFilePath() const { return walFilePath_; }
     void setWalFilePath(const QString& path) { walFilePath_ = path; }
 
+    // ========== 索引配置 ==========
+
+    /**
+     * @brief 批量构建B+树索引时叶子/内部节点的填充因子（0.5 ~ 1.0）
+     */
+    double getIndexBulkLoadFillFactor() const { return indexBulkLoadFillFactor_; }
+    void setIndexBulkLoadFillFactor(double factor) { indexBulkLoadFillFactor_ = factor; }
+
+    // ========== 优化器配置 ==========
+
+    /**
+     * @brief 优化器的成本参数（[Optimizer] 节，启动时读取；CALIBRATE 按本机测量结果写回）
+     */
+    CostParams getCostParams() const;
+    void setCostParams(const CostParams& params);
+
+    /**
+     * @brief 只把成本参数写回配置文件（其余配置项保持文件中的值）
+     */
+    bool saveCostParams();
 
     // ========== 网络配置 ==========
 
@@ -206,6 +239,10 @@ private:
     bool walUseFile_;              // WAL是否使用独立文件（true=文件，false=数据库内部）
     QString walFilePath_;          // WAL文件路径
 
+    double indexBulkLoadFillFactor_;  // 批量构建索引的页填充因子
+
+    CostParams costParams_;           // 优化器成本参数
+
 
     bool networkEnabled_;          // 是否启用网络服务器
     QString serverAddress_;        // 服务器监听地址
@@ -218,6 +255,7 @@ private:
     bool slowQueryEnabled_;
     int slowQueryThresholdMs_;
     QString slowQueryLogPath_;
+    double misestimateFactor_;
 
     QString configPath_;           // 配置文件路径
     mutable QMutex mutex_;         // 线程安全
@@ -0,0 +1,69 @@
+#ifndef QINDB_COST_CALIBRATOR_H
+#define QINDB_COST_CALIBRATOR_H
+
+#include "qindb/common.h"
+#include "qindb/cost_model.h"
+#include <QString>
+
+namespace qindb {
+
+/**
+ * @brief 成本参数校准的测量结果（每次操作的平均耗时，纳秒）
+ */
+struct CalibrationResult {
+    size_t numPages = 0;            // 测试文件的页数
+    size_t numTuples = 0;           // 测试文件中的记录数
+
+    double seqPageReadNs = 0.0;     // 顺序读一页
+    double randomPageReadNs = 0.0;  // 随机读一页
+    double pageWriteNs = 0.0;       // 写一页
+    double tupleDecodeNs = 0.0;     // 从表页解码一条记录
+    double operatorEvalNs = 0.0;    // 在一行上求值一个比较运算符
+    bool coldReads = false;         // 每轮读之前是否都成功丢弃了页缓存
+
+    CostParams params;              // 按测量结果拟合的成本参数
+};
+
+/**
+ * @brief 成本参数校准器：在本机上测量页读写、记录解码和表达式求值的耗时，拟合 CostParams
+ *
+ * 在 workDir 下建一个临时数据文件（应与数据库文件在同一设备上），按查询执行时的路径测量：
+ * 1. 通过 DiskManager 顺序写入 numPages 个装满记录的表页
+ * 2. 通过 DiskManager 按页号顺序、按随机顺序各读一遍所有页
+ * 3. 用 TablePage::getAllRecords 解码所有页中的记录
+ * 4. 用 ExpressionEvaluator 在每条记录上求值一个比较条件
+ * 每项测量重复 ROUNDS 次取最快的一次，减少其他进程的干扰。
+ *
+ * 拟合时以顺序读一页为成本单位（seqPageReadCost = 1），其余参数是相应耗时与它的比值；
+ * 没有测量的参数（索引查找、内存、网络）保留 baseParams 中的值。
+ * 每轮读之前先让操作系统丢弃测试文件的页缓存（DiskManager::dropOSCache），测的是冷读。
+ * 平台不支持时读会命中缓存，此时随机读与顺序读的比值保留 baseParams 中的值。
+ */
+class CostCalibrator {
+public:
+    static constexpr size_t DEFAULT_PAGES = 2048;   // 默认测试文件大小：2048 页（16 MB）
+    static constexpr int ROUNDS = 3;                // 每项测量的重复次数
+
+    explicit CostCalibrator(const QString& workDir, size_t numPages = DEFAULT_PAGES);
+
+    /**
+     * @brief 运行所有测量并拟合成本参数
+     * @param baseParams 没有测量的参数取这里的值
+     * @param result 输出测量结果和拟合的参数
+     * @return 是否成功（临时文件无法创建或读写失败时返回 false）
+     */
+    bool calibrate(const CostParams& baseParams, CalibrationResult& result);
+
+    /**
+     * @brief 按测量结果拟合成本参数（以顺序读一页为单位）
+     */
+    static CostParams fitParams(const CalibrationResult& measured, const CostParams& baseParams);
+
+private:
+    QString workDir_;
+    size_t numPages_;
+};
+
+} // namespace qindb
+
+#endif // QINDB_COST_CALIBRATOR_H
@@ -40,6 +40,10 @@ struct CostParams {
 enum class PlanNodeType {
     SEQ_SCAN,           // 全表扫描
     INDEX_SCAN,         // 索引扫描
+    INDEX_ONLY_SCAN,    // 仅索引扫描（覆盖索引，不回表）
+    BLOCK_RANGE_SCAN,   // 块范围索引扫描（按每页摘要跳页的顺序扫描）
+    BITMAP_SCAN,        // 位图索引扫描（位图 AND/OR 得到候选行后按行ID顺序回表）
+    TRIE_SCAN,          // TRIE 索引扫描（按前缀下降到子树，遍历子树中的行）
     NESTED_LOOP_JOIN,   // 嵌套循环连接
     HASH_JOIN,          // 哈希连接
     SORT_MERGE_JOIN,    // 排序归并连接
@@ -97,10 +101,89 @@ public:
      * @param stats 表统计信息
      * @param indexName 索引名称
      * @param selectivity 选择率
+     * @param entryWidth 索引条目宽度（字节）；为 0 时按索引占表的 20% 估算索引大小
+     * @param indexFraction 进入索引的行占全表的比例（部分索引小于 1，索引更矮、页更少）
+     * @param correlation 索引键与行物理顺序的相关系数：0 时每行回表按一次随机读计，
+     *                    ±1 时命中的行集中在连续的页上，按顺序读计，中间按相关系数的平方插值
      */
     CostEstimate estimateIndexScanCost(const TableStats& stats,
                                       const QString& indexName,
-                                      double selectivity) const;
+                                      double selectivity,
+                                      size_t entryWidth = 0,
+                                      double indexFraction = 1.0,
+                                      double correlation = 0.0) const;
+
+    /**
+     * @brief 估算仅索引扫描成本（覆盖索引）
+     *
+     * 只读 B+ 树的路径和命中的叶子页，不回表；条目越宽（INCLUDE 列越多），
+     * 索引越大、每页条目越少，要读的叶子页也越多
+     * @param stats 表统计信息
+     * @param selectivity 选择率
+     * @param entryWidth 索引条目宽度（字节）
+     * @param indexFraction 进入索引的行占全表的比例（部分索引小于 1）
+     */
+    CostEstimate estimateIndexOnlyScanCost(const TableStats& stats,
+                                          double selectivity,
+                                          size_t entryWidth,
+                                          double indexFraction = 1.0) const;
+
+    /**
+     * @brief 估算哈希索引等值探测成本
+     *
+     * 线性哈希的目录常驻内存，每次探测只读一个桶页（溢出链很短），与表大小无关
+     * @param stats 表统计信息
+     * @param selectivity 选择率
+     * @param numProbes 探测次数（col = v 为 1，col IN (...) 为列表长度）
+     * @param correlation 键列与行物理顺序的相关系数（同 estimateIndexScanCost）
+     */
+    CostEstimate estimateHashIndexScanCost(const TableStats& stats,
+                                          double selectivity,
+                                          size_t numProbes = 1,
+                                          double correlation = 0.0) const;
+
+    /**
+     * @brief 估算块范围索引（BRIN）扫描成本
+     *
+     * 先顺序读全部摘要页，再按表顺序只读摘要可能匹配的数据页，页内所有行都要过滤
+     * @param stats 表统计信息
+     * @param selectivity 选择率
+     * @param pageFraction 摘要无法排除的数据页比例
+     * @param summaryPages 摘要页数
+     */
+    CostEstimate estimateBlockRangeScanCost(const TableStats& stats,
+                                           double selectivity,
+                                           double pageFraction,
+                                           size_t summaryPages) const;
+
+    /**
+     * @brief 估算位图索引扫描成本
+     *
+     * 读取各条件值的位图并做 AND/OR，得到的候选行按行ID升序回表
+     * @param stats 表统计信息
+     * @param selectivity 选择率
+     * @param indexSelectivity 位图条件的选择率（决定回表的行数）
+     * @param numBitmaps 要读取的位图个数（IN 列表的每个值一个）
+     */
+    CostEstimate estimateBitmapScanCost(const TableStats& stats,
+                                       double selectivity,
+                                       double indexSelectivity,
+                                       size_t numBitmaps) const;
+
+    /**
+     * @brief 估算 TRIE 索引前缀扫描成本
+     *
+     * 沿前缀下降到子树根，再遍历子树中的叶子；节点记录按写入先后散布在各页，
+     * 叶子所在的页按随机读计
+     * @param stats 表统计信息
+     * @param selectivity 选择率
+     * @param indexSelectivity 前缀 / 等值条件的选择率（决定遍历的叶子数和回表的行数）
+     * @param entryWidth 叶子条目宽度（字节）
+     */
+    CostEstimate estimateTrieScanCost(const TableStats& stats,
+                                     double selectivity,
+                                     double indexSelectivity,
+                                     size_t entryWidth) const;
 
     // ========== 连接成本估算 ==========
 
@@ -124,6 +207,15 @@ public:
                                      double buildSelectivity,
                                      double probeSelectivity) const;
 
+    /**
+     * @brief 估算索引嵌套循环连接成本（外表每行按连接键探测内表连接列上的哈希索引）
+     * @param rowsPerProbe 每次探测平均命中的内表行数
+     */
+    CostEstimate estimateIndexNestedLoopJoinCost(const TableStats& outerStats,
+                                                 const TableStats& innerStats,
+                                                 double outerSelectivity,
+                                                 double rowsPerProbe) const;
+
     /**
      * @brief 估算排序归并连接成本
      */
@@ -168,6 +260,10 @@ private:
     double estimateIOCost(size_t numPages, bool sequential) const;
     double estimateCPUCost(size_t numTuples) const;
     double estimateSortCPUCost(size_t numRows) const;  // 排序 CPU 成本: O(n log n)
+    size_t estimateIndexPages(size_t numRows, size_t entryWidth) const;  // 按条目宽度估算索引页数
+    // 按索引回表读取 fetchedRows 行的 I/O 成本（按相关系数在随机读和顺序读之间插值）
+    double estimateHeapFetchIOCost(const TableStats& stats, double selectivity,
+                                   size_t fetchedRows, double correlation) const;
 };
 
 } // namespace qindb
@@ -7,12 +7,14 @@
 #include "qindb/cost_model.h"
 #include <QString>
 #include <QVector>
+#include <QSet>
 #include <memory>
 
 namespace qindb {
 
 // 前向声明 Catalog 类
 class Catalog;
+struct IndexDef;
 
 /**
  * @brief 执行计划节点
@@ -28,10 +30,27 @@ struct PlanNode {
 
     // 连接相关属性
     QString joinColumn;                       // 连接列名
+    // 哈希连接的 children[0] 是构建侧、children[1] 是探测侧；
+    // 嵌套循环连接的 children[0] 是外表，内表为 INDEX_SCAN 时按连接键探测该索引
 
     // 过滤条件
     std::unique_ptr<ast::Expression> filter;  // WHERE 条件表达式
 
+    // 成本是否基于统计信息；为 false 时只是缺省估算，执行器按规则选择访问路径和连接算法
+    bool estimated = true;
+
+    // 基数反馈：谓词签名和未经反馈修正的估算行数（有统计信息的扫描和等值连接才有）。
+    // 执行后按签名记录 实际行数 / feedbackBaseRows，之后的估算乘上这个比值
+    QString feedbackKey;
+    size_t feedbackBaseRows = 0;
+
+    // 执行统计（执行器填写，EXPLAIN ANALYZE 输出）
+    bool executed = false;                    // 节点是否实际执行过
+    size_t actualRows = 0;                    // 实际输出行数（执行多次时为每次的平均行数）
+    size_t loops = 1;                         // 执行次数（索引嵌套循环的内层每个外层行探测一次）
+    double actualTimeMs = 0.0;                // 节点的执行时间（包含子节点，毫秒）
+    bool stoppedEarly = false;                // 取够 LIMIT 行就停止，实际行数不是完整结果
+
     // 构造函数
     PlanNode(PlanNodeType type) : nodeType(type) {}
 
@@ -74,14 +93,36 @@ public:
 
     // ========== 执行计划生成 ==========
 
+    /**
+     * @brief 为两表连接（FROM a JOIN b ON ...）选择连接算法和构建侧
+     *
+     * 等值内连接比较嵌套循环、索引嵌套循环（b 的连接列上有哈希索引）和两个方向的哈希连接；
+     * 缺少统计信息时与执行器的规则一致：能用索引嵌套循环就用，否则嵌套循环
+     *
+     * @param filter WHERE 条件：执行器记录的连接行数是过滤后的，基数反馈的签名要包含它
+     */
+    std::unique_ptr<PlanNode> optimizeJoinClause(const ast::TableReference* leftRef,
+                                                 const ast::JoinClause* join,
+                                                 const ast::Expression* filter = nullptr);
+
+    /**
+     * @brief 在访问路径或连接之上依次加上聚合、排序和 LIMIT 节点
+     *
+     * 聚合在排序之下（先分组再对分组结果排序），LIMIT 在最上面；成本累加子节点的成本
+     */
+    std::unique_ptr<PlanNode> addResultOperators(const ast::SelectStatement* selectStmt,
+                                                 std::unique_ptr<PlanNode> plan);
+
     /**
      * @brief 为表生成最优访问路径
      * @param tableName 表名
      * @param filter WHERE 条件
-     * @return 访问计划（SeqScan 或 IndexScan）
+     * @param requiredColumns 查询用到的列（小写）；非空且索引覆盖这些列时可以选择仅索引扫描
+     * @return 访问计划（SeqScan、IndexScan 或 IndexOnlyScan）
      */
     std::unique_ptr<PlanNode> generateAccessPath(const QString& tableName,
-                                                 ast::Expression* filter);
+                                                 ast::Expression* filter,
+                                                 const QSet<QString>* requiredColumns = nullptr);
 
     /**
      * @brief 生成连接计划
@@ -155,6 +196,62 @@ private:
     // 提取等值条件中的列和值
     bool extractEquality(ast::Expression* expr, QString& column, QVariant& value);
 
+    // 提取 column IN (v1, v2, ...) 中的列和值列表
+    bool extractInList(ast::Expression* expr, QString& column, QVector<QVariant>& values);
+
+    // 提取 column </<=/>/>= 常量 中的列和边界，isLower 表示常量是下界（常量可以在左侧）
+    bool extractRangeBound(ast::Expression* expr, QString& column, QVariant& value, bool& isLower);
+
+    // 估算等值连接的结果行数：两边连接列的不同值草图估算重叠的值，再乘上每个值平均的行数
+    size_t estimateJoinRows(const TableStats& leftStats, const QString& leftColumn,
+                            const TableStats& rightStats, const QString& rightColumn) const;
+
+    // 基数反馈中签名的修正系数（没有反馈时为 1.0）
+    double feedbackCorrection(const QString& signature) const;
+
+    // 估算 AND 连接的条件的选择率：同一列的上下界合并成区间，相关列的等值条件按函数依赖合并，
+    // 其余按独立性假设相乘
+    double estimateConjunctionSelectivity(const QVector<ast::Expression*>& conjuncts,
+                                          const QString& tableName);
+
+    // 提取 column LIKE '模式' 中的列和模式的字面前缀，exact 表示模式中没有通配符
+    bool extractLikePrefix(ast::Expression* expr, QString& column, QString& prefix, bool& exact);
+
+    // 查找能回答等值/IN 条件的索引（AND 的任一侧均可），numProbes 为索引探测次数
+    bool findEqualityIndex(ast::Expression* expr, const QString& tableName,
+                           IndexDef& index, size_t& numProbes);
+
+    // 查找能回答 前 k 键等值 + 第 k+1 键范围 的复合布局 B+ 树索引（键可以是表达式），
+    // indexSelectivity 为用到的条件的选择率；部分索引只在 WHERE 蕴含其谓词时可用；
+    // 用到的条件一样多时优先覆盖 requiredColumns 的索引
+    bool findCompositeIndex(ast::Expression* expr, const QString& tableName,
+                            IndexDef& index, double& indexSelectivity,
+                            const QSet<QString>* requiredColumns = nullptr);
+
+    // 查找列上有 =/</<=/>/>=/IN 常量条件的块范围索引，indexSelectivity 为这些条件的选择率
+    bool findBlockRangeIndex(ast::Expression* expr, const QString& tableName,
+                             IndexDef& index, double& indexSelectivity);
+
+    // 查找能回答 =/IN 常量条件的位图索引（所有可用的合取项一起做位图 AND），
+    // index 为第一个用到的索引，indexSelectivity 为这些条件的选择率，numBitmaps 为要读的位图数
+    bool findBitmapIndexes(ast::Expression* expr, const QString& tableName,
+                           IndexDef& index, double& indexSelectivity, size_t& numBitmaps);
+
+    // 查找能回答 LIKE '前缀%' / = '字符串' 条件的 TRIE 索引（各合取项的候选行求交），
+    // index 为第一个用到的索引，indexSelectivity 为这些条件的选择率
+    bool findTrieIndex(ast::Expression* expr, const QString& tableName,
+                       IndexDef& index, double& indexSelectivity);
+
+    // 进入索引的行占全表的比例（部分索引按谓词的选择率估算，其他索引为 1）
+    double estimateIndexFraction(const QString& tableName, const IndexDef& index);
+
+    // 索引的键列和包含列是否覆盖 requiredColumns
+    static bool indexCovers(const IndexDef& index, const QSet<QString>& requiredColumns);
+
+    // 估算 B+ 树索引条目的宽度（各键列、包含列的编码宽度 + rowId）
+    size_t estimateIndexEntryWidth(const QString& tableName, const IndexDef& index,
+                                   const TableStats& stats) const;
+
     // 检查表达式是否引用特定列
     bool referencesColumn(ast::Expression* expr, const QString& columnName);
 };
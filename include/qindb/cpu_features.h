@@ -0,0 +1,34 @@
+#ifndef QINDB_CPU_FEATURES_H
+#define QINDB_CPU_FEATURES_H
+
+/*
+ * 编译器能为单个函数生成 AVX2 指令时定义 QINDB_HAS_AVX2，
+ * AVX2 实现用 QINDB_TARGET_AVX2 标注（其余代码仍按基线指令集编译），
+ * 调用前用 CpuFeatures::hasAvx2() 在运行时确认 CPU 支持。
+ */
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define QINDB_HAS_AVX2 1
+#define QINDB_TARGET_AVX2 __attribute__((target("avx2")))
+#elif defined(_MSC_VER) && defined(_M_X64)
+#define QINDB_HAS_AVX2 1
+#define QINDB_TARGET_AVX2
+#endif
+
+namespace qindb {
+
+/**
+ * @brief 运行时 CPU 特性检测 - 供 B+ 树节点搜索、倒排表求交和位图运算共用
+ */
+class CpuFeatures {
+public:
+    /**
+     * @brief CPU 和操作系统是否支持 AVX2（只检测一次）
+     *
+     * 没有定义 QINDB_HAS_AVX2 的平台上总是返回 false。
+     */
+    static bool hasAvx2();
+};
+
+} // namespace qindb
+
+#endif // QINDB_CPU_FEATURES_H
@@ -8,6 +8,7 @@
 #include "wal.h"         // 预写日志相关
 #include "transaction.h" // 事务相关
 #include "permission_manager.h"  // 权限管理相关
+#include "statistics.h"  // 统计信息后台收集
 #include <QString>       // Qt字符串类
 #include <QMutex>       // Qt互斥锁
 #include <QDir>         // Qt目录操作
@@ -30,6 +31,7 @@ struct DatabaseDef {
     std::unique_ptr<WALManager> walManager;         // WAL管理器
     std::unique_ptr<TransactionManager> transactionManager;  // 事务管理器
     std::unique_ptr<PermissionManager> permissionManager;    // 权限管理器
+    std::unique_ptr<AutoAnalyzeWorker> autoAnalyzer;         // 后台重新收集统计信息（最后声明、最先析构）
 
     DatabaseDef(const QString& dbName, const QString& dbPath)
         : name(dbName), path(dbPath) {}
@@ -117,6 +119,11 @@ public:
      */
     TransactionManager* getCurrentTransactionManager() const;
 
+    /**
+     * @brief 获取当前数据库的后台统计信息收集器
+     */
+    AutoAnalyzeWorker* getCurrentAutoAnalyzer() const;
+
     /**
      * @brief 获取当前会话的事务ID
      * @return 当前事务ID，如果没有活跃事务返回 INVALID_TXN_ID
@@ -61,6 +61,12 @@ public:
      */
     void flush();
 
+    /**
+     * @brief 把文件数据写回磁盘后，让操作系统丢弃该文件在页缓存中的页（用于冷读测量）
+     * @return 平台不支持或失败时返回 false
+     */
+    bool dropOSCache();
+
     /**
      * @brief 关闭数据库文件
      */
@@ -10,8 +10,11 @@
 #include "expression_evaluator.h" // 包含表达式求值器
 #include "auth_manager.h" // 包含认证管理器
 #include "query_result.h" // 包含查询结果相关的类
+#include "table_page.h"   // 包含记录头（RecordHeader）
 #include <QString>       // Qt字符串类
 #include <QVector>       // Qt动态数组类
+#include <QSet>          // Qt集合类
+#include <QHash>         // Qt哈希表类
 #include <memory>        // 智能指针相关的头文件
 
 namespace qindb {  // 定义qindb命名空间
@@ -21,6 +24,10 @@ class QueryRewriter;
 class PermissionManager;
 class QueryCache;
 class TableCache;
+class InvertedIndex;
+class BlockRangeIndex;
+class BitmapIndex;
+class HashIndex;
 // CBO forward declarations
 struct PlanNode;
 
@@ -109,8 +116,12 @@ public:
 
     /**
      * @brief 执行SELECT语句
+     *
+     * 按优化器生成的执行计划选择访问路径、连接算法和构建侧，并按计划执行聚合、排序和 LIMIT；
+     * 计划节点记录实际行数和耗时
+     * @param analyzedPlan 非空时（EXPLAIN ANALYZE）不读写查询缓存，并通过它返回执行所用的计划
      */
-    QueryResult executeSelect(const SelectStatement* stmt);
+    QueryResult executeSelect(const SelectStatement* stmt, std::unique_ptr<PlanNode>* analyzedPlan = nullptr);
 
     /**
      * @brief 执行UPDATE语句
@@ -171,6 +182,11 @@ public:
      */
     QueryResult executeAnalyze(const ast::AnalyzeStatement* stmt);
 
+    /**
+     * @brief 执行CALIBRATE语句（测量本机的成本参数，写入配置文件并用于之后的查询）
+     */
+    QueryResult executeCalibrate(const ast::CalibrateStatement* stmt);
+
     /**
      * @brief 执行EXPLAIN语句（显示执行计划）
      */
@@ -305,8 +321,164 @@ private:
     QueryResult createSuccessResult(const QString& message, const QString& currentDatabase);
     /**
      * @brief 格式化执行计划用于EXPLAIN输出
+     * @param analyze 是否附上实际行数和耗时（EXPLAIN ANALYZE）
+     */
+    QString formatPlan(const PlanNode* node, int indent, bool analyze = false) const;
+
+    /**
+     * @brief 用当前数据库的统计信息为 SELECT 生成执行计划（没有统计信息时为缺省估算）
+     */
+    std::unique_ptr<PlanNode> buildSelectPlan(Catalog* catalog, BufferPoolManager* bufferPool,
+                                              const SelectStatement* stmt);
+
+    /**
+     * @brief 维护表上的二级索引：B+ 树（含复合、覆盖、部分和表达式索引）、哈希、位图、全文、块范围、R 树和 TRIE 索引
+     * @param oldRow 旧行（INSERT 时为 nullptr）
+     * @param newRow 新行（DELETE 时为 nullptr）
+     * @param txnId 执行修改的事务（记入覆盖索引条目，供仅索引扫描做可见性检查）
+     * @param newPageId 新行所在的数据页（块范围索引要并入该页的摘要；
+     *                  INVALID_PAGE_ID 时通过 RowIdIndex 查找）
+     */
+    void maintainIndexes(Catalog* catalog, BufferPoolManager* bufferPool, const TableDef* table,
+                         const QVector<QVariant>* oldRow, RowId oldRowId,
+                         const QVector<QVariant>* newRow, RowId newRowId, TransactionId txnId,
+                         PageId newPageId = INVALID_PAGE_ID);
+
+    /**
+     * @brief 维护一个复合 B+ 树索引（键为各索引列拼接，NULL 也进索引；包含列随条目存放）
+     */
+    void maintainCompositeIndex(Catalog* catalog, BufferPoolManager* bufferPool, const TableDef* table,
+                                const IndexDef& indexDef,
+                                const QVector<QVariant>* oldRow, RowId oldRowId,
+                                const QVector<QVariant>* newRow, RowId newRowId, TransactionId txnId);
+
+    /**
+     * @brief 获取本条语句中待写回的全文索引（同一语句的多行修改共用一个内存缓冲区）
+     * @return 加载失败时返回 nullptr
+     */
+    InvertedIndex* pendingFullTextIndex(BufferPoolManager* bufferPool, const IndexDef& indexDef);
+
+    /**
+     * @brief 获取本条语句中待写回的位图索引（同一语句的多行修改共用内存中的位图）
+     * @return 加载失败时返回 nullptr
+     */
+    BitmapIndex* pendingBitmapIndex(BufferPoolManager* bufferPool, const IndexDef& indexDef);
+
+    /**
+     * @brief 记录一条 DML 对表统计信息的改动
+     *
+     * 自动提交时立即计入；显式事务中累计到 COMMIT 再计入，ROLLBACK 时丢弃
+     */
+    void recordStatsChange(const QString& tableName, size_t rowsInserted, size_t rowsDeleted,
+                           size_t rowsUpdated, bool autoCommit);
+
+    /**
+     * @brief 把累计的改动计入统计信息，改动超过阈值的表交给后台重新收集
+     */
+    void applyStatsChanges();
+
+    /**
+     * @brief 语句结束时写回本条语句中延迟写回的索引：全文索引的缓冲区写成段、写回修改过的位图，并关闭打开的块范围索引和哈希索引
+     */
+    void flushPendingIndexes();
+
+    /**
+     * @brief 获取本条语句中打开的块范围索引（摘要只加载一次，修改直接写回摘要页）
+     * @return 加载失败时返回 nullptr
+     */
+    BlockRangeIndex* openBlockRangeIndex(BufferPoolManager* bufferPool, const IndexDef& indexDef);
+
+    /**
+     * @brief 获取本条语句中打开的哈希索引（目录只加载一次，语句结束时写回元数据）
+     *
+     * 目录中根页为 INVALID_PAGE_ID 的旧索引在这里补建目录页并写回目录
+     * @return 加载失败时返回 nullptr
      */
-    QString formatPlan(const PlanNode* node, int indent) const;
+    HashIndex* openHashIndex(Catalog* catalog, BufferPoolManager* bufferPool, const IndexDef& indexDef);
+
+    /**
+     * @brief 用块范围索引按摘要排除数据页（WHERE 中索引列上的范围、等值、IN、IS [NOT] NULL）
+     * @param pages 输出：可能包含匹配行的数据页（按表链表顺序），调用方仍需重新评估 WHERE
+     * @return 是否使用了块范围索引
+     */
+    bool probeBlockRangeIndex(Catalog* catalog, BufferPoolManager* bufferPool, const TableDef* table,
+                              const ast::Expression* where, QVector<PageId>& pages);
+
+    /**
+     * @brief 用哈希索引回答 col = 常量 / col IN (常量, ...)（也可以是 AND 的一侧）
+     * @param rowIds 输出：候选行ID，调用方仍需做可见性检查并重新评估 WHERE
+     * @return 是否使用了哈希索引
+     */
+    bool probeHashIndex(Catalog* catalog, BufferPoolManager* bufferPool, const TableDef* table,
+                        const ast::Expression* where, QSet<RowId>& rowIds);
+
+    /**
+     * @brief 用位图索引回答 AND 连接的 col = 常量 / col IN (常量, ...) 条件
+     *
+     * 每个可用的合取项取一个位图（IN 为各值位图之并），所有合取项的位图求交后才回表。
+     * @param rowIds 输出：候选行ID，调用方仍需做可见性检查并重新评估 WHERE
+     * @return 是否使用了位图索引
+     */
+    bool probeBitmapIndex(Catalog* catalog, BufferPoolManager* bufferPool, const TableDef* table,
+                          const ast::Expression* where, QSet<RowId>& rowIds);
+
+    /**
+     * @brief 用 R 树索引回答 AND 连接的空间谓词：MBRIntersects / ST_Intersects(col, 常量)、
+     *        ST_DWithin(col, 常量, 距离)
+     *
+     * 索引只按外包矩形筛选，调用方仍需做可见性检查并重新评估 WHERE（精确判断）。
+     * @return 是否使用了 R 树索引
+     */
+    bool probeSpatialIndex(Catalog* catalog, BufferPoolManager* bufferPool, const TableDef* table,
+                           const ast::Expression* where, QSet<RowId>& rowIds);
+
+    /**
+     * @brief ORDER BY ST_Distance(col, 常量) [ASC] LIMIT k：用 R 树按距离由近到远取满足 WHERE 的前 k 行
+     *
+     * 与第 k 行距离相同的行也一并返回，排序和 LIMIT 仍照常执行；列可能为 NULL 时不使用。
+     * @return 是否使用了 R 树索引
+     */
+    bool probeNearestNeighbors(Catalog* catalog, BufferPoolManager* bufferPool, const TableDef* table,
+                               const ast::SelectStatement* stmt, QSet<RowId>& rowIds);
+
+    /**
+     * @brief 用 TRIE 索引回答 AND 连接的 col LIKE '前缀%...' / col = '字符串' 条件
+     *
+     * 各合取项的候选行求交；调用方仍需做可见性检查并重新评估 WHERE（LIKE 的其余部分）。
+     * 传入 select 且是不带 ORDER BY 的 LIMIT k 查询时，按键序逐行回表检查，取够 k 行即停。
+     * @return 是否使用了 TRIE 索引
+     */
+    bool probeTrieIndex(Catalog* catalog, BufferPoolManager* bufferPool, const TableDef* table,
+                        const ast::Expression* where, QSet<RowId>& rowIds,
+                        const ast::SelectStatement* select = nullptr);
+
+    /**
+     * @brief 仅索引扫描得到的一行：未被索引覆盖的列为 NULL
+     */
+    struct IndexOnlyRow {
+        RecordHeader header;
+        QVector<QVariant> record;
+    };
+
+    /**
+     * @brief 用复合 B+ 树索引回答 AND 连接的 前 k 列等值 + 第 k+1 列范围 条件
+     * @param rowIds 输出：候选行ID，调用方仍需做可见性检查并重新评估 WHERE
+     * @param requiredColumns 查询用到的列；非空且选中的索引覆盖这些列时改为仅索引扫描
+     * @param indexOnlyRows 输出：仅索引扫描时由索引条目还原的行（此时 rowIds 不再需要回表）
+     * @param indexOnly 输出：是否做了仅索引扫描
+     * @return 是否使用了复合索引（至少用到首列）
+     */
+    bool probeCompositeIndex(Catalog* catalog, BufferPoolManager* bufferPool, const TableDef* table,
+                             const ast::Expression* where, QSet<RowId>& rowIds,
+                             const QSet<int>* requiredColumns = nullptr,
+                             QVector<IndexOnlyRow>* indexOnlyRows = nullptr,
+                             bool* indexOnly = nullptr);
+
+    /**
+     * @brief 通过 RowIdIndex 找出候选行所在的数据页（升序、去重）
+     * @return 所有行都能定位时返回 true，否则调用方应扫描全表并按 rowId 过滤
+     */
+    static bool locateRowPages(const TableDef* table, const QSet<RowId>& rowIds, QVector<PageId>& pages);
 
     bool checkSelectPermissions(const SelectStatement* stmt, QueryResult& errorOut);
 
@@ -324,6 +496,21 @@ private:
     bool queryRewriteEnabled_ = true;       // 是否启用查询重写
     std::unique_ptr<QueryCache> queryCache_;   // 查询缓存
     std::unique_ptr<TableCache> tableCache_;   // 表级内存缓存
+    QHash<QString, std::shared_ptr<InvertedIndex>> pendingFullTextIndexes_;  // 本条语句修改过的全文索引
+    QHash<QString, std::shared_ptr<BlockRangeIndex>> openBlockRangeIndexes_;  // 本条语句打开的块范围索引
+    QHash<QString, std::shared_ptr<BitmapIndex>> pendingBitmapIndexes_;  // 本条语句修改过的位图索引
+    QHash<QString, std::shared_ptr<HashIndex>> openHashIndexes_;  // 本条语句打开的哈希索引
+
+    /**
+     * @brief 尚未计入统计信息的表改动（行数）
+     */
+    struct PendingStatsChange {
+        size_t inserted = 0;
+        size_t deleted = 0;
+        size_t updated = 0;
+    };
+    QHash<QString, PendingStatsChange> pendingStatsChanges_;  // 表名（小写）→ 当前事务的改动
+    bool scanStoppedEarly_ = false;         // 本条 SELECT 的扫描是否取够 LIMIT 行就停止
 };
 
 } // namespace qindb
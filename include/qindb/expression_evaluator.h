@@ -24,6 +24,8 @@ using ast::UnaryOp;
  * - BinaryExpression: Arithmetic and comparison operations
  * - UnaryExpression: Negation, NOT, NULL checks
  * - ColumnExpression: Column references (requires row context)
+ * - FunctionCallExpression: Deterministic scalar functions (LOWER, UPPER, TRIM,
+ *   LENGTH, SUBSTRING, CONCAT, ABS, ROUND, COALESCE, ...)
  */
 class ExpressionEvaluator {
 public:
@@ -60,6 +62,30 @@ public:
      */
     QVector<QVariant> evaluateList(const std::vector<std::unique_ptr<ast::Expression>>& exprs);
 
+    /**
+     * @brief Check whether a function name is a supported scalar function
+     *
+     * All supported scalar functions are deterministic, so they may be used
+     * in index expressions.
+     */
+    static bool isScalarFunction(const QString& name);
+
+    /**
+     * @brief Match a string against a LIKE pattern
+     *
+     * '%' matches any run of characters, '_' matches exactly one, and a
+     * backslash makes the next character literal. Matching is case-sensitive.
+     */
+    static bool matchLike(const QString& value, const QString& pattern);
+
+    /**
+     * @brief Literal prefix of a LIKE pattern (up to the first unescaped wildcard)
+     *
+     * @param exact Optional output: true when the pattern contains no wildcard,
+     *              i.e. LIKE behaves as equality with the returned string
+     */
+    static QString likePrefix(const QString& pattern, bool* exact = nullptr);
+
     /**
      * @brief Get the last error message
      */
@@ -82,6 +108,13 @@ private:
     QVariant evaluateColumn(const ast::ColumnExpression* expr,
                            const TableDef* table,
                            const QVector<QVariant>& row);
+    QVariant evaluateInList(const QVariant& left, const ast::ListExpression* list,
+                           const TableDef* table,
+                           const QVector<QVariant>& row);
+    QVariant evaluateFunction(const ast::FunctionCallExpression* expr,
+                             const TableDef* table,
+                             const QVector<QVariant>& row);
+    QVariant evaluateSpatialFunction(const QString& name, const QVector<QVariant>& args);
 
     // Helper functions for binary operations
     QVariant evaluateArithmetic(const QVariant& left, const QVariant& right,
@@ -6,6 +6,7 @@
 #include "buffer_pool_manager.h"  // 包含缓冲池管理器
 #include "key_comparator.h"      // 包含键比较器
 #include "type_serializer.h"     // 包含类型序列化器
+#include "key_encoder.h"         // 包含保序键编码器
 #include <QVector>        // 包含Qt向量容器
 #include <QPair>          // 包含Qt对容器
 #include <QMutex>         // 包含Qt互斥锁
@@ -17,7 +18,9 @@ namespace qindb {        // 定义qindb命名空间
  *
  * 特性：
  * - 支持所有60+种数据类型作为索引键
- * - 使用变长键存储
+ * - 键以 KeyEncoder 保序编码存储，节点内比较只需一次 memcmp
+ * - 使用变长键存储，节点内公共前缀只存一次（前缀压缩）
+ * - 内部节点分隔键做后缀截断，只保留区分左右子树所需的最短键
  * - 自平衡
  * - 所有数据存储在叶子节点
  * - 叶子节点通过双向链表连接，支持范围查询
@@ -72,6 +75,43 @@ public:
     bool rangeSearch(const QVariant& minKey, const QVariant& maxKey,
                     QVector<QPair<QVariant, RowId>>& results);
 
+    /**
+     * @brief 自底向上批量构建索引
+     *
+     * 先对 (key, rowId) 并行排序，再从左到右按填充因子装满叶子页，
+     * 最后逐层向上构建内部节点。只能用于空树；非空树会退化为逐条插入。
+     * 重复键保留最后出现的值（与 insert 的覆盖语义一致）。
+     *
+     * @param entries 待加载的键值对（可以无序，函数内部会排序）
+     * @param fillFactor 页填充因子，取值会被限制在 [0.5, 1.0]
+     * @return 是否成功
+     */
+    bool bulkLoad(const QVector<QPair<QVariant, RowId>>& entries, double fillFactor = 1.0);
+
+    /**
+     * @brief 插入已编码的键（键已是树内部的格式，不再按 keyType 编码）
+     */
+    bool insertEncoded(const QByteArray& key, RowId value);
+
+    /**
+     * @brief 删除已编码的键
+     */
+    bool removeEncoded(const QByteArray& key);
+
+    /**
+     * @brief 按已编码的键扫描半开区间 [lower, upper)
+     * @param lower 下界（包含），为空表示从最小键开始
+     * @param upper 上界（不包含），为空表示不设上界
+     * @param results 输出参数，(编码后的键, rowId)，按键升序
+     */
+    bool scanEncoded(const QByteArray& lower, const QByteArray& upper,
+                     QVector<QPair<QByteArray, RowId>>& results);
+
+    /**
+     * @brief 用已编码的键自底向上批量构建（语义同 bulkLoad）
+     */
+    bool bulkLoadEncoded(const QVector<QPair<QByteArray, RowId>>& entries, double fillFactor = 1.0);
+
     /**
      * @brief 获取根节点页ID
      */
@@ -82,6 +122,22 @@ public:
      */
     DataType getKeyType() const { return keyType_; }      // 内联函数，获取键的数据类型
 
+    /**
+     * @brief 是否使用保序编码的键（旧格式的树仍使用 TypeSerializer 编码）
+     */
+    bool usesNormalizedKeys() const { return normalizedKeys_; }
+
+    /**
+     * @brief 值槽位的格式标志（BPlusTreePageFlag 中键编码以外的标志，写页时一并写入）
+     */
+    uint8_t valueFormatFlags() const { return valueFlags_; }
+
+    /**
+     * @brief 为空树设置值槽位的格式标志
+     * @return 是否设置成功（已有键的树保持打开时根页上的标志，返回 false）
+     */
+    bool setValueFormatFlags(uint8_t flags);
+
     /**
      * @brief 获取索引统计信息
      */
@@ -95,6 +151,12 @@ public:
 
     Stats getStats() const;  // 获取统计信息
 
+    /**
+     * @brief 按层序取出内部节点中的全部分隔键并解码（调试、测试用）
+     * @return 读页失败或有分隔键不能按 keyType 解码时返回 false
+     */
+    bool getSeparatorKeys(QVector<QVariant>& keys) const;
+
     /**
      * @brief 打印树结构（调试用）
      */
@@ -143,6 +205,10 @@ private:
      */
     PageId findLeafPage(const QByteArray& serializedKey);  // 查找叶子节点
 
+    bool insertSerialized(const QByteArray& serializedKey, RowId value);  // 插入已序列化的键（调用方持锁）
+    bool removeSerialized(const QByteArray& serializedKey);              // 删除已序列化的键（调用方持锁）
+    bool bulkLoadSerialized(QVector<KeyValuePair>& sorted, double fillFactor);  // 对空树批量构建（调用方持锁）
+
     /**
      * @brief 在叶子节点中插入
      */
@@ -151,12 +217,15 @@ private:
     /**
      * @brief 分裂叶子节点
      */
-    bool splitLeafNode(PageId leafPageId, PageId& newLeafPageId, QByteArray& middleKey);  // 分裂叶子节点
+    bool splitLeafNode(PageId leafPageId, const QVector<KeyValuePair>& entries,
+                       PageId& newLeafPageId, QByteArray& middleKey);  // 分裂叶子节点
 
     /**
      * @brief 分裂内部节点
      */
-    bool splitInternalNode(PageId internalPageId, PageId& newInternalPageId, QByteArray& middleKey);  // 分裂内部节点
+    bool splitInternalNode(PageId internalPageId, const QVector<InternalEntry>& entries,
+                           PageId firstChild, PageId& newInternalPageId,
+                           QByteArray& middleKey);  // 分裂内部节点
 
     /**
      * @brief 在父节点中插入
@@ -199,6 +268,31 @@ private:
      */
     bool writeInternalEntries(Page* page, const QVector<InternalEntry>& entries, PageId firstChild);  // 写入内部节点条目
 
+    /**
+     * @brief 键编码中不参与前缀压缩的类型头长度（旧格式的 NULL标志 + 长度字段；保序编码为 0）
+     */
+    int keyHeaderSize() const;
+
+    /**
+     * @brief 计算一组键（去掉类型头后）的最长公共前缀（节点内前缀压缩）
+     */
+    QByteArray computeNodePrefix(const QVector<QByteArray>& keys) const;
+
+    /**
+     * @brief 叶子条目按前缀压缩格式编码后的字节数
+     */
+    size_t encodedLeafSize(const QVector<KeyValuePair>& entries) const;
+
+    /**
+     * @brief 内部节点条目按前缀压缩格式编码后的字节数
+     */
+    size_t encodedInternalSize(const QVector<InternalEntry>& entries) const;
+
+    /**
+     * @brief 后缀截断：计算满足 leftKey < sep <= rightKey 的最短分隔键
+     */
+    QByteArray shortestSeparator(const QByteArray& leftKey, const QByteArray& rightKey);
+
     /**
      * @brief 在叶子节点中查找键的位置
      */
@@ -209,6 +303,20 @@ private:
      */
     int findChildPosition(const QVector<InternalEntry>& entries, const QByteArray& key);
 
+    /**
+     * @brief 按字节预算和键数上限把有序条目划分为若干页
+     * @param itemBytes 每个条目占用的字节数
+     * @param fixedBytes 每页固定开销（计数字段等）
+     * @param targetItems 每页目标条目数（已按填充因子折算）
+     * @param maxItems 每页最多条目数
+     * @param minItems 非根页最少条目数
+     * @param byteBudget 每页目标字节数（已按填充因子折算）
+     * @return 每页的 [start, end) 区间
+     */
+    QVector<QPair<int, int>> planBulkLoadRuns(const QVector<int>& itemBytes, size_t fixedBytes,
+                                              int targetItems, int maxItems, int minItems,
+                                              size_t byteBudget) const;
+
     /**
      * @brief 递归打印树（调试用）
      */
@@ -256,9 +364,9 @@ private:
                                    PageId parentPageId);  // 与右兄弟合并
 
     /**
-     * @brief 从父节点删除键
+     * @brief 从父节点删除指向指定子节点的条目
      */
-    bool deleteKeyFromInternal(PageId internalPageId, const QByteArray& serializedKey);  // 从父节点删除键
+    bool deleteChildFromInternal(PageId internalPageId, PageId childPageId);  // 从父节点删除子节点条目
 
     /**
      * @brief 处理节点下溢（递归）
@@ -281,6 +389,8 @@ private:
     DataType keyType_;                      // 键的数据类型
     PageId rootPageId_;                     // 根节点页ID
     int maxKeysPerPage_;                    // 每页最多键数
+    bool normalizedKeys_;                   // 键是否为保序编码（打开已有树时由根页标志决定）
+    uint8_t valueFlags_;                    // 值槽位的格式标志（打开已有树时由根页标志决定）
     mutable QMutex mutex_;                  // 树级锁
 };
 
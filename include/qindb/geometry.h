@@ -0,0 +1,167 @@
+#ifndef QINDB_GEOMETRY_H
+#define QINDB_GEOMETRY_H
+
+#include <QByteArray>
+#include <QString>
+#include <QVariant>
+#include <QVector>
+#include <cstdint>
+
+namespace qindb {
+
+/**
+ * @brief 平面上的轴对齐矩形（最小外包矩形，MBR）
+ *
+ * R 树的每个条目保存一个外包矩形；点的外包矩形退化为宽高都是 0 的矩形。
+ */
+struct BoundingBox {
+    double minX = 0.0;
+    double minY = 0.0;
+    double maxX = 0.0;
+    double maxY = 0.0;
+
+    BoundingBox() = default;
+    BoundingBox(double x1, double y1, double x2, double y2);
+
+    static BoundingBox ofPoint(double x, double y) { return BoundingBox(x, y, x, y); }
+
+    double area() const { return (maxX - minX) * (maxY - minY); }
+
+    /**
+     * @brief 半周长（R* 树分裂时用来比较矩形的“方正”程度）
+     */
+    double margin() const { return (maxX - minX) + (maxY - minY); }
+
+    double centerX() const { return (minX + maxX) / 2.0; }
+    double centerY() const { return (minY + maxY) / 2.0; }
+
+    /**
+     * @brief 同时包含两个矩形的最小矩形
+     */
+    BoundingBox united(const BoundingBox& other) const;
+
+    /**
+     * @brief 扩大自身以包含 other
+     */
+    void expand(const BoundingBox& other);
+
+    /**
+     * @brief 各边向外扩展 distance
+     */
+    BoundingBox grown(double distance) const;
+
+    /**
+     * @brief 是否相交（边界接触也算相交）
+     */
+    bool intersects(const BoundingBox& other) const;
+
+    bool contains(const BoundingBox& other) const;
+
+    /**
+     * @brief 相交部分的面积（不相交时为 0）
+     */
+    double overlap(const BoundingBox& other) const;
+
+    /**
+     * @brief 两个矩形之间的最短距离（相交时为 0）
+     *
+     * 矩形内任意两点的距离都不小于它，R 树最近邻搜索用它作为子树的距离下界（MINDIST）。
+     */
+    double distanceTo(const BoundingBox& other) const;
+
+    bool operator==(const BoundingBox& other) const;
+    bool operator!=(const BoundingBox& other) const { return !(*this == other); }
+};
+
+/**
+ * @brief 平面上的一个点
+ */
+struct GeoPoint {
+    double x = 0.0;
+    double y = 0.0;
+};
+
+/**
+ * @brief 平面几何对象：POINT、LINESTRING、POLYGON
+ *
+ * GEOMETRY / GEOGRAPHY 列的值在内存中是 WKT 字符串（"POINT(1 2)"、
+ * "POLYGON((0 0, 4 0, 4 4, 0 4, 0 0))"），落盘时存为 WKB。本类负责两种表示之间的转换，
+ * 以及空间函数和 R 树需要的外包矩形、距离计算。坐标按平面直角坐标处理（GEOGRAPHY 也一样）。
+ *
+ * WKB 布局（OGC Simple Features）：字节序(1) 类型(4)，之后
+ * - POINT：x y
+ * - LINESTRING：点数(4) 点...
+ * - POLYGON：环数(4)，每个环为 点数(4) 点...（第一个环是外环，其余是洞）
+ */
+class Geometry {
+public:
+    enum class Type : uint32_t {
+        POINT = 1,
+        LINESTRING = 2,
+        POLYGON = 3
+    };
+
+    Geometry() = default;
+
+    static Geometry point(double x, double y);
+
+    /**
+     * @brief 矩形对应的多边形（逆时针外环，首尾闭合）
+     */
+    static Geometry envelope(const BoundingBox& box);
+
+    /**
+     * @brief 解析 WKT（类型名不区分大小写）
+     * @return 格式错误、点数不足或多边形的环未闭合时返回 false
+     */
+    static bool fromWkt(const QString& wkt, Geometry& out);
+
+    /**
+     * @brief 解析 WKB（两种字节序都支持）
+     */
+    static bool fromWkb(const QByteArray& wkb, Geometry& out);
+
+    /**
+     * @brief 从列值（WKT 字符串）解析
+     */
+    static bool fromValue(const QVariant& value, Geometry& out);
+
+    QString toWkt() const;
+
+    /**
+     * @brief 编码为小端 WKB
+     */
+    QByteArray toWkb() const;
+
+    Type type() const { return type_; }
+
+    /**
+     * @brief 坐标序列：POINT 和 LINESTRING 只有一组，POLYGON 每个环一组
+     */
+    const QVector<QVector<GeoPoint>>& parts() const { return parts_; }
+
+    BoundingBox bounds() const;
+
+    /**
+     * @brief 两个几何对象之间的最短距离（相交或包含时为 0）
+     */
+    double distance(const Geometry& other) const;
+
+    /**
+     * @brief 是否相交（距离为 0）
+     */
+    bool intersects(const Geometry& other) const { return distance(other) == 0.0; }
+
+private:
+    /**
+     * @brief 点是否在多边形内部（奇偶规则，洞内的点不算）；非多边形恒为 false
+     */
+    bool containsPoint(const GeoPoint& p) const;
+
+    Type type_ = Type::POINT;
+    QVector<QVector<GeoPoint>> parts_;
+};
+
+} // namespace qindb
+
+#endif // QINDB_GEOMETRY_H
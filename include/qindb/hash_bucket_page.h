@@ -28,7 +28,7 @@ public:
     // Initialize a new hash bucket page
     static void initialize(Page* page);
 
-    // Insert a key-value pair into the bucket
+    // Insert a key-value pair into the bucket (duplicate keys are allowed)
     // Returns true if successful, false if bucket is full
     static bool insert(Page* page, const QByteArray& key, RowId value);
 
@@ -56,6 +56,14 @@ public:
     // Get the number of entries in this bucket
     static uint32_t getNumEntries(Page* page);
 
+    // Bytes occupied by one entry with the given key size
+    static constexpr size_t entrySize(size_t keySize) {
+        return KEY_SIZE_FIELD + keySize + VALUE_SIZE_FIELD + VALUE_DATA_SIZE;
+    }
+
+    // Usable bytes for entries in one bucket page
+    static constexpr size_t capacity() { return MAX_ENTRY_SPACE; }
+
 private:
     // Header offsets
     static constexpr size_t NUM_ENTRIES_OFFSET = 0;
@@ -4,9 +4,11 @@
 #include "common.h"
 #include "buffer_pool_manager.h"
 #include "type_serializer.h"
+#include "hash_util.h"
 #include <QString>
 #include <QVariant>
 #include <QMutex>
+#include <QVector>
 #include <vector>
 
 namespace qindb {
@@ -18,12 +20,22 @@ namespace qindb {
  * - 等值查询 O(1) 平均时间复杂度
  * - 不支持范围查询
  * - 不支持排序
- * - 使用开链法处理冲突
+ * - 使用线性哈希（Linear Hashing）随数据量增减桶数量
+ *
+ * 线性哈希：
+ * - 桶地址 = hash & (N0 * 2^level - 1)，若小于分裂指针则改用 hash & (N0 * 2^(level+1) - 1)
+ * - 装载率超过 SPLIT_FILL 时分裂分裂指针指向的桶（每次插入最多分裂一个桶），
+ *   装载率低于 MERGE_FILL 时合并最后一个桶（每次删除最多合并一个桶，不少于初始桶数）
+ * - 桶的增长是渐进的，不会出现整体重建，溢出链长度保持在常数级别
  *
  * 存储结构：
- * - 目录页（Directory Page）：存储桶指针数组
+ * - 目录页（Directory Page）：64 字节元数据头 + 桶页ID数组，桶多时链接后续目录页
+ *   元数据：magic、版本、初始桶数、level、分裂指针、桶数、条目数、条目字节数、下一目录页、
+ *   哈希函数编号和种子（旧索引记录为 SHA-256，新索引为带随机种子的 wyhash）
  * - 桶页（Bucket Page）：存储键值对
  * - 溢出页（Overflow Page）：当桶满时链接额外页面
+ *
+ * 旧格式的目录页（只有桶页ID数组）在 setDirectoryPageId() 加载时原地升级。
  */
 class HashIndex {
 public:
@@ -32,12 +44,14 @@ public:
      * @param indexName 索引名称
      * @param keyType 键的数据类型
      * @param bufferPool 缓冲池管理器
-     * @param numBuckets 初始桶数量（必须是2的幂）
+     * @param numBuckets 初始桶数量（必须是2的幂），之后随数据量自动增减
+     * @param hashFunction 新建索引使用的哈希函数（加载已有索引时以目录中记录的为准）
      */
     HashIndex(const QString& indexName,
               DataType keyType,
               BufferPoolManager* bufferPool,
-              uint32_t numBuckets = 256);
+              uint32_t numBuckets = 256,
+              HashFunction hashFunction = HashFunction::WYHASH);
 
     ~HashIndex();
 
@@ -84,9 +98,14 @@ public:
     DataType getKeyType() const { return keyType_; }
 
     /**
-     * @brief 获取桶数量
+     * @brief 获取当前桶数量
+     */
+    uint32_t getNumBuckets() const { return static_cast<uint32_t>(buckets_.size()); }
+
+    /**
+     * @brief 获取哈希函数编号
      */
-    uint32_t getNumBuckets() const { return numBuckets_; }
+    HashFunction getHashFunction() const { return hashFunction_; }
 
     /**
      * @brief 获取目录页ID
@@ -94,9 +113,16 @@ public:
     PageId getDirectoryPageId() const { return directoryPageId_; }
 
     /**
-     * @brief 设置目录页ID（用于加载已存在的索引）
+     * @brief 确保目录页已创建（空表上建索引时也要有目录页写入 Catalog）
+     * @return true 目录页可用
+     */
+    bool ensureDirectory();
+
+    /**
+     * @brief 设置目录页ID并加载目录（用于加载已存在的索引）
+     * @return true 加载成功
      */
-    void setDirectoryPageId(PageId pageId) { directoryPageId_ = pageId; }
+    bool setDirectoryPageId(PageId pageId);
 
     /**
      * @brief 获取索引统计信息
@@ -106,7 +132,12 @@ public:
         uint32_t numEntries;      // 总条目数
         uint32_t numOverflowPages; // 溢出页数量
         double avgBucketSize;     // 平均桶大小
-        double loadFactor;        // 负载因子
+        double loadFactor;        // 负载因子（条目字节数 / 桶页容量）
+        uint32_t level;           // 线性哈希轮次
+        uint32_t splitPointer;    // 下一个要分裂的桶
+        uint32_t maxChainLength;  // 最长的桶链（页数，含桶页本身）
+        double avgChainLength;    // 非空桶的平均链长（页数）
+        uint32_t numDirectoryPages; // 目录页数量
     };
     Statistics getStatistics() const;
 
@@ -114,16 +145,58 @@ private:
     /**
      * @brief 哈希函数
      * @param key 序列化后的键
-     * @return 哈希值（桶索引）
+     * @return 32 位哈希值
      */
     uint32_t hash(const QByteArray& key) const;
 
     /**
-     * @brief 获取或创建桶页
+     * @brief 按线性哈希规则计算桶索引
+     */
+    uint32_t bucketIndexOf(uint32_t hashValue) const;
+
+    /**
+     * @brief 获取桶页
      * @param bucketIndex 桶索引
-     * @return 桶页ID
+     * @param create 桶页不存在时是否创建
+     * @return 桶页ID，不存在且未创建时返回 INVALID_PAGE_ID
+     */
+    PageId getBucketPageId(uint32_t bucketIndex, bool create);
+
+    /**
+     * @brief 把条目插入指定桶（桶页满时追加溢出页）
+     */
+    bool insertIntoBucket(uint32_t bucketIndex, const QByteArray& serializedKey, RowId value);
+
+    /**
+     * @brief 从指定桶链中删除一个条目
+     */
+    bool removeFromBucket(uint32_t bucketIndex, const QByteArray& serializedKey, RowId value);
+
+    /**
+     * @brief 读出一条桶链中的全部条目和页ID（不修改桶链）
+     */
+    bool readChain(PageId firstPageId, std::vector<std::pair<QByteArray, RowId>>& entries,
+                   QVector<PageId>& chainPages);
+
+    /**
+     * @brief 释放一条已从目录中摘下的桶链
      */
-    PageId getBucketPageId(uint32_t bucketIndex);
+    void freeChain(const QVector<PageId>& chainPages);
+
+    /**
+     * @brief 插入后按装载率分裂一个桶
+     */
+    void maybeSplit();
+
+    /**
+     * @brief 删除后按装载率合并一个桶
+     */
+    void maybeMerge();
+
+    /**
+     * @brief 桶页总容量（字节）
+     */
+    double bucketCapacityBytes() const;
 
     /**
      * @brief 创建新的溢出页
@@ -136,6 +209,29 @@ private:
      */
     void initializeDirectory();
 
+    /**
+     * @brief 从目录页加载元数据和桶数组（旧格式原地升级）
+     */
+    bool loadDirectory();
+
+    /**
+     * @brief 把旧格式目录页（只有桶页ID数组）升级为当前格式
+     */
+    bool upgradeLegacyDirectory(Page* dirPage);
+
+    /**
+     * @brief 写回目录页中的元数据
+     *
+     * 桶数、level、分裂指针变化（分裂、合并、建目录）时立即写回；插入和删除只改条目计数，
+     * 标记为脏，析构时写回一次
+     */
+    bool writeMetadata();
+
+    /**
+     * @brief 写回目录中的一个桶页ID（需要时追加目录页）
+     */
+    bool writeBucketSlot(uint32_t bucketIndex);
+
     /**
      * @brief 序列化键
      */
@@ -145,9 +241,21 @@ private:
     QString indexName_;           // 索引名称
     DataType keyType_;            // 键的数据类型
     BufferPoolManager* bufferPool_; // 缓冲池管理器
-    uint32_t numBuckets_;         // 桶数量
-    PageId directoryPageId_;      // 目录页ID
+    HashFunction hashFunction_;   // 哈希函数编号
+    uint64_t hashSeed_;           // 哈希种子
+    uint32_t initialBuckets_;     // 初始桶数量 N0（2 的幂）
+    uint32_t level_;              // 线性哈希轮次
+    uint32_t splitPointer_;       // 下一个要分裂的桶
+    uint64_t numEntries_;         // 总条目数
+    uint64_t entryBytes_;         // 全部条目占用的字节数（用于计算装载率）
+    QVector<PageId> buckets_;     // 桶页ID数组（目录的内存副本）
+    QVector<PageId> directoryPages_; // 目录页链
+    PageId directoryPageId_;      // 目录页ID（第一个目录页，保存元数据）
+    bool metadataDirty_;          // 条目计数已变但还没写回目录页
     mutable QMutex mutex_;        // 线程安全互斥锁
+
+    static constexpr double SPLIT_FILL = 0.75;   // 装载率高于此值时分裂
+    static constexpr double MERGE_FILL = 0.25;   // 装载率低于此值时合并
 };
 
 } // namespace qindb
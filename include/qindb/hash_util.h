@@ -0,0 +1,72 @@
+#ifndef QINDB_HASH_UTIL_H
+#define QINDB_HASH_UTIL_H
+
+#include <QByteArray>
+#include <cstddef>
+#include <cstdint>
+
+namespace qindb {
+
+/**
+ * @brief 哈希函数编号（写入哈希索引元数据，决定桶的分布，不能随意修改）
+ */
+enum class HashFunction : uint32_t {
+    SHA256 = 0,   // SHA-256 取前 4 字节（旧版索引）
+    WYHASH = 1    // 带种子的 wyhash（默认）
+};
+
+/**
+ * @brief 通用哈希工具 - 供哈希索引、哈希连接、哈希聚合共用
+ *
+ * 使用 wyhash（final 版本的算法，公有领域）：
+ * - 每 8 字节只需一次 64x64→128 位乘法，短键（索引键通常 < 32 字节）只有几纳秒
+ * - 带种子：磁盘上的索引把种子写入元数据，内存中的哈希表可以为每次查询取随机种子
+ * - 结果与平台无关（按小端读取），可以持久化
+ *
+ * 对于这么短的输入，标量的 128 位乘法已经比 SIMD 的加载/归约开销更低，因此没有单独的 SIMD 路径。
+ */
+class HashUtil {
+public:
+    static constexpr uint64_t DEFAULT_SEED = 0x9E3779B97F4A7C15ULL;
+
+    /**
+     * @brief 计算字节串的 64 位哈希
+     * @param data 数据
+     * @param len 长度（字节）
+     * @param seed 种子
+     */
+    static uint64_t hashBytes(const void* data, size_t len, uint64_t seed = DEFAULT_SEED);
+
+    static uint64_t hashBytes(const QByteArray& data, uint64_t seed = DEFAULT_SEED) {
+        return hashBytes(data.constData(), static_cast<size_t>(data.size()), seed);
+    }
+
+    /**
+     * @brief 计算单个 64 位整数的哈希（整数连接键的快速路径）
+     */
+    static uint64_t hashInt(uint64_t value, uint64_t seed = DEFAULT_SEED);
+
+    /**
+     * @brief 合并两个哈希值（多列键）
+     */
+    static uint64_t combine(uint64_t h1, uint64_t h2);
+
+    /**
+     * @brief 按指定的哈希函数计算 32 位哈希（哈希索引的桶地址）
+     */
+    static uint32_t hash32(HashFunction function, const QByteArray& data, uint64_t seed);
+
+    /**
+     * @brief 检查哈希函数编号是否可识别
+     */
+    static bool isKnownFunction(uint32_t id);
+
+    /**
+     * @brief 生成随机种子
+     */
+    static uint64_t randomSeed();
+};
+
+} // namespace qindb
+
+#endif // QINDB_HASH_UTIL_H
@@ -0,0 +1,80 @@
+#ifndef QINDB_HYPERLOGLOG_H
+#define QINDB_HYPERLOGLOG_H
+
+#include "qindb/common.h"
+#include <QByteArray>
+#include <QVariant>
+#include <cstdint>
+
+namespace qindb {
+
+/**
+ * @brief HyperLogLog 基数估计草图：用固定大小的内存估计一列的不同值个数
+ *
+ * 2^precision 个寄存器（每个一字节）。64 位哈希的高 precision 位选寄存器，
+ * 其余位的前导零个数 + 1 作为秩，寄存器保存见过的最大秩。估计值用调和平均公式，
+ * 估计值较小且还有空寄存器时改用线性计数。标准误差约 1.04 / sqrt(2^precision)，
+ * precision = 12 时约 1.6%、占 4 KB。
+ *
+ * 两个草图按寄存器取最大值即可合并（并集的基数），哈希与平台无关，寄存器可以持久化。
+ */
+class HyperLogLog {
+public:
+    static constexpr int MIN_PRECISION = 4;
+    static constexpr int MAX_PRECISION = 16;
+    static constexpr int DEFAULT_PRECISION = 12;
+
+    explicit HyperLogLog(int precision = DEFAULT_PRECISION);
+
+    /**
+     * @brief 值的 64 位哈希：整数和整数值的浮点数哈希相同，其余类型按字符串表示
+     */
+    static uint64_t hashValue(const QVariant& value, DataType type);
+
+    /**
+     * @brief 加入一个哈希值
+     */
+    void add(uint64_t hash);
+
+    /**
+     * @brief 加入一个值（NULL 不计入）
+     */
+    void addValue(const QVariant& value, DataType type);
+
+    /**
+     * @brief 合并另一个草图（精度不同时返回 false）
+     */
+    bool merge(const HyperLogLog& other);
+
+    /**
+     * @brief 估计加入过的不同值个数
+     */
+    double estimate() const;
+
+    int precision() const { return precision_; }
+
+    /**
+     * @brief 降低精度：相邻的寄存器折叠成一个，结果与直接用低精度加入同样的值相同
+     *
+     * 精度不低于当前精度时原样返回
+     */
+    HyperLogLog reduced(int precision) const;
+
+    /**
+     * @brief 寄存器内容（用于持久化）
+     */
+    const QByteArray& registers() const { return registers_; }
+
+    /**
+     * @brief 从持久化的寄存器恢复草图（长度必须是 2^precision）
+     */
+    static bool fromRegisters(const QByteArray& registers, HyperLogLog& sketch);
+
+private:
+    int precision_;
+    QByteArray registers_;
+};
+
+} // namespace qindb
+
+#endif // QINDB_HYPERLOGLOG_H
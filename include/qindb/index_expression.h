@@ -0,0 +1,90 @@
+#ifndef QINDB_INDEX_EXPRESSION_H
+#define QINDB_INDEX_EXPRESSION_H
+
+#include "qindb/ast.h"
+#include "qindb/catalog.h"
+#include <QSet>
+#include <QString>
+#include <QVector>
+#include <memory>
+
+namespace qindb {
+
+/**
+ * @brief 表达式索引与部分索引的辅助函数
+ *
+ * 索引表达式和部分索引谓词在目录中保存为规范化 SQL 文本：
+ * - 列名、函数名小写，去掉表名前缀，函数别名统一（LCASE -> lower、SUBSTR -> substring 等）
+ * - 字符串加引号转义，二元/一元运算整体加括号
+ * 因此两个语义相同的写法（lower(Email) 与 LCASE(t.email)）得到同一段文本，
+ * 查询谓词与索引表达式的匹配只需比较文本。文本可以被 Parser 重新解析。
+ */
+class IndexExpression {
+public:
+    /**
+     * @brief 生成规范化 SQL 文本
+     */
+    static QString toSql(const ast::Expression* expr);
+
+    /**
+     * @brief 解析规范化 SQL 文本
+     * @return 解析失败返回 nullptr
+     */
+    static std::unique_ptr<ast::Expression> parse(const QString& sql);
+
+    /**
+     * @brief 解析并缓存（同一索引定义在每条 DML/查询中都要用到，避免重复解析）
+     * @return 解析失败返回 nullptr
+     */
+    static std::shared_ptr<const ast::Expression> parseCached(const QString& sql);
+
+    /**
+     * @brief 表达式能否用于索引键或部分索引谓词
+     *
+     * 只允许字面值、本表的列、算术/比较/逻辑运算、IN 列表和确定性的标量函数；
+     * 聚合、子查询、MATCH、CASE 等不允许。
+     * @param error 不可用时写入原因
+     */
+    static bool isIndexable(const ast::Expression* expr, const TableDef& table, QString* error);
+
+    /**
+     * @brief 推断表达式结果的数据类型（用作索引键类型）
+     */
+    static DataType inferType(const ast::Expression* expr, const TableDef& table);
+
+    /**
+     * @brief 收集表达式引用的列下标
+     * @return false 表达式无法只靠列值求出（聚合、子查询、MATCH、* 或未知列）
+     */
+    static bool collectReferencedColumns(const ast::Expression* expr, const TableDef* table, QSet<int>& columns);
+
+    /**
+     * @brief 识别 left.col = right.col 形式的等值连接条件（两种写法都接受）
+     *
+     * 列的限定名（如果有）必须与表名或别名一致，且表中有这一列
+     * @param leftColumnIndex 输出：左表连接列的下标
+     * @param rightColumnIndex 输出：右表连接列的下标
+     */
+    static bool matchEquiJoinColumns(const ast::Expression* condition,
+                                     const ast::TableReference* leftRef, const TableDef* leftTable,
+                                     const ast::TableReference* rightRef, const TableDef* rightTable,
+                                     int& leftColumnIndex, int& rightColumnIndex);
+
+    /**
+     * @brief 把 AND 连接的条件拆成合取项
+     */
+    static void splitConjuncts(const ast::Expression* expr, QVector<const ast::Expression*>& conjuncts);
+
+    /**
+     * @brief 查询条件 where 是否蕴含部分索引谓词 predicate
+     *
+     * predicate 的每个合取项都必须被 where 的某个合取项蕴含：
+     * 文本相同；或同一表达式上的范围包含（如 x > 10 蕴含 x > 5、x = 3 蕴含 x <> 4）；
+     * 或 x 上的任意比较蕴含 x IS NOT NULL。
+     */
+    static bool implies(const ast::Expression* where, const ast::Expression* predicate);
+};
+
+} // namespace qindb
+
+#endif // QINDB_INDEX_EXPRESSION_H
@@ -0,0 +1,64 @@
+#ifndef QINDB_INT_KEY_SEARCH_H
+#define QINDB_INT_KEY_SEARCH_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace qindb {
+
+/**
+ * @brief 整数键节点内查找
+ *
+ * 直接在页内的定长条目数组上查找（键为 int64_t，条目步长为 stride 字节），
+ * 不需要先把条目复制到 QVector：
+ * - 先用无分支二分把范围缩小到一个小窗口（几个缓存行）
+ * - 再在窗口内做比较计数；CPU 支持 AVX2 时使用 cmpgt + movemask 一次比较多个键
+ *
+ * AVX2 路径在运行时检测，编译时不需要额外的 -mavx2 选项。
+ * 键数组必须按升序排列。
+ */
+class IntKeySearch {
+public:
+    /**
+     * @brief 第一个 >= key 的位置（即 < key 的键的个数）
+     * @param base 第一个键的地址
+     * @param count 键的个数
+     * @param stride 相邻两个键之间的字节数（>= 8）
+     * @param key 要查找的键
+     */
+    static int lowerBound(const char* base, int count, size_t stride, int64_t key);
+
+    /**
+     * @brief 第一个 > key 的位置（即 <= key 的键的个数）
+     */
+    static int upperBound(const char* base, int count, size_t stride, int64_t key);
+
+    /**
+     * @brief 纯标量实现的 lowerBound（普通二分查找，用于对比测试和基准测试）
+     */
+    static int lowerBoundScalar(const char* base, int count, size_t stride, int64_t key);
+
+    /**
+     * @brief 纯标量实现的 upperBound
+     */
+    static int upperBoundScalar(const char* base, int count, size_t stride, int64_t key);
+
+    /**
+     * @brief 当前 CPU 是否启用了 AVX2 路径
+     */
+    static bool isAvx2Enabled();
+
+    /**
+     * @brief 允许或禁止使用 AVX2 路径（默认允许；禁止后窗口内改用标量计数，用于对比测试）
+     */
+    static void setAvx2Allowed(bool allowed);
+
+    /**
+     * @brief 读取第 index 个键
+     */
+    static int64_t keyAt(const char* base, size_t stride, int index);
+};
+
+} // namespace qindb
+
+#endif // QINDB_INT_KEY_SEARCH_H
@@ -4,11 +4,15 @@
 #include "qindb/common.h"
 #include "qindb/tokenizer.h"
 #include "qindb/buffer_pool_manager.h"
+#include "qindb/inverted_segment.h"
 #include <QString>
 #include <QMap>
 #include <QVector>
 #include <QPair>
 #include <QMutex>
+#include <QHash>
+#include <memory>
+#include <vector>
 
 namespace qindb {
 
@@ -20,7 +24,7 @@ namespace qindb {
 struct Posting {
     RowId docId;        // 文档ID（行ID），唯一标识一个文档
     uint32_t tf;        // 词频（Term Frequency），表示该词在文档中出现的次数
-    QVector<uint32_t> positions;  // 词在文档中的位置（可选，用于短语查询）
+    QVector<uint32_t> positions;  // 词在文档中的位置（分词结果中的下标，升序，个数等于 tf）
 
     Posting() : docId(INVALID_ROW_ID), tf(0) {}
     Posting(RowId id, uint32_t frequency) : docId(id), tf(frequency) {}
@@ -45,7 +49,7 @@ struct PostingList {
  */
 struct SearchResult {
     RowId docId;        // 文档ID
-    double score;       // 相关性得分（TF-IDF）
+    double score;       // 相关性得分（BM25）
 
     SearchResult() : docId(INVALID_ROW_ID), score(0.0) {}
     SearchResult(RowId id, double s) : docId(id), score(s) {}
@@ -60,9 +64,28 @@ struct SearchResult {
  *
  * 支持：
  * - 全文搜索
- * - TF-IDF 相关性排序
+ * - BM25 相关性排序（k1 = BM25_K1，b = BM25_B）
+ * - 带 limit 的 OR 查询使用 Block-Max WAND 动态剪枝：
+ *   每个倒排列表（以及列表中的每个块）都有得分上界，只对可能进入前 k 名的文档完整打分，
+ *   其余的块只读块头就整块跳过
  * - 布尔查询（AND, OR, NOT）
- * - 短语查询（可选）
+ * - 短语查询和 NEAR/k 邻近查询（基于倒排项中的词位置，见 searchMatch）
+ *
+ * 存储结构（段式，类似 LSM）：
+ * - 新插入的文档先进入内存缓冲区，flush() 或缓冲的倒排项超过 FLUSH_THRESHOLD 时写成一个不可变的段
+ * - 段通过缓冲池持久化：按词项排序的词典 + 增量/变长整数编码的分块倒排列表 + 文档表，
+ *   打开索引时只把稀疏采样点读入内存，查询时逐块流式读取倒排列表，内存占用与索引大小无关
+ * - 删除只在段的删除集中标记，更新 = 删除 + 插入
+ * - 存活文档少于 SMALL_SEGMENT_DOCS 的小段（每条 DML 语句刷出一个）在刷新时立即并成一个，
+ *   段数不随语句数增长；段数超过 MAX_SEGMENTS 时把最小的 MERGE_FACTOR 个段合并为一个（分层合并），
+ *   删除超过一半的段单独重写，合并时真正丢弃已删除的文档
+ * - 被合并掉的旧段等元数据页改为引用新段并写盘之后才释放
+ * - 元数据页（rootPageId）：magic、版本、段数、下一段编号、文档数、总词数 + 段描述数组
+ *
+ * 文档频率 df 直接取各段词典中的倒排项数（与 Lucene 一样包含尚未合并掉的已删除文档），
+ * 这样查询前不需要扫描倒排列表就能算出 IDF 和得分上界。
+ *
+ * bufferPool 为空时只在内存中工作（不会写出段）。
  */
 class InvertedIndex {
 public:
@@ -104,13 +127,16 @@ public:
     /**
      * @brief 全文搜索（单词查询）
      * @param query 查询词
-     * @param limit 返回结果数量限制（0表示无限制）
+     * @param limit 返回结果数量限制（0表示无限制，大于 0 时走 top-k 剪枝）
      * @return 搜索结果（按相关性得分降序排列）
      */
     QVector<SearchResult> search(const QString& query, int limit = 0);
 
     /**
      * @brief 全文搜索（多词查询，AND 模式）
+     *
+     * 从文档频率最小的词开始得到有序候选集，之后每个词只在候选所在的块上求交：
+     * 段内用跳表和块头定位块，块内用 PostingIntersection（galloping / AVX2）求交。
      * @param queryTerms 查询词列表
      * @param limit 返回结果数量限制
      * @return 搜索结果（按相关性得分降序排列）
@@ -120,23 +146,49 @@ public:
     /**
      * @brief 全文搜索（多词查询，OR 模式）
      * @param queryTerms 查询词列表
-     * @param limit 返回结果数量限制
+     * @param limit 返回结果数量限制（大于 0 时使用 Block-Max WAND 只求前 limit 名）
      * @return 搜索结果（按相关性得分降序排列）
      */
     QVector<SearchResult> searchOr(const QStringList& queryTerms, int limit = 0);
 
     /**
-     * @brief 计算 TF-IDF 得分
+     * @brief 执行 MATCH ... AGAINST 的查询串
+     *
+     * 查询语法：
+     * - 普通词：自然语言模式下任意一个匹配即可（OR），布尔模式下必须全部匹配（AND）
+     * - "短语"：短语中的词必须按顺序相邻出现（停用词在分词时已去掉，不占位置）
+     * - a NEAR/k b：两个词的位置相距不超过 k（先后不限），可以连写 a NEAR/2 b NEAR/5 c；
+     *   只写 NEAR 时 k = DEFAULT_NEAR_DISTANCE，操作数是短语时取短语中靠近 NEAR 的那个词
+     *
+     * 短语和 NEAR 在两种模式下都是必须满足的条件：先按文档求交得到含有这些词的候选，
+     * 再只对候选文档读取词位置做匹配。查询中没有短语和 NEAR 时不读取任何位置数据。
+     * @param query 查询串
+     * @param booleanMode 是否为 IN BOOLEAN MODE
+     * @param limit 返回结果数量限制（0表示无限制）
+     * @return 搜索结果（按相关性得分降序排列）
+     */
+    QVector<SearchResult> searchMatch(const QString& query, bool booleanMode, int limit = 0);
+
+    /**
+     * @brief 短语查询：分词后的词项按顺序相邻出现的文档
+     * @param phrase 短语文本
+     * @param limit 返回结果数量限制（0表示无限制）
+     * @return 搜索结果（按相关性得分降序排列）
+     */
+    QVector<SearchResult> searchPhrase(const QString& phrase, int limit = 0);
+
+    /**
+     * @brief 计算词项对文档的 BM25 得分（沿用旧名称）
      * @param term 词项
      * @param docId 文档ID
-     * @return TF-IDF 得分
+     * @return BM25 得分，文档不含该词时为 0
      */
     double calculateTfIdf(const QString& term, RowId docId);
 
     /**
      * @brief 获取词项的文档频率
      * @param term 词项
-     * @return 文档频率（包含该词的文档数量）
+     * @return 文档频率（包含该词的文档数量，含尚未合并掉的已删除文档）
      */
     uint32_t getDocumentFrequency(const QString& term) const;
 
@@ -145,14 +197,29 @@ public:
      */
     uint32_t getTotalDocuments() const { return totalDocuments_; }
 
+    /**
+     * @brief 把内存缓冲区写成新段并持久化删除标记和元数据
+     * @return true if 成功
+     */
+    bool flush();
+
+    /**
+     * @brief 把所有段合并成一个（同时丢弃已删除的文档）
+     * @return true if 成功
+     */
+    bool compact();
+
     /**
      * @brief 获取索引统计信息
      */
     struct Statistics {
-        uint32_t numTerms;          // 词项数量
+        uint32_t numTerms;          // 词项数量（各段与缓冲区之和，跨段重复的词项会重复计数）
         uint32_t numDocuments;      // 文档数量
-        uint32_t totalPostings;     // 总倒排项数量
+        uint32_t totalPostings;     // 总倒排项数量（含尚未合并掉的已删除文档）
         double avgDocLength;        // 平均文档长度
+        uint32_t numSegments;       // 磁盘段数量
+        uint32_t numDeletedDocuments; // 已标记删除、等待合并的文档数
+        uint32_t numBufferedDocuments; // 内存缓冲区中的文档数
     };
     Statistics getStatistics() const;
 
@@ -162,55 +229,154 @@ public:
     PageId getRootPageId() const { return rootPageId_; }
 
     /**
-     * @brief 设置根页面ID（用于加载索引）
+     * @brief 设置根页面ID并加载段元数据（用于加载索引）
+     * @return true if 加载成功（pageId 为 INVALID_PAGE_ID 时为空索引）
      */
-    void setRootPageId(PageId pageId) { rootPageId_ = pageId; }
+    bool setRootPageId(PageId pageId);
 
 private:
     /**
-     * @brief 计算 TF（词频）
+     * @brief 位置约束：短语（词项依次相邻），或两个词项相距不超过 distance 的 NEAR
+     */
+    struct ProximityClause {
+        QStringList terms;
+        bool phrase;
+        uint32_t distance;
+    };
+
+    /**
+     * @brief 计算 BM25 的词频部分：tf * (k1 + 1) / (tf + k1 * (1 - b + b * docLength / avgdl))
      * @param tf 词在文档中出现的次数
      * @param docLength 文档总词数
-     * @return TF 得分
+     * @return 词频得分（对 tf 单调递增，对 docLength 单调递减）
      */
     double calculateTF(uint32_t tf, uint32_t docLength) const;
 
     /**
-     * @brief 计算 IDF（逆文档频率）
+     * @brief 计算 BM25 的 IDF：log(1 + (N - df + 0.5) / (df + 0.5))
      * @param df 文档频率
-     * @return IDF 得分
+     * @return IDF 得分（df 不超过 N 时恒为正）
      */
     double calculateIDF(uint32_t df) const;
 
     /**
-     * @brief 获取文档的词项频率映射
-     * @param docId 文档ID
-     * @return 词项 -> 词频映射
+     * @brief 文档频率：缓冲区中的 df 加各段词典中的倒排项数
+     */
+    uint32_t documentFrequency(const QString& term) const;
+
+    bool insertLocked(RowId docId, const QString& text);
+    bool removeLocked(RowId docId);
+    bool flushLocked();
+
+    /**
+     * @brief 收集词项在缓冲区和各段中未删除的倒排项，得到 文档ID -> 词频得分（未乘 IDF）
+     */
+    QHash<RowId, double> collectTermScores(const QString& term) const;
+
+    /**
+     * @brief AND 语义的文档级求交：按文档频率从小到大处理词项
+     * @param candidates 输出含有全部词项的文档ID（升序）
+     * @param scores 输出对应的 BM25 得分
+     */
+    void matchAllTerms(const QStringList& queryTerms, QVector<RowId>& candidates, QVector<double>& scores) const;
+
+    /**
+     * @brief 候选集（有序文档ID）与词项的倒排列表求交，命中的候选累加该词的得分
+     */
+    void intersectTerm(const QString& term, double idf, const QVector<RowId>& candidates,
+                       QVector<double>& contributions, QVector<bool>& matched) const;
+
+    /**
+     * @brief 把查询串拆成普通词项和位置约束
+     */
+    void parseMatchQuery(const QString& query, QStringList& plainTerms, QVector<ProximityClause>& clauses) const;
+
+    /**
+     * @brief 含位置约束的查询：requiredTerms 文档级求交后逐个约束过滤，optionalTerms 只加分
+     */
+    QVector<SearchResult> searchProximity(const QStringList& requiredTerms, const QVector<ProximityClause>& clauses,
+                                          const QStringList& optionalTerms, int limit) const;
+
+    /**
+     * @brief 读取候选文档中约束词项的位置，去掉不满足约束的候选
+     */
+    void filterByProximity(const ProximityClause& clause, QVector<RowId>& candidates, QVector<double>& scores) const;
+
+    /**
+     * @brief Block-Max WAND：OR 语义的前 limit 名，结果与穷举打分后截断完全一致
+     */
+    QVector<SearchResult> searchTopK(const QStringList& queryTerms, int limit) const;
+
+    /**
+     * @brief 查找文档所在的段（只看未删除的）
+     * @return 段下标，不存在时返回 -1
+     */
+    int findSegmentOf(RowId docId, uint32_t& docLength) const;
+
+    /**
+     * @brief 把缓冲区写成一个段
      */
-    QMap<QString, uint32_t> getDocumentTerms(RowId docId) const;
+    bool writeBufferSegment();
 
     /**
-     * @brief 合并搜索结果（用于 OR 查询）
+     * @brief 按分层策略合并段
      */
-    QVector<SearchResult> mergeResults(const QVector<QVector<SearchResult>>& resultSets);
+    bool maybeMerge();
 
     /**
-     * @brief 交集搜索结果（用于 AND 查询）
+     * @brief 把指定的段合并成一个新段（旧段移入 retiredSegments_，由 writeMeta 释放）
      */
-    QVector<SearchResult> intersectResults(const QVector<QVector<SearchResult>>& resultSets);
+    bool mergeSegments(QVector<int> indices);
+
+    /**
+     * @brief 确保元数据页已分配
+     */
+    bool ensureMetaPage();
+
+    bool loadMeta();
+
+    /**
+     * @brief 写元数据页；有被合并掉的旧段时先把元数据页写盘再释放它们
+     */
+    bool writeMeta();
+
+    /**
+     * @brief 按得分排序并截断
+     */
+    static QVector<SearchResult> rankResults(QVector<SearchResult> results, int limit);
 
     QString indexName_;                         // 索引名称
     BufferPoolManager* bufferPool_;             // 缓冲池管理器
     Tokenizer* tokenizer_;                      // 分词器
     bool ownTokenizer_;                         // 是否拥有分词器（需要释放）
 
-    // 倒排索引数据结构（内存中）
+    // 内存缓冲区（尚未写成段的文档）
     QMap<QString, PostingList> index_;          // 词项 -> 倒排列表
     QMap<RowId, uint32_t> docLengths_;          // 文档ID -> 文档长度
-    uint32_t totalDocuments_;                   // 总文档数
-
-    PageId rootPageId_;                         // 根页面ID（预留，用于持久化）
+    QHash<RowId, QStringList> docTerms_;        // 文档ID -> 词项（用于从缓冲区删除）
+    uint64_t bufferedPostings_;                 // 缓冲区中的倒排项数
+    QString foldedText_;                        // 分词用的归一化文本（跨插入复用）
+    QVector<Tokenizer::TokenSpan> tokenSpans_;  // 分词结果（跨插入复用）
+
+    std::vector<std::unique_ptr<InvertedSegment>> segments_;  // 磁盘段
+    std::vector<std::unique_ptr<InvertedSegment>> retiredSegments_;  // 已被合并、元数据页仍可能引用的旧段
+    uint32_t nextSegmentId_;                    // 下一个段编号
+    uint32_t totalDocuments_;                   // 总文档数（未删除的）
+    uint64_t totalLength_;                      // 未删除文档的总词数
+
+    PageId rootPageId_;                         // 元数据页ID
     mutable QMutex mutex_;                      // 线程安全锁
+
+    static constexpr uint32_t META_MAGIC = 0x564E4951;      // "QINV"
+    static constexpr uint32_t META_VERSION = 4;              // 2：块头和词典带得分上界；3：倒排列表带跳表；4：词位置流
+    static constexpr size_t META_HEADER_SIZE = 64;
+    static constexpr uint64_t FLUSH_THRESHOLD = 1u << 18;    // 缓冲区倒排项上限
+    static constexpr int MAX_SEGMENTS = 8;
+    static constexpr int MERGE_FACTOR = 4;
+    static constexpr uint32_t SMALL_SEGMENT_DOCS = 1024;    // 存活文档数低于此值的段立即合并
+    static constexpr double BM25_K1 = 1.2;
+    static constexpr double BM25_B = 0.75;
+    static constexpr uint32_t DEFAULT_NEAR_DISTANCE = 10;
 };
 
 } // namespace qindb
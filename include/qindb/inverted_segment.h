@@ -0,0 +1,473 @@
+#ifndef QINDB_INVERTED_SEGMENT_H
+#define QINDB_INVERTED_SEGMENT_H
+
+#include "qindb/common.h"
+#include "qindb/buffer_pool_manager.h"
+#include <QByteArray>
+#include <QString>
+#include <QVector>
+#include <QPair>
+#include <QSet>
+
+namespace qindb {
+
+/**
+ * @brief 变长整数编码（LEB128：每字节 7 位数据，最高位为续位标志）
+ */
+class Varint {
+public:
+    /**
+     * @brief 把整数编码后追加到缓冲区
+     */
+    static void append(QByteArray& out, uint64_t value);
+
+    /**
+     * @brief 从 [p, end) 解码一个整数，成功时 p 前移
+     * @return false 数据被截断或超过 64 位
+     */
+    static bool decode(const char*& p, const char* end, uint64_t& value);
+};
+
+/**
+ * @brief 页链字节流中的位置
+ */
+struct StreamPos {
+    PageId pageId;      // 所在页
+    uint16_t offset;    // 页内偏移（含页头）
+
+    StreamPos() : pageId(INVALID_PAGE_ID), offset(0) {}
+    StreamPos(PageId id, uint16_t off) : pageId(id), offset(off) {}
+
+    bool isValid() const { return pageId != INVALID_PAGE_ID; }
+};
+
+/**
+ * @brief 页链字节流写入器
+ *
+ * 字节流由同一类型的页（默认 INVERTED_INDEX_PAGE）通过 nextPageId 串成链，
+ * 每页在 PageHeader 之后存放数据，header.freeSpaceOffset 记录已用到的位置。
+ * 写入时只固定当前页，写满后追加新页。
+ */
+class PageStreamWriter {
+public:
+    explicit PageStreamWriter(BufferPoolManager* bufferPool, PageType pageType = PageType::INVERTED_INDEX_PAGE);
+    ~PageStreamWriter();
+
+    PageStreamWriter(const PageStreamWriter&) = delete;
+    PageStreamWriter& operator=(const PageStreamWriter&) = delete;
+
+    /**
+     * @brief 追加字节
+     */
+    bool write(const char* data, int len);
+    bool write(const QByteArray& data) { return write(data.constData(), static_cast<int>(data.size())); }
+
+    /**
+     * @brief 下一个字节将写入的位置（流为空时先分配第一页）
+     */
+    StreamPos position();
+
+    /**
+     * @brief 第一页ID（未写入任何数据时为 INVALID_PAGE_ID）
+     */
+    PageId firstPageId() const { return firstPageId_; }
+
+    /**
+     * @brief 解除当前页的固定，写入结束后调用（析构时自动调用）
+     */
+    void finish();
+
+private:
+    bool appendPage();
+
+    BufferPoolManager* bufferPool_;
+    PageType pageType_;
+    PageId firstPageId_;
+    PageId currentPageId_;
+    Page* currentPage_;
+    int offset_;
+};
+
+/**
+ * @brief 页链字节流读取器（同一时刻只固定一页）
+ */
+class PageStreamReader {
+public:
+    explicit PageStreamReader(BufferPoolManager* bufferPool, StreamPos start = StreamPos(),
+                              PageType pageType = PageType::INVERTED_INDEX_PAGE);
+    ~PageStreamReader();
+
+    PageStreamReader(const PageStreamReader&) = delete;
+    PageStreamReader& operator=(const PageStreamReader&) = delete;
+
+    /**
+     * @brief 定位到指定位置
+     */
+    bool seek(StreamPos pos);
+
+    /**
+     * @brief 读取 len 个字节
+     */
+    bool read(char* out, int len);
+
+    /**
+     * @brief 读取一个变长整数
+     */
+    bool readVarint(uint64_t& value);
+
+    /**
+     * @brief 读取 UTF-8 字符串（长度前缀为变长整数）
+     */
+    bool readString(QString& value);
+
+    /**
+     * @brief 跳过 len 个字节（不复制）
+     */
+    bool skip(int len);
+
+    /**
+     * @brief 当前位置
+     */
+    StreamPos position() const { return StreamPos(pageId_, static_cast<uint16_t>(offset_)); }
+
+private:
+    bool loadPage(PageId pageId);
+    bool ensureData();
+    void release();
+
+    BufferPoolManager* bufferPool_;
+    PageType pageType_;
+    PageId pageId_;
+    Page* page_;
+    int offset_;
+    int used_;
+};
+
+/**
+ * @brief 倒排索引段的元数据（保存在倒排索引的元数据页中）
+ */
+struct InvertedSegmentMeta {
+    uint32_t segmentId;         // 段编号（递增）
+    uint32_t numDocs;           // 段内文档数（含已标记删除的）
+    uint32_t numDeleted;        // 已标记删除的文档数
+    uint32_t numTerms;          // 词项数
+    uint64_t numPostings;       // 倒排项数
+    uint64_t totalLength;       // 段内全部文档的总词数（含已删除的）
+    RowId minDocId;             // 最小文档ID
+    RowId maxDocId;             // 最大文档ID
+    PageId dictPageId;          // 词典流
+    PageId postingsPageId;      // 倒排流
+    PageId docsPageId;          // 文档表流
+    PageId skipPageId;          // 稀疏词项/文档索引流
+    PageId deletesPageId;       // 删除集流（没有删除时为 INVALID_PAGE_ID）
+    PageId positionsPageId;     // 词位置流
+
+    static constexpr size_t DISK_SIZE = 72;
+
+    InvertedSegmentMeta();
+
+    void serialize(char* out) const;
+    static InvertedSegmentMeta deserialize(const char* in);
+};
+
+/**
+ * @brief 词典条目
+ */
+struct TermInfo {
+    QString term;               // 词项
+    uint32_t numPostings;       // 倒排项数（含已删除文档的）
+    StreamPos postings;         // 倒排列表起点
+    uint32_t maxTf;             // 列表中的最大词频
+    uint32_t minDocLength;      // 列表中的最短文档长度
+    StreamPos skips;            // 跳表起点（块数不足 SKIP_INTERVAL 时无效）
+
+    TermInfo() : numPostings(0), maxTf(0), minDocLength(0) {}
+};
+
+/**
+ * @brief 段写入器
+ *
+ * 段由六个字节流组成：
+ * - 词典：按词项升序，每项为 [词长][UTF-8][倒排项数][倒排起点页][倒排起点偏移][最大tf][最短文档长度]
+ *         [跳表页][跳表偏移]
+ * - 倒排：每个词项的倒排列表切成最多 POSTING_BLOCK_SIZE 项的块，
+ *         块头 [项数][块字节数][块内最后文档ID的增量][块内最大tf][块内最短文档长度][位置页][位置偏移]
+ *         可以整块跳过，块内每项为 [文档ID增量][tf][文档长度]，打分时不需要回表查文档长度。
+ *         BM25 对 tf 单调递增、对文档长度单调递减，所以 (最大tf, 最短文档长度) 的得分
+ *         是块内（或整个列表）得分的上界，查询时按当前的文档数和平均长度计算，供 Block-Max WAND 剪枝。
+ *         块数达到 SKIP_INTERVAL 的列表在最后一块之后写跳表：每 SKIP_INTERVAL 个块一项
+ *         [前一块最后文档ID的增量][块头页][块头偏移][之前的倒排项数的增量]，
+ *         游标远距离前进时二分跳表直接定位块头，不必逐个读块头
+ * - 词位置：与倒排块一一对应，块内每项依次写 tf 个 [位置增量]（每项从 0 开始累加）。
+ *         位置单独成流，只有短语/NEAR 查询才会通过块头里的位置指针去读，普通查询不碰这些页
+ * - 文档表：按文档ID升序的 [文档ID增量][文档长度]，每 DOC_SAMPLE_INTERVAL 项增量基准归零
+ * - 稀疏索引：每 TERM_SAMPLE_INTERVAL 个词项、每 DOC_SAMPLE_INTERVAL 个文档取一个采样点，
+ *            打开段时读入内存，查找时二分采样点后最多顺序解码一组
+ * - 删除集：[数量][文档ID增量...]，段不可变，删除只记在这里，合并时才真正丢弃
+ *
+ * 调用顺序：addDocument（文档升序）全部写完后，对每个词项（升序）beginTerm / addPosting / endTerm，
+ * 最后 finish。
+ */
+class InvertedSegmentWriter {
+public:
+    static constexpr int POSTING_BLOCK_SIZE = 128;
+    static constexpr int TERM_SAMPLE_INTERVAL = 64;
+    static constexpr int DOC_SAMPLE_INTERVAL = 128;
+    static constexpr int SKIP_INTERVAL = 8;
+
+    InvertedSegmentWriter(BufferPoolManager* bufferPool, uint32_t segmentId);
+    ~InvertedSegmentWriter();
+
+    bool addDocument(RowId docId, uint32_t docLength);
+    bool beginTerm(const QString& term);
+
+    /**
+     * @brief 追加倒排项
+     * @param positions 词在文档中的位置（升序，个数等于 tf）
+     */
+    bool addPosting(RowId docId, uint32_t tf, uint32_t docLength, const QVector<uint32_t>& positions);
+    bool endTerm();
+
+    /**
+     * @brief 写完所有流并返回段元数据
+     */
+    bool finish(InvertedSegmentMeta& meta);
+
+    /**
+     * @brief 放弃写入并释放已分配的页
+     */
+    void abort();
+
+private:
+    bool flushBlock();
+
+    BufferPoolManager* bufferPool_;
+    InvertedSegmentMeta meta_;
+    PageStreamWriter dict_;
+    PageStreamWriter postings_;
+    PageStreamWriter docs_;
+    PageStreamWriter positions_;
+
+    QVector<QPair<QString, StreamPos>> termSamples_;
+    QVector<QPair<RowId, StreamPos>> docSamples_;
+    RowId lastDocId_;
+
+    QString currentTerm_;
+    StreamPos termStart_;
+    uint32_t termPostings_;
+    RowId blockBase_;
+    RowId blockLastDocId_;
+    int blockCount_;
+    uint32_t blockMaxTf_;
+    uint32_t blockMinLength_;
+    uint32_t termMaxTf_;
+    uint32_t termMinLength_;
+    int termBlocks_;
+    QByteArray skips_;          // 当前词项的跳表
+    uint32_t numSkips_;
+    RowId lastSkipBase_;
+    uint32_t lastSkipPostings_;
+    QByteArray block_;
+    QByteArray blockPositions_; // 当前块的位置数据
+    bool failed_;
+};
+
+/**
+ * @brief 倒排列表游标（一次只解码一个块）
+ *
+ * 块头和块数据分开读取：skipToBlock 只读块头，跳过的块不解码；
+ * 列表有跳表时，第一次远距离前进才读入跳表。
+ * 块数据一次解码成文档ID/tf/文档长度三个数组，块内前进用galloping。
+ * 位置数据只在调用 positions() 时按块读取，不做位置匹配的查询不会读位置流。
+ */
+class PostingCursor {
+public:
+    PostingCursor(BufferPoolManager* bufferPool, const TermInfo& info);
+
+    /**
+     * @brief 前进到下一项
+     * @return false 列表结束
+     */
+    bool next();
+
+    /**
+     * @brief 前进到第一个文档ID >= target 的项（当前项已满足时不动）
+     * @return false 列表结束
+     */
+    bool advance(RowId target);
+
+    /**
+     * @brief 只移动块头：定位到最后文档ID >= target 的块，不解码块数据
+     * @return false 之后没有这样的块
+     */
+    bool skipToBlock(RowId target);
+
+    /**
+     * @brief 定位并解码最后文档ID >= target 的块（整块求交时使用）
+     * @return false 之后没有这样的块
+     */
+    bool loadBlock(RowId target);
+
+    // 已解码的当前块（loadBlock / next / advance 之后有效）
+    int blockSize() const { return static_cast<int>(blockCount_); }
+    const RowId* blockDocIds() const { return docIds_; }
+    const uint32_t* blockTfs() const { return tfs_; }
+    const uint32_t* blockDocLengths() const { return docLengths_; }
+
+    /**
+     * @brief 当前项的词位置（升序，个数为 tf），第一次访问某块时才读取并解码整块的位置
+     * @return false 位置数据损坏或当前没有有效项
+     */
+    bool positions(const uint32_t*& data, uint32_t& count);
+
+    RowId docId() const { return docId_; }
+    uint32_t tf() const { return tf_; }
+    uint32_t docLength() const { return docLength_; }
+
+    // 当前块（skipToBlock / next / advance 之后有效）
+    RowId blockLastDocId() const { return blockLastDocId_; }
+    uint32_t blockMaxTf() const { return blockMaxTf_; }
+    uint32_t blockMinDocLength() const { return blockMinLength_; }
+
+private:
+    struct SkipEntry {
+        RowId base;             // 目标块之前一块的最后文档ID
+        StreamPos header;       // 目标块的块头位置
+        uint32_t postingsBefore; // 目标块之前的倒排项数
+    };
+
+    bool readBlockHeader();
+    bool decodeBlock();
+    bool loadSkips();
+    bool decodePositions();
+    void setEntry(int index);
+    void fail();
+
+    BufferPoolManager* bufferPool_;
+    PageStreamReader reader_;
+    uint32_t numPostings_;
+    uint32_t remaining_;        // 尚未读取块头的项数
+    bool hasBlock_;             // 已读入当前块的块头
+    bool decoded_;              // 当前块的数据已解码
+    bool onEntry_;              // docId_ 等是当前块中的有效项
+    uint32_t blockCount_;
+    uint32_t blockBytes_;
+    int blockPos_;              // 当前项在块内的下标
+    RowId blockBase_;           // 上一块的最后文档ID（块内增量的基准）
+    RowId blockLastDocId_;
+    uint32_t blockMaxTf_;
+    uint32_t blockMinLength_;
+    StreamPos blockPositionsPos_; // 当前块的位置数据起点
+    bool positionsDecoded_;     // 当前块的位置已解码
+    QByteArray block_;
+    QVector<uint32_t> positions_; // 当前块所有项的位置，按项依次排列
+    uint32_t positionOffsets_[InvertedSegmentWriter::POSTING_BLOCK_SIZE + 1];
+    RowId docIds_[InvertedSegmentWriter::POSTING_BLOCK_SIZE];
+    uint32_t tfs_[InvertedSegmentWriter::POSTING_BLOCK_SIZE];
+    uint32_t docLengths_[InvertedSegmentWriter::POSTING_BLOCK_SIZE];
+    StreamPos skipsPos_;
+    bool skipsLoaded_;
+    QVector<SkipEntry> skips_;
+    RowId docId_;
+    uint32_t tf_;
+    uint32_t docLength_;
+};
+
+/**
+ * @brief 词典顺序游标（合并段时使用）
+ */
+class DictionaryCursor {
+public:
+    DictionaryCursor(BufferPoolManager* bufferPool, const InvertedSegmentMeta& meta);
+
+    bool next(TermInfo& info);
+
+private:
+    PageStreamReader reader_;
+    uint32_t remaining_;
+};
+
+/**
+ * @brief 文档表顺序游标
+ */
+class DocumentCursor {
+public:
+    DocumentCursor(BufferPoolManager* bufferPool, const InvertedSegmentMeta& meta, StreamPos start = StreamPos(),
+                   uint32_t skip = 0);
+
+    bool next(RowId& docId, uint32_t& docLength);
+
+private:
+    PageStreamReader reader_;
+    uint32_t index_;            // 下一项在文档表中的序号
+    uint32_t total_;
+    RowId lastDocId_;
+};
+
+/**
+ * @brief 已写入磁盘的只读段
+ */
+class InvertedSegment {
+public:
+    InvertedSegment(BufferPoolManager* bufferPool, const InvertedSegmentMeta& meta);
+
+    /**
+     * @brief 读入稀疏索引和删除集
+     */
+    bool load();
+
+    const InvertedSegmentMeta& meta() const { return meta_; }
+
+    /**
+     * @brief 查找词项
+     */
+    bool findTerm(const QString& term, TermInfo& info) const;
+
+    /**
+     * @brief 查找文档（不考虑删除标记）
+     */
+    bool findDocument(RowId docId, uint32_t& docLength) const;
+
+    /**
+     * @brief 文档是否存在且未被删除
+     */
+    bool containsLive(RowId docId, uint32_t& docLength) const;
+
+    bool isDeleted(RowId docId) const { return deleted_.contains(docId); }
+
+    /**
+     * @brief 标记删除（在下一次 saveDeletes 时写回）
+     */
+    void markDeleted(RowId docId);
+
+    bool hasPendingDeletes() const { return deletesDirty_; }
+
+    uint32_t liveDocuments() const { return meta_.numDocs - meta_.numDeleted; }
+
+    /**
+     * @brief 重写删除集流
+     */
+    bool saveDeletes();
+
+    /**
+     * @brief 释放段占用的全部页
+     */
+    void destroy();
+
+    /**
+     * @brief 释放一条页链
+     */
+    static void freeChain(BufferPoolManager* bufferPool, PageId firstPageId);
+
+private:
+    BufferPoolManager* bufferPool_;
+    InvertedSegmentMeta meta_;
+    QVector<QPair<QString, StreamPos>> termSamples_;
+    QVector<QPair<RowId, StreamPos>> docSamples_;
+    QSet<RowId> deleted_;
+    bool deletesDirty_;
+};
+
+} // namespace qindb
+
+#endif // QINDB_INVERTED_SEGMENT_H
@@ -0,0 +1,114 @@
+#ifndef QINDB_KEY_ENCODER_H
+#define QINDB_KEY_ENCODER_H
+
+#include "common.h"  // 引入公共定义
+#include <QVariant>
+#include <QByteArray>
+#include <QVector>
+#include <cstring>
+
+namespace qindb {
+
+/**
+ * @brief 保序键编码器 - 把索引键编码为可直接 memcmp 比较的字节串
+ *
+ * 编码满足：encode(a) 与 encode(b) 的字节序（memcmp，短者为前缀时更小）
+ * 与 a、b 的值序一致，因此索引中的每次比较都只需一次 memcmp，
+ * 不再需要反序列化和按类型分发。
+ *
+ * 每个值的编码都是自定界的（定长或带终止符），因此多列复合键
+ * 直接按列拼接即可保持字典序。
+ *
+ * 编码格式（每个值）：
+ * - 标记字节：0x00 = NULL，0x01 = 非 NULL（NULL 小于任何非 NULL 值）
+ * - 整数：按类型宽度的大端补码，符号位取反
+ * - 浮点：IEEE 754 位模式，正数翻转符号位、负数翻转全部位；-0 归一为 +0，NaN 归一后最大
+ * - DECIMAL：符号字节 + 十进制指数 + 每位数字（负数整体取反），尾随零不影响相等
+ * - 字符串/JSON/XML：UTF-8（按码点排序），0x00 转义为 0x00 0xFF，以 0x00 0x01 结束
+ *   CHAR 与 KeyComparator 一致先去除首尾空白
+ * - 二进制：原始字节，转义和终止方式同字符串
+ * - 日期时间：DATE 为天数、TIME 为当天毫秒数、其余为 Unix 毫秒时间戳，均为符号位取反的大端整数
+ * - 布尔：0x00 / 0x01；UUID：16 字节
+ */
+class KeyEncoder {
+public:
+    /**
+     * @brief 编码单个键
+     * @param value 键值
+     * @param type 数据类型
+     * @param output 输出的编码字节
+     * @return 成功返回 true
+     */
+    static bool encode(const QVariant& value, DataType type, QByteArray& output);
+
+    /**
+     * @brief 把单个键的编码追加到 output 末尾（用于复合键）
+     */
+    static bool append(const QVariant& value, DataType type, QByteArray& output);
+
+    /**
+     * @brief 解码单个键
+     * @param data 编码字节
+     * @param type 数据类型
+     * @param value 输出的键值
+     * @return 成功且恰好消费全部字节时返回 true
+     */
+    static bool decode(const QByteArray& data, DataType type, QVariant& value);
+
+    /**
+     * @brief 从 data 的 offset 处解码一个值，并把 offset 移到该值之后
+     */
+    static bool decodeAt(const QByteArray& data, int& offset, DataType type, QVariant& value);
+
+    /**
+     * @brief 编码复合键：各列编码依次拼接
+     */
+    static bool encodeComposite(const QVector<QVariant>& values, const QVector<DataType>& types,
+                                QByteArray& output);
+
+    /**
+     * @brief 解码复合键（可只包含前若干列）
+     */
+    static bool decodeComposite(const QByteArray& data, const QVector<DataType>& types,
+                                QVector<QVariant>& values);
+
+    /**
+     * @brief 检查数据类型是否支持保序编码
+     */
+    static bool isEncodableType(DataType type);
+
+    /**
+     * @brief 比较两个编码后的键
+     * @return < 0 表示 key1 < key2，== 0 表示相等，> 0 表示 key1 > key2
+     */
+    static int compare(const QByteArray& key1, const QByteArray& key2) {
+        const int len1 = key1.size();
+        const int len2 = key2.size();
+        const int cmp = std::memcmp(key1.constData(), key2.constData(),
+                                    static_cast<size_t>(len1 < len2 ? len1 : len2));
+        if (cmp != 0) {
+            return cmp;
+        }
+        return (len1 < len2) ? -1 : (len1 > len2 ? 1 : 0);
+    }
+
+private:
+    static bool appendInteger(const QVariant& value, DataType type, QByteArray& output);
+    static bool appendFloat(const QVariant& value, DataType type, QByteArray& output);
+    static bool appendDecimal(const QVariant& value, QByteArray& output);
+    static bool appendDateTime(const QVariant& value, DataType type, QByteArray& output);
+    static bool appendUUID(const QVariant& value, QByteArray& output);
+    static void appendEscaped(const QByteArray& bytes, QByteArray& output);
+
+    static bool decodeInteger(const QByteArray& data, int& offset, DataType type, QVariant& value);
+    static bool decodeFloat(const QByteArray& data, int& offset, DataType type, QVariant& value);
+    static bool decodeDecimal(const QByteArray& data, int& offset, QVariant& value);
+    static bool decodeDateTime(const QByteArray& data, int& offset, DataType type, QVariant& value);
+    static bool decodeEscaped(const QByteArray& data, int& offset, QByteArray& bytes);
+
+    static int integerWidth(DataType type);  // 整数类型的编码宽度（字节）
+};
+
+} // namespace qindb
+
+#endif // QINDB_KEY_ENCODER_H
@@ -37,7 +37,7 @@ enum class TokenType {
     TRUE_KW, FALSE_KW,
     BEGIN, COMMIT, ROLLBACK, TRANSACTION,
     SHOW, TABLES, INDEXES, DATABASE, DATABASES,
-    USE, DESCRIBE, EXPLAIN, ANALYZE, SAVE, VACUUM,
+    USE, DESCRIBE, EXPLAIN, ANALYZE, SAVE, VACUUM, CALIBRATE,
     GRANT, REVOKE, TO, WITH, OPTION,
     USER, PASSWORD, IDENTIFIED,
     ADD, MODIFY, RENAME, COLUMN,
@@ -25,6 +25,8 @@ enum class PageType : uint8_t {
     RTREE_NODE_PAGE = 9,  // R-树节点页
     FREELIST_PAGE = 10,   // 空闲页列表
     OVERFLOW_PAGE = 11,   // 溢出页（超大记录）
+    BLOCK_RANGE_PAGE = 12, // 块范围索引（BRIN）元数据页和摘要页
+    BITMAP_INDEX_PAGE = 13, // 位图索引元数据页、目录和位图字节流
     FREE_PAGE = 255       // 空闲页
 };
 
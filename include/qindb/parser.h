@@ -29,6 +29,12 @@ public:
      */
     std::unique_ptr<ast::ASTNode> parse();  // 主解析函数
 
+    /**
+     * @brief 把整段输入解析为一个表达式（索引表达式、部分索引谓词的持久化文本）
+     * @return 成功返回表达式，语法错误或有多余 Token 时返回 nullptr
+     */
+    std::unique_ptr<ast::Expression> parseStandaloneExpression();
+
     /**
      * @brief 获取最后一次错误信息
      */
@@ -98,6 +104,7 @@ private:
     std::unique_ptr<ast::SaveStatement> parseSave();  // 解析 SAVE 语句
     std::unique_ptr<ast::VacuumStatement> parseVacuum();  // 解析 VACUUM 语句
     std::unique_ptr<ast::AnalyzeStatement> parseAnalyze();  // 解析 ANALYZE 语句
+    std::unique_ptr<ast::CalibrateStatement> parseCalibrate();  // 解析 CALIBRATE 语句
     std::unique_ptr<ast::ExplainStatement> parseExplain();  // 解析 EXPLAIN 语句
     std::unique_ptr<ast::CreateUserStatement> parseCreateUser();  // 解析 CREATE USER 语句
     std::unique_ptr<ast::DropUserStatement> parseDropUser();  // 解析 DROP USER 语句
@@ -144,6 +151,7 @@ private:
     std::unique_ptr<ast::Expression> parseAndExpression();  // 解析 AND 表达式
     std::unique_ptr<ast::Expression> parseNotExpression();  // 解析 NOT 表达式
     std::unique_ptr<ast::Expression> parseComparisonExpression();  // 解析比较表达式
+    std::unique_ptr<ast::Expression> parseInList();  // 解析 IN 右侧的值列表
     std::unique_ptr<ast::Expression> parseAdditiveExpression();  // 解析加法表达式
     std::unique_ptr<ast::Expression> parseMultiplicativeExpression();  // 解析乘法表达式
     std::unique_ptr<ast::Expression> parseUnaryExpression();  // 解析一元表达式
@@ -0,0 +1,70 @@
+#ifndef QINDB_PERFECT_HASH_H
+#define QINDB_PERFECT_HASH_H
+
+#include <QString>
+#include <QStringList>
+#include <QStringView>
+#include <QVector>
+#include <QPair>
+#include <cstdint>
+
+namespace qindb {
+
+/**
+ * @brief 静态字符串集合的完美哈希（CHD：hash-and-displace）
+ *
+ * build 时把 n 个键按哈希分进约 n/4 个桶，从大桶到小桶依次为每个桶找一个位移 d，
+ * 使桶内所有键的槽位 (f1 + d * f2) mod m 都是空的（f2 为奇数、m 为 2 的幂，
+ * d 遍历 [0, m) 时能走遍所有槽位）。找不到时换种子重建。
+ *
+ * 查找只算一次 wyhash，读一次位移表和一个槽位，再比较一次键，不分配内存。
+ * 键集合变化时需要重新 build（停用词表、分词词典这种构建一次、查询无数次的场景）。
+ */
+class PerfectHash {
+public:
+    PerfectHash();
+
+    /**
+     * @brief 用给定的键构建哈希表（重复的键只保留第一个）
+     * @return false 键太多或多次换种子仍无法构建
+     */
+    bool build(const QStringList& keys);
+
+    /**
+     * @brief 查找键
+     * @return 键在 build 参数中的下标（去重后的顺序），不存在时返回 -1
+     */
+    int find(const QChar* data, qsizetype length) const;
+    int find(QStringView key) const { return find(key.data(), key.size()); }
+
+    bool contains(QStringView key) const { return find(key) >= 0; }
+
+    /**
+     * @brief 键的个数
+     */
+    int size() const { return static_cast<int>(keys_.size()); }
+
+    /**
+     * @brief 第 index 个键
+     */
+    QStringView keyAt(int index) const;
+
+private:
+    static constexpr uint32_t EMPTY_SLOT = 0xFFFFFFFFu;
+    static constexpr int MAX_ATTEMPTS = 16;
+
+    uint64_t hash(const QChar* data, qsizetype length) const;
+    uint32_t bucketOf(uint64_t h) const;
+    bool tryBuild();
+
+    QString pool_;                          // 所有键首尾相接
+    QVector<QPair<uint32_t, uint32_t>> keys_; // (偏移, 长度)
+    QVector<uint32_t> displacements_;       // 每个桶的位移
+    QVector<uint32_t> slots_;               // 槽位 -> 键下标，EMPTY_SLOT 表示空
+    uint64_t seed_;
+    uint32_t slotMask_;
+};
+
+} // namespace qindb
+
+#endif // QINDB_PERFECT_HASH_H
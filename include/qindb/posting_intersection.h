@@ -0,0 +1,55 @@
+#ifndef QINDB_POSTING_INTERSECTION_H
+#define QINDB_POSTING_INTERSECTION_H
+
+#include "qindb/common.h"
+#include <cstddef>
+#include <cstdint>
+
+namespace qindb {
+
+/**
+ * @brief 有序文档ID数组的求交
+ *
+ * 两个数组都必须严格升序（无重复）：
+ * - 长度相差悬殊时，用短数组的每个元素在长数组上做galloping（指数步长 + 二分）
+ * - 长度相近时做归并；CPU 支持 AVX2 时一次比较 4x4 个文档ID（cmpeq + 旋转 + movemask）
+ *
+ * AVX2 路径在运行时检测，编译时不需要额外的 -mavx2 选项。
+ */
+class PostingIntersection {
+public:
+    /**
+     * @brief 长数组与短数组的长度比超过该值时改用galloping
+     */
+    static constexpr size_t GALLOP_RATIO = 32;
+
+    /**
+     * @brief 从 begin 开始查找第一个 >= target 的位置（指数步长 + 二分）
+     * @return [begin, count] 内的下标，count 表示不存在
+     */
+    static size_t gallop(const RowId* data, size_t begin, size_t count, RowId target);
+
+    /**
+     * @brief 求交，输出匹配元素在两个数组中的下标（按 a 的下标升序）
+     * @param outA 至少 min(na, nb) 个元素
+     * @param outB 至少 min(na, nb) 个元素
+     * @return 匹配的个数
+     */
+    static size_t intersect(const RowId* a, size_t na, const RowId* b, size_t nb,
+                            uint32_t* outA, uint32_t* outB);
+
+    /**
+     * @brief 纯标量归并求交（用于对比测试和基准测试）
+     */
+    static size_t intersectScalar(const RowId* a, size_t na, const RowId* b, size_t nb,
+                                  uint32_t* outA, uint32_t* outB);
+
+    /**
+     * @brief 当前 CPU 是否启用了 AVX2 路径
+     */
+    static bool isAvx2Enabled();
+};
+
+} // namespace qindb
+
+#endif // QINDB_POSTING_INTERSECTION_H
@@ -0,0 +1,130 @@
+#ifndef QINDB_ROARING_BITMAP_H
+#define QINDB_ROARING_BITMAP_H
+
+#include "qindb/common.h"
+#include <QByteArray>
+#include <QVector>
+#include <cstdint>
+
+namespace qindb {
+
+/**
+ * @brief 压缩位图（Roaring）：保存一组行ID
+ *
+ * 行ID按高 48 位分桶，每个桶（容器）保存低 16 位：
+ * - 数组容器：不超过 ARRAY_MAX 个元素时用升序 uint16 数组
+ * - 位图容器：超过后改用 65536 位的定长位图（1024 个 uint64）
+ * 容器按桶号升序排列。两个位图容器的 AND/OR 是逐字的位运算，CPU 支持 AVX2 时
+ * 一次处理 256 位（运行时检测，编译时不需要额外的 -mavx2 选项）。
+ *
+ * 序列化格式（字节序与页面其余部分一致）：
+ *   varint 容器数；每个容器：varint 桶号、uint8 类型、varint 基数、
+ *   数组容器为 基数 个 uint16，位图容器为 1024 个 uint64
+ */
+class RoaringBitmap {
+public:
+    /**
+     * @brief 数组容器的最大元素数（超过后转为位图容器，两种表示的大小在此处相等）
+     */
+    static constexpr int ARRAY_MAX = 4096;
+
+    /**
+     * @brief 位图容器的 uint64 个数
+     */
+    static constexpr int BITSET_WORDS = 1024;
+
+    /**
+     * @brief 加入一个行ID
+     * @return 原来不存在时返回 true
+     */
+    bool add(RowId rowId);
+
+    /**
+     * @brief 删除一个行ID
+     * @return 原来存在时返回 true
+     */
+    bool remove(RowId rowId);
+
+    bool contains(RowId rowId) const;
+
+    /**
+     * @brief 元素个数
+     */
+    uint64_t cardinality() const;
+
+    bool isEmpty() const { return containers_.isEmpty(); }
+    void clear() { containers_.clear(); }
+
+    /**
+     * @brief 容器个数
+     */
+    int containerCount() const { return containers_.size(); }
+
+    /**
+     * @brief 求交（结果写回自身）
+     */
+    void intersectWith(const RoaringBitmap& other);
+
+    /**
+     * @brief 求并（结果写回自身）
+     */
+    void uniteWith(const RoaringBitmap& other);
+
+    static RoaringBitmap intersect(const RoaringBitmap& a, const RoaringBitmap& b);
+    static RoaringBitmap unite(const RoaringBitmap& a, const RoaringBitmap& b);
+
+    /**
+     * @brief 全部行ID（升序）
+     */
+    QVector<RowId> toVector() const;
+
+    QByteArray serialize() const;
+
+    /**
+     * @brief 从 serialize() 的结果还原
+     * @return 数据损坏时返回 false（此时位图为空）
+     */
+    bool deserialize(const QByteArray& data);
+
+    bool operator==(const RoaringBitmap& other) const;
+    bool operator!=(const RoaringBitmap& other) const { return !(*this == other); }
+
+    /**
+     * @brief 当前 CPU 是否启用了 AVX2 路径
+     */
+    static bool isAvx2Enabled();
+
+    /**
+     * @brief 允许或禁止使用 AVX2 路径（默认允许；禁止后位图容器改用标量 AND/OR 和置位计数，用于对比测试）
+     */
+    static void setAvx2Allowed(bool allowed);
+
+private:
+    /**
+     * @brief 一个桶：bits 非空时为位图容器，否则为数组容器
+     */
+    struct Container {
+        uint64_t key = 0;               // 行ID的高 48 位
+        uint32_t cardinality = 0;       // 元素个数
+        QVector<uint16_t> array;        // 数组容器：升序的低 16 位
+        QVector<uint64_t> bits;         // 位图容器：BITSET_WORDS 个字
+
+        bool isBitset() const { return !bits.isEmpty(); }
+        bool contains(uint16_t low) const;
+        bool add(uint16_t low);
+        bool remove(uint16_t low);
+        void toBitset();
+        void toArray();
+    };
+
+    int findContainer(uint64_t key) const;
+
+    static Container intersectContainers(const Container& a, const Container& b);
+    static Container uniteContainers(const Container& a, const Container& b);
+
+    QVector<Container> containers_;    // 按桶号升序
+};
+
+} // namespace qindb
+
+#endif // QINDB_ROARING_BITMAP_H
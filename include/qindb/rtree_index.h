@@ -0,0 +1,196 @@
+#ifndef QINDB_RTREE_INDEX_H
+#define QINDB_RTREE_INDEX_H
+
+#include "qindb/buffer_pool_manager.h"
+#include "qindb/common.h"
+#include "qindb/geometry.h"
+#include <QSet>
+#include <QVector>
+#include <queue>
+#include <vector>
+
+namespace qindb {
+
+/**
+ * @brief R* 树空间索引：按外包矩形索引 GEOMETRY / GEOGRAPHY 列
+ *
+ * 每个节点占一页（页类型 RTREE_NODE_PAGE），条目为 外包矩形 + 引用：
+ * 叶子节点（level 0）引用行ID，内部节点引用子节点页。所有叶子在同一层。
+ *
+ * - 插入：R* 的 ChooseSubtree（子节点是叶子时按重叠增量选，否则按面积增量选），
+ *   节点溢出时每层先做一次强制重插（移出离中心最远的 30% 条目），仍溢出才分裂；
+ *   分裂先按周长之和选轴，再在该轴上选重叠最小的切分
+ * - 删除：找到叶子条目后自底向上收缩，不足最小条目数的节点整体摘下，条目重插回原层
+ * - 批量构建：STR（Sort-Tile-Recursive），CREATE INDEX 时一次性自底向上装满节点
+ * - 查询：矩形相交查询；最近邻按条目与查询对象外包矩形的最短距离（MINDIST）做最佳优先遍历
+ *
+ * 存储：
+ * - 元数据页：magic、版本、节点最大条目数、树高、根页、条目总数
+ * - 节点页（页头之后）：level(2) count(2) reserved(4)，之后每个条目 40 字节：
+ *   minX minY maxX maxY（double）、引用（uint64）
+ */
+class RTreeIndex {
+public:
+    /**
+     * @brief 节点条目：叶子节点中 ref 为行ID，内部节点中为子节点页ID
+     */
+    struct Entry {
+        BoundingBox box;
+        uint64_t ref = 0;
+    };
+
+    /**
+     * @brief 一页最多能放的条目数
+     */
+    static int pageCapacity();
+
+    /**
+     * @brief 按 MINDIST 从近到远逐个取叶子条目（最佳优先遍历，节点在用到时才读）
+     *
+     * 返回的距离是查询矩形到条目外包矩形的最短距离，是该行几何对象到查询对象真实距离的下界，
+     * 并且依次返回的值单调不减。调用方据此判断何时可以停止（第 k 个真实距离不大于下一个下界）。
+     */
+    class NearestCursor {
+    public:
+        NearestCursor(const RTreeIndex* index, const BoundingBox& query);
+
+        /**
+         * @brief 取下一个叶子条目
+         * @return 已取完或读页失败时返回 false（用 hasError 区分）
+         */
+        bool next(RowId& rowId, double& distance);
+
+        bool hasError() const { return error_; }
+
+    private:
+        struct Item {
+            double distance = 0.0;
+            bool isRow = false;         // 叶子条目（行）还是待展开的节点
+            uint64_t ref = 0;
+        };
+        struct Farther {
+            bool operator()(const Item& a, const Item& b) const {
+                // 距离相同时先返回行，尽早满足调用方的停止条件
+                return a.distance > b.distance || (a.distance == b.distance && !a.isRow && b.isRow);
+            }
+        };
+
+        const RTreeIndex* index_;
+        BoundingBox query_;
+        std::priority_queue<Item, std::vector<Item>, Farther> queue_;
+        bool error_ = false;
+    };
+
+    /**
+     * @brief 构造函数
+     * @param bufferPool 缓冲池管理器
+     * @param metaPageId 元数据页ID（新索引为 INVALID_PAGE_ID，随后调用 create）
+     */
+    explicit RTreeIndex(BufferPoolManager* bufferPool, PageId metaPageId = INVALID_PAGE_ID);
+
+    /**
+     * @brief 分配元数据页和空的根节点
+     * @param maxEntries 每个节点的最大条目数（0 表示按页容量；测试用小值得到更深的树）
+     */
+    bool create(int maxEntries = 0);
+
+    /**
+     * @brief 从元数据页加载树的基本信息（节点在用到时才读）
+     */
+    bool load();
+
+    bool insert(const BoundingBox& box, RowId rowId);
+
+    /**
+     * @brief 删除一个叶子条目（外包矩形和行ID都要一致）
+     * @return 条目不存在或写页失败时返回 false
+     */
+    bool remove(const BoundingBox& box, RowId rowId);
+
+    /**
+     * @brief 用 STR 算法从零构建（只能在空索引上调用）
+     * @param entries 叶子条目（ref 为行ID），调用中会被重新排序
+     */
+    bool bulkLoad(QVector<Entry> entries);
+
+    /**
+     * @brief 外包矩形与 query 相交的全部行
+     */
+    bool search(const BoundingBox& query, QVector<RowId>& rowIds) const;
+
+    /**
+     * @brief 外包矩形离 query 最近的 k 行（按 MINDIST 升序）
+     */
+    bool nearest(const BoundingBox& query, int k, QVector<RowId>& rowIds) const;
+
+    /**
+     * @brief 检查树的结构：层次一致、父条目矩形等于子节点的外包矩形、非根节点条目数不少于下限、
+     *        叶子条目总数与元数据一致
+     */
+    bool checkStructure() const;
+
+    /**
+     * @brief 释放索引占用的全部页（含元数据页）
+     */
+    void destroy();
+
+    PageId getMetaPageId() const { return metaPageId_; }
+    uint64_t size() const { return entryCount_; }
+
+    /**
+     * @brief 树的层数（只有根叶子时为 1）
+     */
+    int height() const { return height_; }
+
+    int maxEntries() const { return maxEntries_; }
+    int minEntries() const { return minEntries_; }
+
+private:
+    struct Node {
+        uint16_t level = 0;             // 0 为叶子
+        QVector<Entry> entries;
+
+        BoundingBox bounds() const;
+    };
+
+    /**
+     * @brief 从根到某个节点的路径：slots[i] 为 nodes[i] 中指向 nodes[i + 1] 的条目下标
+     */
+    struct Path {
+        QVector<PageId> pages;
+        QVector<Node> nodes;
+        QVector<int> slots;
+    };
+
+    bool readNode(PageId pageId, Node& node) const;
+    bool writeNode(PageId pageId, const Node& node);
+    bool allocateNode(PageId& pageId);
+    bool writeMeta();
+
+    bool insertEntry(const Entry& entry, int level);
+    bool chooseSubtree(const BoundingBox& box, int level, Path& path) const;
+    int chooseChild(const Node& node, const BoundingBox& box) const;
+    bool resolveOverflow(Path& path);
+    bool updateAncestors(Path& path, int depth);
+    QVector<Entry> takeReinsertEntries(Node& node) const;
+    void splitEntries(QVector<Entry>& entries, QVector<Entry>& siblingEntries) const;
+
+    bool findLeaf(PageId pageId, const BoundingBox& box, RowId rowId, Path& path) const;
+    bool collectLeafEntries(PageId pageId, QVector<Entry>& entries, bool freePages);
+    bool checkNode(PageId pageId, int expectedLevel, bool isRoot, const BoundingBox* expectedBox,
+                   uint64_t& leafCount) const;
+
+    BufferPoolManager* bufferPool_;
+    PageId metaPageId_;
+    PageId rootPageId_ = INVALID_PAGE_ID;
+    int height_ = 1;
+    int maxEntries_ = 0;
+    int minEntries_ = 0;
+    uint64_t entryCount_ = 0;
+
+    QSet<int> reinsertedLevels_;        // 本次插入中已做过强制重插的层
+};
+
+} // namespace qindb
+
+#endif // QINDB_RTREE_INDEX_H
@@ -6,6 +6,12 @@
 #include <QMap>           // 引入Qt映射容器
 #include <QString>        // 引入Qt字符串类
 #include <QVariant>       // 引入Qt变体类，可以存储各种类型的数据
+#include <QByteArray>     // 引入Qt字节数组类，用于保存不同值草图
+#include <QJsonObject>    // 引入Qt JSON对象类，用于统计信息的序列化
+#include <QStringList>    // 引入Qt字符串列表类
+#include <QMutex>         // 引入Qt互斥锁
+#include <QThread>        // 引入Qt线程类，用于后台收集
+#include <QWaitCondition> // 引入Qt等待条件，用于后台收集线程
 #include <memory>         // 引入智能指针相关头文件
 
 namespace qindb {  // 定义qindb命名空间
@@ -27,21 +33,51 @@ struct ColumnStats {
     size_t numDistinctValues = 0;    // 不同值的数量（基数）
     size_t numNulls = 0;             // NULL 值的数量
 
-    // 值范围（用于数值和日期类型）
+    // 值范围（用于数值和字符串类型，全表扫描得到的精确值）
     QVariant minValue;               // 最小值
     QVariant maxValue;               // 最大值
 
-    // 采样数据（用于直方图）
-    QVector<QVariant> sampleValues;  // 采样值
+    // 等深直方图：采样中不属于 MCV 的非 NULL 值排序后等间隔取的边界，相邻边界之间的行数大致相同
+    QVector<QVariant> histogramBounds;
 
     // 最常见值（Most Common Values, MCV）
-    QHash<QString, size_t> mcv;      // 值的字符串表示 → 出现次数
+    QHash<QString, size_t> mcv;      // 值的字符串表示 → 估计的全表出现次数
+
+    // 物理顺序相关系数（-1.0 - 1.0）：行在表中的先后顺序与值的大小顺序的秩相关，
+    // 绝对值接近 1 时按该列的索引顺序回表基本是顺序读
+    double correlation = 0.0;
+
+    // 不同值草图（HyperLogLog 寄存器，精度 SKETCH_PRECISION），用于估算连接键的重叠
+    QByteArray distinctSketch;
+
+    // MCV 覆盖的总行数
+    size_t mcvRows() const;
+
+    // 直方图覆盖的值中小于 value 的比例（0.0 - 1.0，桶内数值按线性插值）
+    double histogramFraction(const QVariant& value) const;
 
     ColumnStats() = default;         // 默认构造函数
     ColumnStats(const QString& name, DataType type)  // 带参数的构造函数
         : columnName(name), dataType(type) {}
 };
 
+/**
+ * @brief 列组统计信息（两列的扩展统计）
+ *
+ * 用于修正相关列（如城市和邮编）上的条件按独立性假设相乘带来的低估
+ */
+struct ColumnGroupStats {
+    QString firstColumn;             // 第一列
+    QString secondColumn;            // 第二列
+    size_t numDistinctValues = 0;    // 两列组合的不同值个数
+    double dependency = 0.0;         // 函数依赖程度 first → second（0.0 - 1.0）
+    double reverseDependency = 0.0;  // 函数依赖程度 second → first
+
+    ColumnGroupStats() = default;
+    ColumnGroupStats(const QString& first, const QString& second)
+        : firstColumn(first), secondColumn(second) {}
+};
+
 /**
  * @brief 表统计信息
  *
@@ -52,8 +88,10 @@ struct TableStats {
     size_t numRows = 0;                          // 总行数
     size_t numPages = 0;                         // 占用的页面数
     size_t avgRowSize = 0;                       // 平均行大小（字节）
+    size_t modifiedRows = 0;                     // 上次收集以来插入、删除和更新的行数
 
     QMap<QString, ColumnStats> columnStats;      // 列名 → 列统计信息
+    QVector<ColumnGroupStats> columnGroups;      // 列组统计信息（每两列一组）
 
     // 索引统计
     QMap<QString, size_t> indexSizes;            // 索引名 → 索引大小（页面数）
@@ -67,38 +105,73 @@ struct TableStats {
         return (it != columnStats.end()) ? &it.value() : nullptr;
     }
 
+    // 获取两列的列组统计（列名不区分大小写、不分先后；reversed 表示 a 是组中的第二列）
+    const ColumnGroupStats* getColumnGroupStats(const QString& a, const QString& b,
+                                                bool* reversed = nullptr) const;
+
     // 估算选择率（0.0 - 1.0）
     double estimateSelectivity(const QString& columnName, const QVariant& value) const;
 
-    // 估算范围查询选择率
+    // 估算范围查询选择率（[minVal, maxVal]，无效的 QVariant 表示该侧不设界）
     double estimateRangeSelectivity(const QString& columnName,
                                    const QVariant& minVal,
                                    const QVariant& maxVal) const;
+
+    // 估算前缀匹配（LIKE '前缀%'）的选择率
+    double estimatePrefixSelectivity(const QString& columnName, const QString& prefix) const;
+
+    // 计入一条已提交的 DML 的改动：调整行数和页数估计，累加改动计数
+    void applyModifications(size_t rowsInserted, size_t rowsDeleted, size_t rowsUpdated);
+
+    // 上次收集以来的改动是否超过自动重新收集的阈值
+    bool needsReanalyze() const;
+
+    // 序列化为 JSON，用于随 Catalog 持久化
+    QJsonObject toJson() const;
+    static TableStats fromJson(const QJsonObject& obj);
 };
 
 /**
  * @brief 统计信息收集器
  *
- * 负责收集和维护数据库统计信息
+ * 负责收集和维护数据库统计信息。收集到的统计信息发布到 Catalog，随元数据一起持久化；
+ * Catalog 中的统计信息由同一数据库的所有查询共享，收集器在首次用到某个表时才取它的快照。
+ *
+ * ANALYZE 只扫描一遍表：行数、NULL 数、最小/最大值按全表精确统计，不同值个数用每列一个
+ * HyperLogLog 草图估计；同时用蓄水池采样保留最多 SAMPLE_ROWS 行，MCV 和等深直方图由样本构建。
+ * 前 MAX_GROUP_COLUMNS 列两两之间的组合不同值个数同样用草图估计，函数依赖程度和物理顺序相关系数
+ * 由样本计算。各列（列组）的累加和收尾计算分给多个线程并行。
  */
 class StatisticsCollector {
 public:
+    // 自动重新收集的阈值：上次收集以来改动的行数超过 BASE + SCALE × 行数时重新收集
+    static constexpr size_t AUTO_ANALYZE_BASE = 50;
+    static constexpr double AUTO_ANALYZE_SCALE = 0.1;
+
+    static constexpr int SAMPLE_ROWS = 30000;       // 蓄水池采样的行数上限
+    static constexpr int MCV_TARGET = 10;           // 每列最多保留的最常见值个数
+    static constexpr int HISTOGRAM_BUCKETS = 20;    // 等深直方图的桶数
+    static constexpr int MAX_GROUP_COLUMNS = 8;     // 只为前这么多列两两收集列组统计
+    static constexpr int SKETCH_PRECISION = 10;     // 保存的不同值草图精度（1 KB / 列）
+
     StatisticsCollector(Catalog* catalog, BufferPoolManager* bufferPool);  // 构造函数
     ~StatisticsCollector() = default;  // 默认析构函数
 
-    // 收集表的统计信息
+    // 收集表的统计信息（并发布到 Catalog）
     bool collectTableStats(const QString& tableName);
 
     // 收集所有表的统计信息
     bool collectAllStats();
 
-    // 获取表统计信息
+    // 获取表统计信息（本收集器没有时取 Catalog 中的快照，指针在收集器销毁前有效）
     const TableStats* getTableStats(const QString& tableName) const;
 
-    // 更新表统计信息（增量更新）
-    void updateTableStats(const QString& tableName,
+    // 更新表统计信息（增量更新行数），返回改动是否已超过阈值、需要重新收集；
+    // 重新收集由调用方交给 AutoAnalyzeWorker，不在 DML 语句中进行
+    bool updateTableStats(const QString& tableName,
                          size_t rowsInserted,
-                         size_t rowsDeleted);
+                         size_t rowsDeleted,
+                         size_t rowsUpdated = 0);
 
     // 清除统计信息
     void clearStats();
@@ -113,21 +186,44 @@ private:
 
     QMap<QString, TableStats> tableStats_;  // 表名 → 表统计信息
 
-    // 辅助方法
-    bool collectColumnStats(const QString& tableName,
-                           const QString& columnName,
-                           ColumnStats& stats);
+    // 表名（小写）→ 取用过的 Catalog 快照，保证 getTableStats 返回的指针有效
+    mutable QHash<QString, std::shared_ptr<const TableStats>> catalogStats_;
+};
+
+/**
+ * @brief 后台自动重新收集统计信息
+ *
+ * DML 累计的改动超过阈值时，执行器把表名交给它，在后台线程中重新 ANALYZE，
+ * 全表扫描不占用触发它的语句的时间。同一个表排队期间只收集一次。
+ * 每个数据库一个（DatabaseDef 持有），线程在第一次有任务时启动，析构时等待正在进行的收集结束。
+ */
+class AutoAnalyzeWorker {
+public:
+    AutoAnalyzeWorker(Catalog* catalog, BufferPoolManager* bufferPool);
+    ~AutoAnalyzeWorker();
+
+    AutoAnalyzeWorker(const AutoAnalyzeWorker&) = delete;
+    AutoAnalyzeWorker& operator=(const AutoAnalyzeWorker&) = delete;
 
-    // 采样方法
-    QVector<QVariant> sampleColumn(const QString& tableName,
-                                   const QString& columnName,
-                                   size_t sampleSize);
+    // 把表加入收集队列（已在队列中时忽略）
+    void schedule(const QString& tableName);
 
-    // 计算基数（不同值的数量）
-    size_t estimateCardinality(const QVector<QVariant>& samples);
+    // 等待队列中的表全部收集完
+    void waitIdle();
 
-    // 构建直方图
-    void buildHistogram(ColumnStats& stats, const QVector<QVariant>& allValues);
+private:
+    void run();
+
+    Catalog* catalog_;
+    BufferPoolManager* bufferPool_;
+
+    QThread* workerThread_;
+    QStringList queue_;           // 待收集的表名（小写）
+    bool busy_;                   // 正在收集一个表
+    bool stopping_;
+    QMutex mutex_;
+    QWaitCondition workAvailable_;  // 有新任务或要求停止
+    QWaitCondition idle_;           // 队列清空且没有正在进行的收集
 };
 
 } // namespace qindb
@@ -1,22 +1,30 @@
 #ifndef QINDB_TOKENIZER_H
 #define QINDB_TOKENIZER_H
 
+#include "qindb/perfect_hash.h"
 #include <QString>
 #include <QStringList>
+#include <QStringView>
 #include <QSet>
-#include <QRegularExpression>
+#include <QVector>
+
 
 namespace qindb {
 
+class ChineseSegmenter;
+
 /**
  * @brief 文本分词器
  *
  * 支持：
  * - 英文分词（基于空格和标点）
- * - 简单中文分词（单字分词）
- * - 停用词过滤
+ * - 中文分词（词典 + 动态规划切词，可关闭退回单字分词）
+ * - 停用词过滤（完美哈希查表）
  * - 大小写归一化
  * - 标点符号过滤
+ *
+ * 所有分词都建立在 tokenizeSpans 之上：一遍扫描 UTF-16 文本，输出词在归一化文本中的
+ * (偏移, 长度)，不为每个词分配 QString。词项按在原文中出现的顺序输出。
  */
 class Tokenizer {
 public:
@@ -25,10 +33,18 @@ public:
      */
     enum class Mode {
         ENGLISH,        // 英文模式（基于空格分词）
-        CHINESE,        // 中文模式（单字分词）
+        CHINESE,        // 中文模式（词典切词）
         MIXED           // 混合模式（中英文混合）
     };
 
+    /**
+     * @brief 词项在归一化文本中的位置
+     */
+    struct TokenSpan {
+        qsizetype offset;
+        qsizetype length;
+    };
+
     /**
      * @brief 构造函数
      * @param mode 分词模式
@@ -50,6 +66,14 @@ public:
      */
     QStringList tokenizeWithDuplicates(const QString& text) const;
 
+    /**
+     * @brief 对文本进行分词，输出词项区间（保留重复词）
+     * @param text 待分词文本
+     * @param folded 输出归一化（ASCII 转小写）后的文本，词项区间指向它；复用已有容量
+     * @param tokens 输出词项区间（先清空），按在原文中出现的顺序
+     */
+    void tokenizeSpans(QStringView text, QString& folded, QVector<TokenSpan>& tokens) const;
+
     /**
      * @brief 归一化词项（转小写、去除标点等）
      * @param term 词项
@@ -96,27 +120,46 @@ public:
      */
     void setStopWordsEnabled(bool enabled) { enableStopWords_ = enabled; }
 
-private:
     /**
-     * @brief 英文分词
+     * @brief 是否对中文做词典切词（关闭时每个汉字是一个词项）
+     */
+    bool isSegmentationEnabled() const { return enableSegmentation_; }
+
+    /**
+     * @brief 设置是否对中文做词典切词
+     *
+     * 切词方式决定了索引中的词项，同一个索引的写入和查询必须使用相同的设置。
      */
-    QStringList tokenizeEnglish(const QString& text) const;
+    void setSegmentationEnabled(bool enabled) { enableSegmentation_ = enabled; }
 
     /**
-     * @brief 中文分词（简单单字分词）
+     * @brief 设置中文分词器（不接管所有权，nullptr 表示使用内置词典）
      */
-    QStringList tokenizeChinese(const QString& text) const;
+    void setSegmenter(const ChineseSegmenter* segmenter);
 
+private:
     /**
-     * @brief 混合分词（中英文混合）
+     * @brief 追加一个词项区间（停用词被过滤）
      */
-    QStringList tokenizeMixed(const QString& text) const;
+    void appendToken(const QChar* folded, qsizetype offset, qsizetype length,
+                     QVector<TokenSpan>& tokens) const;
+
+    /**
+     * @brief 对一段连续汉字切词
+     */
+    void appendChineseRun(const QChar* folded, qsizetype offset, qsizetype length,
+                          QVector<TokenSpan>& tokens) const;
 
     /**
      * @brief 初始化默认停用词表
      */
     void initializeDefaultStopWords();
 
+    /**
+     * @brief 停用词集合变化后重建完美哈希
+     */
+    void rebuildStopWordLookup();
+
     /**
      * @brief 检查字符是否为中文字符
      */
@@ -124,8 +167,10 @@ private:
 
     Mode mode_;                         // 分词模式
     bool enableStopWords_;              // 是否启用停用词过滤
+    bool enableSegmentation_;           // 是否对中文做词典切词
     QSet<QString> stopWords_;           // 停用词集合
-    QRegularExpression wordRegex_;      // 英文单词正则表达式
+    PerfectHash stopWordLookup_;        // 停用词查找表（由 stopWords_ 构建）
+    const ChineseSegmenter* segmenter_; // 中文分词器（不拥有）
 };
 
 } // namespace qindb
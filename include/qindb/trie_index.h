@@ -0,0 +1,206 @@
+#ifndef QINDB_TRIE_INDEX_H
+#define QINDB_TRIE_INDEX_H
+
+#include "qindb/buffer_pool_manager.h"
+#include "qindb/common.h"
+#include <QByteArray>
+#include <QPair>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+namespace qindb {
+
+/**
+ * @brief 自适应基数树（ART）索引：字符串列的等值、前缀（LIKE 'abc%'）查找和有序遍历
+ *
+ * 键 = 值的保序编码 + 8 字节大端行ID，因此同值的多行也是不同的键，且没有键是另一个键的前缀。
+ * 值按 UTF-16 码元逐个编码为 1~3 字节（与 CESU-8 相同），字节序即 QString 的比较顺序；
+ * 码元 0 转义为 0x00 0xFF，值以 0x00 0x01 结束。值的编码超过 MAX_VALUE_BYTES 时在字符边界截断，
+ * 以 0x00 0x02 结束：这样的值只按截断后的前缀参与查找，结果是候选行，调用方需要重新判断。
+ *
+ * 内部节点按子节点数选用 4 / 16 / 48 / 256 四种大小（ART 的 Node4/16/48/256），
+ * 压缩路径完整保存在节点中；叶子保存完整的键。NULL 不进索引。
+ *
+ * 存储（页类型均为 TRIE_NODE_PAGE）：
+ * - 元数据页：magic、版本、根节点引用、条目数、当前分配页、空闲页链表头
+ * - 节点页：带槽目录的记录页，每个节点或叶子一条变长记录；引用 = 页ID << 16 | 槽号，
+ *   叶子引用带最高位标记。节点变大或变小时记录优先在原页内重新分配
+ * - 删除记录后空出较多空间的页挂到空闲页链表，新记录在当前分配页放不下时先复用这些页
+ */
+class TrieIndex {
+public:
+    /**
+     * @brief 值编码的最大字节数（含结束标记），超过时截断
+     */
+    static constexpr int MAX_VALUE_BYTES = 1024;
+
+    /**
+     * @brief 按键序遍历某个前缀下的全部条目（节点在用到时才读）
+     */
+    class Cursor {
+    public:
+        /**
+         * @param keyPrefix 编码后的键前缀（encodePrefix / encodeValue 的结果，空表示整个索引）
+         */
+        Cursor(const TrieIndex* index, const QByteArray& keyPrefix);
+
+        /**
+         * @brief 取下一个条目
+         * @param value 输出：条目的值（截断的值只有截断后的部分）
+         * @return 已取完或读页失败时返回 false（用 hasError 区分）
+         */
+        bool next(QString& value, RowId& rowId);
+
+        /**
+         * @brief 上一个返回的值是否被截断过
+         */
+        bool valueTruncated() const { return truncated_; }
+
+        bool hasError() const { return error_; }
+
+    private:
+        const TrieIndex* index_;
+        QByteArray prefix_;
+        QVector<uint64_t> stack_;       // 待访问的引用，栈顶是键序最小的
+        bool truncated_ = false;
+        bool error_ = false;
+    };
+
+    /**
+     * @brief 构造函数
+     * @param bufferPool 缓冲池管理器
+     * @param metaPageId 元数据页ID（新索引为 INVALID_PAGE_ID，随后调用 create）
+     */
+    explicit TrieIndex(BufferPoolManager* bufferPool, PageId metaPageId = INVALID_PAGE_ID);
+
+    /**
+     * @brief 列类型能否建 TRIE 索引（字符串类型）
+     */
+    static bool isIndexableType(DataType type);
+
+    /**
+     * @brief 列值在索引中的形式：CHAR 去掉填充空格（与 KeyComparator、表页读出的值一致），其他类型原样
+     *
+     * 建索引、DML 维护和等值查找都要先经过这里，否则带填充空格的值与读出的值对不上
+     */
+    static QString normalizeValue(const QString& value, DataType type);
+
+    /**
+     * @brief 值的完整编码（含结束标记，不含行ID）
+     */
+    static QByteArray encodeValue(const QString& value);
+
+    /**
+     * @brief 前缀的编码（不含结束标记），以它开头的键就是以该前缀开头的值
+     */
+    static QByteArray encodePrefix(const QString& prefix);
+
+    /**
+     * @brief 分配元数据页，创建空索引
+     */
+    bool create();
+
+    /**
+     * @brief 从元数据页加载根节点引用和条目数
+     */
+    bool load();
+
+    bool insert(const QString& value, RowId rowId);
+
+    /**
+     * @brief 删除一个条目（值和行ID都要一致）
+     * @return 条目不存在或写页失败时返回 false
+     */
+    bool remove(const QString& value, RowId rowId);
+
+    /**
+     * @brief 从零构建（只能在空索引上调用）：条目排序后自底向上一次写好每个节点
+     * @param entries 值和行ID，调用中会被重新排序
+     */
+    bool bulkLoad(QVector<QPair<QString, RowId>> entries);
+
+    /**
+     * @brief 取值等于 value 的全部行
+     */
+    bool lookup(const QString& value, QVector<RowId>& rowIds) const;
+
+    /**
+     * @brief 按值的顺序取以 prefix 开头的行
+     * @param limit 最多取多少行（<= 0 表示不限）
+     * @param values 可选输出：与 rowIds 一一对应的值
+     */
+    bool prefixSearch(const QString& prefix, int limit, QVector<RowId>& rowIds,
+                      QStringList* values = nullptr) const;
+
+    /**
+     * @brief 检查树的结构：内部节点至少两个子节点、节点大小与子节点数相符、
+     *        子节点字节升序、叶子的键与路径一致、条目总数与元数据一致
+     */
+    bool checkStructure() const;
+
+    /**
+     * @brief 释放索引占用的全部页（含元数据页）
+     */
+    void destroy();
+
+    PageId getMetaPageId() const { return metaPageId_; }
+    uint64_t size() const { return entryCount_; }
+
+private:
+    /**
+     * @brief 内部节点的大小类别（决定记录布局和容量）
+     */
+    enum class NodeKind : uint8_t {
+        NODE4 = 1,
+        NODE16 = 2,
+        NODE48 = 3,
+        NODE256 = 4
+    };
+
+    /**
+     * @brief 解码后的内部节点：keys[i] 为 children[i] 对应的字节，升序
+     */
+    struct Node {
+        NodeKind kind = NodeKind::NODE4;
+        QByteArray prefix;              // 压缩路径
+        QByteArray keys;
+        QVector<uint64_t> children;
+
+        int findChild(uint8_t byte) const;
+        void addChild(uint8_t byte, uint64_t child);
+    };
+
+    static QByteArray makeKey(const QString& value, RowId rowId);
+    static bool isLeaf(uint64_t ref);
+
+    bool readNode(uint64_t ref, Node& node) const;
+    bool readLeaf(uint64_t ref, QByteArray& key) const;
+    bool writeNode(uint64_t& ref, Node& node);
+    bool writeLeaf(const QByteArray& key, uint64_t& ref);
+
+    bool readRecord(uint64_t ref, QByteArray& record) const;
+    bool writeRecord(uint64_t& ref, const QByteArray& record);
+    bool allocateRecord(const QByteArray& record, uint64_t& ref);
+    bool tryAllocateInPage(PageId pageId, const QByteArray& record, uint64_t& ref);
+    bool freeRecord(uint64_t ref);
+    bool popFreePage(bool& popped);
+    bool allocateNodePage(PageId& pageId);
+    bool writeMeta();
+
+    bool insertAt(uint64_t& ref, const QByteArray& key, int depth, bool& inserted);
+    bool removeAt(uint64_t& ref, const QByteArray& key, int depth, bool& removed);
+    bool buildSubtree(const QVector<QByteArray>& keys, int from, int to, int depth, uint64_t& ref);
+    bool checkSubtree(uint64_t ref, const QByteArray& path, uint64_t& leafCount) const;
+
+    BufferPoolManager* bufferPool_;
+    PageId metaPageId_;
+    uint64_t rootRef_ = 0;              // 0 表示空树
+    uint64_t entryCount_ = 0;
+    PageId fillPageId_ = INVALID_PAGE_ID;  // 新记录优先放入的节点页（最近分配的页，页链表的表头）
+    PageId freePageId_ = INVALID_PAGE_ID;  // 空闲页链表的表头
+};
+
+} // namespace qindb
+
+#endif // QINDB_TRIE_INDEX_H
@@ -804,6 +804,7 @@ int runClientMode(const QString& connectionString) {
                 if (op == "save") { sendAndWait("SAVE"); continue; }
                 if (op == "vacuum") { QString arg = parts.size()>=2 ? parts[1] : QString(); sendAndWait(arg.isEmpty() ? "VACUUM" : QString("VACUUM %1").arg(arg)); continue; }
                 if (op == "analyze") { QString arg = parts.size()>=2 ? parts[1] : QString(); sendAndWait(arg.isEmpty() ? "ANALYZE" : QString("ANALYZE TABLE %1").arg(arg)); continue; }
+                if (op == "calibrate") { sendAndWait("CALIBRATE"); continue; }
                 if (op == "explain") {
                     int p = cmd.indexOf(' ');
                     QString rest = p>=0 ? cmd.mid(p+1) : QString();
@@ -1096,6 +1097,7 @@ void runInteractiveMode(qindb::Executor* executor, qindb::DatabaseManager* dbMan
                 if (op == "save") { execSql("SAVE"); sqlBuffer.clear(); continue; }
                 if (op == "vacuum") { QString arg = parts.size()>=2 ? parts[1] : QString(); execSql(arg.isEmpty() ? "VACUUM" : QString("VACUUM %1").arg(arg)); sqlBuffer.clear(); continue; }
                 if (op == "analyze") { QString arg = parts.size()>=2 ? parts[1] : QString(); execSql(arg.isEmpty() ? "ANALYZE" : QString("ANALYZE TABLE %1").arg(arg)); sqlBuffer.clear(); continue; }
+                if (op == "calibrate") { execSql("CALIBRATE"); sqlBuffer.clear(); continue; }
                 if (op == "explain") { int p = cmd.indexOf(' '); QString rest = p>=0 ? cmd.mid(p+1) : QString(); if (!rest.isEmpty()) { execSql(QString("EXPLAIN %1").arg(rest)); } sqlBuffer.clear(); continue; }
                 if (op == "i" && parts.size() >= 2) {
                     QString filePath = cmd.mid(2).trimmed();
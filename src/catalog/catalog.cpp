@@ -2,6 +2,8 @@
 #include "qindb/catalog_db_backend.h"  // 包含目录数据库后端的头文件
 #include "qindb/logger.h"          // 包含日志系统的头文件
 #include "qindb/config.h"          // 包含配置系统的头文件
+#include "qindb/statistics.h"      // 包含统计信息的头文件
+#include "qindb/cardinality_feedback.h"  // 包含基数反馈的头文件
 #include <QFile>                   // 包含Qt文件操作类
 #include <QDataStream>            // 包含Qt数据流操作类
 #include <QJsonDocument>          // 包含Qt JSON文档类
@@ -15,7 +17,8 @@ namespace qindb {
  * 初始化目录对象，并根据配置设置持久化模式（数据库或文件）
  */
 Catalog::Catalog()
-    : useDatabase_(false)         // 初始化使用数据库标志为false
+    : cardinalityFeedback_(std::make_unique<CardinalityFeedback>())  // 基数反馈存储
+    , useDatabase_(false)         // 初始化使用数据库标志为false
 {
     // 从配置读取持久化模式
     useDatabase_ = !Config::instance().isCatalogUseFile();
@@ -66,6 +69,7 @@ bool Catalog::createTable(const TableDef& tableDef) {
     }
 
     tables_[lowerName] = std::make_shared<TableDef>(tableDef);
+    tableStats_.remove(lowerName);
 
     LOG_INFO(QString("Created table '%1' with %2 columns")
                  .arg(tableDef.name)
@@ -98,6 +102,8 @@ bool Catalog::dropTable(const QString& tableName) {
     }
 
     tables_.remove(lowerName);
+    tableStats_.remove(lowerName);
+    cardinalityFeedback_->invalidateTable(lowerName);
 
     LOG_INFO(QString("Dropped table '%1'").arg(tableName));
 
@@ -190,6 +196,34 @@ bool Catalog::dropIndex(const QString& indexName) {
     return true;
 }
 
+bool Catalog::setIndexRootPageId(const QString& indexName, PageId rootPageId) {
+    QMutexLocker locker(&mutex_);
+
+    QString lowerName = indexName.toLower();
+
+    auto it = indexes_.find(lowerName);
+    if (it == indexes_.end()) {
+        LOG_ERROR(QString("Index '%1' does not exist").arg(indexName));
+        return false;
+    }
+
+    it.value().rootPageId = rootPageId;
+
+    QString tableName = it.value().tableName.toLower();
+    if (tables_.contains(tableName)) {
+        for (IndexDef& index : tables_[tableName]->indexes) {
+            if (index.name.toLower() == lowerName) {
+                index.rootPageId = rootPageId;
+                break;
+            }
+        }
+    }
+
+    LOG_DEBUG(QString("Index '%1' root page changed to %2").arg(indexName).arg(rootPageId));
+
+    return true;
+}
+
 const IndexDef* Catalog::getIndex(const QString& indexName) const {
     QMutexLocker locker(&mutex_);
 
@@ -228,13 +262,43 @@ bool Catalog::updateTable(const QString& tableName, const TableDef& newDef) {
         return false;
     }
 
-    tables_[lowerName] = std::make_shared<TableDef>(newDef);
+    // 索引由 createIndex/dropIndex/setIndexRootPageId 维护，保留目录中的索引列表，
+    // 避免调用方持有的旧副本覆盖执行期间更新过的根页
+    auto updated = std::make_shared<TableDef>(newDef);
+    updated->indexes = tables_[lowerName]->indexes;
+    tables_[lowerName] = updated;
 
     LOG_INFO(QString("Updated table '%1'").arg(tableName));
 
     return true;
 }
 
+void Catalog::setTableStats(const TableStats& stats) {
+    QMutexLocker locker(&mutex_);
+    tableStats_[stats.tableName.toLower()] = std::make_shared<const TableStats>(stats);
+}
+
+std::shared_ptr<const TableStats> Catalog::getTableStats(const QString& tableName) const {
+    QMutexLocker locker(&mutex_);
+    return tableStats_.value(tableName.toLower());
+}
+
+std::shared_ptr<const TableStats> Catalog::applyTableModifications(const QString& tableName,
+                                                                   size_t rowsInserted,
+                                                                   size_t rowsDeleted,
+                                                                   size_t rowsUpdated) {
+    QMutexLocker locker(&mutex_);
+    auto it = tableStats_.find(tableName.toLower());
+    if (it == tableStats_.end() || !it.value()) {
+        return nullptr;
+    }
+
+    auto updated = std::make_shared<TableStats>(*it.value());
+    updated->applyModifications(rowsInserted, rowsDeleted, rowsUpdated);
+    it.value() = updated;
+    return updated;
+}
+
 bool Catalog::saveToDisk(const QString& filePath) {
     QMutexLocker locker(&mutex_);
 
@@ -287,10 +351,35 @@ bool Catalog::saveToDisk(const QString& filePath) {
             }
             idxObj["columns"] = colsArray;
 
+            if (!idx.includeColumns.isEmpty()) {
+                QJsonArray includeArray;
+                for (const auto& colName : idx.includeColumns) {
+                    includeArray.append(colName);
+                }
+                idxObj["includeColumns"] = includeArray;
+            }
+
+            if (idx.hasKeyExpressions()) {
+                QJsonArray exprArray;
+                for (const auto& expr : idx.keyExpressions) {
+                    exprArray.append(expr);
+                }
+                idxObj["keyExpressions"] = exprArray;
+            }
+            if (idx.isPartial()) {
+                idxObj["predicate"] = idx.predicate;
+            }
+
             indexesArray.append(idxObj);
         }
         tableObj["indexes"] = indexesArray;
 
+        // 优化器统计信息
+        auto statsIt = tableStats_.constFind(it.key());
+        if (statsIt != tableStats_.constEnd()) {
+            tableObj["statistics"] = statsIt.value()->toJson();
+        }
+
         tablesArray.append(tableObj);
     }
 
@@ -333,6 +422,7 @@ bool Catalog::loadFromDisk(const QString& filePath) {
 
     tables_.clear();
     indexes_.clear();
+    tableStats_.clear();
 
     for (const auto& tableValue : tablesArray) {
         QJsonObject tableObj = tableValue.toObject();
@@ -376,12 +466,24 @@ bool Catalog::loadFromDisk(const QString& filePath) {
             for (const auto& colName : colsArray) {
                 idx.columns.append(colName.toString());
             }
+            for (const auto& colName : idxObj["includeColumns"].toArray()) {
+                idx.includeColumns.append(colName.toString());
+            }
+            for (const auto& expr : idxObj["keyExpressions"].toArray()) {
+                idx.keyExpressions.append(expr.toString());
+            }
+            idx.predicate = idxObj["predicate"].toString();
 
             table.indexes.append(idx);
             indexes_[idx.name.toLower()] = idx;
         }
 
         tables_[table.name.toLower()] = std::make_shared<TableDef>(table);
+
+        if (tableObj.contains("statistics")) {
+            tableStats_[table.name.toLower()] =
+                std::make_shared<const TableStats>(TableStats::fromJson(tableObj["statistics"].toObject()));
+        }
     }
 
     LOG_INFO(QString("Loaded catalog from %1 (%2 tables)")
@@ -415,7 +517,7 @@ bool Catalog::saveToDatabase() {
         return false;
     }
 
-    if (!dbBackend_->saveCatalog(tables_, indexes_)) {
+    if (!dbBackend_->saveCatalog(tables_, indexes_, tableStats_)) {
         LOG_ERROR("Failed to save catalog to database");
         return false;
     }
@@ -432,7 +534,7 @@ bool Catalog::loadFromDatabase() {
         return false;
     }
 
-    if (!dbBackend_->loadCatalog(tables_, indexes_)) {
+    if (!dbBackend_->loadCatalog(tables_, indexes_, tableStats_)) {
         LOG_ERROR("Failed to load catalog from database");
         return false;
     }
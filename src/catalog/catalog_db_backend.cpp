@@ -3,7 +3,11 @@
 #include "qindb/disk_manager.h"       // 包含磁盘管理器的头文件
 #include "qindb/table_page.h"        // 包含表页面的头文件
 #include "qindb/logger.h"            // 包含日志记录的头文件
+#include "qindb/statistics.h"        // 包含统计信息的头文件
 #include <QDataStream>               // 包含Qt数据流操作的头文件
+#include <QJsonDocument>             // 包含Qt JSON文档类
+#include <algorithm>
+#include <cstring>
 
 namespace qindb {  // 定义qindb命名空间
 
@@ -107,7 +111,8 @@ bool CatalogDbBackend::createSystemTables() {
 
 bool CatalogDbBackend::saveCatalog(
     const QHash<QString, std::shared_ptr<TableDef>>& tables,
-    const QHash<QString, IndexDef>& indexes)
+    const QHash<QString, IndexDef>& indexes,
+    const QHash<QString, std::shared_ptr<const TableStats>>& stats)
 {
     LOG_INFO("Saving catalog to database");
 
@@ -118,9 +123,35 @@ bool CatalogDbBackend::saveCatalog(
         sysIndexesFirstPage_ = 3;
     }
 
+    // 先把变化了的统计信息写成新页链：写失败的表只保存定义，统计信息等下次 ANALYZE
+    QHash<QString, StatsChain> newStatsChains;
+    QVector<PageId> writtenChains;
+    for (auto it = stats.constBegin(); it != stats.constEnd(); ++it) {
+        if (!it.value() || !tables.contains(it.key())) {
+            continue;
+        }
+        auto cached = statsChains_.constFind(it.key());
+        if (cached != statsChains_.constEnd() && cached->snapshot == it.value()) {
+            newStatsChains.insert(it.key(), cached.value());
+            continue;
+        }
+        StatsChain chain;
+        chain.snapshot = it.value();
+        chain.firstPageId = writeStatsChain(*it.value());
+        if (chain.firstPageId == INVALID_PAGE_ID) {
+            LOG_WARN(QString("Failed to save statistics of table '%1'").arg(it.value()->tableName));
+            continue;
+        }
+        writtenChains.append(chain.firstPageId);
+        newStatsChains.insert(it.key(), chain);
+    }
+
     // 清空现有数据
     if (!clearSystemTables()) {
         LOG_ERROR("Failed to clear system tables");
+        for (PageId pageId : writtenChains) {
+            freeStatsChain(pageId);
+        }
         return false;
     }
 
@@ -128,7 +159,8 @@ bool CatalogDbBackend::saveCatalog(
     for (auto it = tables.begin(); it != tables.end(); ++it) {
         const TableDef& table = *it.value();
 
-        if (!saveTableDef(table)) {
+        const PageId statsPageId = newStatsChains.value(it.key()).firstPageId;
+        if (!saveTableDef(table, statsPageId)) {
             LOG_ERROR(QString("Failed to save table '%1'").arg(table.name));
             return false;
         }
@@ -154,13 +186,22 @@ bool CatalogDbBackend::saveCatalog(
     // 刷新所有页面到磁盘
     bufferPool_->flushAllPages();
 
+    // 新记录落盘后才释放不再引用的旧页链
+    for (auto it = statsChains_.constBegin(); it != statsChains_.constEnd(); ++it) {
+        auto current = newStatsChains.constFind(it.key());
+        if (current == newStatsChains.constEnd() || current->firstPageId != it->firstPageId) {
+            freeStatsChain(it->firstPageId);
+        }
+    }
+    statsChains_ = newStatsChains;
+
     LOG_INFO(QString("Catalog saved: %1 tables, %2 indexes")
         .arg(tables.size()).arg(indexes.size()));
 
     return true;
 }
 
-bool CatalogDbBackend::saveTableDef(const TableDef& table) {
+bool CatalogDbBackend::saveTableDef(const TableDef& table, PageId statsPageId) {
     // 序列化表定义
     QByteArray data;
     QDataStream stream(&data, QIODevice::WriteOnly);
@@ -169,6 +210,9 @@ bool CatalogDbBackend::saveTableDef(const TableDef& table) {
     stream << static_cast<qint64>(table.firstPageId);
     stream << static_cast<qint64>(table.nextRowId);
 
+    // 统计信息页链首页追加在末尾（旧数据读不到时没有统计信息）
+    stream << static_cast<qint64>(statsPageId);
+
     // 插入到sys_tables表
     Page* page = bufferPool_->fetchPage(sysTablesFirstPage_);
     if (!page) {
@@ -183,6 +227,102 @@ bool CatalogDbBackend::saveTableDef(const TableDef& table) {
     return success;
 }
 
+PageId CatalogDbBackend::writeStatsChain(const TableStats& stats) {
+    // 长度前缀 + 紧凑 JSON，按页头之后的空间依次写入，页头的 freeSpaceOffset 记录每页用到的位置
+    const QByteArray json = QJsonDocument(stats.toJson()).toJson(QJsonDocument::Compact);
+    QByteArray data;
+    QDataStream stream(&data, QIODevice::WriteOnly);
+    stream << json;
+
+    const int capacity = static_cast<int>(PAGE_SIZE - sizeof(PageHeader));
+    PageId firstPageId = INVALID_PAGE_ID;
+    PageId prevPageId = INVALID_PAGE_ID;
+    for (int offset = 0; offset < data.size(); offset += capacity) {
+        PageId pageId = INVALID_PAGE_ID;
+        Page* page = bufferPool_->newPage(&pageId);
+        if (!page) {
+            LOG_ERROR("Failed to allocate statistics page");
+            freeStatsChain(firstPageId);
+            return INVALID_PAGE_ID;
+        }
+
+        const int n = std::min(capacity, static_cast<int>(data.size()) - offset);
+        page->setPageType(PageType::METADATA_PAGE);
+        page->setPrevPageId(prevPageId);
+        std::memcpy(page->getData() + sizeof(PageHeader), data.constData() + offset, n);
+        page->getHeader()->freeSpaceOffset = static_cast<uint16_t>(sizeof(PageHeader) + n);
+        page->getHeader()->freeSpaceSize = static_cast<uint16_t>(capacity - n);
+        bufferPool_->unpinPage(pageId, true);
+
+        if (prevPageId == INVALID_PAGE_ID) {
+            firstPageId = pageId;
+        } else {
+            Page* prevPage = bufferPool_->fetchPage(prevPageId);
+            if (!prevPage) {
+                LOG_ERROR(QString("Failed to fetch statistics page %1").arg(prevPageId));
+                freeStatsChain(firstPageId);
+                bufferPool_->deletePage(pageId);
+                return INVALID_PAGE_ID;
+            }
+            prevPage->setNextPageId(pageId);
+            bufferPool_->unpinPage(prevPageId, true);
+        }
+        prevPageId = pageId;
+    }
+    return firstPageId;
+}
+
+bool CatalogDbBackend::readStatsChain(PageId firstPageId, TableStats& stats) {
+    QByteArray data;
+    PageId pageId = firstPageId;
+    while (pageId != INVALID_PAGE_ID) {
+        Page* page = bufferPool_->fetchPage(pageId);
+        if (!page) {
+            LOG_ERROR(QString("Failed to fetch statistics page %1").arg(pageId));
+            return false;
+        }
+        if (page->getPageType() != PageType::METADATA_PAGE) {
+            LOG_ERROR(QString("Page %1 is not a statistics page").arg(pageId));
+            bufferPool_->unpinPage(pageId, false);
+            return false;
+        }
+        const uint16_t used = std::clamp<uint16_t>(page->getHeader()->freeSpaceOffset,
+                                                   sizeof(PageHeader), PAGE_SIZE);
+        data.append(page->getData() + sizeof(PageHeader), used - sizeof(PageHeader));
+        const PageId nextPageId = page->getNextPageId();
+        bufferPool_->unpinPage(pageId, false);
+        pageId = nextPageId;
+    }
+
+    QDataStream stream(data);
+    QByteArray json;
+    stream >> json;
+    if (stream.status() != QDataStream::Ok) {
+        return false;
+    }
+    QJsonDocument doc = QJsonDocument::fromJson(json);
+    if (!doc.isObject()) {
+        return false;
+    }
+    stats = TableStats::fromJson(doc.object());
+    return true;
+}
+
+void CatalogDbBackend::freeStatsChain(PageId firstPageId) {
+    PageId pageId = firstPageId;
+    while (pageId != INVALID_PAGE_ID) {
+        Page* page = bufferPool_->fetchPage(pageId);
+        if (!page) {
+            LOG_WARN(QString("Failed to fetch statistics page %1 while freeing").arg(pageId));
+            return;
+        }
+        const PageId nextPageId = page->getNextPageId();
+        bufferPool_->unpinPage(pageId, false);
+        bufferPool_->deletePage(pageId);
+        pageId = nextPageId;
+    }
+}
+
 bool CatalogDbBackend::saveColumnDef(const QString& tableName, const ColumnDef& column, int order) {
     // 序列化列定义
     QByteArray data;
@@ -228,6 +368,14 @@ bool CatalogDbBackend::saveIndexDef(const IndexDef& index) {
     QString columnsStr = index.columns.join(",");
     stream << columnsStr;
 
+    // INCLUDE 列追加在末尾，旧数据读不到时为空
+    stream << index.includeColumns.join(",");
+
+    // 表达式键和部分索引谓词：表达式文本里可能有逗号，列名列表整体另存一份
+    stream << QStringList(index.columns.begin(), index.columns.end());
+    stream << QStringList(index.keyExpressions.begin(), index.keyExpressions.end());
+    stream << index.predicate;
+
     // 插入到sys_indexes表
     Page* page = bufferPool_->fetchPage(sysIndexesFirstPage_);
     if (!page) {
@@ -244,7 +392,8 @@ bool CatalogDbBackend::saveIndexDef(const IndexDef& index) {
 
 bool CatalogDbBackend::loadCatalog(
     QHash<QString, std::shared_ptr<TableDef>>& tables,
-    QHash<QString, IndexDef>& indexes)
+    QHash<QString, IndexDef>& indexes,
+    QHash<QString, std::shared_ptr<const TableStats>>& stats)
 {
     LOG_INFO("Loading catalog from database");
 
@@ -257,9 +406,10 @@ bool CatalogDbBackend::loadCatalog(
 
     tables.clear();
     indexes.clear();
+    stats.clear();
 
     // 加载表定义
-    if (!loadTableDefs(tables)) {
+    if (!loadTableDefs(tables, stats)) {
         LOG_ERROR("Failed to load table definitions");
         return false;
     }
@@ -282,7 +432,8 @@ bool CatalogDbBackend::loadCatalog(
     return true;
 }
 
-bool CatalogDbBackend::loadTableDefs(QHash<QString, std::shared_ptr<TableDef>>& tables) {
+bool CatalogDbBackend::loadTableDefs(QHash<QString, std::shared_ptr<TableDef>>& tables,
+                                     QHash<QString, std::shared_ptr<const TableStats>>& stats) {
     Page* page = bufferPool_->fetchPage(sysTablesFirstPage_);
     if (!page) {
         LOG_ERROR("Failed to fetch sys_tables page");
@@ -291,6 +442,7 @@ bool CatalogDbBackend::loadTableDefs(QHash<QString, std::shared_ptr<TableDef>>&
 
     // 遍历所有元组
     uint16_t slotCount = TablePage::getSlotCount(page);
+    QHash<QString, PageId> statsPageIds;
 
     for (uint16_t i = 0; i < slotCount; ++i) {
         QByteArray tupleData;
@@ -311,9 +463,34 @@ bool CatalogDbBackend::loadTableDefs(QHash<QString, std::shared_ptr<TableDef>>&
         table->nextRowId = static_cast<RowId>(nextRowId);
 
         tables[tableName.toLower()] = table;
+
+        // 统计信息页链首页（旧格式的记录没有这一项）
+        if (tupleData.size() - stream.device()->pos() == static_cast<qint64>(sizeof(qint64))) {
+            qint64 statsPageId;
+            stream >> statsPageId;
+            statsPageIds.insert(tableName.toLower(), static_cast<PageId>(statsPageId));
+        }
     }
 
     bufferPool_->unpinPage(sysTablesFirstPage_, false);
+
+    // 读页链时不再固定 sys_tables 页
+    statsChains_.clear();
+    for (auto it = statsPageIds.constBegin(); it != statsPageIds.constEnd(); ++it) {
+        if (it.value() == INVALID_PAGE_ID) {
+            continue;
+        }
+        TableStats tableStats;
+        if (!readStatsChain(it.value(), tableStats)) {
+            LOG_WARN(QString("Failed to load statistics of table '%1'").arg(it.key()));
+            continue;
+        }
+        StatsChain chain;
+        chain.snapshot = std::make_shared<const TableStats>(tableStats);
+        chain.firstPageId = it.value();
+        stats.insert(it.key(), chain.snapshot);
+        statsChains_.insert(it.key(), chain);
+    }
     return true;
 }
 
@@ -411,6 +588,22 @@ bool CatalogDbBackend::loadIndexDefs(
             index.columns.append(col);
         }
 
+        if (!stream.atEnd()) {
+            QString includeStr;
+            stream >> includeStr;
+            for (const QString& col : includeStr.split(",", Qt::SkipEmptyParts)) {
+                index.includeColumns.append(col);
+            }
+        }
+
+        if (!stream.atEnd()) {
+            QStringList columns;
+            QStringList keyExpressions;
+            stream >> columns >> keyExpressions >> index.predicate;
+            index.columns = QVector<QString>(columns.begin(), columns.end());
+            index.keyExpressions = QVector<QString>(keyExpressions.begin(), keyExpressions.end());
+        }
+
         indexes[indexName.toLower()] = index;
 
         // 同时添加到表定义中
@@ -401,6 +401,9 @@ bool DatabaseManager::initializeDatabase(const QString& dbName) {
     // 创建事务管理器
     dbDef->transactionManager = std::make_unique<TransactionManager>(dbDef->walManager.get());
 
+    // 创建后台统计信息收集器
+    dbDef->autoAnalyzer = std::make_unique<AutoAnalyzeWorker>(dbDef->catalog.get(), dbDef->bufferPool.get());
+
     // 保存Catalog（使用 save() 方法自动选择模式）
     if (!dbDef->catalog->save(dbPath + "/" + Config::instance().getCatalogFilePath())) {
         m_error = Error(ErrorCode::IO_ERROR,
@@ -504,6 +507,9 @@ bool DatabaseManager::loadDatabase(const QString& dbName) {
     // 创建事务管理器
     dbDef->transactionManager = std::make_unique<TransactionManager>(dbDef->walManager.get());
 
+    // 创建后台统计信息收集器
+    dbDef->autoAnalyzer = std::make_unique<AutoAnalyzeWorker>(dbDef->catalog.get(), dbDef->bufferPool.get());
+
     // 执行WAL恢复
     LOG_INFO(QString("Performing WAL recovery for database '%1'").arg(dbName));
     if (!dbDef->walManager->recover(dbDef->catalog.get(), dbDef->bufferPool.get())) {
@@ -522,6 +528,9 @@ void DatabaseManager::closeDatabase(const QString& dbName) {
     LOG_INFO(QString("Closing database '%1'...").arg(dbName));
     auto it = m_databases.find(dbName);
     if (it != m_databases.end()) {
+        // 先停止后台统计信息收集，收集结果随 Catalog 一起保存
+        it->second->autoAnalyzer.reset();
+
         // 保存Catalog（根据配置自动选择模式）
         LOG_INFO(QString("Saving catalog for database '%1'...").arg(dbName));
         QString catalogPath = it->second->path + "/" + Config::instance().getCatalogFilePath();
@@ -591,6 +600,21 @@ TransactionManager* DatabaseManager::getCurrentTransactionManager() const {
     return it->second->transactionManager.get();
 }
 
+AutoAnalyzeWorker* DatabaseManager::getCurrentAutoAnalyzer() const {
+    QMutexLocker locker(&m_mutex);
+
+    if (m_currentDatabase.isEmpty()) {
+        return nullptr;
+    }
+
+    auto it = m_databases.find(m_currentDatabase);
+    if (it == m_databases.end()) {
+        return nullptr;
+    }
+
+    return it->second->autoAnalyzer.get();
+}
+
 TransactionId DatabaseManager::getCurrentTransactionId() const {
     QMutexLocker locker(&m_mutex);
     return m_currentTransactionId;
@@ -19,6 +19,74 @@ Config& Config::instance() {
     return instance;
 }
 
+/**
+ * @brief 读取配置文件开头的注释块（QSettings 写回文件时会丢掉所有注释）
+ */
+static QString readCommentHeader(const QString& path) {
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        return QString();
+    }
+
+    QString header;
+    QTextStream in(&file);
+    while (!in.atEnd()) {
+        const QString line = in.readLine();
+        if (!line.startsWith(';') && !line.trimmed().isEmpty()) {
+            break;
+        }
+        header += line + '\n';
+    }
+    return header;
+}
+
+/**
+ * @brief 把注释块写回配置文件开头
+ */
+static bool prependCommentHeader(const QString& path, const QString& header) {
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        return false;
+    }
+    const QString content = file.readAll();
+    file.close();
+
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        return false;
+    }
+    QTextStream out(&file);
+    out << header << content;
+    return true;
+}
+
+/**
+ * @brief 从 [Optimizer] 节读取成本参数（缺少的键保持 params 中的值）
+ */
+static void readCostParams(QSettings& settings, CostParams& params) {
+    params.seqPageReadCost = settings.value("Optimizer/SeqPageReadCost", params.seqPageReadCost).toDouble();
+    params.randomPageReadCost = settings.value("Optimizer/RandomPageReadCost", params.randomPageReadCost).toDouble();
+    params.pageWriteCost = settings.value("Optimizer/PageWriteCost", params.pageWriteCost).toDouble();
+    params.tupleProcessCost = settings.value("Optimizer/TupleProcessCost", params.tupleProcessCost).toDouble();
+    params.operatorCost = settings.value("Optimizer/OperatorCost", params.operatorCost).toDouble();
+    params.indexSearchCost = settings.value("Optimizer/IndexSearchCost", params.indexSearchCost).toDouble();
+    params.memoryUseCost = settings.value("Optimizer/MemoryUseCost", params.memoryUseCost).toDouble();
+    params.networkTransferCost = settings.value("Optimizer/NetworkTransferCost", params.networkTransferCost).toDouble();
+}
+
+/**
+ * @brief 把成本参数写入 [Optimizer] 节
+ */
+static void writeCostParams(QSettings& settings, const CostParams& params) {
+    settings.setValue("Optimizer/SeqPageReadCost", params.seqPageReadCost);
+    settings.setValue("Optimizer/RandomPageReadCost", params.randomPageReadCost);
+    settings.setValue("Optimizer/PageWriteCost", params.pageWriteCost);
+    settings.setValue("Optimizer/TupleProcessCost", params.tupleProcessCost);
+    settings.setValue("Optimizer/OperatorCost", params.operatorCost);
+    settings.setValue("Optimizer/IndexSearchCost", params.indexSearchCost);
+    settings.setValue("Optimizer/MemoryUseCost", params.memoryUseCost);
+    settings.setValue("Optimizer/NetworkTransferCost", params.networkTransferCost);
+}
+
 /**
  * @brief Config类的构造函数，加载默认配置
  */
@@ -36,6 +104,7 @@ void Config::loadDefaults() {
     slowQueryEnabled_ = false;
     slowQueryThresholdMs_ = 500;
     slowQueryLogPath_ = "qindb_slow.log";
+    misestimateFactor_ = 10.0;        // 实际行数与估算相差 10 倍以上视为误估
 
     // 系统日志配置
     systemLogPath_ = "qindb.log";
@@ -52,6 +121,12 @@ void Config::loadDefaults() {
     walUseFile_ = true;               // 默认使用独立文件存储WAL日志
     walFilePath_ = "qindb.wal";
 
+    // 索引配置
+    indexBulkLoadFillFactor_ = 0.9;   // 批量构建时预留10%空间给后续插入
+
+    // 优化器成本参数默认值
+    costParams_ = CostParams::defaults();
+
     // 网络配置
     networkEnabled_ = false;          // 默认不启用网络服务器
     serverAddress_ = "0.0.0.0";       // 监听所有网卡
@@ -85,6 +160,7 @@ bool Config::load(const QString& configPath) {
     slowQueryEnabled_ = settings.value("Output/SlowQueryEnabled", slowQueryEnabled_).toBool();
     slowQueryThresholdMs_ = settings.value("Output/SlowQueryThresholdMs", slowQueryThresholdMs_).toInt();
     slowQueryLogPath_ = settings.value("Output/SlowQueryLogPath", slowQueryLogPath_).toString();
+    misestimateFactor_ = settings.value("Output/MisestimateFactor", misestimateFactor_).toDouble();
 
     // 读取系统日志配置
     systemLogPath_ = settings.value("SystemLog/LogPath", systemLogPath_).toString();
@@ -100,6 +176,12 @@ bool Config::load(const QString& configPath) {
     walUseFile_ = settings.value("Persistence/WalUseFile", walUseFile_).toBool();
     walFilePath_ = settings.value("Persistence/WalFilePath", walFilePath_).toString();
 
+    // 读取索引配置
+    indexBulkLoadFillFactor_ = settings.value("Index/BulkLoadFillFactor", indexBulkLoadFillFactor_).toDouble();
+
+    // 读取优化器成本参数
+    readCostParams(settings, costParams_);
+
     // 读取网络配置
     networkEnabled_ = settings.value("Network/Enabled", networkEnabled_).toBool();
     serverAddress_ = settings.value("Network/Address", serverAddress_).toString();
@@ -137,6 +219,7 @@ bool Config::save() {
     settings.setValue("Output/SlowQueryEnabled", slowQueryEnabled_);
     settings.setValue("Output/SlowQueryThresholdMs", slowQueryThresholdMs_);
     settings.setValue("Output/SlowQueryLogPath", slowQueryLogPath_);
+    settings.setValue("Output/MisestimateFactor", misestimateFactor_);
 
     // 保存系统日志配置
     settings.setValue("SystemLog/LogPath", systemLogPath_);
@@ -152,6 +235,12 @@ bool Config::save() {
     settings.setValue("Persistence/WalUseFile", walUseFile_);
     settings.setValue("Persistence/WalFilePath", walFilePath_);
 
+    // 保存索引配置
+    settings.setValue("Index/BulkLoadFillFactor", indexBulkLoadFillFactor_);
+
+    // 保存优化器成本参数
+    writeCostParams(settings, costParams_);
+
     // 保存网络配置
     settings.setValue("Network/Enabled", networkEnabled_);
     settings.setValue("Network/Address", serverAddress_);
@@ -169,6 +258,43 @@ bool Config::save() {
     return settings.status() == QSettings::NoError;
 }
 
+CostParams Config::getCostParams() const {
+    QMutexLocker locker(&mutex_);
+    return costParams_;
+}
+
+void Config::setCostParams(const CostParams& params) {
+    QMutexLocker locker(&mutex_);
+    costParams_ = params;
+}
+
+bool Config::saveCostParams() {
+    QMutexLocker locker(&mutex_);
+
+    if (configPath_.isEmpty()) {
+        configPath_ = "qindb.ini";
+    }
+
+    // 只改 [Optimizer] 节的值；QSettings 重写文件时丢掉的说明注释写完后放回文件开头
+    const QString header = readCommentHeader(configPath_);
+    {
+        QSettings settings(configPath_, QSettings::IniFormat);
+        writeCostParams(settings, costParams_);
+        settings.sync();
+        if (settings.status() != QSettings::NoError) {
+            LOG_ERROR(QString("Failed to save cost parameters to: %1").arg(configPath_));
+            return false;
+        }
+    }
+    if (!header.isEmpty() && !prependCommentHeader(configPath_, header)) {
+        LOG_ERROR(QString("Failed to restore comments in: %1").arg(configPath_));
+        return false;
+    }
+
+    LOG_INFO(QString("Cost parameters saved to: %1").arg(configPath_));
+    return true;
+}
+
 bool Config::createDefaultConfig(const QString& configPath) {
     QSettings settings(configPath, QSettings::IniFormat);
 
@@ -181,6 +307,7 @@ bool Config::createDefaultConfig(const QString& configPath) {
     settings.setValue("Output/SlowQueryEnabled", false);
     settings.setValue("Output/SlowQueryThresholdMs", 500);
     settings.setValue("Output/SlowQueryLogPath", "qindb_slow.log");
+    settings.setValue("Output/MisestimateFactor", 10.0);
 
     // 系统日志配置
     settings.setValue("SystemLog/LogPath", "qindb.log");
@@ -195,6 +322,10 @@ bool Config::createDefaultConfig(const QString& configPath) {
     settings.setValue("Persistence/CatalogFilePath", "catalog.json");
     settings.setValue("Persistence/WalUseFile", true);
     settings.setValue("Persistence/WalFilePath", "qindb.wal");
+    // 索引配置
+    settings.setValue("Index/BulkLoadFillFactor", 0.9);
+    // 优化器成本参数
+    writeCostParams(settings, CostParams::defaults());
     // 网络配置
     settings.setValue("Network/Enabled", false);
     settings.setValue("Network/Address", "0.0.0.0");
@@ -240,6 +371,19 @@ bool Config::createDefaultConfig(const QString& configPath) {
             out << ";   CatalogFilePath      - Path to catalog JSON file (when CatalogUseFile=true)\n";
             out << ";   WalUseFile           - Store WAL logs in separate file (true) or database (false)\n";
             out << ";   WalFilePath          - Path to WAL log file (when WalUseFile=true)\n";
+            out << "; \n";
+            out << "; [Index] section controls index construction\n";
+            out << ";   BulkLoadFillFactor   - Page fill factor for bulk-built B+ tree indexes (0.5-1.0, default: 0.9)\n";
+            out << "; \n";
+            out << "; [Optimizer] section holds cost model parameters (run CALIBRATE to measure them on this machine)\n";
+            out << ";   SeqPageReadCost      - Cost of reading one page sequentially (the cost unit, default: 1.0)\n";
+            out << ";   RandomPageReadCost   - Cost of reading one page at a random position (default: 4.0)\n";
+            out << ";   PageWriteCost        - Cost of writing one page (default: 2.0)\n";
+            out << ";   TupleProcessCost     - Cost of decoding and processing one row (default: 0.01)\n";
+            out << ";   OperatorCost         - Cost of evaluating one operator (default: 0.005)\n";
+            out << ";   IndexSearchCost      - Cost of one index lookup (default: 0.02)\n";
+            out << ";   MemoryUseCost        - Cost per byte of memory used (default: 0.0001)\n";
+            out << ";   NetworkTransferCost  - Cost per byte sent over the network (default: 0.1)\n";
             out << "; \n\n";
             out << content;
             file.close();
@@ -16,8 +16,17 @@
 #include "qindb/expression_evaluator.h"
 #include "qindb/bplus_tree.h"
 #include "qindb/generic_bplustree.h"
+#include "qindb/composite_index.h"
+#include "qindb/key_encoder.h"
+#include "qindb/index_expression.h"
 #include "qindb/hash_index.h"
+#include "qindb/hash_util.h"
 #include "qindb/inverted_index.h"
+#include "qindb/block_range_index.h"
+#include "qindb/bitmap_index.h"
+#include "qindb/rtree_index.h"
+#include "qindb/trie_index.h"
+#include "qindb/geometry.h"
 #include "qindb/key_comparator.h"
 #include "qindb/visibility_checker.h"
 #include "qindb/vacuum.h"
@@ -28,12 +37,542 @@
 #include "qindb/query_cache.h"
 #include "qindb/table_cache.h"
 #include "qindb/result_exporter.h"
+#include "qindb/config.h"
+#include "qindb/cardinality_feedback.h"
+#include "qindb/cost_calibrator.h"
+#include <QDateTime>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QMutex>
+#include <QTextStream>
 #include <algorithm>
+#include <cstring>
+#include <limits>
 
 namespace qindb {
 
 using namespace ast;  // 使用AST命名空间
 
+/**
+ * @brief 哈希连接的键哈希：两侧连接列同为整数、同为浮点数或同为字符串时才能按键匹配
+ * @return NULL 或类型不支持时返回 false（NULL 不与任何值相等）
+ */
+static bool hashJoinKey(const QVariant& value, DataType type, uint64_t seed, uint64_t& hash) {
+    if (value.isNull()) {
+        return false;
+    }
+    if (isIntegerType(type)) {
+        hash = HashUtil::hashInt(static_cast<uint64_t>(value.toLongLong()), seed);
+    } else if (isFloatType(type)) {
+        const double d = value.toDouble();
+        const double normalized = d == 0.0 ? 0.0 : d;  // -0.0 与 0.0 相等，哈希也要相同
+        uint64_t bits;
+        memcpy(&bits, &normalized, sizeof(bits));
+        hash = HashUtil::hashInt(bits, seed);
+    } else if (isStringType(type)) {
+        const QString text = value.toString();
+        hash = HashUtil::hashBytes(text.constData(), static_cast<size_t>(text.size()) * sizeof(QChar), seed);
+    } else {
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief 哈希值相同的两个连接键是否真正相等（哈希冲突时按值确认）
+ */
+static bool hashJoinKeysEqual(const QVariant& left, const QVariant& right, DataType type) {
+    if (isIntegerType(type)) {
+        return left.toLongLong() == right.toLongLong();
+    }
+    if (isFloatType(type)) {
+        return left.toDouble() == right.toDouble();
+    }
+    return left.toString() == right.toString();
+}
+
+/**
+ * @brief 两侧连接列的类型能否用同一种键做哈希连接
+ */
+static bool hashJoinCompatible(DataType leftType, DataType rightType) {
+    return (isIntegerType(leftType) && isIntegerType(rightType)) ||
+           (isFloatType(leftType) && isFloatType(rightType)) ||
+           (isStringType(leftType) && isStringType(rightType));
+}
+
+/**
+ * @brief 执行计划中由执行器逐个执行的节点：底部的扫描或连接，及其上的聚合、排序和 LIMIT
+ */
+struct PlanStages {
+    PlanNode* input = nullptr;
+    PlanNode* aggregate = nullptr;
+    PlanNode* sort = nullptr;
+    PlanNode* limit = nullptr;
+};
+
+static PlanStages findPlanStages(PlanNode* root) {
+    PlanStages stages;
+    PlanNode* node = root;
+    while (node && node->children.size() == 1) {
+        if (node->nodeType == PlanNodeType::LIMIT) {
+            stages.limit = node;
+        } else if (node->nodeType == PlanNodeType::SORT) {
+            stages.sort = node;
+        } else if (node->nodeType == PlanNodeType::AGGREGATE) {
+            stages.aggregate = node;
+        } else {
+            break;
+        }
+        node = node->children[0].get();
+    }
+    stages.input = node;
+    return stages;
+}
+
+/**
+ * @brief 记录计划节点的实际行数和耗时
+ * @param startNsecs 节点开始时 timer 的读数（耗时 = 现在 - 开始）
+ */
+static void recordActuals(PlanNode* node, qsizetype rows, const QElapsedTimer& timer, qint64 startNsecs = 0) {
+    if (!node) {
+        return;
+    }
+    node->executed = true;
+    node->actualRows = static_cast<size_t>(rows);
+    node->actualTimeMs = (timer.nsecsElapsed() - startNsecs) / 1e6;
+}
+
+/**
+ * @brief 计划节点类型的显示名（EXPLAIN 和慢查询日志使用）
+ */
+static QString planNodeTypeName(PlanNodeType type) {
+    switch (type) {
+        case PlanNodeType::SEQ_SCAN:
+            return "SeqScan";
+        case PlanNodeType::INDEX_SCAN:
+            return "IndexScan";
+        case PlanNodeType::INDEX_ONLY_SCAN:
+            return "IndexOnlyScan";
+        case PlanNodeType::BLOCK_RANGE_SCAN:
+            return "BlockRangeScan";
+        case PlanNodeType::BITMAP_SCAN:
+            return "BitmapScan";
+        case PlanNodeType::TRIE_SCAN:
+            return "TrieScan";
+        case PlanNodeType::NESTED_LOOP_JOIN:
+            return "NestedLoopJoin";
+        case PlanNodeType::HASH_JOIN:
+            return "HashJoin";
+        case PlanNodeType::SORT_MERGE_JOIN:
+            return "SortMergeJoin";
+        case PlanNodeType::SORT:
+            return "Sort";
+        case PlanNodeType::AGGREGATE:
+            return "Aggregate";
+        case PlanNodeType::LIMIT:
+            return "Limit";
+        default:
+            return "Unknown";
+    }
+}
+
+/**
+ * @brief 计划节点涉及的表（小写）
+ */
+static void collectPlanTables(const PlanNode* node, QStringList& tables) {
+    if (!node) {
+        return;
+    }
+    if (!node->tableName.isEmpty() && !tables.contains(node->tableName.toLower())) {
+        tables.append(node->tableName.toLower());
+    }
+    for (const auto& child : node->children) {
+        collectPlanTables(child.get(), tables);
+    }
+}
+
+/**
+ * @brief 节点或其下的扫描是否取够 LIMIT 行就停止（实际行数只是一部分，不能与估算比较）
+ */
+static bool stoppedEarly(const PlanNode* node) {
+    if (node->stoppedEarly) {
+        return true;
+    }
+    for (const auto& child : node->children) {
+        if (stoppedEarly(child.get())) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief 把执行过的节点的实际行数记入基数反馈，并找出实际行数与估算相差超过 factor 倍的节点
+ *
+ * 只看基于统计信息估算的节点（estimated 为 true），缺省估算的偏差没有意义；
+ * 提前停止的扫描及其上层节点不记录，否则 LIMIT k 的 k 行会被当作同一条件的行数
+ */
+static void recordCardinalityFeedback(const PlanNode* node, CardinalityFeedback* feedback,
+                                      double factor, QStringList& misestimates) {
+    if (!node) {
+        return;
+    }
+    if (node->executed && node->estimated && !stoppedEarly(node)) {
+        if (feedback && !node->feedbackKey.isEmpty()) {
+            QStringList tables;
+            collectPlanTables(node, tables);
+            feedback->record(node->feedbackKey, tables, node->feedbackBaseRows, node->actualRows);
+        }
+
+        const double estimatedRows = static_cast<double>(std::max<size_t>(node->cost.estimatedRows, 1));
+        const double actualRows = static_cast<double>(std::max<size_t>(node->actualRows, 1));
+        if (factor > 1.0 && std::max(estimatedRows / actualRows, actualRows / estimatedRows) > factor) {
+            QString description = planNodeTypeName(node->nodeType);
+            if (!node->tableName.isEmpty()) {
+                description += " on " + node->tableName;
+            }
+            misestimates.append(QString("%1: estimated %2 rows, actual %3")
+                                    .arg(description).arg(node->cost.estimatedRows).arg(node->actualRows));
+        }
+    }
+    for (const auto& child : node->children) {
+        recordCardinalityFeedback(child.get(), feedback, factor, misestimates);
+    }
+}
+
+/**
+ * @brief 把基数误估的计划记入慢查询日志（超过时间阈值的语句由命令行在执行后记录）
+ */
+static void writeMisestimateLog(const QString& sql, double elapsedMs, const QStringList& misestimates) {
+    const Config& config = Config::instance();
+    if (!config.isSlowQueryEnabled() || misestimates.isEmpty()) {
+        return;
+    }
+
+    static QMutex logMutex;
+    QMutexLocker locker(&logMutex);
+
+    QFile logFile(config.getSlowQueryLogPath());
+    if (!logFile.open(QIODevice::Append | QIODevice::Text)) {
+        LOG_WARN(QString("Failed to open slow query log '%1'").arg(config.getSlowQueryLogPath()));
+        return;
+    }
+
+    QTextStream out(&logFile);
+    QString timestamp = QDateTime::currentDateTime().toString("yyyy-MM-dd HH:mm:ss");
+    out << "[" << timestamp << "] " << qRound64(elapsedMs) << " ms | " << sql << "\n";
+    for (const QString& misestimate : misestimates) {
+        out << "  MISESTIMATE " << misestimate << "\n";
+    }
+}
+
+/**
+ * @brief 查找列上的单列哈希索引
+ */
+static bool findHashIndex(Catalog* catalog, const QString& tableName,
+                          const QString& columnName, IndexDef& indexOut) {
+    QVector<IndexDef> tableIndexes = catalog->getTableIndexes(tableName);
+    for (const auto& indexDef : tableIndexes) {
+        if (indexDef.indexType == qindb::IndexType::HASH &&
+            indexDef.columns.size() == 1 &&
+            indexDef.columns[0].compare(columnName, Qt::CaseInsensitive) == 0 &&
+            indexDef.rootPageId != INVALID_PAGE_ID) {
+            indexOut = indexDef;
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief 查找列上的位图索引
+ */
+static bool findBitmapIndex(Catalog* catalog, const QString& tableName,
+                            const QString& columnName, IndexDef& indexOut) {
+    QVector<IndexDef> tableIndexes = catalog->getTableIndexes(tableName);
+    for (const auto& indexDef : tableIndexes) {
+        if (indexDef.indexType == qindb::IndexType::BITMAP &&
+            indexDef.columns.size() == 1 &&
+            indexDef.columns[0].compare(columnName, Qt::CaseInsensitive) == 0 &&
+            indexDef.rootPageId != INVALID_PAGE_ID) {
+            indexOut = indexDef;
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief 查找列上的 R 树空间索引
+ */
+static bool findRTreeIndex(Catalog* catalog, const QString& tableName,
+                           const QString& columnName, IndexDef& indexOut) {
+    QVector<IndexDef> tableIndexes = catalog->getTableIndexes(tableName);
+    for (const auto& indexDef : tableIndexes) {
+        if (indexDef.indexType == qindb::IndexType::RTREE &&
+            indexDef.columns.size() == 1 &&
+            indexDef.columns[0].compare(columnName, Qt::CaseInsensitive) == 0 &&
+            indexDef.rootPageId != INVALID_PAGE_ID) {
+            indexOut = indexDef;
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief 查找列上的 TRIE 索引
+ */
+static bool findTrieIndex(Catalog* catalog, const QString& tableName,
+                          const QString& columnName, IndexDef& indexOut) {
+    QVector<IndexDef> tableIndexes = catalog->getTableIndexes(tableName);
+    for (const auto& indexDef : tableIndexes) {
+        if (indexDef.indexType == qindb::IndexType::TRIE &&
+            indexDef.columns.size() == 1 &&
+            indexDef.columns[0].compare(columnName, Qt::CaseInsensitive) == 0 &&
+            indexDef.rootPageId != INVALID_PAGE_ID) {
+            indexOut = indexDef;
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief 检查常量能否按索引键类型探测
+ *
+ * NULL 不进索引；类型不匹配的常量（例如 INT 列和 1.5）序列化后与存储的键不同，
+ * 这两种情况都退回全表扫描，由 WHERE 求值给出结果
+ */
+static bool isHashProbeKey(const QVariant& value, DataType keyType) {
+    if (value.isNull()) {
+        return false;
+    }
+
+    const int type = value.userType();
+    const bool isInteger = type == QMetaType::Int || type == QMetaType::LongLong ||
+                           type == QMetaType::UInt || type == QMetaType::ULongLong;
+
+    if (isIntegerType(keyType)) {
+        return isInteger;
+    }
+    if (isFloatType(keyType)) {
+        return isInteger || type == QMetaType::Double || type == QMetaType::Float;
+    }
+    if (isStringType(keyType)) {
+        return type == QMetaType::QString;
+    }
+    return false;
+}
+
+/**
+ * @brief 复合布局索引的键布局
+ *
+ * 普通列记下表中的下标；表达式键（如 lower(email)）下标为 -1，保存解析后的表达式。
+ * 部分索引另外保存谓词，只有满足谓词的行才进入索引。
+ */
+struct IndexKeyLayout {
+    QVector<int> columnIndexes;
+    QVector<std::shared_ptr<const Expression>> expressions;
+    QVector<DataType> columnTypes;
+    std::shared_ptr<const Expression> predicate;
+};
+
+/**
+ * @brief 解析复合布局索引的键：列不存在或表达式无法解析时返回 false
+ */
+static bool resolveIndexColumns(const TableDef* table, const IndexDef& indexDef, IndexKeyLayout& layout) {
+    layout = IndexKeyLayout();
+    for (int i = 0; i < indexDef.columns.size(); ++i) {
+        if (indexDef.isKeyExpression(i)) {
+            std::shared_ptr<const Expression> expr = IndexExpression::parseCached(indexDef.keyExpressions[i]);
+            if (!expr) {
+                LOG_WARN(QString("Failed to parse expression '%1' of index '%2'")
+                             .arg(indexDef.keyExpressions[i], indexDef.name));
+                return false;
+            }
+            layout.columnIndexes.append(-1);
+            layout.expressions.append(expr);
+            layout.columnTypes.append(IndexExpression::inferType(expr.get(), *table));
+            continue;
+        }
+
+        int index = table->getColumnIndex(indexDef.columns[i]);
+        if (index < 0) {
+            return false;
+        }
+        layout.columnIndexes.append(index);
+        layout.expressions.append(nullptr);
+        layout.columnTypes.append(table->columns[index].type);
+    }
+
+    if (indexDef.isPartial()) {
+        layout.predicate = IndexExpression::parseCached(indexDef.predicate);
+        if (!layout.predicate) {
+            LOG_WARN(QString("Failed to parse predicate '%1' of index '%2'")
+                         .arg(indexDef.predicate, indexDef.name));
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief 从一行中取出复合索引各键的值组成复合键（表达式键在这一行上求值，出错时按 NULL 处理）
+ */
+static CompositeKey buildCompositeKey(const QVector<QVariant>& row, const IndexKeyLayout& layout,
+                                      const TableDef* table, ExpressionEvaluator& evaluator) {
+    CompositeKey key;
+    for (int i = 0; i < layout.columnIndexes.size(); ++i) {
+        if (layout.expressions[i]) {
+            QVariant value = evaluator.evaluateWithRow(layout.expressions[i].get(), table, row);
+            key.addValue(evaluator.hasError() ? QVariant() : value, layout.columnTypes[i]);
+        } else {
+            key.addValue(row.value(layout.columnIndexes[i]), layout.columnTypes[i]);
+        }
+    }
+    return key;
+}
+
+/**
+ * @brief 行是否属于索引（全表索引总是 true，部分索引要求谓词为真）
+ */
+static bool rowInIndex(const QVector<QVariant>& row, const IndexKeyLayout& layout,
+                       const TableDef* table, ExpressionEvaluator& evaluator) {
+    if (!layout.predicate) {
+        return true;
+    }
+    QVariant result = evaluator.evaluateWithRow(layout.predicate.get(), table, row);
+    return !evaluator.hasError() && !result.isNull() && result.toBool();
+}
+
+/**
+ * @brief WHERE 中 键 op 常量 形式的比较（常量在左侧时已翻转运算符）
+ *
+ * 键是列时 subject 为列名；是其他表达式时为规范化 SQL，用来和表达式索引的键逐字匹配。
+ */
+struct ColumnPredicate {
+    QString subject;
+    bool isColumn;
+    BinaryOp op;
+    QVariant value;
+};
+
+/**
+ * @brief 展开 AND 连接的条件，收集 键 =/</<=/>/>= 常量 形式的比较
+ */
+static void collectColumnPredicates(const Expression* expr, QVector<ColumnPredicate>& predicates) {
+    const BinaryExpression* binExpr = dynamic_cast<const BinaryExpression*>(expr);
+    if (!binExpr) {
+        return;
+    }
+
+    if (binExpr->op == BinaryOp::AND) {
+        collectColumnPredicates(binExpr->left.get(), predicates);
+        collectColumnPredicates(binExpr->right.get(), predicates);
+        return;
+    }
+
+    BinaryOp op = binExpr->op;
+    if (op != BinaryOp::EQ && op != BinaryOp::LT && op != BinaryOp::LE &&
+        op != BinaryOp::GT && op != BinaryOp::GE) {
+        return;
+    }
+
+    const Expression* keyExpr = binExpr->left.get();
+    const LiteralExpression* litExpr = dynamic_cast<const LiteralExpression*>(binExpr->right.get());
+    if (!litExpr || dynamic_cast<const LiteralExpression*>(keyExpr)) {
+        // 常量 op 键：翻转为 键 op' 常量
+        keyExpr = binExpr->right.get();
+        litExpr = dynamic_cast<const LiteralExpression*>(binExpr->left.get());
+        if (!litExpr || dynamic_cast<const LiteralExpression*>(keyExpr)) {
+            return;
+        }
+        if (op == BinaryOp::LT) op = BinaryOp::GT;
+        else if (op == BinaryOp::LE) op = BinaryOp::GE;
+        else if (op == BinaryOp::GT) op = BinaryOp::LT;
+        else if (op == BinaryOp::GE) op = BinaryOp::LE;
+    }
+
+    if (const auto* colExpr = dynamic_cast<const ColumnExpression*>(keyExpr)) {
+        predicates.append({colExpr->column, true, op, litExpr->value});
+    } else {
+        predicates.append({IndexExpression::toSql(keyExpr), false, op, litExpr->value});
+    }
+}
+
+/**
+ * @brief 比较条件是否作用在索引的第 i 个键上
+ */
+static bool predicateMatchesKey(const ColumnPredicate& predicate, const IndexDef& indexDef, int i) {
+    if (indexDef.isKeyExpression(i)) {
+        return !predicate.isColumn && predicate.subject == indexDef.keyExpressions[i];
+    }
+    return predicate.isColumn && predicate.subject.compare(indexDef.columns[i], Qt::CaseInsensitive) == 0;
+}
+
+/**
+ * @brief 索引是否使用复合键布局（多列、带 INCLUDE 列、表达式键或部分索引的 B+ 树索引）
+ */
+static bool usesCompositeLayout(const IndexDef& indexDef) {
+    return indexDef.indexType == qindb::IndexType::BTREE &&
+           (indexDef.columns.size() > 1 || !indexDef.includeColumns.isEmpty() ||
+            indexDef.hasKeyExpressions() || indexDef.isPartial());
+}
+
+/**
+ * @brief 解析索引的包含列（INCLUDE）：返回各列在表中的下标和类型，有列不存在时返回 false
+ */
+static bool resolveIncludeColumns(const TableDef* table, const IndexDef& indexDef,
+                                  QVector<int>& includeIndexes, QVector<DataType>& includeTypes) {
+    includeIndexes.clear();
+    includeTypes.clear();
+    for (const QString& name : indexDef.includeColumns) {
+        int index = table->getColumnIndex(name);
+        if (index < 0) {
+            return false;
+        }
+        includeIndexes.append(index);
+        includeTypes.append(table->columns[index].type);
+    }
+    return true;
+}
+
+/**
+ * @brief 从一行中取出包含列的值
+ */
+static QVector<QVariant> buildIncludedValues(const QVector<QVariant>& row, const QVector<int>& includeIndexes) {
+    QVector<QVariant> included;
+    included.reserve(includeIndexes.size());
+    for (int index : includeIndexes) {
+        included.append(row.value(index));
+    }
+    return included;
+}
+
+/**
+ * @brief 识别空间函数前两个参数中的 (列, 常量几何对象)，列可以在任一侧
+ * @param constant 输出：不引用任何列的另一个参数
+ * @return 列表达式，不是这种形式时返回 nullptr
+ */
+static const ColumnExpression* matchSpatialArguments(const FunctionCallExpression* function, const TableDef* table,
+                                                     const Expression*& constant) {
+    if (function->arguments.size() < 2) {
+        return nullptr;
+    }
+    for (int side = 0; side < 2; ++side) {
+        const auto* colExpr = dynamic_cast<const ColumnExpression*>(function->arguments[side].get());
+        const Expression* other = function->arguments[1 - side].get();
+        QSet<int> referenced;
+        if (colExpr && IndexExpression::collectReferencedColumns(other, table, referenced) && referenced.isEmpty()) {
+            constant = other;
+            return colExpr;
+        }
+    }
+    return nullptr;
+}
+
 /**
  * @brief 构造函数 - 初始化执行器
  * @param dbManager 数据库管理器指针
@@ -71,7 +610,7 @@ Executor::~Executor() {
  * 3. 索引操作（CREATE/DROP INDEX）
  * 4. 事务操作（BEGIN/COMMIT/ROLLBACK）
  * 5. 用户和权限管理（CREATE/DROP USER, GRANT/REVOKE）
- * 6. 维护操作（VACUUM/ANALYZE/EXPLAIN）
+ * 6. 维护操作（VACUUM/ANALYZE/CALIBRATE/EXPLAIN）
  */
 QueryResult Executor::execute(const std::unique_ptr<ASTNode>& ast) {
     if (!ast) {
@@ -107,7 +646,9 @@ QueryResult Executor::execute(const std::unique_ptr<ASTNode>& ast) {
         if (!ensurePermission(dbManager_->currentDatabaseName(), insertStmt->tableName, PermissionType::INSERT, permError)) {
             return permError;
         }
-        return executeInsert(insertStmt);
+        QueryResult result = executeInsert(insertStmt);
+        flushPendingIndexes();
+        return result;
     }
     if (auto* selectStmt = dynamic_cast<const SelectStatement*>(ast.get())) {
         QueryResult permError;
@@ -121,14 +662,18 @@ QueryResult Executor::execute(const std::unique_ptr<ASTNode>& ast) {
         if (!ensurePermission(dbManager_->currentDatabaseName(), updateStmt->tableName, PermissionType::UPDATE, permError)) {
             return permError;
         }
-        return executeUpdate(updateStmt);
+        QueryResult result = executeUpdate(updateStmt);
+        flushPendingIndexes();
+        return result;
     }
     if (auto* deleteStmt = dynamic_cast<const DeleteStatement*>(ast.get())) {
         QueryResult permError;
         if (!ensurePermission(dbManager_->currentDatabaseName(), deleteStmt->tableName, PermissionType::DELETE, permError)) {
             return permError;
         }
-        return executeDelete(deleteStmt);
+        QueryResult result = executeDelete(deleteStmt);
+        flushPendingIndexes();
+        return result;
     }
     
     // 查询操作
@@ -154,6 +699,9 @@ QueryResult Executor::execute(const std::unique_ptr<ASTNode>& ast) {
     if (auto* analyzeStmt = dynamic_cast<const AnalyzeStatement*>(ast.get())) {
         return executeAnalyze(analyzeStmt);
     }
+    if (auto* calibrateStmt = dynamic_cast<const ast::CalibrateStatement*>(ast.get())) {
+        return executeCalibrate(calibrateStmt);
+    }
     if (auto* explainStmt = dynamic_cast<const ExplainStatement*>(ast.get())) {
         return executeExplain(explainStmt);
     }
@@ -417,6 +965,7 @@ QueryResult Executor::executeInsert(const InsertStatement* stmt) {
 
         // 从第一页开始查找有足够空间的页
         PageId currentPageId = mutableTable.firstPageId;
+        PageId insertedPageId = INVALID_PAGE_ID;
         bool inserted = false;
 
         while (currentPageId != INVALID_PAGE_ID && !inserted) {
@@ -462,6 +1011,7 @@ QueryResult Executor::executeInsert(const InsertStatement* stmt) {
 
                     inserted = true;
                     insertedCount++;
+                    insertedPageId = currentPageId;
                     bufferPool->unpinPage(currentPageId, true);  // 标记为脏页
                     break;
                 }
@@ -541,6 +1091,7 @@ QueryResult Executor::executeInsert(const InsertStatement* stmt) {
 
                 inserted = true;
                 insertedCount++;
+                insertedPageId = newPageId;
             }
 
             bufferPool->unpinPage(newPageId, true);
@@ -553,31 +1104,9 @@ QueryResult Executor::executeInsert(const InsertStatement* stmt) {
         }
 
         // 更新所有索引
-        QVector<IndexDef> tableIndexes = catalog->getTableIndexes(stmt->tableName);
-        for (const auto& indexDef : tableIndexes) {
-            // 只处理单列索引
-            if (indexDef.columns.size() != 1) continue;
-
-            QString columnName = indexDef.columns[0];
-            int columnIndex = table->getColumnIndex(columnName);
-            if (columnIndex < 0) continue;
-
-            // 获取索引键值
-            QVariant keyValue = values[columnIndex];
-            if (keyValue.isNull()) continue; // 跳过NULL值
-
-            // 使用通用 B+ 树插入（支持所有数据类型）
-            RowId lastInsertedRowId = mutableTable.nextRowId - 1;
-            GenericBPlusTree genericBTree(bufferPool, indexDef.keyType, indexDef.rootPageId);
-
-            if (!genericBTree.insert(keyValue, lastInsertedRowId)) {
-                LOG_WARN(QString("Failed to update index '%1' for inserted row")
-                            .arg(indexDef.name));
-            } else {
-                LOG_DEBUG(QString("Updated index '%1': inserted key")
-                             .arg(indexDef.name));
-            }
-        }
+        RowId lastInsertedRowId = mutableTable.nextRowId - 1;
+        maintainIndexes(catalog, bufferPool, table, nullptr, INVALID_ROW_ID, &values, lastInsertedRowId, txnId,
+                        insertedPageId);
     }
 
     // 更新表定义到 Catalog（保存 nextRowId 和 rowIdIndex）
@@ -599,6 +1128,9 @@ QueryResult Executor::executeInsert(const InsertStatement* stmt) {
         LOG_INFO(QString("Transaction %1 committed (auto-commit)").arg(txnId));
     }
 
+    // 增量维护统计信息中的行数（事务提交后才计入），改动累计较多时在后台重新收集
+    recordStatsChange(stmt->tableName, insertedCount, 0, 0, autoCommit);
+
     // 保存 Catalog 到磁盘（确保 nextRowId 持久化）
     QString dbPath = dbManager_->getDatabasePath(dbManager_->currentDatabaseName());
     QString catalogPath = dbPath + "/catalog.json";
@@ -632,7 +1164,7 @@ QueryResult Executor::executeInsert(const InsertStatement* stmt) {
                                    .arg(stmt->tableName));
 }
 
-QueryResult Executor::executeSelect(const SelectStatement* stmt) {
+QueryResult Executor::executeSelect(const SelectStatement* stmt, std::unique_ptr<PlanNode>* analyzedPlan) {
     if (!stmt) {
         return createErrorResult(ErrorCode::INTERNAL_ERROR, "Invalid SELECT statement");
     }
@@ -668,7 +1200,7 @@ QueryResult Executor::executeSelect(const SelectStatement* stmt) {
     QueryResult cachedResult;
     bool usedCache = false;
 
-    if (queryCache_ && queryCache_->isEnabled() && actualStmt->from) {
+    if (!analyzedPlan && queryCache_ && queryCache_->isEnabled() && actualStmt->from) {
         // 生成缓存键（简化实现：使用表名 + WHERE toString）
         querySql = QString("SELECT FROM %1").arg(fromTable);
         if (actualStmt->where) {
@@ -715,12 +1247,22 @@ QueryResult Executor::executeSelect(const SelectStatement* stmt) {
                                     QString("Table '%1' does not exist").arg(leftTableName));
         }
 
+        // 执行计划：访问路径、连接算法和构建侧、聚合/排序/LIMIT 都按它执行。
+        // 表没有统计信息时计划只是缺省估算（estimated 为 false），访问路径仍按规则选择
+        std::unique_ptr<PlanNode> plan = buildSelectPlan(catalog, bufferPool, actualStmt);
+        if (!plan) {
+            return createErrorResult(ErrorCode::INTERNAL_ERROR, "Failed to generate execution plan");
+        }
+        const PlanStages stages = findPlanStages(plan.get());
+        QElapsedTimer planTimer;
+        planTimer.start();
+
         // 创建表达式求值器（用于WHERE子句和JOIN条件）
         ExpressionEvaluator evaluator(catalog);
 
         // 检查是否有JOIN子句
         if (!actualStmt->joins.empty()) {
-            // 执行JOIN操作（NestedLoopJoin）
+            // 执行JOIN操作（按计划的连接算法）
             LOG_INFO(QString("Executing JOIN: %1 tables").arg(actualStmt->joins.size() + 1));
 
             // 获取右表信息
@@ -741,6 +1283,16 @@ QueryResult Executor::executeSelect(const SelectStatement* stmt) {
                 result.columnNames.append(rightTableName + "." + col.name);
             }
 
+            // 计划中的连接节点：只有一个 JOIN 时与这里执行的连接对应。
+            // 哈希连接的 children[0] 是构建侧；嵌套循环的 children[0] 是外表（左表）
+            PlanNode* joinNode = actualStmt->joins.size() == 1 && stages.input &&
+                                 stages.input->children.size() == 2 ? stages.input : nullptr;
+            const bool leftFirst = !joinNode || joinNode->nodeType != PlanNodeType::HASH_JOIN ||
+                                   (joinNode->children[0]->tableName.compare(leftTableName, Qt::CaseInsensitive) == 0 &&
+                                    leftTableName.compare(rightTableName, Qt::CaseInsensitive) != 0);
+            PlanNode* leftScanNode = joinNode ? joinNode->children[leftFirst ? 0 : 1].get() : nullptr;
+            PlanNode* rightScanNode = joinNode ? joinNode->children[leftFirst ? 1 : 0].get() : nullptr;
+
             // 读取左表的所有记录
             QVector<QVector<QVariant>> leftRecords;
             PageId leftPageId = leftTable->firstPageId;
@@ -762,76 +1314,312 @@ QueryResult Executor::executeSelect(const SelectStatement* stmt) {
                 bufferPool->unpinPage(leftPageId, false);
                 leftPageId = nextPageId;
             }
+            recordActuals(leftScanNode, leftRecords.size(), planTimer);
 
-            // 读取右表的所有记录
-            QVector<QVector<QVariant>> rightRecords;
-            PageId rightPageId = rightTable->firstPageId;
+            int totalRows = 0;
 
-            while (rightPageId != INVALID_PAGE_ID) {
-                Page* page = bufferPool->fetchPage(rightPageId);
-                if (!page) {
-                    LOG_ERROR(QString("Failed to fetch page %1").arg(rightPageId));
-                    break;
-                }
+            // 等值内连接 left.col = right.col 的两侧连接列
+            int leftKeyIndex = -1;
+            int rightKeyIndex = -1;
+            IndexDef rightHashIndex;  // columns[0] 为右表连接列
+            const bool equiJoin = joinClause->type == JoinType::INNER &&
+                                  IndexExpression::matchEquiJoinColumns(joinClause->condition.get(),
+                                                                        actualStmt->from.get(), leftTable,
+                                                                        joinClause->right.get(), rightTable,
+                                                                        leftKeyIndex, rightKeyIndex);
+            if (equiJoin) {
+                rightHashIndex.columns = {rightTable->columns[rightKeyIndex].name};
+            }
 
-                QVector<QVector<QVariant>> pageRecords;
-                if (TablePage::getAllRecords(page, rightTable, pageRecords)) {
-                    rightRecords.append(pageRecords);
+            // 按计划的连接算法执行：
+            // - 嵌套循环且内表是 INDEX_SCAN：对左表每一行探测右表连接列上的哈希索引（索引嵌套循环），只读取命中的右表行
+            // - 哈希连接：两侧连接列类型一致时按键建哈希表
+            // 计划与 JOIN 对不上（多个 JOIN）时按规则：能用索引嵌套循环就用；条件不满足时都退回嵌套循环
+            bool useIndexNestedLoop = equiJoin &&
+                                      (!joinNode || (joinNode->nodeType == PlanNodeType::NESTED_LOOP_JOIN &&
+                                                     rightScanNode->nodeType == PlanNodeType::INDEX_SCAN)) &&
+                                      findHashIndex(catalog, rightTableName,
+                                                    rightHashIndex.columns.value(0), rightHashIndex);
+            const bool useHashJoin = equiJoin && joinNode && joinNode->nodeType == PlanNodeType::HASH_JOIN &&
+                                     hashJoinCompatible(leftTable->columns[leftKeyIndex].type,
+                                                        rightTable->columns[rightKeyIndex].type);
+
+            // 左表的键都要能按索引键类型探测，否则退回嵌套循环
+            if (useIndexNestedLoop) {
+                for (const auto& leftRow : leftRecords) {
+                    const QVariant& key = leftRow.value(leftKeyIndex);
+                    if (!key.isNull() && !isHashProbeKey(key, rightHashIndex.keyType)) {
+                        useIndexNestedLoop = false;
+                        break;
+                    }
                 }
-
-                PageHeader* header = page->getHeader();
-                PageId nextPageId = header->nextPageId;
-                bufferPool->unpinPage(rightPageId, false);
-                rightPageId = nextPageId;
             }
 
-            // NestedLoopJoin: 对于左表的每一行，遍历右表的所有行
-            int totalRows = 0;
-            for (const auto& leftRow : leftRecords) {
-                for (const auto& rightRow : rightRecords) {
-                    // 合并左右行
-                    QVector<QVariant> joinedRow;
-                    joinedRow.append(leftRow);
-                    joinedRow.append(rightRow);
+            if (useIndexNestedLoop) {
+                LOG_INFO(QString("Using HASH index '%1' for inner side of JOIN").arg(rightHashIndex.name));
 
-                    bool includeRow = true;
+                HashIndex hashIndex(rightHashIndex.name, rightHashIndex.keyType, bufferPool);
+                if (!hashIndex.setDirectoryPageId(rightHashIndex.rootPageId)) {
+                    return createErrorResult(ErrorCode::INTERNAL_ERROR,
+                                            QString("Failed to load hash index '%1'").arg(rightHashIndex.name));
+                }
 
-                    // 评估JOIN条件
-                    if (joinClause->condition) {
-                        // 创建临时的组合表定义用于求值
-                        // 简化实现：直接评估条件（需要扩展ExpressionEvaluator支持多表）
-                        // 这里暂时使用简化的方法
-                        QVariant joinResult = evaluator.evaluateWithRow(joinClause->condition.get(), leftTable, joinedRow);
+                // 第一步：探测所有左表键，收集需要的右表行
+                const qint64 rightStart = planTimer.nsecsElapsed();
+                QVector<std::vector<RowId>> leftMatches(leftRecords.size());
+                QSet<RowId> neededRowIds;
+                for (int i = 0; i < leftRecords.size(); ++i) {
+                    const QVariant& key = leftRecords[i].value(leftKeyIndex);
+                    if (key.isNull()) {
+                        continue;  // NULL 不与任何值相等
+                    }
+                    hashIndex.searchAll(key, leftMatches[i]);
+                    for (RowId rowId : leftMatches[i]) {
+                        neededRowIds.insert(rowId);
+                    }
+                }
 
-                        if (evaluator.hasError()) {
-                            return createErrorResult(ErrorCode::SEMANTIC_ERROR,
-                                                    QString("JOIN condition evaluation error: %1")
-                                                        .arg(evaluator.getLastError()));
-                        }
+                // 第二步：读取命中的右表行（能定位时只读这些行所在的页）
+                TransactionManager* txnManager = dbManager_->getCurrentTransactionManager();
+                TransactionId currentTxnId = dbManager_->getCurrentTransactionId();
+                if (currentTxnId == INVALID_TXN_ID) {
+                    currentTxnId = 0;
+                }
+                std::unique_ptr<VisibilityChecker> checker;
+                if (txnManager) {
+                    checker = std::make_unique<VisibilityChecker>(txnManager);
+                }
+
+                QHash<RowId, QVector<QVariant>> rightRowsById;
+                QVector<PageId> candidatePages;
+                bool candidatePagesOnly = locateRowPages(rightTable, neededRowIds, candidatePages);
+                int candidatePagePos = 0;
+                PageId currentPageId = candidatePagesOnly
+                    ? (candidatePages.isEmpty() ? INVALID_PAGE_ID : candidatePages[0])
+                    : rightTable->firstPageId;
+                if (neededRowIds.isEmpty()) {
+                    currentPageId = INVALID_PAGE_ID;
+                }
 
-                        includeRow = !joinResult.isNull() && joinResult.toBool();
+                while (currentPageId != INVALID_PAGE_ID) {
+                    Page* page = bufferPool->fetchPage(currentPageId);
+                    if (!page) {
+                        LOG_ERROR(QString("Failed to fetch page %1").arg(currentPageId));
+                        break;
                     }
 
-                    // 评估WHERE条件
-                    if (includeRow && actualStmt->where) {
-                        QVariant whereResult = evaluator.evaluateWithRow(actualStmt->where.get(), leftTable, joinedRow);
+                    QVector<QVector<QVariant>> pageRecords;
+                    QVector<RecordHeader> pageHeaders;
+                    if (TablePage::getAllRecords(page, rightTable, pageRecords, pageHeaders)) {
+                        for (int i = 0; i < pageRecords.size(); ++i) {
+                            const RecordHeader& recordHeader = pageHeaders[i];
+                            if (!neededRowIds.contains(recordHeader.rowId)) {
+                                continue;
+                            }
+                            if (checker && !checker->isVisible(recordHeader, currentTxnId)) {
+                                continue;
+                            }
+                            rightRowsById.insert(recordHeader.rowId, pageRecords[i]);
+                        }
+                    }
 
-                        if (evaluator.hasError()) {
-                            return createErrorResult(ErrorCode::SEMANTIC_ERROR,
-                                                    QString("WHERE clause evaluation error: %1")
-                                                        .arg(evaluator.getLastError()));
+                    PageHeader* header = page->getHeader();
+                    PageId nextPageId = header->nextPageId;
+                    bufferPool->unpinPage(currentPageId, false);
+                    if (candidatePagesOnly) {
+                        ++candidatePagePos;
+                        nextPageId = candidatePagePos < candidatePages.size()
+                            ? candidatePages[candidatePagePos] : INVALID_PAGE_ID;
+                    }
+                    currentPageId = nextPageId;
+                }
+
+                // 内层的估算是一次探测的行数：实际行数按每次探测平均，与估算可比
+                size_t probes = 0;
+                size_t matchedRows = 0;
+                for (int i = 0; i < leftRecords.size(); ++i) {
+                    if (leftRecords[i].value(leftKeyIndex).isNull()) {
+                        continue;
+                    }
+                    ++probes;
+                    for (RowId rowId : leftMatches[i]) {
+                        matchedRows += rightRowsById.contains(rowId) ? 1 : 0;
+                    }
+                }
+                recordActuals(rightScanNode, static_cast<qsizetype>(probes > 0 ? (matchedRows + probes / 2) / probes : 0),
+                              planTimer, rightStart);
+                if (rightScanNode) {
+                    rightScanNode->loops = std::max<size_t>(probes, 1);
+                }
+
+                // 第三步：拼接结果行（连接条件已由索引保证），再评估 WHERE
+                for (int i = 0; i < leftRecords.size(); ++i) {
+                    for (RowId rowId : leftMatches[i]) {
+                        auto it = rightRowsById.constFind(rowId);
+                        if (it == rightRowsById.constEnd()) {
+                            continue;
                         }
 
-                        includeRow = !whereResult.isNull() && whereResult.toBool();
+                        QVector<QVariant> joinedRow;
+                        joinedRow.append(leftRecords[i]);
+                        joinedRow.append(it.value());
+
+                        bool includeRow = true;
+                        if (actualStmt->where) {
+                            QVariant whereResult = evaluator.evaluateWithRow(actualStmt->where.get(), leftTable, joinedRow);
+
+                            if (evaluator.hasError()) {
+                                return createErrorResult(ErrorCode::SEMANTIC_ERROR,
+                                                        QString("WHERE clause evaluation error: %1")
+                                                            .arg(evaluator.getLastError()));
+                            }
+
+                            includeRow = !whereResult.isNull() && whereResult.toBool();
+                        }
+
+                        if (includeRow) {
+                            result.rows.append(joinedRow);
+                            totalRows++;
+                        }
+                    }
+                }
+            } else {
+                // 读取右表的所有记录
+                const qint64 rightStart = planTimer.nsecsElapsed();
+                QVector<QVector<QVariant>> rightRecords;
+                PageId rightPageId = rightTable->firstPageId;
+
+                while (rightPageId != INVALID_PAGE_ID) {
+                    Page* page = bufferPool->fetchPage(rightPageId);
+                    if (!page) {
+                        LOG_ERROR(QString("Failed to fetch page %1").arg(rightPageId));
+                        break;
                     }
 
-                    if (includeRow) {
-                        result.rows.append(joinedRow);
-                        totalRows++;
+                    QVector<QVector<QVariant>> pageRecords;
+                    if (TablePage::getAllRecords(page, rightTable, pageRecords)) {
+                        rightRecords.append(pageRecords);
+                    }
+
+                    PageHeader* header = page->getHeader();
+                    PageId nextPageId = header->nextPageId;
+                    bufferPool->unpinPage(rightPageId, false);
+                    rightPageId = nextPageId;
+                }
+                recordActuals(rightScanNode, rightRecords.size(), planTimer, rightStart);
+
+                if (useHashJoin) {
+                    // 哈希连接：构建侧（leftFirst 时是左表）按连接键建哈希表，逐行探测另一侧；
+                    // 连接条件由键相等保证
+                    const auto& buildRecords = leftFirst ? leftRecords : rightRecords;
+                    const auto& probeRecords = leftFirst ? rightRecords : leftRecords;
+                    const int buildKeyIndex = leftFirst ? leftKeyIndex : rightKeyIndex;
+                    const int probeKeyIndex = leftFirst ? rightKeyIndex : leftKeyIndex;
+                    const DataType keyType = leftTable->columns[leftKeyIndex].type;
+
+                    LOG_INFO(QString("Using HashJoin: building on '%1' (%2 rows)")
+                                .arg(leftFirst ? leftTableName : rightTableName).arg(buildRecords.size()));
+
+                    // 按键的 64 位哈希建表（每次查询取随机种子），同一哈希下的行再按值确认相等
+                    const uint64_t seed = HashUtil::randomSeed();
+                    QHash<uint64_t, QVector<int>> buildTable;
+                    buildTable.reserve(buildRecords.size());
+                    uint64_t keyHash = 0;
+                    for (int i = 0; i < buildRecords.size(); ++i) {
+                        if (hashJoinKey(buildRecords[i].value(buildKeyIndex), keyType, seed, keyHash)) {
+                            buildTable[keyHash].append(i);
+                        }
+                    }
+
+                    for (const auto& probeRow : probeRecords) {
+                        const QVariant probeKey = probeRow.value(probeKeyIndex);
+                        if (!hashJoinKey(probeKey, keyType, seed, keyHash)) {
+                            continue;  // NULL 不与任何值相等
+                        }
+                        auto it = buildTable.constFind(keyHash);
+                        if (it == buildTable.constEnd()) {
+                            continue;
+                        }
+
+                        for (int buildPos : it.value()) {
+                            const auto& buildRow = buildRecords[buildPos];
+                            if (!hashJoinKeysEqual(buildRow.value(buildKeyIndex), probeKey, keyType)) {
+                                continue;
+                            }
+                            QVector<QVariant> joinedRow;
+                            joinedRow.append(leftFirst ? buildRow : probeRow);
+                            joinedRow.append(leftFirst ? probeRow : buildRow);
+
+                            bool includeRow = true;
+                            if (actualStmt->where) {
+                                QVariant whereResult = evaluator.evaluateWithRow(actualStmt->where.get(), leftTable, joinedRow);
+
+                                if (evaluator.hasError()) {
+                                    return createErrorResult(ErrorCode::SEMANTIC_ERROR,
+                                                            QString("WHERE clause evaluation error: %1")
+                                                                .arg(evaluator.getLastError()));
+                                }
+
+                                includeRow = !whereResult.isNull() && whereResult.toBool();
+                            }
+
+                            if (includeRow) {
+                                result.rows.append(joinedRow);
+                                totalRows++;
+                            }
+                        }
+                    }
+                } else {
+                    // NestedLoopJoin: 对于左表的每一行，遍历右表的所有行
+                    for (const auto& leftRow : leftRecords) {
+                        for (const auto& rightRow : rightRecords) {
+                            // 合并左右行
+                            QVector<QVariant> joinedRow;
+                            joinedRow.append(leftRow);
+                            joinedRow.append(rightRow);
+
+                            bool includeRow = true;
+
+                            // 评估JOIN条件
+                            if (joinClause->condition) {
+                                // 创建临时的组合表定义用于求值
+                                // 简化实现：直接评估条件（需要扩展ExpressionEvaluator支持多表）
+                                // 这里暂时使用简化的方法
+                                QVariant joinResult = evaluator.evaluateWithRow(joinClause->condition.get(), leftTable, joinedRow);
+
+                                if (evaluator.hasError()) {
+                                    return createErrorResult(ErrorCode::SEMANTIC_ERROR,
+                                                            QString("JOIN condition evaluation error: %1")
+                                                                .arg(evaluator.getLastError()));
+                                }
+
+                                includeRow = !joinResult.isNull() && joinResult.toBool();
+                            }
+
+                            // 评估WHERE条件
+                            if (includeRow && actualStmt->where) {
+                                QVariant whereResult = evaluator.evaluateWithRow(actualStmt->where.get(), leftTable, joinedRow);
+
+                                if (evaluator.hasError()) {
+                                    return createErrorResult(ErrorCode::SEMANTIC_ERROR,
+                                                            QString("WHERE clause evaluation error: %1")
+                                                                .arg(evaluator.getLastError()));
+                                }
+
+                                includeRow = !whereResult.isNull() && whereResult.toBool();
+                            }
+
+                            if (includeRow) {
+                                result.rows.append(joinedRow);
+                                totalRows++;
+                            }
+                        }
                     }
                 }
             }
 
+            recordActuals(joinNode, totalRows, planTimer);
+
             result.message = QString("SELECT executed (%1 rows from JOIN)").arg(totalRows);
 
             LOG_INFO(QString("JOIN '%1' with '%2': %3 rows returned")
@@ -880,10 +1668,9 @@ QueryResult Executor::executeSelect(const SelectStatement* stmt) {
             }
 
             // 尝试使用索引优化查询
-            bool useIndex = false;
-            RowId indexRowId = INVALID_ROW_ID;
             bool useFullTextIndex = false;
-            QVector<RowId> fullTextResults;
+            scanStoppedEarly_ = false;
+            QSet<RowId> fullTextRowIds;
 
             // 检查WHERE子句是否是MATCH...AGAINST表达式
             if (actualStmt->where) {
@@ -907,26 +1694,29 @@ QueryResult Executor::executeSelect(const SelectStatement* stmt) {
                                 LOG_INFO(QString("Using FULLTEXT index '%1' for search").arg(indexDef.name));
 
                                 InvertedIndex invertedIndex(indexDef.name, bufferPool);
-                                invertedIndex.setRootPageId(indexDef.rootPageId);
-
-                                // 根据模式选择搜索方法
-                                QVector<SearchResult> searchResults;
-                                if (matchExpr->mode == ast::MatchMode::BOOLEAN) {
-                                    // AND 模式：所有词都要匹配
-                                    QStringList queryTerms = matchExpr->query.split(' ', Qt::SkipEmptyParts);
-                                    searchResults = invertedIndex.searchAnd(queryTerms, actualStmt->limit);
-                                } else {
-                                    // 自然语言模式（OR 模式）
-                                    searchResults = invertedIndex.search(matchExpr->query, actualStmt->limit);
+                                if (!invertedIndex.setRootPageId(indexDef.rootPageId)) {
+                                    LOG_WARN(QString("Failed to load FULLTEXT index '%1'").arg(indexDef.name));
+                                    continue;
                                 }
 
-                                // 提取 RowId 列表
+                                // 布尔模式所有词都要匹配（AND），自然语言模式任意词匹配（OR）；
+                                // "短语" 和 NEAR/k 在两种模式下都是必须满足的位置约束
+                                QVector<SearchResult> searchResults = invertedIndex.searchMatch(
+                                    matchExpr->query, matchExpr->mode == ast::MatchMode::BOOLEAN, actualStmt->limit);
+
+                                // 带 LIMIT 时只取得分最高的前 k 个文档
+                                if (actualStmt->limit > 0 && searchResults.size() >= actualStmt->limit) {
+                                    scanStoppedEarly_ = true;
+                                }
+
+                                // 提取 RowId 集合（扫描时 O(1) 过滤）
+                                fullTextRowIds.reserve(searchResults.size());
                                 for (const SearchResult& sr : searchResults) {
-                                    fullTextResults.append(sr.docId);
+                                    fullTextRowIds.insert(sr.docId);
                                 }
 
                                 useFullTextIndex = true;
-                                LOG_INFO(QString("Full-text search found %1 matching documents").arg(fullTextResults.size()));
+                                LOG_INFO(QString("Full-text search found %1 matching documents").arg(fullTextRowIds.size()));
                                 break;
                             }
                         }
@@ -938,268 +1728,342 @@ QueryResult Executor::executeSelect(const SelectStatement* stmt) {
                 }
             }
 
-            // 检查WHERE子句是否是简单的等值条件（例如：id = 1）
+            // 访问路径按计划选择：有统计信息时只尝试优化器选中的那一类索引（SeqScan 不走索引），
+            // 没有统计信息时按规则依次尝试。全文索引和 R 树索引不在优化器的估算范围内，总是按规则使用
+            PlanNode* scanNode = stages.input;
+            const bool planDriven = scanNode && scanNode->estimated;
+            const PlanNodeType accessType = planDriven ? scanNode->nodeType : PlanNodeType::SEQ_SCAN;
+            const bool tryIndexScan = !planDriven || accessType == PlanNodeType::INDEX_SCAN ||
+                                      accessType == PlanNodeType::INDEX_ONLY_SCAN;
+            const bool tryBitmapScan = !planDriven || accessType == PlanNodeType::BITMAP_SCAN;
+            const bool tryTrieScan = !planDriven || accessType == PlanNodeType::TRIE_SCAN;
+            const bool tryBlockRangeScan = !planDriven || accessType == PlanNodeType::BLOCK_RANGE_SCAN;
+
+            // 哈希索引：col = 常量、col IN (...)；复合 B+ 树索引：前缀等值 + 下一列范围；
+            // 位图索引：等值/IN 的位图求交；TRIE 索引：col LIKE '前缀%'。都得到候选 rowId 集合
+            bool useHashIndex = false;
+            QSet<RowId> hashRowIds;
+            bool indexOnlyScan = false;
+            QVector<IndexOnlyRow> indexOnlyRows;
             if (!useFullTextIndex && actualStmt->where) {
-                // 简化实现：只检测 "column = constant" 形式的WHERE子句
-                const BinaryExpression* binExpr = dynamic_cast<const BinaryExpression*>(actualStmt->where.get());
-                if (binExpr && binExpr->op == BinaryOp::EQ) {
-                    const ColumnExpression* colExpr = dynamic_cast<const ColumnExpression*>(binExpr->left.get());
-                    const LiteralExpression* litExpr = dynamic_cast<const LiteralExpression*>(binExpr->right.get());
-
-                    if (colExpr && litExpr) {
-                        // 检查该列是否有索引
-                        QString columnName = colExpr->column;
-                        QVector<IndexDef> tableIndexes = catalog->getTableIndexes(leftTableName);
-
-                        for (const auto& indexDef : tableIndexes) {
-                            if (indexDef.columns.size() == 1 &&
-                                indexDef.columns[0].compare(columnName, Qt::CaseInsensitive) == 0) {
-
-                                // 检查该列是否有索引
-                                int columnIndex = leftTable->getColumnIndex(columnName);
-                                if (columnIndex >= 0) {
-                                    // 评估字面值
-                                    QVariant keyValue = evaluator.evaluate(litExpr);
-                                    if (!keyValue.isNull()) {
-                                        // 使用通用 B+ 树索引查找（支持所有数据类型）
-                                        GenericBPlusTree genericBTree(bufferPool, indexDef.keyType, indexDef.rootPageId);
-                                        if (genericBTree.search(keyValue, indexRowId)) {
-                                            useIndex = true;
-                                            LOG_INFO(QString("Using index '%1' for query (rowId=%2)")
-                                                        .arg(indexDef.name).arg(indexRowId));
-                                            break;
-                                        }
-                                    }
-                                }
-                            }
-                        }
+                // 查询用到的列（SELECT 列表和 WHERE），复合索引覆盖这些列时可以不读数据页
+                QSet<int> requiredColumns;
+                bool columnsKnown = IndexExpression::collectReferencedColumns(actualStmt->where.get(), leftTable,
+                                                                              requiredColumns);
+                if (isSelectAll) {
+                    for (int i = 0; i < leftTable->columns.size(); ++i) {
+                        requiredColumns.insert(i);
+                    }
+                } else {
+                    for (const auto& exprPtr : actualStmt->selectList) {
+                        columnsKnown = columnsKnown &&
+                                       IndexExpression::collectReferencedColumns(exprPtr.get(), leftTable, requiredColumns);
                     }
                 }
+
+                useHashIndex = (tryIndexScan &&
+                                (probeHashIndex(catalog, bufferPool, leftTable, actualStmt->where.get(), hashRowIds) ||
+                                 probeCompositeIndex(catalog, bufferPool, leftTable, actualStmt->where.get(), hashRowIds,
+                                                     columnsKnown ? &requiredColumns : nullptr,
+                                                     &indexOnlyRows, &indexOnlyScan))) ||
+                               (tryBitmapScan &&
+                                probeBitmapIndex(catalog, bufferPool, leftTable, actualStmt->where.get(), hashRowIds)) ||
+                               (tryTrieScan &&
+                                probeTrieIndex(catalog, bufferPool, leftTable, actualStmt->where.get(), hashRowIds,
+                                               actualStmt));
+            }
+
+            // R 树索引：空间谓词按外包矩形筛选；ORDER BY ST_Distance(...) LIMIT k 按距离取前 k 行
+            if (!useFullTextIndex && !useHashIndex) {
+                useHashIndex = (actualStmt->where &&
+                                probeSpatialIndex(catalog, bufferPool, leftTable, actualStmt->where.get(), hashRowIds)) ||
+                               probeNearestNeighbors(catalog, bufferPool, leftTable, actualStmt, hashRowIds);
+            }
+
+            // 块范围索引：按每页的最小/最大值摘要跳过不可能匹配的数据页
+            bool useBlockRangeIndex = false;
+            QVector<PageId> blockRangePages;
+            if (!useFullTextIndex && !useHashIndex && tryBlockRangeScan && actualStmt->where) {
+                useBlockRangeIndex = probeBlockRangeIndex(catalog, bufferPool, leftTable,
+                                                          actualStmt->where.get(), blockRangePages);
             }
 
             int totalRows = 0;
 
-            if (useIndex && indexRowId != INVALID_ROW_ID) {
-                // 索引查找成功，但需要通过rowId定位到实际记录
-                // 当前限制：缺少rowId到(pageId, slotIndex)的映射表
-                //
-                // 实现选项：
-                // 1. 在TableDef中维护rowId -> (pageId, slotIndex)映射（哈希表）
-                // 2. 在PageHeader中记录该页的rowId范围，二分查找定位页面
-                // 3. 使用聚簇索引（主键索引直接存储完整记录）
-                //
-                // 当前策略：回退到全表扫描，但记录索引被成功使用的日志
-                LOG_INFO(QString("Index '%1' matched rowId %2, but direct rowId lookup not implemented - using full table scan")
-                            .arg("index").arg(indexRowId));
-                useIndex = false;
-            }
-
-            if (!useIndex) {
-                // 尝试从表级缓存获取数据
-                QVector<QVector<QVariant>> cachedRows;
-                QVector<RecordHeader> cachedHeaders;
-                bool usedTableCache = false;
-
-                QString currentDbName = dbManager_->currentDatabaseName();
-                if (tableCache_ && tableCache_->isEnabled()) {
-                    // 检查表是否已缓存
-                    if (tableCache_->isTableCached(currentDbName, leftTableName)) {
+            // 尝试从表级缓存获取数据
+            QVector<QVector<QVariant>> cachedRows;
+            QVector<RecordHeader> cachedHeaders;
+            bool usedTableCache = false;
+
+            QString currentDbName = dbManager_->currentDatabaseName();
+            if (!indexOnlyScan && !useBlockRangeIndex && tableCache_ && tableCache_->isEnabled()) {
+                // 检查表是否已缓存
+                if (tableCache_->isTableCached(currentDbName, leftTableName)) {
+                    if (tableCache_->getTableData(currentDbName, leftTableName, cachedRows, cachedHeaders)) {
+                        LOG_INFO(QString("Table cache HIT: %1.%2 (%3 rows)")
+                                    .arg(currentDbName).arg(leftTableName).arg(cachedRows.size()));
+                        usedTableCache = true;
+                    }
+                } else {
+                    // 尝试加载小表到缓存
+                    uint64_t tableSize = TableCache::estimateTableSize(const_cast<TableDef*>(leftTable), bufferPool);
+                    LOG_DEBUG(QString("Table %1.%2 size estimate: %3 bytes")
+                                .arg(currentDbName).arg(leftTableName).arg(tableSize));
+
+                    if (tableCache_->loadTable(currentDbName, const_cast<TableDef*>(leftTable), bufferPool)) {
+                        // 加载成功，立即使用缓存
                         if (tableCache_->getTableData(currentDbName, leftTableName, cachedRows, cachedHeaders)) {
-                            LOG_INFO(QString("Table cache HIT: %1.%2 (%3 rows)")
+                            LOG_INFO(QString("Table %1.%2 loaded and cached (%3 rows)")
                                         .arg(currentDbName).arg(leftTableName).arg(cachedRows.size()));
                             usedTableCache = true;
                         }
-                    } else {
-                        // 尝试加载小表到缓存
-                        uint64_t tableSize = TableCache::estimateTableSize(const_cast<TableDef*>(leftTable), bufferPool);
-                        LOG_DEBUG(QString("Table %1.%2 size estimate: %3 bytes")
-                                    .arg(currentDbName).arg(leftTableName).arg(tableSize));
-
-                        if (tableCache_->loadTable(currentDbName, const_cast<TableDef*>(leftTable), bufferPool)) {
-                            // 加载成功，立即使用缓存
-                            if (tableCache_->getTableData(currentDbName, leftTableName, cachedRows, cachedHeaders)) {
-                                LOG_INFO(QString("Table %1.%2 loaded and cached (%3 rows)")
-                                            .arg(currentDbName).arg(leftTableName).arg(cachedRows.size()));
-                                usedTableCache = true;
-                            }
-                        }
                     }
                 }
+            }
 
-                // 全表扫描（支持MVCC可见性检查）
-                // 获取当前事务ID
-                TransactionManager* txnManager = dbManager_->getCurrentTransactionManager();
-                TransactionId currentTxnId = dbManager_->getCurrentTransactionId();
+            // 全表扫描（支持MVCC可见性检查）
+            // 获取当前事务ID
+            TransactionManager* txnManager = dbManager_->getCurrentTransactionManager();
+            TransactionId currentTxnId = dbManager_->getCurrentTransactionId();
 
-                if (currentTxnId == INVALID_TXN_ID) {
-                    // 如果没有活跃事务，使用一个虚拟的事务ID（0）来读取已提交的数据
-                    currentTxnId = 0;
-                }
+            if (currentTxnId == INVALID_TXN_ID) {
+                // 如果没有活跃事务，使用一个虚拟的事务ID（0）来读取已提交的数据
+                currentTxnId = 0;
+            }
 
-                // 创建可见性检查器
-                VisibilityChecker* checker = nullptr;
-                if (txnManager) {
-                    checker = new VisibilityChecker(txnManager);
-                }
+            // 创建可见性检查器
+            VisibilityChecker* checker = nullptr;
+            if (txnManager) {
+                checker = new VisibilityChecker(txnManager);
+            }
 
-                // 优先使用缓存数据，否则扫描磁盘
-                if (usedTableCache) {
-                    // 使用缓存的数据进行查询
-                    LOG_DEBUG("Processing query using cached table data");
+            // 仅索引扫描：行由覆盖索引的条目还原，条目中的创建事务用于可见性检查
+            if (indexOnlyScan) {
+                LOG_INFO(QString("Index-only scan: %1 entries, no heap pages read").arg(indexOnlyRows.size()));
 
-                    for (int i = 0; i < cachedRows.size(); ++i) {
-                        const auto& record = cachedRows[i];
-                        const auto& recordHeader = cachedHeaders[i];
+                for (const auto& indexRow : indexOnlyRows) {
+                    const auto& record = indexRow.record;
 
-                        bool includeRow = true;
+                    if (checker && !checker->isVisible(indexRow.header, currentTxnId)) {
+                        continue;
+                    }
 
-                        // MVCC可见性检查
-                        if (checker && !checker->isVisible(recordHeader, currentTxnId)) {
-                            continue;  // 跳过对当前事务不可见的记录
-                        }
+                    QVariant whereResult = evaluator.evaluateWithRow(actualStmt->where.get(), leftTable, record);
+                    if (evaluator.hasError()) {
+                        delete checker;
+                        return createErrorResult(ErrorCode::SEMANTIC_ERROR,
+                                                QString("WHERE clause evaluation error: %1")
+                                                    .arg(evaluator.getLastError()));
+                    }
+                    if (whereResult.isNull() || !whereResult.toBool()) {
+                        continue;
+                    }
 
-                        // 如果有WHERE子句，评估条件
-                        if (actualStmt->where && !useFullTextIndex) {
-                            QVariant whereResult = evaluator.evaluateWithRow(actualStmt->where.get(), leftTable, record);
+                    QVector<QVariant> projectedRow;
+                    if (isSelectAll) {
+                        projectedRow = record;
+                    } else {
+                        for (const auto& exprPtr : actualStmt->selectList) {
+                            QVariant value = evaluator.evaluateWithRow(exprPtr.get(), leftTable, record);
 
                             if (evaluator.hasError()) {
                                 delete checker;
                                 return createErrorResult(ErrorCode::SEMANTIC_ERROR,
-                                                        QString("WHERE clause evaluation error: %1")
+                                                        QString("SELECT list evaluation error: %1")
                                                             .arg(evaluator.getLastError()));
                             }
 
-                            // SQL三值逻辑：只有明确为true才包含行
-                            includeRow = !whereResult.isNull() && whereResult.toBool();
+                            projectedRow.append(value);
                         }
+                    }
 
-                        if (includeRow) {
-                            // 应用列投影（SELECT 指定列）
-                            QVector<QVariant> projectedRow;
-
-                            if (isSelectAll) {
-                                // SELECT * - 返回所有列
-                                projectedRow = record;
-                            } else {
-                                // SELECT 指定列 - 只返回选择的列
-                                for (const auto& exprPtr : actualStmt->selectList) {
-                                    QVariant value = evaluator.evaluateWithRow(exprPtr.get(), leftTable, record);
-
-                                    if (evaluator.hasError()) {
-                                        delete checker;
-                                        return createErrorResult(ErrorCode::SEMANTIC_ERROR,
-                                                                QString("SELECT list evaluation error: %1")
-                                                                    .arg(evaluator.getLastError()));
-                                    }
+                    result.rows.append(projectedRow);
+                    totalRows++;
+                }
+            } else if (usedTableCache) {
+                // 使用缓存的数据进行查询
+                LOG_DEBUG("Processing query using cached table data");
 
-                                    projectedRow.append(value);
-                                }
-                            }
+                for (int i = 0; i < cachedRows.size(); ++i) {
+                    const auto& record = cachedRows[i];
+                    const auto& recordHeader = cachedHeaders[i];
 
-                            result.rows.append(projectedRow);
-                            totalRows++;
-                        }
+                    bool includeRow = true;
+
+                    // 全文索引候选过滤
+                    if (useFullTextIndex && !fullTextRowIds.contains(recordHeader.rowId)) {
+                        continue;
                     }
-                } else {
-                    // 扫描所有数据页，读取记录（从磁盘）
-                    PageId currentPageId = leftTable->firstPageId;
 
-                    while (currentPageId != INVALID_PAGE_ID) {
-                Page* page = bufferPool->fetchPage(currentPageId);
-                if (!page) {
-                    LOG_ERROR(QString("Failed to fetch page %1").arg(currentPageId));
-                    break;
-                }
+                    // 哈希索引候选过滤
+                    if (useHashIndex && !hashRowIds.contains(recordHeader.rowId)) {
+                        continue;
+                    }
 
-                // 获取该页的所有记录（包含RecordHeader用于MVCC检查）
-                QVector<QVector<QVariant>> pageRecords;
-                QVector<RecordHeader> pageHeaders;
-                QVector<RowId> rowIds;
+                    // MVCC可见性检查
+                    if (checker && !checker->isVisible(recordHeader, currentTxnId)) {
+                        continue;  // 跳过对当前事务不可见的记录
+                    }
+
+                    // 如果有WHERE子句，评估条件
+                    if (actualStmt->where && !useFullTextIndex) {
+                        QVariant whereResult = evaluator.evaluateWithRow(actualStmt->where.get(), leftTable, record);
+
+                        if (evaluator.hasError()) {
+                            delete checker;
+                            return createErrorResult(ErrorCode::SEMANTIC_ERROR,
+                                                    QString("WHERE clause evaluation error: %1")
+                                                        .arg(evaluator.getLastError()));
+                        }
 
-                // 先获取headers
-                if (TablePage::getAllRecords(page, leftTable, pageRecords, pageHeaders)) {
-                    // 如果需要RowId（用于全文搜索过滤），再调用一次
-                    if (useFullTextIndex) {
-                        QVector<QVector<QVariant>> tempRecords;
-                        TablePage::getAllRecords(page, leftTable, tempRecords, &rowIds);
+                        // SQL三值逻辑：只有明确为true才包含行
+                        includeRow = !whereResult.isNull() && whereResult.toBool();
                     }
 
-                    // 应用 MVCC 可见性检查和 WHERE 过滤条件
-                    for (int i = 0; i < pageRecords.size(); ++i) {
-                        const auto& record = pageRecords[i];
-                        const auto& recordHeader = pageHeaders[i];
-                        RowId rowId = (useFullTextIndex && i < rowIds.size()) ? rowIds[i] : INVALID_ROW_ID;
+                    if (includeRow) {
+                        // 应用列投影（SELECT 指定列）
+                        QVector<QVariant> projectedRow;
 
-                        bool includeRow = true;
+                        if (isSelectAll) {
+                            // SELECT * - 返回所有列
+                            projectedRow = record;
+                        } else {
+                            // SELECT 指定列 - 只返回选择的列
+                            for (const auto& exprPtr : actualStmt->selectList) {
+                                QVariant value = evaluator.evaluateWithRow(exprPtr.get(), leftTable, record);
+
+                                if (evaluator.hasError()) {
+                                    delete checker;
+                                    return createErrorResult(ErrorCode::SEMANTIC_ERROR,
+                                                            QString("SELECT list evaluation error: %1")
+                                                                .arg(evaluator.getLastError()));
+                                }
 
-                        // 如果使用了全文索引，检查RowId是否在结果中
-                        if (useFullTextIndex && rowId != INVALID_ROW_ID) {
-                            if (!fullTextResults.contains(rowId)) {
-                                continue;  // 跳过不在全文搜索结果中的记录
+                                projectedRow.append(value);
                             }
                         }
 
-                        // MVCC可见性检查
-                        if (checker && !checker->isVisible(recordHeader, currentTxnId)) {
-                            continue;  // 跳过对当前事务不可见的记录
-                        }
+                        result.rows.append(projectedRow);
+                        totalRows++;
+                    }
+                }
+            } else {
+                // 扫描所有数据页，读取记录（从磁盘）
+                // 哈希索引或全文索引命中且候选行都能通过 RowIdIndex 定位时，只读候选行所在的页；
+                // 块范围索引命中时只读摘要可能匹配的页
+                QVector<PageId> candidatePages;
+                bool candidatePagesOnly =
+                    (useHashIndex && locateRowPages(leftTable, hashRowIds, candidatePages)) ||
+                    (useFullTextIndex && locateRowPages(leftTable, fullTextRowIds, candidatePages));
+                if (!candidatePagesOnly && useBlockRangeIndex) {
+                    candidatePages = blockRangePages;
+                    candidatePagesOnly = true;
+                }
+                int candidatePagePos = 0;
+                PageId currentPageId = candidatePagesOnly
+                    ? (candidatePages.isEmpty() ? INVALID_PAGE_ID : candidatePages[0])
+                    : leftTable->firstPageId;
+
+                while (currentPageId != INVALID_PAGE_ID) {
+                    Page* page = bufferPool->fetchPage(currentPageId);
+                    if (!page) {
+                        LOG_ERROR(QString("Failed to fetch page %1").arg(currentPageId));
+                        break;
+                    }
 
-                        // 如果有WHERE子句��不是MATCH表达式，评估条件
-                        if (actualStmt->where && !useFullTextIndex) {
-                            QVariant whereResult = evaluator.evaluateWithRow(actualStmt->where.get(), leftTable, record);
+                    // 获取该页的所有记录（包含RecordHeader用于MVCC检查）
+                    QVector<QVector<QVariant>> pageRecords;
+                    QVector<RecordHeader> pageHeaders;
 
-                            if (evaluator.hasError()) {
-                                bufferPool->unpinPage(currentPageId, false);
-                                delete checker;
-                                return createErrorResult(ErrorCode::SEMANTIC_ERROR,
-                                                        QString("WHERE clause evaluation error: %1")
-                                                            .arg(evaluator.getLastError()));
+                    // 先获取headers
+                    if (TablePage::getAllRecords(page, leftTable, pageRecords, pageHeaders)) {
+                        // 应用 MVCC 可见性检查和 WHERE 过滤条件
+                        for (int i = 0; i < pageRecords.size(); ++i) {
+                            const auto& record = pageRecords[i];
+                            const auto& recordHeader = pageHeaders[i];
+
+                            bool includeRow = true;
+
+                            // 全文索引候选过滤
+                            if (useFullTextIndex && !fullTextRowIds.contains(recordHeader.rowId)) {
+                                continue;
                             }
 
-                            // SQL三值逻辑：只有明确为true才包含行
-                            includeRow = !whereResult.isNull() && whereResult.toBool();
-                        }
+                            // 哈希索引候选过滤
+                            if (useHashIndex && !hashRowIds.contains(recordHeader.rowId)) {
+                                continue;
+                            }
 
-                        if (includeRow) {
-                            // 应用列投影（SELECT 指定列）
-                            QVector<QVariant> projectedRow;
-
-                            if (isSelectAll) {
-                                // SELECT * - 返回所有列
-                                projectedRow = record;
-                            } else {
-                                // SELECT 指定列 - 只返回选择的列
-                                for (const auto& exprPtr : actualStmt->selectList) {
-                                    QVariant value = evaluator.evaluateWithRow(exprPtr.get(), leftTable, record);
-
-                                    if (evaluator.hasError()) {
-                                        bufferPool->unpinPage(currentPageId, false);
-                                        delete checker;
-                                        return createErrorResult(ErrorCode::SEMANTIC_ERROR,
-                                                                QString("SELECT list evaluation error: %1")
-                                                                    .arg(evaluator.getLastError()));
-                                    }
+                            // MVCC可见性检查
+                            if (checker && !checker->isVisible(recordHeader, currentTxnId)) {
+                                continue;  // 跳过对当前事务不可见的记录
+                            }
+
+                            // 如果有WHERE子句��不是MATCH表达式，评估条件
+                            if (actualStmt->where && !useFullTextIndex) {
+                                QVariant whereResult = evaluator.evaluateWithRow(actualStmt->where.get(), leftTable, record);
 
-                                    projectedRow.append(value);
+                                if (evaluator.hasError()) {
+                                    bufferPool->unpinPage(currentPageId, false);
+                                    delete checker;
+                                    return createErrorResult(ErrorCode::SEMANTIC_ERROR,
+                                                            QString("WHERE clause evaluation error: %1")
+                                                                .arg(evaluator.getLastError()));
                                 }
+
+                                // SQL三值逻辑：只有明确为true才包含行
+                                includeRow = !whereResult.isNull() && whereResult.toBool();
                             }
 
-                            result.rows.append(projectedRow);
-                            totalRows++;
+                            if (includeRow) {
+                                // 应用列投影（SELECT 指定列）
+                                QVector<QVariant> projectedRow;
+
+                                if (isSelectAll) {
+                                    // SELECT * - 返回所有列
+                                    projectedRow = record;
+                                } else {
+                                    // SELECT 指定列 - 只返回选择的列
+                                    for (const auto& exprPtr : actualStmt->selectList) {
+                                        QVariant value = evaluator.evaluateWithRow(exprPtr.get(), leftTable, record);
+
+                                        if (evaluator.hasError()) {
+                                            bufferPool->unpinPage(currentPageId, false);
+                                            delete checker;
+                                            return createErrorResult(ErrorCode::SEMANTIC_ERROR,
+                                                                    QString("SELECT list evaluation error: %1")
+                                                                        .arg(evaluator.getLastError()));
+                                        }
+
+                                        projectedRow.append(value);
+                                    }
+                                }
+
+                                result.rows.append(projectedRow);
+                                totalRows++;
+                            }
                         }
                     }
-                }
 
-                // 移动到下一页
-                PageHeader* header = page->getHeader();
-                PageId nextPageId = header->nextPageId;
-                bufferPool->unpinPage(currentPageId, false);
-                currentPageId = nextPageId;
+                    // 移动到下一页
+                    PageHeader* header = page->getHeader();
+                    PageId nextPageId = header->nextPageId;
+                    bufferPool->unpinPage(currentPageId, false);
+                    if (candidatePagesOnly) {
+                        ++candidatePagePos;
+                        nextPageId = candidatePagePos < candidatePages.size()
+                            ? candidatePages[candidatePagePos] : INVALID_PAGE_ID;
                     }
-                }  // end else (disk scan)
+                    currentPageId = nextPageId;
+                }
+            }  // end else (disk scan)
+
+            // 清理可见性检查器
+            delete checker;
 
-                // 清理可见性检查器
-                delete checker;
+            recordActuals(scanNode, totalRows, planTimer);
+            if (scanNode) {
+                scanNode->stoppedEarly = scanStoppedEarly_;
             }
 
             result.message = QString("SELECT executed (%1 rows)").arg(totalRows);
@@ -1209,8 +2073,10 @@ QueryResult Executor::executeSelect(const SelectStatement* stmt) {
                         .arg(result.rows.size()));
         }
 
+        // 按计划在扫描或连接之上依次执行聚合、排序和 LIMIT
+
         // 应用 GROUP BY 和聚合函数
-        if (actualStmt->groupBy) {
+        if (stages.aggregate && actualStmt->groupBy) {
             LOG_INFO("Executing GROUP BY");
 
             // 使用分组键（group key）构建分组表
@@ -1266,13 +2132,12 @@ QueryResult Executor::executeSelect(const SelectStatement* stmt) {
                                 .arg(result.rows.size());
 
             LOG_INFO(QString("GROUP BY returned %1 groups").arg(result.rows.size()));
+            recordActuals(stages.aggregate, result.rows.size(), planTimer);
         }
 
         // 应用 ORDER BY 排序
-        if (!actualStmt->orderBy.empty()) {
-            // 对结果进行排序
-            std::sort(result.rows.begin(), result.rows.end(),
-                     [&](const QVector<QVariant>& row1, const QVector<QVariant>& row2) -> bool {
+        if (stages.sort && !actualStmt->orderBy.empty()) {
+            auto rowLess = [&](const QVector<QVariant>& row1, const QVector<QVariant>& row2) -> bool {
                 // 按照ORDER BY子句中的每个列依次比较
                 for (const auto& orderItem : actualStmt->orderBy) {
                     // 评估ORDER BY表达式（可能是列名或表达式）
@@ -1318,21 +2183,41 @@ QueryResult Executor::executeSelect(const SelectStatement* stmt) {
 
                 // 所有列都相等
                 return false;
-            });
+            };
+
+            // LIMIT 在排序之上时只需排出前 k 行（top-N）
+            const qsizetype limit = stages.limit ? actualStmt->limit : 0;
+            if (limit > 0 && limit < result.rows.size()) {
+                std::partial_sort(result.rows.begin(), result.rows.begin() + limit, result.rows.end(), rowLess);
+            } else {
+                std::sort(result.rows.begin(), result.rows.end(), rowLess);
+            }
+            recordActuals(stages.sort, result.rows.size(), planTimer);
         }
 
         // 应用 LIMIT 限制
-        if (actualStmt->limit > 0 && result.rows.size() > actualStmt->limit) {
+        if (stages.limit && actualStmt->limit > 0 && result.rows.size() > actualStmt->limit) {
             result.rows.resize(actualStmt->limit);
             result.message += QString(" (limited to %1 rows)").arg(actualStmt->limit);
         }
+        recordActuals(stages.limit, result.rows.size(), planTimer);
+
+        // 实际行数反馈给优化器；误估的计划记入慢查询日志
+        QStringList misestimates;
+        recordCardinalityFeedback(plan.get(), catalog->getCardinalityFeedback(),
+                                  Config::instance().getMisestimateFactor(), misestimates);
+        writeMisestimateLog(actualStmt->toString(), planTimer.nsecsElapsed() / 1e6, misestimates);
+
+        if (analyzedPlan) {
+            *analyzedPlan = std::move(plan);
+        }
 
     } else {
         result.message = "SELECT without FROM clause";
     }
 
     // 存储到查询缓存（仅针对成功的查询且未使用缓存时）
-    if (!usedCache && queryCache_ && queryCache_->isEnabled() && actualStmt->from && result.success) {
+    if (!usedCache && !analyzedPlan && queryCache_ && queryCache_->isEnabled() && actualStmt->from && result.success) {
         QSet<QString> affectedTables;
         affectedTables.insert(fromTable);
 
@@ -1432,6 +2317,7 @@ QueryResult Executor::executeUpdate(const UpdateStatement* stmt) {
     struct UpdateCandidate {
         PageId pageId;
         int slotIndex;
+        RowId rowId;
         QVector<QVariant> oldRow;
         QVector<QVariant> newRow;
     };
@@ -1451,7 +2337,23 @@ QueryResult Executor::executeUpdate(const UpdateStatement* stmt) {
     }
 
     // 扫描所有页，找到符合WHERE条件的行
-    PageId currentPageId = table->firstPageId;
+    // 哈希索引或复合索引能回答 WHERE 时只看候选行（能定位时只读候选行所在的页）；
+    // 否则用块范围索引跳过摘要不匹配的页
+    QSet<RowId> hashRowIds;
+    bool useHashIndex = stmt->where &&
+        (probeHashIndex(catalog, bufferPool, table, stmt->where.get(), hashRowIds) ||
+         probeCompositeIndex(catalog, bufferPool, table, stmt->where.get(), hashRowIds) ||
+         probeBitmapIndex(catalog, bufferPool, table, stmt->where.get(), hashRowIds) ||
+         probeSpatialIndex(catalog, bufferPool, table, stmt->where.get(), hashRowIds) ||
+         probeTrieIndex(catalog, bufferPool, table, stmt->where.get(), hashRowIds));
+    QVector<PageId> candidatePages;
+    bool candidatePagesOnly = useHashIndex
+        ? locateRowPages(table, hashRowIds, candidatePages)
+        : probeBlockRangeIndex(catalog, bufferPool, table, stmt->where.get(), candidatePages);
+    int candidatePagePos = 0;
+    PageId currentPageId = candidatePagesOnly
+        ? (candidatePages.isEmpty() ? INVALID_PAGE_ID : candidatePages[0])
+        : table->firstPageId;
 
     while (currentPageId != INVALID_PAGE_ID) {
         Page* page = bufferPool->fetchPage(currentPageId);
@@ -1469,6 +2371,11 @@ QueryResult Executor::executeUpdate(const UpdateStatement* stmt) {
                 const auto& recordHeader = pageHeaders[i];
                 bool shouldUpdate = true;
 
+                // 哈希索引候选过滤
+                if (useHashIndex && !hashRowIds.contains(recordHeader.rowId)) {
+                    continue;
+                }
+
                 // MVCC可见性检查
                 if (checker && !checker->isVisible(recordHeader, currentTxnId)) {
                     continue;  // 跳过对当前事务不可见的记录
@@ -1530,6 +2437,7 @@ QueryResult Executor::executeUpdate(const UpdateStatement* stmt) {
                     UpdateCandidate candidate;
                     candidate.pageId = currentPageId;
                     candidate.slotIndex = i;  // 使用循环索引 i 而不是 slotIndex
+                    candidate.rowId = recordHeader.rowId;
                     candidate.oldRow = record;
                     candidate.newRow = newRow;
                     candidates.append(candidate);
@@ -1541,6 +2449,11 @@ QueryResult Executor::executeUpdate(const UpdateStatement* stmt) {
         PageHeader* header = page->getHeader();
         PageId nextPageId = header->nextPageId;
         bufferPool->unpinPage(currentPageId, false);
+        if (candidatePagesOnly) {
+            ++candidatePagePos;
+            nextPageId = candidatePagePos < candidatePages.size()
+                ? candidatePages[candidatePagePos] : INVALID_PAGE_ID;
+        }
         currentPageId = nextPageId;
     }
 
@@ -1585,46 +2498,10 @@ QueryResult Executor::executeUpdate(const UpdateStatement* stmt) {
 
             bufferPool->unpinPage(candidate.pageId, true);  // 标记为脏页
 
-            // 更新所有索引（使用通用 B+ 树，支持所有数据类型）
-            QVector<IndexDef> tableIndexes = catalog->getTableIndexes(stmt->tableName);
-            for (const auto& indexDef : tableIndexes) {
-                if (indexDef.columns.size() != 1) continue;
-
-                QString columnName = indexDef.columns[0];
-                int columnIndex = table->getColumnIndex(columnName);
-                if (columnIndex < 0) continue;
-
-                // 获取旧键和新键
-                QVariant oldKeyValue = candidate.oldRow[columnIndex];
-                QVariant newKeyValue = candidate.newRow[columnIndex];
-
-                if (!oldKeyValue.isNull() && !newKeyValue.isNull()) {
-                    // 使用 KeyComparator 比较键值是否改变
-                    int cmpResult = KeyComparator::compare(oldKeyValue, newKeyValue, indexDef.keyType);
-
-                    // 如果键值改变，需要更新索引
-                    if (cmpResult != 0) {
-                        GenericBPlusTree genericBTree(bufferPool, indexDef.keyType, indexDef.rootPageId);
-
-                        // 删除旧键
-                        if (!genericBTree.remove(oldKeyValue)) {
-                            LOG_WARN(QString("Failed to remove old key from index '%1'")
-                                        .arg(indexDef.name));
-                        }
-
-                        // 插入新键（使用相同的rowId）
-                        // TODO: 需要获取实际的rowId
-                        static RowId tempRowId = 1;
-                        if (!genericBTree.insert(newKeyValue, tempRowId++)) {
-                            LOG_WARN(QString("Failed to insert new key into index '%1'")
-                                        .arg(indexDef.name));
-                        } else {
-                            LOG_DEBUG(QString("Updated index '%1' with new key")
-                                         .arg(indexDef.name));
-                        }
-                    }
-                }
-            }
+            // 更新所有索引（行ID不变，只有键变化的索引需要改动）
+            maintainIndexes(catalog, bufferPool, table,
+                            &candidate.oldRow, candidate.rowId,
+                            &candidate.newRow, candidate.rowId, txnId, candidate.pageId);
         } else {
             // 原地更新失败（通常是新记录更大），使用删除+插入策略
             LOG_DEBUG(QString("In-place update failed for slot %1, trying delete+insert")
@@ -1653,6 +2530,11 @@ QueryResult Executor::executeUpdate(const UpdateStatement* stmt) {
                             inserted = true;
                             updatedCount++;
                             bufferPool->unpinPage(insertPageId, true);
+
+                            // 新行换了行ID，旧条目要从索引中移除
+                            maintainIndexes(catalog, bufferPool, table,
+                                            &candidate.oldRow, candidate.rowId,
+                                            &candidate.newRow, newRowId, txnId, insertPageId);
                             break;
                         }
                     }
@@ -1684,6 +2566,9 @@ QueryResult Executor::executeUpdate(const UpdateStatement* stmt) {
         LOG_INFO(QString("Transaction %1 committed (auto-commit)").arg(txnId));
     }
 
+    // 增量维护统计信息中的行数（事务提交后才计入），改动累计较多时在后台重新收集
+    recordStatsChange(stmt->tableName, 0, 0, updatedCount, autoCommit);
+
     // 保存 Catalog 到磁盘（确保元数据持久化）
     QString dbPath = dbManager_->getDatabasePath(dbManager_->currentDatabaseName());
     QString catalogPath = dbPath + "/catalog.json";
@@ -1771,6 +2656,7 @@ QueryResult Executor::executeDelete(const DeleteStatement* stmt) {
     struct DeleteCandidate {
         PageId pageId;
         int slotIndex;
+        RowId rowId;
         QVector<QVariant> record;  // 保存记录数据用于索引维护
     };
 
@@ -1789,7 +2675,23 @@ QueryResult Executor::executeDelete(const DeleteStatement* stmt) {
     }
 
     // 扫描所有页，找到符合WHERE条件的行
-    PageId currentPageId = table->firstPageId;
+    // 哈希索引或复合索引能回答 WHERE 时只看候选行（能定位时只读候选行所在的页）；
+    // 否则用块范围索引跳过摘要不匹配的页
+    QSet<RowId> hashRowIds;
+    bool useHashIndex = stmt->where &&
+        (probeHashIndex(catalog, bufferPool, table, stmt->where.get(), hashRowIds) ||
+         probeCompositeIndex(catalog, bufferPool, table, stmt->where.get(), hashRowIds) ||
+         probeBitmapIndex(catalog, bufferPool, table, stmt->where.get(), hashRowIds) ||
+         probeSpatialIndex(catalog, bufferPool, table, stmt->where.get(), hashRowIds) ||
+         probeTrieIndex(catalog, bufferPool, table, stmt->where.get(), hashRowIds));
+    QVector<PageId> candidatePages;
+    bool candidatePagesOnly = useHashIndex
+        ? locateRowPages(table, hashRowIds, candidatePages)
+        : probeBlockRangeIndex(catalog, bufferPool, table, stmt->where.get(), candidatePages);
+    int candidatePagePos = 0;
+    PageId currentPageId = candidatePagesOnly
+        ? (candidatePages.isEmpty() ? INVALID_PAGE_ID : candidatePages[0])
+        : table->firstPageId;
 
     while (currentPageId != INVALID_PAGE_ID) {
         Page* page = bufferPool->fetchPage(currentPageId);
@@ -1807,6 +2709,11 @@ QueryResult Executor::executeDelete(const DeleteStatement* stmt) {
                 const auto& recordHeader = pageHeaders[i];
                 bool shouldDelete = true;
 
+                // 哈希索引候选过滤
+                if (useHashIndex && !hashRowIds.contains(recordHeader.rowId)) {
+                    continue;
+                }
+
                 // MVCC可见性检查
                 if (checker && !checker->isVisible(recordHeader, currentTxnId)) {
                     continue;  // 跳过对当前事务不可见的记录
@@ -1832,6 +2739,7 @@ QueryResult Executor::executeDelete(const DeleteStatement* stmt) {
                     DeleteCandidate candidate;
                     candidate.pageId = currentPageId;
                     candidate.slotIndex = i;  // 使用循环索引 i 而不是 slotIndex
+                    candidate.rowId = recordHeader.rowId;
                     candidate.record = record;
                     candidates.append(candidate);
                 }
@@ -1842,6 +2750,11 @@ QueryResult Executor::executeDelete(const DeleteStatement* stmt) {
         PageHeader* header = page->getHeader();
         PageId nextPageId = header->nextPageId;
         bufferPool->unpinPage(currentPageId, false);
+        if (candidatePagesOnly) {
+            ++candidatePagePos;
+            nextPageId = candidatePagePos < candidatePages.size()
+                ? candidatePages[candidatePagePos] : INVALID_PAGE_ID;
+        }
         currentPageId = nextPageId;
     }
 
@@ -1887,28 +2800,9 @@ QueryResult Executor::executeDelete(const DeleteStatement* stmt) {
             bufferPool->unpinPage(candidate.pageId, true);  // 标记为脏页
 
             // 从所有索引中删除该记录
-            QVector<IndexDef> tableIndexes = catalog->getTableIndexes(stmt->tableName);
-            for (const auto& indexDef : tableIndexes) {
-                if (indexDef.columns.size() != 1) continue;
-
-                QString columnName = indexDef.columns[0];
-                int columnIndex = table->getColumnIndex(columnName);
-                if (columnIndex < 0) continue;
-
-                // 获取被删除记录的索引键值
-                QVariant keyValue = candidate.record[columnIndex];
-                if (!keyValue.isNull()) {
-                    // 使用通用 B+ 树删除（支持所有数据类型）
-                    GenericBPlusTree genericBTree(bufferPool, indexDef.keyType, indexDef.rootPageId);
-                    if (!genericBTree.remove(keyValue)) {
-                        LOG_WARN(QString("Failed to remove key from index '%1'")
-                                    .arg(indexDef.name));
-                    } else {
-                        LOG_DEBUG(QString("Removed key from index '%1'")
-                                     .arg(indexDef.name));
-                    }
-                }
-            }
+            maintainIndexes(catalog, bufferPool, table,
+                            &candidate.record, candidate.rowId,
+                            nullptr, INVALID_ROW_ID, txnId);
         } else {
             LOG_ERROR(QString("Failed to delete record at page %1, slot %2")
                          .arg(candidate.pageId)
@@ -1928,6 +2822,9 @@ QueryResult Executor::executeDelete(const DeleteStatement* stmt) {
         LOG_INFO(QString("Transaction %1 committed (auto-commit)").arg(txnId));
     }
 
+    // 增量维护统计信息中的行数（事务提交后才计入），改动累计较多时在后台重新收集
+    recordStatsChange(stmt->tableName, 0, deletedCount, 0, autoCommit);
+
     // 保存 Catalog 到磁盘（确保元数据持久化）
     QString dbPath = dbManager_->getDatabasePath(dbManager_->currentDatabaseName());
     QString catalogPath = dbPath + "/catalog.json";
@@ -2275,39 +3172,247 @@ QueryResult Executor::executeCreateIndex(const CreateIndexStatement* stmt) {
                                 QString("Index '%1' already exists").arg(stmt->indexName));
     }
 
-    // 当前只支持单列索引
-    if (stmt->columns.size() != 1) {
-        return createErrorResult(ErrorCode::NOT_IMPLEMENTED,
-                                "Composite indexes not yet supported. Only single-column indexes are supported.");
-    }
+    if (stmt->columns.isEmpty()) {
+        return createErrorResult(ErrorCode::SEMANTIC_ERROR, "CREATE INDEX requires at least one column");
+    }
+
+    // 解析索引键：列必须存在、可索引、不重复；表达式键必须可索引，保存为规范化 SQL
+    QVector<int> columnIndexes;
+    QVector<DataType> columnTypes;
+    QVector<QString> keyNames;
+    QVector<QString> keyExpressions;
+    bool hasKeyExpressions = false;
+    for (int i = 0; i < stmt->columns.size(); ++i) {
+        const QString& name = stmt->columns[i];
+        const Expression* keyExpr = i < static_cast<int>(stmt->expressions.size())
+                                        ? stmt->expressions[i].get() : nullptr;
+        if (keyExpr) {
+            QString error;
+            if (!IndexExpression::isIndexable(keyExpr, *table, &error)) {
+                return createErrorResult(ErrorCode::SEMANTIC_ERROR,
+                                        QString("Invalid index expression '%1': %2").arg(name, error));
+            }
+            const QString canonical = IndexExpression::toSql(keyExpr);
+            if (keyNames.contains(canonical)) {
+                return createErrorResult(ErrorCode::SEMANTIC_ERROR,
+                                        QString("Expression '%1' appears more than once in index").arg(canonical));
+            }
+            const DataType type = IndexExpression::inferType(keyExpr, *table);
+            if (!KeyEncoder::isEncodableType(type)) {
+                return createErrorResult(ErrorCode::NOT_IMPLEMENTED,
+                                        QString("Index expression '%1' of type '%2' not supported")
+                                            .arg(canonical, getDataTypeName(type)));
+            }
+            columnIndexes.append(-1);
+            columnTypes.append(type);
+            keyNames.append(canonical);
+            keyExpressions.append(canonical);
+            hasKeyExpressions = true;
+            continue;
+        }
 
-    QString columnName = stmt->columns[0];
-    int columnIndex = table->getColumnIndex(columnName);
-    if (columnIndex < 0) {
-        return createErrorResult(ErrorCode::SEMANTIC_ERROR,
-                                QString("Column '%1' not found in table '%2'")
-                                    .arg(columnName)
-                                    .arg(stmt->tableName));
-    }
+        int index = table->getColumnIndex(name);
+        if (index < 0) {
+            return createErrorResult(ErrorCode::SEMANTIC_ERROR,
+                                    QString("Column '%1' not found in table '%2'")
+                                        .arg(name)
+                                        .arg(stmt->tableName));
+        }
+        if (columnIndexes.contains(index)) {
+            return createErrorResult(ErrorCode::SEMANTIC_ERROR,
+                                    QString("Column '%1' appears more than once in index").arg(name));
+        }
 
-    const ColumnDef& column = table->columns[columnIndex];
+        // 检查列类型是否支持索引：空间类型只能建 R 树，R 树也只能建在空间类型上
+        const DataType type = table->columns[index].type;
+        const bool spatialType = type == DataType::GEOMETRY || type == DataType::GEOGRAPHY;
+        if (stmt->type == ast::IndexType::RTREE) {
+            if (!spatialType) {
+                return createErrorResult(ErrorCode::SEMANTIC_ERROR,
+                                        QString("RTREE index requires a GEOMETRY or GEOGRAPHY column, got '%1'")
+                                            .arg(getDataTypeName(type)));
+            }
+        } else if (stmt->type == ast::IndexType::TRIE) {
+            if (!TrieIndex::isIndexableType(type)) {
+                return createErrorResult(ErrorCode::SEMANTIC_ERROR,
+                                        QString("TRIE index requires a string column, got '%1'")
+                                            .arg(getDataTypeName(type)));
+            }
+        } else if (!KeyComparator::isIndexableType(type)) {
+            return createErrorResult(ErrorCode::NOT_IMPLEMENTED,
+                                    QString("Index on column type '%1' not supported (GEOMETRY/GEOGRAPHY require USING RTREE)")
+                                        .arg(getDataTypeName(type)));
+        }
+        columnIndexes.append(index);
+        columnTypes.append(type);
+        keyNames.append(name);
+        keyExpressions.append(QString());
+    }
 
-    // 检查列类型是否支持索引
-    if (!KeyComparator::isIndexableType(column.type)) {
-        return createErrorResult(ErrorCode::NOT_IMPLEMENTED,
-                                QString("Index on column type '%1' not supported (GEOMETRY/GEOGRAPHY require R-tree)")
-                                    .arg(getDataTypeName(column.type)));
+    // 部分索引谓词：只能引用本表的列和确定性函数
+    QString predicateSql;
+    if (stmt->where) {
+        QString error;
+        if (!IndexExpression::isIndexable(stmt->where.get(), *table, &error)) {
+            return createErrorResult(ErrorCode::SEMANTIC_ERROR,
+                                    QString("Invalid partial index predicate: %1").arg(error));
+        }
+        predicateSql = IndexExpression::toSql(stmt->where.get());
     }
 
-    // 根据索引类型创建相应的索引结构
-    PageId rootPageId = INVALID_PAGE_ID;
+    // 解析包含列：只存放在叶子条目中，不参与排序，用于仅索引扫描
+    QVector<int> includeIndexes;
+    QVector<DataType> includeTypes;
+    for (const QString& name : stmt->includeColumns) {
+        int index = table->getColumnIndex(name);
+        if (index < 0) {
+            return createErrorResult(ErrorCode::SEMANTIC_ERROR,
+                                    QString("Column '%1' not found in table '%2'")
+                                        .arg(name)
+                                        .arg(stmt->tableName));
+        }
+        if (columnIndexes.contains(index) || includeIndexes.contains(index)) {
+            return createErrorResult(ErrorCode::SEMANTIC_ERROR,
+                                    QString("Column '%1' appears more than once in index").arg(name));
+        }
 
-    if (stmt->type == ast::IndexType::HASH) {
-        // 创建哈希索引
-        LOG_INFO(QString("Creating HASH index '%1' on column '%2'")
-                     .arg(stmt->indexName).arg(columnName));
+        const DataType type = table->columns[index].type;
+        if (!KeyEncoder::isEncodableType(type)) {
+            return createErrorResult(ErrorCode::NOT_IMPLEMENTED,
+                                    QString("INCLUDE column type '%1' not supported")
+                                        .arg(getDataTypeName(type)));
+        }
+        includeIndexes.append(index);
+        includeTypes.append(type);
+    }
+
+    const bool isComposite = columnIndexes.size() > 1 || !includeIndexes.isEmpty() ||
+                             hasKeyExpressions || !predicateSql.isEmpty();
+    if (isComposite && stmt->type != ast::IndexType::BTREE) {
+        QString message = "Composite indexes are only supported for BTREE indexes";
+        if (hasKeyExpressions) {
+            message = "Expression indexes are only supported for BTREE indexes";
+        } else if (!predicateSql.isEmpty()) {
+            message = "Partial indexes are only supported for BTREE indexes";
+        } else if (!includeIndexes.isEmpty()) {
+            message = "INCLUDE columns are only supported for BTREE indexes";
+        }
+        return createErrorResult(ErrorCode::NOT_IMPLEMENTED, message);
+    }
 
-        HashIndex* hashIndex = new HashIndex(stmt->indexName, column.type, bufferPool, 256);
+    // WITH (...) 选项目前只有块范围索引使用
+    bool bloomEnabled = false;
+    for (auto it = stmt->options.constBegin(); it != stmt->options.constEnd(); ++it) {
+        if (stmt->type != ast::IndexType::BRIN || it.key() != "bloom") {
+            return createErrorResult(ErrorCode::NOT_IMPLEMENTED,
+                                    QString("Unsupported index option '%1'").arg(it.key()));
+        }
+        const QString& value = it.value();
+        if (value == "true" || value == "on" || value == "1") {
+            bloomEnabled = true;
+        } else if (value != "false" && value != "off" && value != "0") {
+            return createErrorResult(ErrorCode::SEMANTIC_ERROR,
+                                    QString("Invalid value '%1' for index option 'bloom'").arg(value));
+        }
+    }
+    if (stmt->type == ast::IndexType::BRIN && stmt->unique) {
+        return createErrorResult(ErrorCode::SEMANTIC_ERROR, "BRIN indexes cannot be UNIQUE");
+    }
+    if (stmt->type == ast::IndexType::BITMAP && stmt->unique) {
+        return createErrorResult(ErrorCode::SEMANTIC_ERROR, "BITMAP indexes cannot be UNIQUE");
+    }
+    if (stmt->type == ast::IndexType::RTREE && stmt->unique) {
+        return createErrorResult(ErrorCode::SEMANTIC_ERROR, "RTREE indexes cannot be UNIQUE");
+    }
+    if (stmt->type == ast::IndexType::TRIE && stmt->unique) {
+        return createErrorResult(ErrorCode::SEMANTIC_ERROR, "TRIE indexes cannot be UNIQUE");
+    }
+
+    const QString columnList = QStringList(keyNames.begin(), keyNames.end()).join(", ");
+    QString columnName = keyNames[0];
+    // 表达式键和部分索引都走复合布局，下面的单列分支里首键一定是普通列
+    int columnIndex = columnIndexes[0];
+
+    // 根据索引类型创建相应的索引结构
+    PageId rootPageId = INVALID_PAGE_ID;
+
+    if (isComposite) {
+        // 创建复合B+树索引：扫描表收集 (复合键, rowId, 包含列, 创建事务)，随后批量构建
+        LOG_INFO(QString("Creating composite BTREE index '%1' on columns (%2)%3%4")
+                     .arg(stmt->indexName).arg(columnList)
+                     .arg(includeIndexes.isEmpty()
+                              ? QString()
+                              : QString(" INCLUDE (%1)").arg(stmt->includeColumns.join(", ")))
+                     .arg(predicateSql.isEmpty() ? QString() : QString(" WHERE %1").arg(predicateSql)));
+
+        // 按保存到目录中的规范化 SQL 解析键和谓词，与之后维护索引时的求值保持一致
+        IndexDef layoutDef;
+        layoutDef.name = stmt->indexName;
+        layoutDef.columns = keyNames;
+        layoutDef.keyExpressions = keyExpressions;
+        layoutDef.predicate = predicateSql;
+        IndexKeyLayout layout;
+        if (!resolveIndexColumns(table, layoutDef, layout)) {
+            return createErrorResult(ErrorCode::INTERNAL_ERROR,
+                                    QString("Failed to resolve keys of index '%1'").arg(stmt->indexName));
+        }
+        ExpressionEvaluator evaluator(catalog);
+
+        QVector<CompositeIndex::Entry> indexEntries;
+        PageId currentPageId = table->firstPageId;
+        int totalRows = 0;
+
+        while (currentPageId != INVALID_PAGE_ID) {
+            Page* page = bufferPool->fetchPage(currentPageId);
+            if (!page) {
+                return createErrorResult(ErrorCode::IO_ERROR,
+                                        QString("Failed to fetch page %1").arg(currentPageId));
+            }
+
+            QVector<QVector<QVariant>> pageRecords;
+            QVector<RecordHeader> pageHeaders;
+
+            if (TablePage::getAllRecords(page, table, pageRecords, pageHeaders)) {
+                for (int i = 0; i < pageRecords.size(); ++i) {
+                    if (pageHeaders[i].deleteTxnId != INVALID_TXN_ID ||
+                        !rowInIndex(pageRecords[i], layout, table, evaluator)) {
+                        continue;
+                    }
+
+                    // NULL 也编码进键（排在非 NULL 之前），保证每一行都能按前缀找到
+                    CompositeIndex::Entry entry;
+                    entry.key = buildCompositeKey(pageRecords[i], layout, table, evaluator);
+                    entry.rowId = pageHeaders[i].rowId;
+                    entry.included = buildIncludedValues(pageRecords[i], includeIndexes);
+                    entry.createTxnId = pageHeaders[i].createTxnId;
+                    indexEntries.append(entry);
+                    totalRows++;
+                }
+            }
+
+            PageHeader* header = page->getHeader();
+            PageId nextPageId = header->nextPageId;
+            bufferPool->unpinPage(currentPageId, false);
+            currentPageId = nextPageId;
+        }
+
+        CompositeIndex compositeIndex(bufferPool, layout.columnTypes, INVALID_PAGE_ID, includeTypes);
+        if (!compositeIndex.bulkLoad(indexEntries, Config::instance().getIndexBulkLoadFillFactor())) {
+            return createErrorResult(ErrorCode::INTERNAL_ERROR,
+                                    QString("Failed to build composite index"));
+        }
+
+        rootPageId = compositeIndex.getRootPageId();
+
+        LOG_INFO(QString("Composite BTREE index '%1' created successfully (%2 rows indexed)")
+                     .arg(stmt->indexName).arg(totalRows));
+    }
+    else if (stmt->type == ast::IndexType::HASH) {
+        // 创建哈希索引
+        LOG_INFO(QString("Creating HASH index '%1' on column '%2'")
+                     .arg(stmt->indexName).arg(columnName));
+
+        HashIndex* hashIndex = new HashIndex(stmt->indexName, columnTypes[0], bufferPool, 256);
 
         // 扫描表，将所有记录插入索引
         PageId currentPageId = table->firstPageId;
@@ -2353,6 +3458,13 @@ QueryResult Executor::executeCreateIndex(const CreateIndexStatement* stmt) {
             currentPageId = nextPageId;
         }
 
+        // 空表也要分配目录页，之后 INSERT 才能找到同一个索引
+        if (!hashIndex->ensureDirectory()) {
+            delete hashIndex;
+            return createErrorResult(ErrorCode::INTERNAL_ERROR,
+                                    QString("Failed to create hash index directory"));
+        }
+
         rootPageId = hashIndex->getDirectoryPageId();
         delete hashIndex;
 
@@ -2364,16 +3476,15 @@ QueryResult Executor::executeCreateIndex(const CreateIndexStatement* stmt) {
         LOG_INFO(QString("Creating BTREE index '%1' on column '%2'")
                      .arg(stmt->indexName).arg(columnName));
 
-        GenericBPlusTree* genericBTree = new GenericBPlusTree(bufferPool, column.type);
-
-        // 扫描表，将所有记录插入索引
+        // 扫描表，收集 (key, rowId)，随后排序并自底向上批量构建，
+        // 避免逐行 insert 带来的随机分裂和半满页
+        QVector<QPair<QVariant, RowId>> indexEntries;
         PageId currentPageId = table->firstPageId;
         int totalRows = 0;
 
         while (currentPageId != INVALID_PAGE_ID) {
             Page* page = bufferPool->fetchPage(currentPageId);
             if (!page) {
-                delete genericBTree;
                 return createErrorResult(ErrorCode::IO_ERROR,
                                         QString("Failed to fetch page %1").arg(currentPageId));
             }
@@ -2393,13 +3504,7 @@ QueryResult Executor::executeCreateIndex(const CreateIndexStatement* stmt) {
                         continue;
                     }
 
-                    if (!genericBTree->insert(keyValue, rowId)) {
-                        bufferPool->unpinPage(currentPageId, false);
-                        delete genericBTree;
-                        return createErrorResult(ErrorCode::INTERNAL_ERROR,
-                                                QString("Failed to insert key into index"));
-                    }
-
+                    indexEntries.append(qMakePair(keyValue, rowId));
                     totalRows++;
                 }
             }
@@ -2410,6 +3515,14 @@ QueryResult Executor::executeCreateIndex(const CreateIndexStatement* stmt) {
             currentPageId = nextPageId;
         }
 
+        GenericBPlusTree* genericBTree = new GenericBPlusTree(bufferPool, columnTypes[0]);
+
+        if (!genericBTree->bulkLoad(indexEntries, Config::instance().getIndexBulkLoadFillFactor())) {
+            delete genericBTree;
+            return createErrorResult(ErrorCode::INTERNAL_ERROR,
+                                    QString("Failed to build index"));
+        }
+
         rootPageId = genericBTree->getRootPageId();
         delete genericBTree;
 
@@ -2422,9 +3535,9 @@ QueryResult Executor::executeCreateIndex(const CreateIndexStatement* stmt) {
                      .arg(stmt->indexName).arg(columnName));
 
         // 检查列类型是否为文本类型
-        if (column.type != DataType::VARCHAR &&
-            column.type != DataType::TEXT &&
-            column.type != DataType::CHAR) {
+        if (columnTypes[0] != DataType::VARCHAR &&
+            columnTypes[0] != DataType::TEXT &&
+            columnTypes[0] != DataType::CHAR) {
             return createErrorResult(ErrorCode::SEMANTIC_ERROR,
                                     QString("FULLTEXT index can only be created on text columns (VARCHAR, TEXT, CHAR)"));
         }
@@ -2476,12 +3589,251 @@ QueryResult Executor::executeCreateIndex(const CreateIndexStatement* stmt) {
             currentPageId = nextPageId;
         }
 
+        // 把构建好的文档写成段，元数据页作为索引的根页
+        if (!invertedIndex->flush()) {
+            delete invertedIndex;
+            return createErrorResult(ErrorCode::INTERNAL_ERROR,
+                                    QString("Failed to write inverted index to disk"));
+        }
+
         rootPageId = invertedIndex->getRootPageId();
         delete invertedIndex;
 
         LOG_INFO(QString("FULLTEXT index '%1' created successfully (%2 documents indexed)")
                      .arg(stmt->indexName).arg(totalRows));
     }
+    else if (stmt->type == ast::IndexType::BRIN) {
+        // 创建块范围索引：按表链表顺序为每个数据页写一条摘要（空页也登记，之后插入直接并入）
+        LOG_INFO(QString("Creating BRIN index '%1' on column '%2'%3")
+                     .arg(stmt->indexName).arg(columnName)
+                     .arg(bloomEnabled ? " WITH (bloom = true)" : ""));
+
+        if (!KeyEncoder::isEncodableType(columnTypes[0])) {
+            return createErrorResult(ErrorCode::NOT_IMPLEMENTED,
+                                    QString("BRIN index on column type '%1' not supported")
+                                        .arg(getDataTypeName(columnTypes[0])));
+        }
+
+        BlockRangeIndex blockRangeIndex(bufferPool, columnTypes[0]);
+        if (!blockRangeIndex.create(bloomEnabled)) {
+            return createErrorResult(ErrorCode::INTERNAL_ERROR,
+                                    QString("Failed to create BRIN index"));
+        }
+
+        PageId currentPageId = table->firstPageId;
+        int totalRows = 0;
+
+        while (currentPageId != INVALID_PAGE_ID) {
+            Page* page = bufferPool->fetchPage(currentPageId);
+            if (!page) {
+                return createErrorResult(ErrorCode::IO_ERROR,
+                                        QString("Failed to fetch page %1").arg(currentPageId));
+            }
+
+            // 已删除的版本也并入摘要：回滚后它们会重新可见
+            QVector<QVector<QVariant>> pageRecords;
+            QVector<RecordHeader> pageHeaders;
+            bool summarized = blockRangeIndex.addPage(currentPageId);
+            if (summarized && TablePage::getAllRecords(page, table, pageRecords, pageHeaders)) {
+                for (const auto& record : pageRecords) {
+                    if (!blockRangeIndex.addValue(currentPageId, record[columnIndex])) {
+                        summarized = false;
+                        break;
+                    }
+                    totalRows++;
+                }
+            }
+
+            PageHeader* header = page->getHeader();
+            PageId nextPageId = header->nextPageId;
+            bufferPool->unpinPage(currentPageId, false);
+            if (!summarized) {
+                return createErrorResult(ErrorCode::INTERNAL_ERROR,
+                                        QString("Failed to summarize page %1").arg(currentPageId));
+            }
+            currentPageId = nextPageId;
+        }
+
+        rootPageId = blockRangeIndex.getMetaPageId();
+
+        LOG_INFO(QString("BRIN index '%1' created successfully (%2 rows, %3 pages summarized in %4 index pages)")
+                     .arg(stmt->indexName).arg(totalRows)
+                     .arg(blockRangeIndex.summaryCount()).arg(blockRangeIndex.pageCount()));
+    }
+    else if (stmt->type == ast::IndexType::BITMAP) {
+        // 创建位图索引：扫描表，每个不同值收集一个行ID位图，最后一次写回
+        LOG_INFO(QString("Creating BITMAP index '%1' on column '%2'")
+                     .arg(stmt->indexName).arg(columnName));
+
+        if (!KeyEncoder::isEncodableType(columnTypes[0])) {
+            return createErrorResult(ErrorCode::NOT_IMPLEMENTED,
+                                    QString("BITMAP index on column type '%1' not supported")
+                                        .arg(getDataTypeName(columnTypes[0])));
+        }
+
+        BitmapIndex bitmapIndex(bufferPool, columnTypes[0]);
+        if (!bitmapIndex.create()) {
+            return createErrorResult(ErrorCode::INTERNAL_ERROR,
+                                    QString("Failed to create BITMAP index"));
+        }
+
+        PageId currentPageId = table->firstPageId;
+        int totalRows = 0;
+
+        while (currentPageId != INVALID_PAGE_ID) {
+            Page* page = bufferPool->fetchPage(currentPageId);
+            if (!page) {
+                bitmapIndex.destroy();
+                return createErrorResult(ErrorCode::IO_ERROR,
+                                        QString("Failed to fetch page %1").arg(currentPageId));
+            }
+
+            QVector<QVector<QVariant>> pageRecords;
+            QVector<RowId> rowIds;
+            bool indexed = true;
+
+            if (TablePage::getAllRecords(page, table, pageRecords, &rowIds)) {
+                for (int i = 0; i < pageRecords.size(); ++i) {
+                    const QVariant& keyValue = pageRecords[i][columnIndex];
+                    if (keyValue.isNull()) {
+                        continue;
+                    }
+                    if (!bitmapIndex.insert(keyValue, rowIds[i])) {
+                        indexed = false;
+                        break;
+                    }
+                    totalRows++;
+                }
+            }
+
+            PageHeader* header = page->getHeader();
+            PageId nextPageId = header->nextPageId;
+            bufferPool->unpinPage(currentPageId, false);
+            if (!indexed) {
+                bitmapIndex.destroy();
+                return createErrorResult(ErrorCode::INTERNAL_ERROR,
+                                        QString("Failed to insert key into bitmap index"));
+            }
+            currentPageId = nextPageId;
+        }
+
+        if (!bitmapIndex.flush()) {
+            bitmapIndex.destroy();
+            return createErrorResult(ErrorCode::INTERNAL_ERROR,
+                                    QString("Failed to write bitmap index"));
+        }
+
+        rootPageId = bitmapIndex.getMetaPageId();
+
+        LOG_INFO(QString("BITMAP index '%1' created successfully (%2 rows, %3 distinct values)")
+                     .arg(stmt->indexName).arg(totalRows).arg(bitmapIndex.distinctCount()));
+    }
+    else if (stmt->type == ast::IndexType::RTREE) {
+        // 创建 R 树：扫描表收集每行的外包矩形，再用 STR 自底向上一次装满节点
+        LOG_INFO(QString("Creating RTREE index '%1' on column '%2'")
+                     .arg(stmt->indexName).arg(columnName));
+
+        QVector<RTreeIndex::Entry> entries;
+        PageId currentPageId = table->firstPageId;
+
+        while (currentPageId != INVALID_PAGE_ID) {
+            Page* page = bufferPool->fetchPage(currentPageId);
+            if (!page) {
+                return createErrorResult(ErrorCode::IO_ERROR,
+                                        QString("Failed to fetch page %1").arg(currentPageId));
+            }
+
+            QVector<QVector<QVariant>> pageRecords;
+            QVector<RowId> rowIds;
+
+            if (TablePage::getAllRecords(page, table, pageRecords, &rowIds)) {
+                for (int i = 0; i < pageRecords.size(); ++i) {
+                    Geometry geometry;
+                    if (!Geometry::fromValue(pageRecords[i][columnIndex], geometry)) {
+                        continue;  // NULL 不进索引
+                    }
+                    RTreeIndex::Entry entry;
+                    entry.box = geometry.bounds();
+                    entry.ref = rowIds[i];
+                    entries.append(entry);
+                }
+            }
+
+            PageHeader* header = page->getHeader();
+            PageId nextPageId = header->nextPageId;
+            bufferPool->unpinPage(currentPageId, false);
+            currentPageId = nextPageId;
+        }
+
+        RTreeIndex rtree(bufferPool);
+        const int totalRows = entries.size();
+        if (!rtree.create()) {
+            return createErrorResult(ErrorCode::INTERNAL_ERROR,
+                                    QString("Failed to create RTREE index"));
+        }
+        if (!rtree.bulkLoad(std::move(entries))) {
+            rtree.destroy();
+            return createErrorResult(ErrorCode::INTERNAL_ERROR,
+                                    QString("Failed to build RTREE index"));
+        }
+
+        rootPageId = rtree.getMetaPageId();
+
+        LOG_INFO(QString("RTREE index '%1' created successfully (%2 rows, height %3)")
+                     .arg(stmt->indexName).arg(totalRows).arg(rtree.height()));
+    }
+    else if (stmt->type == ast::IndexType::TRIE) {
+        // 创建 TRIE：扫描表收集 (值, rowId)，排序后自底向上一次写好每个节点
+        LOG_INFO(QString("Creating TRIE index '%1' on column '%2'")
+                     .arg(stmt->indexName).arg(columnName));
+
+        QVector<QPair<QString, RowId>> entries;
+        const DataType columnType = table->columns[columnIndex].type;
+        PageId currentPageId = table->firstPageId;
+
+        while (currentPageId != INVALID_PAGE_ID) {
+            Page* page = bufferPool->fetchPage(currentPageId);
+            if (!page) {
+                return createErrorResult(ErrorCode::IO_ERROR,
+                                        QString("Failed to fetch page %1").arg(currentPageId));
+            }
+
+            QVector<QVector<QVariant>> pageRecords;
+            QVector<RowId> rowIds;
+
+            if (TablePage::getAllRecords(page, table, pageRecords, &rowIds)) {
+                for (int i = 0; i < pageRecords.size(); ++i) {
+                    const QVariant& value = pageRecords[i][columnIndex];
+                    if (!value.isNull()) {  // NULL 不进索引
+                        entries.append(qMakePair(TrieIndex::normalizeValue(value.toString(), columnType),
+                                                 rowIds[i]));
+                    }
+                }
+            }
+
+            PageHeader* header = page->getHeader();
+            PageId nextPageId = header->nextPageId;
+            bufferPool->unpinPage(currentPageId, false);
+            currentPageId = nextPageId;
+        }
+
+        TrieIndex trie(bufferPool);
+        const int totalRows = entries.size();
+        if (!trie.create()) {
+            return createErrorResult(ErrorCode::INTERNAL_ERROR,
+                                    QString("Failed to create TRIE index"));
+        }
+        if (!trie.bulkLoad(std::move(entries))) {
+            trie.destroy();
+            return createErrorResult(ErrorCode::INTERNAL_ERROR,
+                                    QString("Failed to build TRIE index"));
+        }
+
+        rootPageId = trie.getMetaPageId();
+
+        LOG_INFO(QString("TRIE index '%1' created successfully (%2 rows)")
+                     .arg(stmt->indexName).arg(totalRows));
+    }
     else {
         return createErrorResult(ErrorCode::NOT_IMPLEMENTED,
                                 QString("Index type not yet implemented"));
@@ -2491,7 +3843,12 @@ QueryResult Executor::executeCreateIndex(const CreateIndexStatement* stmt) {
     IndexDef indexDef;
     indexDef.name = stmt->indexName;
     indexDef.tableName = stmt->tableName;
-    indexDef.columns.append(columnName);
+    indexDef.columns = keyNames;
+    indexDef.includeColumns = stmt->includeColumns;
+    if (hasKeyExpressions) {
+        indexDef.keyExpressions = keyExpressions;
+    }
+    indexDef.predicate = predicateSql;
     // 根据stmt->type设置索引类型
     if (stmt->type == ast::IndexType::HASH) {
         indexDef.indexType = qindb::IndexType::HASH;
@@ -2499,10 +3856,19 @@ QueryResult Executor::executeCreateIndex(const CreateIndexStatement* stmt) {
         indexDef.indexType = qindb::IndexType::BTREE;
     } else if (stmt->type == ast::IndexType::FULLTEXT) {
         indexDef.indexType = qindb::IndexType::INVERTED;
+    } else if (stmt->type == ast::IndexType::BRIN) {
+        indexDef.indexType = qindb::IndexType::BRIN;
+    } else if (stmt->type == ast::IndexType::BITMAP) {
+        indexDef.indexType = qindb::IndexType::BITMAP;
+    } else if (stmt->type == ast::IndexType::RTREE) {
+        indexDef.indexType = qindb::IndexType::RTREE;
+    } else if (stmt->type == ast::IndexType::TRIE) {
+        indexDef.indexType = qindb::IndexType::TRIE;
     } else {
         indexDef.indexType = qindb::IndexType::BTREE; // 默认
     }
-    indexDef.keyType = column.type;             // 保存键的数据类型
+    indexDef.keyType = columnTypes[0];          // 保存键的数据类型（复合索引为首键类型）
+    indexDef.options = stmt->options;
     indexDef.unique = stmt->unique;
     indexDef.rootPageId = rootPageId;
 
@@ -2521,17 +3887,25 @@ QueryResult Executor::executeCreateIndex(const CreateIndexStatement* stmt) {
     bufferPool->flushAllPages();
 
     QString indexTypeStr = getIndexTypeName(indexDef.indexType);
-    LOG_INFO(QString("Index '%1' (%2) created successfully on table '%3', column '%4'")
+    QString columnLabel = columnIndexes.size() > 1 ? QString("columns (%1)").arg(columnList)
+                                                   : QString("column '%1'").arg(columnName);
+    if (!stmt->includeColumns.isEmpty()) {
+        columnLabel += QString(" INCLUDE (%1)").arg(stmt->includeColumns.join(", "));
+    }
+    if (!predicateSql.isEmpty()) {
+        columnLabel += QString(" WHERE %1").arg(predicateSql);
+    }
+    LOG_INFO(QString("Index '%1' (%2) created successfully on table '%3', %4")
                 .arg(stmt->indexName)
                 .arg(indexTypeStr)
                 .arg(stmt->tableName)
-                .arg(columnName));
+                .arg(columnLabel));
 
-    return createSuccessResult(QString("Index '%1' (%2) created on table '%3', column '%4'")
+    return createSuccessResult(QString("Index '%1' (%2) created on table '%3', %4")
                                    .arg(stmt->indexName)
                                    .arg(indexTypeStr)
                                    .arg(stmt->tableName)
-                                   .arg(columnName));
+                                   .arg(columnLabel));
 }
 
 QueryResult Executor::executeDropIndex(const DropIndexStatement* stmt) {
@@ -2662,6 +4036,7 @@ QueryResult Executor::executeBegin(const BeginTransactionStatement* stmt) {
     // 开始新事务
     TransactionId newTxnId = txnManager->beginTransaction();
     dbManager_->setCurrentTransactionId(newTxnId);
+    pendingStatsChanges_.clear();
 
     LOG_INFO(QString("Transaction %1 started").arg(newTxnId));
 
@@ -2704,6 +4079,9 @@ QueryResult Executor::executeCommit(const CommitStatement* stmt) {
     // 清除当前事务ID
     dbManager_->setCurrentTransactionId(INVALID_TXN_ID);
 
+    // 事务中的改动现在才计入统计信息
+    applyStatsChanges();
+
     LOG_INFO(QString("Transaction %1 committed").arg(currentTxnId));
 
     return createSuccessResult(QString("Transaction %1 committed").arg(currentTxnId));
@@ -2826,8 +4204,9 @@ QueryResult Executor::executeRollback(const RollbackStatement* stmt) {
                                 QString("Failed to rollback transaction %1").arg(currentTxnId));
     }
 
-    // 清除当前事务ID
+    // 清除当前事务ID；事务中的改动被撤销，不计入统计信息
     dbManager_->setCurrentTransactionId(INVALID_TXN_ID);
+    pendingStatsChanges_.clear();
 
     LOG_INFO(QString("Transaction %1 rolled back (%2 operations undone)")
                 .arg(currentTxnId).arg(undoCount));
@@ -2914,22 +4293,76 @@ QueryResult Executor::executeAnalyze(const AnalyzeStatement* stmt) {
                 : QString("Failed to collect statistics for table '%1'").arg(stmt->tableName);
     }
 
-    // 保存统计信息到文件
+    // 统计信息已发布到 Catalog，随元数据一起保存
     if (success) {
-        QString statsPath = dbManager_->getDatabasePath(dbManager_->currentDatabaseName()) + "/statistics.json";
-        statsCollector.saveStats(statsPath);
+        QString catalogPath = dbManager_->getDatabasePath(dbManager_->currentDatabaseName()) + "/catalog.json";
+        if (!catalog->save(catalogPath)) {
+            LOG_ERROR("Failed to save catalog after ANALYZE");
+        }
     }
 
     return success ? createSuccessResult(message)
                    : createErrorResult(ErrorCode::INTERNAL_ERROR, message);
 }
 
+QueryResult Executor::executeCalibrate(const ast::CalibrateStatement* stmt) {
+    if (!stmt) {
+        return createErrorResult(ErrorCode::INTERNAL_ERROR, "Invalid CALIBRATE statement");
+    }
+
+    LOG_INFO("Executing CALIBRATE");
+
+    // 测试文件放在当前数据库的目录下，与数据文件在同一设备上
+    const QString currentDb = dbManager_->currentDatabaseName();
+    const QString workDir = currentDb.isEmpty() ? QDir::currentPath() : dbManager_->getDatabasePath(currentDb);
+
+    Config& config = Config::instance();
+    const CostParams previous = config.getCostParams();
+
+    CostCalibrator calibrator(workDir);
+    CalibrationResult calibration;
+    if (!calibrator.calibrate(previous, calibration)) {
+        return createErrorResult(ErrorCode::INTERNAL_ERROR, "Cost calibration failed");
+    }
+
+    // 之后的查询立即使用新参数；写回配置文件，下次启动时加载
+    config.setCostParams(calibration.params);
+    if (!config.saveCostParams()) {
+        LOG_ERROR("Failed to save calibrated cost parameters");
+    }
+
+    QueryResult result;
+    result.success = true;
+    result.columnNames = {"parameter", "previous", "calibrated", "measured"};
+    auto addRow = [&](const QString& name, double before, double after, const QString& measured) {
+        result.rows.append({QVariant(name), QVariant(before), QVariant(after), QVariant(measured)});
+    };
+    auto perOp = [](double ns, const QString& unit) {
+        return QString("%1 ns/%2").arg(ns, 0, 'f', 1).arg(unit);
+    };
+    const CostParams& fitted = calibration.params;
+    addRow("SeqPageReadCost", previous.seqPageReadCost, fitted.seqPageReadCost,
+           perOp(calibration.seqPageReadNs, "page"));
+    addRow("RandomPageReadCost", previous.randomPageReadCost, fitted.randomPageReadCost,
+           perOp(calibration.randomPageReadNs, "page"));
+    addRow("PageWriteCost", previous.pageWriteCost, fitted.pageWriteCost,
+           perOp(calibration.pageWriteNs, "page"));
+    addRow("TupleProcessCost", previous.tupleProcessCost, fitted.tupleProcessCost,
+           perOp(calibration.tupleDecodeNs, "row"));
+    addRow("OperatorCost", previous.operatorCost, fitted.operatorCost,
+           perOp(calibration.operatorEvalNs, "operator"));
+
+    result.message = QString("Cost parameters calibrated (%1 pages, %2 rows)")
+                         .arg(calibration.numPages).arg(calibration.numTuples);
+    return result;
+}
+
 QueryResult Executor::executeExplain(const ExplainStatement* stmt) {
     if (!stmt || !stmt->query) {
         return createErrorResult(ErrorCode::INTERNAL_ERROR, "Invalid EXPLAIN statement");
     }
 
-    LOG_INFO("Executing EXPLAIN for query");
+    LOG_INFO(QString("Executing %1 for query").arg(stmt->analyze ? "EXPLAIN ANALYZE" : "EXPLAIN"));
 
     // 获取当前数据库的组件
     Catalog* catalog = dbManager_->getCurrentCatalog();
@@ -2939,17 +4372,49 @@ QueryResult Executor::executeExplain(const ExplainStatement* stmt) {
         return createErrorResult(ErrorCode::SEMANTIC_ERROR, "No database selected. Use 'USE DATABASE <name>' first.");
     }
 
-    // 创建统计收集器和CBO优化器
-    StatisticsCollector statsCollector(catalog, bufferPool);
+    QueryResult result;
+    result.success = true;
+    result.columnNames = {"Plan"};
+
+    if (stmt->analyze) {
+        // 实际执行查询（不读写查询缓存），计划节点上记录了实际行数和耗时
+        QueryResult permError;
+        if (!checkSelectPermissions(stmt->query.get(), permError)) {
+            return permError;
+        }
+
+        std::unique_ptr<PlanNode> plan;
+        QElapsedTimer timer;
+        timer.start();
+        QueryResult queryResult = executeSelect(stmt->query.get(), &plan);
+        const double elapsedMs = timer.nsecsElapsed() / 1e6;
+        if (!queryResult.success) {
+            return queryResult;
+        }
+        if (!plan) {
+            return createErrorResult(ErrorCode::INTERNAL_ERROR, "Failed to generate execution plan");
+        }
 
-    // 尝试加载统计信息
-    QString statsPath = dbManager_->getDatabasePath(dbManager_->currentDatabaseName()) + "/statistics.json";
-    statsCollector.loadStats(statsPath);
+        QString planStr = formatPlan(plan.get(), 0, true);
+        planStr += QString("Execution time: %1 ms\n").arg(elapsedMs, 0, 'f', 3);
+
+        result.message = QString("Execution Plan (%1 rows returned)").arg(queryResult.rows.size());
+        result.rows = {{QVariant(planStr)}};
+        return result;
+    }
 
-    CostOptimizer optimizer(catalog, &statsCollector);
+    // 与执行时一样先做查询重写，EXPLAIN 显示的就是 SELECT 实际使用的计划
+    std::unique_ptr<SelectStatement> rewrittenQuery;
+    const SelectStatement* query = stmt->query.get();
+    if (queryRewriteEnabled_ && queryRewriter_) {
+        rewrittenQuery = queryRewriter_->rewrite(query);
+        if (rewrittenQuery) {
+            query = rewrittenQuery.get();
+        }
+    }
 
     // 生成执行计划
-    auto plan = optimizer.optimizeSelect(stmt->query.get());
+    auto plan = buildSelectPlan(catalog, bufferPool, query);
 
     if (!plan) {
         return createErrorResult(ErrorCode::INTERNAL_ERROR, "Failed to generate execution plan");
@@ -2958,48 +4423,30 @@ QueryResult Executor::executeExplain(const ExplainStatement* stmt) {
     // 格式化执行计划输出
     QString planStr = formatPlan(plan.get(), 0);
 
-    QueryResult result;
-    result.success = true;
     result.message = "Execution Plan";
-    result.columnNames = {"Plan"};
     result.rows = {{QVariant(planStr)}};
 
     return result;
 }
 
-QString Executor::formatPlan(const PlanNode* node, int indent) const {
-    if (!node) return "";
+std::unique_ptr<PlanNode> Executor::buildSelectPlan(Catalog* catalog, BufferPoolManager* bufferPool,
+                                                    const SelectStatement* stmt) {
+    // 创建统计收集器和CBO优化器：统计信息取自 Catalog 中最近一次 ANALYZE 的结果，
+    // 没有时优化器使用缺省估算
+    StatisticsCollector statsCollector(catalog, bufferPool);
+
+    CostOptimizer optimizer(catalog, &statsCollector, CostModel(Config::instance().getCostParams()));
+    return optimizer.optimizeSelect(stmt);
+}
+
+QString Executor::formatPlan(const PlanNode* node, int indent, bool analyze) const {
+    if (!node) return "";
 
     QString indentStr(indent * 2, ' ');
     QString result;
 
     // 节点类型
-    QString nodeType;
-    switch (node->nodeType) {
-        case PlanNodeType::SEQ_SCAN:
-            nodeType = "SeqScan";
-            break;
-        case PlanNodeType::INDEX_SCAN:
-            nodeType = "IndexScan";
-            break;
-        case PlanNodeType::NESTED_LOOP_JOIN:
-            nodeType = "NestedLoopJoin";
-            break;
-        case PlanNodeType::HASH_JOIN:
-            nodeType = "HashJoin";
-            break;
-        case PlanNodeType::SORT_MERGE_JOIN:
-            nodeType = "SortMergeJoin";
-            break;
-        case PlanNodeType::SORT:
-            nodeType = "Sort";
-            break;
-        case PlanNodeType::LIMIT:
-            nodeType = "Limit";
-            break;
-        default:
-            nodeType = "Unknown";
-    }
+    const QString nodeType = planNodeTypeName(node->nodeType);
 
     // 格式化当前节点
     result += indentStr + nodeType;
@@ -3012,13 +4459,29 @@ QString Executor::formatPlan(const PlanNode* node, int indent) const {
         result += " using " + node->indexName;
     }
 
-    result += QString(" (cost=%1 rows=%2)\n")
+    result += QString(" (cost=%1 rows=%2)")
                 .arg(node->cost.totalCost, 0, 'f', 2)
                 .arg(node->cost.estimatedRows);
 
+    // EXPLAIN ANALYZE：实际行数和耗时（包含子节点）
+    if (analyze) {
+        if (node->executed) {
+            result += QString(" (actual time=%1 ms rows=%2")
+                        .arg(node->actualTimeMs, 0, 'f', 3)
+                        .arg(node->actualRows);
+            if (node->loops > 1) {
+                result += QString(" loops=%1").arg(node->loops);
+            }
+            result += ")";
+        } else {
+            result += " (never executed)";
+        }
+    }
+    result += "\n";
+
     // 递归格式化子节点
     for (const auto& child : node->children) {
-        result += formatPlan(child.get(), indent + 1);
+        result += formatPlan(child.get(), indent + 1, analyze);
     }
 
     return result;
@@ -3293,6 +4756,1326 @@ QueryResult Executor::executeRevoke(const RevokeStatement* stmt) {
                                    .arg(privStr).arg(targetStr).arg(stmt->username));
 }
 
+void Executor::maintainIndexes(Catalog* catalog, BufferPoolManager* bufferPool, const TableDef* table,
+                               const QVector<QVariant>* oldRow, RowId oldRowId,
+                               const QVector<QVariant>* newRow, RowId newRowId, TransactionId txnId,
+                               PageId newPageId) {
+    QVector<IndexDef> tableIndexes = catalog->getTableIndexes(table->name);
+    for (const auto& indexDef : tableIndexes) {
+        if (usesCompositeLayout(indexDef)) {
+            maintainCompositeIndex(catalog, bufferPool, table, indexDef, oldRow, oldRowId, newRow, newRowId, txnId);
+            continue;
+        }
+        if (indexDef.columns.size() != 1) continue;
+
+        int columnIndex = table->getColumnIndex(indexDef.columns[0]);
+        if (columnIndex < 0) continue;
+
+        QVariant oldKey = oldRow ? oldRow->value(columnIndex) : QVariant();
+        QVariant newKey = newRow ? newRow->value(columnIndex) : QVariant();
+
+        if (indexDef.indexType == qindb::IndexType::RTREE) {
+            // R 树只保存外包矩形：矩形和行都没变时不用动（NULL 不在索引中）
+            Geometry oldGeometry;
+            Geometry newGeometry;
+            const bool hasOld = Geometry::fromValue(oldKey, oldGeometry);
+            const bool hasNew = Geometry::fromValue(newKey, newGeometry);
+            if (hasOld && hasNew && oldRowId == newRowId && oldGeometry.bounds() == newGeometry.bounds()) {
+                continue;
+            }
+
+            RTreeIndex rtree(bufferPool, indexDef.rootPageId);
+            if (!rtree.load()) {
+                LOG_WARN(QString("Failed to load RTREE index '%1'").arg(indexDef.name));
+                continue;
+            }
+            if (hasOld && !rtree.remove(oldGeometry.bounds(), oldRowId)) {
+                LOG_WARN(QString("Failed to remove old key from index '%1'").arg(indexDef.name));
+            }
+            if (hasNew && !rtree.insert(newGeometry.bounds(), newRowId)) {
+                LOG_WARN(QString("Failed to insert new key into index '%1'").arg(indexDef.name));
+            }
+            continue;
+        }
+
+        if (indexDef.indexType == qindb::IndexType::TRIE) {
+            // 与建索引时一样去掉 CHAR 的填充空格；值和行都没变时不用动
+            const DataType columnType = table->columns[columnIndex].type;
+            const QString oldValue = TrieIndex::normalizeValue(oldKey.toString(), columnType);
+            const QString newValue = TrieIndex::normalizeValue(newKey.toString(), columnType);
+            if (oldRow && newRow && oldRowId == newRowId && !oldKey.isNull() && !newKey.isNull() &&
+                oldValue == newValue) {
+                continue;
+            }
+
+            TrieIndex trie(bufferPool, indexDef.rootPageId);
+            if (!trie.load()) {
+                LOG_WARN(QString("Failed to load TRIE index '%1'").arg(indexDef.name));
+                continue;
+            }
+            if (!oldKey.isNull() && !trie.remove(oldValue, oldRowId)) {
+                LOG_WARN(QString("Failed to remove old key from index '%1'").arg(indexDef.name));
+            }
+            if (!newKey.isNull() && !trie.insert(newValue, newRowId)) {
+                LOG_WARN(QString("Failed to insert new key into index '%1'").arg(indexDef.name));
+            }
+            continue;
+        }
+
+        // 键和行都没变（原地更新了其他列），索引不用动
+        if (oldRow && newRow && oldRowId == newRowId &&
+            !oldKey.isNull() && !newKey.isNull() &&
+            KeyComparator::compare(oldKey, newKey, indexDef.keyType) == 0) {
+            continue;
+        }
+
+        if (indexDef.indexType == qindb::IndexType::BRIN) {
+            // 摘要只变宽不变窄：删除和旧值都不用处理，新行的值并入所在页的摘要
+            if (!newRow) {
+                continue;
+            }
+            PageId pageId = newPageId;
+            RowLocation location;
+            if (pageId == INVALID_PAGE_ID && table->rowIdIndex && table->rowIdIndex->lookup(newRowId, location)) {
+                pageId = location.pageId;
+            }
+            if (pageId == INVALID_PAGE_ID) {
+                LOG_WARN(QString("Cannot locate row %1 for BRIN index '%2'").arg(newRowId).arg(indexDef.name));
+                continue;
+            }
+
+            BlockRangeIndex* blockRangeIndex = openBlockRangeIndex(bufferPool, indexDef);
+            if (!blockRangeIndex || !blockRangeIndex->addValue(pageId, newKey)) {
+                LOG_WARN(QString("Failed to update BRIN index '%1'").arg(indexDef.name));
+            }
+            continue;
+        }
+
+        if (indexDef.indexType == qindb::IndexType::HASH) {
+            // 同一语句的多行修改共用一个已加载目录的哈希索引
+            HashIndex* hashIndex = openHashIndex(catalog, bufferPool, indexDef);
+            if (!hashIndex) {
+                continue;
+            }
+
+            // 哈希桶允许重复键，删除时必须带上 rowId
+            if (!oldKey.isNull() && !hashIndex->remove(oldKey, oldRowId)) {
+                LOG_WARN(QString("Failed to remove old key from index '%1'").arg(indexDef.name));
+            }
+            if (!newKey.isNull() && !hashIndex->insert(newKey, newRowId)) {
+                LOG_WARN(QString("Failed to insert new key into index '%1'").arg(indexDef.name));
+            }
+        } else if (indexDef.indexType == qindb::IndexType::BTREE) {
+            // 使用通用 B+ 树（支持所有数据类型）
+            GenericBPlusTree genericBTree(bufferPool, indexDef.keyType, indexDef.rootPageId);
+
+            if (!oldKey.isNull() && !genericBTree.remove(oldKey)) {
+                LOG_WARN(QString("Failed to remove old key from index '%1'").arg(indexDef.name));
+            }
+            if (!newKey.isNull() && !genericBTree.insert(newKey, newRowId)) {
+                LOG_WARN(QString("Failed to insert new key into index '%1'").arg(indexDef.name));
+            }
+
+            // 根节点分裂后根页会变，写回目录，否则下次打开的还是旧根
+            if (genericBTree.getRootPageId() != indexDef.rootPageId) {
+                catalog->setIndexRootPageId(indexDef.name, genericBTree.getRootPageId());
+            }
+        } else if (indexDef.indexType == qindb::IndexType::BITMAP) {
+            // 位图的修改先作用在内存中，语句结束时只重写变化过的位图
+            BitmapIndex* bitmapIndex = pendingBitmapIndex(bufferPool, indexDef);
+            if (!bitmapIndex) {
+                continue;
+            }
+
+            if (!oldKey.isNull() && !bitmapIndex->remove(oldKey, oldRowId)) {
+                LOG_WARN(QString("Failed to remove old key from index '%1'").arg(indexDef.name));
+            }
+            if (!newKey.isNull() && !bitmapIndex->insert(newKey, newRowId)) {
+                LOG_WARN(QString("Failed to insert new key into index '%1'").arg(indexDef.name));
+            }
+        } else if (indexDef.indexType == qindb::IndexType::INVERTED) {
+            // 全文索引的修改先进入内存缓冲区，语句结束时统一写成段
+            InvertedIndex* invertedIndex = pendingFullTextIndex(bufferPool, indexDef);
+            if (!invertedIndex) {
+                continue;
+            }
+
+            if (!oldKey.isNull()) {
+                invertedIndex->remove(oldRowId);
+            }
+            if (!newKey.isNull() && !invertedIndex->insert(newRowId, newKey.toString())) {
+                LOG_WARN(QString("Failed to insert document into index '%1'").arg(indexDef.name));
+            }
+        }
+    }
+}
+
+void Executor::maintainCompositeIndex(Catalog* catalog, BufferPoolManager* bufferPool, const TableDef* table,
+                                      const IndexDef& indexDef,
+                                      const QVector<QVariant>* oldRow, RowId oldRowId,
+                                      const QVector<QVariant>* newRow, RowId newRowId, TransactionId txnId) {
+    IndexKeyLayout layout;
+    QVector<int> includeIndexes;
+    QVector<DataType> includeTypes;
+    if (!resolveIndexColumns(table, indexDef, layout) ||
+        !resolveIncludeColumns(table, indexDef, includeIndexes, includeTypes)) {
+        return;
+    }
+
+    // 部分索引：旧行满足谓词时才有条目，新行满足谓词时才写入条目
+    ExpressionEvaluator evaluator(catalog);
+    const bool oldIndexed = oldRow && rowInIndex(*oldRow, layout, table, evaluator);
+    const bool newIndexed = newRow && rowInIndex(*newRow, layout, table, evaluator);
+    if (!oldIndexed && !newIndexed) {
+        return;
+    }
+
+    CompositeKey oldKey;
+    CompositeKey newKey;
+    if (oldIndexed) {
+        oldKey = buildCompositeKey(*oldRow, layout, table, evaluator);
+    }
+    if (newIndexed) {
+        newKey = buildCompositeKey(*newRow, layout, table, evaluator);
+    }
+
+    QVector<QVariant> newIncluded;
+    if (newIndexed) {
+        newIncluded = buildIncludedValues(*newRow, includeIndexes);
+    }
+
+    // 索引键、包含列和行都没变（原地更新了其他列），索引不用动
+    if (oldIndexed && newIndexed && oldRowId == newRowId && oldKey.encode() == newKey.encode() &&
+        buildIncludedValues(*oldRow, includeIndexes) == newIncluded) {
+        return;
+    }
+
+    CompositeIndex compositeIndex(bufferPool, layout.columnTypes, indexDef.rootPageId, includeTypes);
+
+    // 复合索引的键带 rowId 后缀，删除时按 (键, rowId) 精确定位；
+    // 新条目记下写入事务，仅索引扫描用它做可见性检查
+    if (oldIndexed && !compositeIndex.remove(oldKey, oldRowId)) {
+        LOG_WARN(QString("Failed to remove old key from index '%1'").arg(indexDef.name));
+    }
+    if (newIndexed && !compositeIndex.insert(newKey, newRowId, newIncluded, txnId)) {
+        LOG_WARN(QString("Failed to insert new key into index '%1'").arg(indexDef.name));
+    }
+
+    if (compositeIndex.getRootPageId() != indexDef.rootPageId) {
+        catalog->setIndexRootPageId(indexDef.name, compositeIndex.getRootPageId());
+    }
+}
+
+InvertedIndex* Executor::pendingFullTextIndex(BufferPoolManager* bufferPool, const IndexDef& indexDef) {
+    auto it = pendingFullTextIndexes_.find(indexDef.name);
+    if (it != pendingFullTextIndexes_.end()) {
+        return it.value().get();
+    }
+
+    auto invertedIndex = std::make_shared<InvertedIndex>(indexDef.name, bufferPool);
+    if (!invertedIndex->setRootPageId(indexDef.rootPageId)) {
+        LOG_WARN(QString("Failed to load FULLTEXT index '%1'").arg(indexDef.name));
+        return nullptr;
+    }
+
+    pendingFullTextIndexes_.insert(indexDef.name, invertedIndex);
+    return invertedIndex.get();
+}
+
+void Executor::recordStatsChange(const QString& tableName, size_t rowsInserted, size_t rowsDeleted,
+                                 size_t rowsUpdated, bool autoCommit) {
+    PendingStatsChange& change = pendingStatsChanges_[tableName.toLower()];
+    change.inserted += rowsInserted;
+    change.deleted += rowsDeleted;
+    change.updated += rowsUpdated;
+
+    if (autoCommit) {
+        applyStatsChanges();
+    }
+}
+
+void Executor::applyStatsChanges() {
+    Catalog* catalog = dbManager_->getCurrentCatalog();
+    BufferPoolManager* bufferPool = dbManager_->getCurrentBufferPool();
+    AutoAnalyzeWorker* autoAnalyzer = dbManager_->getCurrentAutoAnalyzer();
+    if (catalog && bufferPool) {
+        StatisticsCollector collector(catalog, bufferPool);
+        for (auto it = pendingStatsChanges_.constBegin(); it != pendingStatsChanges_.constEnd(); ++it) {
+            const bool reanalyze = collector.updateTableStats(it.key(), it->inserted, it->deleted, it->updated);
+            if (reanalyze && autoAnalyzer) {
+                autoAnalyzer->schedule(it.key());
+            }
+        }
+    }
+    pendingStatsChanges_.clear();
+}
+
+void Executor::flushPendingIndexes() {
+    for (auto it = pendingFullTextIndexes_.begin(); it != pendingFullTextIndexes_.end(); ++it) {
+        if (!it.value()->flush()) {
+            LOG_WARN(QString("Failed to flush FULLTEXT index '%1'").arg(it.key()));
+        }
+    }
+    for (auto it = pendingBitmapIndexes_.begin(); it != pendingBitmapIndexes_.end(); ++it) {
+        if (!it.value()->flush()) {
+            LOG_WARN(QString("Failed to flush BITMAP index '%1'").arg(it.key()));
+        }
+    }
+    pendingFullTextIndexes_.clear();
+    pendingBitmapIndexes_.clear();
+    openBlockRangeIndexes_.clear();
+    // 哈希索引析构时写回脏元数据
+    openHashIndexes_.clear();
+}
+
+BitmapIndex* Executor::pendingBitmapIndex(BufferPoolManager* bufferPool, const IndexDef& indexDef) {
+    auto it = pendingBitmapIndexes_.find(indexDef.name);
+    if (it != pendingBitmapIndexes_.end()) {
+        return it.value().get();
+    }
+
+    auto bitmapIndex = std::make_shared<BitmapIndex>(bufferPool, indexDef.keyType, indexDef.rootPageId);
+    if (!bitmapIndex->load()) {
+        LOG_WARN(QString("Failed to load BITMAP index '%1'").arg(indexDef.name));
+        return nullptr;
+    }
+
+    pendingBitmapIndexes_.insert(indexDef.name, bitmapIndex);
+    return bitmapIndex.get();
+}
+
+BlockRangeIndex* Executor::openBlockRangeIndex(BufferPoolManager* bufferPool, const IndexDef& indexDef) {
+    auto it = openBlockRangeIndexes_.find(indexDef.name);
+    if (it != openBlockRangeIndexes_.end()) {
+        return it.value().get();
+    }
+
+    auto blockRangeIndex = std::make_shared<BlockRangeIndex>(bufferPool, indexDef.keyType, indexDef.rootPageId);
+    if (!blockRangeIndex->load()) {
+        LOG_WARN(QString("Failed to load BRIN index '%1'").arg(indexDef.name));
+        return nullptr;
+    }
+
+    openBlockRangeIndexes_.insert(indexDef.name, blockRangeIndex);
+    return blockRangeIndex.get();
+}
+
+HashIndex* Executor::openHashIndex(Catalog* catalog, BufferPoolManager* bufferPool, const IndexDef& indexDef) {
+    auto it = openHashIndexes_.find(indexDef.name);
+    if (it != openHashIndexes_.end()) {
+        return it.value().get();
+    }
+
+    auto hashIndex = std::make_shared<HashIndex>(indexDef.name, indexDef.keyType, bufferPool);
+    if (!hashIndex->setDirectoryPageId(indexDef.rootPageId)) {
+        LOG_WARN(QString("Failed to load hash index '%1'").arg(indexDef.name));
+        return nullptr;
+    }
+
+    // 旧版本在空列上建的哈希索引没有目录页：补建目录并写回目录，否则每行都会新建一份目录
+    if (indexDef.rootPageId == INVALID_PAGE_ID) {
+        if (!hashIndex->ensureDirectory()) {
+            LOG_WARN(QString("Failed to create directory for hash index '%1'").arg(indexDef.name));
+            return nullptr;
+        }
+        catalog->setIndexRootPageId(indexDef.name, hashIndex->getDirectoryPageId());
+    }
+
+    openHashIndexes_.insert(indexDef.name, hashIndex);
+    return hashIndex.get();
+}
+
+bool Executor::probeHashIndex(Catalog* catalog, BufferPoolManager* bufferPool, const TableDef* table,
+                              const ast::Expression* where, QSet<RowId>& rowIds) {
+    const BinaryExpression* binExpr = dynamic_cast<const BinaryExpression*>(where);
+    if (!binExpr) {
+        return false;
+    }
+
+    // AND：用能走哈希索引的一侧缩小候选，另一侧由调用方重新评估
+    if (binExpr->op == BinaryOp::AND) {
+        return probeHashIndex(catalog, bufferPool, table, binExpr->left.get(), rowIds) ||
+               probeHashIndex(catalog, bufferPool, table, binExpr->right.get(), rowIds);
+    }
+
+    const ColumnExpression* colExpr = nullptr;
+    QVector<QVariant> keys;
+
+    if (binExpr->op == BinaryOp::EQ) {
+        // column = constant 或 constant = column
+        colExpr = dynamic_cast<const ColumnExpression*>(binExpr->left.get());
+        const LiteralExpression* litExpr = dynamic_cast<const LiteralExpression*>(binExpr->right.get());
+        if (!colExpr || !litExpr) {
+            colExpr = dynamic_cast<const ColumnExpression*>(binExpr->right.get());
+            litExpr = dynamic_cast<const LiteralExpression*>(binExpr->left.get());
+        }
+        if (!colExpr || !litExpr) {
+            return false;
+        }
+        keys.append(litExpr->value);
+    } else if (binExpr->op == BinaryOp::IN) {
+        // column IN (constant, ...)
+        colExpr = dynamic_cast<const ColumnExpression*>(binExpr->left.get());
+        const ListExpression* listExpr = dynamic_cast<const ListExpression*>(binExpr->right.get());
+        if (!colExpr || !listExpr) {
+            return false;
+        }
+        for (const auto& element : listExpr->elements) {
+            const LiteralExpression* litExpr = dynamic_cast<const LiteralExpression*>(element.get());
+            if (!litExpr) {
+                return false;
+            }
+            // IN 列表中的 NULL 永远匹配不到，直接跳过
+            if (!litExpr->value.isNull()) {
+                keys.append(litExpr->value);
+            }
+        }
+    } else {
+        return false;
+    }
+
+    IndexDef indexDef;
+    if (!findHashIndex(catalog, table->name, colExpr->column, indexDef)) {
+        return false;
+    }
+
+    for (const QVariant& key : keys) {
+        if (!isHashProbeKey(key, indexDef.keyType)) {
+            return false;
+        }
+    }
+
+    HashIndex hashIndex(indexDef.name, indexDef.keyType, bufferPool);
+    if (!hashIndex.setDirectoryPageId(indexDef.rootPageId)) {
+        LOG_WARN(QString("Failed to load hash index '%1', falling back to table scan").arg(indexDef.name));
+        return false;
+    }
+
+    rowIds.clear();
+    for (const QVariant& key : keys) {
+        std::vector<RowId> matches;
+        if (hashIndex.searchAll(key, matches)) {
+            for (RowId rowId : matches) {
+                rowIds.insert(rowId);
+            }
+        }
+    }
+
+    LOG_INFO(QString("Using HASH index '%1' for %2 probe(s): %3 candidate row(s)")
+                .arg(indexDef.name).arg(keys.size()).arg(rowIds.size()));
+    return true;
+}
+
+/**
+ * @brief 合取项是否为 列 = 常量 或 列 IN (常量, ...)
+ * @param keys 输出：要探测的值（IN 列表中的 NULL 永远匹配不到，已去掉）
+ * @return 列表达式，不是这两种形式时返回 nullptr
+ */
+static const ColumnExpression* matchEqualityProbe(const Expression* conjunct, QVector<QVariant>& keys) {
+    const BinaryExpression* binExpr = dynamic_cast<const BinaryExpression*>(conjunct);
+    if (!binExpr) {
+        return nullptr;
+    }
+
+    if (binExpr->op == BinaryOp::EQ) {
+        const ColumnExpression* colExpr = dynamic_cast<const ColumnExpression*>(binExpr->left.get());
+        const LiteralExpression* litExpr = dynamic_cast<const LiteralExpression*>(binExpr->right.get());
+        if (!colExpr || !litExpr) {
+            colExpr = dynamic_cast<const ColumnExpression*>(binExpr->right.get());
+            litExpr = dynamic_cast<const LiteralExpression*>(binExpr->left.get());
+        }
+        if (!colExpr || !litExpr) {
+            return nullptr;
+        }
+        keys.append(litExpr->value);
+        return colExpr;
+    }
+
+    if (binExpr->op == BinaryOp::IN) {
+        const ColumnExpression* colExpr = dynamic_cast<const ColumnExpression*>(binExpr->left.get());
+        const ListExpression* listExpr = dynamic_cast<const ListExpression*>(binExpr->right.get());
+        if (!colExpr || !listExpr) {
+            return nullptr;
+        }
+        for (const auto& element : listExpr->elements) {
+            const LiteralExpression* litExpr = dynamic_cast<const LiteralExpression*>(element.get());
+            if (!litExpr) {
+                keys.clear();
+                return nullptr;
+            }
+            if (!litExpr->value.isNull()) {
+                keys.append(litExpr->value);
+            }
+        }
+        return colExpr;
+    }
+
+    return nullptr;
+}
+
+bool Executor::probeBitmapIndex(Catalog* catalog, BufferPoolManager* bufferPool, const TableDef* table,
+                                const ast::Expression* where, QSet<RowId>& rowIds) {
+    if (!where) {
+        return false;
+    }
+
+    QVector<const Expression*> conjuncts;
+    IndexExpression::splitConjuncts(where, conjuncts);
+
+    // 每个可用的合取项取一个位图（IN 取各值位图之并），再逐个求交；同一索引只加载一次目录
+    QHash<QString, std::shared_ptr<BitmapIndex>> openedIndexes;
+    QStringList usedIndexes;
+    RoaringBitmap candidates;
+    for (const Expression* conjunct : conjuncts) {
+        QVector<QVariant> keys;
+        const ColumnExpression* colExpr = matchEqualityProbe(conjunct, keys);
+        if (!colExpr) {
+            continue;
+        }
+
+        IndexDef indexDef;
+        if (!findBitmapIndex(catalog, table->name, colExpr->column, indexDef)) {
+            continue;
+        }
+        bool probeable = true;
+        for (const QVariant& key : keys) {
+            probeable = probeable && isHashProbeKey(key, indexDef.keyType);
+        }
+        if (!probeable) {
+            continue;
+        }
+
+        std::shared_ptr<BitmapIndex> bitmapIndex = openedIndexes.value(indexDef.name);
+        if (!bitmapIndex) {
+            bitmapIndex = std::make_shared<BitmapIndex>(bufferPool, indexDef.keyType, indexDef.rootPageId);
+            if (!bitmapIndex->load()) {
+                LOG_WARN(QString("Failed to load BITMAP index '%1', ignoring it").arg(indexDef.name));
+                continue;
+            }
+            openedIndexes.insert(indexDef.name, bitmapIndex);
+        }
+
+        RoaringBitmap matches;
+        if (!bitmapIndex->lookupAny(keys, matches)) {
+            continue;
+        }
+        if (usedIndexes.isEmpty()) {
+            candidates = std::move(matches);
+        } else {
+            candidates.intersectWith(matches);
+        }
+        usedIndexes.append(indexDef.name);
+
+        if (candidates.isEmpty()) {
+            break;
+        }
+    }
+
+    if (usedIndexes.isEmpty()) {
+        return false;
+    }
+
+    rowIds.clear();
+    const QVector<RowId> candidateIds = candidates.toVector();
+    rowIds.reserve(candidateIds.size());
+    for (RowId rowId : candidateIds) {
+        rowIds.insert(rowId);
+    }
+
+    LOG_INFO(QString("Using BITMAP index(es) %1 for %2 predicate(s): %3 candidate row(s)")
+                .arg(usedIndexes.join(", ")).arg(usedIndexes.size()).arg(rowIds.size()));
+    return true;
+}
+
+bool Executor::probeSpatialIndex(Catalog* catalog, BufferPoolManager* bufferPool, const TableDef* table,
+                                 const ast::Expression* where, QSet<RowId>& rowIds) {
+    if (!where) {
+        return false;
+    }
+
+    QVector<const Expression*> conjuncts;
+    IndexExpression::splitConjuncts(where, conjuncts);
+
+    ExpressionEvaluator evaluator(catalog);
+    QStringList usedIndexes;
+    QSet<RowId> candidates;
+    for (const Expression* conjunct : conjuncts) {
+        const auto* function = dynamic_cast<const FunctionCallExpression*>(conjunct);
+        if (!function) {
+            continue;
+        }
+        const QString name = function->name.toUpper();
+        const bool withinDistance = name == "ST_DWITHIN";
+        if (!(name == "MBRINTERSECTS" || name == "ST_INTERSECTS" || withinDistance) ||
+            function->arguments.size() != (withinDistance ? 3u : 2u)) {
+            continue;
+        }
+
+        const Expression* constant = nullptr;
+        const ColumnExpression* colExpr = matchSpatialArguments(function, table, constant);
+        IndexDef indexDef;
+        if (!colExpr || !findRTreeIndex(catalog, table->name, colExpr->column, indexDef)) {
+            continue;
+        }
+
+        // 查询矩形：常量几何对象的外包矩形，ST_DWithin 再向外扩展距离
+        Geometry queryGeometry;
+        const QVariant queryValue = evaluator.evaluate(constant);
+        if (evaluator.hasError() || !Geometry::fromValue(queryValue, queryGeometry)) {
+            continue;
+        }
+        BoundingBox queryBox = queryGeometry.bounds();
+        if (withinDistance) {
+            const QVariant distance = evaluator.evaluate(function->arguments[2].get());
+            if (evaluator.hasError() || distance.isNull()) {
+                continue;
+            }
+            queryBox = queryBox.grown(std::max(0.0, distance.toDouble()));
+        }
+
+        RTreeIndex rtree(bufferPool, indexDef.rootPageId);
+        QVector<RowId> matches;
+        if (!rtree.load() || !rtree.search(queryBox, matches)) {
+            LOG_WARN(QString("Failed to search RTREE index '%1', ignoring it").arg(indexDef.name));
+            continue;
+        }
+
+        QSet<RowId> matchSet(matches.begin(), matches.end());
+        if (usedIndexes.isEmpty()) {
+            candidates = std::move(matchSet);
+        } else {
+            candidates.intersect(matchSet);
+        }
+        usedIndexes.append(indexDef.name);
+
+        if (candidates.isEmpty()) {
+            break;
+        }
+    }
+
+    if (usedIndexes.isEmpty()) {
+        return false;
+    }
+
+    rowIds = std::move(candidates);
+    LOG_INFO(QString("Using RTREE index(es) %1 for %2 spatial predicate(s): %3 candidate row(s)")
+                .arg(usedIndexes.join(", ")).arg(usedIndexes.size()).arg(rowIds.size()));
+    return true;
+}
+
+namespace {
+
+/**
+ * @brief 按行ID逐行读取并筛选（可见性检查、WHERE 求值），同一数据页只读一次
+ *
+ * 索引按自身的顺序（距离、键序）给出行、取够行数就停止时使用
+ */
+class RowIdFetcher {
+public:
+    RowIdFetcher(BufferPoolManager* bufferPool, const TableDef* table, const Expression* where,
+                 ExpressionEvaluator& evaluator, VisibilityChecker* checker, TransactionId txnId)
+        : bufferPool_(bufferPool)
+        , table_(table)
+        , where_(where)
+        , evaluator_(evaluator)
+        , checker_(checker)
+        , txnId_(txnId) {
+    }
+
+    /**
+     * @param row 输出：可见且满足 WHERE 的行（到下一次 fetch 前有效），否则为 nullptr
+     * @return 无法定位行或 WHERE 求值出错时返回 false，调用方应退回常规扫描
+     */
+    bool fetch(RowId rowId, const QVector<QVariant>*& row) {
+        row = nullptr;
+        RowLocation location;
+        if (!table_->rowIdIndex->lookup(rowId, location)) {
+            return false;
+        }
+        auto pageIt = pageCache_.find(location.pageId);
+        if (pageIt == pageCache_.end()) {
+            Page* page = bufferPool_->fetchPage(location.pageId);
+            if (!page) {
+                return false;
+            }
+            PageRows rows;
+            TablePage::getAllRecords(page, table_, rows.records, rows.headers);
+            bufferPool_->unpinPage(location.pageId, false);
+            pageIt = pageCache_.insert(location.pageId, rows);
+        }
+
+        const PageRows& rows = pageIt.value();
+        for (int i = 0; i < rows.headers.size(); ++i) {
+            if (rows.headers[i].rowId != rowId) {
+                continue;
+            }
+            if (checker_ && !checker_->isVisible(rows.headers[i], txnId_)) {
+                return true;
+            }
+            if (where_) {
+                const QVariant whereResult = evaluator_.evaluateWithRow(where_, table_, rows.records[i]);
+                if (evaluator_.hasError()) {
+                    return false;  // 交给常规扫描报告错误
+                }
+                if (whereResult.isNull() || !whereResult.toBool()) {
+                    return true;
+                }
+            }
+            row = &rows.records[i];
+            return true;
+        }
+        return true;
+    }
+
+private:
+    struct PageRows {
+        QVector<QVector<QVariant>> records;
+        QVector<RecordHeader> headers;
+    };
+
+    BufferPoolManager* bufferPool_;
+    const TableDef* table_;
+    const Expression* where_;
+    ExpressionEvaluator& evaluator_;
+    VisibilityChecker* checker_;
+    TransactionId txnId_;
+    QHash<PageId, PageRows> pageCache_;
+};
+
+} // namespace
+
+bool Executor::probeNearestNeighbors(Catalog* catalog, BufferPoolManager* bufferPool, const TableDef* table,
+                                     const SelectStatement* stmt, QSet<RowId>& rowIds) {
+    if (stmt->limit <= 0 || stmt->orderBy.empty() || !stmt->orderBy.front().ascending ||
+        stmt->groupBy || stmt->distinct || !stmt->joins.empty() || !table->rowIdIndex) {
+        return false;
+    }
+    for (const auto& item : stmt->selectList) {
+        if (dynamic_cast<const AggregateExpression*>(item.get())) {
+            return false;
+        }
+    }
+
+    const auto* function = dynamic_cast<const FunctionCallExpression*>(stmt->orderBy.front().expression.get());
+    if (!function || function->name.toUpper() != "ST_DISTANCE" || function->arguments.size() != 2) {
+        return false;
+    }
+    const Expression* constant = nullptr;
+    const ColumnExpression* colExpr = matchSpatialArguments(function, table, constant);
+    IndexDef indexDef;
+    if (!colExpr || !findRTreeIndex(catalog, table->name, colExpr->column, indexDef)) {
+        return false;
+    }
+    const int columnIndex = table->getColumnIndex(colExpr->column);
+
+    // 升序时 NULL 排在最前，而 NULL 不在索引中：只有列不可能为 NULL 时才能用索引取前 k 行
+    bool nullsExcluded = table->columns[columnIndex].notNull;
+    QVector<const Expression*> conjuncts;
+    IndexExpression::splitConjuncts(stmt->where.get(), conjuncts);
+    for (const Expression* conjunct : conjuncts) {
+        const auto* unaryExpr = dynamic_cast<const UnaryExpression*>(conjunct);
+        const auto* operand = unaryExpr ? dynamic_cast<const ColumnExpression*>(unaryExpr->expr.get()) : nullptr;
+        if (unaryExpr && unaryExpr->op == UnaryOp::IS_NOT_NULL && operand &&
+            operand->column.compare(colExpr->column, Qt::CaseInsensitive) == 0) {
+            nullsExcluded = true;
+        }
+    }
+    if (!nullsExcluded) {
+        LOG_DEBUG(QString("RTREE index '%1' not used for ORDER BY ST_Distance: column '%2' is nullable")
+                      .arg(indexDef.name).arg(colExpr->column));
+        return false;
+    }
+
+    ExpressionEvaluator evaluator(catalog);
+    Geometry target;
+    const QVariant targetValue = evaluator.evaluate(constant);
+    if (evaluator.hasError() || !Geometry::fromValue(targetValue, target)) {
+        return false;
+    }
+
+    RTreeIndex rtree(bufferPool, indexDef.rootPageId);
+    if (!rtree.load()) {
+        LOG_WARN(QString("Failed to load RTREE index '%1', ignoring it").arg(indexDef.name));
+        return false;
+    }
+
+    TransactionManager* txnManager = dbManager_->getCurrentTransactionManager();
+    TransactionId currentTxnId = dbManager_->getCurrentTransactionId();
+    if (currentTxnId == INVALID_TXN_ID) {
+        currentTxnId = 0;
+    }
+    std::unique_ptr<VisibilityChecker> checker;
+    if (txnManager) {
+        checker = std::make_unique<VisibilityChecker>(txnManager);
+    }
+
+    // 按外包矩形的最短距离由近到远取行，逐行做可见性检查、WHERE 求值和精确距离计算；
+    // 第 k 近的精确距离小于下一个条目的距离下界时，剩下的行都不可能进入结果
+    RowIdFetcher fetcher(bufferPool, table, stmt->where.get(), evaluator, checker.get(), currentTxnId);
+    QVector<QPair<double, RowId>> found;  // 满足条件的行，按精确距离升序
+    const int k = stmt->limit + std::max(stmt->offset, 0);
+    int examined = 0;
+
+    RTreeIndex::NearestCursor cursor(&rtree, target.bounds());
+    RowId rowId = INVALID_ROW_ID;
+    double lowerBound = 0.0;
+    bool stopped = false;
+    while (cursor.next(rowId, lowerBound)) {
+        if (found.size() >= k && lowerBound > found[k - 1].first) {
+            stopped = true;
+            break;
+        }
+        ++examined;
+
+        const QVector<QVariant>* row = nullptr;
+        if (!fetcher.fetch(rowId, row)) {
+            return false;  // 无法定位或求值出错时退回全表扫描
+        }
+        Geometry geometry;
+        if (!row || !Geometry::fromValue((*row)[columnIndex], geometry)) {
+            continue;
+        }
+        const QPair<double, RowId> item(geometry.distance(target), rowId);
+        found.insert(std::upper_bound(found.begin(), found.end(), item), item);
+    }
+    if (cursor.hasError()) {
+        return false;
+    }
+
+    // 与第 k 近距离相同的行全部保留，由随后的排序和 LIMIT 决定取舍
+    rowIds.clear();
+    const double cutoff = found.size() >= k ? found[k - 1].first : std::numeric_limits<double>::infinity();
+    for (const auto& item : found) {
+        if (item.first <= cutoff) {
+            rowIds.insert(item.second);
+        }
+    }
+
+    scanStoppedEarly_ = stopped;
+
+    LOG_INFO(QString("Using RTREE index '%1' for nearest-neighbour ORDER BY (%2 entries examined, %3 candidate row(s))")
+                .arg(indexDef.name).arg(examined).arg(rowIds.size()));
+    return true;
+}
+
+/**
+ * @brief 识别可用 TRIE 索引回答的合取项：col LIKE '字面前缀...'（前缀非空）或 col = '字符串'
+ * @param key 输出：LIKE 模式的字面前缀，或等值比较的值
+ * @param exact 输出：是否按整个值查找（等值，或不含通配符的 LIKE）
+ */
+static const ColumnExpression* matchTrieProbe(const Expression* conjunct, QString& key, bool& exact) {
+    const BinaryExpression* binExpr = dynamic_cast<const BinaryExpression*>(conjunct);
+    if (!binExpr || (binExpr->op != BinaryOp::LIKE && binExpr->op != BinaryOp::EQ)) {
+        return nullptr;
+    }
+
+    const ColumnExpression* colExpr = dynamic_cast<const ColumnExpression*>(binExpr->left.get());
+    const LiteralExpression* litExpr = dynamic_cast<const LiteralExpression*>(binExpr->right.get());
+    if (binExpr->op == BinaryOp::EQ && (!colExpr || !litExpr)) {
+        colExpr = dynamic_cast<const ColumnExpression*>(binExpr->right.get());
+        litExpr = dynamic_cast<const LiteralExpression*>(binExpr->left.get());
+    }
+    if (!colExpr || !litExpr || litExpr->value.userType() != QMetaType::QString) {
+        return nullptr;
+    }
+
+    if (binExpr->op == BinaryOp::EQ) {
+        key = litExpr->value.toString();
+        exact = true;
+        return colExpr;
+    }
+
+    // '%abc' 这样以通配符开头的模式没有可用的前缀
+    key = ExpressionEvaluator::likePrefix(litExpr->value.toString(), &exact);
+    return key.isEmpty() ? nullptr : colExpr;
+}
+
+bool Executor::probeTrieIndex(Catalog* catalog, BufferPoolManager* bufferPool, const TableDef* table,
+                              const ast::Expression* where, QSet<RowId>& rowIds,
+                              const SelectStatement* select) {
+    if (!where) {
+        return false;
+    }
+
+    struct TrieProbe {
+        IndexDef indexDef;
+        QString key;
+        bool exact = false;
+    };
+    QVector<TrieProbe> probes;
+    QVector<const Expression*> conjuncts;
+    IndexExpression::splitConjuncts(where, conjuncts);
+    for (const Expression* conjunct : conjuncts) {
+        TrieProbe probe;
+        const ColumnExpression* colExpr = matchTrieProbe(conjunct, probe.key, probe.exact);
+        if (colExpr && findTrieIndex(catalog, table->name, colExpr->column, probe.indexDef)) {
+            const int columnIndex = table->getColumnIndex(colExpr->column);
+            if (probe.exact && columnIndex >= 0) {
+                probe.key = TrieIndex::normalizeValue(probe.key, table->columns[columnIndex].type);
+            }
+            probes.append(probe);
+        }
+    }
+    if (probes.isEmpty()) {
+        return false;
+    }
+
+    // 不带 ORDER BY 的 LIMIT k：任意 k 行满足条件的行都是正确结果，
+    // 按键序从第一个前缀开始逐行回表检查，取够 k 行就停，不必取出前缀下的全部行
+    bool limitScan = select && select->limit > 0 && select->orderBy.empty() && !select->groupBy &&
+                     !select->distinct && select->joins.empty() && table->rowIdIndex;
+    for (size_t i = 0; limitScan && i < select->selectList.size(); ++i) {
+        if (dynamic_cast<const AggregateExpression*>(select->selectList[i].get())) {
+            limitScan = false;
+        }
+    }
+
+    if (limitScan) {
+        const TrieProbe& probe = probes.front();
+        TrieIndex trie(bufferPool, probe.indexDef.rootPageId);
+        if (!trie.load()) {
+            LOG_WARN(QString("Failed to load TRIE index '%1', ignoring it").arg(probe.indexDef.name));
+            return false;
+        }
+
+        TransactionManager* txnManager = dbManager_->getCurrentTransactionManager();
+        TransactionId currentTxnId = dbManager_->getCurrentTransactionId();
+        if (currentTxnId == INVALID_TXN_ID) {
+            currentTxnId = 0;
+        }
+        std::unique_ptr<VisibilityChecker> checker;
+        if (txnManager) {
+            checker = std::make_unique<VisibilityChecker>(txnManager);
+        }
+
+        ExpressionEvaluator evaluator(catalog);
+        RowIdFetcher fetcher(bufferPool, table, where, evaluator, checker.get(), currentTxnId);
+        const int k = select->limit + std::max(select->offset, 0);
+        QSet<RowId> found;
+        int examined = 0;
+
+        TrieIndex::Cursor cursor(&trie, probe.exact ? TrieIndex::encodeValue(probe.key)
+                                                    : TrieIndex::encodePrefix(probe.key));
+        QString value;
+        RowId rowId = INVALID_ROW_ID;
+        bool fetched = true;
+        while (found.size() < k && cursor.next(value, rowId)) {
+            ++examined;
+            const QVector<QVariant>* row = nullptr;
+            if (!fetcher.fetch(rowId, row)) {
+                fetched = false;
+                break;
+            }
+            if (row) {
+                found.insert(rowId);
+            }
+        }
+
+        if (fetched && !cursor.hasError()) {
+            scanStoppedEarly_ = found.size() >= k;
+            rowIds = std::move(found);
+            LOG_INFO(QString("Using TRIE index '%1' for LIMIT %2 (%3 entries examined, %4 candidate row(s))")
+                        .arg(probe.indexDef.name).arg(k).arg(examined).arg(rowIds.size()));
+            return true;
+        }
+        // 无法逐行回表时按下面的方式取全部候选行
+    }
+
+    QStringList usedIndexes;
+    QSet<RowId> candidates;
+    for (const TrieProbe& probe : probes) {
+        TrieIndex trie(bufferPool, probe.indexDef.rootPageId);
+        QVector<RowId> matches;
+        const bool searched = trie.load() &&
+                              (probe.exact ? trie.lookup(probe.key, matches)
+                                           : trie.prefixSearch(probe.key, 0, matches));
+        if (!searched) {
+            LOG_WARN(QString("Failed to search TRIE index '%1', ignoring it").arg(probe.indexDef.name));
+            continue;
+        }
+
+        QSet<RowId> matchSet(matches.begin(), matches.end());
+        if (usedIndexes.isEmpty()) {
+            candidates = std::move(matchSet);
+        } else {
+            candidates.intersect(matchSet);
+        }
+        usedIndexes.append(probe.indexDef.name);
+
+        if (candidates.isEmpty()) {
+            break;
+        }
+    }
+
+    if (usedIndexes.isEmpty()) {
+        return false;
+    }
+
+    rowIds = std::move(candidates);
+    LOG_INFO(QString("Using TRIE index(es) %1 for %2 predicate(s): %3 candidate row(s)")
+                .arg(usedIndexes.join(", ")).arg(usedIndexes.size()).arg(rowIds.size()));
+    return true;
+}
+
+bool Executor::probeCompositeIndex(Catalog* catalog, BufferPoolManager* bufferPool, const TableDef* table,
+                                   const ast::Expression* where, QSet<RowId>& rowIds,
+                                   const QSet<int>* requiredColumns,
+                                   QVector<IndexOnlyRow>* indexOnlyRows,
+                                   bool* indexOnly) {
+    if (indexOnly) {
+        *indexOnly = false;
+    }
+
+    if (!where) {
+        return false;
+    }
+
+    QVector<ColumnPredicate> predicates;
+    collectColumnPredicates(where, predicates);
+
+    // 为每个复合索引匹配：前 k 列等值 + 第 k+1 列范围，选用到列最多的一个；
+    // 用到的列一样多时优先能覆盖查询的索引。
+    // 部分索引只有在 WHERE 蕴含其谓词时才可用，此时即使没有可用的键条件，
+    // 扫描整个（很小的）部分索引也比全表扫描好
+    IndexDef bestIndex;
+    IndexKeyLayout bestLayout;
+    QVector<int> bestIncludeColumns;
+    QVector<DataType> bestIncludeTypes;
+    CompositeKey bestPrefix;
+    CompositeIndex::ColumnRange bestRange;
+    int bestScore = 0;
+    bool bestCovers = false;
+
+    QVector<IndexDef> tableIndexes = catalog->getTableIndexes(table->name);
+    for (const auto& indexDef : tableIndexes) {
+        if (!usesCompositeLayout(indexDef) || indexDef.rootPageId == INVALID_PAGE_ID) {
+            continue;
+        }
+
+        IndexKeyLayout layout;
+        QVector<int> includeIndexes;
+        QVector<DataType> includeTypes;
+        if (!resolveIndexColumns(table, indexDef, layout) ||
+            !resolveIncludeColumns(table, indexDef, includeIndexes, includeTypes)) {
+            continue;
+        }
+        if (layout.predicate && !IndexExpression::implies(where, layout.predicate.get())) {
+            continue;
+        }
+        const QVector<int>& columnIndexes = layout.columnIndexes;
+        const QVector<DataType>& columnTypes = layout.columnTypes;
+
+        CompositeKey prefix;
+        int matched = 0;
+        while (matched < indexDef.columns.size()) {
+            const ColumnPredicate* equality = nullptr;
+            for (const auto& predicate : predicates) {
+                if (predicate.op == BinaryOp::EQ &&
+                    predicateMatchesKey(predicate, indexDef, matched) &&
+                    isHashProbeKey(predicate.value, columnTypes[matched])) {
+                    equality = &predicate;
+                    break;
+                }
+            }
+            if (!equality) {
+                break;
+            }
+            prefix.addValue(equality->value, columnTypes[matched]);
+            ++matched;
+        }
+
+        // 下一列的范围：同方向有多个界时取更紧的一个
+        CompositeIndex::ColumnRange range;
+        if (matched < indexDef.columns.size()) {
+            const DataType rangeType = columnTypes[matched];
+            for (const auto& predicate : predicates) {
+                if (predicate.op == BinaryOp::EQ ||
+                    !predicateMatchesKey(predicate, indexDef, matched) ||
+                    !isHashProbeKey(predicate.value, rangeType)) {
+                    continue;
+                }
+                const bool inclusive = predicate.op == BinaryOp::GE || predicate.op == BinaryOp::LE;
+                if (predicate.op == BinaryOp::GT || predicate.op == BinaryOp::GE) {
+                    int cmp = range.hasLower ? KeyComparator::compare(predicate.value, range.lower, rangeType) : 1;
+                    if (cmp > 0 || (cmp == 0 && !inclusive)) {
+                        range.hasLower = true;
+                        range.lower = predicate.value;
+                        range.lowerInclusive = inclusive;
+                    }
+                } else {
+                    int cmp = range.hasUpper ? KeyComparator::compare(predicate.value, range.upper, rangeType) : -1;
+                    if (cmp < 0 || (cmp == 0 && !inclusive)) {
+                        range.hasUpper = true;
+                        range.upper = predicate.value;
+                        range.upperInclusive = inclusive;
+                    }
+                }
+            }
+        }
+
+        bool covers = false;
+        if (requiredColumns) {
+            covers = true;
+            for (int column : *requiredColumns) {
+                if (!columnIndexes.contains(column) && !includeIndexes.contains(column)) {
+                    covers = false;
+                    break;
+                }
+            }
+        }
+
+        const int score = matched * 2 + (range.isBounded() ? 1 : 0) + (layout.predicate ? 1 : 0);
+        if (score > bestScore || (score > 0 && score == bestScore && covers && !bestCovers)) {
+            bestScore = score;
+            bestCovers = covers;
+            bestIndex = indexDef;
+            bestLayout = layout;
+            bestIncludeColumns = includeIndexes;
+            bestIncludeTypes = includeTypes;
+            bestPrefix = prefix;
+            bestRange = range;
+        }
+    }
+
+    if (bestScore == 0) {
+        return false;
+    }
+
+    CompositeIndex compositeIndex(bufferPool, bestLayout.columnTypes, bestIndex.rootPageId, bestIncludeTypes);
+    QVector<CompositeIndex::Entry> matches;
+    if (!compositeIndex.scanEntries(bestPrefix, bestRange, matches)) {
+        LOG_WARN(QString("Failed to scan composite index '%1', falling back to table scan").arg(bestIndex.name));
+        return false;
+    }
+
+    rowIds.clear();
+    for (const auto& match : matches) {
+        rowIds.insert(match.rowId);
+    }
+
+    // 索引覆盖了查询用到的所有列：直接用条目还原行，不再读数据页。
+    // 条目只记创建事务，删除只体现在数据页的 deleteTxnId 上：提交或自己的删除会移除条目，
+    // 回滚（或崩溃恢复撤销）的插入却只在数据页上标记删除、条目留在索引里。创建事务在事务表中
+    // 有记录（已提交、已中止或仍活跃）时条目的可见性可以确定；否则（如重启前写入的条目）
+    // 无法从索引判断，回表由数据页的记录头做可见性检查。旧格式的树值槽位不是事务ID，也要回表
+    bool answerFromIndex = bestCovers && indexOnlyRows && compositeIndex.storesCreateTxnIds();
+    if (answerFromIndex) {
+        TransactionManager* txnManager = dbManager_->getCurrentTransactionManager();
+        for (const auto& match : matches) {
+            if (!txnManager ||
+                txnManager->getTransactionState(match.createTxnId) == TransactionState::INVALID) {
+                answerFromIndex = false;
+                break;
+            }
+        }
+    }
+    if (answerFromIndex) {
+        indexOnlyRows->clear();
+        indexOnlyRows->reserve(matches.size());
+        for (const auto& match : matches) {
+            IndexOnlyRow row;
+            row.header.rowId = match.rowId;
+            row.header.createTxnId = match.createTxnId;
+            row.header.columnCount = static_cast<uint16_t>(table->columns.size());
+            row.record.resize(table->columns.size());
+            // 表达式键的值不是列值，不能用来还原行
+            for (int i = 0; i < bestLayout.columnIndexes.size(); ++i) {
+                if (bestLayout.columnIndexes[i] >= 0) {
+                    row.record[bestLayout.columnIndexes[i]] = match.key.getValue(i);
+                }
+            }
+            for (int i = 0; i < bestIncludeColumns.size(); ++i) {
+                row.record[bestIncludeColumns[i]] = match.included.value(i);
+            }
+            indexOnlyRows->append(std::move(row));
+        }
+        if (indexOnly) {
+            *indexOnly = true;
+        }
+    }
+
+    LOG_INFO(QString("Using composite BTREE index '%1' (%2 equality column(s)%3%4%5): %6 candidate row(s)")
+                .arg(bestIndex.name)
+                .arg(bestPrefix.size())
+                .arg(bestRange.isBounded() ? " + range" : "")
+                .arg(bestLayout.predicate ? ", partial" : "")
+                .arg(answerFromIndex ? ", index-only" : "")
+                .arg(rowIds.size()));
+    return true;
+}
+
+bool Executor::locateRowPages(const TableDef* table, const QSet<RowId>& rowIds, QVector<PageId>& pages) {
+    pages.clear();
+    if (!table->rowIdIndex) {
+        return false;
+    }
+
+    QSet<PageId> seen;
+    for (RowId rowId : rowIds) {
+        RowLocation location;
+        if (!table->rowIdIndex->lookup(rowId, location)) {
+            return false;
+        }
+        if (!seen.contains(location.pageId)) {
+            seen.insert(location.pageId);
+            pages.append(location.pageId);
+        }
+    }
+
+    // 按页号顺序访问，尽量顺序读
+    std::sort(pages.begin(), pages.end());
+    return true;
+}
+
+/**
+ * @brief 从 WHERE 的 AND 合取项中收集作用在 columnName 上的条件，构造块范围索引的扫描条件
+ *
+ * 只用 WHERE 蕴含的条件（每一项都是某个合取项本身），同一方向的多个边界取更紧的一个；
+ * 常量类型和列类型不匹配的条件被忽略（交给 WHERE 求值）
+ */
+static void buildBlockRangeFilter(const Expression* where, const QString& columnName, DataType keyType,
+                                  BlockRangeIndex::Filter& filter) {
+    QVector<const Expression*> conjuncts;
+    IndexExpression::splitConjuncts(where, conjuncts);
+
+    auto isColumn = [&columnName](const Expression* expr) {
+        const auto* colExpr = dynamic_cast<const ColumnExpression*>(expr);
+        return colExpr && colExpr->column.compare(columnName, Qt::CaseInsensitive) == 0;
+    };
+
+    for (const Expression* conjunct : conjuncts) {
+        if (const auto* unaryExpr = dynamic_cast<const UnaryExpression*>(conjunct)) {
+            if (isColumn(unaryExpr->expr.get())) {
+                if (unaryExpr->op == UnaryOp::IS_NULL) filter.isNull = true;
+                if (unaryExpr->op == UnaryOp::IS_NOT_NULL) filter.isNotNull = true;
+            }
+            continue;
+        }
+
+        const auto* binExpr = dynamic_cast<const BinaryExpression*>(conjunct);
+        if (!binExpr) {
+            continue;
+        }
+
+        if (binExpr->op == BinaryOp::IN) {
+            const auto* listExpr = dynamic_cast<const ListExpression*>(binExpr->right.get());
+            if (filter.hasEquals || !isColumn(binExpr->left.get()) || !listExpr) {
+                continue;
+            }
+            QVector<QVariant> values;
+            bool usable = true;
+            for (const auto& element : listExpr->elements) {
+                const auto* litExpr = dynamic_cast<const LiteralExpression*>(element.get());
+                if (!litExpr) {
+                    usable = false;
+                    break;
+                }
+                // IN 列表中的 NULL 永远匹配不到
+                if (litExpr->value.isNull()) {
+                    continue;
+                }
+                if (!isHashProbeKey(litExpr->value, keyType)) {
+                    usable = false;
+                    break;
+                }
+                values.append(litExpr->value);
+            }
+            if (usable) {
+                filter.hasEquals = true;
+                filter.equals = values;
+            }
+            continue;
+        }
+
+        QVector<ColumnPredicate> predicates;
+        collectColumnPredicates(conjunct, predicates);
+        for (const ColumnPredicate& predicate : predicates) {
+            if (!predicate.isColumn || predicate.subject.compare(columnName, Qt::CaseInsensitive) != 0 ||
+                !isHashProbeKey(predicate.value, keyType)) {
+                continue;
+            }
+
+            switch (predicate.op) {
+                case BinaryOp::EQ:
+                    if (!filter.hasEquals) {
+                        filter.hasEquals = true;
+                        filter.equals = {predicate.value};
+                    }
+                    break;
+                case BinaryOp::GT:
+                case BinaryOp::GE: {
+                    const bool inclusive = predicate.op == BinaryOp::GE;
+                    const int cmp = filter.hasLower ? KeyComparator::compare(predicate.value, filter.lower, keyType) : 1;
+                    if (cmp > 0 || (cmp == 0 && !inclusive)) {
+                        filter.hasLower = true;
+                        filter.lower = predicate.value;
+                        filter.lowerInclusive = inclusive;
+                    }
+                    break;
+                }
+                case BinaryOp::LT:
+                case BinaryOp::LE: {
+                    const bool inclusive = predicate.op == BinaryOp::LE;
+                    const int cmp = filter.hasUpper ? KeyComparator::compare(predicate.value, filter.upper, keyType) : -1;
+                    if (cmp < 0 || (cmp == 0 && !inclusive)) {
+                        filter.hasUpper = true;
+                        filter.upper = predicate.value;
+                        filter.upperInclusive = inclusive;
+                    }
+                    break;
+                }
+                default:
+                    break;
+            }
+        }
+    }
+}
+
+bool Executor::probeBlockRangeIndex(Catalog* catalog, BufferPoolManager* bufferPool, const TableDef* table,
+                                    const ast::Expression* where, QVector<PageId>& pages) {
+    if (!where) {
+        return false;
+    }
+
+    // 表上可能有多个块范围索引，选排除页数最多的一个
+    bool used = false;
+    QString usedIndexName;
+    int totalPages = 0;
+    QVector<IndexDef> tableIndexes = catalog->getTableIndexes(table->name);
+    for (const auto& indexDef : tableIndexes) {
+        if (indexDef.indexType != qindb::IndexType::BRIN || indexDef.columns.size() != 1 ||
+            indexDef.rootPageId == INVALID_PAGE_ID) {
+            continue;
+        }
+
+        BlockRangeIndex::Filter filter;
+        buildBlockRangeFilter(where, indexDef.columns[0], indexDef.keyType, filter);
+        if (!filter.isRestrictive()) {
+            continue;
+        }
+
+        BlockRangeIndex blockRangeIndex(bufferPool, indexDef.keyType, indexDef.rootPageId);
+        if (!blockRangeIndex.load()) {
+            LOG_WARN(QString("Failed to load BRIN index '%1', falling back to table scan").arg(indexDef.name));
+            continue;
+        }
+
+        QVector<PageId> candidates = blockRangeIndex.candidatePages(filter);
+        if (!used || candidates.size() < pages.size()) {
+            pages = candidates;
+            usedIndexName = indexDef.name;
+            totalPages = blockRangeIndex.summaryCount();
+            used = true;
+        }
+    }
+
+    if (used) {
+        LOG_INFO(QString("Using BRIN index '%1': %2 of %3 page(s) may match")
+                    .arg(usedIndexName).arg(pages.size()).arg(totalPages));
+    }
+    return used;
+}
+
 bool Executor::checkSelectPermissions(const SelectStatement* stmt, QueryResult& errorOut) {
     if (!stmt || !stmt->from) {
         return true;
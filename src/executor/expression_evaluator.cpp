@@ -1,5 +1,11 @@
 #include "qindb/expression_evaluator.h"  // 包含表达式求值器的头文件
+#include "qindb/geometry.h"
 #include "qindb/logger.h"                // 包含日志记录器的头文件
+#include <QSet>
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <cstdlib>
 
 namespace qindb {  // 定义qindb命名空间
 
@@ -77,6 +83,10 @@ QVariant ExpressionEvaluator::evaluateWithRow(const ast::Expression* expr,
         return evaluateColumn(column, table, row);
     }
 
+    if (auto* function = dynamic_cast<const ast::FunctionCallExpression*>(expr)) {
+        return evaluateFunction(function, table, row);
+    }
+
     setError("Unsupported expression type");
     return QVariant();
 }
@@ -105,6 +115,13 @@ QVariant ExpressionEvaluator::evaluateBinary(const ast::BinaryExpression* expr,
         return QVariant();
     }
 
+    // IN (a, b, c): the list is not a value, match against each element
+    if (expr->op == ast::BinaryOp::IN) {
+        if (auto* list = dynamic_cast<const ast::ListExpression*>(expr->right.get())) {
+            return evaluateInList(left, list, table, row);
+        }
+    }
+
     QVariant right = evaluateWithRow(expr->right.get(), table, row);
     if (hasError()) {
         return QVariant();
@@ -136,6 +153,12 @@ QVariant ExpressionEvaluator::evaluateBinary(const ast::BinaryExpression* expr,
         case Op::OR:
             return evaluateLogical(left, right, expr->op);
 
+        case Op::LIKE:
+            if (left.isNull() || right.isNull()) {
+                return QVariant();
+            }
+            return QVariant(matchLike(left.toString(), right.toString()));
+
         default:
             setError("Unsupported binary operator");
             return QVariant();
@@ -225,6 +248,304 @@ QVariant ExpressionEvaluator::evaluateColumn(const ast::ColumnExpression* expr,
     return row[colIndex];
 }
 
+QVariant ExpressionEvaluator::evaluateInList(const QVariant& left,
+                                             const ast::ListExpression* list,
+                                             const TableDef* table,
+                                             const QVector<QVariant>& row) {
+    // SQL semantics: NULL IN (...) is NULL; no match but a NULL element is NULL
+    if (left.isNull()) {
+        return QVariant();
+    }
+
+    bool sawNull = false;
+    for (const auto& element : list->elements) {
+        QVariant value = evaluateWithRow(element.get(), table, row);
+        if (hasError()) {
+            return QVariant();
+        }
+        if (value.isNull()) {
+            sawNull = true;
+            continue;
+        }
+
+        QVariant equal = evaluateComparison(left, value, ast::BinaryOp::EQ);
+        if (hasError()) {
+            return QVariant();
+        }
+        if (equal.toBool()) {
+            return QVariant(true);
+        }
+    }
+
+    return sawNull ? QVariant() : QVariant(false);
+}
+
+bool ExpressionEvaluator::matchLike(const QString& value, const QString& pattern) {
+    // 贪心匹配：失配时回到最近一个 '%'，让它多匹配一个字符后重试
+    qsizetype v = 0;
+    qsizetype p = 0;
+    qsizetype resumePattern = -1;
+    qsizetype resumeValue = 0;
+    while (v < value.size()) {
+        if (p < pattern.size()) {
+            if (pattern[p] == '%') {
+                resumePattern = ++p;
+                resumeValue = v;
+                continue;
+            }
+            const bool escaped = pattern[p] == '\\' && p + 1 < pattern.size();
+            const QChar ch = escaped ? pattern[p + 1] : pattern[p];
+            if ((!escaped && ch == '_') || ch == value[v]) {
+                p += escaped ? 2 : 1;
+                ++v;
+                continue;
+            }
+        }
+        if (resumePattern < 0) {
+            return false;
+        }
+        p = resumePattern;
+        v = ++resumeValue;
+    }
+
+    while (p < pattern.size() && pattern[p] == '%') {
+        ++p;
+    }
+    return p == pattern.size();
+}
+
+QString ExpressionEvaluator::likePrefix(const QString& pattern, bool* exact) {
+    QString prefix;
+    for (qsizetype i = 0; i < pattern.size(); ++i) {
+        QChar ch = pattern[i];
+        if (ch == '%' || ch == '_') {
+            if (exact) {
+                *exact = false;
+            }
+            return prefix;
+        }
+        if (ch == '\\' && i + 1 < pattern.size()) {
+            ch = pattern[++i];
+        }
+        prefix.append(ch);
+    }
+    if (exact) {
+        *exact = true;
+    }
+    return prefix;
+}
+
+bool ExpressionEvaluator::isScalarFunction(const QString& name) {
+    static const QSet<QString> functions = {
+        "LOWER", "LCASE", "UPPER", "UCASE", "TRIM", "LTRIM", "RTRIM",
+        "LENGTH", "CHAR_LENGTH", "SUBSTRING", "SUBSTR", "CONCAT",
+        "ABS", "ROUND", "COALESCE", "IFNULL",
+        // 空间函数（参数和结果中的几何对象均为 WKT）
+        "ST_POINT", "ST_MAKEPOINT", "ST_MAKEENVELOPE", "ST_GEOMFROMTEXT", "ST_ASTEXT",
+        "ST_X", "ST_Y", "ST_ENVELOPE", "ST_DISTANCE", "ST_INTERSECTS", "ST_DWITHIN", "MBRINTERSECTS"
+    };
+    return functions.contains(name.toUpper());
+}
+
+QVariant ExpressionEvaluator::evaluateFunction(const ast::FunctionCallExpression* expr,
+                                               const TableDef* table,
+                                               const QVector<QVariant>& row) {
+    const QString name = expr->name.toUpper();
+    if (!isScalarFunction(name)) {
+        setError(QString("Unsupported function '%1'").arg(expr->name));
+        return QVariant();
+    }
+
+    QVector<QVariant> args;
+    args.reserve(static_cast<qsizetype>(expr->arguments.size()));
+    for (const auto& argument : expr->arguments) {
+        QVariant value = evaluateWithRow(argument.get(), table, row);
+        if (hasError()) {
+            return QVariant();
+        }
+        args.append(value);
+    }
+
+    auto requireArgs = [&](int minCount, int maxCount) {
+        if (args.size() < minCount || args.size() > maxCount) {
+            setError(QString("Wrong number of arguments to %1").arg(name));
+            return false;
+        }
+        return true;
+    };
+
+    // COALESCE / IFNULL：返回第一个非 NULL 参数
+    if (name == "COALESCE" || name == "IFNULL") {
+        if (!requireArgs(name == "IFNULL" ? 2 : 1, name == "IFNULL" ? 2 : INT_MAX)) {
+            return QVariant();
+        }
+        for (const QVariant& value : args) {
+            if (!value.isNull()) {
+                return value;
+            }
+        }
+        return QVariant();
+    }
+
+    // 其余函数任一参数为 NULL 时结果为 NULL
+    for (const QVariant& value : args) {
+        if (value.isNull()) {
+            return QVariant();
+        }
+    }
+
+    if (name == "LOWER" || name == "LCASE") {
+        return requireArgs(1, 1) ? QVariant(args[0].toString().toLower()) : QVariant();
+    }
+    if (name == "UPPER" || name == "UCASE") {
+        return requireArgs(1, 1) ? QVariant(args[0].toString().toUpper()) : QVariant();
+    }
+    if (name == "TRIM") {
+        return requireArgs(1, 1) ? QVariant(args[0].toString().trimmed()) : QVariant();
+    }
+    if (name == "LTRIM" || name == "RTRIM") {
+        if (!requireArgs(1, 1)) {
+            return QVariant();
+        }
+        QString text = args[0].toString();
+        if (name == "LTRIM") {
+            qsizetype start = 0;
+            while (start < text.size() && text[start].isSpace()) ++start;
+            return QVariant(text.mid(start));
+        }
+        qsizetype end = text.size();
+        while (end > 0 && text[end - 1].isSpace()) --end;
+        return QVariant(text.left(end));
+    }
+    if (name == "LENGTH" || name == "CHAR_LENGTH") {
+        return requireArgs(1, 1) ? QVariant(static_cast<qint64>(args[0].toString().size())) : QVariant();
+    }
+    if (name == "SUBSTRING" || name == "SUBSTR") {
+        if (!requireArgs(2, 3)) {
+            return QVariant();
+        }
+        // SQL 下标从 1 开始
+        const QString text = args[0].toString();
+        const qsizetype start = std::max<qsizetype>(args[1].toLongLong() - 1, 0);
+        if (args.size() == 3) {
+            return QVariant(text.mid(start, std::max<qsizetype>(args[2].toLongLong(), 0)));
+        }
+        return QVariant(text.mid(start));
+    }
+    if (name == "CONCAT") {
+        QString result;
+        for (const QVariant& value : args) {
+            result += value.toString();
+        }
+        return QVariant(result);
+    }
+    if (name == "ABS") {
+        if (!requireArgs(1, 1)) {
+            return QVariant();
+        }
+        const int type = args[0].userType();
+        if (type == QMetaType::Double || type == QMetaType::Float) {
+            return QVariant(std::fabs(args[0].toDouble()));
+        }
+        return QVariant(static_cast<qint64>(std::llabs(args[0].toLongLong())));
+    }
+    if (name == "ROUND") {
+        if (!requireArgs(1, 2)) {
+            return QVariant();
+        }
+        const int digits = args.size() == 2 ? args[1].toInt() : 0;
+        const double scale = std::pow(10.0, digits);
+        const double rounded = std::round(args[0].toDouble() * scale) / scale;
+        // 与 IndexExpression::inferType 一致：只有一个参数时是整数，指定了位数时是浮点数（位数 <= 0 也一样）
+        if (args.size() == 1) {
+            return QVariant(static_cast<qint64>(rounded));
+        }
+        return QVariant(rounded);
+    }
+
+    if (name.startsWith("ST_") || name == "MBRINTERSECTS") {
+        return evaluateSpatialFunction(name, args);
+    }
+
+    setError(QString("Unsupported function '%1'").arg(expr->name));
+    return QVariant();
+}
+
+QVariant ExpressionEvaluator::evaluateSpatialFunction(const QString& name, const QVector<QVariant>& args) {
+    auto requireArgs = [&](int count) {
+        if (args.size() != count) {
+            setError(QString("Wrong number of arguments to %1").arg(name));
+            return false;
+        }
+        return true;
+    };
+    auto geometryArg = [&](int index, Geometry& geometry) {
+        if (!Geometry::fromValue(args[index], geometry)) {
+            setError(QString("Invalid geometry argument to %1: '%2'").arg(name, args[index].toString()));
+            return false;
+        }
+        return true;
+    };
+
+    // 构造
+    if (name == "ST_POINT" || name == "ST_MAKEPOINT") {
+        if (!requireArgs(2)) {
+            return QVariant();
+        }
+        return QVariant(Geometry::point(args[0].toDouble(), args[1].toDouble()).toWkt());
+    }
+    if (name == "ST_MAKEENVELOPE") {
+        if (!requireArgs(4)) {
+            return QVariant();
+        }
+        const BoundingBox box(args[0].toDouble(), args[1].toDouble(), args[2].toDouble(), args[3].toDouble());
+        return QVariant(Geometry::envelope(box).toWkt());
+    }
+
+    // 单个几何对象
+    Geometry first;
+    if (name == "ST_GEOMFROMTEXT" || name == "ST_ASTEXT" || name == "ST_X" || name == "ST_Y" ||
+        name == "ST_ENVELOPE") {
+        if (!requireArgs(1) || !geometryArg(0, first)) {
+            return QVariant();
+        }
+        if (name == "ST_X" || name == "ST_Y") {
+            if (first.type() != Geometry::Type::POINT) {
+                setError(QString("%1 requires a POINT").arg(name));
+                return QVariant();
+            }
+            const GeoPoint& p = first.parts()[0][0];
+            return QVariant(name == "ST_X" ? p.x : p.y);
+        }
+        if (name == "ST_ENVELOPE") {
+            return QVariant(Geometry::envelope(first.bounds()).toWkt());
+        }
+        return QVariant(first.toWkt());  // 规范化的 WKT
+    }
+
+    // 两个几何对象
+    Geometry second;
+    if (!requireArgs(name == "ST_DWITHIN" ? 3 : 2) || !geometryArg(0, first) || !geometryArg(1, second)) {
+        return QVariant();
+    }
+    if (name == "MBRINTERSECTS") {
+        return QVariant(first.bounds().intersects(second.bounds()));
+    }
+    if (name == "ST_INTERSECTS") {
+        return QVariant(first.bounds().intersects(second.bounds()) && first.intersects(second));
+    }
+    if (name == "ST_DWITHIN") {
+        const double limit = args[2].toDouble();
+        return QVariant(first.bounds().distanceTo(second.bounds()) <= limit && first.distance(second) <= limit);
+    }
+    if (name == "ST_DISTANCE") {
+        return QVariant(first.distance(second));
+    }
+
+    setError(QString("Unsupported function '%1'").arg(name));
+    return QVariant();
+}
+
 QVariant ExpressionEvaluator::evaluateArithmetic(const QVariant& left,
                                                  const QVariant& right,
                                                  BinaryOp op) {
@@ -293,17 +614,8 @@ QVariant ExpressionEvaluator::evaluateComparison(const QVariant& left,
                                                  BinaryOp op) {
     using Op = ast::BinaryOp;
 
-    // NULL handling for equality
-    if (op == Op::EQ) {
-        if (left.isNull() && right.isNull()) return QVariant(true);
-        if (left.isNull() || right.isNull()) return QVariant(false);
-    }
-    if (op == Op::NE) {
-        if (left.isNull() && right.isNull()) return QVariant(false);
-        if (left.isNull() || right.isNull()) return QVariant(true);
-    }
-
-    // NULL propagation for other comparisons
+    // SQL 三值逻辑：任一侧为 NULL 时比较结果未知（NULL = NULL 也是 NULL），
+    // 与哈希连接、索引探测不匹配 NULL 键的行为一致；判断 NULL 用 IS [NOT] NULL
     if (left.isNull() || right.isNull()) {
         return QVariant();
     }
@@ -0,0 +1,364 @@
+#include "qindb/bitmap_index.h"
+#include "qindb/inverted_segment.h"
+#include "qindb/key_encoder.h"
+#include "qindb/logger.h"
+#include "qindb/page.h"
+#include <cstring>
+
+namespace qindb {
+
+namespace {
+
+// 元数据页（页头之后）：magic(4) version(4) keyType(1) reserved(3) entryCount(4) directoryPageId(4)
+constexpr uint32_t META_MAGIC = 0x504D4251;  // "QBMP"
+constexpr uint32_t META_VERSION = 1;
+constexpr size_t META_MAGIC_OFFSET = 0;
+constexpr size_t META_VERSION_OFFSET = 4;
+constexpr size_t META_KEY_TYPE_OFFSET = 8;
+constexpr size_t META_ENTRY_COUNT_OFFSET = 12;
+constexpr size_t META_DIRECTORY_PAGE_OFFSET = 16;
+
+constexpr uint16_t STREAM_DATA_OFFSET = static_cast<uint16_t>(sizeof(PageHeader));
+
+template <typename T>
+T readField(const char* data, size_t offset) {
+    T value;
+    memcpy(&value, data + offset, sizeof(T));
+    return value;
+}
+
+template <typename T>
+void writeField(char* data, size_t offset, T value) {
+    memcpy(data + offset, &value, sizeof(T));
+}
+
+/**
+ * @brief 把一段字节写成新的字节流
+ * @return 字节流首页，失败时返回 INVALID_PAGE_ID
+ */
+PageId writeStream(BufferPoolManager* bufferPool, const QByteArray& data) {
+    PageStreamWriter writer(bufferPool, PageType::BITMAP_INDEX_PAGE);
+    if (!writer.write(data)) {
+        return INVALID_PAGE_ID;
+    }
+    writer.finish();
+    return writer.firstPageId();
+}
+
+void freeStream(BufferPoolManager* bufferPool, PageId firstPageId) {
+    PageId pageId = firstPageId;
+    while (pageId != INVALID_PAGE_ID) {
+        Page* page = bufferPool->fetchPage(pageId);
+        if (!page) {
+            LOG_WARN(QString("Failed to fetch bitmap index page %1 while freeing").arg(pageId));
+            return;
+        }
+        PageId nextPageId = page->getNextPageId();
+        bufferPool->unpinPage(pageId, false);
+        bufferPool->deletePage(pageId);
+        pageId = nextPageId;
+    }
+}
+
+} // namespace
+
+BitmapIndex::BitmapIndex(BufferPoolManager* bufferPool, DataType keyType, PageId metaPageId)
+    : bufferPool_(bufferPool)
+    , keyType_(keyType)
+    , metaPageId_(metaPageId) {
+}
+
+bool BitmapIndex::create() {
+    Page* metaPage = bufferPool_->newPage(&metaPageId_);
+    if (!metaPage) {
+        metaPageId_ = INVALID_PAGE_ID;
+        LOG_ERROR("Failed to allocate bitmap index meta page");
+        return false;
+    }
+
+    memset(metaPage->getData(), 0, PAGE_SIZE);
+    metaPage->setPageId(metaPageId_);
+    metaPage->setPageType(PageType::BITMAP_INDEX_PAGE);
+    bufferPool_->unpinPage(metaPageId_, true);
+
+    entries_.clear();
+    directoryPageId_ = INVALID_PAGE_ID;
+    dirty_ = false;
+    return writeMeta();
+}
+
+bool BitmapIndex::load() {
+    entries_.clear();
+    directoryPageId_ = INVALID_PAGE_ID;
+    dirty_ = false;
+
+    if (metaPageId_ == INVALID_PAGE_ID) {
+        return false;
+    }
+
+    Page* metaPage = bufferPool_->fetchPage(metaPageId_);
+    if (!metaPage) {
+        LOG_ERROR(QString("Failed to fetch bitmap index meta page %1").arg(metaPageId_));
+        return false;
+    }
+
+    const char* meta = metaPage->getData() + sizeof(PageHeader);
+    const uint32_t magic = readField<uint32_t>(meta, META_MAGIC_OFFSET);
+    const uint32_t version = readField<uint32_t>(meta, META_VERSION_OFFSET);
+    const uint32_t entryCount = readField<uint32_t>(meta, META_ENTRY_COUNT_OFFSET);
+    directoryPageId_ = readField<PageId>(meta, META_DIRECTORY_PAGE_OFFSET);
+    bufferPool_->unpinPage(metaPageId_, false);
+
+    if (magic != META_MAGIC || version != META_VERSION) {
+        LOG_ERROR(QString("Page %1 is not a bitmap index meta page").arg(metaPageId_));
+        directoryPageId_ = INVALID_PAGE_ID;
+        return false;
+    }
+    if (entryCount == 0) {
+        return true;
+    }
+
+    PageStreamReader reader(bufferPool_, StreamPos(directoryPageId_, STREAM_DATA_OFFSET),
+                            PageType::BITMAP_INDEX_PAGE);
+    for (uint32_t i = 0; i < entryCount; ++i) {
+        uint64_t keySize = 0;
+        uint64_t cardinality = 0;
+        uint64_t firstPageId = 0;
+        uint64_t byteSize = 0;
+        if (!reader.readVarint(keySize) || keySize > PAGE_SIZE) {
+            LOG_ERROR(QString("Corrupted bitmap index directory at entry %1").arg(i));
+            entries_.clear();
+            return false;
+        }
+
+        QByteArray key(static_cast<int>(keySize), '\0');
+        if (!reader.read(key.data(), static_cast<int>(keySize)) || !reader.readVarint(cardinality) ||
+            !reader.readVarint(firstPageId) || !reader.readVarint(byteSize)) {
+            LOG_ERROR(QString("Corrupted bitmap index directory at entry %1").arg(i));
+            entries_.clear();
+            return false;
+        }
+
+        Entry entry;
+        entry.cardinality = cardinality;
+        entry.firstPageId = static_cast<PageId>(firstPageId);
+        entry.byteSize = static_cast<uint32_t>(byteSize);
+        entries_.insert(key, entry);
+    }
+    return true;
+}
+
+bool BitmapIndex::encodeKey(const QVariant& key, QByteArray& encoded) const {
+    encoded.clear();
+    return !key.isNull() && KeyEncoder::encode(key, keyType_, encoded);
+}
+
+bool BitmapIndex::ensureLoaded(Entry& entry) {
+    if (entry.loaded) {
+        return true;
+    }
+
+    QByteArray data(static_cast<int>(entry.byteSize), '\0');
+    PageStreamReader reader(bufferPool_, StreamPos(entry.firstPageId, STREAM_DATA_OFFSET),
+                            PageType::BITMAP_INDEX_PAGE);
+    if (!reader.read(data.data(), data.size()) || !entry.bitmap.deserialize(data)) {
+        LOG_ERROR(QString("Failed to read bitmap at page %1").arg(entry.firstPageId));
+        return false;
+    }
+    if (entry.bitmap.cardinality() != entry.cardinality) {
+        LOG_WARN(QString("Bitmap at page %1: directory says %2 rows, found %3")
+                     .arg(entry.firstPageId).arg(entry.cardinality).arg(entry.bitmap.cardinality()));
+        entry.cardinality = entry.bitmap.cardinality();
+    }
+    entry.loaded = true;
+    return true;
+}
+
+bool BitmapIndex::insert(const QVariant& key, RowId rowId) {
+    if (key.isNull()) {
+        return true;
+    }
+
+    QByteArray encoded;
+    if (!encodeKey(key, encoded)) {
+        LOG_WARN(QString("Cannot encode bitmap index key '%1'").arg(key.toString()));
+        return false;
+    }
+
+    auto it = entries_.find(encoded);
+    if (it == entries_.end()) {
+        Entry entry;
+        entry.loaded = true;
+        it = entries_.insert(encoded, entry);
+    } else if (!ensureLoaded(it.value())) {
+        return false;
+    }
+
+    if (it->bitmap.add(rowId)) {
+        it->cardinality++;
+        it->dirty = true;
+        dirty_ = true;
+    }
+    return true;
+}
+
+bool BitmapIndex::remove(const QVariant& key, RowId rowId) {
+    QByteArray encoded;
+    if (!encodeKey(key, encoded)) {
+        return true;
+    }
+
+    auto it = entries_.find(encoded);
+    if (it == entries_.end()) {
+        return true;
+    }
+    if (!ensureLoaded(it.value())) {
+        return false;
+    }
+
+    if (it->bitmap.remove(rowId)) {
+        it->cardinality--;
+        it->dirty = true;
+        dirty_ = true;
+    }
+    return true;
+}
+
+bool BitmapIndex::lookup(const QVariant& key, RoaringBitmap& result) {
+    result.clear();
+
+    QByteArray encoded;
+    if (!encodeKey(key, encoded)) {
+        return false;
+    }
+
+    auto it = entries_.find(encoded);
+    if (it == entries_.end()) {
+        return true;
+    }
+    if (!ensureLoaded(it.value())) {
+        return false;
+    }
+    result = it->bitmap;
+    return true;
+}
+
+bool BitmapIndex::lookupAny(const QVector<QVariant>& keys, RoaringBitmap& result) {
+    result.clear();
+    for (const QVariant& key : keys) {
+        RoaringBitmap bitmap;
+        if (!lookup(key, bitmap)) {
+            result.clear();
+            return false;
+        }
+        result.uniteWith(bitmap);
+    }
+    return true;
+}
+
+uint64_t BitmapIndex::totalCardinality() const {
+    uint64_t total = 0;
+    for (auto it = entries_.constBegin(); it != entries_.constEnd(); ++it) {
+        total += it->cardinality;
+    }
+    return total;
+}
+
+bool BitmapIndex::flush() {
+    if (!dirty_) {
+        return true;
+    }
+
+    // 先写新位图和新目录，元数据页切换过去之后才释放旧页
+    QVector<PageId> retired;
+    for (auto it = entries_.begin(); it != entries_.end();) {
+        Entry& entry = it.value();
+        if (!entry.dirty) {
+            ++it;
+            continue;
+        }
+
+        if (entry.firstPageId != INVALID_PAGE_ID) {
+            retired.append(entry.firstPageId);
+        }
+        if (entry.bitmap.isEmpty()) {
+            it = entries_.erase(it);
+            continue;
+        }
+
+        const QByteArray data = entry.bitmap.serialize();
+        entry.firstPageId = writeStream(bufferPool_, data);
+        if (entry.firstPageId == INVALID_PAGE_ID) {
+            LOG_ERROR("Failed to write bitmap index bitmap");
+            return false;
+        }
+        entry.byteSize = static_cast<uint32_t>(data.size());
+        entry.dirty = false;
+        ++it;
+    }
+
+    QByteArray directory;
+    for (auto it = entries_.constBegin(); it != entries_.constEnd(); ++it) {
+        Varint::append(directory, static_cast<uint64_t>(it.key().size()));
+        directory.append(it.key());
+        Varint::append(directory, it->cardinality);
+        Varint::append(directory, it->firstPageId);
+        Varint::append(directory, it->byteSize);
+    }
+
+    if (directoryPageId_ != INVALID_PAGE_ID) {
+        retired.append(directoryPageId_);
+    }
+    directoryPageId_ = INVALID_PAGE_ID;
+    if (!directory.isEmpty()) {
+        directoryPageId_ = writeStream(bufferPool_, directory);
+        if (directoryPageId_ == INVALID_PAGE_ID) {
+            LOG_ERROR("Failed to write bitmap index directory");
+            return false;
+        }
+    }
+
+    if (!writeMeta()) {
+        return false;
+    }
+
+    for (PageId pageId : retired) {
+        freeStream(bufferPool_, pageId);
+    }
+    dirty_ = false;
+    return true;
+}
+
+void BitmapIndex::destroy() {
+    for (auto it = entries_.constBegin(); it != entries_.constEnd(); ++it) {
+        freeStream(bufferPool_, it->firstPageId);
+    }
+    freeStream(bufferPool_, directoryPageId_);
+    if (metaPageId_ != INVALID_PAGE_ID) {
+        bufferPool_->deletePage(metaPageId_);
+    }
+
+    entries_.clear();
+    directoryPageId_ = INVALID_PAGE_ID;
+    metaPageId_ = INVALID_PAGE_ID;
+    dirty_ = false;
+}
+
+bool BitmapIndex::writeMeta() {
+    Page* metaPage = bufferPool_->fetchPage(metaPageId_);
+    if (!metaPage) {
+        LOG_ERROR(QString("Failed to fetch bitmap index meta page %1").arg(metaPageId_));
+        return false;
+    }
+
+    char* meta = metaPage->getData() + sizeof(PageHeader);
+    writeField<uint32_t>(meta, META_MAGIC_OFFSET, META_MAGIC);
+    writeField<uint32_t>(meta, META_VERSION_OFFSET, META_VERSION);
+    writeField<uint8_t>(meta, META_KEY_TYPE_OFFSET, static_cast<uint8_t>(keyType_));
+    writeField<uint32_t>(meta, META_ENTRY_COUNT_OFFSET, static_cast<uint32_t>(entries_.size()));
+    writeField<PageId>(meta, META_DIRECTORY_PAGE_OFFSET, directoryPageId_);
+    bufferPool_->unpinPage(metaPageId_, true);
+    return true;
+}
+
+} // namespace qindb
@@ -0,0 +1,469 @@
+#include "qindb/block_range_index.h"
+#include "qindb/hash_util.h"
+#include "qindb/key_encoder.h"
+#include "qindb/logger.h"
+#include "qindb/page.h"
+#include <cstring>
+
+namespace qindb {
+
+namespace {
+
+// 元数据页（页头之后）：magic(4) version(4) keyType(1) flags(1) reserved(2)
+//                     entryCount(4) firstDataPageId(4) lastDataPageId(4)
+constexpr uint32_t META_MAGIC = 0x4E524251;  // "QBRN"
+constexpr uint32_t META_VERSION = 1;
+constexpr size_t META_MAGIC_OFFSET = 0;
+constexpr size_t META_VERSION_OFFSET = 4;
+constexpr size_t META_KEY_TYPE_OFFSET = 8;
+constexpr size_t META_FLAGS_OFFSET = 9;
+constexpr size_t META_ENTRY_COUNT_OFFSET = 12;
+constexpr size_t META_FIRST_PAGE_OFFSET = 16;
+constexpr size_t META_LAST_PAGE_OFFSET = 20;
+constexpr uint8_t META_FLAG_BLOOM = 0x01;
+
+// 摘要（定长）：heapPageId(4) rowCount(4) nullCount(4) flags(1)
+//              minLen(1) min[32] maxLen(1) max[32] reserved(1) [bloom(64)]
+constexpr size_t ENTRY_HEAP_PAGE_OFFSET = 0;
+constexpr size_t ENTRY_ROW_COUNT_OFFSET = 4;
+constexpr size_t ENTRY_NULL_COUNT_OFFSET = 8;
+constexpr size_t ENTRY_FLAGS_OFFSET = 12;
+constexpr size_t ENTRY_MIN_LEN_OFFSET = 13;
+constexpr size_t ENTRY_MIN_OFFSET = 14;
+constexpr size_t ENTRY_MAX_LEN_OFFSET = ENTRY_MIN_OFFSET + BlockRangeIndex::MAX_BOUND_SIZE;
+constexpr size_t ENTRY_MAX_OFFSET = ENTRY_MAX_LEN_OFFSET + 1;
+constexpr size_t ENTRY_BASE_SIZE = 80;
+constexpr uint8_t ENTRY_FLAG_HAS_VALUES = 0x01;
+constexpr uint8_t ENTRY_FLAG_MAX_UNBOUNDED = 0x02;
+
+static_assert(ENTRY_MAX_OFFSET + BlockRangeIndex::MAX_BOUND_SIZE < ENTRY_BASE_SIZE,
+              "block range entry layout overflows its fixed size");
+
+constexpr int PAGE_PAYLOAD = PAGE_SIZE - static_cast<int>(sizeof(PageHeader));
+
+template <typename T>
+T readField(const char* data, size_t offset) {
+    T value;
+    memcpy(&value, data + offset, sizeof(T));
+    return value;
+}
+
+template <typename T>
+void writeField(char* data, size_t offset, T value) {
+    memcpy(data + offset, &value, sizeof(T));
+}
+
+/**
+ * @brief 截断为下界：前缀的字节序不大于原编码
+ */
+QByteArray lowerBound(const QByteArray& key) {
+    return key.size() > BlockRangeIndex::MAX_BOUND_SIZE ? key.left(BlockRangeIndex::MAX_BOUND_SIZE) : key;
+}
+
+/**
+ * @brief 截断为上界：去掉末尾的 0xFF 后把最后一个字节加一，大于所有以该前缀开头的编码
+ * @return false 前缀全是 0xFF，无法表示上界
+ */
+bool upperBound(const QByteArray& key, QByteArray& bound) {
+    if (key.size() <= BlockRangeIndex::MAX_BOUND_SIZE) {
+        bound = key;
+        return true;
+    }
+
+    bound = key.left(BlockRangeIndex::MAX_BOUND_SIZE);
+    while (!bound.isEmpty() && static_cast<uint8_t>(bound.back()) == 0xFF) {
+        bound.chop(1);
+    }
+    if (bound.isEmpty()) {
+        return false;
+    }
+    bound[bound.size() - 1] = static_cast<char>(static_cast<uint8_t>(bound.back()) + 1);
+    return true;
+}
+
+} // namespace
+
+BlockRangeIndex::BlockRangeIndex(BufferPoolManager* bufferPool, DataType keyType, PageId metaPageId)
+    : bufferPool_(bufferPool)
+    , keyType_(keyType)
+    , metaPageId_(metaPageId) {
+}
+
+int BlockRangeIndex::entrySize() const {
+    return static_cast<int>(ENTRY_BASE_SIZE) + (bloomEnabled_ ? BLOOM_BYTES : 0);
+}
+
+int BlockRangeIndex::entriesPerPage() const {
+    return PAGE_PAYLOAD / entrySize();
+}
+
+bool BlockRangeIndex::create(bool bloomEnabled) {
+    Page* metaPage = bufferPool_->newPage(&metaPageId_);
+    if (!metaPage) {
+        metaPageId_ = INVALID_PAGE_ID;
+        LOG_ERROR("Failed to allocate block range index meta page");
+        return false;
+    }
+
+    memset(metaPage->getData(), 0, PAGE_SIZE);
+    metaPage->setPageId(metaPageId_);
+    metaPage->setPageType(PageType::BLOCK_RANGE_PAGE);
+    bufferPool_->unpinPage(metaPageId_, true);
+
+    bloomEnabled_ = bloomEnabled;
+    summaries_.clear();
+    positions_.clear();
+    dataPages_.clear();
+    return writeMeta();
+}
+
+bool BlockRangeIndex::load() {
+    summaries_.clear();
+    positions_.clear();
+    dataPages_.clear();
+
+    if (metaPageId_ == INVALID_PAGE_ID) {
+        return false;
+    }
+
+    Page* metaPage = bufferPool_->fetchPage(metaPageId_);
+    if (!metaPage) {
+        LOG_ERROR(QString("Failed to fetch block range index meta page %1").arg(metaPageId_));
+        return false;
+    }
+
+    const char* meta = metaPage->getData() + sizeof(PageHeader);
+    const uint32_t magic = readField<uint32_t>(meta, META_MAGIC_OFFSET);
+    const uint32_t version = readField<uint32_t>(meta, META_VERSION_OFFSET);
+    const uint8_t flags = readField<uint8_t>(meta, META_FLAGS_OFFSET);
+    const uint32_t entryCount = readField<uint32_t>(meta, META_ENTRY_COUNT_OFFSET);
+    PageId dataPageId = readField<PageId>(meta, META_FIRST_PAGE_OFFSET);
+    bufferPool_->unpinPage(metaPageId_, false);
+
+    if (magic != META_MAGIC || version != META_VERSION) {
+        LOG_ERROR(QString("Page %1 is not a block range index meta page").arg(metaPageId_));
+        return false;
+    }
+    bloomEnabled_ = (flags & META_FLAG_BLOOM) != 0;
+
+    const int size = entrySize();
+    summaries_.reserve(static_cast<int>(entryCount));
+    while (dataPageId != INVALID_PAGE_ID) {
+        Page* page = bufferPool_->fetchPage(dataPageId);
+        if (!page) {
+            LOG_ERROR(QString("Failed to fetch block range index page %1").arg(dataPageId));
+            return false;
+        }
+
+        dataPages_.append(dataPageId);
+        const PageHeader* header = page->getHeader();
+        const char* data = page->getData() + sizeof(PageHeader);
+        for (int slot = 0; slot < header->slotCount; ++slot) {
+            PageSummary summary;
+            deserializeSummary(data + slot * size, summary);
+            positions_.insert(summary.heapPageId, summaries_.size());
+            summaries_.append(summary);
+        }
+
+        PageId nextPageId = header->nextPageId;
+        bufferPool_->unpinPage(dataPageId, false);
+        dataPageId = nextPageId;
+    }
+
+    if (static_cast<uint32_t>(summaries_.size()) != entryCount) {
+        LOG_WARN(QString("Block range index %1: meta says %2 summaries, found %3")
+                     .arg(metaPageId_).arg(entryCount).arg(summaries_.size()));
+    }
+    return true;
+}
+
+bool BlockRangeIndex::addPage(PageId heapPageId) {
+    if (positions_.contains(heapPageId)) {
+        return true;
+    }
+
+    PageSummary summary;
+    summary.heapPageId = heapPageId;
+    if (bloomEnabled_) {
+        summary.bloom = QByteArray(BLOOM_BYTES, '\0');
+    }
+    return appendSummary(summary);
+}
+
+bool BlockRangeIndex::addValue(PageId heapPageId, const QVariant& value) {
+    if (!addPage(heapPageId)) {
+        return false;
+    }
+
+    const int position = positions_.value(heapPageId);
+    PageSummary& summary = summaries_[position];
+    summary.rowCount++;
+
+    if (value.isNull()) {
+        summary.nullCount++;
+        return writeSummary(position);
+    }
+
+    QByteArray key;
+    if (!KeyEncoder::encode(value, keyType_, key)) {
+        // 编码失败的值无法比较，放开上下界，保证这一页不会被错误跳过
+        LOG_WARN(QString("Block range index: cannot encode value for page %1").arg(heapPageId));
+        summary.hasValues = true;
+        summary.minKey.clear();
+        summary.maxUnbounded = true;
+        if (bloomEnabled_) {
+            summary.bloom.fill('\xFF');
+        }
+        return writeSummary(position);
+    }
+
+    if (!summary.hasValues) {
+        summary.hasValues = true;
+        summary.minKey = lowerBound(key);
+        summary.maxUnbounded = !upperBound(key, summary.maxKey);
+    } else {
+        QByteArray lower = lowerBound(key);
+        if (KeyEncoder::compare(lower, summary.minKey) < 0) {
+            summary.minKey = lower;
+        }
+        if (!summary.maxUnbounded && KeyEncoder::compare(key, summary.maxKey) > 0) {
+            summary.maxUnbounded = !upperBound(key, summary.maxKey);
+        }
+    }
+
+    if (bloomEnabled_) {
+        bloomAdd(summary.bloom, key);
+    }
+    return writeSummary(position);
+}
+
+QVector<PageId> BlockRangeIndex::candidatePages(const Filter& filter) const {
+    const EncodedFilter encoded = encodeFilter(filter);
+
+    QVector<PageId> pages;
+    pages.reserve(summaries_.size());
+    for (const PageSummary& summary : summaries_) {
+        if (mayMatchEncoded(summary, encoded)) {
+            pages.append(summary.heapPageId);
+        }
+    }
+    return pages;
+}
+
+bool BlockRangeIndex::mayMatch(const PageSummary& summary, const Filter& filter) const {
+    return mayMatchEncoded(summary, encodeFilter(filter));
+}
+
+BlockRangeIndex::EncodedFilter BlockRangeIndex::encodeFilter(const Filter& filter) const {
+    EncodedFilter encoded;
+    encoded.isNull = filter.isNull;
+    encoded.isNotNull = filter.isNotNull;
+
+    if (filter.hasLower) {
+        encoded.hasLower = true;
+        encoded.lowerInclusive = filter.lowerInclusive;
+        encoded.valid = encoded.valid && KeyEncoder::encode(filter.lower, keyType_, encoded.lower);
+    }
+    if (filter.hasUpper) {
+        encoded.hasUpper = true;
+        encoded.upperInclusive = filter.upperInclusive;
+        encoded.valid = encoded.valid && KeyEncoder::encode(filter.upper, keyType_, encoded.upper);
+    }
+    if (filter.hasEquals) {
+        encoded.hasEquals = true;
+        for (const QVariant& value : filter.equals) {
+            QByteArray key;
+            if (!KeyEncoder::encode(value, keyType_, key)) {
+                encoded.valid = false;
+                break;
+            }
+            encoded.equals.append(key);
+        }
+    }
+    return encoded;
+}
+
+bool BlockRangeIndex::mayMatchEncoded(const PageSummary& summary, const EncodedFilter& filter) const {
+    if (!filter.valid) {
+        return true;
+    }
+
+    if (filter.isNull && summary.nullCount == 0) {
+        return false;
+    }
+    if (!filter.hasLower && !filter.hasUpper && !filter.hasEquals && !filter.isNotNull) {
+        return true;
+    }
+
+    // 其余条件都要求非 NULL 值
+    if (!summary.hasValues) {
+        return false;
+    }
+
+    // 页内最大值 < 下界，或最小值 > 上界：整页都不满足
+    if (filter.hasLower && !summary.maxUnbounded) {
+        const int cmp = KeyEncoder::compare(summary.maxKey, filter.lower);
+        if (cmp < 0 || (cmp == 0 && !filter.lowerInclusive)) {
+            return false;
+        }
+    }
+    if (filter.hasUpper) {
+        const int cmp = KeyEncoder::compare(summary.minKey, filter.upper);
+        if (cmp > 0 || (cmp == 0 && !filter.upperInclusive)) {
+            return false;
+        }
+    }
+
+    if (filter.hasEquals) {
+        for (const QByteArray& key : filter.equals) {
+            if (KeyEncoder::compare(summary.minKey, key) > 0) {
+                continue;
+            }
+            if (!summary.maxUnbounded && KeyEncoder::compare(key, summary.maxKey) > 0) {
+                continue;
+            }
+            if (!summary.bloom.isEmpty() && !bloomMayContain(summary.bloom, key)) {
+                continue;
+            }
+            return true;
+        }
+        return false;
+    }
+    return true;
+}
+
+void BlockRangeIndex::bloomAdd(QByteArray& bloom, const QByteArray& key) {
+    const uint64_t hash = HashUtil::hashBytes(key);
+    const uint32_t h1 = static_cast<uint32_t>(hash);
+    const uint32_t h2 = static_cast<uint32_t>(hash >> 32) | 1u;
+    for (int i = 0; i < BLOOM_HASHES; ++i) {
+        const uint32_t bit = (h1 + static_cast<uint32_t>(i) * h2) % (BLOOM_BYTES * 8);
+        bloom[bit / 8] = static_cast<char>(static_cast<uint8_t>(bloom[bit / 8]) | (1u << (bit % 8)));
+    }
+}
+
+bool BlockRangeIndex::bloomMayContain(const QByteArray& bloom, const QByteArray& key) {
+    const uint64_t hash = HashUtil::hashBytes(key);
+    const uint32_t h1 = static_cast<uint32_t>(hash);
+    const uint32_t h2 = static_cast<uint32_t>(hash >> 32) | 1u;
+    for (int i = 0; i < BLOOM_HASHES; ++i) {
+        const uint32_t bit = (h1 + static_cast<uint32_t>(i) * h2) % (BLOOM_BYTES * 8);
+        if ((static_cast<uint8_t>(bloom[bit / 8]) & (1u << (bit % 8))) == 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool BlockRangeIndex::appendSummary(const PageSummary& summary) {
+    const int position = summaries_.size();
+    const int perPage = entriesPerPage();
+
+    // 最后一页已满（或还没有摘要页）：分配新页挂到链表末尾
+    if (position % perPage == 0) {
+        PageId newPageId;
+        Page* newPage = bufferPool_->newPage(&newPageId);
+        if (!newPage) {
+            LOG_ERROR("Failed to allocate block range index page");
+            return false;
+        }
+        memset(newPage->getData(), 0, PAGE_SIZE);
+        newPage->setPageId(newPageId);
+        newPage->setPageType(PageType::BLOCK_RANGE_PAGE);
+        newPage->setPrevPageId(dataPages_.isEmpty() ? INVALID_PAGE_ID : dataPages_.last());
+        bufferPool_->unpinPage(newPageId, true);
+
+        if (!dataPages_.isEmpty()) {
+            Page* lastPage = bufferPool_->fetchPage(dataPages_.last());
+            if (!lastPage) {
+                LOG_ERROR(QString("Failed to fetch block range index page %1").arg(dataPages_.last()));
+                return false;
+            }
+            lastPage->setNextPageId(newPageId);
+            bufferPool_->unpinPage(dataPages_.last(), true);
+        }
+        dataPages_.append(newPageId);
+    }
+
+    positions_.insert(summary.heapPageId, position);
+    summaries_.append(summary);
+    return writeSummary(position) && writeMeta();
+}
+
+bool BlockRangeIndex::writeSummary(int position) {
+    const int perPage = entriesPerPage();
+    const PageId pageId = dataPages_.value(position / perPage, INVALID_PAGE_ID);
+    Page* page = pageId == INVALID_PAGE_ID ? nullptr : bufferPool_->fetchPage(pageId);
+    if (!page) {
+        LOG_ERROR(QString("Failed to fetch block range index page for summary %1").arg(position));
+        return false;
+    }
+
+    const int slot = position % perPage;
+    serializeSummary(summaries_[position], page->getData() + sizeof(PageHeader) + slot * entrySize());
+    PageHeader* header = page->getHeader();
+    if (header->slotCount <= slot) {
+        header->slotCount = static_cast<uint16_t>(slot + 1);
+    }
+    bufferPool_->unpinPage(pageId, true);
+    return true;
+}
+
+bool BlockRangeIndex::writeMeta() {
+    Page* metaPage = bufferPool_->fetchPage(metaPageId_);
+    if (!metaPage) {
+        LOG_ERROR(QString("Failed to fetch block range index meta page %1").arg(metaPageId_));
+        return false;
+    }
+
+    char* meta = metaPage->getData() + sizeof(PageHeader);
+    writeField<uint32_t>(meta, META_MAGIC_OFFSET, META_MAGIC);
+    writeField<uint32_t>(meta, META_VERSION_OFFSET, META_VERSION);
+    writeField<uint8_t>(meta, META_KEY_TYPE_OFFSET, static_cast<uint8_t>(keyType_));
+    writeField<uint8_t>(meta, META_FLAGS_OFFSET, bloomEnabled_ ? META_FLAG_BLOOM : 0);
+    writeField<uint32_t>(meta, META_ENTRY_COUNT_OFFSET, static_cast<uint32_t>(summaries_.size()));
+    writeField<PageId>(meta, META_FIRST_PAGE_OFFSET, dataPages_.isEmpty() ? INVALID_PAGE_ID : dataPages_.first());
+    writeField<PageId>(meta, META_LAST_PAGE_OFFSET, dataPages_.isEmpty() ? INVALID_PAGE_ID : dataPages_.last());
+    bufferPool_->unpinPage(metaPageId_, true);
+    return true;
+}
+
+void BlockRangeIndex::serializeSummary(const PageSummary& summary, char* out) const {
+    memset(out, 0, entrySize());
+    writeField<PageId>(out, ENTRY_HEAP_PAGE_OFFSET, summary.heapPageId);
+    writeField<uint32_t>(out, ENTRY_ROW_COUNT_OFFSET, summary.rowCount);
+    writeField<uint32_t>(out, ENTRY_NULL_COUNT_OFFSET, summary.nullCount);
+
+    uint8_t flags = 0;
+    if (summary.hasValues) flags |= ENTRY_FLAG_HAS_VALUES;
+    if (summary.maxUnbounded) flags |= ENTRY_FLAG_MAX_UNBOUNDED;
+    writeField<uint8_t>(out, ENTRY_FLAGS_OFFSET, flags);
+
+    writeField<uint8_t>(out, ENTRY_MIN_LEN_OFFSET, static_cast<uint8_t>(summary.minKey.size()));
+    memcpy(out + ENTRY_MIN_OFFSET, summary.minKey.constData(), summary.minKey.size());
+    writeField<uint8_t>(out, ENTRY_MAX_LEN_OFFSET, static_cast<uint8_t>(summary.maxKey.size()));
+    memcpy(out + ENTRY_MAX_OFFSET, summary.maxKey.constData(), summary.maxKey.size());
+
+    if (bloomEnabled_ && summary.bloom.size() == BLOOM_BYTES) {
+        memcpy(out + ENTRY_BASE_SIZE, summary.bloom.constData(), BLOOM_BYTES);
+    }
+}
+
+void BlockRangeIndex::deserializeSummary(const char* in, PageSummary& summary) const {
+    summary.heapPageId = readField<PageId>(in, ENTRY_HEAP_PAGE_OFFSET);
+    summary.rowCount = readField<uint32_t>(in, ENTRY_ROW_COUNT_OFFSET);
+    summary.nullCount = readField<uint32_t>(in, ENTRY_NULL_COUNT_OFFSET);
+
+    const uint8_t flags = readField<uint8_t>(in, ENTRY_FLAGS_OFFSET);
+    summary.hasValues = (flags & ENTRY_FLAG_HAS_VALUES) != 0;
+    summary.maxUnbounded = (flags & ENTRY_FLAG_MAX_UNBOUNDED) != 0;
+
+    const int minLen = qMin<int>(readField<uint8_t>(in, ENTRY_MIN_LEN_OFFSET), MAX_BOUND_SIZE);
+    summary.minKey = QByteArray(in + ENTRY_MIN_OFFSET, minLen);
+    const int maxLen = qMin<int>(readField<uint8_t>(in, ENTRY_MAX_LEN_OFFSET), MAX_BOUND_SIZE);
+    summary.maxKey = QByteArray(in + ENTRY_MAX_OFFSET, maxLen);
+
+    summary.bloom = bloomEnabled_ ? QByteArray(in + ENTRY_BASE_SIZE, BLOOM_BYTES) : QByteArray();
+}
+
+} // namespace qindb
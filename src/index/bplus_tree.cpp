@@ -1,10 +1,37 @@
 #include "qindb/bplus_tree.h"  // 包含B+树头文件
+#include "qindb/int_key_search.h"  // 节点内整数键查找（AVX2 / 无分支二分）
 #include "qindb/logger.h"      // 包含日志记录头文件
 #include <algorithm>          // 包含STL算法库
+#include <cstddef>            // offsetof
 #include <cstring>            // 包含字符串操作库
 
 namespace qindb {  // 定义命名空间qindb
 
+namespace {
+
+// 叶子页：头部之后是连续的 BPlusTreeEntry 数组
+const char* leafKeyBase(Page* page) {
+    return page->getData() + sizeof(BPlusTreePageHeader) + offsetof(BPlusTreeEntry, key);
+}
+
+// 内部页：头部之后是 firstChild，再是连续的 BPlusTreeInternalEntry 数组
+const char* internalEntryBase(Page* page) {
+    return page->getData() + sizeof(BPlusTreePageHeader) + sizeof(PageId);
+}
+
+PageId internalChildAt(Page* page, int index) {
+    PageId child;
+    if (index == 0) {
+        std::memcpy(&child, page->getData() + sizeof(BPlusTreePageHeader), sizeof(PageId));
+    } else {
+        std::memcpy(&child, internalEntryBase(page) + (index - 1) * sizeof(BPlusTreeInternalEntry)
+                                + offsetof(BPlusTreeInternalEntry, childPageId), sizeof(PageId));
+    }
+    return child;
+}
+
+} // namespace
+
 BPlusTree::BPlusTree(BufferPoolManager* bufferPoolManager, PageId rootPageId, int order)
     : bufferPoolManager_(bufferPoolManager)
     , rootPageId_(rootPageId)
@@ -119,20 +146,16 @@ bool BPlusTree::remove(int64_t key) {
         return false;
     }
 
-    QVector<BPlusTreeEntry> entries;
-    readLeafEntries(leafPage, entries);
-
     // Find and remove the key
-    bool found = false;
-    for (int i = 0; i < entries.size(); ++i) {
-        if (entries[i].key == key) {
-            entries.removeAt(i);
-            found = true;
-            break;
-        }
-    }
+    int pos = findKeyPositionInLeaf(leafPage, key);
+    BPlusTreePageHeader* header = reinterpret_cast<BPlusTreePageHeader*>(leafPage->getData());
+    bool found = pos < header->numKeys &&
+                 IntKeySearch::keyAt(leafKeyBase(leafPage), sizeof(BPlusTreeEntry), pos) == key;
 
     if (found) {
+        QVector<BPlusTreeEntry> entries;
+        readLeafEntries(leafPage, entries);
+        entries.removeAt(pos);
         writeLeafEntries(leafPage, entries);
         bufferPoolManager_->unpinPage(leafPageId, true);
         LOG_DEBUG(QString("Removed key=%1").arg(key));
@@ -158,15 +181,18 @@ bool BPlusTree::search(int64_t key, RowId& value) {
         return false;
     }
 
-    QVector<BPlusTreeEntry> entries;
-    readLeafEntries(leafPage, entries);
+    // 直接在页内查找，不复制条目
+    int pos = findKeyPositionInLeaf(leafPage, key);
+    BPlusTreePageHeader* header = reinterpret_cast<BPlusTreePageHeader*>(leafPage->getData());
 
     bool found = false;
-    for (const auto& entry : entries) {
+    if (pos < header->numKeys) {
+        BPlusTreeEntry entry;
+        const char* entryData = leafPage->getData() + sizeof(BPlusTreePageHeader) + pos * sizeof(BPlusTreeEntry);
+        std::memcpy(&entry, entryData, sizeof(BPlusTreeEntry));
         if (entry.key == key) {
             value = entry.value;
             found = true;
-            break;
         }
     }
 
@@ -186,6 +212,7 @@ bool BPlusTree::rangeSearch(int64_t minKey, int64_t maxKey, QVector<BPlusTreeEnt
     }
 
     // Traverse leaf pages via linked list
+    bool firstPage = true;
     while (currentPageId != INVALID_PAGE_ID) {
         Page* page = bufferPoolManager_->fetchPage(currentPageId);
         if (!page) {
@@ -195,7 +222,12 @@ bool BPlusTree::rangeSearch(int64_t minKey, int64_t maxKey, QVector<BPlusTreeEnt
         QVector<BPlusTreeEntry> entries;
         readLeafEntries(page, entries);
 
-        for (const auto& entry : entries) {
+        // 第一个叶子从 minKey 的位置开始，跳过更小的键
+        int start = firstPage ? findKeyPositionInLeaf(page, minKey) : 0;
+        firstPage = false;
+
+        for (int i = start; i < entries.size(); ++i) {
+            const BPlusTreeEntry& entry = entries[i];
             if (entry.key >= minKey && entry.key <= maxKey) {
                 results.append(entry);
             }
@@ -260,19 +292,8 @@ PageId BPlusTree::findLeafPage(int64_t key) {
             return currentPageId;
         }
 
-        // Internal node - find child to descend to
-        QVector<BPlusTreeInternalEntry> entries;
-        PageId firstChild;
-        readInternalEntries(page, entries, firstChild);
-
-        PageId nextPageId = firstChild;
-        for (const auto& entry : entries) {
-            if (key >= entry.key) {
-                nextPageId = entry.childPageId;
-            } else {
-                break;
-            }
-        }
+        // Internal node - find child to descend to（第一个 > key 的分隔键左侧的子节点）
+        PageId nextPageId = internalChildAt(page, findKeyPositionInInternal(page, key));
 
         bufferPoolManager_->unpinPage(currentPageId, false);
         currentPageId = nextPageId;
@@ -292,19 +313,13 @@ bool BPlusTree::insertIntoLeaf(PageId leafPageId, int64_t key, RowId value) {
 
     // Insert in sorted order
     BPlusTreeEntry newEntry(key, value);
-    int insertPos = 0;
-    for (int i = 0; i < entries.size(); ++i) {
-        if (entries[i].key < key) {
-            insertPos = i + 1;
-        } else if (entries[i].key == key) {
-            // Update existing key
-            entries[i].value = value;
-            writeLeafEntries(page, entries);
-            bufferPoolManager_->unpinPage(leafPageId, true);
-            return true;
-        } else {
-            break;
-        }
+    int insertPos = findKeyPositionInLeaf(page, key);
+    if (insertPos < entries.size() && entries[insertPos].key == key) {
+        // Update existing key
+        entries[insertPos].value = value;
+        writeLeafEntries(page, entries);
+        bufferPoolManager_->unpinPage(leafPageId, true);
+        return true;
     }
 
     entries.insert(insertPos, newEntry);
@@ -409,10 +424,7 @@ bool BPlusTree::insertIntoParent(PageId parentPageId, int64_t key, PageId leftPa
         readInternalEntries(parentPage, entries, firstChild);
 
         BPlusTreeInternalEntry newEntry(key, rightPageId);
-        entries.append(newEntry);
-        std::sort(entries.begin(), entries.end(), [](const auto& a, const auto& b) {
-            return a.key < b.key;
-        });
+        entries.insert(findKeyPositionInInternal(parentPage, key), newEntry);
 
         writeInternalEntries(parentPage, entries, firstChild);
         bufferPoolManager_->unpinPage(parentPageId, true);
@@ -488,28 +500,14 @@ PageId BPlusTree::createNewRoot(PageId leftPageId, int64_t key, PageId rightPage
 }
 
 int BPlusTree::findKeyPositionInLeaf(Page* page, int64_t key) {
-    QVector<BPlusTreeEntry> entries;
-    readLeafEntries(page, entries);
-
-    for (int i = 0; i < entries.size(); ++i) {
-        if (entries[i].key >= key) {
-            return i;
-        }
-    }
-    return entries.size();
+    BPlusTreePageHeader* header = reinterpret_cast<BPlusTreePageHeader*>(page->getData());
+    return IntKeySearch::lowerBound(leafKeyBase(page), header->numKeys, sizeof(BPlusTreeEntry), key);
 }
 
 int BPlusTree::findKeyPositionInInternal(Page* page, int64_t key) {
-    QVector<BPlusTreeInternalEntry> entries;
-    PageId firstChild;
-    readInternalEntries(page, entries, firstChild);
-
-    for (int i = 0; i < entries.size(); ++i) {
-        if (entries[i].key > key) {
-            return i;
-        }
-    }
-    return entries.size();
+    BPlusTreePageHeader* header = reinterpret_cast<BPlusTreePageHeader*>(page->getData());
+    return IntKeySearch::upperBound(internalEntryBase(page) + offsetof(BPlusTreeInternalEntry, key),
+                                    header->numKeys, sizeof(BPlusTreeInternalEntry), key);
 }
 
 void BPlusTree::readLeafEntries(Page* page, QVector<BPlusTreeEntry>& entries) {
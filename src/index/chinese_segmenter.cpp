@@ -0,0 +1,591 @@
+#include "qindb/chinese_segmenter.h"
+#include "qindb/logger.h"
+#include <QFile>
+#include <QTextStream>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace qindb {
+
+namespace {
+
+/**
+ * 内置词典：每行 "词 词频"。收录常用虚词、单字和一般领域与计算机领域的常用词，
+ * 词频是相对量级，只用于在候选切分之间做选择。需要更完整的词典时用 loadDictionary 加载。
+ */
+const char BUILTIN_DICTIONARY[] = R"DICT(
+的 300000
+了 100000
+是 150000
+在 120000
+和 80000
+有 80000
+我 90000
+他 60000
+她 20000
+你 50000
+它 10000
+这 60000
+那 20000
+也 40000
+就 40000
+都 30000
+不 80000
+人 50000
+大 40000
+中 40000
+上 40000
+下 20000
+个 30000
+为 30000
+对 30000
+说 30000
+要 30000
+会 25000
+能 25000
+到 30000
+去 15000
+来 25000
+年 40000
+月 20000
+日 20000
+天 15000
+好 20000
+多 20000
+少 8000
+小 20000
+新 15000
+用 20000
+与 25000
+及 15000
+等 20000
+被 15000
+把 12000
+从 15000
+向 8000
+而 15000
+但 15000
+又 10000
+很 15000
+最 15000
+更 10000
+将 15000
+并 12000
+其 15000
+之 20000
+以 20000
+于 20000
+由 10000
+可 15000
+所 15000
+让 8000
+给 8000
+着 15000
+过 12000
+还 15000
+再 8000
+只 10000
+已 8000
+没 8000
+一 60000
+二 8000
+三 8000
+十 8000
+们 10000
+后 15000
+前 12000
+里 10000
+外 8000
+内 6000
+时 20000
+地 20000
+得 15000
+出 15000
+自 8000
+生 10000
+学 10000
+江 2000
+市 8000
+长 8000
+命 2000
+起 10000
+高 10000
+性 8000
+化 8000
+者 8000
+家 15000
+国 20000
+看 10000
+想 10000
+做 10000
+写 4000
+读 3000
+找 4000
+查 2000
+表 5000
+库 1500
+词 2000
+字 3000
+页 3000
+行 10000
+列 2000
+键 800
+值 2000
+我们 30000
+你们 6000
+他们 20000
+她们 2000
+它们 3000
+自己 15000
+大家 8000
+什么 15000
+怎么 8000
+怎样 3000
+为什么 4000
+因为 15000
+所以 12000
+但是 15000
+如果 12000
+虽然 5000
+然后 5000
+或者 6000
+而且 6000
+以及 8000
+并且 4000
+可以 30000
+可能 12000
+应该 8000
+必须 5000
+已经 20000
+没有 25000
+一个 40000
+一些 8000
+一样 4000
+一起 5000
+一直 5000
+一般 6000
+这个 15000
+那个 5000
+这些 8000
+那些 3000
+这样 10000
+那样 2000
+这里 5000
+那里 3000
+其中 8000
+之间 8000
+之后 6000
+之前 4000
+之一 5000
+现在 15000
+以后 5000
+以前 4000
+今天 8000
+明天 3000
+昨天 3000
+今年 5000
+时间 15000
+时候 10000
+开始 12000
+结束 4000
+成为 8000
+进行 15000
+通过 12000
+使用 12000
+需要 12000
+认为 8000
+知道 10000
+觉得 5000
+喜欢 5000
+看到 5000
+发现 6000
+表示 8000
+出现 6000
+包括 8000
+提供 8000
+提高 8000
+增加 8000
+减少 4000
+影响 8000
+重要 10000
+主要 12000
+不同 10000
+非常 10000
+特别 6000
+问题 20000
+方法 8000
+方式 6000
+方面 8000
+情况 10000
+过程 6000
+结果 10000
+原因 5000
+目的 4000
+作用 5000
+关系 10000
+能力 6000
+水平 6000
+机会 4000
+目标 5000
+条件 5000
+要求 10000
+标准 6000
+规则 2000
+原则 3000
+内容 6000
+部分 8000
+全部 4000
+整个 4000
+世界 12000
+中国 40000
+中华 3000
+人民 15000
+共和国 1500
+中华人民共和国 2000
+国家 20000
+政府 10000
+社会 15000
+经济 15000
+发展 25000
+企业 15000
+公司 20000
+市场 12000
+产品 10000
+服务 15000
+管理 15000
+工作 20000
+生活 12000
+家庭 4000
+朋友 6000
+孩子 6000
+学生 9000
+老师 5000
+学校 6000
+大学 8000
+学习 12000
+研究 12000
+研究生 1500
+生命 6000
+起源 800
+科学 8000
+科学家 1000
+科技 5000
+技术 15000
+历史 8000
+文化 10000
+教育 8000
+语言 5000
+文字 3000
+汉字 800
+中文 3000
+英文 1500
+词语 300
+词典 300
+字典 300
+北京 12000
+上海 8000
+广州 3000
+深圳 3000
+南京 3000
+南京市 500
+北京市 800
+上海市 600
+市长 1000
+长江 800
+大桥 500
+长江大桥 50
+城市 6000
+地区 6000
+环境 8000
+质量 6000
+价格 5000
+银行 4000
+医院 3000
+医生 3000
+健康 4000
+天气 1500
+交通 3000
+旅游 3000
+新闻 5000
+报告 5000
+会议 6000
+项目 8000
+计划 6000
+方案 3000
+组织 6000
+部门 5000
+领导 6000
+工程 5000
+工程师 800
+信息 15000
+互联网 3000
+网络 8000
+网站 3000
+网页 1000
+手机 5000
+电脑 3000
+电话 3000
+电子 4000
+邮件 1500
+电子邮件 300
+视频 2000
+图片 2000
+音乐 3000
+电影 4000
+游戏 3000
+人工智能 800
+机器 3000
+机器学习 200
+深度学习 100
+神经网络 100
+算法 1200
+模型 3000
+统计 3000
+分析 10000
+计算 6000
+计算机 4000
+软件 5000
+硬件 1200
+程序 5000
+程序员 400
+代码 1000
+开发 12000
+开发者 500
+测试 3000
+版本 2000
+功能 5000
+支持 12000
+实现 10000
+设计 8000
+架构 600
+系统 20000
+平台 5000
+服务器 2000
+客户端 600
+用户 8000
+密码 1200
+账号 800
+权限 900
+安全 10000
+加密 500
+认证 800
+数据 12000
+数据库 3000
+数据表 100
+数据结构 200
+索引 1500
+查询 2500
+搜索 5000
+搜索引擎 500
+检索 600
+全文 200
+全文检索 60
+全文搜索 60
+分词 150
+排序 600
+过滤 500
+聚合 300
+连接 3000
+优化 3000
+优化器 300
+执行 4000
+执行器 100
+计划器 50
+存储 2500
+引擎 1500
+存储引擎 200
+事务 800
+日志 1200
+缓存 800
+缓冲 500
+缓冲池 50
+内存 1200
+磁盘 500
+文件 6000
+文件系统 300
+页面 1500
+记录 5000
+表格 600
+字段 400
+主键 50
+外键 30
+视图 200
+函数 800
+变量 600
+参数 1500
+类型 3000
+结构 5000
+哈希 100
+哈希表 30
+树 3000
+节点 600
+并发 300
+线程 500
+进程 900
+格式 2000
+压缩 700
+编码 800
+解码 200
+协议 1500
+接口 1200
+配置 1200
+错误 2000
+异常 800
+性能 3000
+效率 2500
+速度 3000
+吞吐量 100
+延迟 500
+备份 400
+恢复 1500
+复制 800
+同步 800
+异步 200
+分布式 200
+集群 200
+云计算 200
+开源 300
+)DICT";
+
+} // namespace
+
+ChineseSegmenter::ChineseSegmenter()
+    : unknownLogProbability_(0.0f)
+{
+    loadBuiltinDictionary();
+    rebuild();
+}
+
+const ChineseSegmenter& ChineseSegmenter::builtin() {
+    static const ChineseSegmenter segmenter;
+    return segmenter;
+}
+
+void ChineseSegmenter::loadBuiltinDictionary() {
+    const QStringList lines = QString::fromUtf8(BUILTIN_DICTIONARY).split('\n', Qt::SkipEmptyParts);
+    for (const QString& line : lines) {
+        const QStringList fields = line.split(' ', Qt::SkipEmptyParts);
+        if (fields.size() >= 2) {
+            addWord(fields[0], fields[1].toUInt());
+        }
+    }
+}
+
+void ChineseSegmenter::addWord(const QString& word, uint32_t frequency) {
+    if (word.isEmpty() || word.size() > MAX_WORD_LENGTH || frequency == 0) {
+        return;
+    }
+
+    auto it = wordIndex_.constFind(word);
+    if (it != wordIndex_.constEnd()) {
+        frequencies_[it.value()] += frequency;
+        return;
+    }
+    wordIndex_.insert(word, static_cast<int>(words_.size()));
+    words_.append(word);
+    frequencies_.append(frequency);
+}
+
+bool ChineseSegmenter::loadDictionary(const QString& path) {
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        LOG_ERROR(QString("Failed to open segmenter dictionary: %1").arg(path));
+        return false;
+    }
+
+    QTextStream in(&file);
+    int loaded = 0;
+    while (!in.atEnd()) {
+        const QStringList fields = in.readLine().split(' ', Qt::SkipEmptyParts);
+        if (fields.size() < 2) {
+            continue;
+        }
+        bool ok = false;
+        uint32_t frequency = fields[1].toUInt(&ok);
+        if (ok) {
+            addWord(fields[0], frequency);
+            loaded++;
+        }
+    }
+
+    LOG_INFO(QString("Loaded %1 words from segmenter dictionary %2").arg(loaded).arg(path));
+    return rebuild();
+}
+
+bool ChineseSegmenter::rebuild() {
+    // 先放词、再放前缀：完美哈希按首次出现去重，下标小于词数的键都是词
+    QStringList keys = words_;
+    for (const QString& word : words_) {
+        for (qsizetype length = 1; length < word.size(); ++length) {
+            keys.append(word.left(length));
+        }
+    }
+    if (!lookup_.build(keys)) {
+        return false;
+    }
+
+    uint64_t total = 0;
+    for (uint64_t frequency : frequencies_) {
+        total += frequency;
+    }
+    const double logTotal = std::log(static_cast<double>(std::max<uint64_t>(total, 1)));
+
+    logProbabilities_.fill(-std::numeric_limits<float>::infinity(), lookup_.size());
+    for (int i = 0; i < words_.size(); ++i) {
+        logProbabilities_[i] = static_cast<float>(std::log(static_cast<double>(frequencies_[i])) - logTotal);
+    }
+    unknownLogProbability_ = static_cast<float>(-logTotal);
+    return true;
+}
+
+bool ChineseSegmenter::containsWord(QStringView word) const {
+    int index = lookup_.find(word);
+    return index >= 0 && index < words_.size();
+}
+
+int ChineseSegmenter::segment(const QChar* text, int length, uint8_t* wordLengths) const {
+    double best[MAX_RUN_LENGTH + 1];
+    uint8_t choice[MAX_RUN_LENGTH];
+    const int wordCount = static_cast<int>(words_.size());
+
+    int count = 0;
+    for (int runStart = 0; runStart < length; runStart += MAX_RUN_LENGTH) {
+        const QChar* run = text + runStart;
+        const int n = std::min(MAX_RUN_LENGTH, length - runStart);
+
+        // 从右向左：best[i] 是 run[i..n) 的最大对数概率
+        best[n] = 0.0;
+        for (int i = n - 1; i >= 0; --i) {
+            int index = lookup_.find(run + i, 1);
+            double single = (index >= 0 && index < wordCount) ? logProbabilities_[index] : unknownLogProbability_;
+            best[i] = single + best[i + 1];
+            choice[i] = 1;
+            if (index < 0) {
+                continue;  // 没有以这个字开头的词
+            }
+
+            const int maxLength = std::min(MAX_WORD_LENGTH, n - i);
+            for (int len = 2; len <= maxLength; ++len) {
+                index = lookup_.find(run + i, len);
+                if (index < 0) {
+                    break;  // 不是任何词的前缀
+                }
+                if (index < wordCount) {
+                    double candidate = logProbabilities_[index] + best[i + len];
+                    if (candidate > best[i]) {
+                        best[i] = candidate;
+                        choice[i] = static_cast<uint8_t>(len);
+                    }
+                }
+            }
+        }
+
+        for (int i = 0; i < n; i += choice[i]) {
+            wordLengths[count++] = choice[i];
+        }
+    }
+    return count;
+}
+
+} // namespace qindb
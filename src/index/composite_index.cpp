@@ -1,15 +1,19 @@
 #include "qindb/composite_index.h"  // 包含复合索引头文件
+#include "qindb/key_encoder.h"     // 包含保序键编码器
+#include "qindb/bplus_tree.h"     // 包含B+树页格式标志
 #include "qindb/logger.h"          // 包含日志记录头文件
 
 namespace qindb {  // 定义qindb命名空间
 
 CompositeIndex::CompositeIndex(BufferPoolManager* bufferPoolManager,
                               const QVector<DataType>& columnTypes,
-                              PageId rootPageId)
+                              PageId rootPageId,
+                              const QVector<DataType>& includeTypes)
     : bufferPoolManager_(bufferPoolManager)
     , columnTypes_(columnTypes)
+    , includeTypes_(includeTypes)
 {
-    // 使用BINARY类型的B+树来存储序列化的CompositeKey
+    // 键由 encodeEntry 编码后直接写入B+树；keyType 只在旧格式的树中用于包装序列化后的键
     tree_ = std::make_unique<GenericBPlusTree>(
         bufferPoolManager,
         DataType::BINARY,
@@ -17,33 +21,56 @@ CompositeIndex::CompositeIndex(BufferPoolManager* bufferPoolManager,
         50  // 复合键可能较大，减少每页的键数
     );
 
-    LOG_DEBUG(QString("CompositeIndex created with %1 columns").arg(columnTypes_.size()));
+    // 新建的（空）树值槽位存放创建事务ID；已有条目的旧树保持原格式
+    if (tree_->usesNormalizedKeys()) {
+        tree_->setValueFormatFlags(BPTREE_FLAG_TXN_VALUES);
+    }
+
+    LOG_DEBUG(QString("CompositeIndex created with %1 key columns, %2 included columns")
+                 .arg(columnTypes_.size()).arg(includeTypes_.size()));
 }
 
 CompositeIndex::~CompositeIndex() {
 }
 
-bool CompositeIndex::insert(const CompositeKey& key, RowId rowId) {
+bool CompositeIndex::validateKey(const CompositeKey& key, const char* operation) const {
     // 验证键的列数
     if (key.size() != columnTypes_.size()) {
-        LOG_ERROR(QString("CompositeIndex::insert: key size mismatch (%1 vs %2)")
-                     .arg(key.size()).arg(columnTypes_.size()));
+        LOG_ERROR(QString("CompositeIndex::%1: key size mismatch (%2 vs %3)")
+                     .arg(operation).arg(key.size()).arg(columnTypes_.size()));
         return false;
     }
 
     // 验证键的类型
     for (int i = 0; i < key.size(); ++i) {
         if (key.getType(i) != columnTypes_[i]) {
-            LOG_ERROR(QString("CompositeIndex::insert: type mismatch at column %1").arg(i));
+            LOG_ERROR(QString("CompositeIndex::%1: type mismatch at column %2").arg(operation).arg(i));
             return false;
         }
     }
+    return true;
+}
 
-    // 序列化复合键
-    QVariant serializedKey = serializeKey(key);
+bool CompositeIndex::insert(const CompositeKey& key, RowId rowId) {
+    return insert(key, rowId, QVector<QVariant>(), INVALID_TXN_ID);
+}
+
+bool CompositeIndex::insert(const CompositeKey& key, RowId rowId,
+                            const QVector<QVariant>& included, TransactionId createTxnId) {
+    if (!validateKey(key, "insert")) {
+        return false;
+    }
 
-    // 插入到底层B+树
-    bool success = tree_->insert(serializedKey, rowId);
+    bool success;
+    if (tree_->usesNormalizedKeys()) {
+        // 值槽位存放创建该行的事务ID，仅索引扫描时用它做可见性检查（rowId 已在键里）；
+        // 旧树仍按原格式写 rowId
+        QByteArray entry = encodeEntry(key, rowId, included);
+        const RowId value = storesCreateTxnIds() ? static_cast<RowId>(createTxnId) : rowId;
+        success = !entry.isEmpty() && tree_->insertEncoded(entry, value);
+    } else {
+        success = tree_->insert(serializeLegacyKey(key), rowId);
+    }
 
     if (success) {
         LOG_DEBUG(QString("CompositeIndex::insert: inserted key %1 -> rowId %2")
@@ -56,44 +83,80 @@ bool CompositeIndex::insert(const CompositeKey& key, RowId rowId) {
     return success;
 }
 
-bool CompositeIndex::remove(const CompositeKey& key) {
-    // 验证键的列数
-    if (key.size() != columnTypes_.size()) {
-        LOG_ERROR(QString("CompositeIndex::remove: key size mismatch (%1 vs %2)")
-                     .arg(key.size()).arg(columnTypes_.size()));
+bool CompositeIndex::remove(const CompositeKey& key, RowId rowId) {
+    if (!validateKey(key, "remove")) {
+        return false;
+    }
+
+    if (!tree_->usesNormalizedKeys()) {
+        // 旧格式每个键只对应一行
+        return tree_->remove(serializeLegacyKey(key));
+    }
+
+    QByteArray entry = encodeEntry(key, rowId, QVector<QVariant>());
+    if (!entry.isEmpty() && !includeTypes_.isEmpty()) {
+        // 键后面还有包含列：(键, rowId) 唯一，取出以它开头的那一项再删
+        QVector<QPair<QByteArray, RowId>> matches;
+        if (!tree_->scanEncoded(entry, prefixSuccessor(entry), matches) || matches.isEmpty()) {
+            entry.clear();
+        } else {
+            entry = matches.first().first;
+        }
+    }
+    if (entry.isEmpty() || !tree_->removeEncoded(entry)) {
+        LOG_WARN(QString("CompositeIndex::remove: failed to remove key %1 (rowId %2)")
+                    .arg(key.toString()).arg(rowId));
         return false;
     }
+    return true;
+}
 
-    // 序列化复合键
-    QVariant serializedKey = serializeKey(key);
+bool CompositeIndex::remove(const CompositeKey& key) {
+    if (!validateKey(key, "remove")) {
+        return false;
+    }
 
-    // 从底层B+树删除
-    bool success = tree_->remove(serializedKey);
+    if (!tree_->usesNormalizedKeys()) {
+        return tree_->remove(serializeLegacyKey(key));
+    }
 
-    if (success) {
-        LOG_DEBUG(QString("CompositeIndex::remove: removed key %1")
-                     .arg(key.toString()));
-    } else {
+    // 删除等于该键的所有行
+    QByteArray prefix = key.encode();
+    QVector<QPair<QByteArray, RowId>> matches;
+    if (prefix.isEmpty() || !tree_->scanEncoded(prefix, prefixSuccessor(prefix), matches) ||
+        matches.isEmpty()) {
         LOG_WARN(QString("CompositeIndex::remove: failed to remove key %1")
                     .arg(key.toString()));
+        return false;
+    }
+    for (const auto& match : matches) {
+        if (!tree_->removeEncoded(match.first)) {
+            return false;
+        }
     }
 
-    return success;
+    LOG_DEBUG(QString("CompositeIndex::remove: removed key %1 (%2 rows)")
+                 .arg(key.toString()).arg(matches.size()));
+    return true;
 }
 
 bool CompositeIndex::search(const CompositeKey& key, RowId& rowId) {
-    // 验证键的列数
     if (key.size() != columnTypes_.size()) {
         LOG_ERROR(QString("CompositeIndex::search: key size mismatch (%1 vs %2)")
                      .arg(key.size()).arg(columnTypes_.size()));
         return false;
     }
 
-    // 序列化复合键
-    QVariant serializedKey = serializeKey(key);
+    if (!tree_->usesNormalizedKeys()) {
+        return tree_->search(serializeLegacyKey(key), rowId);
+    }
 
-    // 在底层B+树中查找
-    return tree_->search(serializedKey, rowId);
+    QVector<QPair<CompositeKey, RowId>> matches;
+    if (!prefixSearch(key, matches) || matches.isEmpty()) {
+        return false;
+    }
+    rowId = matches.first().second;
+    return true;
 }
 
 bool CompositeIndex::rangeSearch(const CompositeKey& minKey, const CompositeKey& maxKey,
@@ -106,24 +169,24 @@ bool CompositeIndex::rangeSearch(const CompositeKey& minKey, const CompositeKey&
         return false;
     }
 
-    // 序列化最小和最大键
-    QVariant serializedMinKey = serializeKey(minKey);
-    QVariant serializedMaxKey = serializeKey(maxKey);
+    if (!tree_->usesNormalizedKeys()) {
+        return searchLegacyRange(serializeLegacyKey(minKey), serializeLegacyKey(maxKey), results);
+    }
 
-    // 在底层B+树中范围查询
-    QVector<QPair<QVariant, RowId>> rawResults;
-    if (!tree_->rangeSearch(serializedMinKey, serializedMaxKey, rawResults)) {
+    // [min, max] 包含等于 max 的所有行：上界取 max 编码的后继
+    QByteArray lower = minKey.encode();
+    QByteArray upperPrefix = maxKey.encode();
+    if (lower.isEmpty() || upperPrefix.isEmpty()) {
         return false;
     }
-
-    // 反序列化结果
-    results.reserve(rawResults.size());
-    for (const auto& pair : rawResults) {
-        CompositeKey key = deserializeKey(pair.first);
-        results.append(qMakePair(key, pair.second));
+    QVector<Entry> entries;
+    if (!scanRange(lower, prefixSuccessor(upperPrefix), entries)) {
+        return false;
+    }
+    results.reserve(entries.size());
+    for (const Entry& entry : entries) {
+        results.append(qMakePair(entry.key, entry.rowId));
     }
-
-    LOG_DEBUG(QString("CompositeIndex::rangeSearch: found %1 results").arg(results.size()));
     return true;
 }
 
@@ -143,6 +206,10 @@ bool CompositeIndex::prefixSearch(const CompositeKey& prefix,
         return false;
     }
 
+    if (tree_->usesNormalizedKeys()) {
+        return scan(prefix, ColumnRange(), results);
+    }
+
     // 构造范围查询的最小和最大键
     // 例如：前缀 (name='Alice')
     // minKey = ('Alice', MIN_VALUE, MIN_VALUE, ...)
@@ -225,23 +292,245 @@ bool CompositeIndex::prefixSearch(const CompositeKey& prefix,
     }
 
     // 使用范围查询
-    return rangeSearch(minKey, maxKey, results);
+    return searchLegacyRange(serializeLegacyKey(minKey), serializeLegacyKey(maxKey), results);
+}
+
+bool CompositeIndex::scan(const CompositeKey& prefix, const ColumnRange& range,
+                          QVector<QPair<CompositeKey, RowId>>& results) {
+    results.clear();
+
+    QVector<Entry> entries;
+    if (!scanEntries(prefix, range, entries)) {
+        return false;
+    }
+
+    results.reserve(entries.size());
+    for (const Entry& entry : entries) {
+        results.append(qMakePair(entry.key, entry.rowId));
+    }
+    return true;
+}
+
+bool CompositeIndex::scanEntries(const CompositeKey& prefix, const ColumnRange& range,
+                                 QVector<Entry>& results) {
+    results.clear();
+
+    if (!tree_->usesNormalizedKeys()) {
+        LOG_ERROR("CompositeIndex::scan: not supported on legacy key format");
+        return false;
+    }
+
+    const int rangeColumn = prefix.size();
+    if (rangeColumn > columnTypes_.size() || (range.isBounded() && rangeColumn >= columnTypes_.size())) {
+        LOG_ERROR(QString("CompositeIndex::scan: prefix size too large (%1 vs %2)")
+                     .arg(prefix.size()).arg(columnTypes_.size()));
+        return false;
+    }
+
+    QByteArray prefixBytes;
+    if (!prefix.isEmpty()) {
+        prefixBytes = prefix.encode();
+        if (prefixBytes.isEmpty()) {
+            return false;
+        }
+    }
+
+    // 前缀相等的所有键都在 [prefix, successor(prefix)) 内
+    QByteArray lower = prefixBytes;
+    QByteArray upper = prefixSuccessor(prefixBytes);
+
+    // 每个值的编码自定界：同一前缀下值 v 的所有键都以 prefix + enc(v) 开头，
+    // 大于 v 的值的键都不小于 successor(prefix + enc(v))
+    if (range.hasLower) {
+        QByteArray bound = prefixBytes;
+        if (!KeyEncoder::append(range.lower, columnTypes_[rangeColumn], bound)) {
+            return false;
+        }
+        lower = range.lowerInclusive ? bound : prefixSuccessor(bound);
+    } else if (range.hasUpper) {
+        // 只有上界时排除 NULL（NULL 的标记字节 0x00 小于非 NULL 的 0x01）
+        lower = prefixBytes;
+        lower.append('\x01');
+    }
+
+    if (range.hasUpper) {
+        QByteArray bound = prefixBytes;
+        if (!KeyEncoder::append(range.upper, columnTypes_[rangeColumn], bound)) {
+            return false;
+        }
+        upper = range.upperInclusive ? prefixSuccessor(bound) : bound;
+    }
+
+    if (!upper.isEmpty() && KeyEncoder::compare(lower, upper) >= 0) {
+        return true;  // 空区间
+    }
+
+    return scanRange(lower, upper, results);
+}
+
+bool CompositeIndex::bulkLoad(const QVector<QPair<CompositeKey, RowId>>& entries, double fillFactor) {
+    QVector<Entry> converted;
+    converted.reserve(entries.size());
+    for (const auto& entry : entries) {
+        Entry item;
+        item.key = entry.first;
+        item.rowId = entry.second;
+        converted.append(item);
+    }
+    return bulkLoad(converted, fillFactor);
+}
+
+bool CompositeIndex::bulkLoad(const QVector<Entry>& entries, double fillFactor) {
+    if (!tree_->usesNormalizedKeys()) {
+        LOG_ERROR("CompositeIndex::bulkLoad: not supported on legacy key format");
+        return false;
+    }
+
+    QVector<QPair<QByteArray, RowId>> encoded;
+    encoded.reserve(entries.size());
+    for (const Entry& entry : entries) {
+        if (!validateKey(entry.key, "bulkLoad")) {
+            return false;
+        }
+        QByteArray data = encodeEntry(entry.key, entry.rowId, entry.included);
+        if (data.isEmpty()) {
+            return false;
+        }
+        encoded.append(qMakePair(data, storesCreateTxnIds() ? static_cast<RowId>(entry.createTxnId)
+                                                            : entry.rowId));
+    }
+
+    return tree_->bulkLoadEncoded(encoded, fillFactor);
+}
+
+bool CompositeIndex::storesCreateTxnIds() const {
+    return (tree_->valueFormatFlags() & BPTREE_FLAG_TXN_VALUES) != 0;
 }
 
 PageId CompositeIndex::getRootPageId() const {
     return tree_->getRootPageId();
 }
 
-QVariant CompositeIndex::serializeKey(const CompositeKey& key) const {
-    QByteArray data = key.serialize();
-    return QVariant(data);
+QByteArray CompositeIndex::encodeEntry(const CompositeKey& key, RowId rowId,
+                                       const QVector<QVariant>& included) const {
+    QByteArray data = key.encode();
+    if (data.isEmpty()) {
+        return QByteArray();
+    }
+
+    // 大端 rowId：同一键下的行按 rowId 升序排列
+    for (int shift = 56; shift >= 0; shift -= 8) {
+        data.append(static_cast<char>((rowId >> shift) & 0xFF));
+    }
+
+    // 包含列在 rowId 之后：(键, rowId) 已唯一，它们不参与排序，只随叶子项存储。
+    // 只查 (键, rowId) 时（remove 定位）不带包含列
+    if (!included.isEmpty()) {
+        for (int i = 0; i < includeTypes_.size(); ++i) {
+            if (!KeyEncoder::append(included.value(i), includeTypes_[i], data)) {
+                return QByteArray();
+            }
+        }
+    }
+
+    if (data.size() > MAX_ENTRY_SIZE) {
+        LOG_ERROR(QString("CompositeIndex: index entry too large (%1 bytes, max %2)")
+                     .arg(data.size()).arg(MAX_ENTRY_SIZE));
+        return QByteArray();
+    }
+    return data;
 }
 
-CompositeKey CompositeIndex::deserializeKey(const QVariant& variant) const {
-    QByteArray data = variant.toByteArray();
-    CompositeKey key;
-    key.deserialize(data);
-    return key;
+bool CompositeIndex::decodeEntry(const QByteArray& data, Entry& entry) const {
+    int offset = 0;
+    entry.key.clear();
+    for (DataType type : columnTypes_) {
+        QVariant value;
+        if (!KeyEncoder::decodeAt(data, offset, type, value)) {
+            return false;
+        }
+        entry.key.addValue(value, type);
+    }
+
+    if (offset + static_cast<int>(sizeof(RowId)) > data.size()) {
+        return false;
+    }
+    entry.rowId = 0;
+    for (int i = 0; i < static_cast<int>(sizeof(RowId)); ++i) {
+        entry.rowId = (entry.rowId << 8) | static_cast<uint8_t>(data[offset++]);
+    }
+
+    entry.included.clear();
+    if (offset < data.size()) {
+        entry.included.reserve(includeTypes_.size());
+        for (DataType type : includeTypes_) {
+            QVariant value;
+            if (!KeyEncoder::decodeAt(data, offset, type, value)) {
+                return false;
+            }
+            entry.included.append(value);
+        }
+    }
+    return offset == data.size();
+}
+
+QByteArray CompositeIndex::prefixSuccessor(const QByteArray& prefix) {
+    QByteArray successor = prefix;
+    while (!successor.isEmpty() && static_cast<uint8_t>(successor.back()) == 0xFF) {
+        successor.chop(1);
+    }
+    if (!successor.isEmpty()) {
+        successor.back() = static_cast<char>(static_cast<uint8_t>(successor.back()) + 1);
+    }
+    return successor;
+}
+
+bool CompositeIndex::scanRange(const QByteArray& lower, const QByteArray& upper,
+                               QVector<Entry>& results) {
+    QVector<QPair<QByteArray, RowId>> rawResults;
+    if (!tree_->scanEncoded(lower, upper, rawResults)) {
+        return false;
+    }
+
+    results.reserve(rawResults.size());
+    for (const auto& raw : rawResults) {
+        Entry entry;
+        if (!decodeEntry(raw.first, entry)) {
+            LOG_ERROR("CompositeIndex::scan: malformed index entry");
+            return false;
+        }
+        if (storesCreateTxnIds()) {
+            entry.createTxnId = static_cast<TransactionId>(raw.second);
+        }
+        results.append(entry);
+    }
+
+    LOG_DEBUG(QString("CompositeIndex::scan: found %1 results").arg(results.size()));
+    return true;
+}
+
+QVariant CompositeIndex::serializeLegacyKey(const CompositeKey& key) const {
+    return QVariant(key.serialize());
+}
+
+bool CompositeIndex::searchLegacyRange(const QVariant& minKey, const QVariant& maxKey,
+                                       QVector<QPair<CompositeKey, RowId>>& results) {
+    // 在底层B+树中范围查询
+    QVector<QPair<QVariant, RowId>> rawResults;
+    if (!tree_->rangeSearch(minKey, maxKey, rawResults)) {
+        return false;
+    }
+
+    // 反序列化结果
+    results.reserve(rawResults.size());
+    for (const auto& pair : rawResults) {
+        CompositeKey key;
+        key.deserialize(pair.first.toByteArray());
+        results.append(qMakePair(key, pair.second));
+    }
+
+    LOG_DEBUG(QString("CompositeIndex::rangeSearch: found %1 results").arg(results.size()));
+    return true;
 }
 
 } // namespace qindb
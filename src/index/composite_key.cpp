@@ -4,6 +4,7 @@
  */
 #include "qindb/composite_key.h"
 #include "qindb/key_comparator.h"
+#include "qindb/key_encoder.h"
 #include "qindb/type_serializer.h"
 #include "qindb/logger.h"
 #include <QDataStream>
@@ -119,6 +120,27 @@ bool CompositeKey::deserialize(const QByteArray& data) {
     return true;
 }
 
+QByteArray CompositeKey::encode() const {
+    QByteArray result;
+    if (!KeyEncoder::encodeComposite(values_, types_, result)) {
+        LOG_ERROR("CompositeKey::encode: failed to encode value");
+        return QByteArray();
+    }
+    return result;
+}
+
+bool CompositeKey::decode(const QByteArray& data, const QVector<DataType>& types) {
+    QVector<QVariant> values;
+    if (!KeyEncoder::decodeComposite(data, types, values)) {
+        LOG_ERROR("CompositeKey::decode: malformed key");
+        return false;
+    }
+
+    values_ = values;
+    types_ = types.mid(0, values.size());
+    return true;
+}
+
 int CompositeKey::compare(const CompositeKey& other) const {
     // 使用字典序比较
     int minSize = qMin(values_.size(), other.values_.size());
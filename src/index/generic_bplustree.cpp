@@ -2,6 +2,9 @@
 #include "qindb/bplus_tree.h"  // 包含BPlusTreePageHeader定义
 #include "qindb/logger.h"  // 日志记录功能
 #include <QDataStream>  // Qt数据流，用于序列化
+#include <algorithm>
+#include <thread>
+#include <vector>
 
 namespace qindb {
 
@@ -27,7 +30,23 @@ GenericBPlusTree::GenericBPlusTree(BufferPoolManager* bufferPoolManager,
     , keyType_(keyType)  // 键类型
     , rootPageId_(rootPageId)  // 根节点页面ID
     , maxKeysPerPage_(maxKeysPerPage)  // 每页最大键数
+    , normalizedKeys_(true)  // 新树使用保序编码
+    , valueFlags_(BPTREE_FLAG_NONE)
 {
+    if (rootPageId_ != INVALID_PAGE_ID) {
+        // 已有的树：根页上没有保序编码标志且已有键，说明是旧格式，继续使用 TypeSerializer 编码
+        Page* rootPage = bufferPoolManager_->fetchPage(rootPageId_);
+        if (rootPage) {
+            BPlusTreePageHeader* header = reinterpret_cast<BPlusTreePageHeader*>(rootPage->getData());
+            normalizedKeys_ = (header->flags & BPTREE_FLAG_NORMALIZED_KEYS) != 0 || header->numKeys == 0;
+            valueFlags_ = static_cast<uint8_t>(header->flags & BPTREE_FLAG_TXN_VALUES);
+            bufferPoolManager_->unpinPage(rootPageId_, false);
+        }
+        if (!normalizedKeys_) {
+            LOG_INFO(QString("B+ tree root page %1 uses legacy key encoding").arg(rootPageId_));
+        }
+    }
+
     if (rootPageId_ == INVALID_PAGE_ID) {
         // 创建新的根节点（初始为空叶子节点）
         PageId newPageId;
@@ -56,6 +75,28 @@ GenericBPlusTree::~GenericBPlusTree() {
     // 析构函数不需要做特殊处理，页面由缓冲池管理
 }
 
+bool GenericBPlusTree::setValueFormatFlags(uint8_t flags) {
+    QMutexLocker locker(&mutex_);
+    if (valueFlags_ == flags) {
+        return true;
+    }
+
+    // 只有空树可以换格式：已有条目的值按原格式写入，换了会被误读
+    Page* rootPage = bufferPoolManager_->fetchPage(rootPageId_);
+    if (!rootPage) {
+        return false;
+    }
+    BPlusTreePageHeader* header = reinterpret_cast<BPlusTreePageHeader*>(rootPage->getData());
+    const bool empty = header->nodeType == BPlusTreeNodeType::LEAF_NODE && header->numKeys == 0;
+    bufferPoolManager_->unpinPage(rootPageId_, false);
+    if (!empty) {
+        return false;
+    }
+
+    valueFlags_ = flags;
+    return true;
+}
+
 // ============ 键序列化/反序列化 ============
 
 /**
@@ -63,11 +104,13 @@ GenericBPlusTree::~GenericBPlusTree() {
  * @param key 要序列化的键值
  * @return 序列化后的字节数组，失败返回空数组
  *
- * 说明：使用TypeSerializer根据键类型进行序列化
+ * 说明：使用KeyEncoder编码为可memcmp比较的保序格式；旧格式的树使用TypeSerializer
  */
 QByteArray GenericBPlusTree::serializeKey(const QVariant& key) {
     QByteArray result;
-    if (!TypeSerializer::serialize(key, keyType_, result)) {
+    bool ok = normalizedKeys_ ? KeyEncoder::encode(key, keyType_, result)
+                              : TypeSerializer::serialize(key, keyType_, result);
+    if (!ok) {
         LOG_ERROR(QString("Failed to serialize key of type %1").arg(getDataTypeName(keyType_)));
         return QByteArray();
     }
@@ -79,11 +122,13 @@ QByteArray GenericBPlusTree::serializeKey(const QVariant& key) {
  * @param serializedKey 序列化的字节数组
  * @return 反序列化后的键值，失败返回空QVariant
  *
- * 说明：使用TypeSerializer根据键类型进行反序列化
+ * 说明：与serializeKey对应，按树的键格式解码
  */
 QVariant GenericBPlusTree::deserializeKey(const QByteArray& serializedKey) {
     QVariant result;
-    if (!TypeSerializer::deserialize(serializedKey, keyType_, result)) {
+    bool ok = normalizedKeys_ ? KeyEncoder::decode(serializedKey, keyType_, result)
+                              : TypeSerializer::deserialize(serializedKey, keyType_, result);
+    if (!ok) {
         LOG_ERROR(QString("Failed to deserialize key of type %1").arg(getDataTypeName(keyType_)));
         return QVariant();
     }
@@ -96,9 +141,13 @@ QVariant GenericBPlusTree::deserializeKey(const QByteArray& serializedKey) {
  * @param key2 第二个键的字节数组
  * @return 比较结果：< 0表示key1 < key2，0表示相等，> 0表示key1 > key2
  *
- * 说明：使用KeyComparator根据键类型进行比较
+ * 说明：保序编码的键直接按字节比较（一次memcmp）；
+ *       旧格式的键需要反序列化后由KeyComparator按类型比较
  */
 int GenericBPlusTree::compareKeys(const QByteArray& key1, const QByteArray& key2) {
+    if (normalizedKeys_) {
+        return KeyEncoder::compare(key1, key2);
+    }
     return KeyComparator::compareSerialized(key1, key2, keyType_);
 }
 
@@ -133,6 +182,26 @@ bool GenericBPlusTree::insert(const QVariant& key, RowId value) {
         return false;
     }
 
+    return insertSerialized(serializedKey, value);
+}
+
+/**
+ * @brief 插入已编码的键
+ *
+ * 键必须已经是树内部的格式（保序编码的树即 KeyEncoder 的输出，
+ * 复合索引把多列编码拼接后直接传入），不再按 keyType 编码一次。
+ */
+bool GenericBPlusTree::insertEncoded(const QByteArray& key, RowId value) {
+    QMutexLocker locker(&mutex_);
+
+    if (key.isEmpty()) {
+        LOG_ERROR("Cannot insert empty encoded key into B+ tree");
+        return false;
+    }
+    return insertSerialized(key, value);
+}
+
+bool GenericBPlusTree::insertSerialized(const QByteArray& serializedKey, RowId value) {
     // 查找应该插入的叶子节点
     PageId leafPageId = findLeafPage(serializedKey);
     if (leafPageId == INVALID_PAGE_ID) {
@@ -234,6 +303,22 @@ bool GenericBPlusTree::remove(const QVariant& key) {
         return false;
     }
 
+    return removeSerialized(serializedKey);
+}
+
+/**
+ * @brief 删除已编码的键（格式要求同 insertEncoded）
+ */
+bool GenericBPlusTree::removeEncoded(const QByteArray& key) {
+    QMutexLocker locker(&mutex_);
+
+    if (key.isEmpty()) {
+        return false;
+    }
+    return removeSerialized(key);
+}
+
+bool GenericBPlusTree::removeSerialized(const QByteArray& serializedKey) {
     // 1. 查找包含键的叶子节点
     PageId leafPageId = findLeafPage(serializedKey);
     if (leafPageId == INVALID_PAGE_ID) {
@@ -364,6 +449,467 @@ bool GenericBPlusTree::rangeSearch(const QVariant& minKey, const QVariant& maxKe
     return true;
 }
 
+/**
+ * @brief 按已编码的键做半开区间扫描 [lower, upper)
+ *
+ * 从 lower 所在的叶子开始沿叶子链表向右，遇到 >= upper 的键即停止，
+ * 复合索引的前缀和前缀 + 范围查询都是一次连续的叶子遍历。
+ * lower 为空表示从最小键开始，upper 为空表示扫描到最后。
+ */
+bool GenericBPlusTree::scanEncoded(const QByteArray& lower, const QByteArray& upper,
+                                   QVector<QPair<QByteArray, RowId>>& results) {
+    QMutexLocker locker(&mutex_);
+
+    results.clear();
+
+    PageId leafPageId = findLeafPage(lower);
+    if (leafPageId == INVALID_PAGE_ID) {
+        return false;
+    }
+
+    while (leafPageId != INVALID_PAGE_ID) {
+        Page* page = bufferPoolManager_->fetchPage(leafPageId);
+        if (!page) {
+            return false;
+        }
+
+        BPlusTreePageHeader* header = reinterpret_cast<BPlusTreePageHeader*>(page->getData());
+        QVector<KeyValuePair> entries;
+        bool success = readLeafEntries(page, entries);
+        PageId nextPageId = header->nextPageId;
+        bufferPoolManager_->unpinPage(leafPageId, false);
+
+        if (!success) {
+            return false;
+        }
+
+        for (const auto& entry : entries) {
+            if (compareKeys(entry.serializedKey, lower) < 0) {
+                continue;
+            }
+            if (!upper.isEmpty() && compareKeys(entry.serializedKey, upper) >= 0) {
+                return true;
+            }
+            results.append(qMakePair(entry.serializedKey, entry.value));
+        }
+
+        leafPageId = nextPageId;
+    }
+
+    return true;
+}
+
+// ============ 批量构建 ============
+
+namespace {
+
+/**
+ * @brief 并行稳定排序
+ *
+ * 数据量较大时切成若干段由多个线程分别排序，再两两归并；
+ * 归并使用 std::inplace_merge，整体保持稳定（相等元素维持原有先后顺序）。
+ */
+template <typename T, typename Less>
+void parallelStableSort(QVector<T>& items, Less less) {
+    const int kMinChunkSize = 65536;  // 每段至少的元素数，避免线程开销大于收益
+
+    int numThreads = static_cast<int>(std::thread::hardware_concurrency());
+    if (numThreads <= 1 || items.size() < kMinChunkSize * 2) {
+        std::stable_sort(items.begin(), items.end(), less);
+        return;
+    }
+    numThreads = std::min(numThreads, static_cast<int>(items.size() / kMinChunkSize));
+
+    // 切段并行排序
+    QVector<int> bounds;
+    for (int i = 0; i <= numThreads; ++i) {
+        bounds.append(static_cast<int>(static_cast<qint64>(items.size()) * i / numThreads));
+    }
+
+    T* base = items.data();  // 先 detach，避免多线程下隐式共享拷贝
+    std::vector<std::thread> workers;
+    for (int i = 0; i < numThreads; ++i) {
+        int first = bounds[i];
+        int last = bounds[i + 1];
+        workers.emplace_back([base, first, last, &less]() {
+            std::stable_sort(base + first, base + last, less);
+        });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+
+    // 逐轮两两归并，同一轮内的归并互不重叠，可以并行
+    while (bounds.size() > 2) {
+        QVector<int> merged;
+        workers.clear();
+        for (int i = 0; i + 2 < bounds.size(); i += 2) {
+            int first = bounds[i];
+            int middle = bounds[i + 1];
+            int last = bounds[i + 2];
+            workers.emplace_back([base, first, middle, last, &less]() {
+                std::inplace_merge(base + first, base + middle, base + last, less);
+            });
+            merged.append(first);
+        }
+        if (bounds.size() % 2 == 0) {
+            // 奇数段，最后一段本轮轮空
+            merged.append(bounds[bounds.size() - 2]);
+        }
+        merged.append(bounds.last());
+        for (auto& worker : workers) {
+            worker.join();
+        }
+        bounds = merged;
+    }
+}
+
+} // anonymous namespace
+
+/**
+ * @brief 自底向上批量构建B+树
+ * @param entries 待加载的键值对（无需有序）
+ * @param fillFactor 页填充因子
+ * @return 构建成功返回true，失败返回false
+ *
+ * 功能流程：
+ * 1. 序列化所有键，跳过NULL键
+ * 2. 并行稳定排序，相同键只保留最后一个值
+ * 3. 按填充因子从左到右装填叶子页，并串成双向链表
+ * 4. 以每页的最小键作为分隔键，逐层向上构建内部节点，直到只剩一个根
+ *
+ * 相比逐条 insert：
+ * - 不需要每行都从根向下查找
+ * - 不会产生随机分裂和半满页
+ * - 每个页面只写一次，页面按顺序分配，叶子在磁盘上基本连续
+ *
+ * 注意：仅适用于空树（通常是 CREATE INDEX 时新建的树）；
+ * 非空树会退化为逐条插入，保证语义正确。
+ */
+bool GenericBPlusTree::bulkLoad(const QVector<QPair<QVariant, RowId>>& entries, double fillFactor) {
+    // 填充因子低于 0.5 会导致非根节点一开始就处于下溢状态
+    fillFactor = std::clamp(fillFactor, 0.5, 1.0);
+
+    QMutexLocker locker(&mutex_);
+
+    Page* rootPage = bufferPoolManager_->fetchPage(rootPageId_);
+    if (!rootPage) {
+        LOG_ERROR("Failed to fetch root page for bulk load");
+        return false;
+    }
+    BPlusTreePageHeader* rootHeader = reinterpret_cast<BPlusTreePageHeader*>(rootPage->getData());
+    bool isEmpty = (rootHeader->nodeType == BPlusTreeNodeType::LEAF_NODE && rootHeader->numKeys == 0);
+    bufferPoolManager_->unpinPage(rootPageId_, false);
+
+    if (!isEmpty) {
+        // insert 内部会自行加锁
+        locker.unlock();
+        LOG_WARN("Bulk load on non-empty B+ tree, falling back to per-row insert");
+        for (const auto& entry : entries) {
+            if (!entry.first.isNull() && !insert(entry.first, entry.second)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // 1. 序列化
+    QVector<KeyValuePair> sorted;
+    sorted.reserve(entries.size());
+    for (const auto& entry : entries) {
+        if (entry.first.isNull()) {
+            continue;  // NULL 键不进入索引
+        }
+        QByteArray serializedKey = serializeKey(entry.first);
+        if (serializedKey.isEmpty()) {
+            return false;
+        }
+        if (serializedKey.size() > 4096) {
+            LOG_ERROR(QString("Key too large for B+ tree: %1 bytes").arg(serializedKey.size()));
+            return false;
+        }
+        sorted.append(KeyValuePair(serializedKey, entry.second));
+    }
+
+    return bulkLoadSerialized(sorted, fillFactor);
+}
+
+/**
+ * @brief 用已编码的键批量构建（格式要求同 insertEncoded）
+ */
+bool GenericBPlusTree::bulkLoadEncoded(const QVector<QPair<QByteArray, RowId>>& entries, double fillFactor) {
+    fillFactor = std::clamp(fillFactor, 0.5, 1.0);
+
+    QMutexLocker locker(&mutex_);
+
+    Page* rootPage = bufferPoolManager_->fetchPage(rootPageId_);
+    if (!rootPage) {
+        LOG_ERROR("Failed to fetch root page for bulk load");
+        return false;
+    }
+    BPlusTreePageHeader* rootHeader = reinterpret_cast<BPlusTreePageHeader*>(rootPage->getData());
+    bool isEmpty = (rootHeader->nodeType == BPlusTreeNodeType::LEAF_NODE && rootHeader->numKeys == 0);
+    bufferPoolManager_->unpinPage(rootPageId_, false);
+
+    if (!isEmpty) {
+        locker.unlock();
+        LOG_WARN("Bulk load on non-empty B+ tree, falling back to per-row insert");
+        for (const auto& entry : entries) {
+            if (!insertEncoded(entry.first, entry.second)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    QVector<KeyValuePair> sorted;
+    sorted.reserve(entries.size());
+    for (const auto& entry : entries) {
+        if (entry.first.isEmpty() || entry.first.size() > 4096) {
+            LOG_ERROR(QString("Invalid encoded key for B+ tree: %1 bytes").arg(entry.first.size()));
+            return false;
+        }
+        sorted.append(KeyValuePair(entry.first, entry.second));
+    }
+
+    return bulkLoadSerialized(sorted, fillFactor);
+}
+
+bool GenericBPlusTree::bulkLoadSerialized(QVector<KeyValuePair>& sorted, double fillFactor) {
+    if (sorted.isEmpty()) {
+        return true;
+    }
+
+    // 2. 并行稳定排序 + 去重（与 insert 的覆盖语义一致，保留最后一次出现的值）
+    const DataType keyType = keyType_;
+    const bool normalized = normalizedKeys_;
+    parallelStableSort(sorted, [keyType, normalized](const KeyValuePair& a, const KeyValuePair& b) {
+        if (normalized) {
+            return KeyEncoder::compare(a.serializedKey, b.serializedKey) < 0;
+        }
+        return KeyComparator::compareSerialized(a.serializedKey, b.serializedKey, keyType) < 0;
+    });
+
+    int writePos = 0;
+    for (int i = 1; i < sorted.size(); ++i) {
+        if (compareKeys(sorted[writePos].serializedKey, sorted[i].serializedKey) == 0) {
+            sorted[writePos].value = sorted[i].value;
+        } else {
+            sorted[++writePos] = std::move(sorted[i]);
+        }
+    }
+    sorted.resize(writePos + 1);
+
+    const size_t pageCapacity = PAGE_SIZE - sizeof(BPlusTreePageHeader);
+    const size_t byteBudget = static_cast<size_t>(pageCapacity * fillFactor);
+    const int targetKeys = std::max(getMinKeys(true),
+                                    std::min(maxKeysPerPage_, static_cast<int>(maxKeysPerPage_ * fillFactor)));
+
+    // 3. 装填叶子页
+    QVector<int> leafItemBytes;
+    leafItemBytes.reserve(sorted.size());
+    for (const auto& kv : sorted) {
+        leafItemBytes.append(static_cast<int>(sizeof(uint16_t) + kv.serializedKey.size() + sizeof(RowId)));
+    }
+
+    QVector<QPair<int, int>> leafRuns = planBulkLoadRuns(leafItemBytes, sizeof(uint16_t),
+                                                         targetKeys, maxKeysPerPage_,
+                                                         getMinKeys(true), byteBudget);
+
+    // 当前层的 (分隔键, 页ID)，作为上一层的分隔键和子节点
+    QVector<InternalEntry> level;
+    level.reserve(leafRuns.size());
+
+    // 失败时释放本次新分配的页，并把原根页恢复成空叶子，树仍是构建前的空树
+    QVector<PageId> allocatedPages;
+    auto abortBulkLoad = [&]() {
+        for (PageId pageId : allocatedPages) {
+            bufferPoolManager_->deletePage(pageId);
+        }
+        Page* rootPage = bufferPoolManager_->fetchPage(rootPageId_);
+        if (rootPage) {
+            initializeLeafPage(rootPage, rootPageId_);
+            writeLeafEntries(rootPage, QVector<KeyValuePair>());
+            bufferPoolManager_->unpinPage(rootPageId_, true);
+        }
+        return false;
+    };
+
+    PageId prevLeafPageId = INVALID_PAGE_ID;
+    QByteArray prevLeafLastKey;
+    for (int r = 0; r < leafRuns.size(); ++r) {
+        PageId leafPageId;
+        Page* page;
+        if (r == 0) {
+            // 复用空树原有的根叶子页作为最左叶子
+            leafPageId = rootPageId_;
+            page = bufferPoolManager_->fetchPage(leafPageId);
+        } else {
+            page = bufferPoolManager_->newPage(&leafPageId);
+        }
+        if (!page) {
+            LOG_ERROR("Failed to allocate leaf page during bulk load");
+            return abortBulkLoad();
+        }
+        if (r > 0) {
+            allocatedPages.append(leafPageId);
+        }
+
+        initializeLeafPage(page, leafPageId);
+        QVector<KeyValuePair> leafEntries = sorted.mid(leafRuns[r].first,
+                                                       leafRuns[r].second - leafRuns[r].first);
+        if (!writeLeafEntries(page, leafEntries)) {
+            bufferPoolManager_->unpinPage(leafPageId, false);
+            return abortBulkLoad();
+        }
+        BPlusTreePageHeader* header = reinterpret_cast<BPlusTreePageHeader*>(page->getData());
+        header->prevPageId = prevLeafPageId;
+        bufferPoolManager_->unpinPage(leafPageId, true);
+
+        // 回填前一个叶子的 next 指针
+        if (prevLeafPageId != INVALID_PAGE_ID) {
+            Page* prevPage = bufferPoolManager_->fetchPage(prevLeafPageId);
+            if (!prevPage) {
+                return abortBulkLoad();
+            }
+            reinterpret_cast<BPlusTreePageHeader*>(prevPage->getData())->nextPageId = leafPageId;
+            bufferPoolManager_->unpinPage(prevLeafPageId, true);
+        }
+
+        // 分隔键做后缀截断（最左叶子的键不会作为分隔键使用）
+        QByteArray separator = (r == 0)
+            ? leafEntries.first().serializedKey
+            : shortestSeparator(prevLeafLastKey, leafEntries.first().serializedKey);
+        level.append(InternalEntry(separator, leafPageId));
+        prevLeafPageId = leafPageId;
+        prevLeafLastKey = leafEntries.last().serializedKey;
+    }
+
+    // 4. 逐层构建内部节点
+    const int targetChildren = targetKeys + 1;
+    int height = 1;
+    while (level.size() > 1) {
+        // 每个子节点在内部页中占用：键长 + 键 + 子页ID（首个子节点实际只占子页ID，按上界估算）
+        QVector<int> childItemBytes;
+        childItemBytes.reserve(level.size());
+        for (const auto& child : level) {
+            childItemBytes.append(static_cast<int>(sizeof(uint16_t) + child.serializedKey.size() + sizeof(PageId)));
+        }
+
+        QVector<QPair<int, int>> runs = planBulkLoadRuns(childItemBytes, sizeof(uint16_t),
+                                                         targetChildren, maxKeysPerPage_ + 1,
+                                                         getMinKeys(false) + 1, byteBudget);
+
+        QVector<InternalEntry> parentLevel;
+        parentLevel.reserve(runs.size());
+        for (const auto& run : runs) {
+            PageId internalPageId;
+            Page* page = bufferPoolManager_->newPage(&internalPageId);
+            if (!page) {
+                LOG_ERROR("Failed to allocate internal page during bulk load");
+                return abortBulkLoad();
+            }
+            allocatedPages.append(internalPageId);
+            initializeInternalPage(page, internalPageId);
+
+            // 首个子节点作为 firstChild，其余子节点的最小键作为分隔键
+            PageId firstChild = level[run.first].childPageId;
+            QVector<InternalEntry> internalEntries = level.mid(run.first + 1, run.second - run.first - 1);
+            if (!writeInternalEntries(page, internalEntries, firstChild)) {
+                bufferPoolManager_->unpinPage(internalPageId, false);
+                return abortBulkLoad();
+            }
+            bufferPoolManager_->unpinPage(internalPageId, true);
+
+            // 设置子节点的父指针
+            for (int i = run.first; i < run.second; ++i) {
+                PageId childPageId = level[i].childPageId;
+                Page* childPage = bufferPoolManager_->fetchPage(childPageId);
+                if (!childPage) {
+                    return abortBulkLoad();
+                }
+                reinterpret_cast<BPlusTreePageHeader*>(childPage->getData())->parentPageId = internalPageId;
+                bufferPoolManager_->unpinPage(childPageId, true);
+            }
+
+            parentLevel.append(InternalEntry(level[run.first].serializedKey, internalPageId));
+        }
+
+        level = parentLevel;
+        ++height;
+    }
+
+    rootPageId_ = level.first().childPageId;
+
+    LOG_INFO(QString("Bulk loaded B+ tree: %1 keys, %2 leaf pages, height %3, root %4, fill factor %5")
+                .arg(sorted.size()).arg(leafRuns.size()).arg(height).arg(rootPageId_).arg(fillFactor));
+
+    return true;
+}
+
+/**
+ * @brief 把有序条目划分为若干页
+ *
+ * 贪心地从左到右装填，直到达到目标条目数或字节预算；
+ * 如果最后一页条目数不足最小值，则与前一页合并或平分，避免产生下溢页。
+ */
+QVector<QPair<int, int>> GenericBPlusTree::planBulkLoadRuns(const QVector<int>& itemBytes, size_t fixedBytes,
+                                                            int targetItems, int maxItems, int minItems,
+                                                            size_t byteBudget) const {
+    const size_t pageCapacity = PAGE_SIZE - sizeof(BPlusTreePageHeader);
+
+    QVector<QPair<int, int>> runs;
+    int start = 0;
+    size_t bytes = fixedBytes;
+    for (int i = 0; i < itemBytes.size(); ++i) {
+        int count = i - start;
+        if (count > 0 && (count >= targetItems || bytes + itemBytes[i] > byteBudget)) {
+            runs.append(qMakePair(start, i));
+            start = i;
+            bytes = fixedBytes;
+        }
+        bytes += itemBytes[i];
+    }
+    runs.append(qMakePair(start, static_cast<int>(itemBytes.size())));
+
+    // 修正最后一页的下溢
+    if (runs.size() > 1 && runs.last().second - runs.last().first < minItems) {
+        QPair<int, int> last = runs.takeLast();
+        QPair<int, int> prev = runs.takeLast();
+
+        size_t combinedBytes = fixedBytes;
+        for (int i = prev.first; i < last.second; ++i) {
+            combinedBytes += itemBytes[i];
+        }
+
+        int combinedCount = last.second - prev.first;
+        if (combinedCount <= maxItems && combinedBytes <= pageCapacity) {
+            // 两页合并为一页
+            runs.append(qMakePair(prev.first, last.second));
+        } else {
+            // 平分两页；若平分后任一页放不下，则保持原划分（下溢页仍是合法的B+树）
+            int mid = prev.first + combinedCount / 2;
+            size_t leftBytes = fixedBytes;
+            size_t rightBytes = fixedBytes;
+            for (int i = prev.first; i < mid; ++i) {
+                leftBytes += itemBytes[i];
+            }
+            for (int i = mid; i < last.second; ++i) {
+                rightBytes += itemBytes[i];
+            }
+            if (leftBytes <= pageCapacity && rightBytes <= pageCapacity) {
+                runs.append(qMakePair(prev.first, mid));
+                runs.append(qMakePair(mid, last.second));
+            } else {
+                runs.append(prev);
+                runs.append(last);
+            }
+        }
+    }
+
+    return runs;
+}
+
 // ============ 内部辅助函数 ============
 
 /**
@@ -476,27 +1022,22 @@ bool GenericBPlusTree::insertIntoLeaf(PageId leafPageId, const QByteArray& seria
     // 插入新键值对到正确位置（保持有序）
     entries.insert(pos, KeyValuePair(serializedKey, value));
 
-    // 检查是否需要分裂节点
-    if (entries.size() <= maxKeysPerPage_) {
+    // 检查是否需要分裂节点（键数超限，或前缀压缩后仍放不下一页）
+    if (entries.size() <= maxKeysPerPage_ &&
+        encodedLeafSize(entries) <= PAGE_SIZE - sizeof(BPlusTreePageHeader)) {
         // 节点未满，不需要分裂，直接写入
         bool success = writeLeafEntries(page, entries);
         bufferPoolManager_->unpinPage(leafPageId, success);
         return success;
     }
 
-    // 节点已满，需要分裂
-    // 关键修复：先将新插入的键值对写入页面，然后再分裂
-    // 这样可以确保分裂时数据的完整性
-    bool success = writeLeafEntries(page, entries);
-    bufferPoolManager_->unpinPage(leafPageId, success);
-    if (!success) {
-        return false;
-    }
+    bufferPoolManager_->unpinPage(leafPageId, false);
 
-    // 执行叶子节点分裂
+    // 节点已满，需要分裂
+    // 直接用内存中包含新键的条目分裂，避免先写入一个可能放不下的页面
     PageId newLeafPageId;
-    QByteArray middleKey;  // 分裂后的中间键
-    if (!splitLeafNode(leafPageId, newLeafPageId, middleKey)) {
+    QByteArray middleKey;  // 分裂后的分隔键
+    if (!splitLeafNode(leafPageId, entries, newLeafPageId, middleKey)) {
         return false;
     }
 
@@ -525,43 +1066,38 @@ bool GenericBPlusTree::insertIntoLeaf(PageId leafPageId, const QByteArray& seria
 /**
  * @brief 分裂叶子节点
  * @param leafPageId 要分裂的叶子节点ID
+ * @param entries 分裂前的全部条目（已包含新插入的键）
  * @param newLeafPageId 输出参数，新创建的叶子节点ID
- * @param middleKey 输出参数，分裂后的中间键（提升到父节点）
+ * @param middleKey 输出参数，分裂后的分隔键（提升到父节点）
  * @return 分裂成功返回true，失败返回false
  *
  * 功能流程：
- * 1. 读取原叶子节点的所有条目
+ * 1. 读取原叶子节点的链接信息
  * 2. 创建新的叶子节点
  * 3. 将条目分为两部分：前一半留在原节点，后一半移到新节点
  * 4. 更新叶子节点链表的指针（prev和next）
  * 5. 返回中间键，用于插入到父节点
  *
  * 分裂策略：
- * - 使用中点分裂（mid = size / 2）
+ * - 使用中点分裂（mid = size / 2），变长键时按字节微调
  * - 左节点：[0, mid)
  * - 右节点：[mid, size)
- * - 中间键：右节点的第一个键
+ * - 分隔键：对右节点第一个键做后缀截断，只保留区分左右两侧所需的最短前缀
  *
  * 链表维护：
  * - 叶子节点通过双向链表连接
  * - 分裂后需要更新prev/next指针
  * - 保证范围查询的正确性
  */
-bool GenericBPlusTree::splitLeafNode(PageId leafPageId, PageId& newLeafPageId, QByteArray& middleKey) {
-    // 读取原叶子节点
+bool GenericBPlusTree::splitLeafNode(PageId leafPageId, const QVector<KeyValuePair>& entries,
+                                     PageId& newLeafPageId, QByteArray& middleKey) {
+    // 读取原叶子节点的链接信息
     Page* oldPage = bufferPoolManager_->fetchPage(leafPageId);
     if (!oldPage) {
         return false;
     }
 
     BPlusTreePageHeader* oldHeader = reinterpret_cast<BPlusTreePageHeader*>(oldPage->getData());
-    QVector<KeyValuePair> entries;
-
-    // 读取所有键值对
-    if (!readLeafEntries(oldPage, entries)) {
-        bufferPoolManager_->unpinPage(leafPageId, false);
-        return false;
-    }
 
     // 保存父节点和下一个节点的ID
     PageId parentPageId = oldHeader->parentPageId;
@@ -577,12 +1113,20 @@ bool GenericBPlusTree::splitLeafNode(PageId leafPageId, PageId& newLeafPageId, Q
     initializeLeafPage(newPage, newLeafPageId);
 
     // 分裂：前一半留在旧节点，后一半放到新节点
+    // 变长键时按字节调整分裂点，保证两侧都能放进一页
+    const size_t pageCapacity = PAGE_SIZE - sizeof(BPlusTreePageHeader);
     int mid = entries.size() / 2;
+    while (mid > 1 && encodedLeafSize(entries.mid(0, mid)) > pageCapacity) {
+        --mid;
+    }
+    while (mid < entries.size() - 1 && encodedLeafSize(entries.mid(mid)) > pageCapacity) {
+        ++mid;
+    }
     QVector<KeyValuePair> leftEntries = entries.mid(0, mid);  // [0, mid)
     QVector<KeyValuePair> rightEntries = entries.mid(mid);    // [mid, size)
 
-    // 中间键是右半部分的第一个键，将被提升到父节点
-    middleKey = rightEntries.first().serializedKey;
+    // 分隔键：后缀截断后的最短键，满足 左侧最大键 < 分隔键 <= 右侧最小键
+    middleKey = shortestSeparator(leftEntries.last().serializedKey, rightEntries.first().serializedKey);
 
     // 写入新节点（右半部分）
     if (!writeLeafEntries(newPage, rightEntries)) {
@@ -631,22 +1175,16 @@ bool GenericBPlusTree::splitLeafNode(PageId leafPageId, PageId& newLeafPageId, Q
     return true;
 }
 
-bool GenericBPlusTree::splitInternalNode(PageId internalPageId, PageId& newInternalPageId, QByteArray& middleKey) {
-    // 读取原内部节点
+bool GenericBPlusTree::splitInternalNode(PageId internalPageId, const QVector<InternalEntry>& entries,
+                                         PageId firstChild, PageId& newInternalPageId,
+                                         QByteArray& middleKey) {
+    // 读取原内部节点的父指针
     Page* oldPage = bufferPoolManager_->fetchPage(internalPageId);
     if (!oldPage) {
         return false;
     }
 
     BPlusTreePageHeader* oldHeader = reinterpret_cast<BPlusTreePageHeader*>(oldPage->getData());
-    QVector<InternalEntry> entries;
-    PageId firstChild;
-
-    if (!readInternalEntries(oldPage, entries, firstChild)) {
-        bufferPoolManager_->unpinPage(internalPageId, false);
-        return false;
-    }
-
     PageId parentPageId = oldHeader->parentPageId;
     bufferPoolManager_->unpinPage(internalPageId, false);
 
@@ -658,10 +1196,17 @@ bool GenericBPlusTree::splitInternalNode(PageId internalPageId, PageId& newInter
 
     initializeInternalPage(newPage, newInternalPageId);
 
-    // 分裂：前一半留在旧节点，后一半放到新节点
+    // 分裂：前一半留在旧节点，后一半放到新节点（按字节微调分裂点）
+    const size_t pageCapacity = PAGE_SIZE - sizeof(BPlusTreePageHeader);
     int mid = entries.size() / 2;
+    while (mid > 1 && encodedInternalSize(entries.mid(0, mid)) > pageCapacity) {
+        --mid;
+    }
+    while (mid < entries.size() - 2 && encodedInternalSize(entries.mid(mid + 1)) > pageCapacity) {
+        ++mid;
+    }
 
-    // 中间键会被提升到父节点
+    // 中间键会被提升到父节点（它本身已经是截断后的分隔键）
     middleKey = entries[mid].serializedKey;
 
     QVector<InternalEntry> leftEntries = entries.mid(0, mid);
@@ -790,8 +1335,9 @@ bool GenericBPlusTree::insertIntoParent(PageId parentPageId, const QByteArray& k
     // 插入新条目
     entries.insert(pos, InternalEntry(key, rightPageId));
 
-    // 检查是否需要分裂
-    if (entries.size() <= maxKeysPerPage_) {
+    // 检查是否需要分裂（键数超限，或前缀压缩后仍放不下一页）
+    if (entries.size() <= maxKeysPerPage_ &&
+        encodedInternalSize(entries) <= PAGE_SIZE - sizeof(BPlusTreePageHeader)) {
         // 不需要分裂，直接写入
         page = bufferPoolManager_->fetchPage(parentPageId);
         if (!page) {
@@ -803,23 +1349,11 @@ bool GenericBPlusTree::insertIntoParent(PageId parentPageId, const QByteArray& k
         return success;
     }
 
-    // 需要分裂内部节点
-    // 关键修复：先将新插入的条目写入页面，然后再分裂
-    page = bufferPoolManager_->fetchPage(parentPageId);
-    if (!page) {
-        return false;
-    }
-
-    if (!writeInternalEntries(page, entries, firstChild)) {
-        bufferPoolManager_->unpinPage(parentPageId, false);
-        return false;
-    }
-    bufferPoolManager_->unpinPage(parentPageId, true);
-
+    // 需要分裂内部节点，直接用内存中的条目分裂
     PageId newInternalPageId;
     QByteArray middleKey;
 
-    if (!splitInternalNode(parentPageId, newInternalPageId, middleKey)) {
+    if (!splitInternalNode(parentPageId, entries, firstChild, newInternalPageId, middleKey)) {
         return false;
     }
 
@@ -873,6 +1407,161 @@ void GenericBPlusTree::initializeInternalPage(Page* page, PageId pageId) {
 
 // ============ 页面读写 ============
 
+/**
+ * @brief 计算 prefix 前 prefixLen 字节与 key 的公共前缀长度
+ */
+static int commonPrefixLength(const QByteArray& prefix, int prefixLen, const QByteArray& key) {
+    int limit = qMin(prefixLen, static_cast<int>(key.size()));
+    int i = 0;
+    while (i < limit && prefix[i] == key[i]) {
+        ++i;
+    }
+    return i;
+}
+
+int GenericBPlusTree::keyHeaderSize() const {
+    // 保序编码没有长度字段，整个键都可以参与前缀压缩
+    if (normalizedKeys_) {
+        return 0;
+    }
+
+    // TypeSerializer 对变长类型的编码为：NULL标志(1) + 长度 + 数据
+    // 长度字段因键而异，放在前缀里会让公共前缀几乎为空，因此只对其后的数据部分做前缀压缩
+    if (isStringType(keyType_) || keyType_ == DataType::DECIMAL || keyType_ == DataType::NUMERIC) {
+        return 1 + sizeof(uint16_t);
+    }
+    if (isBinaryType(keyType_) || keyType_ == DataType::JSON ||
+        keyType_ == DataType::JSONB || keyType_ == DataType::XML) {
+        return 1 + sizeof(uint32_t);
+    }
+    return 0;
+}
+
+QByteArray GenericBPlusTree::computeNodePrefix(const QVector<QByteArray>& keys) const {
+    if (keys.isEmpty()) {
+        return QByteArray();
+    }
+
+    const int headerSize = keyHeaderSize();
+    for (const auto& key : keys) {
+        if (key.size() < headerSize) {
+            return QByteArray();  // 非预期的编码，不做压缩
+        }
+    }
+
+    const QByteArray& first = keys.first();
+    int prefixLen = first.size() - headerSize;
+    for (int i = 1; i < keys.size() && prefixLen > 0; ++i) {
+        const QByteArray& key = keys[i];
+        int limit = qMin(prefixLen, static_cast<int>(key.size()) - headerSize);
+        int j = 0;
+        while (j < limit && first[headerSize + j] == key[headerSize + j]) {
+            ++j;
+        }
+        prefixLen = j;
+    }
+    return first.mid(headerSize, prefixLen);
+}
+
+size_t GenericBPlusTree::encodedLeafSize(const QVector<KeyValuePair>& entries) const {
+    QVector<QByteArray> keys;
+    keys.reserve(entries.size());
+    size_t keyBytes = 0;
+    for (const auto& entry : entries) {
+        keys.append(entry.serializedKey);
+        keyBytes += entry.serializedKey.size();
+    }
+    size_t prefixLen = computeNodePrefix(keys).size();
+
+    // 前缀长度 + 前缀 + 条目数量 + 每个条目（后缀长度 + 后缀 + 值）
+    return sizeof(uint16_t) + prefixLen + sizeof(uint16_t)
+         + entries.size() * (sizeof(uint16_t) + sizeof(RowId))
+         + keyBytes - entries.size() * prefixLen;
+}
+
+size_t GenericBPlusTree::encodedInternalSize(const QVector<InternalEntry>& entries) const {
+    QVector<QByteArray> keys;
+    keys.reserve(entries.size());
+    size_t keyBytes = 0;
+    for (const auto& entry : entries) {
+        keys.append(entry.serializedKey);
+        keyBytes += entry.serializedKey.size();
+    }
+    size_t prefixLen = computeNodePrefix(keys).size();
+
+    // 前缀长度 + 前缀 + firstChild + 条目数量 + 每个条目（后缀长度 + 后缀 + 子页ID）
+    return sizeof(uint16_t) + prefixLen + sizeof(PageId) + sizeof(uint16_t)
+         + entries.size() * (sizeof(uint16_t) + sizeof(PageId))
+         + keyBytes - entries.size() * prefixLen;
+}
+
+/**
+ * @brief 从流中读取节点公共前缀（仅前缀压缩格式）
+ */
+static bool readNodePrefix(QDataStream& stream, QByteArray& prefix) {
+    uint16_t prefixLen;
+    stream >> prefixLen;
+    if (prefixLen > 4096) {
+        LOG_ERROR(QString("Invalid node prefix size: %1").arg(prefixLen));
+        return false;
+    }
+
+    prefix = QByteArray(prefixLen, '\0');
+    if (prefixLen > 0 && stream.readRawData(prefix.data(), prefixLen) != prefixLen) {
+        LOG_ERROR("Failed to read node prefix");
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief 从流中读取一个键（压缩格式下在类型头之后插回节点前缀）
+ */
+static bool readNodeKey(QDataStream& stream, const QByteArray& prefix, int headerSize,
+                        bool compressed, QByteArray& key) {
+    uint16_t storedSize;
+    stream >> storedSize;
+
+    int keySize = storedSize + (compressed ? prefix.size() : 0);
+    if (keySize == 0 || keySize > 4096) {  // 限制键大小
+        LOG_ERROR(QString("Invalid key size: %1").arg(keySize));
+        return false;
+    }
+
+    QByteArray stored(storedSize, '\0');
+    if (storedSize > 0 && stream.readRawData(stored.data(), storedSize) != storedSize) {
+        LOG_ERROR("Failed to read key data");
+        return false;
+    }
+
+    if (!compressed || prefix.isEmpty()) {
+        key = stored;
+        return true;
+    }
+
+    if (storedSize < headerSize) {
+        LOG_ERROR(QString("Compressed key shorter than type header: %1").arg(storedSize));
+        return false;
+    }
+
+    key = stored.left(headerSize);
+    key.append(prefix);
+    key.append(stored.constData() + headerSize, storedSize - headerSize);
+    return true;
+}
+
+/**
+ * @brief 把键编码为压缩格式的存储形式：类型头 + 去掉节点前缀后的剩余部分
+ */
+static void writeNodeKey(QDataStream& stream, const QByteArray& key, const QByteArray& prefix, int headerSize) {
+    int skip = prefix.isEmpty() ? 0 : prefix.size();
+    int head = prefix.isEmpty() ? 0 : headerSize;
+    int storedSize = key.size() - skip;
+    stream << static_cast<uint16_t>(storedSize);
+    stream.writeRawData(key.constData(), head);
+    stream.writeRawData(key.constData() + head + skip, storedSize - head);
+}
+
 bool GenericBPlusTree::readLeafEntries(Page* page, QVector<KeyValuePair>& entries) {
     entries.clear();
 
@@ -886,23 +1575,23 @@ bool GenericBPlusTree::readLeafEntries(Page* page, QVector<KeyValuePair>& entrie
     QDataStream stream(QByteArray::fromRawData(data, PAGE_SIZE - sizeof(BPlusTreePageHeader)));
     stream.setByteOrder(QDataStream::LittleEndian);
 
+    // 前缀压缩格式：先读取节点公共前缀；旧格式页没有该字段
+    bool compressed = (header->flags & BPTREE_FLAG_PREFIX_COMPRESSED) != 0;
+    const int headerSize = keyHeaderSize();
+    QByteArray prefix;
+    if (compressed && !readNodePrefix(stream, prefix)) {
+        return false;
+    }
+
     // 读取条目数量
     uint16_t numKeys;
     stream >> numKeys;
+    entries.reserve(numKeys);
 
     // 读取每个键值对
     for (uint16_t i = 0; i < numKeys; ++i) {
-        uint16_t keySize;
-        stream >> keySize;
-
-        if (keySize == 0 || keySize > 4096) {  // 限制键大小
-            LOG_ERROR(QString("Invalid key size: %1").arg(keySize));
-            return false;
-        }
-
-        QByteArray key(keySize, '\0');
-        if (stream.readRawData(key.data(), keySize) != keySize) {
-            LOG_ERROR("Failed to read key data");
+        QByteArray key;
+        if (!readNodeKey(stream, prefix, headerSize, compressed, key)) {
             return false;
         }
 
@@ -923,28 +1612,32 @@ bool GenericBPlusTree::writeLeafEntries(Page* page, const QVector<KeyValuePair>&
     }
 
     // 计算所需空间
-    size_t totalSize = sizeof(uint16_t);  // 条目数量
-    for (const auto& entry : entries) {
-        totalSize += sizeof(uint16_t);  // 键大小
-        totalSize += entry.serializedKey.size();  // 键数据
-        totalSize += sizeof(RowId);  // 值
-    }
-
-    if (static_cast<size_t>(totalSize) > PAGE_SIZE - sizeof(BPlusTreePageHeader)) {
+    size_t totalSize = encodedLeafSize(entries);
+    if (totalSize > PAGE_SIZE - sizeof(BPlusTreePageHeader)) {
         LOG_ERROR(QString("Leaf entries too large: %1 bytes").arg(totalSize));
         return false;
     }
 
-    // 写入数据
+    QVector<QByteArray> keys;
+    keys.reserve(entries.size());
+    for (const auto& entry : entries) {
+        keys.append(entry.serializedKey);
+    }
+    QByteArray prefix = computeNodePrefix(keys);
+
+    // 写入数据：公共前缀只存一次，每个条目只存后缀
     QByteArray buffer;
+    buffer.reserve(static_cast<int>(totalSize));
     QDataStream stream(&buffer, QIODevice::WriteOnly);
     stream.setByteOrder(QDataStream::LittleEndian);
 
+    stream << static_cast<uint16_t>(prefix.size());
+    stream.writeRawData(prefix.constData(), prefix.size());
     stream << static_cast<uint16_t>(entries.size());
 
+    const int headerSize = keyHeaderSize();
     for (const auto& entry : entries) {
-        stream << static_cast<uint16_t>(entry.serializedKey.size());
-        stream.writeRawData(entry.serializedKey.constData(), entry.serializedKey.size());
+        writeNodeKey(stream, entry.serializedKey, prefix, headerSize);
         stream << entry.value;
     }
 
@@ -952,6 +1645,11 @@ bool GenericBPlusTree::writeLeafEntries(Page* page, const QVector<KeyValuePair>&
     char* data = page->getData() + sizeof(BPlusTreePageHeader);
     memcpy(data, buffer.constData(), buffer.size());
 
+    header->flags |= BPTREE_FLAG_PREFIX_COMPRESSED;
+    if (normalizedKeys_) {
+        header->flags |= BPTREE_FLAG_NORMALIZED_KEYS;
+    }
+    header->flags |= valueFlags_;
     header->numKeys = entries.size();
 
     return true;
@@ -971,26 +1669,25 @@ bool GenericBPlusTree::readInternalEntries(Page* page, QVector<InternalEntry>& e
     QDataStream stream(QByteArray::fromRawData(data, PAGE_SIZE - sizeof(BPlusTreePageHeader)));
     stream.setByteOrder(QDataStream::LittleEndian);
 
+    bool compressed = (header->flags & BPTREE_FLAG_PREFIX_COMPRESSED) != 0;
+    const int headerSize = keyHeaderSize();
+    QByteArray prefix;
+    if (compressed && !readNodePrefix(stream, prefix)) {
+        return false;
+    }
+
     // 读取第一个子节点
     stream >> firstChild;
 
     // 读取条目数量
     uint16_t numKeys;
     stream >> numKeys;
+    entries.reserve(numKeys);
 
     // 读取每个条目
     for (uint16_t i = 0; i < numKeys; ++i) {
-        uint16_t keySize;
-        stream >> keySize;
-
-        if (keySize == 0 || keySize > 4096) {
-            LOG_ERROR(QString("Invalid key size: %1").arg(keySize));
-            return false;
-        }
-
-        QByteArray key(keySize, '\0');
-        if (stream.readRawData(key.data(), keySize) != keySize) {
-            LOG_ERROR("Failed to read key data");
+        QByteArray key;
+        if (!readNodeKey(stream, prefix, headerSize, compressed, key)) {
             return false;
         }
 
@@ -1011,29 +1708,33 @@ bool GenericBPlusTree::writeInternalEntries(Page* page, const QVector<InternalEn
     }
 
     // 计算所需空间
-    size_t totalSize = sizeof(PageId) + sizeof(uint16_t);  // firstChild + 条目数量
-    for (const auto& entry : entries) {
-        totalSize += sizeof(uint16_t);  // 键大小
-        totalSize += entry.serializedKey.size();  // 键数据
-        totalSize += sizeof(PageId);  // 子页面ID
-    }
-
-    if (static_cast<size_t>(totalSize) > PAGE_SIZE - sizeof(BPlusTreePageHeader)) {
+    size_t totalSize = encodedInternalSize(entries);
+    if (totalSize > PAGE_SIZE - sizeof(BPlusTreePageHeader)) {
         LOG_ERROR(QString("Internal entries too large: %1 bytes").arg(totalSize));
         return false;
     }
 
+    QVector<QByteArray> keys;
+    keys.reserve(entries.size());
+    for (const auto& entry : entries) {
+        keys.append(entry.serializedKey);
+    }
+    QByteArray prefix = computeNodePrefix(keys);
+
     // 写入数据
     QByteArray buffer;
+    buffer.reserve(static_cast<int>(totalSize));
     QDataStream stream(&buffer, QIODevice::WriteOnly);
     stream.setByteOrder(QDataStream::LittleEndian);
 
+    stream << static_cast<uint16_t>(prefix.size());
+    stream.writeRawData(prefix.constData(), prefix.size());
     stream << firstChild;
     stream << static_cast<uint16_t>(entries.size());
 
+    const int headerSize = keyHeaderSize();
     for (const auto& entry : entries) {
-        stream << static_cast<uint16_t>(entry.serializedKey.size());
-        stream.writeRawData(entry.serializedKey.constData(), entry.serializedKey.size());
+        writeNodeKey(stream, entry.serializedKey, prefix, headerSize);
         stream << entry.childPageId;
     }
 
@@ -1041,11 +1742,93 @@ bool GenericBPlusTree::writeInternalEntries(Page* page, const QVector<InternalEn
     char* data = page->getData() + sizeof(BPlusTreePageHeader);
     memcpy(data, buffer.constData(), buffer.size());
 
+    header->flags |= BPTREE_FLAG_PREFIX_COMPRESSED;
+    if (normalizedKeys_) {
+        header->flags |= BPTREE_FLAG_NORMALIZED_KEYS;
+    }
+    header->flags |= valueFlags_;
     header->numKeys = entries.size();
 
     return true;
 }
 
+/**
+ * @brief 计算最短分隔键（后缀截断）
+ * @param leftKey 左侧节点的最大键
+ * @param rightKey 右侧节点的最小键
+ * @return 满足 leftKey < sep <= rightKey 的尽可能短的键
+ *
+ * 说明：
+ * - 分隔键是某个值的完整编码，与叶子中的键一样能按 keyType 解码
+ * - 字符串键：取 rightKey 的最短前缀，使其仍大于 leftKey，再按原格式编码（带结束标记）；
+ *   不拆分代理对。截断后的值编码后仍须落在 (leftKey, rightKey] 内，
+ *   否则（如 CHAR 编码时去掉了尾部空白）直接返回 rightKey
+ * - 二进制键：按字节做同样的截断
+ * - 旧格式的 CHAR 比较前会去除空白，截断可能改变语义；定长类型截断没有收益，直接返回 rightKey
+ * - 保序编码但不能按 keyType 解码的键（CompositeIndex 写入的复合键）只有写入方知道怎么解释，
+ *   按字节取 rightKey 在第一个与 leftKey 不同的字节处的前缀
+ */
+QByteArray GenericBPlusTree::shortestSeparator(const QByteArray& leftKey, const QByteArray& rightKey) {
+    QVariant left;
+    QVariant right;
+    if (normalizedKeys_) {
+        if (!KeyEncoder::decode(leftKey, keyType_, left) || !KeyEncoder::decode(rightKey, keyType_, right)) {
+            int lcp = commonPrefixLength(leftKey, leftKey.size(), rightKey);
+            if (lcp + 1 >= rightKey.size()) {
+                return rightKey;
+            }
+            return rightKey.left(lcp + 1);
+        }
+    } else if (keyType_ == DataType::CHAR) {
+        return rightKey;
+    }
+
+    if (!isStringType(keyType_) && !isBinaryType(keyType_)) {
+        return rightKey;
+    }
+
+    if (!normalizedKeys_) {
+        left = deserializeKey(leftKey);
+        right = deserializeKey(rightKey);
+    }
+    if (left.isNull() || right.isNull()) {
+        return rightKey;
+    }
+
+    QVariant separator;
+    if (isStringType(keyType_)) {
+        QString l = left.toString();
+        QString r = right.toString();
+        int lcp = 0;
+        while (lcp < l.size() && lcp < r.size() && l[lcp] == r[lcp]) {
+            ++lcp;
+        }
+        int len = lcp + 1;
+        if (len < r.size() && r[lcp].isHighSurrogate()) {
+            ++len;  // 保持代理对完整，否则 UTF-8 编码会失真
+        }
+        if (len >= r.size()) {
+            return rightKey;
+        }
+        separator = r.left(len);
+    } else {
+        QByteArray l = left.toByteArray();
+        QByteArray r = right.toByteArray();
+        int lcp = commonPrefixLength(l, l.size(), r);
+        if (lcp + 1 >= r.size()) {
+            return rightKey;
+        }
+        separator = r.left(lcp + 1);
+    }
+
+    QByteArray serialized = serializeKey(separator);
+    if (serialized.isEmpty() || serialized.size() >= rightKey.size() ||
+        compareKeys(serialized, leftKey) <= 0 || compareKeys(serialized, rightKey) > 0) {
+        return rightKey;
+    }
+    return serialized;
+}
+
 // ============ 查找辅助函数 ============
 
 int GenericBPlusTree::findKeyPositionInLeaf(const QVector<KeyValuePair>& entries, const QByteArray& key) {
@@ -1074,21 +1857,25 @@ int GenericBPlusTree::findKeyPositionInLeaf(const QVector<KeyValuePair>& entries
  * @return 子节点的位置索引
  *
  * 算法说明：
- * 线性扫描，找到第一个大于key的分隔键
+ * 二分查找第一个大于key的分隔键（upper bound）
  * 返回值：
  * - 0: 进入第一个子节点（firstChild）
  * - i: 进入entries[i-1].childPageId
  */
 int GenericBPlusTree::findChildPosition(const QVector<InternalEntry>& entries, const QByteArray& key) {
-    // 查找应该进入哪个子节点
-    int pos = 0;
-    for (int i = 0; i < entries.size(); ++i) {
-        if (compareKeys(key, entries[i].serializedKey) < 0) {
-            break;
+    int left = 0;
+    int right = entries.size();
+
+    while (left < right) {
+        int mid = (left + right) / 2;
+        if (compareKeys(key, entries[mid].serializedKey) < 0) {
+            right = mid;
+        } else {
+            left = mid + 1;
         }
-        pos = i + 1;
     }
-    return pos;
+
+    return left;
 }
 
 // ============ 统计和调试 ============
@@ -1097,8 +1884,9 @@ int GenericBPlusTree::findChildPosition(const QVector<InternalEntry>& entries, c
  * @brief 获取B+树的统计信息
  * @return Stats结构，包含树的各种统计数据
  *
- * 注意：当前为简化实现，返回空统计信息
- * TODO: 实现完整的统计功能，需要遍历整棵树
+ * 实现说明：
+ * 从根节点开始逐层遍历（层序），统计每层的页数；
+ * 叶子层额外累计键数和键数据大小
  */
 GenericBPlusTree::Stats GenericBPlusTree::getStats() const {
     QMutexLocker locker(&mutex_);
@@ -1110,12 +1898,102 @@ GenericBPlusTree::Stats GenericBPlusTree::getStats() const {
     stats.treeHeight = 0;
     stats.totalKeySize = 0;
 
-    // TODO: 实现完整的统计功能
-    // 需要遍历整棵树
+    // readLeafEntries/readInternalEntries 不修改树结构，这里与 printTreeRecursive 一样使用 const_cast
+    GenericBPlusTree* self = const_cast<GenericBPlusTree*>(this);
+
+    QVector<PageId> currentLevel;
+    if (rootPageId_ != INVALID_PAGE_ID) {
+        currentLevel.append(rootPageId_);
+    }
+
+    while (!currentLevel.isEmpty()) {
+        stats.treeHeight++;
+        QVector<PageId> nextLevel;
+
+        for (PageId pageId : currentLevel) {
+            Page* page = bufferPoolManager_->fetchPage(pageId);
+            if (!page) {
+                continue;
+            }
+
+            BPlusTreePageHeader* header = reinterpret_cast<BPlusTreePageHeader*>(page->getData());
+            if (header->nodeType == BPlusTreeNodeType::LEAF_NODE) {
+                QVector<KeyValuePair> entries;
+                if (self->readLeafEntries(page, entries)) {
+                    stats.numLeafPages++;
+                    stats.numKeys += entries.size();
+                    for (const auto& entry : entries) {
+                        stats.totalKeySize += entry.serializedKey.size();
+                    }
+                }
+            } else {
+                QVector<InternalEntry> entries;
+                PageId firstChild;
+                if (self->readInternalEntries(page, entries, firstChild)) {
+                    stats.numInternalPages++;
+                    nextLevel.append(firstChild);
+                    for (const auto& entry : entries) {
+                        nextLevel.append(entry.childPageId);
+                    }
+                }
+            }
+
+            bufferPoolManager_->unpinPage(pageId, false);
+        }
+
+        currentLevel = nextLevel;
+    }
 
     return stats;
 }
 
+bool GenericBPlusTree::getSeparatorKeys(QVector<QVariant>& keys) const {
+    QMutexLocker locker(&mutex_);
+    keys.clear();
+
+    GenericBPlusTree* self = const_cast<GenericBPlusTree*>(this);
+    QVector<PageId> currentLevel;
+    if (rootPageId_ != INVALID_PAGE_ID) {
+        currentLevel.append(rootPageId_);
+    }
+
+    while (!currentLevel.isEmpty()) {
+        QVector<PageId> nextLevel;
+        for (PageId pageId : currentLevel) {
+            Page* page = bufferPoolManager_->fetchPage(pageId);
+            if (!page) {
+                return false;
+            }
+
+            BPlusTreePageHeader* header = reinterpret_cast<BPlusTreePageHeader*>(page->getData());
+            bool ok = true;
+            if (header->nodeType == BPlusTreeNodeType::INTERNAL_NODE) {
+                QVector<InternalEntry> entries;
+                PageId firstChild;
+                ok = self->readInternalEntries(page, entries, firstChild);
+                if (ok) {
+                    nextLevel.append(firstChild);
+                }
+                for (const auto& entry : entries) {
+                    QVariant key = self->deserializeKey(entry.serializedKey);
+                    if (key.isNull()) {
+                        ok = false;
+                        break;
+                    }
+                    keys.append(key);
+                    nextLevel.append(entry.childPageId);
+                }
+            }
+            bufferPoolManager_->unpinPage(pageId, false);
+            if (!ok) {
+                return false;
+            }
+        }
+        currentLevel = nextLevel;
+    }
+    return true;
+}
+
 /**
  * @brief 打印B+树的结构（用于调试）
  *
@@ -1422,7 +2300,8 @@ bool GenericBPlusTree::borrowFromLeftSiblingLeaf(PageId nodePageId, PageId leftS
 
     // 更新分隔键
     if (keyIndexInParent > 0 && keyIndexInParent - 1 < parentEntries.size()) {
-        parentEntries[keyIndexInParent - 1].serializedKey = nodeEntries.first().serializedKey;
+        parentEntries[keyIndexInParent - 1].serializedKey =
+            shortestSeparator(leftEntries.last().serializedKey, nodeEntries.first().serializedKey);
     }
 
     bool success = writeInternalEntries(parentPage, parentEntries, firstChild);
@@ -1507,7 +2386,8 @@ bool GenericBPlusTree::borrowFromRightSiblingLeaf(PageId nodePageId, PageId righ
 
     // 更新分隔键
     if (keyIndexInParent < parentEntries.size()) {
-        parentEntries[keyIndexInParent].serializedKey = rightEntries.first().serializedKey;
+        parentEntries[keyIndexInParent].serializedKey =
+            shortestSeparator(nodeEntries.last().serializedKey, rightEntries.first().serializedKey);
     }
 
     bool success = writeInternalEntries(parentPage, parentEntries, firstChild);
@@ -1551,8 +2431,11 @@ bool GenericBPlusTree::mergeWithLeftSiblingLeaf(PageId nodePageId, PageId leftSi
     PageId nodeNext = nodeHeader->nextPageId;
     bufferPoolManager_->unpinPage(nodePageId, false);
 
-    // 合并：将当前节点的所有键移到左兄弟
+    // 合并：将当前节点的所有键移到左兄弟（变长键合并后可能放不下一页）
     leftEntries.append(nodeEntries);
+    if (encodedLeafSize(leftEntries) > PAGE_SIZE - sizeof(BPlusTreePageHeader)) {
+        return false;
+    }
 
     // 写回左兄弟
     leftPage = bufferPoolManager_->fetchPage(leftSiblingPageId);
@@ -1577,7 +2460,7 @@ bool GenericBPlusTree::mergeWithLeftSiblingLeaf(PageId nodePageId, PageId leftSi
     }
 
     // 从父节点删除分隔键
-    if (!deleteKeyFromInternal(parentPageId, nodeEntries.first().serializedKey)) {
+    if (!deleteChildFromInternal(parentPageId, nodePageId)) {
         LOG_WARN("Failed to delete key from parent after merge");
     }
 
@@ -1623,8 +2506,11 @@ bool GenericBPlusTree::mergeWithRightSiblingLeaf(PageId nodePageId, PageId right
     PageId rightNext = rightHeader->nextPageId;
     bufferPoolManager_->unpinPage(rightSiblingPageId, false);
 
-    // 合并
+    // 合并（变长键合并后可能放不下一页）
     nodeEntries.append(rightEntries);
+    if (encodedLeafSize(nodeEntries) > PAGE_SIZE - sizeof(BPlusTreePageHeader)) {
+        return false;
+    }
 
     // 写回当前节点
     nodePage = bufferPoolManager_->fetchPage(nodePageId);
@@ -1649,7 +2535,7 @@ bool GenericBPlusTree::mergeWithRightSiblingLeaf(PageId nodePageId, PageId right
     }
 
     // 从父节点删除分隔键
-    if (!deleteKeyFromInternal(parentPageId, rightEntries.first().serializedKey)) {
+    if (!deleteChildFromInternal(parentPageId, rightSiblingPageId)) {
         LOG_WARN("Failed to delete key from parent after merge");
     }
 
@@ -1661,7 +2547,7 @@ bool GenericBPlusTree::mergeWithRightSiblingLeaf(PageId nodePageId, PageId right
     return true;
 }
 
-bool GenericBPlusTree::deleteKeyFromInternal(PageId internalPageId, const QByteArray& serializedKey) {
+bool GenericBPlusTree::deleteChildFromInternal(PageId internalPageId, PageId childPageId) {
     Page* page = bufferPoolManager_->fetchPage(internalPageId);
     if (!page) {
         return false;
@@ -1674,10 +2560,10 @@ bool GenericBPlusTree::deleteKeyFromInternal(PageId internalPageId, const QByteA
         return false;
     }
 
-    // 查找并删除键
+    // 按子节点页ID定位条目：分隔键经过后缀截断后不一定等于子节点的第一个键
     bool found = false;
     for (int i = 0; i < entries.size(); ++i) {
-        if (compareKeys(entries[i].serializedKey, serializedKey) == 0) {
+        if (entries[i].childPageId == childPageId) {
             entries.remove(i);
             found = true;
             break;
@@ -28,20 +28,8 @@ bool HashBucketPage::insert(Page* page, const QByteArray& key, RowId value) {
         return false;
     }
 
-    // Check if key already exists (update value)
-    RowId existingValue;
-    if (search(page, key, existingValue)) {
-        // Key exists, update is not supported in hash index
-        // (would require finding and modifying the existing entry)
-        return false;
-    }
-
-    // Check if page has enough space
-    if (isFull(page, key.size())) {
-        return false;
-    }
-
-    // Get current number of entries
+    // Duplicate keys are stored side by side in the same page (non-unique index);
+    // searchAll() collects all of them.
     uint32_t numEntries = getNumEntries(page);
 
     // Find insert position (after header and existing entries)
@@ -52,7 +40,12 @@ bool HashBucketPage::insert(Page* page, const QByteArray& key, RowId value) {
     for (uint32_t i = 0; i < numEntries; i++) {
         uint32_t keySize;
         memcpy(&keySize, data + offset, KEY_SIZE_FIELD);
-        offset += KEY_SIZE_FIELD + keySize + VALUE_SIZE_FIELD + VALUE_DATA_SIZE;
+        offset += entrySize(keySize);
+    }
+
+    // Check if page has enough space
+    if (offset + entrySize(key.size()) > HEADER_SIZE + MAX_ENTRY_SPACE) {
+        return false;
     }
 
     // Write new entry
@@ -1,40 +1,91 @@
 #include "qindb/hash_index.h"
 #include "qindb/hash_bucket_page.h"
 #include "qindb/logger.h"
-#include <QCryptographicHash>
 #include <QMutexLocker>
+#include <algorithm>
 #include <cstring>
 
 namespace qindb {
 
+namespace {
+
+// 目录页布局：64 字节头 + 桶页ID数组
+// 头（第一个目录页）：magic(4) version(4) initialBuckets(4) level(4) splitPointer(4)
+//                    numBuckets(4) numEntries(8) entryBytes(8) nextDirectoryPageId(4)
+//                    hashFunction(4) hashSeed(8) reserved(8)
+// 后续目录页只使用 nextDirectoryPageId 字段
+constexpr uint32_t DIRECTORY_MAGIC = 0x48534851;  // "QHSH"
+constexpr uint32_t DIRECTORY_VERSION = 1;
+constexpr size_t DIR_MAGIC_OFFSET = 0;
+constexpr size_t DIR_VERSION_OFFSET = 4;
+constexpr size_t DIR_INITIAL_BUCKETS_OFFSET = 8;
+constexpr size_t DIR_LEVEL_OFFSET = 12;
+constexpr size_t DIR_SPLIT_POINTER_OFFSET = 16;
+constexpr size_t DIR_NUM_BUCKETS_OFFSET = 20;
+constexpr size_t DIR_NUM_ENTRIES_OFFSET = 24;
+constexpr size_t DIR_ENTRY_BYTES_OFFSET = 32;
+constexpr size_t DIR_NEXT_PAGE_OFFSET = 40;
+constexpr size_t DIR_HASH_FUNCTION_OFFSET = 44;  // 0 = SHA-256，旧目录此处为 0
+constexpr size_t DIR_HASH_SEED_OFFSET = 48;
+constexpr size_t DIR_HEADER_SIZE = 64;
+constexpr uint32_t DIR_SLOTS_PER_PAGE = static_cast<uint32_t>((PAGE_SIZE - DIR_HEADER_SIZE) / sizeof(PageId));
+
+template <typename T>
+T readField(const char* data, size_t offset) {
+    T value;
+    memcpy(&value, data + offset, sizeof(T));
+    return value;
+}
+
+template <typename T>
+void writeField(char* data, size_t offset, T value) {
+    memcpy(data + offset, &value, sizeof(T));
+}
+
+} // namespace
+
 HashIndex::HashIndex(const QString& indexName,
                      DataType keyType,
                      BufferPoolManager* bufferPool,
-                     uint32_t numBuckets)
+                     uint32_t numBuckets,
+                     HashFunction hashFunction)
     : indexName_(indexName)
     , keyType_(keyType)
     , bufferPool_(bufferPool)
-    , numBuckets_(numBuckets)
+    , hashFunction_(hashFunction)
+    , hashSeed_(0)
+    , initialBuckets_(numBuckets)
+    , level_(0)
+    , splitPointer_(0)
+    , numEntries_(0)
+    , entryBytes_(0)
     , directoryPageId_(INVALID_PAGE_ID)
+    , metadataDirty_(false)
 {
     // Ensure numBuckets is a power of 2
-    if ((numBuckets & (numBuckets - 1)) != 0) {
+    if (numBuckets == 0 || (numBuckets & (numBuckets - 1)) != 0) {
         // Round up to next power of 2
-        numBuckets_ = 1;
-        while (numBuckets_ < numBuckets) {
-            numBuckets_ <<= 1;
+        initialBuckets_ = 1;
+        while (initialBuckets_ < numBuckets) {
+            initialBuckets_ <<= 1;
         }
         LOG_WARN(QString("HashIndex: Adjusted bucket count from %1 to %2 (power of 2)")
-                     .arg(numBuckets).arg(numBuckets_));
+                     .arg(numBuckets).arg(initialBuckets_));
     }
 
+    buckets_.fill(INVALID_PAGE_ID, static_cast<int>(initialBuckets_));
+
     LOG_INFO(QString("HashIndex created: %1, keyType=%2, numBuckets=%3")
                  .arg(indexName_)
                  .arg(static_cast<int>(keyType_))
-                 .arg(numBuckets_));
+                 .arg(initialBuckets_));
 }
 
 HashIndex::~HashIndex() {
+    QMutexLocker locker(&mutex_);
+    if (metadataDirty_) {
+        writeMetadata();
+    }
     LOG_INFO(QString("HashIndex destroyed: %1").arg(indexName_));
 }
 
@@ -52,65 +103,25 @@ bool HashIndex::insert(const QVariant& key, RowId value) {
         return false;
     }
 
-    // Calculate hash and bucket index
-    uint32_t bucketIndex = hash(serializedKey);
-
-    // Get bucket page ID
-    PageId bucketPageId = getBucketPageId(bucketIndex);
-    if (bucketPageId == INVALID_PAGE_ID) {
-        LOG_ERROR(QString("HashIndex::insert: Failed to get bucket page for index %1")
-                      .arg(bucketIndex));
-        return false;
+    if (directoryPageId_ == INVALID_PAGE_ID) {
+        initializeDirectory();
+        if (directoryPageId_ == INVALID_PAGE_ID) {
+            LOG_ERROR("HashIndex::insert: Failed to create directory");
+            return false;
+        }
     }
 
-    // Try to insert into bucket page
-    Page* page = bufferPool_->fetchPage(bucketPageId);
-    if (!page) {
-        LOG_ERROR(QString("HashIndex::insert: Failed to fetch bucket page %1")
-                      .arg(bucketPageId));
+    uint32_t bucketIndex = bucketIndexOf(hash(serializedKey));
+    if (!insertIntoBucket(bucketIndex, serializedKey, value)) {
         return false;
     }
 
-    bool inserted = HashBucketPage::insert(page, serializedKey, value);
+    numEntries_++;
+    entryBytes_ += HashBucketPage::entrySize(serializedKey.size());
+    metadataDirty_ = true;
 
-    // If bucket is full, try overflow pages
-    if (!inserted) {
-        PageId currentPageId = bucketPageId;
-        while (!inserted) {
-            PageId nextPageId = HashBucketPage::getNextBucketPageId(page);
-
-            if (nextPageId == INVALID_PAGE_ID) {
-                // Create new overflow page
-                nextPageId = createOverflowPage();
-                if (nextPageId == INVALID_PAGE_ID) {
-                    bufferPool_->unpinPage(currentPageId, false);
-                    LOG_ERROR("HashIndex::insert: Failed to create overflow page");
-                    return false;
-                }
-
-                // Link overflow page
-                HashBucketPage::setNextBucketPageId(page, nextPageId);
-                bufferPool_->unpinPage(currentPageId, true);
-            } else {
-                bufferPool_->unpinPage(currentPageId, false);
-            }
-
-            // Fetch overflow page
-            currentPageId = nextPageId;
-            page = bufferPool_->fetchPage(currentPageId);
-            if (!page) {
-                LOG_ERROR(QString("HashIndex::insert: Failed to fetch overflow page %1")
-                              .arg(currentPageId));
-                return false;
-            }
-
-            inserted = HashBucketPage::insert(page, serializedKey, value);
-        }
-
-        bufferPool_->unpinPage(currentPageId, true);
-    } else {
-        bufferPool_->unpinPage(bucketPageId, true);
-    }
+    // 线性哈希：装载率过高时分裂一个桶（分裂中会写回元数据）
+    maybeSplit();
 
     return true;
 }
@@ -128,48 +139,21 @@ bool HashIndex::search(const QVariant& key, RowId& value) {
         return false;
     }
 
-    // Calculate hash and bucket index
-    uint32_t bucketIndex = hash(serializedKey);
-
-    // Get bucket page ID
-    PageId bucketPageId = getBucketPageId(bucketIndex);
-    if (bucketPageId == INVALID_PAGE_ID) {
-        return false;
-    }
-
-    // Search in bucket page
-    Page* page = bufferPool_->fetchPage(bucketPageId);
-    if (!page) {
-        return false;
-    }
+    // 空桶没有页面，直接返回未找到
+    PageId currentPageId = getBucketPageId(bucketIndexOf(hash(serializedKey)), false);
+    bool found = false;
 
-    bool found = HashBucketPage::search(page, serializedKey, value);
-
-    // If not found, search in overflow pages
-    if (!found) {
-        PageId currentPageId = bucketPageId;
-        while (!found) {
-            PageId nextPageId = HashBucketPage::getNextBucketPageId(page);
-            bufferPool_->unpinPage(currentPageId, false);
-
-            if (nextPageId == INVALID_PAGE_ID) {
-                break;
-            }
-
-            currentPageId = nextPageId;
-            page = bufferPool_->fetchPage(currentPageId);
-            if (!page) {
-                break;
-            }
-
-            found = HashBucketPage::search(page, serializedKey, value);
+    // Search bucket page and its overflow chain
+    while (!found && currentPageId != INVALID_PAGE_ID) {
+        Page* page = bufferPool_->fetchPage(currentPageId);
+        if (!page) {
+            break;
         }
 
-        if (page) {
-            bufferPool_->unpinPage(currentPageId, false);
-        }
-    } else {
-        bufferPool_->unpinPage(bucketPageId, false);
+        found = HashBucketPage::search(page, serializedKey, value);
+        PageId nextPageId = HashBucketPage::getNextBucketPageId(page);
+        bufferPool_->unpinPage(currentPageId, false);
+        currentPageId = nextPageId;
     }
 
     return found;
@@ -188,35 +172,12 @@ bool HashIndex::searchAll(const QVariant& key, std::vector<RowId>& values) {
         return false;
     }
 
-    // Calculate hash and bucket index
-    uint32_t bucketIndex = hash(serializedKey);
-
-    // Get bucket page ID
-    PageId bucketPageId = getBucketPageId(bucketIndex);
-    if (bucketPageId == INVALID_PAGE_ID) {
-        return false;
-    }
-
-    // Search in bucket page
-    Page* page = bufferPool_->fetchPage(bucketPageId);
-    if (!page) {
-        return false;
-    }
-
-    bool found = HashBucketPage::searchAll(page, serializedKey, values);
-
-    // Search in overflow pages
-    PageId currentPageId = bucketPageId;
-    while (true) {
-        PageId nextPageId = HashBucketPage::getNextBucketPageId(page);
-        bufferPool_->unpinPage(currentPageId, false);
-
-        if (nextPageId == INVALID_PAGE_ID) {
-            break;
-        }
+    PageId currentPageId = getBucketPageId(bucketIndexOf(hash(serializedKey)), false);
+    bool found = false;
 
-        currentPageId = nextPageId;
-        page = bufferPool_->fetchPage(currentPageId);
+    // Search bucket page and all overflow pages
+    while (currentPageId != INVALID_PAGE_ID) {
+        Page* page = bufferPool_->fetchPage(currentPageId);
         if (!page) {
             break;
         }
@@ -224,6 +185,9 @@ bool HashIndex::searchAll(const QVariant& key, std::vector<RowId>& values) {
         if (HashBucketPage::searchAll(page, serializedKey, values)) {
             found = true;
         }
+        PageId nextPageId = HashBucketPage::getNextBucketPageId(page);
+        bufferPool_->unpinPage(currentPageId, false);
+        currentPageId = nextPageId;
     }
 
     return found;
@@ -242,48 +206,17 @@ bool HashIndex::remove(const QVariant& key, RowId value) {
         return false;
     }
 
-    // Calculate hash and bucket index
-    uint32_t bucketIndex = hash(serializedKey);
-
-    // Get bucket page ID
-    PageId bucketPageId = getBucketPageId(bucketIndex);
-    if (bucketPageId == INVALID_PAGE_ID) {
-        return false;
-    }
-
-    // Try to remove from bucket page
-    Page* page = bufferPool_->fetchPage(bucketPageId);
-    if (!page) {
-        return false;
-    }
-
-    bool removed = HashBucketPage::remove(page, serializedKey, value);
-
-    // If not removed, try overflow pages
-    if (!removed) {
-        PageId currentPageId = bucketPageId;
-        while (!removed) {
-            PageId nextPageId = HashBucketPage::getNextBucketPageId(page);
-            bufferPool_->unpinPage(currentPageId, false);
-
-            if (nextPageId == INVALID_PAGE_ID) {
-                break;
-            }
-
-            currentPageId = nextPageId;
-            page = bufferPool_->fetchPage(currentPageId);
-            if (!page) {
-                break;
-            }
-
-            removed = HashBucketPage::remove(page, serializedKey, value);
+    bool removed = removeFromBucket(bucketIndexOf(hash(serializedKey)), serializedKey, value);
+    if (removed) {
+        if (numEntries_ > 0) {
+            numEntries_--;
         }
+        uint64_t bytes = HashBucketPage::entrySize(serializedKey.size());
+        entryBytes_ = entryBytes_ > bytes ? entryBytes_ - bytes : 0;
+        metadataDirty_ = true;
 
-        if (page) {
-            bufferPool_->unpinPage(currentPageId, removed);
-        }
-    } else {
-        bufferPool_->unpinPage(bucketPageId, true);
+        // 线性哈希：装载率过低时合并一个桶（合并中会写回元数据）
+        maybeMerge();
     }
 
     return removed;
@@ -293,111 +226,301 @@ HashIndex::Statistics HashIndex::getStatistics() const {
     QMutexLocker locker(&mutex_);
 
     Statistics stats;
-    stats.numBuckets = numBuckets_;
+    stats.numBuckets = static_cast<uint32_t>(buckets_.size());
     stats.numEntries = 0;
     stats.numOverflowPages = 0;
     stats.avgBucketSize = 0.0;
     stats.loadFactor = 0.0;
+    stats.level = level_;
+    stats.splitPointer = splitPointer_;
+    stats.maxChainLength = 0;
+    stats.avgChainLength = 0.0;
+    stats.numDirectoryPages = static_cast<uint32_t>(directoryPages_.size());
 
     if (directoryPageId_ == INVALID_PAGE_ID) {
         return stats;
     }
 
-    // Iterate through all buckets
-    for (uint32_t i = 0; i < numBuckets_; i++) {
-        PageId bucketPageId = const_cast<HashIndex*>(this)->getBucketPageId(i);
-        if (bucketPageId == INVALID_PAGE_ID) {
-            continue;
-        }
-
-        Page* page = bufferPool_->fetchPage(bucketPageId);
-        if (!page) {
-            continue;
-        }
-
-        stats.numEntries += HashBucketPage::getNumEntries(page);
-
-        // Count overflow pages
+    // Walk every bucket chain
+    uint32_t nonEmptyBuckets = 0;
+    uint64_t totalChainPages = 0;
+    for (PageId bucketPageId : buckets_) {
+        uint32_t chainLength = 0;
         PageId currentPageId = bucketPageId;
-        while (true) {
-            PageId nextPageId = HashBucketPage::getNextBucketPageId(page);
-            bufferPool_->unpinPage(currentPageId, false);
-
-            if (nextPageId == INVALID_PAGE_ID) {
-                break;
-            }
-
-            stats.numOverflowPages++;
-            currentPageId = nextPageId;
-            page = bufferPool_->fetchPage(currentPageId);
+        while (currentPageId != INVALID_PAGE_ID) {
+            Page* page = bufferPool_->fetchPage(currentPageId);
             if (!page) {
                 break;
             }
 
             stats.numEntries += HashBucketPage::getNumEntries(page);
+            chainLength++;
+            PageId nextPageId = HashBucketPage::getNextBucketPageId(page);
+            bufferPool_->unpinPage(currentPageId, false);
+            currentPageId = nextPageId;
+        }
+
+        if (chainLength > 0) {
+            nonEmptyBuckets++;
+            totalChainPages += chainLength;
+            stats.numOverflowPages += chainLength - 1;
+            stats.maxChainLength = std::max(stats.maxChainLength, chainLength);
         }
     }
 
-    stats.avgBucketSize = static_cast<double>(stats.numEntries) / numBuckets_;
-    stats.loadFactor = stats.avgBucketSize;
+    if (stats.numBuckets > 0) {
+        stats.avgBucketSize = static_cast<double>(stats.numEntries) / stats.numBuckets;
+        stats.loadFactor = static_cast<double>(entryBytes_) / bucketCapacityBytes();
+    }
+    if (nonEmptyBuckets > 0) {
+        stats.avgChainLength = static_cast<double>(totalChainPages) / nonEmptyBuckets;
+    }
 
     return stats;
 }
 
 uint32_t HashIndex::hash(const QByteArray& key) const {
-    // Use SHA-256 hash and take first 4 bytes
-    QByteArray hashValue = QCryptographicHash::hash(key, QCryptographicHash::Sha256);
-    uint32_t hashInt;
-    memcpy(&hashInt, hashValue.constData(), sizeof(hashInt));
+    return HashUtil::hash32(hashFunction_, key, hashSeed_);
+}
 
-    // Use modulo to get bucket index (works because numBuckets_ is power of 2)
-    return hashInt & (numBuckets_ - 1);
+uint32_t HashIndex::bucketIndexOf(uint32_t hashValue) const {
+    // 桶数都是 2 的幂，取模即按位与
+    const uint32_t roundBuckets = initialBuckets_ << level_;
+    uint32_t bucketIndex = hashValue & (roundBuckets - 1);
+    if (bucketIndex < splitPointer_) {
+        // 本轮已经分裂过的桶，用下一轮的掩码定位
+        bucketIndex = hashValue & ((roundBuckets << 1) - 1);
+    }
+    return bucketIndex;
 }
 
-PageId HashIndex::getBucketPageId(uint32_t bucketIndex) {
-    if (bucketIndex >= numBuckets_) {
+PageId HashIndex::getBucketPageId(uint32_t bucketIndex, bool create) {
+    if (bucketIndex >= static_cast<uint32_t>(buckets_.size())) {
         return INVALID_PAGE_ID;
     }
 
-    // If directory doesn't exist, create it
-    if (directoryPageId_ == INVALID_PAGE_ID) {
-        initializeDirectory();
-        if (directoryPageId_ == INVALID_PAGE_ID) {
-            return INVALID_PAGE_ID;
-        }
+    PageId bucketPageId = buckets_[bucketIndex];
+    if (bucketPageId != INVALID_PAGE_ID || !create) {
+        return bucketPageId;
     }
 
-    // Fetch directory page
-    Page* dirPage = bufferPool_->fetchPage(directoryPageId_);
-    if (!dirPage) {
+    // 桶页按需创建
+    Page* bucketPage = bufferPool_->newPage(&bucketPageId);
+    if (!bucketPage) {
         return INVALID_PAGE_ID;
     }
 
-    // Read bucket page ID from directory
-    char* data = dirPage->getData();
-    PageId bucketPageId;
-    memcpy(&bucketPageId, data + bucketIndex * sizeof(PageId), sizeof(PageId));
-
-    // If bucket doesn't exist, create it
-    if (bucketPageId == INVALID_PAGE_ID) {
-        Page* bucketPage = bufferPool_->newPage(&bucketPageId);
-        if (!bucketPage) {
-            bufferPool_->unpinPage(directoryPageId_, false);
-            return INVALID_PAGE_ID;
+    HashBucketPage::initialize(bucketPage);
+    bufferPool_->unpinPage(bucketPageId, true);
+
+    buckets_[bucketIndex] = bucketPageId;
+    writeBucketSlot(bucketIndex);
+
+    return bucketPageId;
+}
+
+bool HashIndex::insertIntoBucket(uint32_t bucketIndex, const QByteArray& serializedKey, RowId value) {
+    PageId currentPageId = getBucketPageId(bucketIndex, true);
+    if (currentPageId == INVALID_PAGE_ID) {
+        LOG_ERROR(QString("HashIndex::insert: Failed to get bucket page for index %1")
+                      .arg(bucketIndex));
+        return false;
+    }
+
+    while (true) {
+        Page* page = bufferPool_->fetchPage(currentPageId);
+        if (!page) {
+            LOG_ERROR(QString("HashIndex::insert: Failed to fetch bucket page %1")
+                          .arg(currentPageId));
+            return false;
         }
 
-        // Initialize bucket page
-        HashBucketPage::initialize(bucketPage);
-        bufferPool_->unpinPage(bucketPageId, true);
+        if (HashBucketPage::insert(page, serializedKey, value)) {
+            bufferPool_->unpinPage(currentPageId, true);
+            return true;
+        }
 
-        // Update directory
-        memcpy(data + bucketIndex * sizeof(PageId), &bucketPageId, sizeof(PageId));
-        bufferPool_->unpinPage(directoryPageId_, true);
-    } else {
-        bufferPool_->unpinPage(directoryPageId_, false);
+        // Page is full, move on to (or create) the next overflow page
+        PageId nextPageId = HashBucketPage::getNextBucketPageId(page);
+        if (nextPageId == INVALID_PAGE_ID) {
+            nextPageId = createOverflowPage();
+            if (nextPageId == INVALID_PAGE_ID) {
+                bufferPool_->unpinPage(currentPageId, false);
+                LOG_ERROR("HashIndex::insert: Failed to create overflow page");
+                return false;
+            }
+
+            // Link overflow page
+            HashBucketPage::setNextBucketPageId(page, nextPageId);
+            bufferPool_->unpinPage(currentPageId, true);
+        } else {
+            bufferPool_->unpinPage(currentPageId, false);
+        }
+
+        currentPageId = nextPageId;
     }
+}
 
-    return bucketPageId;
+bool HashIndex::removeFromBucket(uint32_t bucketIndex, const QByteArray& serializedKey, RowId value) {
+    PageId currentPageId = getBucketPageId(bucketIndex, false);
+    bool removed = false;
+
+    // Try bucket page first, then overflow pages
+    while (!removed && currentPageId != INVALID_PAGE_ID) {
+        Page* page = bufferPool_->fetchPage(currentPageId);
+        if (!page) {
+            break;
+        }
+
+        removed = HashBucketPage::remove(page, serializedKey, value);
+        PageId nextPageId = HashBucketPage::getNextBucketPageId(page);
+        bufferPool_->unpinPage(currentPageId, removed);
+        currentPageId = nextPageId;
+    }
+
+    return removed;
+}
+
+bool HashIndex::readChain(PageId firstPageId, std::vector<std::pair<QByteArray, RowId>>& entries,
+                          QVector<PageId>& chainPages) {
+    PageId currentPageId = firstPageId;
+    while (currentPageId != INVALID_PAGE_ID) {
+        Page* page = bufferPool_->fetchPage(currentPageId);
+        if (!page) {
+            LOG_ERROR(QString("HashIndex: Failed to fetch bucket page %1").arg(currentPageId));
+            return false;
+        }
+
+        auto pageEntries = HashBucketPage::getAll(page);
+        entries.insert(entries.end(), pageEntries.begin(), pageEntries.end());
+        chainPages.append(currentPageId);
+        PageId nextPageId = HashBucketPage::getNextBucketPageId(page);
+        bufferPool_->unpinPage(currentPageId, false);
+        currentPageId = nextPageId;
+    }
+    return true;
+}
+
+void HashIndex::freeChain(const QVector<PageId>& chainPages) {
+    for (PageId pageId : chainPages) {
+        bufferPool_->deletePage(pageId);
+    }
+}
+
+void HashIndex::maybeSplit() {
+    if (static_cast<double>(entryBytes_) <= SPLIT_FILL * bucketCapacityBytes()) {
+        return;
+    }
+
+    // 分裂 splitPointer_ 指向的桶，新桶追加在末尾
+    const uint32_t roundBuckets = initialBuckets_ << level_;
+    const uint32_t oldIndex = splitPointer_;
+    const uint32_t newIndex = oldIndex + roundBuckets;
+    const uint32_t oldLevel = level_;
+
+    std::vector<std::pair<QByteArray, RowId>> entries;
+    QVector<PageId> oldChain;
+    if (!readChain(buckets_[oldIndex], entries, oldChain)) {
+        return;
+    }
+
+    // 旧桶链先摘下但不释放：条目都写进新链之后再释放，中途失败时还能恢复
+    const PageId oldFirstPageId = buckets_[oldIndex];
+    buckets_[oldIndex] = INVALID_PAGE_ID;
+    buckets_.append(INVALID_PAGE_ID);
+    splitPointer_++;
+    if (splitPointer_ == roundBuckets) {
+        // 本轮所有桶都已分裂，进入下一轮
+        level_++;
+        splitPointer_ = 0;
+    }
+
+    // 按新的掩码把条目分配到旧桶或新桶
+    bool moved = true;
+    for (const auto& entry : entries) {
+        if (!insertIntoBucket(bucketIndexOf(hash(entry.first)), entry.first, entry.second)) {
+            moved = false;
+            break;
+        }
+    }
+
+    if (!moved) {
+        LOG_ERROR(QString("HashIndex: Failed to move entries while splitting bucket %1, split undone").arg(oldIndex));
+        std::vector<std::pair<QByteArray, RowId>> partial;
+        QVector<PageId> newChains;
+        readChain(buckets_[oldIndex], partial, newChains);
+        readChain(buckets_[newIndex], partial, newChains);
+        freeChain(newChains);
+
+        buckets_[newIndex] = INVALID_PAGE_ID;
+        writeBucketSlot(newIndex);
+        buckets_.removeLast();
+        buckets_[oldIndex] = oldFirstPageId;
+        level_ = oldLevel;
+        splitPointer_ = oldIndex;
+        writeBucketSlot(oldIndex);
+        return;
+    }
+
+    writeBucketSlot(oldIndex);
+    writeBucketSlot(newIndex);
+    writeMetadata();
+    freeChain(oldChain);
+}
+
+void HashIndex::maybeMerge() {
+    if (static_cast<uint32_t>(buckets_.size()) <= initialBuckets_ ||
+        static_cast<double>(entryBytes_) >= MERGE_FILL * bucketCapacityBytes()) {
+        return;
+    }
+
+    // 撤销最近一次分裂：把最后一个桶并回它的“兄弟”桶
+    const uint32_t oldLevel = level_;
+    const uint32_t oldSplitPointer = splitPointer_;
+    if (splitPointer_ == 0) {
+        level_--;
+        splitPointer_ = initialBuckets_ << level_;
+    }
+    splitPointer_--;
+    const uint32_t targetIndex = splitPointer_;
+    const uint32_t lastIndex = static_cast<uint32_t>(buckets_.size()) - 1;
+
+    std::vector<std::pair<QByteArray, RowId>> entries;
+    QVector<PageId> lastChain;
+    if (!readChain(buckets_[lastIndex], entries, lastChain)) {
+        level_ = oldLevel;
+        splitPointer_ = oldSplitPointer;
+        return;
+    }
+
+    // 条目都并入目标桶之后才摘下并释放最后一个桶；中途失败时删掉已并入的条目
+    size_t movedCount = 0;
+    for (const auto& entry : entries) {
+        if (!insertIntoBucket(targetIndex, entry.first, entry.second)) {
+            break;
+        }
+        movedCount++;
+    }
+
+    if (movedCount < entries.size()) {
+        LOG_ERROR(QString("HashIndex: Failed to move entries while merging bucket %1, merge undone").arg(lastIndex));
+        for (size_t i = 0; i < movedCount; ++i) {
+            removeFromBucket(targetIndex, entries[i].first, entries[i].second);
+        }
+        level_ = oldLevel;
+        splitPointer_ = oldSplitPointer;
+        return;
+    }
+
+    buckets_[lastIndex] = INVALID_PAGE_ID;
+    writeBucketSlot(lastIndex);
+    buckets_.removeLast();
+    writeMetadata();
+    freeChain(lastChain);
+}
+
+double HashIndex::bucketCapacityBytes() const {
+    return static_cast<double>(buckets_.size()) * HashBucketPage::capacity();
 }
 
 PageId HashIndex::createOverflowPage() {
@@ -414,23 +537,256 @@ PageId HashIndex::createOverflowPage() {
 }
 
 void HashIndex::initializeDirectory() {
+    // 种子只在新建目录时生成；加载已有索引时以目录中记录的为准，不必在构造时生成
+    if (hashFunction_ == HashFunction::WYHASH) {
+        hashSeed_ = HashUtil::randomSeed();
+    }
+
     Page* dirPage = bufferPool_->newPage(&directoryPageId_);
     if (!dirPage) {
         directoryPageId_ = INVALID_PAGE_ID;
         return;
     }
 
-    // Initialize directory with INVALID_PAGE_ID for all buckets
+    memset(dirPage->getData(), 0, PAGE_SIZE);
+    bufferPool_->unpinPage(directoryPageId_, true);
+
+    directoryPages_.clear();
+    directoryPages_.append(directoryPageId_);
+
+    // 元数据和已存在的桶页ID（目录创建前不会有桶页，这里都是 INVALID_PAGE_ID）
+    writeMetadata();
+    for (uint32_t i = 0; i < static_cast<uint32_t>(buckets_.size()); i++) {
+        if (buckets_[i] != INVALID_PAGE_ID) {
+            writeBucketSlot(i);
+        }
+    }
+
+    LOG_INFO(QString("HashIndex directory initialized: pageId=%1, numBuckets=%2")
+                 .arg(directoryPageId_).arg(buckets_.size()));
+}
+
+bool HashIndex::ensureDirectory() {
+    QMutexLocker locker(&mutex_);
+
+    if (directoryPageId_ == INVALID_PAGE_ID) {
+        initializeDirectory();
+    }
+    return directoryPageId_ != INVALID_PAGE_ID;
+}
+
+bool HashIndex::setDirectoryPageId(PageId pageId) {
+    QMutexLocker locker(&mutex_);
+
+    directoryPageId_ = pageId;
+    if (pageId == INVALID_PAGE_ID) {
+        return true;
+    }
+    return loadDirectory();
+}
+
+bool HashIndex::loadDirectory() {
+    Page* dirPage = bufferPool_->fetchPage(directoryPageId_);
+    if (!dirPage) {
+        LOG_ERROR(QString("HashIndex: Failed to fetch directory page %1").arg(directoryPageId_));
+        return false;
+    }
+
+    const char* data = dirPage->getData();
+    if (readField<uint32_t>(data, DIR_MAGIC_OFFSET) != DIRECTORY_MAGIC) {
+        bool upgraded = upgradeLegacyDirectory(dirPage);
+        bufferPool_->unpinPage(directoryPageId_, upgraded);
+        return upgraded && writeMetadata();
+    }
+
+    uint32_t version = readField<uint32_t>(data, DIR_VERSION_OFFSET);
+    if (version != DIRECTORY_VERSION) {
+        bufferPool_->unpinPage(directoryPageId_, false);
+        LOG_ERROR(QString("HashIndex: Unsupported directory version %1").arg(version));
+        return false;
+    }
+
+    initialBuckets_ = readField<uint32_t>(data, DIR_INITIAL_BUCKETS_OFFSET);
+    level_ = readField<uint32_t>(data, DIR_LEVEL_OFFSET);
+    splitPointer_ = readField<uint32_t>(data, DIR_SPLIT_POINTER_OFFSET);
+    uint32_t numBuckets = readField<uint32_t>(data, DIR_NUM_BUCKETS_OFFSET);
+    numEntries_ = readField<uint64_t>(data, DIR_NUM_ENTRIES_OFFSET);
+    entryBytes_ = readField<uint64_t>(data, DIR_ENTRY_BYTES_OFFSET);
+    uint32_t hashFunction = readField<uint32_t>(data, DIR_HASH_FUNCTION_OFFSET);
+    hashSeed_ = readField<uint64_t>(data, DIR_HASH_SEED_OFFSET);
+    bufferPool_->unpinPage(directoryPageId_, false);
+
+    if (!HashUtil::isKnownFunction(hashFunction)) {
+        LOG_ERROR(QString("HashIndex: Unknown hash function %1 in directory of %2")
+                      .arg(hashFunction).arg(indexName_));
+        return false;
+    }
+    hashFunction_ = static_cast<HashFunction>(hashFunction);
+
+    if (numBuckets != (initialBuckets_ << level_) + splitPointer_) {
+        LOG_ERROR(QString("HashIndex: Corrupted directory page %1").arg(directoryPageId_));
+        return false;
+    }
+
+    // 沿目录页链读取桶页ID数组（缩小后保留的目录页也要记下，供再次增长使用）
+    buckets_.clear();
+    buckets_.reserve(static_cast<int>(numBuckets));
+    directoryPages_.clear();
+    PageId currentPageId = directoryPageId_;
+    while (currentPageId != INVALID_PAGE_ID) {
+        Page* page = bufferPool_->fetchPage(currentPageId);
+        if (!page) {
+            LOG_ERROR(QString("HashIndex: Failed to fetch directory page %1").arg(currentPageId));
+            return false;
+        }
+
+        directoryPages_.append(currentPageId);
+        const char* pageData = page->getData();
+        uint32_t slots = std::min(DIR_SLOTS_PER_PAGE, numBuckets - static_cast<uint32_t>(buckets_.size()));
+        for (uint32_t i = 0; i < slots; i++) {
+            buckets_.append(readField<PageId>(pageData, DIR_HEADER_SIZE + i * sizeof(PageId)));
+        }
+
+        PageId nextPageId = readField<PageId>(pageData, DIR_NEXT_PAGE_OFFSET);
+        bufferPool_->unpinPage(currentPageId, false);
+        currentPageId = nextPageId;
+    }
+
+    if (static_cast<uint32_t>(buckets_.size()) != numBuckets) {
+        LOG_ERROR(QString("HashIndex: Directory of %1 is truncated").arg(indexName_));
+        return false;
+    }
+
+    LOG_INFO(QString("HashIndex loaded: %1, numBuckets=%2, level=%3, splitPointer=%4, entries=%5, hash=%6")
+                 .arg(indexName_).arg(numBuckets).arg(level_).arg(splitPointer_).arg(numEntries_)
+                 .arg(static_cast<uint32_t>(hashFunction_)));
+    return true;
+}
+
+bool HashIndex::upgradeLegacyDirectory(Page* dirPage) {
+    // 旧格式：页首即为 numBuckets 个桶页ID，桶数固定为构造时的 numBuckets
+    // 旧版桶地址是 hash & (numBuckets - 1)，与 level 0 的线性哈希一致
+    if (initialBuckets_ > DIR_SLOTS_PER_PAGE) {
+        LOG_ERROR(QString("HashIndex: Legacy directory with %1 buckets cannot be upgraded in place")
+                      .arg(initialBuckets_));
+        return false;
+    }
+
     char* data = dirPage->getData();
-    for (uint32_t i = 0; i < numBuckets_; i++) {
-        PageId invalidPageId = INVALID_PAGE_ID;
-        memcpy(data + i * sizeof(PageId), &invalidPageId, sizeof(PageId));
+    QVector<PageId> legacyBuckets;
+    legacyBuckets.reserve(static_cast<int>(initialBuckets_));
+    for (uint32_t i = 0; i < initialBuckets_; i++) {
+        legacyBuckets.append(readField<PageId>(data, i * sizeof(PageId)));
+    }
+
+    // 旧索引的桶分布由 SHA-256 决定
+    hashFunction_ = HashFunction::SHA256;
+    hashSeed_ = 0;
+    level_ = 0;
+    splitPointer_ = 0;
+    buckets_ = legacyBuckets;
+    directoryPages_.clear();
+    directoryPages_.append(directoryPageId_);
+
+    // 重新统计条目数和字节数
+    numEntries_ = 0;
+    entryBytes_ = 0;
+    for (PageId bucketPageId : buckets_) {
+        PageId currentPageId = bucketPageId;
+        while (currentPageId != INVALID_PAGE_ID) {
+            Page* page = bufferPool_->fetchPage(currentPageId);
+            if (!page) {
+                return false;
+            }
+            for (const auto& entry : HashBucketPage::getAll(page)) {
+                numEntries_++;
+                entryBytes_ += HashBucketPage::entrySize(entry.first.size());
+            }
+            PageId nextPageId = HashBucketPage::getNextBucketPageId(page);
+            bufferPool_->unpinPage(currentPageId, false);
+            currentPageId = nextPageId;
+        }
+    }
+
+    // 原地改写为新格式：桶数组移到 64 字节头之后，元数据由调用方写回
+    memset(data, 0, PAGE_SIZE);
+    for (uint32_t i = 0; i < initialBuckets_; i++) {
+        writeField<PageId>(data, DIR_HEADER_SIZE + i * sizeof(PageId), buckets_[i]);
+    }
+
+    LOG_INFO(QString("HashIndex: Upgraded legacy directory of %1 (%2 buckets, %3 entries)")
+                 .arg(indexName_).arg(initialBuckets_).arg(numEntries_));
+    return true;
+}
+
+bool HashIndex::writeMetadata() {
+    if (directoryPageId_ == INVALID_PAGE_ID) {
+        return false;
+    }
+
+    Page* dirPage = bufferPool_->fetchPage(directoryPageId_);
+    if (!dirPage) {
+        LOG_ERROR(QString("HashIndex: Failed to fetch directory page %1").arg(directoryPageId_));
+        return false;
     }
 
+    char* data = dirPage->getData();
+    writeField<uint32_t>(data, DIR_MAGIC_OFFSET, DIRECTORY_MAGIC);
+    writeField<uint32_t>(data, DIR_VERSION_OFFSET, DIRECTORY_VERSION);
+    writeField<uint32_t>(data, DIR_INITIAL_BUCKETS_OFFSET, initialBuckets_);
+    writeField<uint32_t>(data, DIR_LEVEL_OFFSET, level_);
+    writeField<uint32_t>(data, DIR_SPLIT_POINTER_OFFSET, splitPointer_);
+    writeField<uint32_t>(data, DIR_NUM_BUCKETS_OFFSET, static_cast<uint32_t>(buckets_.size()));
+    writeField<uint64_t>(data, DIR_NUM_ENTRIES_OFFSET, numEntries_);
+    writeField<uint64_t>(data, DIR_ENTRY_BYTES_OFFSET, entryBytes_);
+    writeField<uint32_t>(data, DIR_HASH_FUNCTION_OFFSET, static_cast<uint32_t>(hashFunction_));
+    writeField<uint64_t>(data, DIR_HASH_SEED_OFFSET, hashSeed_);
     bufferPool_->unpinPage(directoryPageId_, true);
+    metadataDirty_ = false;
+    return true;
+}
 
-    LOG_INFO(QString("HashIndex directory initialized: pageId=%1, numBuckets=%2")
-                 .arg(directoryPageId_).arg(numBuckets_));
+bool HashIndex::writeBucketSlot(uint32_t bucketIndex) {
+    if (directoryPageId_ == INVALID_PAGE_ID) {
+        return true;  // 目录创建时会写入全部桶
+    }
+
+    const int dirIndex = static_cast<int>(bucketIndex / DIR_SLOTS_PER_PAGE);
+    const uint32_t slot = bucketIndex % DIR_SLOTS_PER_PAGE;
+
+    // 需要时在目录页链末尾追加新目录页（缩小时保留已分配的目录页，供再次增长使用）
+    while (directoryPages_.size() <= dirIndex) {
+        PageId newPageId;
+        Page* newPage = bufferPool_->newPage(&newPageId);
+        if (!newPage) {
+            LOG_ERROR("HashIndex: Failed to allocate directory page");
+            return false;
+        }
+        memset(newPage->getData(), 0, PAGE_SIZE);
+        bufferPool_->unpinPage(newPageId, true);
+
+        PageId lastPageId = directoryPages_.last();
+        Page* lastPage = bufferPool_->fetchPage(lastPageId);
+        if (!lastPage) {
+            return false;
+        }
+        writeField<PageId>(lastPage->getData(), DIR_NEXT_PAGE_OFFSET, newPageId);
+        bufferPool_->unpinPage(lastPageId, true);
+
+        directoryPages_.append(newPageId);
+    }
+
+    // 目录页链可能比当前桶数长（缩小后再增长），其后续页已存在
+    PageId dirPageId = directoryPages_[dirIndex];
+    Page* page = bufferPool_->fetchPage(dirPageId);
+    if (!page) {
+        LOG_ERROR(QString("HashIndex: Failed to fetch directory page %1").arg(dirPageId));
+        return false;
+    }
+
+    writeField<PageId>(page->getData(), DIR_HEADER_SIZE + slot * sizeof(PageId), buckets_[bucketIndex]);
+    bufferPool_->unpinPage(dirPageId, true);
+    return true;
 }
 
 QByteArray HashIndex::serializeKey(const QVariant& key) const {
@@ -0,0 +1,159 @@
+#include "qindb/int_key_search.h"
+#include "qindb/cpu_features.h"
+#include <atomic>
+#include <bit>
+#include <cstring>
+
+#ifdef QINDB_HAS_AVX2
+#include <immintrin.h>
+#endif
+
+namespace qindb {
+
+namespace {
+
+// 二分缩小到不超过该数量的窗口后改为计数（16 个 16 字节条目 = 4 个缓存行）
+constexpr int SEARCH_WINDOW = 16;
+
+// setAvx2Allowed 的开关
+std::atomic<bool> avx2Allowed{true};
+
+#ifdef QINDB_HAS_AVX2
+
+bool useAvx2() {
+    return CpuFeatures::hasAvx2() && avx2Allowed.load(std::memory_order_relaxed);
+}
+
+/**
+ * @brief 统计窗口内 < key（orEqual 时为 <= key）的键个数
+ *
+ * stride 为 8 时一次加载 4 个键；stride 为 16 时一次加载 2 个条目，只取键所在的 0、2 号通道。
+ */
+QINDB_TARGET_AVX2
+int countBelowAvx2(const char* base, int count, size_t stride, int64_t key, bool orEqual) {
+    // orEqual: k <= key  <=>  k < key + 1（key 为最大值时全部满足）
+    if (orEqual) {
+        if (key == INT64_MAX) {
+            return count;
+        }
+        ++key;
+    }
+
+    const __m256i needle = _mm256_set1_epi64x(key);
+    int result = 0;
+    int i = 0;
+
+    if (stride == sizeof(int64_t)) {
+        for (; i + 4 <= count; i += 4) {
+            __m256i keys = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(base + i * stride));
+            __m256i less = _mm256_cmpgt_epi64(needle, keys);
+            result += std::popcount(static_cast<unsigned>(_mm256_movemask_pd(_mm256_castsi256_pd(less))));
+        }
+    } else if (stride == 2 * sizeof(int64_t)) {
+        for (; i + 2 <= count; i += 2) {
+            __m256i keys = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(base + i * stride));
+            __m256i less = _mm256_cmpgt_epi64(needle, keys);
+            int mask = _mm256_movemask_pd(_mm256_castsi256_pd(less)) & 0x5;
+            result += (mask & 1) + (mask >> 2);
+        }
+    }
+
+    for (; i < count; ++i) {
+        result += IntKeySearch::keyAt(base, stride, i) < key ? 1 : 0;
+    }
+    return result;
+}
+
+#endif // QINDB_HAS_AVX2
+
+int countBelowScalar(const char* base, int count, size_t stride, int64_t key, bool orEqual) {
+    int result = 0;
+    for (int i = 0; i < count; ++i) {
+        int64_t k = IntKeySearch::keyAt(base, stride, i);
+        result += (orEqual ? k <= key : k < key) ? 1 : 0;
+    }
+    return result;
+}
+
+/**
+ * @brief 无分支二分缩小范围 + 窗口内计数
+ *
+ * 不变式：答案始终位于 [lo, lo + len] 内，且窗口外左侧的键都满足条件、右侧的都不满足。
+ */
+int searchImpl(const char* base, int count, size_t stride, int64_t key, bool orEqual) {
+    int lo = 0;
+    int len = count;
+    while (len > SEARCH_WINDOW) {
+        int half = len / 2;
+        int64_t probe = IntKeySearch::keyAt(base, stride, lo + half);
+        bool below = orEqual ? probe <= key : probe < key;
+        lo += below ? half : 0;
+        len -= half;
+    }
+
+    const char* window = base + static_cast<size_t>(lo) * stride;
+#ifdef QINDB_HAS_AVX2
+    if (useAvx2()) {
+        return lo + countBelowAvx2(window, len, stride, key, orEqual);
+    }
+#endif
+    return lo + countBelowScalar(window, len, stride, key, orEqual);
+}
+
+} // namespace
+
+int64_t IntKeySearch::keyAt(const char* base, size_t stride, int index) {
+    int64_t key;
+    std::memcpy(&key, base + static_cast<size_t>(index) * stride, sizeof(key));
+    return key;
+}
+
+int IntKeySearch::lowerBound(const char* base, int count, size_t stride, int64_t key) {
+    return searchImpl(base, count, stride, key, false);
+}
+
+int IntKeySearch::upperBound(const char* base, int count, size_t stride, int64_t key) {
+    return searchImpl(base, count, stride, key, true);
+}
+
+int IntKeySearch::lowerBoundScalar(const char* base, int count, size_t stride, int64_t key) {
+    int left = 0;
+    int right = count;
+    while (left < right) {
+        int mid = (left + right) / 2;
+        if (keyAt(base, stride, mid) < key) {
+            left = mid + 1;
+        } else {
+            right = mid;
+        }
+    }
+    return left;
+}
+
+int IntKeySearch::upperBoundScalar(const char* base, int count, size_t stride, int64_t key) {
+    int left = 0;
+    int right = count;
+    while (left < right) {
+        int mid = (left + right) / 2;
+        if (keyAt(base, stride, mid) <= key) {
+            left = mid + 1;
+        } else {
+            right = mid;
+        }
+    }
+    return left;
+}
+
+bool IntKeySearch::isAvx2Enabled() {
+#ifdef QINDB_HAS_AVX2
+    return useAvx2();
+#else
+    return false;
+#endif
+}
+
+void IntKeySearch::setAvx2Allowed(bool allowed) {
+    avx2Allowed.store(allowed, std::memory_order_relaxed);
+}
+
+} // namespace qindb
@@ -1,11 +1,286 @@
 #include "qindb/inverted_index.h"
+#include "qindb/posting_intersection.h"
 #include "qindb/logger.h"
 #include <QMutexLocker>
 #include <QtMath>
 #include <algorithm>
+#include <cstring>
+#include <limits>
+#include <numeric>
 
 namespace qindb {
 
+namespace {
+
+constexpr RowId END_OF_LIST = std::numeric_limits<RowId>::max();
+
+// 得分上界放大一点，抵消浮点舍入，保证剪枝不会漏掉真正的前 k 名
+constexpr double BOUND_SLACK = 1.0 + 1e-9;
+
+struct BufferedPosting {
+    RowId docId;
+    uint32_t tf;
+    uint32_t docLength;
+};
+
+/**
+ * @brief WAND 使用的倒排游标：缓冲区中的一个倒排列表，或某个段中的一个倒排列表
+ *
+ * 段游标自动跳过段内已删除的文档；缓冲区列表整体视为一个块。
+ */
+class WandCursor {
+public:
+    WandCursor(int termIndex, QVector<BufferedPosting> postings)
+        : termIndex_(termIndex)
+        , segment_(nullptr)
+        , buffered_(std::move(postings))
+        , position_(-1)
+        , docId_(INVALID_ROW_ID)
+        , maxTf_(0)
+        , minDocLength_(0)
+        , upperBound_(0.0)
+    {
+        std::sort(buffered_.begin(), buffered_.end(), [](const BufferedPosting& a, const BufferedPosting& b) {
+            return a.docId < b.docId;
+        });
+        for (const BufferedPosting& posting : buffered_) {
+            maxTf_ = std::max(maxTf_, posting.tf);
+            minDocLength_ = minDocLength_ == 0 ? posting.docLength : std::min(minDocLength_, posting.docLength);
+        }
+    }
+
+    WandCursor(int termIndex, BufferPoolManager* bufferPool, const InvertedSegment* segment, const TermInfo& info)
+        : termIndex_(termIndex)
+        , segment_(segment)
+        , cursor_(std::make_unique<PostingCursor>(bufferPool, info))
+        , position_(-1)
+        , docId_(INVALID_ROW_ID)
+        , maxTf_(info.maxTf)
+        , minDocLength_(info.minDocLength)
+        , upperBound_(0.0)
+    {
+    }
+
+    int termIndex() const { return termIndex_; }
+    RowId docId() const { return docId_; }
+    uint32_t maxTf() const { return maxTf_; }
+    uint32_t minDocLength() const { return minDocLength_; }
+
+    double upperBound() const { return upperBound_; }
+    void setUpperBound(double bound) { upperBound_ = bound; }
+
+    uint32_t tf() const { return segment_ ? cursor_->tf() : buffered_[position_].tf; }
+    uint32_t docLength() const { return segment_ ? cursor_->docLength() : buffered_[position_].docLength; }
+
+    /**
+     * @brief 前进到下一个文档，列表结束时 docId() 为 END_OF_LIST
+     */
+    void next() {
+        if (segment_) {
+            docId_ = cursor_->next() ? cursor_->docId() : END_OF_LIST;
+            skipDeleted();
+        } else {
+            position_++;
+            docId_ = position_ < buffered_.size() ? buffered_[position_].docId : END_OF_LIST;
+        }
+    }
+
+    /**
+     * @brief 前进到第一个 >= target 的文档
+     */
+    void advance(RowId target) {
+        if (docId_ != INVALID_ROW_ID && docId_ >= target) {
+            return;
+        }
+        if (segment_) {
+            docId_ = cursor_->advance(target) ? cursor_->docId() : END_OF_LIST;
+            skipDeleted();
+        } else {
+            auto it = std::lower_bound(buffered_.constBegin() + std::max<qsizetype>(position_, 0), buffered_.constEnd(),
+                                       target, [](const BufferedPosting& posting, RowId value) {
+                                           return posting.docId < value;
+                                       });
+            position_ = it - buffered_.constBegin();
+            docId_ = position_ < buffered_.size() ? buffered_[position_].docId : END_OF_LIST;
+        }
+    }
+
+    /**
+     * @brief 定位包含 target 的块（不解码），返回块的 (最大tf, 最短文档长度) 和块尾文档ID
+     * @return false 之后没有文档
+     */
+    bool shallowAdvance(RowId target, uint32_t& maxTf, uint32_t& minDocLength, RowId& blockLast) {
+        if (segment_) {
+            if (!cursor_->skipToBlock(target)) {
+                return false;
+            }
+            maxTf = cursor_->blockMaxTf();
+            minDocLength = cursor_->blockMinDocLength();
+            blockLast = cursor_->blockLastDocId();
+            return true;
+        }
+        if (buffered_.isEmpty() || buffered_.constLast().docId < target) {
+            return false;
+        }
+        maxTf = maxTf_;
+        minDocLength = minDocLength_;
+        blockLast = buffered_.constLast().docId;
+        return true;
+    }
+
+private:
+    void skipDeleted() {
+        while (docId_ != END_OF_LIST && segment_->isDeleted(docId_)) {
+            docId_ = cursor_->next() ? cursor_->docId() : END_OF_LIST;
+        }
+    }
+
+    int termIndex_;
+    const InvertedSegment* segment_;
+    std::unique_ptr<PostingCursor> cursor_;
+    QVector<BufferedPosting> buffered_;
+    qsizetype position_;
+    RowId docId_;
+    uint32_t maxTf_;
+    uint32_t minDocLength_;
+    double upperBound_;         // 整个列表的得分上界
+};
+
+/**
+ * @brief 按文档ID递增读取一个词项在文档中的位置（缓冲区 + 各段）
+ *
+ * 段游标用跳表和块头定位候选所在的块，只有这些块的位置数据会被读取和解码。
+ */
+class PositionReader {
+public:
+    PositionReader(const QString& term, const QMap<QString, PostingList>& buffer, BufferPoolManager* bufferPool,
+                   const std::vector<std::unique_ptr<InvertedSegment>>& segments)
+        : position_(0)
+    {
+        auto listIt = buffer.constFind(term);
+        if (listIt != buffer.constEnd()) {
+            for (const Posting& posting : listIt->postings) {
+                buffered_.append(&posting);
+            }
+            std::sort(buffered_.begin(), buffered_.end(), [](const Posting* a, const Posting* b) {
+                return a->docId < b->docId;
+            });
+        }
+
+        for (const auto& segment : segments) {
+            TermInfo info;
+            if (segment->findTerm(term, info)) {
+                sources_.push_back({segment.get(), std::make_unique<PostingCursor>(bufferPool, info), false});
+            }
+        }
+    }
+
+    /**
+     * @brief 取词项在 docId 中的位置，docId 必须单调递增
+     * @return false 文档中没有该词项
+     */
+    bool fetch(RowId docId, const uint32_t*& data, uint32_t& count) {
+        while (position_ < buffered_.size() && buffered_[position_]->docId < docId) {
+            position_++;
+        }
+        if (position_ < buffered_.size() && buffered_[position_]->docId == docId) {
+            const QVector<uint32_t>& positions = buffered_[position_]->positions;
+            data = positions.constData();
+            count = static_cast<uint32_t>(positions.size());
+            return true;
+        }
+
+        // 文档的未删除版本最多在一个段中
+        for (Source& source : sources_) {
+            const InvertedSegmentMeta& meta = source.segment->meta();
+            if (source.exhausted || docId < meta.minDocId || docId > meta.maxDocId ||
+                source.segment->isDeleted(docId)) {
+                continue;
+            }
+            if (!source.cursor->advance(docId)) {
+                source.exhausted = true;
+                continue;
+            }
+            if (source.cursor->docId() == docId) {
+                return source.cursor->positions(data, count);
+            }
+        }
+        return false;
+    }
+
+private:
+    struct Source {
+        const InvertedSegment* segment;
+        std::unique_ptr<PostingCursor> cursor;
+        bool exhausted;
+    };
+
+    QVector<const Posting*> buffered_;
+    qsizetype position_;
+    std::vector<Source> sources_;
+};
+
+/**
+ * @brief 短语匹配：存在 p 使第 i 个列表含有 p + i
+ *
+ * 起点集合从第一个列表开始，逐个列表做有序归并收缩，集合为空时提前结束。
+ */
+bool matchPhrase(const QVector<const uint32_t*>& lists, const QVector<uint32_t>& counts) {
+    std::vector<uint32_t> starts(lists[0], lists[0] + counts[0]);
+    for (int i = 1; i < lists.size() && !starts.empty(); ++i) {
+        const uint32_t* list = lists[i];
+        const uint32_t count = counts[i];
+        const uint32_t shift = static_cast<uint32_t>(i);
+        uint32_t j = 0;
+        size_t kept = 0;
+        for (uint32_t start : starts) {
+            const uint64_t wanted = static_cast<uint64_t>(start) + shift;
+            while (j < count && list[j] < wanted) {
+                j++;
+            }
+            if (j == count) {
+                break;
+            }
+            if (list[j] == wanted) {
+                starts[kept++] = start;
+            }
+        }
+        starts.resize(kept);
+    }
+    return !starts.empty();
+}
+
+/**
+ * @brief 邻近匹配：两个有序位置列表中存在相距不超过 distance 的一对（同一个词时要求是不同的出现）
+ */
+bool matchNear(const uint32_t* a, uint32_t na, const uint32_t* b, uint32_t nb, uint32_t distance, bool sameTerm) {
+    if (sameTerm) {
+        for (uint32_t i = 1; i < na; ++i) {
+            if (a[i] - a[i - 1] <= distance) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    uint32_t i = 0;
+    uint32_t j = 0;
+    while (i < na && j < nb) {
+        const uint32_t gap = a[i] < b[j] ? b[j] - a[i] : a[i] - b[j];
+        if (gap <= distance) {
+            return true;
+        }
+        if (a[i] < b[j]) {
+            i++;
+        } else {
+            j++;
+        }
+    }
+    return false;
+}
+
+} // namespace
+
 InvertedIndex::InvertedIndex(const QString& indexName,
                              BufferPoolManager* bufferPool,
                              Tokenizer* tokenizer)
@@ -13,7 +288,10 @@ InvertedIndex::InvertedIndex(const QString& indexName,
     , bufferPool_(bufferPool)
     , tokenizer_(tokenizer)
     , ownTokenizer_(false)
+    , bufferedPostings_(0)
+    , nextSegmentId_(1)
     , totalDocuments_(0)
+    , totalLength_(0)
     , rootPageId_(INVALID_PAGE_ID)
 {
     // 如果没有提供分词器，创建默认分词器
@@ -32,62 +310,79 @@ InvertedIndex::~InvertedIndex() {
     LOG_INFO(QString("InvertedIndex destroyed: %1").arg(indexName_));
 }
 
+
 bool InvertedIndex::insert(RowId docId, const QString& text) {
     if (docId == INVALID_ROW_ID || text.isEmpty()) {
         return false;
     }
 
     QMutexLocker locker(&mutex_);
+    return insertLocked(docId, text);
+}
 
-    // 检查文档是否已存在
-    if (docLengths_.contains(docId)) {
+bool InvertedIndex::insertLocked(RowId docId, const QString& text) {
+    // 检查文档是否已存在（缓冲区或任一段中未删除的）
+    uint32_t existingLength = 0;
+    if (docLengths_.contains(docId) || findSegmentOf(docId, existingLength) >= 0) {
         LOG_WARN(QString("Document %1 already exists in index, use update() instead").arg(docId));
         return false;
     }
 
-    // 分词（保留重复词以计算词频）
-    QStringList tokens = tokenizer_->tokenizeWithDuplicates(text);
+    // 分词（保留重复词以计算词频），词项先以区间形式存在，每个不同的词只构造一次 QString
+    tokenizer_->tokenizeSpans(text, foldedText_, tokenSpans_);
 
-    if (tokens.isEmpty()) {
+    if (tokenSpans_.isEmpty()) {
         LOG_DEBUG(QString("No tokens extracted from document %1").arg(docId));
         return true;  // 空文档也算成功
     }
 
-    // 计算词频
-    QMap<QString, uint32_t> termFrequencies;
-    for (const QString& term : tokens) {
-        termFrequencies[term]++;
+    // 词位置（分词结果中的下标），个数即词频
+    QHash<QStringView, QVector<uint32_t>> spanPositions;
+    spanPositions.reserve(tokenSpans_.size());
+    for (int i = 0; i < tokenSpans_.size(); ++i) {
+        const Tokenizer::TokenSpan& span = tokenSpans_[i];
+        spanPositions[QStringView(foldedText_.constData() + span.offset, span.length)].append(static_cast<uint32_t>(i));
+    }
+
+    QMap<QString, QVector<uint32_t>> termPositions;
+    for (auto it = spanPositions.begin(); it != spanPositions.end(); ++it) {
+        termPositions.insert(it.key().toString(), std::move(it.value()));
     }
 
     // 文档长度（总词数）
-    uint32_t docLength = static_cast<uint32_t>(tokens.size());
+    uint32_t docLength = static_cast<uint32_t>(tokenSpans_.size());
     docLengths_[docId] = docLength;
+    docTerms_[docId] = termPositions.keys();
 
-    // 更新倒排索引
-    for (auto it = termFrequencies.constBegin(); it != termFrequencies.constEnd(); ++it) {
+    // 更新缓冲区中的倒排列表
+    for (auto it = termPositions.constBegin(); it != termPositions.constEnd(); ++it) {
         const QString& term = it.key();
-        uint32_t tf = it.value();
 
-        // 获取或创建倒排列表
-        if (!index_.contains(term)) {
-            index_[term] = PostingList(term);
+        auto listIt = index_.find(term);
+        if (listIt == index_.end()) {
+            listIt = index_.insert(term, PostingList(term));
         }
 
-        PostingList& postingList = index_[term];
-
-        // 添加倒排项
-        Posting posting(docId, tf);
-        postingList.postings.append(posting);
-        postingList.df++;
+        Posting posting(docId, static_cast<uint32_t>(it.value().size()));
+        posting.positions = it.value();
+        listIt->postings.append(posting);
+        listIt->df++;
+        bufferedPostings_++;
     }
 
     totalDocuments_++;
+    totalLength_ += docLength;
 
     LOG_DEBUG(QString("Inserted document %1: %2 unique terms, %3 total terms")
                  .arg(docId)
-                 .arg(termFrequencies.size())
+                 .arg(termPositions.size())
                  .arg(docLength));
 
+    // 缓冲区过大时写成段，内存占用保持有界
+    if (bufferPool_ && bufferedPostings_ >= FLUSH_THRESHOLD && !flushLocked()) {
+        LOG_WARN(QString("Failed to flush inverted index '%1', keeping documents in memory").arg(indexName_));
+    }
+
     return true;
 }
 
@@ -97,58 +392,80 @@ bool InvertedIndex::remove(RowId docId) {
     }
 
     QMutexLocker locker(&mutex_);
+    return removeLocked(docId);
+}
 
-    // 检查文档是否存在
-    if (!docLengths_.contains(docId)) {
-        LOG_WARN(QString("Document %1 not found in index").arg(docId));
-        return false;
-    }
+bool InvertedIndex::removeLocked(RowId docId) {
+    // 缓冲区中的文档直接删除
+    auto lengthIt = docLengths_.find(docId);
+    if (lengthIt != docLengths_.end()) {
+        for (const QString& term : docTerms_.value(docId)) {
+            auto listIt = index_.find(term);
+            if (listIt == index_.end()) {
+                continue;
+            }
 
-    // 从每个倒排列表中删除该文档
-    for (auto it = index_.begin(); it != index_.end();) {
-        PostingList& postingList = it.value();
+            QVector<Posting>& postings = listIt->postings;
+            for (int i = 0; i < postings.size(); ++i) {
+                if (postings[i].docId == docId) {
+                    postings.removeAt(i);
+                    listIt->df--;
+                    bufferedPostings_--;
+                    break;
+                }
+            }
 
-        // 查找并删除该文档的倒排项
-        for (int i = 0; i < postingList.postings.size(); ++i) {
-            if (postingList.postings[i].docId == docId) {
-                postingList.postings.removeAt(i);
-                postingList.df--;
-                break;
+            // 如果倒排列表为空，删除该词项
+            if (postings.isEmpty()) {
+                index_.erase(listIt);
             }
         }
 
-        // 如果倒排列表为空，删除该词项
-        if (postingList.postings.isEmpty()) {
-            it = index_.erase(it);
-        } else {
-            ++it;
-        }
+        totalLength_ -= lengthIt.value();
+        docLengths_.erase(lengthIt);
+        docTerms_.remove(docId);
+        totalDocuments_--;
+
+        LOG_DEBUG(QString("Removed document %1 from index buffer").arg(docId));
+        return true;
+    }
+
+    // 段中的文档只做删除标记，合并时丢弃
+    uint32_t docLength = 0;
+    int segmentIndex = findSegmentOf(docId, docLength);
+    if (segmentIndex < 0) {
+        LOG_DEBUG(QString("Document %1 not found in index").arg(docId));
+        return false;
     }
 
-    // 删除文档长度记录
-    docLengths_.remove(docId);
+    segments_[segmentIndex]->markDeleted(docId);
+    totalLength_ -= docLength;
     totalDocuments_--;
 
-    LOG_DEBUG(QString("Removed document %1 from index").arg(docId));
+    LOG_DEBUG(QString("Marked document %1 deleted in segment %2")
+                 .arg(docId)
+                 .arg(segments_[segmentIndex]->meta().segmentId));
 
     return true;
 }
 
 bool InvertedIndex::update(RowId docId, const QString& newText) {
+    if (docId == INVALID_ROW_ID) {
+        return false;
+    }
+
     QMutexLocker locker(&mutex_);
 
     // 先删除旧文档
-    locker.unlock();
-    bool removed = remove(docId);
-    locker.relock();
-
-    if (!removed) {
+    if (!removeLocked(docId)) {
         LOG_DEBUG(QString("Document %1 not found, treating update as insert").arg(docId));
     }
 
     // 插入新文档
-    locker.unlock();
-    return insert(docId, newText);
+    if (newText.isEmpty()) {
+        return true;
+    }
+    return insertLocked(docId, newText);
 }
 
 QVector<SearchResult> InvertedIndex::search(const QString& query, int limit) {
@@ -156,8 +473,6 @@ QVector<SearchResult> InvertedIndex::search(const QString& query, int limit) {
         return QVector<SearchResult>();
     }
 
-    QMutexLocker locker(&mutex_);
-
     // 分词查询
     QStringList queryTerms = tokenizer_->tokenize(query);
 
@@ -167,7 +482,6 @@ QVector<SearchResult> InvertedIndex::search(const QString& query, int limit) {
     }
 
     // 默认使用 OR 模式（任意词匹配）
-    locker.unlock();
     return searchOr(queryTerms, limit);
 }
 
@@ -178,42 +492,147 @@ QVector<SearchResult> InvertedIndex::searchAnd(const QStringList& queryTerms, in
 
     QMutexLocker locker(&mutex_);
 
-    QVector<QVector<SearchResult>> resultSets;
+    QVector<RowId> candidates;
+    QVector<double> scores;
+    matchAllTerms(queryTerms, candidates, scores);
 
-    // 为每个查询词生成结果集
-    for (const QString& term : queryTerms) {
-        if (!index_.contains(term)) {
-            // AND 查询：如果任一词不存在，返回空结果
-            return QVector<SearchResult>();
-        }
+    QVector<SearchResult> results;
+    results.reserve(candidates.size());
+    for (int i = 0; i < candidates.size(); ++i) {
+        results.append(SearchResult(candidates[i], scores[i]));
+    }
+    QVector<SearchResult> finalResults = rankResults(std::move(results), limit);
 
-        const PostingList& postingList = index_[term];
-        QVector<SearchResult> results;
+    LOG_DEBUG(QString("AND search for %1 terms: %2 results")
+                 .arg(queryTerms.size())
+                 .arg(finalResults.size()));
+
+    return finalResults;
+}
+
+void InvertedIndex::matchAllTerms(const QStringList& queryTerms, QVector<RowId>& candidates,
+                                  QVector<double>& scores) const {
+    candidates.clear();
+    scores.clear();
+    if (queryTerms.isEmpty()) {
+        return;
+    }
 
-        for (const Posting& posting : postingList.postings) {
-            double score = calculateTfIdf(term, posting.docId);
-            results.append(SearchResult(posting.docId, score));
+    // 按文档频率升序处理，候选集从最短的列表开始只会越来越小
+    QVector<QPair<uint32_t, QString>> terms;
+    for (const QString& term : queryTerms) {
+        uint32_t df = documentFrequency(term);
+        if (df == 0) {
+            // AND 查询：如果任一词不存在，结果为空
+            return;
+        }
+        terms.append(qMakePair(df, term));
+    }
+    std::stable_sort(terms.begin(), terms.end(), [](const QPair<uint32_t, QString>& a, const QPair<uint32_t, QString>& b) {
+        return a.first < b.first;
+    });
+
+    // 候选集：有序文档ID + 累计得分
+    {
+        QHash<RowId, double> first = collectTermScores(terms[0].second);
+        candidates.reserve(first.size());
+        for (auto it = first.constBegin(); it != first.constEnd(); ++it) {
+            candidates.append(it.key());
         }
+        std::sort(candidates.begin(), candidates.end());
 
-        resultSets.append(results);
+        double idf = calculateIDF(terms[0].first);
+        scores.reserve(candidates.size());
+        for (RowId docId : candidates) {
+            scores.append(first.value(docId) * idf);
+        }
     }
 
-    // 交集运算
-    QVector<SearchResult> finalResults = intersectResults(resultSets);
+    for (int t = 1; t < terms.size() && !candidates.isEmpty(); ++t) {
+        QVector<double> contributions(candidates.size(), 0.0);
+        QVector<bool> matched(candidates.size(), false);
+        intersectTerm(terms[t].second, calculateIDF(terms[t].first), candidates, contributions, matched);
+
+        int kept = 0;
+        for (int i = 0; i < candidates.size(); ++i) {
+            if (matched[i]) {
+                candidates[kept] = candidates[i];
+                scores[kept] = scores[i] + contributions[i];
+                kept++;
+            }
+        }
+        candidates.resize(kept);
+        scores.resize(kept);
+    }
+}
 
-    // 按得分排序
-    std::sort(finalResults.begin(), finalResults.end());
+void InvertedIndex::intersectTerm(const QString& term, double idf, const QVector<RowId>& candidates,
+                                  QVector<double>& contributions, QVector<bool>& matched) const {
+    const RowId* candidateIds = candidates.constData();
+    const size_t numCandidates = static_cast<size_t>(candidates.size());
+
+    // 缓冲区：排序后整体求交
+    auto listIt = index_.constFind(term);
+    if (listIt != index_.constEnd() && !listIt->postings.isEmpty()) {
+        QVector<Posting> postings = listIt->postings;
+        std::sort(postings.begin(), postings.end(), [](const Posting& a, const Posting& b) {
+            return a.docId < b.docId;
+        });
+        QVector<RowId> docIds;
+        docIds.reserve(postings.size());
+        for (const Posting& posting : postings) {
+            docIds.append(posting.docId);
+        }
 
-    // 应用限制
-    if (limit > 0 && finalResults.size() > limit) {
-        finalResults.resize(limit);
+        const size_t capacity = std::min(numCandidates, static_cast<size_t>(docIds.size()));
+        QVector<uint32_t> outCandidates(static_cast<qsizetype>(capacity));
+        QVector<uint32_t> outPostings(static_cast<qsizetype>(capacity));
+        size_t count = PostingIntersection::intersect(candidateIds, numCandidates, docIds.constData(),
+                                                      static_cast<size_t>(docIds.size()),
+                                                      outCandidates.data(), outPostings.data());
+        for (size_t k = 0; k < count; ++k) {
+            const Posting& posting = postings[outPostings[k]];
+            contributions[outCandidates[k]] += idf * calculateTF(posting.tf, docLengths_.value(posting.docId));
+            matched[outCandidates[k]] = true;
+        }
     }
 
-    LOG_DEBUG(QString("AND search for %1 terms: %2 results")
-                 .arg(queryTerms.size())
-                 .arg(finalResults.size()));
+    // 段：按候选文档ID定位块（跳表 + 块头），只解码含候选的块，块内与候选区间求交
+    uint32_t outCandidates[InvertedSegmentWriter::POSTING_BLOCK_SIZE];
+    uint32_t outPostings[InvertedSegmentWriter::POSTING_BLOCK_SIZE];
+    for (const auto& segment : segments_) {
+        const InvertedSegmentMeta& meta = segment->meta();
+        if (candidates.constLast() < meta.minDocId || candidates.constFirst() > meta.maxDocId) {
+            continue;
+        }
 
-    return finalResults;
+        TermInfo info;
+        if (!segment->findTerm(term, info)) {
+            continue;
+        }
+
+        PostingCursor cursor(bufferPool_, info);
+        size_t begin = PostingIntersection::gallop(candidateIds, 0, numCandidates, meta.minDocId);
+        while (begin < numCandidates && cursor.loadBlock(candidateIds[begin])) {
+            const RowId* blockIds = cursor.blockDocIds();
+            const size_t blockSize = static_cast<size_t>(cursor.blockSize());
+            const size_t end = PostingIntersection::gallop(candidateIds, begin, numCandidates,
+                                                           blockIds[blockSize - 1] + 1);
+
+            size_t count = PostingIntersection::intersect(candidateIds + begin, end - begin, blockIds, blockSize,
+                                                          outCandidates, outPostings);
+            for (size_t k = 0; k < count; ++k) {
+                const uint32_t p = outPostings[k];
+                if (segment->isDeleted(blockIds[p])) {
+                    continue;
+                }
+                const size_t index = begin + outCandidates[k];
+                contributions[index] += idf * calculateTF(cursor.blockTfs()[p], cursor.blockDocLengths()[p]);
+                matched[index] = true;
+            }
+            begin = end;
+        }
+    }
 }
 
 QVector<SearchResult> InvertedIndex::searchOr(const QStringList& queryTerms, int limit) {
@@ -223,85 +642,303 @@ QVector<SearchResult> InvertedIndex::searchOr(const QStringList& queryTerms, int
 
     QMutexLocker locker(&mutex_);
 
-    QVector<QVector<SearchResult>> resultSets;
+    if (limit > 0) {
+        return searchTopK(queryTerms, limit);
+    }
 
-    // 为每个查询词生成结果集
+    // 同一文档的得分相加
+    QHash<RowId, double> finalScores;
     for (const QString& term : queryTerms) {
-        if (!index_.contains(term)) {
+        QHash<RowId, double> scores = collectTermScores(term);
+        if (scores.isEmpty()) {
             continue;  // OR 查询：跳过不存在的词
         }
 
-        const PostingList& postingList = index_[term];
-        QVector<SearchResult> results;
+        double idf = calculateIDF(documentFrequency(term));
+        for (auto it = scores.constBegin(); it != scores.constEnd(); ++it) {
+            finalScores[it.key()] += it.value() * idf;
+        }
+    }
+
+    QVector<SearchResult> results;
+    results.reserve(finalScores.size());
+    for (auto it = finalScores.constBegin(); it != finalScores.constEnd(); ++it) {
+        results.append(SearchResult(it.key(), it.value()));
+    }
+    QVector<SearchResult> finalResults = rankResults(std::move(results), limit);
 
-        for (const Posting& posting : postingList.postings) {
-            double score = calculateTfIdf(term, posting.docId);
-            results.append(SearchResult(posting.docId, score));
+    LOG_DEBUG(QString("OR search for %1 terms: %2 results")
+                 .arg(queryTerms.size())
+                 .arg(finalResults.size()));
+
+    return finalResults;
+}
+
+QVector<SearchResult> InvertedIndex::searchMatch(const QString& query, bool booleanMode, int limit) {
+    QStringList plainTerms;
+    QVector<ProximityClause> clauses;
+    parseMatchQuery(query, plainTerms, clauses);
+
+    if (clauses.isEmpty()) {
+        if (plainTerms.isEmpty()) {
+            LOG_DEBUG("No valid query terms after tokenization");
+            return QVector<SearchResult>();
         }
+        return booleanMode ? searchAnd(plainTerms, limit) : searchOr(plainTerms, limit);
+    }
 
-        resultSets.append(results);
+    // 约束中的词项必须出现；普通词在布尔模式下也必须出现，自然语言模式下只加分
+    QStringList requiredTerms;
+    for (const ProximityClause& clause : clauses) {
+        for (const QString& term : clause.terms) {
+            if (!requiredTerms.contains(term)) {
+                requiredTerms.append(term);
+            }
+        }
+    }
+    QStringList optionalTerms;
+    for (const QString& term : plainTerms) {
+        if (requiredTerms.contains(term)) {
+            continue;
+        }
+        if (booleanMode) {
+            requiredTerms.append(term);
+        } else {
+            optionalTerms.append(term);
+        }
     }
 
-    if (resultSets.isEmpty()) {
+    QMutexLocker locker(&mutex_);
+    return searchProximity(requiredTerms, clauses, optionalTerms, limit);
+}
+
+QVector<SearchResult> InvertedIndex::searchPhrase(const QString& phrase, int limit) {
+    ProximityClause clause;
+    clause.terms = tokenizer_->tokenizeWithDuplicates(phrase);
+    clause.phrase = true;
+    clause.distance = 0;
+    if (clause.terms.isEmpty()) {
         return QVector<SearchResult>();
     }
 
-    // 合并运算
-    QVector<SearchResult> finalResults = mergeResults(resultSets);
+    QStringList requiredTerms = clause.terms;
+    requiredTerms.removeDuplicates();
 
-    // 按得分排序
-    std::sort(finalResults.begin(), finalResults.end());
+    QMutexLocker locker(&mutex_);
+    return searchProximity(requiredTerms, QVector<ProximityClause>{clause}, QStringList(), limit);
+}
 
-    // 应用限制
-    if (limit > 0 && finalResults.size() > limit) {
-        finalResults.resize(limit);
+void InvertedIndex::parseMatchQuery(const QString& query, QStringList& plainTerms,
+                                    QVector<ProximityClause>& clauses) const {
+    // 第一遍切成单词、短语和 NEAR 运算符，第二遍把 NEAR 与左右两个操作数组成约束
+    struct Item {
+        QStringList terms;
+        bool phrase = false;
+        bool nearOperator = false;
+        uint32_t distance = 0;
+    };
+    QVector<Item> items;
+
+    const qsizetype length = query.size();
+    qsizetype i = 0;
+    while (i < length) {
+        if (query[i].isSpace()) {
+            i++;
+            continue;
+        }
+
+        Item item;
+        if (query[i] == QLatin1Char('"')) {
+            qsizetype close = query.indexOf(QLatin1Char('"'), i + 1);
+            if (close < 0) {
+                close = length;
+            }
+            item.terms = tokenizer_->tokenizeWithDuplicates(query.mid(i + 1, close - i - 1));
+            item.phrase = true;
+            i = close + 1;
+        } else {
+            qsizetype end = i;
+            while (end < length && !query[end].isSpace() && query[end] != QLatin1Char('"')) {
+                end++;
+            }
+            QString word = query.mid(i, end - i);
+            i = end;
+
+            bool isNumber = false;
+            uint32_t distance = 0;
+            if (word.startsWith(QLatin1String("NEAR/"), Qt::CaseInsensitive)) {
+                distance = word.mid(5).toUInt(&isNumber);
+            }
+            if (word.compare(QLatin1String("NEAR"), Qt::CaseInsensitive) == 0 || isNumber) {
+                item.nearOperator = true;
+                item.distance = isNumber ? distance : DEFAULT_NEAR_DISTANCE;
+            } else {
+                item.terms = tokenizer_->tokenizeWithDuplicates(word);
+            }
+        }
+
+        if (item.nearOperator || !item.terms.isEmpty()) {
+            items.append(item);
+        }
     }
 
-    LOG_DEBUG(QString("OR search for %1 terms: %2 results")
-                 .arg(queryTerms.size())
+    for (int k = 0; k < items.size(); ++k) {
+        const Item& item = items[k];
+        if (item.nearOperator) {
+            if (k == 0 || k + 1 >= items.size() || items[k - 1].nearOperator || items[k + 1].nearOperator) {
+                LOG_DEBUG("Ignoring NEAR without two operands");
+                continue;
+            }
+            ProximityClause clause;
+            clause.terms = QStringList{items[k - 1].terms.constLast(), items[k + 1].terms.constFirst()};
+            clause.phrase = false;
+            clause.distance = item.distance;
+            clauses.append(clause);
+        } else if (item.phrase) {
+            ProximityClause clause;
+            clause.terms = item.terms;
+            clause.phrase = true;
+            clause.distance = 0;
+            clauses.append(clause);
+        } else {
+            for (const QString& term : item.terms) {
+                if (!plainTerms.contains(term)) {
+                    plainTerms.append(term);
+                }
+            }
+        }
+    }
+}
+
+QVector<SearchResult> InvertedIndex::searchProximity(const QStringList& requiredTerms,
+                                                     const QVector<ProximityClause>& clauses,
+                                                     const QStringList& optionalTerms, int limit) const {
+    // 文档级求交不读位置，位置只为通过求交的候选读取
+    QVector<RowId> candidates;
+    QVector<double> scores;
+    matchAllTerms(requiredTerms, candidates, scores);
+
+    for (const ProximityClause& clause : clauses) {
+        if (candidates.isEmpty()) {
+            break;
+        }
+        if (clause.terms.size() >= 2) {
+            filterByProximity(clause, candidates, scores);
+        }
+    }
+
+    for (const QString& term : optionalTerms) {
+        if (candidates.isEmpty()) {
+            break;
+        }
+        uint32_t df = documentFrequency(term);
+        if (df == 0) {
+            continue;
+        }
+        QVector<double> contributions(candidates.size(), 0.0);
+        QVector<bool> matched(candidates.size(), false);
+        intersectTerm(term, calculateIDF(df), candidates, contributions, matched);
+        for (int i = 0; i < candidates.size(); ++i) {
+            scores[i] += contributions[i];
+        }
+    }
+
+    QVector<SearchResult> results;
+    results.reserve(candidates.size());
+    for (int i = 0; i < candidates.size(); ++i) {
+        results.append(SearchResult(candidates[i], scores[i]));
+    }
+    QVector<SearchResult> finalResults = rankResults(std::move(results), limit);
+
+    LOG_DEBUG(QString("Proximity search for %1 terms and %2 clauses: %3 results")
+                 .arg(requiredTerms.size())
+                 .arg(clauses.size())
                  .arg(finalResults.size()));
 
     return finalResults;
 }
 
-double InvertedIndex::calculateTfIdf(const QString& term, RowId docId) {
-    if (!index_.contains(term) || !docLengths_.contains(docId)) {
-        return 0.0;
+void InvertedIndex::filterByProximity(const ProximityClause& clause, QVector<RowId>& candidates,
+                                      QVector<double>& scores) const {
+    // 同一个词项在约束中出现多次时共用一个读取器
+    QStringList distinctTerms;
+    QVector<int> termSlots;
+    for (const QString& term : clause.terms) {
+        int slot = static_cast<int>(distinctTerms.indexOf(term));
+        if (slot < 0) {
+            slot = static_cast<int>(distinctTerms.size());
+            distinctTerms.append(term);
+        }
+        termSlots.append(slot);
     }
 
-    const PostingList& postingList = index_[term];
+    std::vector<std::unique_ptr<PositionReader>> readers;
+    for (const QString& term : distinctTerms) {
+        readers.push_back(std::make_unique<PositionReader>(term, index_, bufferPool_, segments_));
+    }
 
-    // 查找该文档的词频
-    uint32_t tf = 0;
-    for (const Posting& posting : postingList.postings) {
-        if (posting.docId == docId) {
-            tf = posting.tf;
-            break;
+    QVector<const uint32_t*> slotData(distinctTerms.size(), nullptr);
+    QVector<uint32_t> slotCounts(distinctTerms.size(), 0);
+    QVector<const uint32_t*> lists(clause.terms.size(), nullptr);
+    QVector<uint32_t> counts(clause.terms.size(), 0);
+
+    int kept = 0;
+    for (int i = 0; i < candidates.size(); ++i) {
+        bool found = true;
+        for (int slot = 0; slot < distinctTerms.size() && found; ++slot) {
+            found = readers[slot]->fetch(candidates[i], slotData[slot], slotCounts[slot]) && slotCounts[slot] > 0;
+        }
+        if (!found) {
+            continue;
         }
-    }
 
-    if (tf == 0) {
-        return 0.0;
+        bool matched = false;
+        if (clause.phrase) {
+            for (int t = 0; t < clause.terms.size(); ++t) {
+                lists[t] = slotData[termSlots[t]];
+                counts[t] = slotCounts[termSlots[t]];
+            }
+            matched = matchPhrase(lists, counts);
+        } else {
+            matched = matchNear(slotData[termSlots[0]], slotCounts[termSlots[0]],
+                                slotData[termSlots[1]], slotCounts[termSlots[1]],
+                                clause.distance, termSlots[0] == termSlots[1]);
+        }
+
+        if (matched) {
+            candidates[kept] = candidates[i];
+            scores[kept] = scores[i];
+            kept++;
+        }
     }
+    candidates.resize(kept);
+    scores.resize(kept);
+}
 
-    uint32_t docLength = docLengths_[docId];
-    uint32_t df = postingList.df;
+double InvertedIndex::calculateTfIdf(const QString& term, RowId docId) {
+    QMutexLocker locker(&mutex_);
 
-    // TF-IDF = TF * IDF
-    double tfScore = calculateTF(tf, docLength);
-    double idfScore = calculateIDF(df);
+    QHash<RowId, double> scores = collectTermScores(term);
+    auto it = scores.constFind(docId);
+    if (it == scores.constEnd()) {
+        return 0.0;
+    }
 
-    return tfScore * idfScore;
+    return it.value() * calculateIDF(documentFrequency(term));
 }
 
 double InvertedIndex::calculateTF(uint32_t tf, uint32_t docLength) const {
-    if (docLength == 0) {
+    if (tf == 0 || totalDocuments_ == 0) {
         return 0.0;
     }
 
-    // 归一化词频：tf / docLength
-    // 使用 log(1 + tf) 避免过度惩罚短文档
-    return std::log(1.0 + static_cast<double>(tf)) / static_cast<double>(docLength);
+    // 文档长度按平均长度归一化，tf 的贡献随 k1 饱和
+    double avgDocLength = static_cast<double>(totalLength_) / static_cast<double>(totalDocuments_);
+    if (avgDocLength <= 0.0) {
+        avgDocLength = 1.0;
+    }
+    double norm = BM25_K1 * (1.0 - BM25_B + BM25_B * static_cast<double>(docLength) / avgDocLength);
+    return static_cast<double>(tf) * (BM25_K1 + 1.0) / (static_cast<double>(tf) + norm);
 }
 
 double InvertedIndex::calculateIDF(uint32_t df) const {
@@ -309,19 +946,33 @@ double InvertedIndex::calculateIDF(uint32_t df) const {
         return 0.0;
     }
 
-    // IDF = log(N / df)
-    // 使用 log(1 + N/df) 避免除零
-    return std::log(1.0 + static_cast<double>(totalDocuments_) / static_cast<double>(df));
+    // df 含已删除文档，可能超过 N，截断后 IDF 保持为正
+    double n = static_cast<double>(totalDocuments_);
+    double d = static_cast<double>(std::min(df, totalDocuments_));
+    return std::log(1.0 + (n - d + 0.5) / (d + 0.5));
 }
 
-uint32_t InvertedIndex::getDocumentFrequency(const QString& term) const {
-    QMutexLocker locker(&mutex_);
+uint32_t InvertedIndex::documentFrequency(const QString& term) const {
+    uint64_t df = 0;
+
+    auto listIt = index_.constFind(term);
+    if (listIt != index_.constEnd()) {
+        df += listIt->df;
+    }
 
-    if (!index_.contains(term)) {
-        return 0;
+    for (const auto& segment : segments_) {
+        TermInfo info;
+        if (segment->findTerm(term, info)) {
+            df += info.numPostings;
+        }
     }
 
-    return index_[term].df;
+    return static_cast<uint32_t>(std::min<uint64_t>(df, std::numeric_limits<uint32_t>::max()));
+}
+
+uint32_t InvertedIndex::getDocumentFrequency(const QString& term) const {
+    QMutexLocker locker(&mutex_);
+    return documentFrequency(term);
 }
 
 InvertedIndex::Statistics InvertedIndex::getStatistics() const {
@@ -330,19 +981,20 @@ InvertedIndex::Statistics InvertedIndex::getStatistics() const {
     Statistics stats;
     stats.numTerms = static_cast<uint32_t>(index_.size());
     stats.numDocuments = totalDocuments_;
-    stats.totalPostings = 0;
-
-    for (const PostingList& postingList : index_) {
-        stats.totalPostings += static_cast<uint32_t>(postingList.postings.size());
+    stats.totalPostings = static_cast<uint32_t>(bufferedPostings_);
+    stats.numSegments = static_cast<uint32_t>(segments_.size());
+    stats.numDeletedDocuments = 0;
+    stats.numBufferedDocuments = static_cast<uint32_t>(docLengths_.size());
+
+    for (const auto& segment : segments_) {
+        stats.numTerms += segment->meta().numTerms;
+        stats.totalPostings += static_cast<uint32_t>(segment->meta().numPostings);
+        stats.numDeletedDocuments += segment->meta().numDeleted;
     }
 
     // 计算平均文档长度
     if (totalDocuments_ > 0) {
-        uint64_t totalLength = 0;
-        for (uint32_t length : docLengths_) {
-            totalLength += length;
-        }
-        stats.avgDocLength = static_cast<double>(totalLength) / totalDocuments_;
+        stats.avgDocLength = static_cast<double>(totalLength_) / totalDocuments_;
     } else {
         stats.avgDocLength = 0.0;
     }
@@ -350,113 +1002,685 @@ InvertedIndex::Statistics InvertedIndex::getStatistics() const {
     return stats;
 }
 
-QMap<QString, uint32_t> InvertedIndex::getDocumentTerms(RowId docId) const {
-    QMap<QString, uint32_t> termFrequencies;
+QHash<RowId, double> InvertedIndex::collectTermScores(const QString& term) const {
+    QHash<RowId, double> scores;
 
-    for (const PostingList& postingList : index_) {
-        for (const Posting& posting : postingList.postings) {
-            if (posting.docId == docId) {
-                termFrequencies[postingList.term] = posting.tf;
-                break;
+    auto listIt = index_.constFind(term);
+    if (listIt != index_.constEnd()) {
+        for (const Posting& posting : listIt->postings) {
+            scores.insert(posting.docId, calculateTF(posting.tf, docLengths_.value(posting.docId)));
+        }
+    }
+
+    // 逐块流式读取各段的倒排列表，跳过已删除的文档
+    for (const auto& segment : segments_) {
+        TermInfo info;
+        if (!segment->findTerm(term, info)) {
+            continue;
+        }
+
+        PostingCursor cursor(bufferPool_, info);
+        while (cursor.next()) {
+            if (segment->isDeleted(cursor.docId())) {
+                continue;
             }
+            scores.insert(cursor.docId(), calculateTF(cursor.tf(), cursor.docLength()));
         }
     }
 
-    return termFrequencies;
+    return scores;
 }
 
-QVector<SearchResult> InvertedIndex::mergeResults(const QVector<QVector<SearchResult>>& resultSets) {
-    if (resultSets.isEmpty()) {
-        return QVector<SearchResult>();
+QVector<SearchResult> InvertedIndex::searchTopK(const QStringList& queryTerms, int limit) const {
+    // 每个查询词在缓冲区和每个段中各有一个游标，同一文档的未删除版本只在其中一个里
+    std::vector<std::unique_ptr<WandCursor>> owned;
+    QVector<double> idfs;
+    for (int t = 0; t < queryTerms.size(); ++t) {
+        const QString& term = queryTerms[t];
+        double idf = calculateIDF(documentFrequency(term));
+        idfs.append(idf);
+        if (idf <= 0.0) {
+            continue;
+        }
+
+        auto listIt = index_.constFind(term);
+        if (listIt != index_.constEnd() && !listIt->postings.isEmpty()) {
+            QVector<BufferedPosting> postings;
+            postings.reserve(listIt->postings.size());
+            for (const Posting& posting : listIt->postings) {
+                postings.append({posting.docId, posting.tf, docLengths_.value(posting.docId)});
+            }
+            owned.push_back(std::make_unique<WandCursor>(t, std::move(postings)));
+        }
+
+        for (const auto& segment : segments_) {
+            TermInfo info;
+            if (segment->findTerm(term, info)) {
+                owned.push_back(std::make_unique<WandCursor>(t, bufferPool_, segment.get(), info));
+            }
+        }
     }
 
-    if (resultSets.size() == 1) {
-        return resultSets[0];
+    std::vector<WandCursor*> cursors;
+    for (const auto& cursor : owned) {
+        cursor->next();
+        if (cursor->docId() == END_OF_LIST) {
+            continue;
+        }
+        cursor->setUpperBound(idfs[cursor->termIndex()] * calculateTF(cursor->maxTf(), cursor->minDocLength()) *
+                              BOUND_SLACK);
+        cursors.push_back(cursor.get());
     }
 
-    // 使用 QMap 聚合得分（同一文档的得分相加）
-    QMap<RowId, double> scoreMap;
+    // 小顶堆：堆顶是当前第 limit 名（得分最低、同分时文档ID最大）
+    auto better = [](const SearchResult& a, const SearchResult& b) {
+        if (a.score != b.score) {
+            return a.score > b.score;
+        }
+        return a.docId < b.docId;
+    };
+    std::vector<SearchResult> heap;
+    heap.reserve(static_cast<size_t>(limit));
+
+    QVector<double> contributions(queryTerms.size(), 0.0);
+    uint64_t scored = 0;
+
+    while (!cursors.empty()) {
+        std::sort(cursors.begin(), cursors.end(), [](const WandCursor* a, const WandCursor* b) {
+            return a->docId() < b->docId();
+        });
+        while (!cursors.empty() && cursors.back()->docId() == END_OF_LIST) {
+            cursors.pop_back();
+        }
+        if (cursors.empty()) {
+            break;
+        }
+
+        // 文档按ID升序打分，同分的后来者文档ID更大，只有严格更高的得分才能进入前 k 名
+        const double threshold = static_cast<int>(heap.size()) < limit ? -1.0 : heap.front().score;
+
+        // 找枢轴：按文档ID排好后，上界累加第一次超过阈值的位置
+        int pivot = -1;
+        double accumulated = 0.0;
+        for (int i = 0; i < static_cast<int>(cursors.size()); ++i) {
+            accumulated += cursors[i]->upperBound();
+            if (accumulated > threshold) {
+                pivot = i;
+                break;
+            }
+        }
+        if (pivot < 0) {
+            break;  // 剩余文档的得分都不可能超过阈值
+        }
+
+        const RowId pivotDoc = cursors[pivot]->docId();
+        while (pivot + 1 < static_cast<int>(cursors.size()) && cursors[pivot + 1]->docId() == pivotDoc) {
+            pivot++;
+        }
+
+        // 块级上界：只读块头
+        double blockBound = 0.0;
+        RowId nextCandidate = END_OF_LIST;
+        for (int i = 0; i <= pivot; ++i) {
+            uint32_t maxTf = 0;
+            uint32_t minDocLength = 0;
+            RowId blockLast = END_OF_LIST;
+            if (cursors[i]->shallowAdvance(pivotDoc, maxTf, minDocLength, blockLast)) {
+                blockBound += idfs[cursors[i]->termIndex()] * calculateTF(maxTf, minDocLength) * BOUND_SLACK;
+            }
+            if (blockLast != END_OF_LIST) {
+                nextCandidate = std::min(nextCandidate, blockLast + 1);
+            }
+        }
 
-    for (const QVector<SearchResult>& resultSet : resultSets) {
-        for (const SearchResult& result : resultSet) {
-            scoreMap[result.docId] += result.score;
+        if (blockBound > threshold) {
+            if (cursors[0]->docId() == pivotDoc) {
+                // 枢轴之前的游标都停在 pivotDoc：完整打分，按查询词顺序求和
+                std::fill(contributions.begin(), contributions.end(), 0.0);
+                for (int i = 0; i <= pivot; ++i) {
+                    int t = cursors[i]->termIndex();
+                    contributions[t] += idfs[t] * calculateTF(cursors[i]->tf(), cursors[i]->docLength());
+                }
+                double score = 0.0;
+                for (double contribution : contributions) {
+                    score += contribution;
+                }
+                scored++;
+
+                SearchResult result(pivotDoc, score);
+                if (static_cast<int>(heap.size()) < limit) {
+                    heap.push_back(result);
+                    std::push_heap(heap.begin(), heap.end(), better);
+                } else if (score > threshold) {
+                    std::pop_heap(heap.begin(), heap.end(), better);
+                    heap.back() = result;
+                    std::push_heap(heap.begin(), heap.end(), better);
+                }
+
+                for (int i = 0; i <= pivot; ++i) {
+                    cursors[i]->next();
+                }
+            } else {
+                for (int i = 0; i < pivot; ++i) {
+                    cursors[i]->advance(pivotDoc);
+                }
+            }
+        } else {
+            // 这些块里的文档都进不了前 k 名，跳到最早结束的块之后
+            if (pivot + 1 < static_cast<int>(cursors.size())) {
+                nextCandidate = std::min(nextCandidate, cursors[pivot + 1]->docId());
+            }
+            for (int i = 0; i <= pivot; ++i) {
+                cursors[i]->advance(nextCandidate);
+            }
         }
     }
 
-    // 转换为 QVector
-    QVector<SearchResult> merged;
-    for (auto it = scoreMap.constBegin(); it != scoreMap.constEnd(); ++it) {
-        merged.append(SearchResult(it.key(), it.value()));
+    std::sort(heap.begin(), heap.end(), better);
+    QVector<SearchResult> results(heap.begin(), heap.end());
+
+    LOG_DEBUG(QString("Top-%1 search for %2 terms: %3 results, %4 documents scored")
+                 .arg(limit)
+                 .arg(queryTerms.size())
+                 .arg(results.size())
+                 .arg(scored));
+
+    return results;
+}
+
+int InvertedIndex::findSegmentOf(RowId docId, uint32_t& docLength) const {
+    // 未删除的文档只会出现在一个段中
+    for (size_t i = 0; i < segments_.size(); ++i) {
+        if (segments_[i]->containsLive(docId, docLength)) {
+            return static_cast<int>(i);
+        }
     }
+    return -1;
+}
+
+QVector<SearchResult> InvertedIndex::rankResults(QVector<SearchResult> results, int limit) {
+    // 按得分降序，得分相同按文档ID升序（结果稳定）
+    auto byScore = [](const SearchResult& a, const SearchResult& b) {
+        if (a.score != b.score) {
+            return a.score > b.score;
+        }
+        return a.docId < b.docId;
+    };
 
-    return merged;
+    // 应用限制
+    if (limit > 0 && results.size() > limit) {
+        std::partial_sort(results.begin(), results.begin() + limit, results.end(), byScore);
+        results.resize(limit);
+    } else {
+        std::sort(results.begin(), results.end(), byScore);
+    }
+
+    return results;
 }
 
-QVector<SearchResult> InvertedIndex::intersectResults(const QVector<QVector<SearchResult>>& resultSets) {
-    if (resultSets.isEmpty()) {
-        return QVector<SearchResult>();
+// ========== 段管理 ==========
+
+bool InvertedIndex::flush() {
+    QMutexLocker locker(&mutex_);
+    return flushLocked();
+}
+
+bool InvertedIndex::compact() {
+    QMutexLocker locker(&mutex_);
+
+    if (!flushLocked()) {
+        return false;
+    }
+    if (segments_.size() < 2 && (segments_.empty() || segments_[0]->meta().numDeleted == 0)) {
+        return true;
+    }
+
+    QVector<int> all(static_cast<int>(segments_.size()));
+    std::iota(all.begin(), all.end(), 0);
+    if (!mergeSegments(all)) {
+        return false;
+    }
+    return writeMeta();
+}
+
+bool InvertedIndex::flushLocked() {
+    if (!bufferPool_) {
+        return true;
+    }
+
+    if (!ensureMetaPage()) {
+        return false;
+    }
+
+    if (!docLengths_.isEmpty() && !writeBufferSegment()) {
+        return false;
+    }
+
+    if (!maybeMerge()) {
+        return false;
+    }
+
+    for (const auto& segment : segments_) {
+        if (segment->hasPendingDeletes() && !segment->saveDeletes()) {
+            LOG_ERROR(QString("Failed to save delete set of segment %1").arg(segment->meta().segmentId));
+            return false;
+        }
+    }
+
+    return writeMeta();
+}
+
+bool InvertedIndex::writeBufferSegment() {
+    InvertedSegmentWriter writer(bufferPool_, nextSegmentId_);
+
+    bool ok = true;
+    for (auto it = docLengths_.constBegin(); ok && it != docLengths_.constEnd(); ++it) {
+        ok = writer.addDocument(it.key(), it.value());
+    }
+
+    // QMap 按词项升序迭代，与段内词典的顺序一致
+    for (auto it = index_.constBegin(); ok && it != index_.constEnd(); ++it) {
+        QVector<Posting> postings = it->postings;
+        std::sort(postings.begin(), postings.end(), [](const Posting& a, const Posting& b) {
+            return a.docId < b.docId;
+        });
+
+        ok = writer.beginTerm(it.key());
+        for (const Posting& posting : postings) {
+            if (!ok) {
+                break;
+            }
+            ok = writer.addPosting(posting.docId, posting.tf, docLengths_.value(posting.docId), posting.positions);
+        }
+        ok = ok && writer.endTerm();
+    }
+
+    InvertedSegmentMeta meta;
+    if (!ok || !writer.finish(meta)) {
+        writer.abort();
+        LOG_ERROR(QString("Failed to write segment for inverted index '%1'").arg(indexName_));
+        return false;
     }
 
-    if (resultSets.size() == 1) {
-        return resultSets[0];
+    auto segment = std::make_unique<InvertedSegment>(bufferPool_, meta);
+    if (!segment->load()) {
+        segment->destroy();
+        return false;
     }
 
-    // 找到最小的结果集作为初始集合
-    int minIndex = 0;
-    int minSize = resultSets[0].size();
-    for (int i = 1; i < resultSets.size(); ++i) {
-        if (resultSets[i].size() < minSize) {
-            minSize = resultSets[i].size();
-            minIndex = i;
+    LOG_DEBUG(QString("Inverted index '%1': wrote segment %2 (%3 documents, %4 terms)")
+                 .arg(indexName_)
+                 .arg(meta.segmentId)
+                 .arg(meta.numDocs)
+                 .arg(meta.numTerms));
+
+    segments_.push_back(std::move(segment));
+    nextSegmentId_++;
+
+    index_.clear();
+    docLengths_.clear();
+    docTerms_.clear();
+    bufferedPostings_ = 0;
+    return true;
+}
+
+bool InvertedIndex::maybeMerge() {
+    // 删除超过一半的段单独重写
+    QVector<uint32_t> heavySegments;
+    for (const auto& segment : segments_) {
+        const InvertedSegmentMeta& meta = segment->meta();
+        if (meta.numDocs > 0 && meta.numDeleted * 2 > meta.numDocs) {
+            heavySegments.append(meta.segmentId);
+        }
+    }
+    for (uint32_t segmentId : heavySegments) {
+        for (size_t i = 0; i < segments_.size(); ++i) {
+            if (segments_[i]->meta().segmentId == segmentId) {
+                if (!mergeSegments(QVector<int>{static_cast<int>(i)})) {
+                    return false;
+                }
+                break;
+            }
         }
     }
 
-    // 从最小集合开始，逐步求交集
-    QSet<RowId> docIdSet;
-    for (const SearchResult& result : resultSets[minIndex]) {
-        docIdSet.insert(result.docId);
+    // 小段并成一个：逐条语句刷新时段数不会随语句数增长，每次只重写这些小段
+    QVector<int> smallSegments;
+    for (size_t i = 0; i < segments_.size(); ++i) {
+        if (segments_[i]->liveDocuments() < SMALL_SEGMENT_DOCS) {
+            smallSegments.append(static_cast<int>(i));
+        }
+    }
+    if (smallSegments.size() >= 2 && !mergeSegments(smallSegments)) {
+        return false;
     }
 
-    // 与其他集合求交集
-    for (int i = 0; i < resultSets.size(); ++i) {
-        if (i == minIndex) continue;
+    // 段数过多时合并最小的几个
+    while (static_cast<int>(segments_.size()) > MAX_SEGMENTS) {
+        QVector<int> order(static_cast<int>(segments_.size()));
+        std::iota(order.begin(), order.end(), 0);
+        std::sort(order.begin(), order.end(), [this](int a, int b) {
+            return segments_[a]->liveDocuments() < segments_[b]->liveDocuments();
+        });
+        order.resize(MERGE_FACTOR);
+        if (!mergeSegments(order)) {
+            return false;
+        }
+    }
 
-        QSet<RowId> currentSet;
-        for (const SearchResult& result : resultSets[i]) {
-            currentSet.insert(result.docId);
+    return true;
+}
+
+bool InvertedIndex::mergeSegments(QVector<int> indices) {
+    std::sort(indices.begin(), indices.end());
+
+    QVector<InvertedSegment*> sources;
+    for (int index : indices) {
+        sources.append(segments_[index].get());
+    }
+    const int k = sources.size();
+
+    InvertedSegmentWriter writer(bufferPool_, nextSegmentId_);
+    bool ok = true;
+
+    // 文档表：按文档ID k 路归并，丢弃已删除的文档
+    {
+        std::vector<std::unique_ptr<DocumentCursor>> cursors;
+        QVector<RowId> heads(k);
+        QVector<uint32_t> lengths(k);
+        QVector<bool> valid(k, false);
+
+        auto advance = [&](int i) {
+            while (cursors[i]->next(heads[i], lengths[i])) {
+                if (!sources[i]->isDeleted(heads[i])) {
+                    return true;
+                }
+            }
+            return false;
+        };
+
+        for (int i = 0; i < k; ++i) {
+            cursors.push_back(std::make_unique<DocumentCursor>(bufferPool_, sources[i]->meta()));
+            valid[i] = advance(i);
         }
 
-        docIdSet.intersect(currentSet);
+        while (ok) {
+            int minIndex = -1;
+            for (int i = 0; i < k; ++i) {
+                if (valid[i] && (minIndex < 0 || heads[i] < heads[minIndex])) {
+                    minIndex = i;
+                }
+            }
+            if (minIndex < 0) {
+                break;
+            }
 
-        if (docIdSet.isEmpty()) {
-            break;  // 早期退出优化
+            RowId docId = heads[minIndex];
+            ok = writer.addDocument(docId, lengths[minIndex]);
+            for (int i = 0; i < k; ++i) {
+                if (valid[i] && heads[i] == docId) {
+                    valid[i] = advance(i);
+                }
+            }
         }
     }
 
-    // 计算交集文档的总得分
-    QMap<RowId, double> scoreMap;
-    for (RowId docId : docIdSet) {
-        double totalScore = 0.0;
+    // 词典：按词项 k 路归并，同一词项的倒排列表再按文档ID归并
+    {
+        std::vector<std::unique_ptr<DictionaryCursor>> dictionaries;
+        QVector<TermInfo> terms(k);
+        QVector<bool> hasTerm(k, false);
+
+        for (int i = 0; i < k; ++i) {
+            dictionaries.push_back(std::make_unique<DictionaryCursor>(bufferPool_, sources[i]->meta()));
+            hasTerm[i] = dictionaries[i]->next(terms[i]);
+        }
+
+        while (ok) {
+            int minIndex = -1;
+            for (int i = 0; i < k; ++i) {
+                if (hasTerm[i] && (minIndex < 0 || terms[i].term < terms[minIndex].term)) {
+                    minIndex = i;
+                }
+            }
+            if (minIndex < 0) {
+                break;
+            }
+
+            const QString term = terms[minIndex].term;
+            ok = writer.beginTerm(term);
+
+            std::vector<std::unique_ptr<PostingCursor>> postings;
+            QVector<int> owners;
+            for (int i = 0; i < k; ++i) {
+                if (hasTerm[i] && terms[i].term == term) {
+                    postings.push_back(std::make_unique<PostingCursor>(bufferPool_, terms[i]));
+                    owners.append(i);
+                }
+            }
+
+            const int n = owners.size();
+            QVector<bool> live(n, false);
+            auto advance = [&](int j) {
+                while (postings[j]->next()) {
+                    if (!sources[owners[j]]->isDeleted(postings[j]->docId())) {
+                        return true;
+                    }
+                }
+                return false;
+            };
+            for (int j = 0; j < n; ++j) {
+                live[j] = advance(j);
+            }
 
-        for (const QVector<SearchResult>& resultSet : resultSets) {
-            for (const SearchResult& result : resultSet) {
-                if (result.docId == docId) {
-                    totalScore += result.score;
+            while (ok) {
+                int minPosting = -1;
+                for (int j = 0; j < n; ++j) {
+                    if (live[j] && (minPosting < 0 || postings[j]->docId() < postings[minPosting]->docId())) {
+                        minPosting = j;
+                    }
+                }
+                if (minPosting < 0) {
                     break;
                 }
+
+                RowId docId = postings[minPosting]->docId();
+                const uint32_t* positionData = nullptr;
+                uint32_t positionCount = 0;
+                ok = postings[minPosting]->positions(positionData, positionCount) &&
+                     writer.addPosting(docId, postings[minPosting]->tf(), postings[minPosting]->docLength(),
+                                       QVector<uint32_t>(positionData, positionData + positionCount));
+                for (int j = 0; j < n; ++j) {
+                    if (live[j] && postings[j]->docId() == docId) {
+                        live[j] = advance(j);
+                    }
+                }
+            }
+
+            ok = ok && writer.endTerm();
+
+            for (int i : owners) {
+                hasTerm[i] = dictionaries[i]->next(terms[i]);
             }
         }
+    }
 
-        scoreMap[docId] = totalScore;
+    InvertedSegmentMeta meta;
+    if (!ok || !writer.finish(meta)) {
+        writer.abort();
+        LOG_ERROR(QString("Failed to merge segments of inverted index '%1'").arg(indexName_));
+        return false;
     }
+    nextSegmentId_++;
 
-    // 转换为 QVector
-    QVector<SearchResult> intersected;
-    for (auto it = scoreMap.constBegin(); it != scoreMap.constEnd(); ++it) {
-        intersected.append(SearchResult(it.key(), it.value()));
+    std::unique_ptr<InvertedSegment> merged = std::make_unique<InvertedSegment>(bufferPool_, meta);
+    if (meta.numDocs > 0 && !merged->load()) {
+        merged->destroy();
+        return false;
     }
 
-    return intersected;
+    LOG_DEBUG(QString("Inverted index '%1': merged %2 segments into segment %3 (%4 documents)")
+                 .arg(indexName_)
+                 .arg(k)
+                 .arg(meta.segmentId)
+                 .arg(meta.numDocs));
+
+    // 旧段先退役：元数据页改为引用新段并写盘之后（writeMeta）才释放它们的页
+    for (int i = indices.size() - 1; i >= 0; --i) {
+        retiredSegments_.push_back(std::move(segments_[indices[i]]));
+        segments_.erase(segments_.begin() + indices[i]);
+    }
+
+    if (meta.numDocs > 0) {
+        segments_.push_back(std::move(merged));
+    } else {
+        merged->destroy();
+    }
+    return true;
+}
+
+// ========== 元数据页 ==========
+
+bool InvertedIndex::setRootPageId(PageId pageId) {
+    QMutexLocker locker(&mutex_);
+
+    index_.clear();
+    docLengths_.clear();
+    docTerms_.clear();
+    bufferedPostings_ = 0;
+    segments_.clear();
+    retiredSegments_.clear();
+    nextSegmentId_ = 1;
+    totalDocuments_ = 0;
+    totalLength_ = 0;
+    rootPageId_ = pageId;
+
+    if (!bufferPool_ || pageId == INVALID_PAGE_ID) {
+        return true;
+    }
+    return loadMeta();
+}
+
+bool InvertedIndex::ensureMetaPage() {
+    if (rootPageId_ != INVALID_PAGE_ID) {
+        return true;
+    }
+
+    PageId pageId = INVALID_PAGE_ID;
+    Page* page = bufferPool_->newPage(&pageId);
+    if (!page) {
+        LOG_ERROR(QString("Failed to allocate meta page for inverted index '%1'").arg(indexName_));
+        return false;
+    }
+    page->setPageType(PageType::INVERTED_INDEX_PAGE);
+    bufferPool_->unpinPage(pageId, true);
+
+    rootPageId_ = pageId;
+    return true;
+}
+
+bool InvertedIndex::writeMeta() {
+    const size_t capacity = (PAGE_SIZE - sizeof(PageHeader) - META_HEADER_SIZE) / InvertedSegmentMeta::DISK_SIZE;
+    if (segments_.size() > capacity) {
+        LOG_ERROR(QString("Inverted index '%1' has too many segments (%2)").arg(indexName_).arg(segments_.size()));
+        return false;
+    }
+
+    Page* page = bufferPool_->fetchPage(rootPageId_);
+    if (!page) {
+        LOG_ERROR(QString("Failed to fetch meta page %1 of inverted index '%2'").arg(rootPageId_).arg(indexName_));
+        return false;
+    }
+
+    char* data = page->getData() + sizeof(PageHeader);
+    std::memset(data, 0, PAGE_SIZE - sizeof(PageHeader));
+
+    uint32_t numSegments = static_cast<uint32_t>(segments_.size());
+    std::memcpy(data + 0, &META_MAGIC, sizeof(uint32_t));
+    std::memcpy(data + 4, &META_VERSION, sizeof(uint32_t));
+    std::memcpy(data + 8, &numSegments, sizeof(uint32_t));
+    std::memcpy(data + 12, &nextSegmentId_, sizeof(uint32_t));
+    std::memcpy(data + 16, &totalDocuments_, sizeof(uint32_t));
+    std::memcpy(data + 24, &totalLength_, sizeof(uint64_t));
+
+    char* entry = data + META_HEADER_SIZE;
+    for (const auto& segment : segments_) {
+        segment->meta().serialize(entry);
+        entry += InvertedSegmentMeta::DISK_SIZE;
+    }
+
+    bufferPool_->unpinPage(rootPageId_, true);
+
+    // 旧段的页释放后可能被复用，元数据页必须先落盘，崩溃后不会引用到被覆盖的页
+    if (!retiredSegments_.empty()) {
+        if (!bufferPool_->flushPage(rootPageId_)) {
+            LOG_ERROR(QString("Failed to flush meta page %1 of inverted index '%2'").arg(rootPageId_).arg(indexName_));
+            return false;
+        }
+        for (auto& segment : retiredSegments_) {
+            segment->destroy();
+        }
+        retiredSegments_.clear();
+    }
+    return true;
+}
+
+bool InvertedIndex::loadMeta() {
+    Page* page = bufferPool_->fetchPage(rootPageId_);
+    if (!page) {
+        LOG_ERROR(QString("Failed to fetch meta page %1 of inverted index '%2'").arg(rootPageId_).arg(indexName_));
+        return false;
+    }
+
+    const char* data = page->getData() + sizeof(PageHeader);
+    uint32_t magic = 0;
+    uint32_t version = 0;
+    uint32_t numSegments = 0;
+    std::memcpy(&magic, data + 0, sizeof(uint32_t));
+    std::memcpy(&version, data + 4, sizeof(uint32_t));
+    std::memcpy(&numSegments, data + 8, sizeof(uint32_t));
+
+    const size_t capacity = (PAGE_SIZE - sizeof(PageHeader) - META_HEADER_SIZE) / InvertedSegmentMeta::DISK_SIZE;
+    if (magic == META_MAGIC && version < META_VERSION) {
+        bufferPool_->unpinPage(rootPageId_, false);
+        LOG_ERROR(QString("Inverted index '%1' was written in format version %2, rebuild it with CREATE FULLTEXT INDEX")
+                      .arg(indexName_).arg(version));
+        return false;
+    }
+    if (magic != META_MAGIC || version != META_VERSION || numSegments > capacity) {
+        bufferPool_->unpinPage(rootPageId_, false);
+        LOG_ERROR(QString("Invalid meta page %1 for inverted index '%2'").arg(rootPageId_).arg(indexName_));
+        return false;
+    }
+
+    std::memcpy(&nextSegmentId_, data + 12, sizeof(uint32_t));
+    std::memcpy(&totalDocuments_, data + 16, sizeof(uint32_t));
+    std::memcpy(&totalLength_, data + 24, sizeof(uint64_t));
+
+    QVector<InvertedSegmentMeta> metas;
+    const char* entry = data + META_HEADER_SIZE;
+    for (uint32_t i = 0; i < numSegments; ++i) {
+        metas.append(InvertedSegmentMeta::deserialize(entry));
+        entry += InvertedSegmentMeta::DISK_SIZE;
+    }
+    bufferPool_->unpinPage(rootPageId_, false);
+
+    for (const InvertedSegmentMeta& meta : metas) {
+        auto segment = std::make_unique<InvertedSegment>(bufferPool_, meta);
+        if (!segment->load()) {
+            LOG_ERROR(QString("Failed to load segment %1 of inverted index '%2'").arg(meta.segmentId).arg(indexName_));
+            segments_.clear();
+            return false;
+        }
+        segments_.push_back(std::move(segment));
+    }
+
+    LOG_DEBUG(QString("Loaded inverted index '%1': %2 segments, %3 documents")
+                 .arg(indexName_)
+                 .arg(segments_.size())
+                 .arg(totalDocuments_));
+
+    return true;
 }
 
 } // namespace qindb
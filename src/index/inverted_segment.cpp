@@ -0,0 +1,1155 @@
+#include "qindb/inverted_segment.h"
+#include "qindb/posting_intersection.h"
+#include "qindb/logger.h"
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+namespace qindb {
+
+namespace {
+
+constexpr int STREAM_DATA_OFFSET = static_cast<int>(sizeof(PageHeader));
+
+void appendString(QByteArray& out, const QString& value) {
+    QByteArray utf8 = value.toUtf8();
+    Varint::append(out, static_cast<uint64_t>(utf8.size()));
+    out.append(utf8);
+}
+
+void appendPos(QByteArray& out, const StreamPos& pos) {
+    Varint::append(out, pos.pageId);
+    Varint::append(out, pos.offset);
+}
+
+bool readPos(PageStreamReader& reader, StreamPos& pos) {
+    uint64_t pageId = 0;
+    uint64_t offset = 0;
+    if (!reader.readVarint(pageId) || !reader.readVarint(offset) || offset > PAGE_SIZE) {
+        return false;
+    }
+    pos = StreamPos(static_cast<PageId>(pageId), static_cast<uint16_t>(offset));
+    return true;
+}
+
+bool readTermInfo(PageStreamReader& reader, TermInfo& info) {
+    uint64_t numPostings = 0;
+    uint64_t maxTf = 0;
+    uint64_t minDocLength = 0;
+    if (!reader.readString(info.term) || !reader.readVarint(numPostings) || !readPos(reader, info.postings) ||
+        !reader.readVarint(maxTf) || !reader.readVarint(minDocLength) || !readPos(reader, info.skips)) {
+        return false;
+    }
+    info.numPostings = static_cast<uint32_t>(numPostings);
+    info.maxTf = static_cast<uint32_t>(maxTf);
+    info.minDocLength = static_cast<uint32_t>(minDocLength);
+    return true;
+}
+
+} // namespace
+
+// ========== Varint ==========
+
+void Varint::append(QByteArray& out, uint64_t value) {
+    char buf[10];
+    int n = 0;
+    while (value >= 0x80) {
+        buf[n++] = static_cast<char>((value & 0x7F) | 0x80);
+        value >>= 7;
+    }
+    buf[n++] = static_cast<char>(value);
+    out.append(buf, n);
+}
+
+bool Varint::decode(const char*& p, const char* end, uint64_t& value) {
+    value = 0;
+    for (int shift = 0; shift < 64 && p < end; shift += 7) {
+        uint8_t byte = static_cast<uint8_t>(*p++);
+        value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// ========== PageStreamWriter ==========
+
+PageStreamWriter::PageStreamWriter(BufferPoolManager* bufferPool, PageType pageType)
+    : bufferPool_(bufferPool)
+    , pageType_(pageType)
+    , firstPageId_(INVALID_PAGE_ID)
+    , currentPageId_(INVALID_PAGE_ID)
+    , currentPage_(nullptr)
+    , offset_(PAGE_SIZE)
+{
+}
+
+PageStreamWriter::~PageStreamWriter() {
+    finish();
+}
+
+bool PageStreamWriter::appendPage() {
+    PageId newPageId = INVALID_PAGE_ID;
+    Page* newPage = bufferPool_->newPage(&newPageId);
+    if (!newPage) {
+        LOG_ERROR("Failed to allocate index stream page");
+        return false;
+    }
+
+    newPage->setPageType(pageType_);
+    newPage->getHeader()->freeSpaceOffset = static_cast<uint16_t>(STREAM_DATA_OFFSET);
+    newPage->getHeader()->freeSpaceSize = static_cast<uint16_t>(PAGE_SIZE - STREAM_DATA_OFFSET);
+
+    if (currentPage_) {
+        currentPage_->setNextPageId(newPageId);
+        newPage->setPrevPageId(currentPageId_);
+        bufferPool_->unpinPage(currentPageId_, true);
+    } else {
+        firstPageId_ = newPageId;
+    }
+
+    currentPage_ = newPage;
+    currentPageId_ = newPageId;
+    offset_ = STREAM_DATA_OFFSET;
+    return true;
+}
+
+bool PageStreamWriter::write(const char* data, int len) {
+    while (len > 0) {
+        if (!currentPage_ || offset_ >= static_cast<int>(PAGE_SIZE)) {
+            if (!appendPage()) {
+                return false;
+            }
+        }
+
+        int n = std::min(len, static_cast<int>(PAGE_SIZE) - offset_);
+        std::memcpy(currentPage_->getData() + offset_, data, n);
+        offset_ += n;
+        data += n;
+        len -= n;
+
+        PageHeader* header = currentPage_->getHeader();
+        header->freeSpaceOffset = static_cast<uint16_t>(offset_);
+        header->freeSpaceSize = static_cast<uint16_t>(PAGE_SIZE - offset_);
+    }
+    return true;
+}
+
+StreamPos PageStreamWriter::position() {
+    if (!currentPage_ || offset_ >= static_cast<int>(PAGE_SIZE)) {
+        if (!appendPage()) {
+            return StreamPos();
+        }
+    }
+    return StreamPos(currentPageId_, static_cast<uint16_t>(offset_));
+}
+
+void PageStreamWriter::finish() {
+    if (currentPage_) {
+        bufferPool_->unpinPage(currentPageId_, true);
+        currentPage_ = nullptr;
+        currentPageId_ = INVALID_PAGE_ID;
+        offset_ = PAGE_SIZE;
+    }
+}
+
+// ========== PageStreamReader ==========
+
+PageStreamReader::PageStreamReader(BufferPoolManager* bufferPool, StreamPos start, PageType pageType)
+    : bufferPool_(bufferPool)
+    , pageType_(pageType)
+    , pageId_(INVALID_PAGE_ID)
+    , page_(nullptr)
+    , offset_(0)
+    , used_(0)
+{
+    if (start.isValid()) {
+        seek(start);
+    }
+}
+
+PageStreamReader::~PageStreamReader() {
+    release();
+}
+
+void PageStreamReader::release() {
+    if (page_) {
+        bufferPool_->unpinPage(pageId_, false);
+        page_ = nullptr;
+    }
+}
+
+bool PageStreamReader::loadPage(PageId pageId) {
+    release();
+
+    page_ = bufferPool_->fetchPage(pageId);
+    if (!page_) {
+        LOG_ERROR(QString("Failed to fetch index stream page %1").arg(pageId));
+        pageId_ = INVALID_PAGE_ID;
+        return false;
+    }
+    if (page_->getPageType() != pageType_) {
+        LOG_ERROR(QString("Page %1 is not an index stream page of the expected type").arg(pageId));
+        release();
+        pageId_ = INVALID_PAGE_ID;
+        return false;
+    }
+
+    pageId_ = pageId;
+    used_ = page_->getHeader()->freeSpaceOffset;
+    return true;
+}
+
+bool PageStreamReader::seek(StreamPos pos) {
+    if (!pos.isValid()) {
+        release();
+        pageId_ = INVALID_PAGE_ID;
+        return false;
+    }
+    if (pos.pageId != pageId_ || !page_) {
+        if (!loadPage(pos.pageId)) {
+            return false;
+        }
+    }
+    offset_ = pos.offset;
+    return true;
+}
+
+bool PageStreamReader::ensureData() {
+    while (page_ && offset_ >= used_) {
+        PageId nextPageId = page_->getNextPageId();
+        if (nextPageId == INVALID_PAGE_ID) {
+            return false;
+        }
+        if (!loadPage(nextPageId)) {
+            return false;
+        }
+        offset_ = STREAM_DATA_OFFSET;
+    }
+    return page_ != nullptr;
+}
+
+bool PageStreamReader::read(char* out, int len) {
+    while (len > 0) {
+        if (!ensureData()) {
+            return false;
+        }
+        int n = std::min(len, used_ - offset_);
+        std::memcpy(out, page_->getData() + offset_, n);
+        offset_ += n;
+        out += n;
+        len -= n;
+    }
+    return true;
+}
+
+bool PageStreamReader::readVarint(uint64_t& value) {
+    value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        if (!ensureData()) {
+            return false;
+        }
+        uint8_t byte = static_cast<uint8_t>(page_->getData()[offset_++]);
+        value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool PageStreamReader::readString(QString& value) {
+    uint64_t len = 0;
+    if (!readVarint(len) || len > PAGE_SIZE) {
+        return false;
+    }
+    QByteArray utf8(static_cast<qsizetype>(len), Qt::Uninitialized);
+    if (len > 0 && !read(utf8.data(), static_cast<int>(len))) {
+        return false;
+    }
+    value = QString::fromUtf8(utf8);
+    return true;
+}
+
+bool PageStreamReader::skip(int len) {
+    while (len > 0) {
+        if (!ensureData()) {
+            return false;
+        }
+        int n = std::min(len, used_ - offset_);
+        offset_ += n;
+        len -= n;
+    }
+    return true;
+}
+
+// ========== InvertedSegmentMeta ==========
+
+InvertedSegmentMeta::InvertedSegmentMeta()
+    : segmentId(0)
+    , numDocs(0)
+    , numDeleted(0)
+    , numTerms(0)
+    , numPostings(0)
+    , totalLength(0)
+    , minDocId(INVALID_ROW_ID)
+    , maxDocId(INVALID_ROW_ID)
+    , dictPageId(INVALID_PAGE_ID)
+    , postingsPageId(INVALID_PAGE_ID)
+    , docsPageId(INVALID_PAGE_ID)
+    , skipPageId(INVALID_PAGE_ID)
+    , deletesPageId(INVALID_PAGE_ID)
+    , positionsPageId(INVALID_PAGE_ID)
+{
+}
+
+void InvertedSegmentMeta::serialize(char* out) const {
+    size_t offset = 0;
+    auto put = [&](const void* value, size_t size) {
+        std::memcpy(out + offset, value, size);
+        offset += size;
+    };
+    put(&segmentId, sizeof(segmentId));
+    put(&numDocs, sizeof(numDocs));
+    put(&numDeleted, sizeof(numDeleted));
+    put(&numTerms, sizeof(numTerms));
+    put(&numPostings, sizeof(numPostings));
+    put(&totalLength, sizeof(totalLength));
+    put(&minDocId, sizeof(minDocId));
+    put(&maxDocId, sizeof(maxDocId));
+    put(&dictPageId, sizeof(dictPageId));
+    put(&postingsPageId, sizeof(postingsPageId));
+    put(&docsPageId, sizeof(docsPageId));
+    put(&skipPageId, sizeof(skipPageId));
+    put(&deletesPageId, sizeof(deletesPageId));
+    put(&positionsPageId, sizeof(positionsPageId));
+}
+
+InvertedSegmentMeta InvertedSegmentMeta::deserialize(const char* in) {
+    InvertedSegmentMeta meta;
+    size_t offset = 0;
+    auto get = [&](void* value, size_t size) {
+        std::memcpy(value, in + offset, size);
+        offset += size;
+    };
+    get(&meta.segmentId, sizeof(meta.segmentId));
+    get(&meta.numDocs, sizeof(meta.numDocs));
+    get(&meta.numDeleted, sizeof(meta.numDeleted));
+    get(&meta.numTerms, sizeof(meta.numTerms));
+    get(&meta.numPostings, sizeof(meta.numPostings));
+    get(&meta.totalLength, sizeof(meta.totalLength));
+    get(&meta.minDocId, sizeof(meta.minDocId));
+    get(&meta.maxDocId, sizeof(meta.maxDocId));
+    get(&meta.dictPageId, sizeof(meta.dictPageId));
+    get(&meta.postingsPageId, sizeof(meta.postingsPageId));
+    get(&meta.docsPageId, sizeof(meta.docsPageId));
+    get(&meta.skipPageId, sizeof(meta.skipPageId));
+    get(&meta.deletesPageId, sizeof(meta.deletesPageId));
+    get(&meta.positionsPageId, sizeof(meta.positionsPageId));
+    return meta;
+}
+
+// ========== InvertedSegmentWriter ==========
+
+InvertedSegmentWriter::InvertedSegmentWriter(BufferPoolManager* bufferPool, uint32_t segmentId)
+    : bufferPool_(bufferPool)
+    , dict_(bufferPool)
+    , postings_(bufferPool)
+    , docs_(bufferPool)
+    , positions_(bufferPool)
+    , lastDocId_(INVALID_ROW_ID)
+    , termPostings_(0)
+    , blockBase_(INVALID_ROW_ID)
+    , blockLastDocId_(INVALID_ROW_ID)
+    , blockCount_(0)
+    , blockMaxTf_(0)
+    , blockMinLength_(0)
+    , termMaxTf_(0)
+    , termMinLength_(0)
+    , termBlocks_(0)
+    , numSkips_(0)
+    , lastSkipBase_(0)
+    , lastSkipPostings_(0)
+    , failed_(false)
+{
+    meta_.segmentId = segmentId;
+}
+
+InvertedSegmentWriter::~InvertedSegmentWriter() {
+    dict_.finish();
+    postings_.finish();
+    docs_.finish();
+    positions_.finish();
+}
+
+bool InvertedSegmentWriter::addDocument(RowId docId, uint32_t docLength) {
+    if (failed_ || docId == INVALID_ROW_ID || (meta_.numDocs > 0 && docId <= lastDocId_)) {
+        failed_ = true;
+        return false;
+    }
+
+    // 每组第一个文档写绝对值，采样点可以独立解码
+    RowId base = lastDocId_;
+    if (meta_.numDocs % DOC_SAMPLE_INTERVAL == 0) {
+        docSamples_.append(qMakePair(docId, docs_.position()));
+        base = 0;
+    }
+
+    QByteArray entry;
+    Varint::append(entry, docId - base);
+    Varint::append(entry, docLength);
+    if (!docs_.write(entry)) {
+        failed_ = true;
+        return false;
+    }
+
+    if (meta_.numDocs == 0) {
+        meta_.minDocId = docId;
+    }
+    meta_.maxDocId = docId;
+    meta_.numDocs++;
+    meta_.totalLength += docLength;
+    lastDocId_ = docId;
+    return true;
+}
+
+bool InvertedSegmentWriter::beginTerm(const QString& term) {
+    if (failed_) {
+        return false;
+    }
+    currentTerm_ = term;
+    termStart_ = StreamPos();
+    termPostings_ = 0;
+    blockBase_ = 0;
+    blockLastDocId_ = 0;
+    blockCount_ = 0;
+    blockMaxTf_ = 0;
+    blockMinLength_ = 0;
+    termMaxTf_ = 0;
+    termMinLength_ = 0;
+    termBlocks_ = 0;
+    skips_.clear();
+    numSkips_ = 0;
+    lastSkipBase_ = 0;
+    lastSkipPostings_ = 0;
+    block_.clear();
+    blockPositions_.clear();
+    return true;
+}
+
+bool InvertedSegmentWriter::addPosting(RowId docId, uint32_t tf, uint32_t docLength,
+                                       const QVector<uint32_t>& positions) {
+    if (failed_ || docId == INVALID_ROW_ID || (termPostings_ > 0 && docId <= blockLastDocId_) ||
+        static_cast<uint32_t>(positions.size()) != tf) {
+        failed_ = true;
+        return false;
+    }
+
+    if (termPostings_ == 0) {
+        termStart_ = postings_.position();
+        if (!termStart_.isValid()) {
+            failed_ = true;
+            return false;
+        }
+    }
+
+    Varint::append(block_, docId - blockLastDocId_);
+    Varint::append(block_, tf);
+    Varint::append(block_, docLength);
+    uint32_t lastPosition = 0;
+    for (uint32_t position : positions) {
+        Varint::append(blockPositions_, position - lastPosition);
+        lastPosition = position;
+    }
+    blockLastDocId_ = docId;
+    blockMaxTf_ = std::max(blockMaxTf_, tf);
+    blockMinLength_ = blockCount_ == 0 ? docLength : std::min(blockMinLength_, docLength);
+    termMaxTf_ = std::max(termMaxTf_, tf);
+    termMinLength_ = termPostings_ == 0 ? docLength : std::min(termMinLength_, docLength);
+    blockCount_++;
+    termPostings_++;
+
+    if (blockCount_ == POSTING_BLOCK_SIZE) {
+        return flushBlock();
+    }
+    return true;
+}
+
+bool InvertedSegmentWriter::flushBlock() {
+    if (blockCount_ == 0) {
+        return true;
+    }
+
+    // 每 SKIP_INTERVAL 个块记一个跳表项，指向本块块头
+    if (termBlocks_ > 0 && termBlocks_ % SKIP_INTERVAL == 0) {
+        StreamPos headerPos = postings_.position();
+        if (!headerPos.isValid()) {
+            failed_ = true;
+            return false;
+        }
+        uint32_t postingsBefore = termPostings_ - static_cast<uint32_t>(blockCount_);
+        Varint::append(skips_, blockBase_ - lastSkipBase_);
+        appendPos(skips_, headerPos);
+        Varint::append(skips_, postingsBefore - lastSkipPostings_);
+        lastSkipBase_ = blockBase_;
+        lastSkipPostings_ = postingsBefore;
+        numSkips_++;
+    }
+
+    StreamPos positionsPos = positions_.position();
+    if (!positionsPos.isValid() || !positions_.write(blockPositions_)) {
+        failed_ = true;
+        return false;
+    }
+
+    QByteArray header;
+    Varint::append(header, static_cast<uint64_t>(blockCount_));
+    Varint::append(header, static_cast<uint64_t>(block_.size()));
+    Varint::append(header, blockLastDocId_ - blockBase_);
+    Varint::append(header, blockMaxTf_);
+    Varint::append(header, blockMinLength_);
+    appendPos(header, positionsPos);
+
+    if (!postings_.write(header) || !postings_.write(block_)) {
+        failed_ = true;
+        return false;
+    }
+
+    meta_.numPostings += static_cast<uint64_t>(blockCount_);
+    termBlocks_++;
+    blockBase_ = blockLastDocId_;
+    blockCount_ = 0;
+    blockMaxTf_ = 0;
+    blockMinLength_ = 0;
+    block_.clear();
+    blockPositions_.clear();
+    return true;
+}
+
+bool InvertedSegmentWriter::endTerm() {
+    if (failed_) {
+        return false;
+    }
+    if (termPostings_ == 0) {
+        // 合并时全部文档都已删除的词项不写入词典
+        return true;
+    }
+    if (!flushBlock()) {
+        return false;
+    }
+
+    StreamPos skipsPos;
+    if (numSkips_ > 0) {
+        skipsPos = postings_.position();
+        QByteArray table;
+        Varint::append(table, numSkips_);
+        table.append(skips_);
+        if (!skipsPos.isValid() || !postings_.write(table)) {
+            failed_ = true;
+            return false;
+        }
+    }
+
+    if (meta_.numTerms % TERM_SAMPLE_INTERVAL == 0) {
+        termSamples_.append(qMakePair(currentTerm_, dict_.position()));
+    }
+
+    QByteArray entry;
+    appendString(entry, currentTerm_);
+    Varint::append(entry, termPostings_);
+    appendPos(entry, termStart_);
+    Varint::append(entry, termMaxTf_);
+    Varint::append(entry, termMinLength_);
+    appendPos(entry, skipsPos);
+    if (!dict_.write(entry)) {
+        failed_ = true;
+        return false;
+    }
+
+    meta_.numTerms++;
+    return true;
+}
+
+bool InvertedSegmentWriter::finish(InvertedSegmentMeta& meta) {
+    if (failed_) {
+        return false;
+    }
+
+    QByteArray skip;
+    Varint::append(skip, static_cast<uint64_t>(termSamples_.size()));
+    for (const auto& sample : termSamples_) {
+        appendString(skip, sample.first);
+        appendPos(skip, sample.second);
+    }
+    Varint::append(skip, static_cast<uint64_t>(docSamples_.size()));
+    for (const auto& sample : docSamples_) {
+        Varint::append(skip, sample.first);
+        appendPos(skip, sample.second);
+    }
+
+    PageStreamWriter skipWriter(bufferPool_);
+    if (!skipWriter.write(skip)) {
+        failed_ = true;
+        return false;
+    }
+    skipWriter.finish();
+
+    dict_.finish();
+    postings_.finish();
+    docs_.finish();
+    positions_.finish();
+
+    meta_.dictPageId = dict_.firstPageId();
+    meta_.postingsPageId = postings_.firstPageId();
+    meta_.docsPageId = docs_.firstPageId();
+    meta_.positionsPageId = positions_.firstPageId();
+    meta_.skipPageId = skipWriter.firstPageId();
+    meta = meta_;
+    return true;
+}
+
+void InvertedSegmentWriter::abort() {
+    dict_.finish();
+    postings_.finish();
+    docs_.finish();
+    positions_.finish();
+    InvertedSegment::freeChain(bufferPool_, dict_.firstPageId());
+    InvertedSegment::freeChain(bufferPool_, postings_.firstPageId());
+    InvertedSegment::freeChain(bufferPool_, docs_.firstPageId());
+    InvertedSegment::freeChain(bufferPool_, positions_.firstPageId());
+    failed_ = true;
+}
+
+// ========== PostingCursor ==========
+
+PostingCursor::PostingCursor(BufferPoolManager* bufferPool, const TermInfo& info)
+    : bufferPool_(bufferPool)
+    , reader_(bufferPool, info.postings)
+    , numPostings_(info.numPostings)
+    , remaining_(info.numPostings)
+    , hasBlock_(false)
+    , decoded_(false)
+    , onEntry_(false)
+    , blockCount_(0)
+    , blockBytes_(0)
+    , blockPos_(-1)
+    , blockBase_(0)
+    , blockLastDocId_(0)
+    , blockMaxTf_(0)
+    , blockMinLength_(0)
+    , positionsDecoded_(false)
+    , skipsPos_(info.skips)
+    , skipsLoaded_(false)
+    , docId_(0)
+    , tf_(0)
+    , docLength_(0)
+{
+}
+
+void PostingCursor::fail() {
+    remaining_ = 0;
+    hasBlock_ = false;
+    decoded_ = false;
+    onEntry_ = false;
+    blockPos_ = -1;
+}
+
+bool PostingCursor::readBlockHeader() {
+    if (remaining_ == 0) {
+        fail();
+        return false;
+    }
+
+    // 当前块没有解码时整块跳过
+    if (hasBlock_ && !decoded_ && !reader_.skip(static_cast<int>(blockBytes_))) {
+        LOG_ERROR("Truncated posting block");
+        fail();
+        return false;
+    }
+    if (hasBlock_) {
+        blockBase_ = blockLastDocId_;
+    }
+
+    uint64_t count = 0;
+    uint64_t byteLen = 0;
+    uint64_t lastDelta = 0;
+    uint64_t maxTf = 0;
+    uint64_t minLength = 0;
+    StreamPos positionsPos;
+    if (!reader_.readVarint(count) || !reader_.readVarint(byteLen) || !reader_.readVarint(lastDelta) ||
+        !reader_.readVarint(maxTf) || !reader_.readVarint(minLength) || !readPos(reader_, positionsPos) ||
+        count == 0 || count > remaining_ || count > InvertedSegmentWriter::POSTING_BLOCK_SIZE ||
+        byteLen > static_cast<uint64_t>(count) * 30) {
+        LOG_ERROR("Corrupted posting block header");
+        fail();
+        return false;
+    }
+
+    hasBlock_ = true;
+    decoded_ = false;
+    onEntry_ = false;
+    blockCount_ = static_cast<uint32_t>(count);
+    blockBytes_ = static_cast<uint32_t>(byteLen);
+    blockPos_ = -1;
+    blockLastDocId_ = blockBase_ + lastDelta;
+    blockMaxTf_ = static_cast<uint32_t>(maxTf);
+    blockMinLength_ = static_cast<uint32_t>(minLength);
+    blockPositionsPos_ = positionsPos;
+    positionsDecoded_ = false;
+    remaining_ -= blockCount_;
+    return true;
+}
+
+bool PostingCursor::decodeBlock() {
+    block_.resize(static_cast<qsizetype>(blockBytes_));
+    if (!reader_.read(block_.data(), static_cast<int>(blockBytes_))) {
+        LOG_ERROR("Truncated posting block");
+        fail();
+        return false;
+    }
+
+    const char* p = block_.constData();
+    const char* end = p + block_.size();
+    RowId docId = blockBase_;
+    for (uint32_t i = 0; i < blockCount_; ++i) {
+        uint64_t delta = 0;
+        uint64_t tf = 0;
+        uint64_t docLength = 0;
+        if (!Varint::decode(p, end, delta) || !Varint::decode(p, end, tf) || !Varint::decode(p, end, docLength)) {
+            LOG_ERROR("Corrupted posting entry");
+            fail();
+            return false;
+        }
+        docId += delta;
+        docIds_[i] = docId;
+        tfs_[i] = static_cast<uint32_t>(tf);
+        docLengths_[i] = static_cast<uint32_t>(docLength);
+    }
+    if (docId != blockLastDocId_) {
+        LOG_ERROR("Posting block does not match its header");
+        fail();
+        return false;
+    }
+
+    decoded_ = true;
+    blockPos_ = -1;
+    return true;
+}
+
+bool PostingCursor::loadSkips() {
+    skipsLoaded_ = true;
+
+    PageStreamReader reader(bufferPool_, skipsPos_);
+    uint64_t count = 0;
+    if (!reader.readVarint(count) || count > numPostings_) {
+        LOG_WARN("Corrupted posting skip table, falling back to sequential block headers");
+        return false;
+    }
+
+    RowId base = 0;
+    uint32_t postingsBefore = 0;
+    skips_.reserve(static_cast<qsizetype>(count));
+    for (uint64_t i = 0; i < count; ++i) {
+        uint64_t baseDelta = 0;
+        uint64_t postingsDelta = 0;
+        SkipEntry entry;
+        if (!reader.readVarint(baseDelta) || !readPos(reader, entry.header) || !reader.readVarint(postingsDelta)) {
+            LOG_WARN("Corrupted posting skip table, falling back to sequential block headers");
+            skips_.clear();
+            return false;
+        }
+        base += baseDelta;
+        postingsBefore += static_cast<uint32_t>(postingsDelta);
+        entry.base = base;
+        entry.postingsBefore = postingsBefore;
+        skips_.append(entry);
+    }
+    return !skips_.isEmpty();
+}
+
+bool PostingCursor::decodePositions() {
+    // tf 之和就是块内的位置个数，位置流不需要额外的长度信息
+    uint64_t total = 0;
+    for (uint32_t i = 0; i < blockCount_; ++i) {
+        positionOffsets_[i] = static_cast<uint32_t>(total);
+        total += tfs_[i];
+    }
+    positionOffsets_[blockCount_] = static_cast<uint32_t>(total);
+    if (total > std::numeric_limits<uint32_t>::max()) {
+        LOG_ERROR("Corrupted posting block: too many positions");
+        return false;
+    }
+
+    PageStreamReader reader(bufferPool_, blockPositionsPos_);
+    positions_.resize(static_cast<qsizetype>(total));
+    for (uint32_t i = 0; i < blockCount_; ++i) {
+        uint64_t position = 0;
+        for (uint32_t k = positionOffsets_[i]; k < positionOffsets_[i + 1]; ++k) {
+            uint64_t delta = 0;
+            if (!reader.readVarint(delta)) {
+                LOG_ERROR("Truncated position data");
+                return false;
+            }
+            position += delta;
+            positions_[k] = static_cast<uint32_t>(position);
+        }
+    }
+
+    positionsDecoded_ = true;
+    return true;
+}
+
+bool PostingCursor::positions(const uint32_t*& data, uint32_t& count) {
+    if (!onEntry_ || !blockPositionsPos_.isValid()) {
+        return false;
+    }
+    if (!positionsDecoded_ && !decodePositions()) {
+        return false;
+    }
+    data = positions_.constData() + positionOffsets_[blockPos_];
+    count = positionOffsets_[blockPos_ + 1] - positionOffsets_[blockPos_];
+    return true;
+}
+
+void PostingCursor::setEntry(int index) {
+    blockPos_ = index;
+    docId_ = docIds_[index];
+    tf_ = tfs_[index];
+    docLength_ = docLengths_[index];
+    onEntry_ = true;
+}
+
+bool PostingCursor::next() {
+    while (!hasBlock_ || !decoded_ || blockPos_ + 1 >= static_cast<int>(blockCount_)) {
+        if (hasBlock_ && !decoded_) {
+            if (!decodeBlock()) {
+                return false;
+            }
+        } else if (!readBlockHeader()) {
+            return false;
+        }
+    }
+    setEntry(blockPos_ + 1);
+    return true;
+}
+
+bool PostingCursor::skipToBlock(RowId target) {
+    if (hasBlock_ && blockLastDocId_ >= target) {
+        return true;
+    }
+
+    // 跳表：最后一个基准 < target 的项，在当前块之后才值得跳
+    if (skipsPos_.isValid() && (skipsLoaded_ ? !skips_.isEmpty() : loadSkips())) {
+        auto it = std::lower_bound(skips_.constBegin(), skips_.constEnd(), target,
+                                   [](const SkipEntry& entry, RowId value) {
+                                       return entry.base < value;
+                                   });
+        if (it != skips_.constBegin()) {
+            --it;
+            uint32_t consumed = numPostings_ - remaining_;
+            if (remaining_ > 0 && it->postingsBefore >= consumed) {
+                if (!reader_.seek(it->header)) {
+                    fail();
+                    return false;
+                }
+                blockBase_ = it->base;
+                remaining_ = numPostings_ - it->postingsBefore;
+                hasBlock_ = false;
+                decoded_ = false;
+                onEntry_ = false;
+            }
+        }
+    }
+
+    if (!hasBlock_ && !readBlockHeader()) {
+        return false;
+    }
+    while (blockLastDocId_ < target) {
+        if (!readBlockHeader()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool PostingCursor::loadBlock(RowId target) {
+    if (!skipToBlock(target)) {
+        return false;
+    }
+    return decoded_ || decodeBlock();
+}
+
+bool PostingCursor::advance(RowId target) {
+    if (onEntry_ && docId_ >= target) {
+        return true;
+    }
+    if (!skipToBlock(target)) {
+        return false;
+    }
+    if (!decoded_ && !decodeBlock()) {
+        return false;
+    }
+
+    // 块内最后一项 >= target，所以一定能在本块找到
+    size_t from = static_cast<size_t>(blockPos_ + 1);
+    size_t index = PostingIntersection::gallop(docIds_, from, blockCount_, target);
+    if (index >= blockCount_) {
+        fail();
+        return false;
+    }
+    setEntry(static_cast<int>(index));
+    return true;
+}
+
+// ========== DictionaryCursor ==========
+
+DictionaryCursor::DictionaryCursor(BufferPoolManager* bufferPool, const InvertedSegmentMeta& meta)
+    : reader_(bufferPool, StreamPos(meta.dictPageId, static_cast<uint16_t>(STREAM_DATA_OFFSET)))
+    , remaining_(meta.dictPageId == INVALID_PAGE_ID ? 0 : meta.numTerms)
+{
+}
+
+bool DictionaryCursor::next(TermInfo& info) {
+    if (remaining_ == 0) {
+        return false;
+    }
+
+    if (!readTermInfo(reader_, info)) {
+        LOG_ERROR("Corrupted term dictionary entry");
+        remaining_ = 0;
+        return false;
+    }
+
+    remaining_--;
+    return true;
+}
+
+// ========== DocumentCursor ==========
+
+DocumentCursor::DocumentCursor(BufferPoolManager* bufferPool, const InvertedSegmentMeta& meta,
+                               StreamPos start, uint32_t skip)
+    : reader_(bufferPool, start.isValid() ? start : StreamPos(meta.docsPageId, static_cast<uint16_t>(STREAM_DATA_OFFSET)))
+    , index_(skip)
+    , total_(meta.docsPageId == INVALID_PAGE_ID ? 0 : meta.numDocs)
+    , lastDocId_(0)
+{
+}
+
+bool DocumentCursor::next(RowId& docId, uint32_t& docLength) {
+    if (index_ >= total_) {
+        return false;
+    }
+
+    uint64_t delta = 0;
+    uint64_t length = 0;
+    if (!reader_.readVarint(delta) || !reader_.readVarint(length)) {
+        LOG_ERROR("Corrupted document table entry");
+        index_ = total_;
+        return false;
+    }
+
+    RowId base = (index_ % InvertedSegmentWriter::DOC_SAMPLE_INTERVAL == 0) ? 0 : lastDocId_;
+    docId = base + delta;
+    docLength = static_cast<uint32_t>(length);
+    lastDocId_ = docId;
+    index_++;
+    return true;
+}
+
+// ========== InvertedSegment ==========
+
+InvertedSegment::InvertedSegment(BufferPoolManager* bufferPool, const InvertedSegmentMeta& meta)
+    : bufferPool_(bufferPool)
+    , meta_(meta)
+    , deletesDirty_(false)
+{
+}
+
+bool InvertedSegment::load() {
+    termSamples_.clear();
+    docSamples_.clear();
+    deleted_.clear();
+
+    PageStreamReader skip(bufferPool_, StreamPos(meta_.skipPageId, static_cast<uint16_t>(STREAM_DATA_OFFSET)));
+    uint64_t count = 0;
+    if (!skip.readVarint(count) || count > meta_.numTerms) {
+        LOG_ERROR(QString("Failed to read term samples of segment %1").arg(meta_.segmentId));
+        return false;
+    }
+    termSamples_.reserve(static_cast<qsizetype>(count));
+    for (uint64_t i = 0; i < count; ++i) {
+        QString term;
+        StreamPos pos;
+        if (!skip.readString(term) || !readPos(skip, pos)) {
+            return false;
+        }
+        termSamples_.append(qMakePair(term, pos));
+    }
+
+    if (!skip.readVarint(count) || count > meta_.numDocs) {
+        LOG_ERROR(QString("Failed to read document samples of segment %1").arg(meta_.segmentId));
+        return false;
+    }
+    docSamples_.reserve(static_cast<qsizetype>(count));
+    for (uint64_t i = 0; i < count; ++i) {
+        uint64_t docId = 0;
+        StreamPos pos;
+        if (!skip.readVarint(docId) || !readPos(skip, pos)) {
+            return false;
+        }
+        docSamples_.append(qMakePair(static_cast<RowId>(docId), pos));
+    }
+
+    if (meta_.deletesPageId != INVALID_PAGE_ID) {
+        PageStreamReader deletes(bufferPool_, StreamPos(meta_.deletesPageId, static_cast<uint16_t>(STREAM_DATA_OFFSET)));
+        if (!deletes.readVarint(count) || count > meta_.numDocs) {
+            LOG_ERROR(QString("Failed to read delete set of segment %1").arg(meta_.segmentId));
+            return false;
+        }
+        RowId docId = 0;
+        for (uint64_t i = 0; i < count; ++i) {
+            uint64_t delta = 0;
+            if (!deletes.readVarint(delta)) {
+                return false;
+            }
+            docId += delta;
+            deleted_.insert(docId);
+        }
+    }
+    meta_.numDeleted = static_cast<uint32_t>(deleted_.size());
+    return true;
+}
+
+bool InvertedSegment::findTerm(const QString& term, TermInfo& info) const {
+    // 最后一个 <= term 的采样点
+    auto it = std::upper_bound(termSamples_.constBegin(), termSamples_.constEnd(), term,
+                               [](const QString& value, const QPair<QString, StreamPos>& sample) {
+                                   return value < sample.first;
+                               });
+    if (it == termSamples_.constBegin()) {
+        return false;
+    }
+    --it;
+
+    PageStreamReader reader(bufferPool_, it->second);
+    int sampleIndex = static_cast<int>(it - termSamples_.constBegin());
+    uint32_t first = static_cast<uint32_t>(sampleIndex) * InvertedSegmentWriter::TERM_SAMPLE_INTERVAL;
+    uint32_t count = std::min<uint32_t>(InvertedSegmentWriter::TERM_SAMPLE_INTERVAL, meta_.numTerms - first);
+
+    for (uint32_t i = 0; i < count; ++i) {
+        TermInfo entry;
+        if (!readTermInfo(reader, entry)) {
+            LOG_ERROR(QString("Corrupted term dictionary in segment %1").arg(meta_.segmentId));
+            return false;
+        }
+        if (entry.term == term) {
+            info = entry;
+            return true;
+        }
+        if (term < entry.term) {
+            break;
+        }
+    }
+    return false;
+}
+
+bool InvertedSegment::findDocument(RowId docId, uint32_t& docLength) const {
+    if (meta_.numDocs == 0 || docId < meta_.minDocId || docId > meta_.maxDocId) {
+        return false;
+    }
+
+    auto it = std::upper_bound(docSamples_.constBegin(), docSamples_.constEnd(), docId,
+                               [](RowId value, const QPair<RowId, StreamPos>& sample) {
+                                   return value < sample.first;
+                               });
+    if (it == docSamples_.constBegin()) {
+        return false;
+    }
+    --it;
+
+    uint32_t first = static_cast<uint32_t>(it - docSamples_.constBegin()) * InvertedSegmentWriter::DOC_SAMPLE_INTERVAL;
+    DocumentCursor cursor(bufferPool_, meta_, it->second, first);
+    RowId current = INVALID_ROW_ID;
+    uint32_t length = 0;
+    for (int i = 0; i < InvertedSegmentWriter::DOC_SAMPLE_INTERVAL && cursor.next(current, length); ++i) {
+        if (current == docId) {
+            docLength = length;
+            return true;
+        }
+        if (current > docId) {
+            break;
+        }
+    }
+    return false;
+}
+
+bool InvertedSegment::containsLive(RowId docId, uint32_t& docLength) const {
+    return !deleted_.contains(docId) && findDocument(docId, docLength);
+}
+
+void InvertedSegment::markDeleted(RowId docId) {
+    if (!deleted_.contains(docId)) {
+        deleted_.insert(docId);
+        meta_.numDeleted = static_cast<uint32_t>(deleted_.size());
+        deletesDirty_ = true;
+    }
+}
+
+bool InvertedSegment::saveDeletes() {
+    if (!deletesDirty_) {
+        return true;
+    }
+
+    QVector<RowId> sorted(deleted_.constBegin(), deleted_.constEnd());
+    std::sort(sorted.begin(), sorted.end());
+
+    QByteArray data;
+    Varint::append(data, static_cast<uint64_t>(sorted.size()));
+    RowId previous = 0;
+    for (RowId docId : sorted) {
+        Varint::append(data, docId - previous);
+        previous = docId;
+    }
+
+    PageStreamWriter writer(bufferPool_);
+    if (!writer.write(data)) {
+        writer.finish();
+        freeChain(bufferPool_, writer.firstPageId());
+        return false;
+    }
+    writer.finish();
+
+    freeChain(bufferPool_, meta_.deletesPageId);
+    meta_.deletesPageId = writer.firstPageId();
+    deletesDirty_ = false;
+    return true;
+}
+
+void InvertedSegment::destroy() {
+    freeChain(bufferPool_, meta_.dictPageId);
+    freeChain(bufferPool_, meta_.postingsPageId);
+    freeChain(bufferPool_, meta_.docsPageId);
+    freeChain(bufferPool_, meta_.skipPageId);
+    freeChain(bufferPool_, meta_.deletesPageId);
+    freeChain(bufferPool_, meta_.positionsPageId);
+    meta_.dictPageId = meta_.postingsPageId = meta_.docsPageId = INVALID_PAGE_ID;
+    meta_.skipPageId = meta_.deletesPageId = meta_.positionsPageId = INVALID_PAGE_ID;
+}
+
+void InvertedSegment::freeChain(BufferPoolManager* bufferPool, PageId firstPageId) {
+    PageId pageId = firstPageId;
+    while (pageId != INVALID_PAGE_ID) {
+        Page* page = bufferPool->fetchPage(pageId);
+        if (!page) {
+            LOG_WARN(QString("Failed to fetch inverted index page %1 while freeing").arg(pageId));
+            return;
+        }
+        PageId nextPageId = page->getNextPageId();
+        bufferPool->unpinPage(pageId, false);
+        bufferPool->deletePage(pageId);
+        pageId = nextPageId;
+    }
+}
+
+} // namespace qindb
@@ -0,0 +1,571 @@
+#include "qindb/key_encoder.h"
+#include "qindb/logger.h"
+#include <QDateTime>
+#include <cmath>
+#include <limits>
+
+namespace qindb {
+
+namespace {
+
+constexpr char NULL_MARKER = '\x00';      // NULL 值标记（排在所有非 NULL 值之前）
+constexpr char VALUE_MARKER = '\x01';     // 非 NULL 值标记
+
+constexpr char ESCAPE_BYTE = '\x00';      // 变长数据中的 0x00 需要转义
+constexpr char ESCAPED_ZERO = '\xFF';     // 0x00 -> 0x00 0xFF
+constexpr char TERMINATOR = '\x01';       // 结束符 0x00 0x01
+
+constexpr uint8_t DECIMAL_NEGATIVE = 0x01;
+constexpr uint8_t DECIMAL_ZERO = 0x02;
+constexpr uint8_t DECIMAL_POSITIVE = 0x03;
+
+/**
+ * @brief 把有符号整数按 width 字节写为符号位取反的大端序
+ */
+bool appendSigned(qint64 v, int width, QByteArray& output) {
+    const int bits = width * 8;
+    if (bits < 64) {
+        const qint64 limit = qint64(1) << (bits - 1);
+        if (v < -limit || v >= limit) {
+            return false;
+        }
+    }
+
+    uint64_t u = static_cast<uint64_t>(v) ^ (uint64_t(1) << (bits - 1));
+    for (int i = width - 1; i >= 0; --i) {
+        output.append(static_cast<char>((u >> (i * 8)) & 0xFF));
+    }
+    return true;
+}
+
+bool readUnsigned(const QByteArray& data, int& offset, int width, uint64_t& u) {
+    if (offset + width > data.size()) {
+        return false;
+    }
+    u = 0;
+    for (int i = 0; i < width; ++i) {
+        u = (u << 8) | static_cast<uint8_t>(data[offset + i]);
+    }
+    offset += width;
+    return true;
+}
+
+bool readSigned(const QByteArray& data, int& offset, int width, qint64& v) {
+    uint64_t u;
+    if (!readUnsigned(data, offset, width, u)) {
+        return false;
+    }
+    const int bits = width * 8;
+    u ^= uint64_t(1) << (bits - 1);
+    if (bits < 64 && (u & (uint64_t(1) << (bits - 1)))) {
+        u |= ~uint64_t(0) << bits;  // 符号扩展
+    }
+    v = static_cast<qint64>(u);
+    return true;
+}
+
+} // namespace
+
+// ============ 公共接口 ============
+
+bool KeyEncoder::encode(const QVariant& value, DataType type, QByteArray& output) {
+    output.clear();
+    return append(value, type, output);
+}
+
+bool KeyEncoder::append(const QVariant& value, DataType type, QByteArray& output) {
+    if (value.isNull()) {
+        output.append(NULL_MARKER);
+        return true;
+    }
+    output.append(VALUE_MARKER);
+
+    bool ok = false;
+    if (isIntegerType(type) || type == DataType::ROWID) {
+        ok = appendInteger(value, type, output);
+    } else if (isFloatType(type)) {
+        ok = appendFloat(value, type, output);
+    } else if (type == DataType::DECIMAL || type == DataType::NUMERIC) {
+        ok = appendDecimal(value, output);
+    } else if (isStringType(type) || type == DataType::JSON || type == DataType::JSONB ||
+               type == DataType::XML || type == DataType::HIERARCHYID) {
+        QString str = value.toString();
+        if (type == DataType::CHAR) {
+            str = str.trimmed();  // 与 KeyComparator::compareString 的 CHAR 语义一致
+        }
+        appendEscaped(str.toUtf8(), output);
+        ok = true;
+    } else if (isBinaryType(type)) {
+        appendEscaped(value.toByteArray(), output);
+        ok = true;
+    } else if (isDateTimeType(type)) {
+        ok = appendDateTime(value, type, output);
+    } else if (type == DataType::BOOLEAN || type == DataType::BOOL) {
+        output.append(value.toBool() ? '\x01' : '\x00');
+        ok = true;
+    } else if (type == DataType::UUID || type == DataType::UNIQUEIDENTIFIER) {
+        ok = appendUUID(value, output);
+    } else {
+        LOG_ERROR(QString("Unsupported key type for normalized encoding: %1").arg(getDataTypeName(type)));
+        return false;
+    }
+
+    if (!ok) {
+        LOG_ERROR(QString("Failed to encode key '%1' as %2").arg(value.toString(), getDataTypeName(type)));
+    }
+    return ok;
+}
+
+bool KeyEncoder::decode(const QByteArray& data, DataType type, QVariant& value) {
+    int offset = 0;
+    if (!decodeAt(data, offset, type, value)) {
+        return false;
+    }
+    return offset == data.size();
+}
+
+bool KeyEncoder::decodeAt(const QByteArray& data, int& offset, DataType type, QVariant& value) {
+    if (offset >= data.size()) {
+        return false;
+    }
+
+    const char marker = data[offset++];
+    if (marker == NULL_MARKER) {
+        value = QVariant();
+        return true;
+    }
+    if (marker != VALUE_MARKER) {
+        return false;
+    }
+
+    if (isIntegerType(type) || type == DataType::ROWID) {
+        return decodeInteger(data, offset, type, value);
+    } else if (isFloatType(type)) {
+        return decodeFloat(data, offset, type, value);
+    } else if (type == DataType::DECIMAL || type == DataType::NUMERIC) {
+        return decodeDecimal(data, offset, value);
+    } else if (isStringType(type) || type == DataType::JSON || type == DataType::JSONB ||
+               type == DataType::XML || type == DataType::HIERARCHYID) {
+        QByteArray utf8;
+        if (!decodeEscaped(data, offset, utf8)) {
+            return false;
+        }
+        value = QString::fromUtf8(utf8);
+        return true;
+    } else if (isBinaryType(type)) {
+        QByteArray bytes;
+        if (!decodeEscaped(data, offset, bytes)) {
+            return false;
+        }
+        value = bytes;
+        return true;
+    } else if (isDateTimeType(type)) {
+        return decodeDateTime(data, offset, type, value);
+    } else if (type == DataType::BOOLEAN || type == DataType::BOOL) {
+        if (offset >= data.size()) {
+            return false;
+        }
+        value = (data[offset++] != '\x00');
+        return true;
+    } else if (type == DataType::UUID || type == DataType::UNIQUEIDENTIFIER) {
+        if (offset + 16 > data.size()) {
+            return false;
+        }
+        QByteArray hex = data.mid(offset, 16).toHex().toUpper();
+        offset += 16;
+        // 与 TypeSerializer::formatUUID 的格式一致：xxxxxxxx-xxxx-xxxx-xxxx-xxxxxxxxxxxx
+        value = QString::fromLatin1(hex.left(8) + '-' + hex.mid(8, 4) + '-' + hex.mid(12, 4) + '-' +
+                                    hex.mid(16, 4) + '-' + hex.mid(20));
+        return true;
+    }
+
+    return false;
+}
+
+bool KeyEncoder::encodeComposite(const QVector<QVariant>& values, const QVector<DataType>& types,
+                                 QByteArray& output) {
+    output.clear();
+    if (values.size() != types.size()) {
+        LOG_ERROR(QString("KeyEncoder::encodeComposite: values and types size mismatch (%1 vs %2)")
+                     .arg(values.size()).arg(types.size()));
+        return false;
+    }
+
+    for (int i = 0; i < values.size(); ++i) {
+        if (!append(values[i], types[i], output)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool KeyEncoder::decodeComposite(const QByteArray& data, const QVector<DataType>& types,
+                                 QVector<QVariant>& values) {
+    values.clear();
+    int offset = 0;
+    for (int i = 0; i < types.size() && offset < data.size(); ++i) {
+        QVariant value;
+        if (!decodeAt(data, offset, types[i], value)) {
+            return false;
+        }
+        values.append(value);
+    }
+    return offset == data.size();
+}
+
+bool KeyEncoder::isEncodableType(DataType type) {
+    switch (type) {
+        case DataType::GEOMETRY:
+        case DataType::GEOGRAPHY:
+        case DataType::NULL_TYPE:
+            return false;
+        default:
+            return true;
+    }
+}
+
+// ============ 各类型编码 ============
+
+int KeyEncoder::integerWidth(DataType type) {
+    switch (type) {
+        case DataType::TINYINT: return 1;
+        case DataType::SMALLINT: return 2;
+        case DataType::MEDIUMINT: return 3;
+        case DataType::INT:
+        case DataType::INTEGER:
+        case DataType::SERIAL: return 4;
+        default: return 8;  // BIGINT、BIGSERIAL、ROWID
+    }
+}
+
+bool KeyEncoder::appendInteger(const QVariant& value, DataType type, QByteArray& output) {
+    bool ok = false;
+    qint64 v = value.toLongLong(&ok);
+    if (!ok) {
+        return false;
+    }
+    return appendSigned(v, integerWidth(type), output);
+}
+
+bool KeyEncoder::appendFloat(const QVariant& value, DataType type, QByteArray& output) {
+    bool ok = false;
+    if (type == DataType::FLOAT || type == DataType::REAL || type == DataType::BINARY_FLOAT) {
+        float v = value.toFloat(&ok);
+        if (!ok) {
+            return false;
+        }
+        uint32_t bits;
+        if (std::isnan(v)) {
+            bits = 0x7FC00000u;  // 所有 NaN 归一为同一个值，排在 +Inf 之后
+        } else {
+            if (v == 0.0f) {
+                v = 0.0f;  // -0 与 +0 相等
+            }
+            std::memcpy(&bits, &v, sizeof(bits));
+        }
+        bits = (bits & 0x80000000u) ? ~bits : (bits | 0x80000000u);
+        for (int i = 3; i >= 0; --i) {
+            output.append(static_cast<char>((bits >> (i * 8)) & 0xFF));
+        }
+        return true;
+    }
+
+    double v = value.toDouble(&ok);
+    if (!ok) {
+        return false;
+    }
+    uint64_t bits;
+    if (std::isnan(v)) {
+        bits = 0x7FF8000000000000ull;
+    } else {
+        if (v == 0.0) {
+            v = 0.0;
+        }
+        std::memcpy(&bits, &v, sizeof(bits));
+    }
+    bits = (bits & 0x8000000000000000ull) ? ~bits : (bits | 0x8000000000000000ull);
+    for (int i = 7; i >= 0; --i) {
+        output.append(static_cast<char>((bits >> (i * 8)) & 0xFF));
+    }
+    return true;
+}
+
+/**
+ * @brief DECIMAL 编码
+ *
+ * 值规范化为 0.d1d2...dn × 10^exp（d1 != 0，去掉尾随零），编码为：
+ *   符号字节（负/零/正）+ exp（偏移 0x8000 的 2 字节大端）+ 每位数字 (d+1) + 终止符 0x00
+ * 负数把符号字节之后的全部字节取反，使绝对值越大排得越前。
+ */
+bool KeyEncoder::appendDecimal(const QVariant& value, QByteArray& output) {
+    const QString str = value.toString().trimmed();
+
+    bool negative = false;
+    int i = 0;
+    if (i < str.size() && (str[i] == '-' || str[i] == '+')) {
+        negative = (str[i] == '-');
+        ++i;
+    }
+
+    QByteArray digits;
+    int pointPos = -1;
+    qint64 exponent = 0;
+    for (; i < str.size(); ++i) {
+        const QChar c = str[i];
+        if (c.isDigit()) {
+            digits.append(static_cast<char>(c.digitValue()));
+        } else if (c == '.' && pointPos < 0) {
+            pointPos = digits.size();
+        } else if (c == 'e' || c == 'E') {
+            bool ok = false;
+            exponent = str.mid(i + 1).toLongLong(&ok);
+            if (!ok) {
+                return false;
+            }
+            break;
+        } else {
+            return false;
+        }
+    }
+    if (digits.isEmpty()) {
+        return false;
+    }
+    if (pointPos < 0) {
+        pointPos = digits.size();
+    }
+
+    qint64 exp10 = pointPos + exponent;
+    int start = 0;
+    while (start < digits.size() && digits[start] == 0) {
+        ++start;
+        --exp10;
+    }
+    int end = digits.size();
+    while (end > start && digits[end - 1] == 0) {
+        --end;
+    }
+
+    if (start == end) {
+        output.append(static_cast<char>(DECIMAL_ZERO));
+        return true;
+    }
+    if (exp10 < -0x8000 || exp10 > 0x7FFF) {
+        return false;
+    }
+
+    QByteArray body;
+    body.reserve(2 + (end - start) + 1);
+    const uint16_t biased = static_cast<uint16_t>(exp10 + 0x8000);
+    body.append(static_cast<char>(biased >> 8));
+    body.append(static_cast<char>(biased & 0xFF));
+    for (int d = start; d < end; ++d) {
+        body.append(static_cast<char>(digits[d] + 1));
+    }
+    body.append('\x00');
+
+    if (negative) {
+        for (int k = 0; k < body.size(); ++k) {
+            body[k] = static_cast<char>(~static_cast<uint8_t>(body[k]));
+        }
+    }
+
+    output.append(static_cast<char>(negative ? DECIMAL_NEGATIVE : DECIMAL_POSITIVE));
+    output.append(body);
+    return true;
+}
+
+bool KeyEncoder::appendDateTime(const QVariant& value, DataType type, QByteArray& output) {
+    switch (type) {
+        case DataType::DATE: {
+            QDate date = value.toDate();
+            if (!date.isValid()) {
+                return false;
+            }
+            return appendSigned(QDate(1970, 1, 1).daysTo(date), 4, output);
+        }
+        case DataType::TIME: {
+            QTime time = value.toTime();
+            if (!time.isValid()) {
+                return false;
+            }
+            return appendSigned(time.msecsSinceStartOfDay(), 4, output);
+        }
+        default: {
+            QDateTime dateTime = value.toDateTime();
+            if (!dateTime.isValid()) {
+                return false;
+            }
+            return appendSigned(dateTime.toMSecsSinceEpoch(), 8, output);
+        }
+    }
+}
+
+bool KeyEncoder::appendUUID(const QVariant& value, QByteArray& output) {
+    QString cleaned = value.toString();
+    cleaned.remove('{').remove('}').remove('-');
+    QByteArray bytes = QByteArray::fromHex(cleaned.toLatin1());
+    if (cleaned.size() != 32 || bytes.size() != 16) {
+        return false;
+    }
+    output.append(bytes);
+    return true;
+}
+
+void KeyEncoder::appendEscaped(const QByteArray& bytes, QByteArray& output) {
+    output.reserve(output.size() + bytes.size() + 2);
+    const char* p = bytes.constData();
+    const char* end = p + bytes.size();
+    while (p < end) {
+        const char* zero = static_cast<const char*>(std::memchr(p, 0, static_cast<size_t>(end - p)));
+        if (!zero) {
+            output.append(p, static_cast<int>(end - p));
+            break;
+        }
+        output.append(p, static_cast<int>(zero - p));
+        output.append(ESCAPE_BYTE);
+        output.append(ESCAPED_ZERO);
+        p = zero + 1;
+    }
+    output.append(ESCAPE_BYTE);
+    output.append(TERMINATOR);
+}
+
+// ============ 各类型解码 ============
+
+bool KeyEncoder::decodeInteger(const QByteArray& data, int& offset, DataType type, QVariant& value) {
+    qint64 v;
+    if (!readSigned(data, offset, integerWidth(type), v)) {
+        return false;
+    }
+    if (integerWidth(type) <= 4) {
+        value = static_cast<int>(v);
+    } else {
+        value = v;
+    }
+    return true;
+}
+
+bool KeyEncoder::decodeFloat(const QByteArray& data, int& offset, DataType type, QVariant& value) {
+    uint64_t u;
+    if (type == DataType::FLOAT || type == DataType::REAL || type == DataType::BINARY_FLOAT) {
+        if (!readUnsigned(data, offset, 4, u)) {
+            return false;
+        }
+        uint32_t bits = static_cast<uint32_t>(u);
+        bits = (bits & 0x80000000u) ? (bits & 0x7FFFFFFFu) : ~bits;
+        float v;
+        std::memcpy(&v, &bits, sizeof(v));
+        value = v;
+        return true;
+    }
+
+    if (!readUnsigned(data, offset, 8, u)) {
+        return false;
+    }
+    u = (u & 0x8000000000000000ull) ? (u & 0x7FFFFFFFFFFFFFFFull) : ~u;
+    double v;
+    std::memcpy(&v, &u, sizeof(v));
+    value = v;
+    return true;
+}
+
+bool KeyEncoder::decodeDecimal(const QByteArray& data, int& offset, QVariant& value) {
+    if (offset >= data.size()) {
+        return false;
+    }
+    const uint8_t sign = static_cast<uint8_t>(data[offset++]);
+    if (sign == DECIMAL_ZERO) {
+        value = QString("0");
+        return true;
+    }
+    if (sign != DECIMAL_NEGATIVE && sign != DECIMAL_POSITIVE) {
+        return false;
+    }
+
+    const uint8_t mask = (sign == DECIMAL_NEGATIVE) ? 0xFF : 0x00;
+    uint64_t biased;
+    if (!readUnsigned(data, offset, 2, biased)) {
+        return false;
+    }
+    const int exp10 = static_cast<int>((biased ^ (mask ? 0xFFFF : 0)) & 0xFFFF) - 0x8000;
+
+    QString digits;
+    while (true) {
+        if (offset >= data.size()) {
+            return false;
+        }
+        const uint8_t b = static_cast<uint8_t>(data[offset++]) ^ mask;
+        if (b == 0) {
+            break;
+        }
+        if (b > 10) {
+            return false;
+        }
+        digits.append(QChar('0' + (b - 1)));
+    }
+
+    QString result;
+    if (exp10 <= 0) {
+        result = "0." + QString(-exp10, '0') + digits;
+    } else if (exp10 >= digits.size()) {
+        result = digits + QString(exp10 - digits.size(), '0');
+    } else {
+        result = digits.left(exp10) + "." + digits.mid(exp10);
+    }
+    if (sign == DECIMAL_NEGATIVE) {
+        result.prepend('-');
+    }
+    value = result;
+    return true;
+}
+
+bool KeyEncoder::decodeDateTime(const QByteArray& data, int& offset, DataType type, QVariant& value) {
+    qint64 v;
+    switch (type) {
+        case DataType::DATE:
+            if (!readSigned(data, offset, 4, v)) {
+                return false;
+            }
+            value = QDate(1970, 1, 1).addDays(v);
+            return true;
+        case DataType::TIME:
+            if (!readSigned(data, offset, 4, v)) {
+                return false;
+            }
+            value = QTime::fromMSecsSinceStartOfDay(static_cast<int>(v));
+            return true;
+        default:
+            if (!readSigned(data, offset, 8, v)) {
+                return false;
+            }
+            value = QDateTime::fromMSecsSinceEpoch(v);
+            return true;
+    }
+}
+
+bool KeyEncoder::decodeEscaped(const QByteArray& data, int& offset, QByteArray& bytes) {
+    bytes.clear();
+    while (offset < data.size()) {
+        const char c = data[offset];
+        if (c != ESCAPE_BYTE) {
+            bytes.append(c);
+            ++offset;
+            continue;
+        }
+        if (offset + 1 >= data.size()) {
+            return false;
+        }
+        const char next = data[offset + 1];
+        offset += 2;
+        if (next == TERMINATOR) {
+            return true;
+        }
+        if (next != ESCAPED_ZERO) {
+            return false;
+        }
+        bytes.append('\x00');
+    }
+    return false;  // 缺少终止符
+}
+
+} // namespace qindb
@@ -0,0 +1,161 @@
+#include "qindb/posting_intersection.h"
+#include "qindb/cpu_features.h"
+#include <algorithm>
+#include <bit>
+
+#ifdef QINDB_HAS_AVX2
+#include <immintrin.h>
+#endif
+
+namespace qindb {
+
+namespace {
+
+#ifdef QINDB_HAS_AVX2
+
+bool useAvx2() {
+    return CpuFeatures::hasAvx2();
+}
+
+/**
+ * @brief 4x4 块归并求交
+ *
+ * a 的 4 个文档ID与 b 的 4 个文档ID及其 3 个旋转逐通道比较，得到 a 中命中的通道；
+ * 块内最大值较小的一侧前进 4 个，相等时两侧都前进。剩余不足 4 个的部分标量归并。
+ */
+QINDB_TARGET_AVX2
+size_t intersectAvx2(const RowId* a, size_t na, const RowId* b, size_t nb, uint32_t* outA, uint32_t* outB) {
+    size_t i = 0;
+    size_t j = 0;
+    size_t count = 0;
+
+    while (i + 4 <= na && j + 4 <= nb) {
+        const __m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+        const __m256i vb = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + j));
+
+        __m256i match = _mm256_cmpeq_epi64(va, vb);
+        match = _mm256_or_si256(match, _mm256_cmpeq_epi64(va, _mm256_permute4x64_epi64(vb, 0x39)));
+        match = _mm256_or_si256(match, _mm256_cmpeq_epi64(va, _mm256_permute4x64_epi64(vb, 0x4E)));
+        match = _mm256_or_si256(match, _mm256_cmpeq_epi64(va, _mm256_permute4x64_epi64(vb, 0x93)));
+
+        unsigned mask = static_cast<unsigned>(_mm256_movemask_pd(_mm256_castsi256_pd(match)));
+        while (mask != 0) {
+            const int lane = std::countr_zero(mask);
+            const RowId value = a[i + lane];
+            int k = 0;
+            while (b[j + k] != value) {
+                ++k;
+            }
+            outA[count] = static_cast<uint32_t>(i + lane);
+            outB[count] = static_cast<uint32_t>(j + k);
+            ++count;
+            mask &= mask - 1;
+        }
+
+        const RowId lastA = a[i + 3];
+        const RowId lastB = b[j + 3];
+        i += lastA <= lastB ? 4 : 0;
+        j += lastB <= lastA ? 4 : 0;
+    }
+
+    while (i < na && j < nb) {
+        if (a[i] < b[j]) {
+            ++i;
+        } else if (b[j] < a[i]) {
+            ++j;
+        } else {
+            outA[count] = static_cast<uint32_t>(i++);
+            outB[count] = static_cast<uint32_t>(j++);
+            ++count;
+        }
+    }
+    return count;
+}
+
+#endif // QINDB_HAS_AVX2
+
+/**
+ * @brief 短数组逐个在长数组上galloping，long 的搜索起点单调前移
+ */
+size_t intersectGalloping(const RowId* shortList, size_t ns, const RowId* longList, size_t nl,
+                          uint32_t* outShort, uint32_t* outLong) {
+    size_t count = 0;
+    size_t position = 0;
+    for (size_t i = 0; i < ns && position < nl; ++i) {
+        position = PostingIntersection::gallop(longList, position, nl, shortList[i]);
+        if (position < nl && longList[position] == shortList[i]) {
+            outShort[count] = static_cast<uint32_t>(i);
+            outLong[count] = static_cast<uint32_t>(position);
+            ++count;
+            ++position;
+        }
+    }
+    return count;
+}
+
+} // namespace
+
+size_t PostingIntersection::gallop(const RowId* data, size_t begin, size_t count, RowId target) {
+    if (begin >= count || data[begin] >= target) {
+        return begin;
+    }
+
+    // data[lo] < target，步长翻倍直到越过 target
+    size_t lo = begin;
+    size_t step = 1;
+    while (lo + step < count && data[lo + step] < target) {
+        lo += step;
+        step <<= 1;
+    }
+    size_t hi = std::min(lo + step, count);
+    return static_cast<size_t>(std::lower_bound(data + lo + 1, data + hi, target) - data);
+}
+
+size_t PostingIntersection::intersect(const RowId* a, size_t na, const RowId* b, size_t nb,
+                                      uint32_t* outA, uint32_t* outB) {
+    if (na == 0 || nb == 0) {
+        return 0;
+    }
+    if (nb / na >= GALLOP_RATIO) {
+        return intersectGalloping(a, na, b, nb, outA, outB);
+    }
+    if (na / nb >= GALLOP_RATIO) {
+        // 输出按 a 的下标升序：短数组是 b，b 升序时匹配到的 a 下标也升序
+        return intersectGalloping(b, nb, a, na, outB, outA);
+    }
+#ifdef QINDB_HAS_AVX2
+    if (useAvx2()) {
+        return intersectAvx2(a, na, b, nb, outA, outB);
+    }
+#endif
+    return intersectScalar(a, na, b, nb, outA, outB);
+}
+
+size_t PostingIntersection::intersectScalar(const RowId* a, size_t na, const RowId* b, size_t nb,
+                                            uint32_t* outA, uint32_t* outB) {
+    size_t i = 0;
+    size_t j = 0;
+    size_t count = 0;
+    while (i < na && j < nb) {
+        if (a[i] < b[j]) {
+            ++i;
+        } else if (b[j] < a[i]) {
+            ++j;
+        } else {
+            outA[count] = static_cast<uint32_t>(i++);
+            outB[count] = static_cast<uint32_t>(j++);
+            ++count;
+        }
+    }
+    return count;
+}
+
+bool PostingIntersection::isAvx2Enabled() {
+#ifdef QINDB_HAS_AVX2
+    return useAvx2();
+#else
+    return false;
+#endif
+}
+
+} // namespace qindb
@@ -0,0 +1,472 @@
+#include "qindb/roaring_bitmap.h"
+#include "qindb/cpu_features.h"
+#include "qindb/inverted_segment.h"
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstring>
+#include <iterator>
+
+#ifdef QINDB_HAS_AVX2
+#include <immintrin.h>
+#endif
+
+namespace qindb {
+
+namespace {
+
+constexpr uint8_t CONTAINER_ARRAY = 0;
+constexpr uint8_t CONTAINER_BITSET = 1;
+
+// setAvx2Allowed 的开关
+std::atomic<bool> avx2Allowed{true};
+
+uint32_t combineBitsetsScalar(const uint64_t* a, const uint64_t* b, uint64_t* out, bool intersect) {
+    uint32_t count = 0;
+    for (int i = 0; i < RoaringBitmap::BITSET_WORDS; ++i) {
+        out[i] = intersect ? (a[i] & b[i]) : (a[i] | b[i]);
+        count += static_cast<uint32_t>(std::popcount(out[i]));
+    }
+    return count;
+}
+
+#ifdef QINDB_HAS_AVX2
+
+bool useAvx2() {
+    return CpuFeatures::hasAvx2() && avx2Allowed.load(std::memory_order_relaxed);
+}
+
+/**
+ * @brief 256 位中每个 64 位通道的置位数（半字节查表 + sad 横向求和）
+ */
+QINDB_TARGET_AVX2
+__m256i popcount256(__m256i v) {
+    const __m256i lookup = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+                                            0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+    const __m256i lowMask = _mm256_set1_epi8(0x0F);
+    const __m256i lo = _mm256_and_si256(v, lowMask);
+    const __m256i hi = _mm256_and_si256(_mm256_srli_epi16(v, 4), lowMask);
+    const __m256i counts = _mm256_add_epi8(_mm256_shuffle_epi8(lookup, lo), _mm256_shuffle_epi8(lookup, hi));
+    return _mm256_sad_epu8(counts, _mm256_setzero_si256());
+}
+
+/**
+ * @brief 两个位图容器逐 256 位 AND/OR，同时累计结果的置位数
+ */
+QINDB_TARGET_AVX2
+uint32_t combineBitsetsAvx2(const uint64_t* a, const uint64_t* b, uint64_t* out, bool intersect) {
+    __m256i total = _mm256_setzero_si256();
+    for (int i = 0; i < RoaringBitmap::BITSET_WORDS; i += 4) {
+        const __m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+        const __m256i vb = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i));
+        const __m256i result = intersect ? _mm256_and_si256(va, vb) : _mm256_or_si256(va, vb);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), result);
+        total = _mm256_add_epi64(total, popcount256(result));
+    }
+
+    uint64_t lanes[4];
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(lanes), total);
+    return static_cast<uint32_t>(lanes[0] + lanes[1] + lanes[2] + lanes[3]);
+}
+
+#endif // QINDB_HAS_AVX2
+
+uint32_t combineBitsets(const uint64_t* a, const uint64_t* b, uint64_t* out, bool intersect) {
+#ifdef QINDB_HAS_AVX2
+    if (useAvx2()) {
+        return combineBitsetsAvx2(a, b, out, intersect);
+    }
+#endif
+    return combineBitsetsScalar(a, b, out, intersect);
+}
+
+bool testBit(const QVector<uint64_t>& bits, uint16_t low) {
+    return (bits[low >> 6] >> (low & 63)) & 1;
+}
+
+} // namespace
+
+bool RoaringBitmap::isAvx2Enabled() {
+#ifdef QINDB_HAS_AVX2
+    return useAvx2();
+#else
+    return false;
+#endif
+}
+
+void RoaringBitmap::setAvx2Allowed(bool allowed) {
+    avx2Allowed.store(allowed, std::memory_order_relaxed);
+}
+
+// ========== Container ==========
+
+bool RoaringBitmap::Container::contains(uint16_t low) const {
+    if (isBitset()) {
+        return testBit(bits, low);
+    }
+    return std::binary_search(array.begin(), array.end(), low);
+}
+
+bool RoaringBitmap::Container::add(uint16_t low) {
+    if (isBitset()) {
+        uint64_t& word = bits[low >> 6];
+        const uint64_t mask = uint64_t(1) << (low & 63);
+        if (word & mask) {
+            return false;
+        }
+        word |= mask;
+        ++cardinality;
+        return true;
+    }
+
+    auto it = std::lower_bound(array.begin(), array.end(), low);
+    if (it != array.end() && *it == low) {
+        return false;
+    }
+    array.insert(it, low);
+    ++cardinality;
+    if (cardinality > static_cast<uint32_t>(ARRAY_MAX)) {
+        toBitset();
+    }
+    return true;
+}
+
+bool RoaringBitmap::Container::remove(uint16_t low) {
+    if (isBitset()) {
+        uint64_t& word = bits[low >> 6];
+        const uint64_t mask = uint64_t(1) << (low & 63);
+        if (!(word & mask)) {
+            return false;
+        }
+        word &= ~mask;
+        --cardinality;
+        if (cardinality <= static_cast<uint32_t>(ARRAY_MAX)) {
+            toArray();
+        }
+        return true;
+    }
+
+    auto it = std::lower_bound(array.begin(), array.end(), low);
+    if (it == array.end() || *it != low) {
+        return false;
+    }
+    array.erase(it);
+    --cardinality;
+    return true;
+}
+
+void RoaringBitmap::Container::toBitset() {
+    bits.fill(0, BITSET_WORDS);
+    for (uint16_t low : array) {
+        bits[low >> 6] |= uint64_t(1) << (low & 63);
+    }
+    array.clear();
+}
+
+void RoaringBitmap::Container::toArray() {
+    array.clear();
+    array.reserve(static_cast<int>(cardinality));
+    for (int i = 0; i < BITSET_WORDS; ++i) {
+        uint64_t word = bits[i];
+        while (word != 0) {
+            array.append(static_cast<uint16_t>(i * 64 + std::countr_zero(word)));
+            word &= word - 1;
+        }
+    }
+    bits.clear();
+}
+
+// ========== RoaringBitmap ==========
+
+int RoaringBitmap::findContainer(uint64_t key) const {
+    auto it = std::lower_bound(containers_.begin(), containers_.end(), key,
+                               [](const Container& c, uint64_t k) { return c.key < k; });
+    if (it != containers_.end() && it->key == key) {
+        return static_cast<int>(it - containers_.begin());
+    }
+    return -1;
+}
+
+bool RoaringBitmap::add(RowId rowId) {
+    const uint64_t key = rowId >> 16;
+    const uint16_t low = static_cast<uint16_t>(rowId & 0xFFFF);
+
+    auto it = std::lower_bound(containers_.begin(), containers_.end(), key,
+                               [](const Container& c, uint64_t k) { return c.key < k; });
+    if (it == containers_.end() || it->key != key) {
+        Container container;
+        container.key = key;
+        container.cardinality = 1;
+        container.array.append(low);
+        containers_.insert(it, container);
+        return true;
+    }
+    return it->add(low);
+}
+
+bool RoaringBitmap::remove(RowId rowId) {
+    const int index = findContainer(rowId >> 16);
+    if (index < 0) {
+        return false;
+    }
+
+    Container& container = containers_[index];
+    if (!container.remove(static_cast<uint16_t>(rowId & 0xFFFF))) {
+        return false;
+    }
+    if (container.cardinality == 0) {
+        containers_.remove(index);
+    }
+    return true;
+}
+
+bool RoaringBitmap::contains(RowId rowId) const {
+    const int index = findContainer(rowId >> 16);
+    return index >= 0 && containers_[index].contains(static_cast<uint16_t>(rowId & 0xFFFF));
+}
+
+uint64_t RoaringBitmap::cardinality() const {
+    uint64_t total = 0;
+    for (const Container& container : containers_) {
+        total += container.cardinality;
+    }
+    return total;
+}
+
+RoaringBitmap::Container RoaringBitmap::intersectContainers(const Container& a, const Container& b) {
+    Container result;
+    result.key = a.key;
+
+    if (a.isBitset() && b.isBitset()) {
+        result.bits.resize(BITSET_WORDS);
+        result.cardinality = combineBitsets(a.bits.constData(), b.bits.constData(), result.bits.data(), true);
+        if (result.cardinality <= static_cast<uint32_t>(ARRAY_MAX)) {
+            result.toArray();
+        }
+        return result;
+    }
+
+    if (a.isBitset() || b.isBitset()) {
+        // 数组容器逐个查位图，结果不会超过数组容器的大小
+        const Container& arrayContainer = a.isBitset() ? b : a;
+        const Container& bitsetContainer = a.isBitset() ? a : b;
+        result.array.reserve(arrayContainer.array.size());
+        for (uint16_t low : arrayContainer.array) {
+            if (testBit(bitsetContainer.bits, low)) {
+                result.array.append(low);
+            }
+        }
+    } else {
+        result.array.reserve(std::min(a.array.size(), b.array.size()));
+        std::set_intersection(a.array.begin(), a.array.end(), b.array.begin(), b.array.end(),
+                              std::back_inserter(result.array));
+    }
+    result.cardinality = static_cast<uint32_t>(result.array.size());
+    return result;
+}
+
+RoaringBitmap::Container RoaringBitmap::uniteContainers(const Container& a, const Container& b) {
+    Container result;
+    result.key = a.key;
+
+    if (a.isBitset() && b.isBitset()) {
+        result.bits.resize(BITSET_WORDS);
+        result.cardinality = combineBitsets(a.bits.constData(), b.bits.constData(), result.bits.data(), false);
+        return result;
+    }
+
+    if (a.isBitset() || b.isBitset()) {
+        const Container& arrayContainer = a.isBitset() ? b : a;
+        result = a.isBitset() ? a : b;
+        for (uint16_t low : arrayContainer.array) {
+            uint64_t& word = result.bits[low >> 6];
+            const uint64_t mask = uint64_t(1) << (low & 63);
+            if (!(word & mask)) {
+                word |= mask;
+                ++result.cardinality;
+            }
+        }
+        return result;
+    }
+
+    result.array.reserve(a.array.size() + b.array.size());
+    std::set_union(a.array.begin(), a.array.end(), b.array.begin(), b.array.end(),
+                   std::back_inserter(result.array));
+    result.cardinality = static_cast<uint32_t>(result.array.size());
+    if (result.cardinality > static_cast<uint32_t>(ARRAY_MAX)) {
+        result.toBitset();
+    }
+    return result;
+}
+
+void RoaringBitmap::intersectWith(const RoaringBitmap& other) {
+    *this = intersect(*this, other);
+}
+
+void RoaringBitmap::uniteWith(const RoaringBitmap& other) {
+    *this = unite(*this, other);
+}
+
+RoaringBitmap RoaringBitmap::intersect(const RoaringBitmap& a, const RoaringBitmap& b) {
+    RoaringBitmap result;
+    int i = 0;
+    int j = 0;
+    while (i < a.containers_.size() && j < b.containers_.size()) {
+        const Container& ca = a.containers_[i];
+        const Container& cb = b.containers_[j];
+        if (ca.key < cb.key) {
+            ++i;
+        } else if (cb.key < ca.key) {
+            ++j;
+        } else {
+            Container merged = intersectContainers(ca, cb);
+            if (merged.cardinality > 0) {
+                result.containers_.append(std::move(merged));
+            }
+            ++i;
+            ++j;
+        }
+    }
+    return result;
+}
+
+RoaringBitmap RoaringBitmap::unite(const RoaringBitmap& a, const RoaringBitmap& b) {
+    RoaringBitmap result;
+    result.containers_.reserve(a.containers_.size() + b.containers_.size());
+    int i = 0;
+    int j = 0;
+    while (i < a.containers_.size() || j < b.containers_.size()) {
+        if (j >= b.containers_.size() || (i < a.containers_.size() && a.containers_[i].key < b.containers_[j].key)) {
+            result.containers_.append(a.containers_[i++]);
+        } else if (i >= a.containers_.size() || b.containers_[j].key < a.containers_[i].key) {
+            result.containers_.append(b.containers_[j++]);
+        } else {
+            result.containers_.append(uniteContainers(a.containers_[i++], b.containers_[j++]));
+        }
+    }
+    return result;
+}
+
+QVector<RowId> RoaringBitmap::toVector() const {
+    QVector<RowId> rowIds;
+    rowIds.reserve(static_cast<int>(cardinality()));
+    for (const Container& container : containers_) {
+        const RowId high = static_cast<RowId>(container.key) << 16;
+        if (container.isBitset()) {
+            for (int i = 0; i < BITSET_WORDS; ++i) {
+                uint64_t word = container.bits[i];
+                while (word != 0) {
+                    rowIds.append(high | static_cast<RowId>(i * 64 + std::countr_zero(word)));
+                    word &= word - 1;
+                }
+            }
+        } else {
+            for (uint16_t low : container.array) {
+                rowIds.append(high | low);
+            }
+        }
+    }
+    return rowIds;
+}
+
+QByteArray RoaringBitmap::serialize() const {
+    QByteArray out;
+    Varint::append(out, static_cast<uint64_t>(containers_.size()));
+    for (const Container& container : containers_) {
+        Varint::append(out, container.key);
+        out.append(static_cast<char>(container.isBitset() ? CONTAINER_BITSET : CONTAINER_ARRAY));
+        Varint::append(out, container.cardinality);
+        if (container.isBitset()) {
+            out.append(reinterpret_cast<const char*>(container.bits.constData()),
+                       BITSET_WORDS * static_cast<int>(sizeof(uint64_t)));
+        } else {
+            out.append(reinterpret_cast<const char*>(container.array.constData()),
+                       container.array.size() * static_cast<int>(sizeof(uint16_t)));
+        }
+    }
+    return out;
+}
+
+bool RoaringBitmap::deserialize(const QByteArray& data) {
+    containers_.clear();
+
+    const char* p = data.constData();
+    const char* end = p + data.size();
+    uint64_t count = 0;
+    if (!Varint::decode(p, end, count)) {
+        return false;
+    }
+
+    bool ok = true;
+    for (uint64_t n = 0; n < count && ok; ++n) {
+        Container container;
+        uint64_t cardinality = 0;
+        if (!Varint::decode(p, end, container.key) || p >= end) {
+            ok = false;
+            break;
+        }
+        const uint8_t type = static_cast<uint8_t>(*p++);
+        if (!Varint::decode(p, end, cardinality) || cardinality == 0 || cardinality > 65536 ||
+            (!containers_.isEmpty() && containers_.back().key >= container.key)) {
+            ok = false;
+            break;
+        }
+        container.cardinality = static_cast<uint32_t>(cardinality);
+
+        if (type == CONTAINER_BITSET) {
+            const size_t bytes = BITSET_WORDS * sizeof(uint64_t);
+            if (static_cast<size_t>(end - p) < bytes || cardinality <= static_cast<uint64_t>(ARRAY_MAX)) {
+                ok = false;
+                break;
+            }
+            container.bits.resize(BITSET_WORDS);
+            std::memcpy(container.bits.data(), p, bytes);
+            p += bytes;
+
+            uint64_t actual = 0;
+            for (uint64_t word : container.bits) {
+                actual += static_cast<uint64_t>(std::popcount(word));
+            }
+            ok = actual == cardinality;
+        } else if (type == CONTAINER_ARRAY) {
+            const size_t bytes = cardinality * sizeof(uint16_t);
+            if (static_cast<size_t>(end - p) < bytes || cardinality > static_cast<uint64_t>(ARRAY_MAX)) {
+                ok = false;
+                break;
+            }
+            container.array.resize(static_cast<int>(cardinality));
+            std::memcpy(container.array.data(), p, bytes);
+            p += bytes;
+            ok = std::adjacent_find(container.array.begin(), container.array.end(),
+                                    [](uint16_t x, uint16_t y) { return x >= y; }) == container.array.end();
+        } else {
+            ok = false;
+        }
+
+        if (ok) {
+            containers_.append(std::move(container));
+        }
+    }
+
+    if (!ok || p != end) {
+        containers_.clear();
+        return false;
+    }
+    return true;
+}
+
+bool RoaringBitmap::operator==(const RoaringBitmap& other) const {
+    if (containers_.size() != other.containers_.size()) {
+        return false;
+    }
+    for (int i = 0; i < containers_.size(); ++i) {
+        const Container& a = containers_[i];
+        const Container& b = other.containers_[i];
+        if (a.key != b.key || a.cardinality != b.cardinality || a.array != b.array || a.bits != b.bits) {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace qindb
@@ -0,0 +1,850 @@
+#include "qindb/rtree_index.h"
+#include "qindb/logger.h"
+#include "qindb/page.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+namespace qindb {
+
+namespace {
+
+// 元数据页（页头之后）：magic(4) version(4) maxEntries(4) height(4) rootPageId(4) reserved(4) entryCount(8)
+constexpr uint32_t META_MAGIC = 0x52545251;  // "QRTR"
+constexpr uint32_t META_VERSION = 1;
+constexpr size_t META_MAGIC_OFFSET = 0;
+constexpr size_t META_VERSION_OFFSET = 4;
+constexpr size_t META_MAX_ENTRIES_OFFSET = 8;
+constexpr size_t META_HEIGHT_OFFSET = 12;
+constexpr size_t META_ROOT_OFFSET = 16;
+constexpr size_t META_ENTRY_COUNT_OFFSET = 24;
+
+// 节点页（页头之后）：level(2) count(2) reserved(4)，之后是定长条目
+constexpr size_t NODE_LEVEL_OFFSET = 0;
+constexpr size_t NODE_COUNT_OFFSET = 2;
+constexpr size_t NODE_HEADER_SIZE = 8;
+
+// 条目：minX(8) minY(8) maxX(8) maxY(8) ref(8)
+constexpr size_t ENTRY_SIZE = 40;
+
+constexpr int MIN_MAX_ENTRIES = 4;
+
+// ChooseSubtree 计算重叠增量时只考虑面积增量最小的这么多个候选（R* 论文的近似做法）
+constexpr int OVERLAP_CANDIDATES = 32;
+
+template <typename T>
+T readField(const char* data, size_t offset) {
+    T value;
+    memcpy(&value, data + offset, sizeof(T));
+    return value;
+}
+
+template <typename T>
+void writeField(char* data, size_t offset, T value) {
+    memcpy(data + offset, &value, sizeof(T));
+}
+
+BoundingBox boundsOf(const QVector<RTreeIndex::Entry>& entries, int from, int to) {
+    BoundingBox box = entries[from].box;
+    for (int i = from + 1; i < to; ++i) {
+        box.expand(entries[i].box);
+    }
+    return box;
+}
+
+} // namespace
+
+// ============ 节点与页面 ============
+
+int RTreeIndex::pageCapacity() {
+    return static_cast<int>((PAGE_SIZE - sizeof(PageHeader) - NODE_HEADER_SIZE) / ENTRY_SIZE);
+}
+
+BoundingBox RTreeIndex::Node::bounds() const {
+    return entries.isEmpty() ? BoundingBox() : boundsOf(entries, 0, entries.size());
+}
+
+RTreeIndex::RTreeIndex(BufferPoolManager* bufferPool, PageId metaPageId)
+    : bufferPool_(bufferPool)
+    , metaPageId_(metaPageId) {
+}
+
+bool RTreeIndex::readNode(PageId pageId, Node& node) const {
+    Page* page = bufferPool_->fetchPage(pageId);
+    if (!page) {
+        LOG_ERROR(QString("Failed to fetch R-tree node page %1").arg(pageId));
+        return false;
+    }
+
+    const char* data = page->getData() + sizeof(PageHeader);
+    node.level = readField<uint16_t>(data, NODE_LEVEL_OFFSET);
+    const int count = readField<uint16_t>(data, NODE_COUNT_OFFSET);
+    if (count > pageCapacity()) {
+        bufferPool_->unpinPage(pageId, false);
+        LOG_ERROR(QString("Corrupt R-tree node page %1 (%2 entries)").arg(pageId).arg(count));
+        return false;
+    }
+
+    node.entries.resize(count);
+    const char* entryData = data + NODE_HEADER_SIZE;
+    for (int i = 0; i < count; ++i) {
+        Entry& entry = node.entries[i];
+        entry.box.minX = readField<double>(entryData, 0);
+        entry.box.minY = readField<double>(entryData, 8);
+        entry.box.maxX = readField<double>(entryData, 16);
+        entry.box.maxY = readField<double>(entryData, 24);
+        entry.ref = readField<uint64_t>(entryData, 32);
+        entryData += ENTRY_SIZE;
+    }
+
+    bufferPool_->unpinPage(pageId, false);
+    return true;
+}
+
+bool RTreeIndex::writeNode(PageId pageId, const Node& node) {
+    Page* page = bufferPool_->fetchPage(pageId);
+    if (!page) {
+        LOG_ERROR(QString("Failed to fetch R-tree node page %1").arg(pageId));
+        return false;
+    }
+
+    char* data = page->getData() + sizeof(PageHeader);
+    writeField<uint16_t>(data, NODE_LEVEL_OFFSET, node.level);
+    writeField<uint16_t>(data, NODE_COUNT_OFFSET, static_cast<uint16_t>(node.entries.size()));
+    page->getHeader()->slotCount = static_cast<uint16_t>(node.entries.size());
+
+    char* entryData = data + NODE_HEADER_SIZE;
+    for (const Entry& entry : node.entries) {
+        writeField<double>(entryData, 0, entry.box.minX);
+        writeField<double>(entryData, 8, entry.box.minY);
+        writeField<double>(entryData, 16, entry.box.maxX);
+        writeField<double>(entryData, 24, entry.box.maxY);
+        writeField<uint64_t>(entryData, 32, entry.ref);
+        entryData += ENTRY_SIZE;
+    }
+
+    bufferPool_->unpinPage(pageId, true);
+    return true;
+}
+
+bool RTreeIndex::allocateNode(PageId& pageId) {
+    Page* page = bufferPool_->newPage(&pageId);
+    if (!page) {
+        LOG_ERROR("Failed to allocate R-tree node page");
+        return false;
+    }
+
+    memset(page->getData(), 0, PAGE_SIZE);
+    page->setPageId(pageId);
+    page->setPageType(PageType::RTREE_NODE_PAGE);
+    bufferPool_->unpinPage(pageId, true);
+    return true;
+}
+
+bool RTreeIndex::writeMeta() {
+    Page* metaPage = bufferPool_->fetchPage(metaPageId_);
+    if (!metaPage) {
+        LOG_ERROR(QString("Failed to fetch R-tree meta page %1").arg(metaPageId_));
+        return false;
+    }
+
+    char* meta = metaPage->getData() + sizeof(PageHeader);
+    writeField<uint32_t>(meta, META_MAGIC_OFFSET, META_MAGIC);
+    writeField<uint32_t>(meta, META_VERSION_OFFSET, META_VERSION);
+    writeField<uint32_t>(meta, META_MAX_ENTRIES_OFFSET, static_cast<uint32_t>(maxEntries_));
+    writeField<uint32_t>(meta, META_HEIGHT_OFFSET, static_cast<uint32_t>(height_));
+    writeField<PageId>(meta, META_ROOT_OFFSET, rootPageId_);
+    writeField<uint64_t>(meta, META_ENTRY_COUNT_OFFSET, entryCount_);
+    bufferPool_->unpinPage(metaPageId_, true);
+    return true;
+}
+
+// ============ 创建与加载 ============
+
+bool RTreeIndex::create(int maxEntries) {
+    maxEntries_ = maxEntries > 0 ? std::clamp(maxEntries, MIN_MAX_ENTRIES, pageCapacity()) : pageCapacity();
+    minEntries_ = std::max(2, maxEntries_ * 2 / 5);
+
+    Page* metaPage = bufferPool_->newPage(&metaPageId_);
+    if (!metaPage) {
+        metaPageId_ = INVALID_PAGE_ID;
+        LOG_ERROR("Failed to allocate R-tree meta page");
+        return false;
+    }
+
+    memset(metaPage->getData(), 0, PAGE_SIZE);
+    metaPage->setPageId(metaPageId_);
+    metaPage->setPageType(PageType::RTREE_NODE_PAGE);
+    bufferPool_->unpinPage(metaPageId_, true);
+
+    if (!allocateNode(rootPageId_) || !writeNode(rootPageId_, Node())) {
+        return false;
+    }
+    height_ = 1;
+    entryCount_ = 0;
+    return writeMeta();
+}
+
+bool RTreeIndex::load() {
+    if (metaPageId_ == INVALID_PAGE_ID) {
+        return false;
+    }
+
+    Page* metaPage = bufferPool_->fetchPage(metaPageId_);
+    if (!metaPage) {
+        LOG_ERROR(QString("Failed to fetch R-tree meta page %1").arg(metaPageId_));
+        return false;
+    }
+
+    const char* meta = metaPage->getData() + sizeof(PageHeader);
+    const uint32_t magic = readField<uint32_t>(meta, META_MAGIC_OFFSET);
+    const uint32_t version = readField<uint32_t>(meta, META_VERSION_OFFSET);
+    maxEntries_ = static_cast<int>(readField<uint32_t>(meta, META_MAX_ENTRIES_OFFSET));
+    height_ = static_cast<int>(readField<uint32_t>(meta, META_HEIGHT_OFFSET));
+    rootPageId_ = readField<PageId>(meta, META_ROOT_OFFSET);
+    entryCount_ = readField<uint64_t>(meta, META_ENTRY_COUNT_OFFSET);
+    bufferPool_->unpinPage(metaPageId_, false);
+
+    if (magic != META_MAGIC || version != META_VERSION ||
+        maxEntries_ < MIN_MAX_ENTRIES || maxEntries_ > pageCapacity() ||
+        height_ < 1 || rootPageId_ == INVALID_PAGE_ID) {
+        LOG_ERROR(QString("Invalid R-tree meta page %1").arg(metaPageId_));
+        return false;
+    }
+    minEntries_ = std::max(2, maxEntries_ * 2 / 5);
+    return true;
+}
+
+// ============ 插入 ============
+
+bool RTreeIndex::insert(const BoundingBox& box, RowId rowId) {
+    reinsertedLevels_.clear();
+
+    Entry entry;
+    entry.box = box;
+    entry.ref = rowId;
+    if (!insertEntry(entry, 0)) {
+        return false;
+    }
+
+    ++entryCount_;
+    return writeMeta();
+}
+
+bool RTreeIndex::insertEntry(const Entry& entry, int level) {
+    Path path;
+    if (!chooseSubtree(entry.box, level, path)) {
+        return false;
+    }
+    path.nodes.last().entries.append(entry);
+    return resolveOverflow(path);
+}
+
+bool RTreeIndex::chooseSubtree(const BoundingBox& box, int level, Path& path) const {
+    Node node;
+    PageId pageId = rootPageId_;
+    if (!readNode(pageId, node)) {
+        return false;
+    }
+    if (node.level < level) {
+        LOG_ERROR(QString("R-tree has no level %1 (root level %2)").arg(level).arg(node.level));
+        return false;
+    }
+
+    path.pages.append(pageId);
+    path.nodes.append(node);
+    while (path.nodes.last().level > level) {
+        const Node& current = path.nodes.last();
+        if (current.entries.isEmpty()) {
+            LOG_ERROR(QString("Empty R-tree internal node %1").arg(path.pages.last()));
+            return false;
+        }
+        const int slot = chooseChild(current, box);
+        const PageId childId = static_cast<PageId>(current.entries[slot].ref);
+
+        Node child;
+        if (!readNode(childId, child)) {
+            return false;
+        }
+        path.slots.append(slot);
+        path.pages.append(childId);
+        path.nodes.append(child);
+    }
+    return true;
+}
+
+int RTreeIndex::chooseChild(const Node& node, const BoundingBox& box) const {
+    const QVector<Entry>& entries = node.entries;
+
+    auto enlargement = [&box](const Entry& entry) {
+        return entry.box.united(box).area() - entry.box.area();
+    };
+
+    // 按面积增量（相同时按面积）排序候选
+    QVector<int> order(entries.size());
+    for (int i = 0; i < order.size(); ++i) {
+        order[i] = i;
+    }
+    std::sort(order.begin(), order.end(), [&](int a, int b) {
+        const double ea = enlargement(entries[a]);
+        const double eb = enlargement(entries[b]);
+        if (ea != eb) {
+            return ea < eb;
+        }
+        return entries[a].box.area() < entries[b].box.area();
+    });
+
+    if (node.level != 1) {
+        return order[0];
+    }
+
+    // 子节点是叶子：选重叠增量最小的（相同时保持面积增量的顺序）
+    int best = order[0];
+    double bestOverlap = std::numeric_limits<double>::infinity();
+    const int candidates = std::min(static_cast<int>(order.size()), OVERLAP_CANDIDATES);
+    for (int c = 0; c < candidates; ++c) {
+        const int i = order[c];
+        const BoundingBox enlarged = entries[i].box.united(box);
+        double overlapDelta = 0.0;
+        for (int j = 0; j < entries.size(); ++j) {
+            if (j != i) {
+                overlapDelta += enlarged.overlap(entries[j].box) - entries[i].box.overlap(entries[j].box);
+            }
+        }
+        if (overlapDelta < bestOverlap) {
+            bestOverlap = overlapDelta;
+            best = i;
+        }
+    }
+    return best;
+}
+
+bool RTreeIndex::resolveOverflow(Path& path) {
+    int depth = path.nodes.size() - 1;
+    while (true) {
+        Node& node = path.nodes[depth];
+        if (node.entries.size() <= maxEntries_) {
+            return writeNode(path.pages[depth], node) && updateAncestors(path, depth);
+        }
+
+        // 每层第一次溢出时强制重插：移出离中心最远的条目，让它们有机会进入更合适的节点
+        const int level = node.level;
+        if (depth > 0 && !reinsertedLevels_.contains(level)) {
+            reinsertedLevels_.insert(level);
+            const QVector<Entry> removed = takeReinsertEntries(node);
+            if (!writeNode(path.pages[depth], node) || !updateAncestors(path, depth)) {
+                return false;
+            }
+            for (const Entry& entry : removed) {
+                if (!insertEntry(entry, level)) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        // 分裂：原节点保留一组，另一组放入新页
+        Node sibling;
+        sibling.level = node.level;
+        splitEntries(node.entries, sibling.entries);
+        PageId siblingId = INVALID_PAGE_ID;
+        if (!allocateNode(siblingId) ||
+            !writeNode(path.pages[depth], node) || !writeNode(siblingId, sibling)) {
+            return false;
+        }
+
+        Entry siblingEntry;
+        siblingEntry.box = sibling.bounds();
+        siblingEntry.ref = siblingId;
+
+        if (depth == 0) {
+            // 根分裂：树长高一层
+            Node root;
+            root.level = static_cast<uint16_t>(node.level + 1);
+            Entry oldRootEntry;
+            oldRootEntry.box = node.bounds();
+            oldRootEntry.ref = path.pages[0];
+            root.entries.append(oldRootEntry);
+            root.entries.append(siblingEntry);
+
+            PageId newRootId = INVALID_PAGE_ID;
+            if (!allocateNode(newRootId) || !writeNode(newRootId, root)) {
+                return false;
+            }
+            rootPageId_ = newRootId;
+            ++height_;
+            return writeMeta();
+        }
+
+        Node& parent = path.nodes[depth - 1];
+        parent.entries[path.slots[depth - 1]].box = node.bounds();
+        parent.entries.append(siblingEntry);
+        --depth;
+    }
+}
+
+bool RTreeIndex::updateAncestors(Path& path, int depth) {
+    for (int i = depth - 1; i >= 0; --i) {
+        const BoundingBox childBox = path.nodes[i + 1].bounds();
+        Entry& entry = path.nodes[i].entries[path.slots[i]];
+        if (entry.box == childBox) {
+            break;  // 再往上的矩形也不会变
+        }
+        entry.box = childBox;
+        if (!writeNode(path.pages[i], path.nodes[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+QVector<RTreeIndex::Entry> RTreeIndex::takeReinsertEntries(Node& node) const {
+    const BoundingBox box = node.bounds();
+    const double cx = box.centerX();
+    const double cy = box.centerY();
+    auto distanceSq = [cx, cy](const Entry& entry) {
+        const double dx = entry.box.centerX() - cx;
+        const double dy = entry.box.centerY() - cy;
+        return dx * dx + dy * dy;
+    };
+
+    // 按条目中心到节点中心的距离降序，前 30% 移出
+    std::sort(node.entries.begin(), node.entries.end(), [&](const Entry& a, const Entry& b) {
+        return distanceSq(a) > distanceSq(b);
+    });
+    const int count = std::max(1, maxEntries_ * 3 / 10);
+    QVector<Entry> removed = node.entries.mid(0, count);
+    node.entries.remove(0, count);
+
+    // 由近到远重插（close reinsert）
+    std::reverse(removed.begin(), removed.end());
+    return removed;
+}
+
+void RTreeIndex::splitEntries(QVector<Entry>& entries, QVector<Entry>& siblingEntries) const {
+    const int total = entries.size();
+    const int minCount = std::min(minEntries_, total / 2);
+
+    // 某种排序下的全部切分：前 k 个一组、其余一组，k 取 [minCount, total - minCount]
+    struct Distribution {
+        double marginSum = 0.0;
+        double overlap = 0.0;
+        double area = 0.0;
+        int split = 0;
+    };
+    auto evaluate = [&](const QVector<Entry>& sorted, QVector<Distribution>& out) {
+        QVector<BoundingBox> prefix(total);
+        QVector<BoundingBox> suffix(total);
+        prefix[0] = sorted[0].box;
+        for (int i = 1; i < total; ++i) {
+            prefix[i] = prefix[i - 1].united(sorted[i].box);
+        }
+        suffix[total - 1] = sorted[total - 1].box;
+        for (int i = total - 2; i >= 0; --i) {
+            suffix[i] = suffix[i + 1].united(sorted[i].box);
+        }
+        out.clear();
+        for (int k = minCount; k <= total - minCount; ++k) {
+            const BoundingBox& first = prefix[k - 1];
+            const BoundingBox& second = suffix[k];
+            Distribution d;
+            d.marginSum = first.margin() + second.margin();
+            d.overlap = first.overlap(second);
+            d.area = first.area() + second.area();
+            d.split = k;
+            out.append(d);
+        }
+    };
+
+    // 每个轴按下边界、上边界各排序一次
+    auto sortedBy = [&entries](int axis, bool byUpper) {
+        QVector<Entry> sorted = entries;
+        std::sort(sorted.begin(), sorted.end(), [axis, byUpper](const Entry& a, const Entry& b) {
+            const double la = axis == 0 ? a.box.minX : a.box.minY;
+            const double lb = axis == 0 ? b.box.minX : b.box.minY;
+            const double ua = axis == 0 ? a.box.maxX : a.box.maxY;
+            const double ub = axis == 0 ? b.box.maxX : b.box.maxY;
+            if (byUpper) {
+                return ua != ub ? ua < ub : la < lb;
+            }
+            return la != lb ? la < lb : ua < ub;
+        });
+        return sorted;
+    };
+
+    // ChooseSplitAxis：周长之和最小的轴
+    int bestAxis = 0;
+    double bestMargin = std::numeric_limits<double>::infinity();
+    QVector<Distribution> distributions;
+    for (int axis = 0; axis < 2; ++axis) {
+        double marginSum = 0.0;
+        for (bool byUpper : {false, true}) {
+            evaluate(sortedBy(axis, byUpper), distributions);
+            for (const Distribution& d : distributions) {
+                marginSum += d.marginSum;
+            }
+        }
+        if (marginSum < bestMargin) {
+            bestMargin = marginSum;
+            bestAxis = axis;
+        }
+    }
+
+    // ChooseSplitIndex：该轴上重叠最小（相同时面积之和最小）的切分
+    QVector<Entry> bestSorted;
+    int bestSplit = total / 2;
+    double bestOverlap = std::numeric_limits<double>::infinity();
+    double bestArea = std::numeric_limits<double>::infinity();
+    for (bool byUpper : {false, true}) {
+        QVector<Entry> sorted = sortedBy(bestAxis, byUpper);
+        evaluate(sorted, distributions);
+        for (const Distribution& d : distributions) {
+            if (d.overlap < bestOverlap || (d.overlap == bestOverlap && d.area < bestArea)) {
+                bestOverlap = d.overlap;
+                bestArea = d.area;
+                bestSplit = d.split;
+                bestSorted = sorted;
+            }
+        }
+    }
+
+    entries = bestSorted.mid(0, bestSplit);
+    siblingEntries = bestSorted.mid(bestSplit);
+}
+
+// ============ 删除 ============
+
+bool RTreeIndex::findLeaf(PageId pageId, const BoundingBox& box, RowId rowId, Path& path) const {
+    Node node;
+    if (!readNode(pageId, node)) {
+        return false;
+    }
+
+    path.pages.append(pageId);
+    path.nodes.append(node);
+    for (int i = 0; i < node.entries.size(); ++i) {
+        const Entry& entry = node.entries[i];
+        if (node.level == 0) {
+            if (entry.ref == rowId && entry.box == box) {
+                path.slots.append(i);
+                return true;
+            }
+            continue;
+        }
+        if (!entry.box.contains(box)) {
+            continue;
+        }
+        path.slots.append(i);
+        if (findLeaf(static_cast<PageId>(entry.ref), box, rowId, path)) {
+            return true;
+        }
+        path.slots.removeLast();
+    }
+
+    path.pages.removeLast();
+    path.nodes.removeLast();
+    return false;
+}
+
+bool RTreeIndex::remove(const BoundingBox& box, RowId rowId) {
+    // 找到叶子后 slots 比 nodes 多一项：最后一项是叶子中的条目下标
+    Path path;
+    if (!findLeaf(rootPageId_, box, rowId, path)) {
+        return false;
+    }
+    const int leafDepth = path.nodes.size() - 1;
+    path.nodes[leafDepth].entries.remove(path.slots.takeLast());
+
+    // CondenseTree：自底向上，条目不足的节点整体摘下，条目留待重插回原层
+    struct Orphan {
+        int level;
+        Entry entry;
+    };
+    QVector<Orphan> orphans;
+    for (int depth = leafDepth; depth > 0; --depth) {
+        Node& node = path.nodes[depth];
+        Node& parent = path.nodes[depth - 1];
+        if (node.entries.size() < minEntries_) {
+            for (const Entry& entry : node.entries) {
+                orphans.append(Orphan{node.level, entry});
+            }
+            parent.entries.remove(path.slots[depth - 1]);
+            bufferPool_->deletePage(path.pages[depth]);
+        } else {
+            if (!writeNode(path.pages[depth], node)) {
+                return false;
+            }
+            parent.entries[path.slots[depth - 1]].box = node.bounds();
+        }
+    }
+
+    Node& root = path.nodes[0];
+    if (root.level > 0 && root.entries.isEmpty()) {
+        root.level = 0;
+        height_ = 1;
+    }
+    if (!writeNode(rootPageId_, root)) {
+        return false;
+    }
+    --entryCount_;
+
+    // 高层的条目先重插；比当前根还高的子树（根已被清空时）拆成叶子条目重插
+    std::stable_sort(orphans.begin(), orphans.end(), [](const Orphan& a, const Orphan& b) {
+        return a.level > b.level;
+    });
+    reinsertedLevels_.clear();
+    for (const Orphan& orphan : orphans) {
+        if (orphan.level > height_ - 1) {
+            QVector<Entry> leafEntries;
+            if (!collectLeafEntries(static_cast<PageId>(orphan.entry.ref), leafEntries, true)) {
+                return false;
+            }
+            for (const Entry& entry : leafEntries) {
+                if (!insertEntry(entry, 0)) {
+                    return false;
+                }
+            }
+            continue;
+        }
+        if (!insertEntry(orphan.entry, orphan.level)) {
+            return false;
+        }
+    }
+
+    // 根只剩一个子节点时降低树高
+    Node top;
+    if (!readNode(rootPageId_, top)) {
+        return false;
+    }
+    while (top.level > 0 && top.entries.size() == 1) {
+        const PageId childId = static_cast<PageId>(top.entries[0].ref);
+        bufferPool_->deletePage(rootPageId_);
+        rootPageId_ = childId;
+        --height_;
+        if (!readNode(rootPageId_, top)) {
+            return false;
+        }
+    }
+
+    return writeMeta();
+}
+
+bool RTreeIndex::collectLeafEntries(PageId pageId, QVector<Entry>& entries, bool freePages) {
+    Node node;
+    if (!readNode(pageId, node)) {
+        return false;
+    }
+    if (node.level == 0) {
+        entries += node.entries;
+    } else {
+        for (const Entry& entry : node.entries) {
+            if (!collectLeafEntries(static_cast<PageId>(entry.ref), entries, freePages)) {
+                return false;
+            }
+        }
+    }
+    if (freePages) {
+        bufferPool_->deletePage(pageId);
+    }
+    return true;
+}
+
+// ============ 批量构建 ============
+
+bool RTreeIndex::bulkLoad(QVector<Entry> entries) {
+    if (entryCount_ != 0) {
+        LOG_ERROR("R-tree bulk load requires an empty index");
+        return false;
+    }
+    if (entries.isEmpty()) {
+        return true;
+    }
+
+    const uint64_t total = static_cast<uint64_t>(entries.size());
+    uint16_t level = 0;
+    while (entries.size() > maxEntries_) {
+        // STR：按中心 x 排序后切成 ceil(sqrt(P)) 条竖带，每条带内按中心 y 排序
+        const int n = entries.size();
+        const int nodeCount = (n + maxEntries_ - 1) / maxEntries_;
+        const int sliceCount = static_cast<int>(std::ceil(std::sqrt(static_cast<double>(nodeCount))));
+        const int sliceSize = (n + sliceCount - 1) / sliceCount;
+
+        std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) {
+            return a.box.centerX() < b.box.centerX();
+        });
+        for (int start = 0; start < n; start += sliceSize) {
+            const int end = std::min(n, start + sliceSize);
+            std::sort(entries.begin() + start, entries.begin() + end, [](const Entry& a, const Entry& b) {
+                return a.box.centerY() < b.box.centerY();
+            });
+        }
+
+        // 按上面的顺序均匀装入 nodeCount 个节点（每个节点的条目数相差不超过 1，都不少于下限）
+        QVector<Entry> parents;
+        parents.reserve(nodeCount);
+        int start = 0;
+        for (int i = 0; i < nodeCount; ++i) {
+            const int count = n / nodeCount + (i < n % nodeCount ? 1 : 0);
+            Node node;
+            node.level = level;
+            node.entries = entries.mid(start, count);
+            start += count;
+
+            PageId pageId = INVALID_PAGE_ID;
+            if (!allocateNode(pageId) || !writeNode(pageId, node)) {
+                return false;
+            }
+            Entry parent;
+            parent.box = node.bounds();
+            parent.ref = pageId;
+            parents.append(parent);
+        }
+
+        entries = std::move(parents);
+        ++level;
+    }
+
+    // 最上层写入现有的根页
+    Node root;
+    root.level = level;
+    root.entries = entries;
+    if (!writeNode(rootPageId_, root)) {
+        return false;
+    }
+    height_ = level + 1;
+    entryCount_ = total;
+    return writeMeta();
+}
+
+// ============ 查询 ============
+
+bool RTreeIndex::search(const BoundingBox& query, QVector<RowId>& rowIds) const {
+    rowIds.clear();
+    QVector<PageId> stack{rootPageId_};
+    while (!stack.isEmpty()) {
+        Node node;
+        if (!readNode(stack.takeLast(), node)) {
+            return false;
+        }
+        for (const Entry& entry : node.entries) {
+            if (!entry.box.intersects(query)) {
+                continue;
+            }
+            if (node.level == 0) {
+                rowIds.append(entry.ref);
+            } else {
+                stack.append(static_cast<PageId>(entry.ref));
+            }
+        }
+    }
+    return true;
+}
+
+bool RTreeIndex::nearest(const BoundingBox& query, int k, QVector<RowId>& rowIds) const {
+    rowIds.clear();
+    NearestCursor cursor(this, query);
+    RowId rowId = INVALID_ROW_ID;
+    double distance = 0.0;
+    while (rowIds.size() < k && cursor.next(rowId, distance)) {
+        rowIds.append(rowId);
+    }
+    return !cursor.hasError();
+}
+
+RTreeIndex::NearestCursor::NearestCursor(const RTreeIndex* index, const BoundingBox& query)
+    : index_(index)
+    , query_(query) {
+    Item root;
+    root.ref = index_->rootPageId_;
+    queue_.push(root);
+}
+
+bool RTreeIndex::NearestCursor::next(RowId& rowId, double& distance) {
+    while (!queue_.empty()) {
+        const Item item = queue_.top();
+        queue_.pop();
+        if (item.isRow) {
+            rowId = item.ref;
+            distance = item.distance;
+            return true;
+        }
+
+        Node node;
+        if (!index_->readNode(static_cast<PageId>(item.ref), node)) {
+            error_ = true;
+            return false;
+        }
+        for (const Entry& entry : node.entries) {
+            Item child;
+            child.distance = query_.distanceTo(entry.box);
+            child.isRow = node.level == 0;
+            child.ref = entry.ref;
+            queue_.push(child);
+        }
+    }
+    return false;
+}
+
+// ============ 检查与释放 ============
+
+bool RTreeIndex::checkStructure() const {
+    uint64_t leafCount = 0;
+    if (!checkNode(rootPageId_, height_ - 1, true, nullptr, leafCount)) {
+        return false;
+    }
+    if (leafCount != entryCount_) {
+        LOG_ERROR(QString("R-tree holds %1 entries but meta page says %2").arg(leafCount).arg(entryCount_));
+        return false;
+    }
+    return true;
+}
+
+bool RTreeIndex::checkNode(PageId pageId, int expectedLevel, bool isRoot, const BoundingBox* expectedBox,
+                           uint64_t& leafCount) const {
+    Node node;
+    if (!readNode(pageId, node)) {
+        return false;
+    }
+    if (node.level != expectedLevel) {
+        LOG_ERROR(QString("R-tree node %1 is at level %2, expected %3").arg(pageId).arg(node.level).arg(expectedLevel));
+        return false;
+    }
+    if (node.entries.size() > maxEntries_ || (!isRoot && node.entries.size() < minEntries_) ||
+        (isRoot && node.level > 0 && node.entries.size() < 2)) {
+        LOG_ERROR(QString("R-tree node %1 has %2 entries").arg(pageId).arg(node.entries.size()));
+        return false;
+    }
+    if (expectedBox && node.bounds() != *expectedBox) {
+        LOG_ERROR(QString("R-tree node %1 bounding box does not match its parent entry").arg(pageId));
+        return false;
+    }
+
+    if (node.level == 0) {
+        leafCount += static_cast<uint64_t>(node.entries.size());
+        return true;
+    }
+    for (const Entry& entry : node.entries) {
+        if (!checkNode(static_cast<PageId>(entry.ref), expectedLevel - 1, false, &entry.box, leafCount)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void RTreeIndex::destroy() {
+    if (rootPageId_ != INVALID_PAGE_ID) {
+        QVector<Entry> ignored;
+        collectLeafEntries(rootPageId_, ignored, true);
+    }
+    if (metaPageId_ != INVALID_PAGE_ID) {
+        bufferPool_->deletePage(metaPageId_);
+    }
+
+    rootPageId_ = INVALID_PAGE_ID;
+    metaPageId_ = INVALID_PAGE_ID;
+    entryCount_ = 0;
+    height_ = 1;
+}
+
+} // namespace qindb
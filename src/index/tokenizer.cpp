@@ -1,14 +1,27 @@
 #include "qindb/tokenizer.h"
+#include "qindb/chinese_segmenter.h"
 #include "qindb/logger.h"
-#include <QRegularExpression>
 #include <QSet>
 
 namespace qindb {
 
+namespace {
+
+inline bool isAsciiLetter(char16_t c) {
+    return (c >= u'a' && c <= u'z') || (c >= u'A' && c <= u'Z');
+}
+
+inline bool isAsciiWordChar(char16_t c) {
+    return isAsciiLetter(c) || (c >= u'0' && c <= u'9') || c == u'_';
+}
+
+} // namespace
+
 Tokenizer::Tokenizer(Mode mode, bool enableStopWords)
     : mode_(mode)
     , enableStopWords_(enableStopWords)
-    , wordRegex_("\\b[a-zA-Z]+\\b")  // 匹配英文单词
+    , enableSegmentation_(true)
+    , segmenter_(&ChineseSegmenter::builtin())
 {
     initializeDefaultStopWords();
     LOG_DEBUG(QString("Tokenizer created: mode=%1, stopWords=%2")
@@ -16,52 +29,121 @@ Tokenizer::Tokenizer(Mode mode, bool enableStopWords)
                  .arg(enableStopWords));
 }
 
-QStringList Tokenizer::tokenize(const QString& text) const {
-    QStringList tokens;
+void Tokenizer::setSegmenter(const ChineseSegmenter* segmenter) {
+    segmenter_ = segmenter ? segmenter : &ChineseSegmenter::builtin();
+}
 
-    // 根据模式选择分词方法
-    switch (mode_) {
-    case Mode::ENGLISH:
-        tokens = tokenizeEnglish(text);
-        break;
-    case Mode::CHINESE:
-        tokens = tokenizeChinese(text);
-        break;
-    case Mode::MIXED:
-        tokens = tokenizeMixed(text);
-        break;
-    }
+QStringList Tokenizer::tokenize(const QString& text) const {
+    QString folded;
+    QVector<TokenSpan> spans;
+    tokenizeSpans(text, folded, spans);
 
     // 去重
-    QSet<QString> uniqueTokens;
-    for (const QString& token : tokens) {
-        if (!token.isEmpty()) {
+    QSet<QStringView> uniqueTokens;
+    uniqueTokens.reserve(spans.size());
+    QStringList tokens;
+    for (const TokenSpan& span : spans) {
+        QStringView token(folded.constData() + span.offset, span.length);
+        if (!uniqueTokens.contains(token)) {
             uniqueTokens.insert(token);
+            tokens.append(token.toString());
         }
     }
 
-    return uniqueTokens.values();
+    return tokens;
 }
 
 QStringList Tokenizer::tokenizeWithDuplicates(const QString& text) const {
-    QStringList tokens;
+    QString folded;
+    QVector<TokenSpan> spans;
+    tokenizeSpans(text, folded, spans);
 
-    // 根据模式选择分词方法
-    switch (mode_) {
-    case Mode::ENGLISH:
-        tokens = tokenizeEnglish(text);
-        break;
-    case Mode::CHINESE:
-        tokens = tokenizeChinese(text);
-        break;
-    case Mode::MIXED:
-        tokens = tokenizeMixed(text);
-        break;
+    QStringList tokens;
+    tokens.reserve(spans.size());
+    for (const TokenSpan& span : spans) {
+        tokens.append(QString(folded.constData() + span.offset, span.length));
     }
 
     return tokens;
 }
 
+void Tokenizer::tokenizeSpans(QStringView text, QString& folded, QVector<TokenSpan>& tokens) const {
+    tokens.clear();
+    folded.resize(text.size());
+
+    const QChar* in = text.data();
+    QChar* out = folded.data();
+    const qsizetype n = text.size();
+    const bool wantEnglish = mode_ != Mode::CHINESE;
+    const bool wantChinese = mode_ != Mode::ENGLISH;
+
+    qsizetype i = 0;
+    while (i < n) {
+        char16_t c = in[i].unicode();
+
+        if (isAsciiWordChar(c)) {
+            // 与 \b[a-zA-Z]+\b 一致：整段 ASCII 单词字符全是字母时才是一个英文词
+            const qsizetype start = i;
+            bool lettersOnly = true;
+            for (; i < n && isAsciiWordChar(c = in[i].unicode()); ++i) {
+                if (c >= u'A' && c <= u'Z') {
+                    c = static_cast<char16_t>(c + (u'a' - u'A'));
+                } else if (!isAsciiLetter(c)) {
+                    lettersOnly = false;
+                }
+                out[i] = QChar(c);
+            }
+            if (wantEnglish && lettersOnly) {
+                appendToken(out, start, i - start, tokens);
+            }
+            continue;
+        }
+
+        if (isChineseChar(in[i])) {
+            const qsizetype start = i;
+            for (; i < n && isChineseChar(in[i]); ++i) {
+                out[i] = in[i];
+            }
+            if (wantChinese) {
+                appendChineseRun(out, start, i - start, tokens);
+            }
+            continue;
+        }
+
+        out[i] = in[i];
+        ++i;
+    }
+}
+
+void Tokenizer::appendToken(const QChar* folded, qsizetype offset, qsizetype length,
+                            QVector<TokenSpan>& tokens) const {
+    if (enableStopWords_ && stopWordLookup_.find(folded + offset, length) >= 0) {
+        return;
+    }
+    tokens.append(TokenSpan{offset, length});
+}
+
+void Tokenizer::appendChineseRun(const QChar* folded, qsizetype offset, qsizetype length,
+                                 QVector<TokenSpan>& tokens) const {
+    if (!enableSegmentation_) {
+        for (qsizetype i = 0; i < length; ++i) {
+            appendToken(folded, offset + i, 1, tokens);
+        }
+        return;
+    }
+
+    uint8_t wordLengths[ChineseSegmenter::MAX_RUN_LENGTH];
+    const qsizetype end = offset + length;
+    while (offset < end) {
+        const int chunk = static_cast<int>(qMin<qsizetype>(end - offset, ChineseSegmenter::MAX_RUN_LENGTH));
+        const int words = segmenter_->segment(folded + offset, chunk, wordLengths);
+        for (int w = 0; w < words; ++w) {
+            appendToken(folded, offset, wordLengths[w], tokens);
+            offset += wordLengths[w];
+        }
+    }
+}
+
 QString Tokenizer::normalize(const QString& term) {
     if (term.isEmpty()) {
         return QString();
@@ -88,84 +170,28 @@ bool Tokenizer::isStopWord(const QString& term) const {
     }
 
     QString normalized = normalize(term);
-    return stopWords_.contains(normalized);
+    return stopWordLookup_.contains(normalized);
 }
 
 void Tokenizer::addStopWord(const QString& stopWord) {
     QString normalized = normalize(stopWord);
-    if (!normalized.isEmpty()) {
+    if (!normalized.isEmpty() && !stopWords_.contains(normalized)) {
         stopWords_.insert(normalized);
+        rebuildStopWordLookup();
     }
 }
 
 void Tokenizer::removeStopWord(const QString& stopWord) {
     QString normalized = normalize(stopWord);
-    stopWords_.remove(normalized);
-}
-
-QStringList Tokenizer::tokenizeEnglish(const QString& text) const {
-    QStringList tokens;
-
-    // 使用正则表达式匹配英文单词
-    QRegularExpressionMatchIterator it = wordRegex_.globalMatch(text);
-    while (it.hasNext()) {
-        QRegularExpressionMatch match = it.next();
-        QString word = match.captured(0);
-
-        // 归一化
-        QString normalized = normalize(word);
-
-        // 过滤停用词和空词
-        if (!normalized.isEmpty() && !isStopWord(normalized)) {
-            tokens.append(normalized);
-        }
-    }
-
-    return tokens;
-}
-
-QStringList Tokenizer::tokenizeChinese(const QString& text) const {
-    QStringList tokens;
-
-    // 简单单字分词
-    for (int i = 0; i < text.length(); ++i) {
-        QChar ch = text[i];
-
-        if (isChineseChar(ch)) {
-            QString token = QString(ch);
-
-            // 过滤停用词
-            if (!isStopWord(token)) {
-                tokens.append(token);
-            }
-        }
+    if (stopWords_.remove(normalized)) {
+        rebuildStopWordLookup();
     }
-
-    return tokens;
 }
 
-QStringList Tokenizer::tokenizeMixed(const QString& text) const {
-    QStringList tokens;
-
-    // 先提取英文单词
-    QStringList englishTokens = tokenizeEnglish(text);
-    tokens.append(englishTokens);
-
-    // 再提取中文字符
-    for (int i = 0; i < text.length(); ++i) {
-        QChar ch = text[i];
-
-        if (isChineseChar(ch)) {
-            QString token = QString(ch);
-
-            // 过滤停用词
-            if (!isStopWord(token)) {
-                tokens.append(token);
-            }
-        }
+void Tokenizer::rebuildStopWordLookup() {
+    if (!stopWordLookup_.build(QStringList(stopWords_.begin(), stopWords_.end()))) {
+        LOG_ERROR("Failed to build stop word lookup table");
     }
-
-    return tokens;
 }
 
 void Tokenizer::initializeDefaultStopWords() {
@@ -204,6 +230,7 @@ void Tokenizer::initializeDefaultStopWords() {
         stopWords_.insert(word);
     }
 
+    rebuildStopWordLookup();
     LOG_DEBUG(QString("Initialized %1 stop words").arg(stopWords_.size()));
 }
 
@@ -0,0 +1,1075 @@
+#include "qindb/trie_index.h"
+#include "qindb/logger.h"
+#include "qindb/page.h"
+#include <algorithm>
+#include <cstring>
+
+namespace qindb {
+
+namespace {
+
+// 元数据页（页头之后）：magic(4) version(4) rootRef(8) entryCount(8) fillPageId(4) freePageId(4)
+constexpr uint32_t META_MAGIC = 0x49525451;  // "QTRI"
+constexpr uint32_t META_VERSION = 1;
+constexpr size_t META_MAGIC_OFFSET = 0;
+constexpr size_t META_VERSION_OFFSET = 4;
+constexpr size_t META_ROOT_OFFSET = 8;
+constexpr size_t META_ENTRY_COUNT_OFFSET = 16;
+constexpr size_t META_FILL_PAGE_OFFSET = 24;
+constexpr size_t META_FREE_PAGE_OFFSET = 28;   // 旧索引这里是 0，即空链表
+
+// 节点页：页头的 slotCount 为槽数，freeSpaceOffset 为记录区起点（记录从页尾向前增长），
+// freeSpaceSize 为可用字节总数（含已删除记录留下的空洞）；槽目录从数据区开头起每槽 4 字节
+constexpr size_t DATA_SIZE = PAGE_SIZE - sizeof(PageHeader);
+constexpr size_t SLOT_SIZE = 4;
+
+// 空闲页链表：删除记录后可用空间不少于 FREE_PAGE_MIN_BYTES 的页经 prevPageId 串起来，
+// 页头的 reserved1 标记页已在链表中
+constexpr size_t FREE_PAGE_MIN_BYTES = DATA_SIZE / 8;
+constexpr uint8_t ON_FREE_LIST = 0x01;
+
+// 内部节点记录：kind(1) prefixLen(2) count(2) prefix，之后按大小类别：
+// Node4/16：keys[容量] + children[容量]；Node48：256 字节的子节点下标（0 为空，否则下标 + 1）
+// + children[48]；Node256：children[256]
+constexpr int NODE_HEADER_SIZE = 5;
+
+// 叶子引用带这一位；引用 0 表示空
+constexpr uint64_t LEAF_TAG = uint64_t(1) << 63;
+
+// 值结束标记：0x00 0x01 为完整的值，0x00 0x02 为截断的值；码元 0 转义为 0x00 0xFF
+constexpr char TERMINATOR_BYTE = 0x01;
+constexpr char TRUNCATED_BYTE = 0x02;
+constexpr char ESCAPED_NUL_BYTE = static_cast<char>(0xFF);
+constexpr int ROW_ID_SIZE = 8;
+
+template <typename T>
+T readField(const char* data, size_t offset) {
+    T value;
+    memcpy(&value, data + offset, sizeof(T));
+    return value;
+}
+
+template <typename T>
+void writeField(char* data, size_t offset, T value) {
+    memcpy(data + offset, &value, sizeof(T));
+}
+
+uint64_t makeRef(PageId pageId, int slot) {
+    return (static_cast<uint64_t>(pageId) << 16) | static_cast<uint16_t>(slot);
+}
+
+PageId pageOf(uint64_t ref) {
+    return static_cast<PageId>((ref & ~LEAF_TAG) >> 16);
+}
+
+int slotOf(uint64_t ref) {
+    return static_cast<int>(ref & 0xFFFF);
+}
+
+/**
+ * @brief 值（不含结束标记）的编码：每个 UTF-16 码元 1~3 字节，超过上限时在码元边界截断
+ */
+QByteArray encodeBody(const QString& value, bool& truncated) {
+    constexpr int maxBody = TrieIndex::MAX_VALUE_BYTES - 2;
+    QByteArray out;
+    out.reserve(std::min<qsizetype>(value.size() + 2, maxBody));
+    truncated = false;
+    for (const QChar ch : value) {
+        const char16_t unit = ch.unicode();
+        const int width = unit == 0 ? 2 : unit < 0x80 ? 1 : unit < 0x800 ? 2 : 3;
+        if (out.size() + width > maxBody) {
+            truncated = true;
+            break;
+        }
+        if (unit == 0) {
+            out.append('\0');
+            out.append(ESCAPED_NUL_BYTE);
+        } else if (unit < 0x80) {
+            out.append(static_cast<char>(unit));
+        } else if (unit < 0x800) {
+            out.append(static_cast<char>(0xC0 | (unit >> 6)));
+            out.append(static_cast<char>(0x80 | (unit & 0x3F)));
+        } else {
+            out.append(static_cast<char>(0xE0 | (unit >> 12)));
+            out.append(static_cast<char>(0x80 | ((unit >> 6) & 0x3F)));
+            out.append(static_cast<char>(0x80 | (unit & 0x3F)));
+        }
+    }
+    return out;
+}
+
+/**
+ * @brief 从键解码值和行ID
+ */
+bool decodeKey(const QByteArray& key, QString& value, RowId& rowId, bool& truncated) {
+    const int bodySize = key.size() - ROW_ID_SIZE - 2;
+    if (bodySize < 0 || key[bodySize] != '\0' ||
+        (key[bodySize + 1] != TERMINATOR_BYTE && key[bodySize + 1] != TRUNCATED_BYTE)) {
+        return false;
+    }
+    truncated = key[bodySize + 1] == TRUNCATED_BYTE;
+
+    rowId = 0;
+    for (int i = bodySize + 2; i < key.size(); ++i) {
+        rowId = (rowId << 8) | static_cast<uint8_t>(key[i]);
+    }
+
+    value.clear();
+    const auto* data = reinterpret_cast<const uint8_t*>(key.constData());
+    for (int i = 0; i < bodySize;) {
+        const uint8_t lead = data[i];
+        char16_t unit = 0;
+        if (lead == 0) {
+            if (i + 1 >= bodySize || data[i + 1] != 0xFF) {
+                return false;
+            }
+            i += 2;
+        } else if (lead < 0x80) {
+            unit = lead;
+            i += 1;
+        } else if ((lead & 0xE0) == 0xC0 && i + 1 < bodySize) {
+            unit = static_cast<char16_t>(((lead & 0x1F) << 6) | (data[i + 1] & 0x3F));
+            i += 2;
+        } else if ((lead & 0xF0) == 0xE0 && i + 2 < bodySize) {
+            unit = static_cast<char16_t>(((lead & 0x0F) << 12) | ((data[i + 1] & 0x3F) << 6) |
+                                         (data[i + 2] & 0x3F));
+            i += 3;
+        } else {
+            return false;
+        }
+        value.append(QChar(unit));
+    }
+    return true;
+}
+
+int kindCapacity(uint8_t kind) {
+    switch (kind) {
+        case 1: return 4;
+        case 2: return 16;
+        case 3: return 48;
+        case 4: return 256;
+        default: return 0;
+    }
+}
+
+// 子节点数不超过这个值时换成小一号的节点（留出余量，避免在边界上反复变大变小）
+int kindShrinkThreshold(uint8_t kind) {
+    switch (kind) {
+        case 2: return 3;
+        case 3: return 12;
+        case 4: return 40;
+        default: return 1;
+    }
+}
+
+int kindLayoutSize(uint8_t kind) {
+    switch (kind) {
+        case 1: return 4 + 4 * 8;
+        case 2: return 16 + 16 * 8;
+        case 3: return 256 + 48 * 8;
+        case 4: return 256 * 8;
+        default: return -1;
+    }
+}
+
+} // namespace
+
+// ============ 节点 ============
+
+int TrieIndex::Node::findChild(uint8_t byte) const {
+    const auto* begin = reinterpret_cast<const uint8_t*>(keys.constData());
+    const auto* end = begin + keys.size();
+    const auto* it = std::lower_bound(begin, end, byte);
+    return (it != end && *it == byte) ? static_cast<int>(it - begin) : -1;
+}
+
+void TrieIndex::Node::addChild(uint8_t byte, uint64_t child) {
+    int pos = 0;
+    while (pos < keys.size() && static_cast<uint8_t>(keys[pos]) < byte) {
+        ++pos;
+    }
+    keys.insert(pos, static_cast<char>(byte));
+    children.insert(pos, child);
+}
+
+bool TrieIndex::isLeaf(uint64_t ref) {
+    return (ref & LEAF_TAG) != 0;
+}
+
+// ============ 键编码 ============
+
+bool TrieIndex::isIndexableType(DataType type) {
+    return isStringType(type);
+}
+
+QString TrieIndex::normalizeValue(const QString& value, DataType type) {
+    return type == DataType::CHAR ? value.trimmed() : value;
+}
+
+QByteArray TrieIndex::encodeValue(const QString& value) {
+    bool truncated = false;
+    QByteArray encoded = encodeBody(value, truncated);
+    encoded.append('\0');
+    encoded.append(truncated ? TRUNCATED_BYTE : TERMINATOR_BYTE);
+    return encoded;
+}
+
+QByteArray TrieIndex::encodePrefix(const QString& prefix) {
+    bool truncated = false;
+    return encodeBody(prefix, truncated);
+}
+
+QByteArray TrieIndex::makeKey(const QString& value, RowId rowId) {
+    QByteArray key = encodeValue(value);
+    for (int shift = 56; shift >= 0; shift -= 8) {
+        key.append(static_cast<char>((rowId >> shift) & 0xFF));
+    }
+    return key;
+}
+
+// ============ 记录页 ============
+
+TrieIndex::TrieIndex(BufferPoolManager* bufferPool, PageId metaPageId)
+    : bufferPool_(bufferPool)
+    , metaPageId_(metaPageId) {
+}
+
+bool TrieIndex::allocateNodePage(PageId& pageId) {
+    Page* page = bufferPool_->newPage(&pageId);
+    if (!page) {
+        LOG_ERROR("Failed to allocate trie node page");
+        return false;
+    }
+
+    memset(page->getData(), 0, PAGE_SIZE);
+    page->setPageId(pageId);
+    page->setPageType(PageType::TRIE_NODE_PAGE);
+    PageHeader* header = page->getHeader();
+    header->slotCount = 0;
+    header->freeSpaceOffset = static_cast<uint16_t>(DATA_SIZE);
+    header->freeSpaceSize = static_cast<uint16_t>(DATA_SIZE);
+    header->nextPageId = fillPageId_;   // 新页成为页链表的表头
+    bufferPool_->unpinPage(pageId, true);
+    return true;
+}
+
+bool TrieIndex::tryAllocateInPage(PageId pageId, const QByteArray& record, uint64_t& ref) {
+    Page* page = bufferPool_->fetchPage(pageId);
+    if (!page) {
+        LOG_ERROR(QString("Failed to fetch trie node page %1").arg(pageId));
+        return false;
+    }
+
+    PageHeader* header = page->getHeader();
+    char* data = page->getData() + sizeof(PageHeader);
+
+    // 优先复用空槽，否则在槽目录末尾加一个
+    int slot = 0;
+    while (slot < header->slotCount && readField<uint16_t>(data, slot * SLOT_SIZE + 2) != 0) {
+        ++slot;
+    }
+    const bool newSlot = slot == header->slotCount;
+    const size_t needed = record.size() + (newSlot ? SLOT_SIZE : 0);
+    if (header->freeSpaceSize < needed) {
+        bufferPool_->unpinPage(pageId, false);
+        return false;
+    }
+
+    const size_t directoryEnd = (header->slotCount + (newSlot ? 1 : 0)) * SLOT_SIZE;
+    if (header->freeSpaceOffset < directoryEnd + record.size()) {
+        // 连续空间不够但总空间够：把存活记录挤到页尾，空洞合并成一整块
+        const QByteArray copy(data, static_cast<int>(DATA_SIZE));
+        size_t writeOffset = DATA_SIZE;
+        for (int i = 0; i < header->slotCount; ++i) {
+            const uint16_t length = readField<uint16_t>(data, i * SLOT_SIZE + 2);
+            if (length == 0) {
+                continue;
+            }
+            const uint16_t offset = readField<uint16_t>(data, i * SLOT_SIZE);
+            writeOffset -= length;
+            memcpy(data + writeOffset, copy.constData() + offset, length);
+            writeField<uint16_t>(data, i * SLOT_SIZE, static_cast<uint16_t>(writeOffset));
+        }
+        header->freeSpaceOffset = static_cast<uint16_t>(writeOffset);
+    }
+
+    const size_t offset = header->freeSpaceOffset - record.size();
+    memcpy(data + offset, record.constData(), record.size());
+    writeField<uint16_t>(data, slot * SLOT_SIZE, static_cast<uint16_t>(offset));
+    writeField<uint16_t>(data, slot * SLOT_SIZE + 2, static_cast<uint16_t>(record.size()));
+    header->freeSpaceOffset = static_cast<uint16_t>(offset);
+    header->freeSpaceSize = static_cast<uint16_t>(header->freeSpaceSize - needed);
+    if (newSlot) {
+        header->slotCount++;
+    }
+
+    bufferPool_->unpinPage(pageId, true);
+    ref = makeRef(pageId, slot);
+    return true;
+}
+
+bool TrieIndex::allocateRecord(const QByteArray& record, uint64_t& ref) {
+    if (fillPageId_ != INVALID_PAGE_ID && tryAllocateInPage(fillPageId_, record, ref)) {
+        return true;
+    }
+
+    // 再试空闲页链表：放不下且剩余空间已不多的页摘下，还有较多空间的页留着给小记录
+    while (freePageId_ != INVALID_PAGE_ID) {
+        if (tryAllocateInPage(freePageId_, record, ref)) {
+            return true;
+        }
+        bool popped = false;
+        if (!popFreePage(popped)) {
+            return false;
+        }
+        if (!popped) {
+            break;
+        }
+    }
+
+    PageId pageId = INVALID_PAGE_ID;
+    if (!allocateNodePage(pageId)) {
+        return false;
+    }
+    fillPageId_ = pageId;
+    if (!tryAllocateInPage(pageId, record, ref)) {
+        LOG_ERROR(QString("Trie record of %1 bytes does not fit in a page").arg(record.size()));
+        return false;
+    }
+    return true;
+}
+
+bool TrieIndex::readRecord(uint64_t ref, QByteArray& record) const {
+    const PageId pageId = pageOf(ref);
+    const int slot = slotOf(ref);
+    Page* page = bufferPool_->fetchPage(pageId);
+    if (!page) {
+        LOG_ERROR(QString("Failed to fetch trie node page %1").arg(pageId));
+        return false;
+    }
+
+    const PageHeader* header = page->getHeader();
+    const char* data = page->getData() + sizeof(PageHeader);
+    const uint16_t offset = slot < header->slotCount ? readField<uint16_t>(data, slot * SLOT_SIZE) : 0;
+    const uint16_t length = slot < header->slotCount ? readField<uint16_t>(data, slot * SLOT_SIZE + 2) : 0;
+    if (length == 0 || offset + length > DATA_SIZE) {
+        bufferPool_->unpinPage(pageId, false);
+        LOG_ERROR(QString("Invalid trie record %1 in page %2").arg(slot).arg(pageId));
+        return false;
+    }
+
+    record = QByteArray(data + offset, length);
+    bufferPool_->unpinPage(pageId, false);
+    return true;
+}
+
+bool TrieIndex::freeRecord(uint64_t ref) {
+    const PageId pageId = pageOf(ref);
+    const int slot = slotOf(ref);
+    Page* page = bufferPool_->fetchPage(pageId);
+    if (!page) {
+        LOG_ERROR(QString("Failed to fetch trie node page %1").arg(pageId));
+        return false;
+    }
+
+    PageHeader* header = page->getHeader();
+    char* data = page->getData() + sizeof(PageHeader);
+    if (slot >= header->slotCount) {
+        bufferPool_->unpinPage(pageId, false);
+        LOG_ERROR(QString("Invalid trie record %1 in page %2").arg(slot).arg(pageId));
+        return false;
+    }
+
+    header->freeSpaceSize = static_cast<uint16_t>(header->freeSpaceSize +
+                                                  readField<uint16_t>(data, slot * SLOT_SIZE + 2));
+    writeField<uint16_t>(data, slot * SLOT_SIZE, 0);
+    writeField<uint16_t>(data, slot * SLOT_SIZE + 2, 0);
+
+    // 目录末尾的空槽直接收回
+    while (header->slotCount > 0 &&
+           readField<uint16_t>(data, (header->slotCount - 1) * SLOT_SIZE + 2) == 0) {
+        header->slotCount--;
+        header->freeSpaceSize = static_cast<uint16_t>(header->freeSpaceSize + SLOT_SIZE);
+    }
+
+    // 空出的空间够多时挂到空闲页链表，之后分配记录时复用（元数据随本次操作一起写回）
+    if (!(header->reserved1 & ON_FREE_LIST) && pageId != fillPageId_ &&
+        header->freeSpaceSize >= FREE_PAGE_MIN_BYTES) {
+        header->reserved1 |= ON_FREE_LIST;
+        header->prevPageId = freePageId_;
+        freePageId_ = pageId;
+    }
+
+    bufferPool_->unpinPage(pageId, true);
+    return true;
+}
+
+bool TrieIndex::popFreePage(bool& popped) {
+    popped = false;
+    Page* page = bufferPool_->fetchPage(freePageId_);
+    if (!page) {
+        LOG_ERROR(QString("Failed to fetch trie node page %1").arg(freePageId_));
+        return false;
+    }
+
+    PageHeader* header = page->getHeader();
+    const PageId pageId = freePageId_;
+    if (header->freeSpaceSize >= FREE_PAGE_MIN_BYTES) {
+        bufferPool_->unpinPage(pageId, false);
+        return true;
+    }
+
+    freePageId_ = header->prevPageId;
+    header->reserved1 &= static_cast<uint8_t>(~ON_FREE_LIST);
+    header->prevPageId = INVALID_PAGE_ID;
+    bufferPool_->unpinPage(pageId, true);
+    popped = true;
+    return true;
+}
+
+bool TrieIndex::writeRecord(uint64_t& ref, const QByteArray& record) {
+    if (ref == 0) {
+        return allocateRecord(record, ref);
+    }
+
+    const PageId pageId = pageOf(ref);
+    const int slot = slotOf(ref);
+    Page* page = bufferPool_->fetchPage(pageId);
+    if (!page) {
+        LOG_ERROR(QString("Failed to fetch trie node page %1").arg(pageId));
+        return false;
+    }
+
+    // 大小不变时原地覆盖
+    char* data = page->getData() + sizeof(PageHeader);
+    if (slot < page->getHeader()->slotCount &&
+        readField<uint16_t>(data, slot * SLOT_SIZE + 2) == record.size()) {
+        memcpy(data + readField<uint16_t>(data, slot * SLOT_SIZE), record.constData(), record.size());
+        bufferPool_->unpinPage(pageId, true);
+        return true;
+    }
+    bufferPool_->unpinPage(pageId, false);
+
+    // 大小变了：先释放旧记录，尽量放回同一页
+    return freeRecord(ref) &&
+           (tryAllocateInPage(pageId, record, ref) || allocateRecord(record, ref));
+}
+
+bool TrieIndex::readNode(uint64_t ref, Node& node) const {
+    QByteArray record;
+    if (!readRecord(ref, record)) {
+        return false;
+    }
+
+    const char* data = record.constData();
+    const uint8_t kind = record.isEmpty() ? 0 : static_cast<uint8_t>(data[0]);
+    const int prefixLength = record.size() >= NODE_HEADER_SIZE ? readField<uint16_t>(data, 1) : 0;
+    const int count = record.size() >= NODE_HEADER_SIZE ? readField<uint16_t>(data, 3) : 0;
+    if (kindLayoutSize(kind) < 0 || count > kindCapacity(kind) ||
+        record.size() != NODE_HEADER_SIZE + prefixLength + kindLayoutSize(kind)) {
+        LOG_ERROR(QString("Corrupt trie node in page %1").arg(pageOf(ref)));
+        return false;
+    }
+
+    node.kind = static_cast<NodeKind>(kind);
+    node.prefix = record.mid(NODE_HEADER_SIZE, prefixLength);
+    node.keys.clear();
+    node.children.clear();
+    const char* layout = data + NODE_HEADER_SIZE + prefixLength;
+    const int capacity = kindCapacity(kind);
+
+    if (node.kind == NodeKind::NODE4 || node.kind == NodeKind::NODE16) {
+        node.keys = QByteArray(layout, count);
+        for (int i = 0; i < count; ++i) {
+            node.children.append(readField<uint64_t>(layout, capacity + i * 8));
+        }
+    } else if (node.kind == NodeKind::NODE48) {
+        for (int byte = 0; byte < 256; ++byte) {
+            const uint8_t index = static_cast<uint8_t>(layout[byte]);
+            if (index != 0) {
+                node.keys.append(static_cast<char>(byte));
+                node.children.append(readField<uint64_t>(layout, 256 + (index - 1) * 8));
+            }
+        }
+    } else {
+        for (int byte = 0; byte < 256; ++byte) {
+            const uint64_t child = readField<uint64_t>(layout, byte * 8);
+            if (child != 0) {
+                node.keys.append(static_cast<char>(byte));
+                node.children.append(child);
+            }
+        }
+    }
+
+    if (node.children.size() != count) {
+        LOG_ERROR(QString("Corrupt trie node in page %1").arg(pageOf(ref)));
+        return false;
+    }
+    return true;
+}
+
+bool TrieIndex::readLeaf(uint64_t ref, QByteArray& key) const {
+    return readRecord(ref, key);
+}
+
+bool TrieIndex::writeNode(uint64_t& ref, Node& node) {
+    // 子节点超出容量时换大一号，少到阈值以下时换小一号
+    const int count = node.children.size();
+    uint8_t kind = static_cast<uint8_t>(node.kind);
+    while (count > kindCapacity(kind)) {
+        ++kind;
+    }
+    while (kind > static_cast<uint8_t>(NodeKind::NODE4) && count <= kindShrinkThreshold(kind)) {
+        --kind;
+    }
+    node.kind = static_cast<NodeKind>(kind);
+
+    const int capacity = kindCapacity(kind);
+    QByteArray record(NODE_HEADER_SIZE + node.prefix.size() + kindLayoutSize(kind), '\0');
+    char* data = record.data();
+    data[0] = static_cast<char>(kind);
+    writeField<uint16_t>(data, 1, static_cast<uint16_t>(node.prefix.size()));
+    writeField<uint16_t>(data, 3, static_cast<uint16_t>(count));
+    memcpy(data + NODE_HEADER_SIZE, node.prefix.constData(), node.prefix.size());
+    char* layout = data + NODE_HEADER_SIZE + node.prefix.size();
+
+    for (int i = 0; i < count; ++i) {
+        const uint8_t byte = static_cast<uint8_t>(node.keys[i]);
+        if (node.kind == NodeKind::NODE4 || node.kind == NodeKind::NODE16) {
+            layout[i] = static_cast<char>(byte);
+            writeField<uint64_t>(layout, capacity + i * 8, node.children[i]);
+        } else if (node.kind == NodeKind::NODE48) {
+            layout[byte] = static_cast<char>(i + 1);
+            writeField<uint64_t>(layout, 256 + i * 8, node.children[i]);
+        } else {
+            writeField<uint64_t>(layout, byte * 8, node.children[i]);
+        }
+    }
+
+    return writeRecord(ref, record);
+}
+
+bool TrieIndex::writeLeaf(const QByteArray& key, uint64_t& ref) {
+    ref = 0;
+    if (!allocateRecord(key, ref)) {
+        return false;
+    }
+    ref |= LEAF_TAG;
+    return true;
+}
+
+bool TrieIndex::writeMeta() {
+    Page* metaPage = bufferPool_->fetchPage(metaPageId_);
+    if (!metaPage) {
+        LOG_ERROR(QString("Failed to fetch trie meta page %1").arg(metaPageId_));
+        return false;
+    }
+
+    char* meta = metaPage->getData() + sizeof(PageHeader);
+    writeField<uint32_t>(meta, META_MAGIC_OFFSET, META_MAGIC);
+    writeField<uint32_t>(meta, META_VERSION_OFFSET, META_VERSION);
+    writeField<uint64_t>(meta, META_ROOT_OFFSET, rootRef_);
+    writeField<uint64_t>(meta, META_ENTRY_COUNT_OFFSET, entryCount_);
+    writeField<PageId>(meta, META_FILL_PAGE_OFFSET, fillPageId_);
+    writeField<PageId>(meta, META_FREE_PAGE_OFFSET, freePageId_);
+    bufferPool_->unpinPage(metaPageId_, true);
+    return true;
+}
+
+// ============ 创建与加载 ============
+
+bool TrieIndex::create() {
+    Page* metaPage = bufferPool_->newPage(&metaPageId_);
+    if (!metaPage) {
+        metaPageId_ = INVALID_PAGE_ID;
+        LOG_ERROR("Failed to allocate trie meta page");
+        return false;
+    }
+
+    memset(metaPage->getData(), 0, PAGE_SIZE);
+    metaPage->setPageId(metaPageId_);
+    metaPage->setPageType(PageType::TRIE_NODE_PAGE);
+    bufferPool_->unpinPage(metaPageId_, true);
+
+    rootRef_ = 0;
+    entryCount_ = 0;
+    fillPageId_ = INVALID_PAGE_ID;
+    freePageId_ = INVALID_PAGE_ID;
+    return writeMeta();
+}
+
+bool TrieIndex::load() {
+    if (metaPageId_ == INVALID_PAGE_ID) {
+        return false;
+    }
+
+    Page* metaPage = bufferPool_->fetchPage(metaPageId_);
+    if (!metaPage) {
+        LOG_ERROR(QString("Failed to fetch trie meta page %1").arg(metaPageId_));
+        return false;
+    }
+
+    const char* meta = metaPage->getData() + sizeof(PageHeader);
+    const uint32_t magic = readField<uint32_t>(meta, META_MAGIC_OFFSET);
+    const uint32_t version = readField<uint32_t>(meta, META_VERSION_OFFSET);
+    rootRef_ = readField<uint64_t>(meta, META_ROOT_OFFSET);
+    entryCount_ = readField<uint64_t>(meta, META_ENTRY_COUNT_OFFSET);
+    fillPageId_ = readField<PageId>(meta, META_FILL_PAGE_OFFSET);
+    freePageId_ = readField<PageId>(meta, META_FREE_PAGE_OFFSET);
+    bufferPool_->unpinPage(metaPageId_, false);
+
+    if (magic != META_MAGIC || version != META_VERSION || (rootRef_ == 0) != (entryCount_ == 0)) {
+        LOG_ERROR(QString("Invalid trie meta page %1").arg(metaPageId_));
+        return false;
+    }
+    return true;
+}
+
+// ============ 插入与删除 ============
+
+bool TrieIndex::insert(const QString& value, RowId rowId) {
+    bool inserted = false;
+    if (!insertAt(rootRef_, makeKey(value, rowId), 0, inserted)) {
+        return false;
+    }
+    if (inserted) {
+        ++entryCount_;
+    }
+    return writeMeta();
+}
+
+bool TrieIndex::insertAt(uint64_t& ref, const QByteArray& key, int depth, bool& inserted) {
+    inserted = false;
+    if (ref == 0) {
+        inserted = writeLeaf(key, ref);
+        return inserted;
+    }
+
+    if (isLeaf(ref)) {
+        QByteArray existing;
+        if (!readLeaf(ref, existing)) {
+            return false;
+        }
+        if (existing == key) {
+            return true;  // 已存在
+        }
+
+        // 两个键从 depth 起的公共部分成为新节点的压缩路径，在第一个不同的字节处分叉
+        int split = depth;
+        while (split < key.size() && split < existing.size() && key[split] == existing[split]) {
+            ++split;
+        }
+        if (split >= key.size() || split >= existing.size()) {
+            LOG_ERROR("Trie key is a prefix of another key");
+            return false;
+        }
+
+        Node node;
+        node.prefix = key.mid(depth, split - depth);
+        uint64_t leafRef = 0;
+        if (!writeLeaf(key, leafRef)) {
+            return false;
+        }
+        node.addChild(static_cast<uint8_t>(existing[split]), ref);
+        node.addChild(static_cast<uint8_t>(key[split]), leafRef);
+
+        uint64_t nodeRef = 0;
+        if (!writeNode(nodeRef, node)) {
+            return false;
+        }
+        ref = nodeRef;
+        inserted = true;
+        return true;
+    }
+
+    Node node;
+    if (!readNode(ref, node)) {
+        return false;
+    }
+
+    int matched = 0;
+    while (matched < node.prefix.size() && depth + matched < key.size() &&
+           node.prefix[matched] == key[depth + matched]) {
+        ++matched;
+    }
+
+    if (matched < node.prefix.size()) {
+        // 压缩路径中途分叉：新节点接管公共部分，原节点的路径去掉公共部分和分叉字节
+        if (depth + matched >= key.size()) {
+            LOG_ERROR("Trie key is a prefix of another key");
+            return false;
+        }
+        Node parent;
+        parent.prefix = node.prefix.left(matched);
+        const uint8_t oldByte = static_cast<uint8_t>(node.prefix[matched]);
+        node.prefix = node.prefix.mid(matched + 1);
+
+        uint64_t oldRef = ref;
+        uint64_t leafRef = 0;
+        if (!writeNode(oldRef, node) || !writeLeaf(key, leafRef)) {
+            return false;
+        }
+        parent.addChild(oldByte, oldRef);
+        parent.addChild(static_cast<uint8_t>(key[depth + matched]), leafRef);
+
+        uint64_t parentRef = 0;
+        if (!writeNode(parentRef, parent)) {
+            return false;
+        }
+        ref = parentRef;
+        inserted = true;
+        return true;
+    }
+
+    depth += node.prefix.size();
+    if (depth >= key.size()) {
+        LOG_ERROR("Trie key is a prefix of another key");
+        return false;
+    }
+
+    const uint8_t byte = static_cast<uint8_t>(key[depth]);
+    const int index = node.findChild(byte);
+    if (index >= 0) {
+        uint64_t child = node.children[index];
+        if (!insertAt(child, key, depth + 1, inserted)) {
+            return false;
+        }
+        if (child == node.children[index]) {
+            return true;
+        }
+        node.children[index] = child;
+        return writeNode(ref, node);
+    }
+
+    uint64_t leafRef = 0;
+    if (!writeLeaf(key, leafRef)) {
+        return false;
+    }
+    node.addChild(byte, leafRef);
+    inserted = true;
+    return writeNode(ref, node);
+}
+
+bool TrieIndex::remove(const QString& value, RowId rowId) {
+    bool removed = false;
+    if (!removeAt(rootRef_, makeKey(value, rowId), 0, removed)) {
+        return false;
+    }
+    if (!removed) {
+        return false;
+    }
+    --entryCount_;
+    return writeMeta();
+}
+
+bool TrieIndex::removeAt(uint64_t& ref, const QByteArray& key, int depth, bool& removed) {
+    removed = false;
+    if (ref == 0) {
+        return true;
+    }
+
+    if (isLeaf(ref)) {
+        QByteArray existing;
+        if (!readLeaf(ref, existing)) {
+            return false;
+        }
+        if (existing != key) {
+            return true;
+        }
+        if (!freeRecord(ref)) {
+            return false;
+        }
+        ref = 0;
+        removed = true;
+        return true;
+    }
+
+    Node node;
+    if (!readNode(ref, node)) {
+        return false;
+    }
+    if (key.mid(depth, node.prefix.size()) != node.prefix) {
+        return true;
+    }
+    depth += node.prefix.size();
+    const int index = depth < key.size() ? node.findChild(static_cast<uint8_t>(key[depth])) : -1;
+    if (index < 0) {
+        return true;
+    }
+
+    uint64_t child = node.children[index];
+    if (!removeAt(child, key, depth + 1, removed)) {
+        return false;
+    }
+    if (!removed || child == node.children[index]) {
+        return true;
+    }
+
+    if (child == 0) {
+        node.keys.remove(index, 1);
+        node.children.remove(index);
+    } else {
+        node.children[index] = child;
+    }
+
+    if (node.children.size() == 1) {
+        // 只剩一个子节点：并入子节点（子节点的压缩路径前面接上本节点的路径和分支字节）
+        uint64_t only = node.children[0];
+        if (!isLeaf(only)) {
+            Node childNode;
+            if (!readNode(only, childNode)) {
+                return false;
+            }
+            childNode.prefix = node.prefix + node.keys.left(1) + childNode.prefix;
+            if (!writeNode(only, childNode)) {
+                return false;
+            }
+        }
+        if (!freeRecord(ref)) {
+            return false;
+        }
+        ref = only;
+        return true;
+    }
+
+    return writeNode(ref, node);
+}
+
+// ============ 批量构建 ============
+
+bool TrieIndex::bulkLoad(QVector<QPair<QString, RowId>> entries) {
+    if (rootRef_ != 0) {
+        LOG_ERROR("Trie bulk load requires an empty index");
+        return false;
+    }
+
+    QVector<QByteArray> keys;
+    keys.reserve(entries.size());
+    for (const auto& entry : entries) {
+        keys.append(makeKey(entry.first, entry.second));
+    }
+    entries.clear();
+    std::sort(keys.begin(), keys.end());
+    keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+
+    if (!keys.isEmpty() && !buildSubtree(keys, 0, keys.size(), 0, rootRef_)) {
+        return false;
+    }
+    entryCount_ = keys.size();
+    return writeMeta();
+}
+
+bool TrieIndex::buildSubtree(const QVector<QByteArray>& keys, int from, int to, int depth, uint64_t& ref) {
+    if (to - from == 1) {
+        return writeLeaf(keys[from], ref);
+    }
+
+    // 有序区间的公共前缀就是首尾两个键的公共前缀
+    const QByteArray& first = keys[from];
+    const QByteArray& last = keys[to - 1];
+    int split = depth;
+    while (split < first.size() && split < last.size() && first[split] == last[split]) {
+        ++split;
+    }
+    if (split >= first.size()) {
+        LOG_ERROR("Trie key is a prefix of another key");
+        return false;
+    }
+
+    // 子节点先写，父节点拿到全部子节点引用后只写一次
+    Node node;
+    node.prefix = first.mid(depth, split - depth);
+    for (int i = from; i < to;) {
+        const char byte = keys[i][split];
+        int j = i + 1;
+        while (j < to && keys[j][split] == byte) {
+            ++j;
+        }
+        uint64_t child = 0;
+        if (!buildSubtree(keys, i, j, split + 1, child)) {
+            return false;
+        }
+        node.keys.append(byte);
+        node.children.append(child);
+        i = j;
+    }
+
+    ref = 0;
+    return writeNode(ref, node);
+}
+
+// ============ 查询 ============
+
+TrieIndex::Cursor::Cursor(const TrieIndex* index, const QByteArray& keyPrefix)
+    : index_(index)
+    , prefix_(keyPrefix) {
+    // 沿前缀下降到第一个整棵子树都以前缀开头的节点
+    uint64_t ref = index_->rootRef_;
+    int depth = 0;
+    while (ref != 0) {
+        if (isLeaf(ref)) {
+            QByteArray key;
+            if (!index_->readLeaf(ref, key)) {
+                error_ = true;
+            } else if (key.startsWith(prefix_)) {
+                stack_.append(ref);
+            }
+            return;
+        }
+        if (depth == prefix_.size()) {
+            stack_.append(ref);
+            return;
+        }
+
+        Node node;
+        if (!index_->readNode(ref, node)) {
+            error_ = true;
+            return;
+        }
+        const int remaining = prefix_.size() - depth;
+        const int compared = std::min(remaining, static_cast<int>(node.prefix.size()));
+        if (memcmp(node.prefix.constData(), prefix_.constData() + depth, compared) != 0) {
+            return;
+        }
+        if (remaining <= node.prefix.size()) {
+            stack_.append(ref);
+            return;
+        }
+
+        depth += node.prefix.size();
+        const int child = node.findChild(static_cast<uint8_t>(prefix_[depth]));
+        if (child < 0) {
+            return;
+        }
+        ref = node.children[child];
+        ++depth;
+    }
+}
+
+bool TrieIndex::Cursor::next(QString& value, RowId& rowId) {
+    while (!stack_.isEmpty() && !error_) {
+        const uint64_t ref = stack_.takeLast();
+        if (isLeaf(ref)) {
+            QByteArray key;
+            if (!index_->readLeaf(ref, key) || !decodeKey(key, value, rowId, truncated_)) {
+                LOG_ERROR("Corrupt trie leaf");
+                error_ = true;
+                return false;
+            }
+            return true;
+        }
+
+        Node node;
+        if (!index_->readNode(ref, node)) {
+            error_ = true;
+            return false;
+        }
+        for (int i = node.children.size() - 1; i >= 0; --i) {
+            stack_.append(node.children[i]);
+        }
+    }
+    return false;
+}
+
+bool TrieIndex::lookup(const QString& value, QVector<RowId>& rowIds) const {
+    Cursor cursor(this, encodeValue(value));
+    QString key;
+    RowId rowId = INVALID_ROW_ID;
+    while (cursor.next(key, rowId)) {
+        rowIds.append(rowId);
+    }
+    return !cursor.hasError();
+}
+
+bool TrieIndex::prefixSearch(const QString& prefix, int limit, QVector<RowId>& rowIds,
+                             QStringList* values) const {
+    Cursor cursor(this, encodePrefix(prefix));
+    QString value;
+    RowId rowId = INVALID_ROW_ID;
+    int count = 0;
+    while ((limit <= 0 || count < limit) && cursor.next(value, rowId)) {
+        rowIds.append(rowId);
+        if (values) {
+            values->append(value);
+        }
+        ++count;
+    }
+    return !cursor.hasError();
+}
+
+// ============ 检查与销毁 ============
+
+bool TrieIndex::checkStructure() const {
+    uint64_t leafCount = 0;
+    if (rootRef_ != 0 && !checkSubtree(rootRef_, QByteArray(), leafCount)) {
+        return false;
+    }
+    if (leafCount != entryCount_) {
+        LOG_ERROR(QString("Trie has %1 leaves but %2 entries").arg(leafCount).arg(entryCount_));
+        return false;
+    }
+    return true;
+}
+
+bool TrieIndex::checkSubtree(uint64_t ref, const QByteArray& path, uint64_t& leafCount) const {
+    if (isLeaf(ref)) {
+        QByteArray key;
+        QString value;
+        RowId rowId = INVALID_ROW_ID;
+        bool truncated = false;
+        if (!readLeaf(ref, key) || !key.startsWith(path) || !decodeKey(key, value, rowId, truncated)) {
+            LOG_ERROR(QString("Trie leaf in page %1 does not match its path").arg(pageOf(ref)));
+            return false;
+        }
+        ++leafCount;
+        return true;
+    }
+
+    Node node;
+    if (!readNode(ref, node)) {
+        return false;
+    }
+    const uint8_t kind = static_cast<uint8_t>(node.kind);
+    if (node.children.size() < 2 || node.children.size() <= kindShrinkThreshold(kind)) {
+        LOG_ERROR(QString("Trie node in page %1 has %2 children (kind %3)")
+                      .arg(pageOf(ref)).arg(node.children.size()).arg(kind));
+        return false;
+    }
+
+    const QByteArray nodePath = path + node.prefix;
+    for (int i = 0; i < node.children.size(); ++i) {
+        if (i > 0 && static_cast<uint8_t>(node.keys[i - 1]) >= static_cast<uint8_t>(node.keys[i])) {
+            LOG_ERROR(QString("Trie node in page %1 has unsorted children").arg(pageOf(ref)));
+            return false;
+        }
+        if (!checkSubtree(node.children[i], nodePath + node.keys.mid(i, 1), leafCount)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void TrieIndex::destroy() {
+    PageId pageId = fillPageId_;
+    while (pageId != INVALID_PAGE_ID) {
+        Page* page = bufferPool_->fetchPage(pageId);
+        if (!page) {
+            break;
+        }
+        const PageId nextPageId = page->getHeader()->nextPageId;
+        bufferPool_->unpinPage(pageId, false);
+        bufferPool_->deletePage(pageId);
+        pageId = nextPageId;
+    }
+    if (metaPageId_ != INVALID_PAGE_ID) {
+        bufferPool_->deletePage(metaPageId_);
+    }
+
+    metaPageId_ = INVALID_PAGE_ID;
+    rootRef_ = 0;
+    entryCount_ = 0;
+    fillPageId_ = INVALID_PAGE_ID;
+    freePageId_ = INVALID_PAGE_ID;
+}
+
+} // namespace qindb
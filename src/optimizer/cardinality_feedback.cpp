@@ -0,0 +1,97 @@
+#include "qindb/cardinality_feedback.h"
+#include <QMutexLocker>
+#include <algorithm>
+#include <cmath>
+
+namespace qindb {
+
+QString CardinalityFeedback::scanSignature(const QString& tableName, const QString& predicate) {
+    return QString("scan:%1|%2").arg(tableName.toLower(), predicate);
+}
+
+QString CardinalityFeedback::joinSignature(const QString& leftTable, const QString& leftColumn,
+                                           const QString& rightTable, const QString& rightColumn) {
+    QString left = leftTable.toLower() + "." + leftColumn.toLower();
+    QString right = rightTable.toLower() + "." + rightColumn.toLower();
+    if (right < left) {
+        std::swap(left, right);
+    }
+    return QString("join:%1=%2").arg(left, right);
+}
+
+void CardinalityFeedback::record(const QString& signature, const QStringList& tables,
+                                 size_t estimatedRows, size_t actualRows) {
+    QMutexLocker locker(&mutex_);
+
+    // 按至少一行计，估算或实际为 0 时比值仍有意义
+    const double ratio = static_cast<double>(std::max<size_t>(actualRows, 1)) /
+                         static_cast<double>(std::max<size_t>(estimatedRows, 1));
+
+    auto it = entries_.find(signature);
+    if (it == entries_.end()) {
+        // 满了先淘汰最久未用的条目
+        if (entries_.size() >= MAX_ENTRIES) {
+            auto oldest = std::min_element(entries_.begin(), entries_.end(),
+                                           [](const Entry& a, const Entry& b) { return a.lastUsed < b.lastUsed; });
+            entries_.erase(oldest);
+        }
+        Entry entry;
+        for (const QString& table : tables) {
+            entry.tables.append(table.toLower());
+        }
+        entry.correction = ratio;
+        it = entries_.insert(signature, entry);
+    } else {
+        // 对数域指数平滑：偶尔一次偏差不会让修正系数大幅摆动
+        const double logCorrection = (1.0 - SMOOTHING) * std::log(it->correction) + SMOOTHING * std::log(ratio);
+        it->correction = std::exp(logCorrection);
+    }
+
+    ++it->observations;
+    it->lastEstimated = estimatedRows;
+    it->lastActual = actualRows;
+    it->lastUsed = ++clock_;
+}
+
+double CardinalityFeedback::correction(const QString& signature) const {
+    QMutexLocker locker(&mutex_);
+    auto it = entries_.constFind(signature);
+    if (it == entries_.constEnd()) {
+        return 1.0;
+    }
+    return it->correction;
+}
+
+bool CardinalityFeedback::getEntry(const QString& signature, Entry& entry) const {
+    QMutexLocker locker(&mutex_);
+    auto it = entries_.constFind(signature);
+    if (it == entries_.constEnd()) {
+        return false;
+    }
+    entry = it.value();
+    return true;
+}
+
+void CardinalityFeedback::invalidateTable(const QString& tableName) {
+    QMutexLocker locker(&mutex_);
+    const QString lowerName = tableName.toLower();
+    for (auto it = entries_.begin(); it != entries_.end();) {
+        if (it->tables.contains(lowerName)) {
+            it = entries_.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void CardinalityFeedback::clear() {
+    QMutexLocker locker(&mutex_);
+    entries_.clear();
+}
+
+int CardinalityFeedback::size() const {
+    QMutexLocker locker(&mutex_);
+    return static_cast<int>(entries_.size());
+}
+
+} // namespace qindb
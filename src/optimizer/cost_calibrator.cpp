@@ -0,0 +1,265 @@
+#include "qindb/cost_calibrator.h"
+#include "qindb/catalog.h"
+#include "qindb/disk_manager.h"
+#include "qindb/page.h"
+#include "qindb/table_page.h"
+#include "qindb/expression_evaluator.h"
+#include "qindb/ast.h"
+#include "qindb/logger.h"
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <algorithm>
+#include <limits>
+#include <memory>
+#include <random>
+#include <utility>
+#include <vector>
+
+namespace qindb {
+
+namespace {
+
+constexpr size_t EVAL_ROWS = 16384;     // 表达式求值测量用的行数
+
+/**
+ * @brief 测试表：整数、变长字符串、浮点数各一列
+ */
+TableDef calibrationTable() {
+    TableDef table("qindb_calibrate");
+
+    ColumnDef id;
+    id.name = "id";
+    id.type = DataType::INT;
+    table.columns.append(id);
+
+    ColumnDef name;
+    name.name = "name";
+    name.type = DataType::VARCHAR;
+    name.length = 32;
+    table.columns.append(name);
+
+    ColumnDef score;
+    score.name = "score";
+    score.type = DataType::DOUBLE;
+    table.columns.append(score);
+
+    return table;
+}
+
+/**
+ * @brief 把 fn 执行 CostCalibrator::ROUNDS 次，返回最快一次的耗时（纳秒），fn 失败时返回 -1
+ * @param prepare 每次执行前调用，不计入耗时
+ */
+template <typename Fn, typename Prepare>
+qint64 fastestRound(Fn&& fn, Prepare&& prepare) {
+    qint64 best = std::numeric_limits<qint64>::max();
+    for (int round = 0; round < CostCalibrator::ROUNDS; ++round) {
+        prepare();
+        QElapsedTimer timer;
+        timer.start();
+        if (!fn()) {
+            return -1;
+        }
+        best = std::min(best, timer.nsecsElapsed());
+    }
+    return best;
+}
+
+template <typename Fn>
+qint64 fastestRound(Fn&& fn) {
+    return fastestRound(std::forward<Fn>(fn), []() {});
+}
+
+} // namespace
+
+CostCalibrator::CostCalibrator(const QString& workDir, size_t numPages)
+    : workDir_(workDir)
+    , numPages_(std::max<size_t>(numPages, 1)) {
+}
+
+bool CostCalibrator::calibrate(const CostParams& baseParams, CalibrationResult& result) {
+    result = CalibrationResult();
+
+    const QString filePath = QDir(workDir_).filePath("qindb_calibrate.tmp");
+    QFile::remove(filePath);
+
+    const TableDef table = calibrationTable();
+    std::unique_ptr<Page[]> pages(new Page[numPages_]);
+    std::vector<PageId> pageIds;
+    pageIds.reserve(numPages_);
+
+    bool success = true;
+    {
+        DiskManager diskManager(filePath);
+        if (!diskManager.isOpen()) {
+            LOG_ERROR(QString("Failed to create calibration file '%1'").arg(filePath));
+            return false;
+        }
+
+        // 1. 在内存中装满表页
+        RowId rowId = 1;
+        for (size_t i = 0; i < numPages_ && success; ++i) {
+            const PageId pageId = diskManager.allocatePage();
+            if (pageId == INVALID_PAGE_ID) {
+                success = false;
+                break;
+            }
+            pageIds.push_back(pageId);
+
+            Page* page = &pages[i];
+            TablePage::init(page, pageId);
+            while (true) {
+                const QVector<QVariant> values = {
+                    QVariant(static_cast<int>(rowId)),
+                    QVariant(QString("name_%1").arg(rowId % 10007)),
+                    QVariant(static_cast<double>(rowId % 100) + 0.5)
+                };
+                if (!TablePage::insertRecord(page, &table, rowId, values)) {
+                    break;
+                }
+                ++rowId;
+                ++result.numTuples;
+            }
+            page->updateChecksum();
+        }
+
+        // 2. 写页
+        const qint64 writeNs = success ? fastestRound([&]() {
+            for (size_t i = 0; i < pageIds.size(); ++i) {
+                if (!diskManager.writePage(pageIds[i], &pages[i])) {
+                    return false;
+                }
+            }
+            diskManager.flush();
+            return true;
+        }) : -1;
+
+        // 3. 按页号顺序读、按随机顺序读（读到同一个页缓冲区，之后解码用内存中的页）
+        //    每轮读之前丢弃页缓存，否则刚写入的文件全在缓存中，测到的是内存拷贝
+        result.coldReads = true;
+        const auto dropCache = [&]() {
+            if (!diskManager.dropOSCache()) {
+                result.coldReads = false;
+            }
+        };
+        Page readBuffer;
+        const qint64 seqReadNs = writeNs >= 0 ? fastestRound([&]() {
+            for (PageId pageId : pageIds) {
+                if (!diskManager.readPage(pageId, &readBuffer)) {
+                    return false;
+                }
+            }
+            return true;
+        }, dropCache) : -1;
+
+        std::vector<PageId> randomOrder = pageIds;
+        std::shuffle(randomOrder.begin(), randomOrder.end(), std::mt19937(12345));
+        const qint64 randomReadNs = seqReadNs >= 0 ? fastestRound([&]() {
+            for (PageId pageId : randomOrder) {
+                if (!diskManager.readPage(pageId, &readBuffer)) {
+                    return false;
+                }
+            }
+            return true;
+        }, dropCache) : -1;
+
+        success = success && writeNs >= 0 && seqReadNs > 0 && randomReadNs >= 0;
+        if (success) {
+            const double numPages = static_cast<double>(pageIds.size());
+            result.numPages = pageIds.size();
+            result.pageWriteNs = writeNs / numPages;
+            result.seqPageReadNs = seqReadNs / numPages;
+            result.randomPageReadNs = randomReadNs / numPages;
+        }
+        diskManager.close();
+    }
+    QFile::remove(filePath);
+
+    if (!success || result.numTuples == 0) {
+        LOG_ERROR("Cost calibration failed: could not write or read the calibration file");
+        return false;
+    }
+
+    // 4. 解码记录
+    const qint64 decodeNs = fastestRound([&]() {
+        QVector<QVector<QVariant>> records;
+        for (size_t i = 0; i < numPages_; ++i) {
+            records.clear();
+            if (!TablePage::getAllRecords(&pages[i], &table, records)) {
+                return false;
+            }
+        }
+        return true;
+    });
+    if (decodeNs < 0) {
+        LOG_ERROR("Cost calibration failed: could not decode table pages");
+        return false;
+    }
+    result.tupleDecodeNs = static_cast<double>(decodeNs) / result.numTuples;
+
+    // 5. 在前 EVAL_ROWS 行上求值 score > 50.0（一次列读取 + 一次比较）
+    QVector<QVector<QVariant>> evalRows;
+    for (size_t i = 0; i < numPages_ && static_cast<size_t>(evalRows.size()) < EVAL_ROWS; ++i) {
+        QVector<QVector<QVariant>> records;
+        TablePage::getAllRecords(&pages[i], &table, records);
+        evalRows.append(records);
+    }
+    if (evalRows.isEmpty()) {
+        LOG_ERROR("Cost calibration failed: no rows to evaluate");
+        return false;
+    }
+
+    ast::BinaryExpression predicate(std::make_unique<ast::ColumnExpression>("", "score"),
+                                    ast::BinaryOp::GT,
+                                    std::make_unique<ast::LiteralExpression>(QVariant(50.0)));
+    ExpressionEvaluator evaluator(nullptr);
+    const qint64 evalNs = fastestRound([&]() {
+        for (const auto& row : evalRows) {
+            evaluator.evaluateWithRow(&predicate, &table, row);
+        }
+        return !evaluator.hasError();
+    });
+    if (evalNs < 0) {
+        LOG_ERROR(QString("Cost calibration failed: %1").arg(evaluator.getLastError()));
+        return false;
+    }
+    result.operatorEvalNs = static_cast<double>(evalNs) / evalRows.size();
+
+    if (!result.coldReads) {
+        LOG_WARN("Cost calibration: could not drop the OS page cache, reads were served from memory; "
+                 "keeping the configured random/sequential read ratio");
+    }
+    result.params = fitParams(result, baseParams);
+
+    LOG_INFO(QString("Cost calibration: %1 pages, %2 tuples; seq read %3 ns, random read %4 ns, "
+                     "write %5 ns, decode %6 ns/tuple, operator %7 ns")
+                 .arg(result.numPages).arg(result.numTuples)
+                 .arg(result.seqPageReadNs, 0, 'f', 0).arg(result.randomPageReadNs, 0, 'f', 0)
+                 .arg(result.pageWriteNs, 0, 'f', 0).arg(result.tupleDecodeNs, 0, 'f', 1)
+                 .arg(result.operatorEvalNs, 0, 'f', 1));
+    return true;
+}
+
+CostParams CostCalibrator::fitParams(const CalibrationResult& measured, const CostParams& baseParams) {
+    CostParams params = baseParams;
+    if (measured.seqPageReadNs <= 0.0) {
+        return params;
+    }
+
+    // 以顺序读一页为单位；随机读不会比顺序读便宜（测量误差可能让它略小）
+    const double unit = measured.seqPageReadNs;
+    params.seqPageReadCost = 1.0;
+    // 读命中页缓存时随机读与顺序读几乎一样快，这个比值没有意义，保留 baseParams 中的值
+    params.randomPageReadCost = measured.coldReads
+        ? std::max(1.0, measured.randomPageReadNs / unit)
+        : std::max(1.0, baseParams.seqPageReadCost > 0.0
+                            ? baseParams.randomPageReadCost / baseParams.seqPageReadCost
+                            : baseParams.randomPageReadCost);
+    params.pageWriteCost = measured.pageWriteNs / unit;
+    params.tupleProcessCost = measured.tupleDecodeNs / unit;
+    params.operatorCost = measured.operatorEvalNs / unit;
+    return params;
+}
+
+} // namespace qindb
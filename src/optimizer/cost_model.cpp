@@ -30,7 +30,10 @@ CostEstimate CostModel::estimateSeqScanCost(const TableStats& stats, double sele
 
 CostEstimate CostModel::estimateIndexScanCost(const TableStats& stats,
                                               const QString& indexName,
-                                              double selectivity) const {
+                                              double selectivity,
+                                              size_t entryWidth,
+                                              double indexFraction,
+                                              double correlation) const {
     Q_UNUSED(indexName);
     CostEstimate cost;
 
@@ -38,17 +41,25 @@ CostEstimate CostModel::estimateIndexScanCost(const TableStats& stats,
     cost.estimatedRows = static_cast<size_t>(std::ceil(stats.numRows * selectivity));
     cost.estimatedWidth = stats.avgRowSize;
 
-    // 索引大小估算（假设索引占表的20%）
-    size_t indexPages = stats.numPages / 5;
+    // 索引大小估算：知道条目宽度时按宽度计算，否则假设索引占表的20%；
+    // 部分索引只含满足谓词的行
+    indexFraction = std::clamp(indexFraction, 0.0, 1.0);
+    const size_t indexedRows = static_cast<size_t>(std::ceil(stats.numRows * indexFraction));
+    size_t indexPages = entryWidth > 0 ? estimateIndexPages(indexedRows, entryWidth)
+                                       : static_cast<size_t>(std::ceil(stats.numPages / 5.0 * indexFraction));
 
     // I/O 成本：
     // 1. 索引查找成本 (B+树遍历，log(N))
     double indexHeight = std::log2(indexPages + 1);
     cost.ioCost = indexHeight * params_.randomPageReadCost;
 
-    // 2. 表数据随机读取成本
-    size_t dataPages = std::min(cost.estimatedRows, stats.numPages);
-    cost.ioCost += dataPages * params_.randomPageReadCost;
+    // 范围内的叶子页顺序读取（条目越宽，页数越多）
+    if (entryWidth > 0) {
+        cost.ioCost += estimateIOCost(estimateIndexPages(cost.estimatedRows, entryWidth), true);
+    }
+
+    // 2. 表数据读取成本
+    cost.ioCost += estimateHeapFetchIOCost(stats, selectivity, cost.estimatedRows, correlation);
 
     // CPU 成本：
     // 1. 索引搜索
@@ -66,6 +77,149 @@ CostEstimate CostModel::estimateIndexScanCost(const TableStats& stats,
     return cost;
 }
 
+CostEstimate CostModel::estimateIndexOnlyScanCost(const TableStats& stats,
+                                                  double selectivity,
+                                                  size_t entryWidth,
+                                                  double indexFraction) const {
+    CostEstimate cost;
+
+    cost.estimatedRows = static_cast<size_t>(std::ceil(stats.numRows * selectivity));
+    cost.estimatedWidth = entryWidth;
+
+    // I/O 成本：B+ 树路径 + 范围内的叶子页，没有回表读取
+    indexFraction = std::clamp(indexFraction, 0.0, 1.0);
+    size_t indexPages = estimateIndexPages(static_cast<size_t>(std::ceil(stats.numRows * indexFraction)),
+                                           entryWidth);
+    double indexHeight = std::log2(indexPages + 1);
+    cost.ioCost = indexHeight * params_.randomPageReadCost;
+    cost.ioCost += estimateIOCost(estimateIndexPages(cost.estimatedRows, entryWidth), true);
+
+    // CPU 成本：索引搜索 + 解码条目
+    cost.cpuCost = indexHeight * params_.indexSearchCost;
+    cost.cpuCost += estimateCPUCost(cost.estimatedRows);
+
+    cost.startupCost = params_.indexSearchCost;
+    cost.totalCost = cost.startupCost + cost.ioCost + cost.cpuCost;
+
+    return cost;
+}
+
+CostEstimate CostModel::estimateHashIndexScanCost(const TableStats& stats,
+                                                  double selectivity,
+                                                  size_t numProbes,
+                                                  double correlation) const {
+    CostEstimate cost;
+    numProbes = std::max<size_t>(numProbes, 1);
+
+    cost.estimatedRows = static_cast<size_t>(std::ceil(stats.numRows * selectivity));
+    cost.estimatedWidth = stats.avgRowSize;
+
+    // I/O 成本：
+    // 1. 每次探测读一个桶页（负载因子 0.75 时溢出页很少，按 1.1 页计）
+    cost.ioCost = numProbes * 1.1 * params_.randomPageReadCost;
+
+    // 2. 表数据读取成本
+    cost.ioCost += estimateHeapFetchIOCost(stats, selectivity, cost.estimatedRows, correlation);
+
+    // CPU 成本：每次探测一次哈希 + 桶内比较，加上处理返回的元组
+    cost.cpuCost = numProbes * params_.indexSearchCost;
+    cost.cpuCost += estimateCPUCost(cost.estimatedRows);
+
+    cost.startupCost = params_.indexSearchCost;
+    cost.totalCost = cost.startupCost + cost.ioCost + cost.cpuCost;
+
+    return cost;
+}
+
+CostEstimate CostModel::estimateBlockRangeScanCost(const TableStats& stats,
+                                                   double selectivity,
+                                                   double pageFraction,
+                                                   size_t summaryPages) const {
+    CostEstimate cost;
+    pageFraction = std::clamp(pageFraction, 0.0, 1.0);
+
+    cost.estimatedRows = static_cast<size_t>(std::ceil(stats.numRows * selectivity));
+    cost.estimatedWidth = stats.avgRowSize;
+
+    // I/O 成本：摘要页 + 未被排除的数据页（按表链表顺序读，视为顺序读取）
+    const size_t dataPages = static_cast<size_t>(std::ceil(stats.numPages * pageFraction));
+    cost.ioCost = estimateIOCost(summaryPages, true) + estimateIOCost(dataPages, true);
+
+    // CPU 成本：每页比较一次摘要，读到的页内所有元组都要过滤
+    cost.cpuCost = stats.numPages * params_.operatorCost;
+    cost.cpuCost += estimateCPUCost(static_cast<size_t>(std::ceil(stats.numRows * pageFraction)));
+
+    // 启动成本：读完摘要才能开始扫描
+    cost.startupCost = params_.seqPageReadCost;
+    cost.totalCost = cost.startupCost + cost.ioCost + cost.cpuCost;
+
+    return cost;
+}
+
+CostEstimate CostModel::estimateBitmapScanCost(const TableStats& stats,
+                                               double selectivity,
+                                               double indexSelectivity,
+                                               size_t numBitmaps) const {
+    CostEstimate cost;
+    numBitmaps = std::max<size_t>(numBitmaps, 1);
+    indexSelectivity = std::clamp(indexSelectivity, 0.0, 1.0);
+
+    cost.estimatedRows = static_cast<size_t>(std::ceil(stats.numRows * selectivity));
+    cost.estimatedWidth = stats.avgRowSize;
+
+    // I/O 成本：
+    // 1. 每个位图按一次随机读计（低基数列的位图通常只有一两页）
+    cost.ioCost = numBitmaps * params_.randomPageReadCost;
+
+    // 2. 候选行按行ID升序回表，同一数据页只读一次
+    const size_t candidateRows = static_cast<size_t>(std::ceil(stats.numRows * indexSelectivity));
+    const size_t dataPages = std::min(candidateRows, stats.numPages);
+    cost.ioCost += dataPages * params_.randomPageReadCost;
+
+    // CPU 成本：目录查找 + 位图运算（每个候选行一次位运算的量级），加上过滤回表的元组
+    cost.cpuCost = numBitmaps * params_.indexSearchCost;
+    cost.cpuCost += candidateRows * params_.operatorCost;
+    cost.cpuCost += estimateCPUCost(candidateRows);
+
+    cost.startupCost = numBitmaps * params_.indexSearchCost;
+    cost.totalCost = cost.startupCost + cost.ioCost + cost.cpuCost;
+
+    return cost;
+}
+
+CostEstimate CostModel::estimateTrieScanCost(const TableStats& stats,
+                                             double selectivity,
+                                             double indexSelectivity,
+                                             size_t entryWidth) const {
+    CostEstimate cost;
+    indexSelectivity = std::clamp(indexSelectivity, 0.0, 1.0);
+
+    cost.estimatedRows = static_cast<size_t>(std::ceil(stats.numRows * selectivity));
+    cost.estimatedWidth = stats.avgRowSize;
+
+    // I/O 成本：
+    // 1. 下降路径：路径压缩后的深度与 B+ 树同量级
+    const size_t indexPages = estimateIndexPages(stats.numRows, entryWidth);
+    const double pathLength = std::log2(indexPages + 1) + 1.0;
+    cost.ioCost = pathLength * params_.randomPageReadCost;
+
+    // 2. 子树中的叶子（随机读），再按行回表
+    const size_t candidateRows = static_cast<size_t>(std::ceil(stats.numRows * indexSelectivity));
+    cost.ioCost += estimateIndexPages(candidateRows, entryWidth) * params_.randomPageReadCost;
+    const size_t dataPages = std::min(candidateRows, stats.numPages);
+    cost.ioCost += dataPages * params_.randomPageReadCost;
+
+    // CPU 成本：路径上的节点查找 + 逐个解码叶子，加上过滤回表的元组
+    cost.cpuCost = pathLength * params_.indexSearchCost;
+    cost.cpuCost += candidateRows * params_.operatorCost;
+    cost.cpuCost += estimateCPUCost(candidateRows);
+
+    cost.startupCost = pathLength * params_.indexSearchCost;
+    cost.totalCost = cost.startupCost + cost.ioCost + cost.cpuCost;
+
+    return cost;
+}
+
 // ========== 连接成本估算 ==========
 
 CostEstimate CostModel::estimateNestedLoopJoinCost(const TableStats& outerStats,
@@ -154,6 +308,42 @@ CostEstimate CostModel::estimateHashJoinCost(const TableStats& buildStats,
     return cost;
 }
 
+CostEstimate CostModel::estimateIndexNestedLoopJoinCost(const TableStats& outerStats,
+                                                        const TableStats& innerStats,
+                                                        double outerSelectivity,
+                                                        double rowsPerProbe) const {
+    CostEstimate cost;
+
+    // 估算行数
+    size_t outerRows = static_cast<size_t>(outerStats.numRows * outerSelectivity);
+    rowsPerProbe = std::max(rowsPerProbe, 0.0);
+    cost.estimatedRows = static_cast<size_t>(std::ceil(outerRows * rowsPerProbe));
+    cost.estimatedWidth = outerStats.avgRowSize + innerStats.avgRowSize;
+
+    // I/O 成本：
+    // 1. 扫描外表一次
+    cost.ioCost = estimateIOCost(outerStats.numPages, true);
+
+    // 2. 外表每行探测一次内表索引（读一个桶页，按 1.1 页计）
+    cost.ioCost += outerRows * 1.1 * params_.randomPageReadCost;
+
+    // 3. 命中的内表行随机读取，最多读完内表
+    cost.ioCost += estimateIOCost(std::min(cost.estimatedRows, innerStats.numPages), false);
+
+    // CPU 成本：处理外表、每次探测、拼接结果行
+    cost.cpuCost = estimateCPUCost(outerRows);
+    cost.cpuCost += outerRows * params_.indexSearchCost;
+    cost.cpuCost += estimateCPUCost(cost.estimatedRows);
+
+    // 启动成本
+    cost.startupCost = params_.indexSearchCost;
+
+    // 总成本
+    cost.totalCost = cost.startupCost + cost.ioCost + cost.cpuCost;
+
+    return cost;
+}
+
 CostEstimate CostModel::estimateSortMergeJoinCost(const TableStats& leftStats,
                                                   const TableStats& rightStats,
                                                   double leftSelectivity,
@@ -301,4 +491,29 @@ double CostModel::estimateSortCPUCost(size_t numRows) const {
     return numRows * std::log2(numRows) * params_.operatorCost;
 }
 
+double CostModel::estimateHeapFetchIOCost(const TableStats& stats, double selectivity,
+                                          size_t fetchedRows, double correlation) const {
+    // 不相关时每页随机读，完全相关时只读选择率比例的连续页，中间按相关系数的平方插值
+    const size_t dataPages = std::min(fetchedRows, stats.numPages);
+    if (dataPages == 0) {
+        return 0.0;
+    }
+    const double uncorrelatedIO = dataPages * params_.randomPageReadCost;
+    const size_t orderedPages = std::max<size_t>(1, static_cast<size_t>(std::ceil(stats.numPages * selectivity)));
+    const double correlatedIO = params_.randomPageReadCost +
+                                (std::min(orderedPages, dataPages) - 1) * params_.seqPageReadCost;
+    const double correlationSquared = std::clamp(correlation * correlation, 0.0, 1.0);
+    return uncorrelatedIO + correlationSquared * (correlatedIO - uncorrelatedIO);
+}
+
+size_t CostModel::estimateIndexPages(size_t numRows, size_t entryWidth) const {
+    if (numRows == 0) return 0;
+
+    // 叶子条目 = 键（含 rowId 和包含列）+ 值槽（8 字节）+ 长度前缀；
+    // 随机插入时 B+ 树页平均约 70% 满
+    const size_t entryBytes = entryWidth + sizeof(uint64_t) + sizeof(uint16_t) * 2;
+    const size_t entriesPerPage = std::max<size_t>(1, static_cast<size_t>(PAGE_SIZE * 0.7) / entryBytes);
+    return (numRows + entriesPerPage - 1) / entriesPerPage;
+}
+
 } // namespace qindb
@@ -1,7 +1,12 @@
 #include "qindb/cost_optimizer.h"
 #include "qindb/catalog.h"
+#include "qindb/index_expression.h"
+#include "qindb/expression_evaluator.h"
 #include "qindb/logger.h"
+#include "qindb/hyperloglog.h"
+#include "qindb/cardinality_feedback.h"
 #include <algorithm>
+#include <cmath>
 #include <limits>
 
 namespace qindb {
@@ -26,18 +31,41 @@ std::unique_ptr<PlanNode> CostOptimizer::optimizeSelect(const ast::SelectStateme
     if (selectStmt->from && selectStmt->joins.empty()) {
         QString tableName = selectStmt->from->tableName;
 
-        // 生成访问路径
-        auto plan = generateAccessPath(tableName, selectStmt->where.get());
-
-        // 如果有 LIMIT，应用 LIMIT 优化
-        if (selectStmt->limit > 0) {
-            auto limitPlan = std::make_unique<PlanNode>(PlanNodeType::LIMIT);
-            limitPlan->cost = costModel_.estimateLimitCost(plan->cost, selectStmt->limit);
-            limitPlan->addChild(std::move(plan));
-            return limitPlan;
+        // 查询用到的列，用于判断索引能否覆盖查询（与执行器判断仅索引扫描的方式一致）
+        QSet<QString> requiredColumns;
+        const TableDef* table = catalog_ ? catalog_->getTable(tableName) : nullptr;
+        bool columnsKnown = table != nullptr;
+        if (table) {
+            QSet<int> columnIndexes;
+            columnsKnown = IndexExpression::collectReferencedColumns(selectStmt->where.get(), table, columnIndexes);
+            bool selectAll = selectStmt->selectList.empty();
+            for (const auto& expr : selectStmt->selectList) {
+                auto* colExpr = dynamic_cast<ast::ColumnExpression*>(expr.get());
+                if (colExpr && colExpr->column == "*") {
+                    selectAll = true;
+                } else {
+                    columnsKnown = columnsKnown &&
+                                   IndexExpression::collectReferencedColumns(expr.get(), table, columnIndexes);
+                }
+            }
+            for (int i = 0; i < table->columns.size(); ++i) {
+                if (selectAll || columnIndexes.contains(i)) {
+                    requiredColumns.insert(table->columns[i].name.toLower());
+                }
+            }
         }
 
-        return plan;
+        // 生成访问路径
+        auto plan = generateAccessPath(tableName, selectStmt->where.get(),
+                                       columnsKnown ? &requiredColumns : nullptr);
+        return addResultOperators(selectStmt, std::move(plan));
+    }
+
+    // 两表连接：执行器按这里选出的连接算法和构建侧执行
+    if (selectStmt->from && selectStmt->joins.size() == 1) {
+        auto plan = optimizeJoinClause(selectStmt->from.get(), selectStmt->joins[0].get(),
+                                       selectStmt->where.get());
+        return plan ? addResultOperators(selectStmt, std::move(plan)) : nullptr;
     }
 
     // 多表连接查询
@@ -52,7 +80,227 @@ std::unique_ptr<PlanNode> CostOptimizer::optimizeSelect(const ast::SelectStateme
     // TODO: 提取连接条件
     QVector<ast::Expression*> joinConditions;
 
-    return optimizeJoin(tables, joinConditions);
+    auto plan = optimizeJoin(tables, joinConditions);
+    return plan ? addResultOperators(selectStmt, std::move(plan)) : nullptr;
+}
+
+std::unique_ptr<PlanNode> CostOptimizer::optimizeJoinClause(const ast::TableReference* leftRef,
+                                                            const ast::JoinClause* join,
+                                                            const ast::Expression* filter) {
+    if (!leftRef || !join || !join->right) {
+        return nullptr;
+    }
+
+    const QString& leftName = leftRef->tableName;
+    const QString& rightName = join->right->tableName;
+    auto leftPlan = generateAccessPath(leftName, nullptr);
+    auto rightPlan = generateAccessPath(rightName, nullptr);
+
+    // 等值内连接才能用哈希表或索引按键匹配
+    QString leftColumn;
+    QString rightColumn;
+    const TableDef* leftTable = catalog_ ? catalog_->getTable(leftName) : nullptr;
+    const TableDef* rightTable = catalog_ ? catalog_->getTable(rightName) : nullptr;
+    int leftColumnIndex = -1;
+    int rightColumnIndex = -1;
+    const bool equiJoin = join->type == ast::JoinType::INNER && leftTable && rightTable &&
+                          IndexExpression::matchEquiJoinColumns(join->condition.get(), leftRef, leftTable,
+                                                                join->right.get(), rightTable,
+                                                                leftColumnIndex, rightColumnIndex);
+    if (equiJoin) {
+        leftColumn = leftTable->columns[leftColumnIndex].name;
+        rightColumn = rightTable->columns[rightColumnIndex].name;
+    }
+
+    // 右表连接列上的单列哈希索引：对左表每行探测一次
+    const IndexDef* innerIndex = nullptr;
+    QVector<IndexDef> rightIndexes = equiJoin ? catalog_->getTableIndexes(rightName) : QVector<IndexDef>();
+    for (const IndexDef& candidate : rightIndexes) {
+        if (candidate.indexType == IndexType::HASH && candidate.columns.size() == 1 &&
+            candidate.columns[0].compare(rightColumn, Qt::CaseInsensitive) == 0 &&
+            candidate.rootPageId != INVALID_PAGE_ID) {
+            innerIndex = &candidate;
+            break;
+        }
+    }
+
+    auto makeIndexNestedLoop = [&](const CostEstimate& joinCost, const CostEstimate& probeCost) {
+        auto innerPlan = std::make_unique<PlanNode>(PlanNodeType::INDEX_SCAN);
+        innerPlan->tableName = rightName;
+        innerPlan->indexName = innerIndex->name;
+        innerPlan->cost = probeCost;
+        innerPlan->estimated = rightPlan->estimated;
+
+        auto joinPlan = std::make_unique<PlanNode>(PlanNodeType::NESTED_LOOP_JOIN);
+        joinPlan->joinColumn = rightColumn;
+        joinPlan->cost = joinCost;
+        joinPlan->addChild(std::move(leftPlan));
+        joinPlan->addChild(std::move(innerPlan));
+        return joinPlan;
+    };
+
+    const TableStats* leftStats = getTableStats(leftName);
+    const TableStats* rightStats = getTableStats(rightName);
+    if (!leftStats || !rightStats) {
+        // 没有统计信息：能用索引嵌套循环就用，否则嵌套循环
+        CostEstimate defaultCost;
+        defaultCost.totalCost = leftPlan->cost.totalCost + rightPlan->cost.totalCost;
+        defaultCost.estimatedRows = std::max(leftPlan->cost.estimatedRows, rightPlan->cost.estimatedRows);
+
+        std::unique_ptr<PlanNode> joinPlan;
+        if (innerIndex) {
+            joinPlan = makeIndexNestedLoop(defaultCost, rightPlan->cost);
+        } else {
+            joinPlan = std::make_unique<PlanNode>(PlanNodeType::NESTED_LOOP_JOIN);
+            joinPlan->cost = defaultCost;
+            joinPlan->addChild(std::move(leftPlan));
+            joinPlan->addChild(std::move(rightPlan));
+        }
+        joinPlan->estimated = false;
+        return joinPlan;
+    }
+
+    CostEstimate nestedLoopCost = costModel_.estimateNestedLoopJoinCost(*leftStats, *rightStats, 1.0, 1.0);
+    PlanNodeType bestType = PlanNodeType::NESTED_LOOP_JOIN;
+    CostEstimate bestCost = nestedLoopCost;
+    bool buildLeft = false;
+    bool useInnerIndex = false;
+
+    CostEstimate probeCost;
+    if (innerIndex) {
+        // 每次探测命中的行数 = 内表行数 / 连接列的不同值数
+        const ColumnStats* columnStats = rightStats->getColumnStats(rightColumn);
+        const double distinct = columnStats && columnStats->numDistinctValues > 0
+            ? static_cast<double>(columnStats->numDistinctValues) : static_cast<double>(rightStats->numRows);
+        const double rowsPerProbe = distinct > 0 ? rightStats->numRows / distinct : 1.0;
+        CostEstimate indexCost = costModel_.estimateIndexNestedLoopJoinCost(*leftStats, *rightStats,
+                                                                            1.0, rowsPerProbe);
+        probeCost = costModel_.estimateHashIndexScanCost(
+            *rightStats, rightStats->numRows > 0 ? rowsPerProbe / rightStats->numRows : 1.0, 1);
+        if (indexCost.isCheaperThan(bestCost)) {
+            bestCost = indexCost;
+            useInnerIndex = true;
+        }
+    }
+
+    if (equiJoin) {
+        // 两个方向都试：构建侧越小，哈希表越省内存
+        CostEstimate buildRightCost = costModel_.estimateHashJoinCost(*rightStats, *leftStats, 1.0, 1.0);
+        CostEstimate buildLeftCost = costModel_.estimateHashJoinCost(*leftStats, *rightStats, 1.0, 1.0);
+        const bool leftCheaper = buildLeftCost.isCheaperThan(buildRightCost);
+        const CostEstimate& hashCost = leftCheaper ? buildLeftCost : buildRightCost;
+        if (hashCost.isCheaperThan(bestCost)) {
+            bestCost = hashCost;
+            bestType = PlanNodeType::HASH_JOIN;
+            buildLeft = leftCheaper;
+            useInnerIndex = false;
+        }
+    }
+
+    // 连接结果行数按两边连接列的不同值重叠估算（各算法的估算只按表行数粗略给出），
+    // 再按同一连接（及 WHERE 条件）之前执行的实际行数修正
+    QString feedbackKey;
+    size_t feedbackBaseRows = 0;
+    if (equiJoin) {
+        feedbackBaseRows = estimateJoinRows(*leftStats, leftColumn, *rightStats, rightColumn);
+        feedbackKey = CardinalityFeedback::joinSignature(leftName, leftColumn, rightName, rightColumn);
+        if (filter) {
+            feedbackKey += "|" + filter->toString();
+        }
+        bestCost.estimatedRows = static_cast<size_t>(
+            std::llround(feedbackBaseRows * feedbackCorrection(feedbackKey)));
+    }
+
+    if (useInnerIndex) {
+        LOG_INFO(QString("Choosing index NestedLoopJoin on '%1' using '%2' (cost: %3 vs %4)")
+                    .arg(rightName).arg(innerIndex->name)
+                    .arg(bestCost.totalCost).arg(nestedLoopCost.totalCost));
+        auto joinPlan = makeIndexNestedLoop(bestCost, probeCost);
+        joinPlan->feedbackKey = feedbackKey;
+        joinPlan->feedbackBaseRows = feedbackBaseRows;
+        return joinPlan;
+    }
+
+    auto joinPlan = std::make_unique<PlanNode>(bestType);
+    joinPlan->cost = bestCost;
+    joinPlan->feedbackKey = feedbackKey;
+    joinPlan->feedbackBaseRows = feedbackBaseRows;
+    if (bestType == PlanNodeType::HASH_JOIN) {
+        LOG_INFO(QString("Choosing HashJoin building on '%1' (cost: %2 vs %3)")
+                    .arg(buildLeft ? leftName : rightName)
+                    .arg(bestCost.totalCost).arg(nestedLoopCost.totalCost));
+        joinPlan->joinColumn = rightColumn;
+        joinPlan->addChild(buildLeft ? std::move(leftPlan) : std::move(rightPlan));
+        joinPlan->addChild(buildLeft ? std::move(rightPlan) : std::move(leftPlan));
+    } else {
+        LOG_INFO(QString("Choosing NestedLoopJoin (cost: %1)").arg(bestCost.totalCost));
+        joinPlan->addChild(std::move(leftPlan));
+        joinPlan->addChild(std::move(rightPlan));
+    }
+    return joinPlan;
+}
+
+std::unique_ptr<PlanNode> CostOptimizer::addResultOperators(const ast::SelectStatement* selectStmt,
+                                                            std::unique_ptr<PlanNode> plan) {
+    const bool estimated = plan->estimated;
+
+    // 分组：单表按一列（两列）分组且有统计信息时组数取该列（列组）的不同值数，否则按输入行数的十分之一估算
+    if (selectStmt->groupBy) {
+        const size_t inputRows = plan->cost.estimatedRows;
+        size_t numGroups = std::max<size_t>(1, inputRows / 10);
+        const auto& groupExprs = selectStmt->groupBy->expressions;
+        QVector<const ast::ColumnExpression*> groupColumns;
+        for (const auto& groupExpr : groupExprs) {
+            if (auto* column = dynamic_cast<const ast::ColumnExpression*>(groupExpr.get())) {
+                groupColumns.append(column);
+            }
+        }
+        const bool columnsOnly = groupColumns.size() == static_cast<qsizetype>(groupExprs.size()) &&
+                                 groupColumns.size() <= 2;
+        const TableStats* stats = columnsOnly && selectStmt->from && selectStmt->joins.empty()
+            ? getTableStats(selectStmt->from->tableName) : nullptr;
+        size_t distinct = 0;
+        if (stats && groupColumns.size() == 1) {
+            const ColumnStats* columnStats = stats->getColumnStats(groupColumns[0]->column);
+            distinct = columnStats ? columnStats->numDistinctValues : 0;
+        } else if (stats && groupColumns.size() == 2) {
+            const ColumnGroupStats* group = stats->getColumnGroupStats(groupColumns[0]->column,
+                                                                       groupColumns[1]->column);
+            distinct = group ? group->numDistinctValues : 0;
+        }
+        if (distinct > 0) {
+            numGroups = std::min(std::max<size_t>(inputRows, 1), distinct);
+        }
+
+        auto aggregatePlan = std::make_unique<PlanNode>(PlanNodeType::AGGREGATE);
+        aggregatePlan->cost = costModel_.estimateAggregateCost(inputRows, numGroups);
+        // 读完全部输入才能输出第一组
+        aggregatePlan->cost.startupCost += plan->cost.totalCost;
+        aggregatePlan->cost.totalCost += plan->cost.totalCost;
+        aggregatePlan->estimated = estimated;
+        aggregatePlan->addChild(std::move(plan));
+        plan = std::move(aggregatePlan);
+    }
+
+    if (!selectStmt->orderBy.empty()) {
+        auto sortPlan = std::make_unique<PlanNode>(PlanNodeType::SORT);
+        sortPlan->cost = costModel_.estimateSortCost(plan->cost.estimatedRows, plan->cost.estimatedWidth);
+        sortPlan->cost.startupCost += plan->cost.totalCost;
+        sortPlan->cost.totalCost += plan->cost.totalCost;
+        sortPlan->estimated = estimated;
+        sortPlan->addChild(std::move(plan));
+        plan = std::move(sortPlan);
+    }
+
+    if (selectStmt->limit > 0) {
+        auto limitPlan = std::make_unique<PlanNode>(PlanNodeType::LIMIT);
+        limitPlan->cost = costModel_.estimateLimitCost(plan->cost, selectStmt->limit);
+        limitPlan->estimated = estimated;
+        limitPlan->addChild(std::move(plan));
+        plan = std::move(limitPlan);
+    }
+
+    return plan;
 }
 
 std::unique_ptr<PlanNode> CostOptimizer::optimizeJoin(const QVector<QString>& tables,
@@ -78,12 +326,14 @@ std::unique_ptr<PlanNode> CostOptimizer::optimizeJoin(const QVector<QString>& ta
 // ========== 执行计划生成 ==========
 
 std::unique_ptr<PlanNode> CostOptimizer::generateAccessPath(const QString& tableName,
-                                                            ast::Expression* filter) {
+                                                            ast::Expression* filter,
+                                                            const QSet<QString>* requiredColumns) {
     const TableStats* stats = getTableStats(tableName);
     if (!stats) {
-        LOG_WARN(QString("No statistics for table '%1', using SeqScan with default estimates").arg(tableName));
+        LOG_DEBUG(QString("No statistics for table '%1', using SeqScan with default estimates").arg(tableName));
         auto plan = std::make_unique<PlanNode>(PlanNodeType::SEQ_SCAN);
         plan->tableName = tableName;
+        plan->estimated = false;
         // 设置默认估算值（没有统计信息时的后备值）
         plan->cost.totalCost = 100.0;
         plan->cost.estimatedRows = 100;
@@ -91,27 +341,146 @@ std::unique_ptr<PlanNode> CostOptimizer::generateAccessPath(const QString& table
         return plan;
     }
 
-    // 估算选择率
+    // 估算选择率，再按同一条件之前执行的实际行数修正（索引和全表扫描的选择都用修正后的值）
     double selectivity = filter ? estimateSelectivity(filter, tableName) : 1.0;
+    QString feedbackKey;
+    size_t feedbackBaseRows = 0;
+    if (filter) {
+        feedbackKey = CardinalityFeedback::scanSignature(tableName, filter->toString());
+        feedbackBaseRows = static_cast<size_t>(std::ceil(stats->numRows * selectivity));
+        selectivity = std::clamp(selectivity * feedbackCorrection(feedbackKey), 0.0, 1.0);
+    }
+    auto withFeedback = [&](std::unique_ptr<PlanNode> plan) {
+        plan->feedbackKey = feedbackKey;
+        plan->feedbackBaseRows = feedbackBaseRows;
+        return plan;
+    };
 
     // 检查是否可以使用索引
-    QString indexName;
-    if (filter && canUseIndex(filter, tableName, indexName)) {
+    IndexDef index;
+    size_t numProbes = 0;
+    bool hasIndex = filter && findEqualityIndex(filter, tableName, index, numProbes);
+
+    // 复合索引：前缀等值 + 下一列范围，取回的行数按用到的条件估算（单列哈希索引仍然优先）
+    double indexSelectivity = selectivity;
+    IndexDef compositeIndex;
+    double compositeSelectivity = 1.0;
+    if (filter && !(hasIndex && index.indexType == IndexType::HASH) &&
+        findCompositeIndex(filter, tableName, compositeIndex, compositeSelectivity, requiredColumns)) {
+        index = compositeIndex;
+        indexSelectivity = compositeSelectivity;
+        hasIndex = true;
+    }
+
+    if (hasIndex) {
+        const QString& indexName = index.name;
+
+        // 复合布局的 B+ 树索引（多列、带 INCLUDE 列、表达式键或部分索引）覆盖查询时不用回表
+        const bool compositeLayout = index.indexType == IndexType::BTREE &&
+                                     (index.columns.size() > 1 || !index.includeColumns.isEmpty() ||
+                                      index.hasKeyExpressions() || index.isPartial());
+        const bool indexOnly = compositeLayout && requiredColumns && indexCovers(index, *requiredColumns);
+        const size_t entryWidth = index.indexType == IndexType::BTREE
+            ? estimateIndexEntryWidth(tableName, index, *stats) : 0;
+        const double indexFraction = estimateIndexFraction(tableName, index);
+
+        // 索引第一列的物理顺序相关系数决定回表读的页是顺序的还是随机的
+        const ColumnStats* keyStats = index.columns.isEmpty() ? nullptr
+                                                              : stats->getColumnStats(index.columns[0]);
+        const double keyCorrelation = keyStats ? keyStats->correlation : 0.0;
+
         // 比较索引扫描和全表扫描的成本
-        CostEstimate indexCost = costModel_.estimateIndexScanCost(*stats, indexName, selectivity);
+        CostEstimate indexCost;
+        if (index.indexType == IndexType::HASH) {
+            indexCost = costModel_.estimateHashIndexScanCost(*stats, selectivity, numProbes, keyCorrelation);
+        } else if (indexOnly) {
+            indexCost = costModel_.estimateIndexOnlyScanCost(*stats, indexSelectivity, entryWidth, indexFraction);
+        } else {
+            indexCost = costModel_.estimateIndexScanCost(*stats, indexName, indexSelectivity, entryWidth,
+                                                         indexFraction, keyCorrelation);
+        }
+        // 索引没用到的条件在取回的行上过滤
+        indexCost.estimatedRows = static_cast<size_t>(std::ceil(stats->numRows * selectivity));
         CostEstimate seqCost = costModel_.estimateSeqScanCost(*stats, selectivity);
 
         if (indexCost.isCheaperThan(seqCost)) {
-            LOG_INFO(QString("Choosing IndexScan on '%1' (cost: %2 vs %3)")
+            LOG_INFO(QString("Choosing %1 on '%2' (cost: %3 vs %4)")
+                        .arg(indexOnly ? "IndexOnlyScan" : "IndexScan")
                         .arg(indexName).arg(indexCost.totalCost).arg(seqCost.totalCost));
 
-            auto plan = std::make_unique<PlanNode>(PlanNodeType::INDEX_SCAN);
+            auto plan = std::make_unique<PlanNode>(indexOnly ? PlanNodeType::INDEX_ONLY_SCAN
+                                                             : PlanNodeType::INDEX_SCAN);
             plan->tableName = tableName;
             plan->indexName = indexName;
             plan->cost = indexCost;
             // TODO: Clone filter expression (需要实现 Expression copy)
             // if (filter) plan->filter = ...;
-            return plan;
+            return withFeedback(std::move(plan));
+        }
+    }
+
+    // 位图索引：所有可用的等值/IN 条件先在位图上求交，只回表交集中的行
+    IndexDef bitmapIndex;
+    double bitmapSelectivity = 1.0;
+    size_t numBitmaps = 0;
+    if (filter && findBitmapIndexes(filter, tableName, bitmapIndex, bitmapSelectivity, numBitmaps)) {
+        CostEstimate bitmapCost = costModel_.estimateBitmapScanCost(*stats, selectivity,
+                                                                    bitmapSelectivity, numBitmaps);
+        CostEstimate seqCost = costModel_.estimateSeqScanCost(*stats, selectivity);
+
+        if (bitmapCost.isCheaperThan(seqCost)) {
+            LOG_INFO(QString("Choosing BitmapScan on '%1' (cost: %2 vs %3)")
+                        .arg(bitmapIndex.name).arg(bitmapCost.totalCost).arg(seqCost.totalCost));
+
+            auto plan = std::make_unique<PlanNode>(PlanNodeType::BITMAP_SCAN);
+            plan->tableName = tableName;
+            plan->indexName = bitmapIndex.name;
+            plan->cost = bitmapCost;
+            return withFeedback(std::move(plan));
+        }
+    }
+
+    // TRIE 索引：沿前缀下降到子树，只遍历以该前缀开头的行
+    IndexDef trieIndex;
+    double trieSelectivity = 1.0;
+    if (filter && findTrieIndex(filter, tableName, trieIndex, trieSelectivity)) {
+        CostEstimate trieCost = costModel_.estimateTrieScanCost(*stats, selectivity, trieSelectivity,
+                                                                estimateIndexEntryWidth(tableName, trieIndex, *stats));
+        CostEstimate seqCost = costModel_.estimateSeqScanCost(*stats, selectivity);
+
+        if (trieCost.isCheaperThan(seqCost)) {
+            LOG_INFO(QString("Choosing TrieScan on '%1' (cost: %2 vs %3)")
+                        .arg(trieIndex.name).arg(trieCost.totalCost).arg(seqCost.totalCost));
+
+            auto plan = std::make_unique<PlanNode>(PlanNodeType::TRIE_SCAN);
+            plan->tableName = tableName;
+            plan->indexName = trieIndex.name;
+            plan->cost = trieCost;
+            return withFeedback(std::move(plan));
+        }
+    }
+
+    // 块范围索引：假定列值与插入顺序相关（BRIN 的适用前提），匹配的行集中在
+    // 约 选择率 × 总页数 个页里，再加一个边界页；每个摘要页约 100 条摘要
+    IndexDef blockRangeIndex;
+    double blockRangeSelectivity = 1.0;
+    if (filter && findBlockRangeIndex(filter, tableName, blockRangeIndex, blockRangeSelectivity)) {
+        const size_t numPages = std::max<size_t>(stats->numPages, 1);
+        const double pageFraction = std::min(1.0, blockRangeSelectivity + 1.0 / numPages);
+        const size_t summaryPages = 1 + numPages / 100;
+        CostEstimate blockRangeCost = costModel_.estimateBlockRangeScanCost(*stats, selectivity,
+                                                                            pageFraction, summaryPages);
+        CostEstimate seqCost = costModel_.estimateSeqScanCost(*stats, selectivity);
+
+        if (blockRangeCost.isCheaperThan(seqCost)) {
+            LOG_INFO(QString("Choosing BlockRangeScan on '%1' (cost: %2 vs %3)")
+                        .arg(blockRangeIndex.name).arg(blockRangeCost.totalCost).arg(seqCost.totalCost));
+
+            auto plan = std::make_unique<PlanNode>(PlanNodeType::BLOCK_RANGE_SCAN);
+            plan->tableName = tableName;
+            plan->indexName = blockRangeIndex.name;
+            plan->cost = blockRangeCost;
+            return withFeedback(std::move(plan));
         }
     }
 
@@ -122,7 +491,7 @@ std::unique_ptr<PlanNode> CostOptimizer::generateAccessPath(const QString& table
     plan->cost = costModel_.estimateSeqScanCost(*stats, selectivity);
     // TODO: Clone filter expression (需要实现 Expression copy)
     // if (filter) plan->filter = ...;
-    return plan;
+    return withFeedback(std::move(plan));
 }
 
 std::unique_ptr<PlanNode> CostOptimizer::generateJoinPlan(std::unique_ptr<PlanNode> leftPlan,
@@ -320,35 +689,14 @@ double CostOptimizer::estimateSelectivity(ast::Expression* expr, const QString&
 bool CostOptimizer::canUseIndex(ast::Expression* expr,
                                const QString& tableName,
                                QString& indexName) {
-    if (!expr) {
+    IndexDef index;
+    size_t numProbes = 0;
+    if (!findEqualityIndex(expr, tableName, index, numProbes)) {
         return false;
     }
 
-    // 检查是否是等值条件: column = value
-    QString column;
-    QVariant value;
-
-    if (!extractEquality(expr, column, value)) {
-        return false;
-    }
-
-    // 检查该列是否有索引
-    QVector<IndexDef> indexes = catalog_->getTableIndexes(tableName);
-
-    for (const IndexDef& index : indexes) {
-        if (index.columns.size() == 1 && index.columns[0] == column) {
-            indexName = index.name;
-            return true;
-        }
-
-        // 复合索引的第一列也可以使用
-        if (!index.columns.isEmpty() && index.columns[0] == column) {
-            indexName = index.name;
-            return true;
-        }
-    }
-
-    return false;
+    indexName = index.name;
+    return true;
 }
 
 PlanNodeType CostOptimizer::chooseJoinAlgorithm(const TableStats& leftStats,
@@ -369,6 +717,11 @@ PlanNodeType CostOptimizer::chooseJoinAlgorithm(const TableStats& leftStats,
     return PlanNodeType::NESTED_LOOP_JOIN;
 }
 
+double CostOptimizer::feedbackCorrection(const QString& signature) const {
+    const CardinalityFeedback* feedback = catalog_ ? catalog_->getCardinalityFeedback() : nullptr;
+    return feedback ? feedback->correction(signature) : 1.0;
+}
+
 const TableStats* CostOptimizer::getTableStats(const QString& tableName) const {
     // 先查缓存
     auto it = statsCache_.find(tableName);
@@ -387,6 +740,19 @@ const TableStats* CostOptimizer::getTableStats(const QString& tableName) const {
 
 // ========== 私有辅助方法 ==========
 
+/**
+ * @brief 展开 AND 连接的条件（保留非二元表达式的条件，用于选择率估算）
+ */
+static void flattenAnd(ast::Expression* expr, QVector<ast::Expression*>& conjuncts) {
+    auto* binExpr = dynamic_cast<ast::BinaryExpression*>(expr);
+    if (binExpr && binExpr->op == ast::BinaryOp::AND) {
+        flattenAnd(binExpr->left.get(), conjuncts);
+        flattenAnd(binExpr->right.get(), conjuncts);
+        return;
+    }
+    conjuncts.append(expr);
+}
+
 double CostOptimizer::estimateBinaryOpSelectivity(ast::BinaryExpression* binExpr, const QString& tableName) {
     const TableStats* stats = getTableStats(tableName);
     if (!stats) {
@@ -403,19 +769,52 @@ double CostOptimizer::estimateBinaryOpSelectivity(ast::BinaryExpression* binExpr
         }
     }
 
+    // IN 列表: 各值的选择率之和
+    if (binExpr->op == ast::BinaryOp::IN) {
+        QString column;
+        QVector<QVariant> values;
+
+        if (extractInList(binExpr, column, values)) {
+            double sel = 0.0;
+            for (const QVariant& value : values) {
+                sel += stats->estimateSelectivity(column, value);
+            }
+            return std::min(sel, 1.0);
+        }
+    }
+
+    // 前缀匹配: column LIKE 'abc%'（以通配符开头的模式仍按默认值估算）
+    if (binExpr->op == ast::BinaryOp::LIKE) {
+        QString column;
+        QString prefix;
+        bool exact = false;
+
+        if (extractLikePrefix(binExpr, column, prefix, exact)) {
+            return exact ? stats->estimateSelectivity(column, prefix)
+                         : stats->estimatePrefixSelectivity(column, prefix);
+        }
+    }
+
     // 范围条件: column > value, column < value, column BETWEEN a AND b
     if (binExpr->op == ast::BinaryOp::GT || binExpr->op == ast::BinaryOp::LT ||
         binExpr->op == ast::BinaryOp::GE || binExpr->op == ast::BinaryOp::LE) {
-        // 简化：范围查询选择率估算为 1/3
+        QString column;
+        QVariant value;
+        bool isLower = false;
+
+        if (extractRangeBound(binExpr, column, value, isLower)) {
+            return isLower ? stats->estimateRangeSelectivity(column, value, QVariant())
+                           : stats->estimateRangeSelectivity(column, QVariant(), value);
+        }
+        // 无法识别的范围条件（如表达式比较）估算为 1/3
         return 0.33;
     }
 
     // AND/OR 逻辑操作
     if (binExpr->op == ast::BinaryOp::AND) {
-        double leftSel = estimateSelectivity(binExpr->left.get(), tableName);
-        double rightSel = estimateSelectivity(binExpr->right.get(), tableName);
-        // 独立性假设：P(A AND B) = P(A) * P(B)
-        return leftSel * rightSel;
+        QVector<ast::Expression*> conjuncts;
+        flattenAnd(binExpr, conjuncts);
+        return estimateConjunctionSelectivity(conjuncts, tableName);
     } else if (binExpr->op == ast::BinaryOp::OR) {
         double leftSel = estimateSelectivity(binExpr->left.get(), tableName);
         double rightSel = estimateSelectivity(binExpr->right.get(), tableName);
@@ -455,6 +854,589 @@ bool CostOptimizer::extractEquality(ast::Expression* expr, QString& column, QVar
     return false;
 }
 
+size_t CostOptimizer::estimateJoinRows(const TableStats& leftStats, const QString& leftColumn,
+                                      const TableStats& rightStats, const QString& rightColumn) const {
+    const ColumnStats* left = leftStats.getColumnStats(leftColumn);
+    const ColumnStats* right = rightStats.getColumnStats(rightColumn);
+    if (!left || !right || left->numDistinctValues == 0 || right->numDistinctValues == 0) {
+        // 没有列统计：按较大的表的行数作为不同值数
+        const double maxRows = static_cast<double>(std::max<size_t>({leftStats.numRows, rightStats.numRows, 1}));
+        return static_cast<size_t>(std::llround(static_cast<double>(leftStats.numRows) * rightStats.numRows / maxRows));
+    }
+
+    const double leftRows = static_cast<double>(leftStats.numRows - std::min(left->numNulls, leftStats.numRows));
+    const double rightRows = static_cast<double>(rightStats.numRows - std::min(right->numNulls, rightStats.numRows));
+    const double leftDistinct = static_cast<double>(left->numDistinctValues);
+    const double rightDistinct = static_cast<double>(right->numDistinctValues);
+
+    // 两边都有不同值草图时，交集的不同值数 = |A| + |B| - |A ∪ B|；否则假设较小的一边全部能匹配
+    double matchingDistinct = std::min(leftDistinct, rightDistinct);
+    HyperLogLog leftSketch;
+    HyperLogLog rightSketch;
+    if (HyperLogLog::fromRegisters(left->distinctSketch, leftSketch) &&
+        HyperLogLog::fromRegisters(right->distinctSketch, rightSketch)) {
+        const int precision = std::min(leftSketch.precision(), rightSketch.precision());
+        HyperLogLog unionSketch = leftSketch.reduced(precision);
+        const HyperLogLog other = rightSketch.reduced(precision);
+        const double leftEstimate = unionSketch.estimate();
+        const double rightEstimate = other.estimate();
+        unionSketch.merge(other);
+        const double overlap = leftEstimate + rightEstimate - unionSketch.estimate();
+        const double smaller = std::min(leftEstimate, rightEstimate);
+        if (smaller > 0.0) {
+            matchingDistinct *= std::clamp(overlap / smaller, 0.0, 1.0);
+        }
+    }
+
+    // 每个匹配的值在左边约 leftRows / leftDistinct 行、右边约 rightRows / rightDistinct 行
+    return static_cast<size_t>(std::llround(matchingDistinct * (leftRows / leftDistinct) *
+                                            (rightRows / rightDistinct)));
+}
+
+bool CostOptimizer::extractRangeBound(ast::Expression* expr, QString& column, QVariant& value, bool& isLower) {
+    auto* binExpr = dynamic_cast<ast::BinaryExpression*>(expr);
+    if (!binExpr) {
+        return false;
+    }
+
+    bool greater;
+    switch (binExpr->op) {
+        case ast::BinaryOp::GT:
+        case ast::BinaryOp::GE:
+            greater = true;
+            break;
+        case ast::BinaryOp::LT:
+        case ast::BinaryOp::LE:
+            greater = false;
+            break;
+        default:
+            return false;
+    }
+
+    // column > value 是下界；value > column 即 column < value，是上界
+    auto* leftCol = dynamic_cast<ast::ColumnExpression*>(binExpr->left.get());
+    auto* rightLit = dynamic_cast<ast::LiteralExpression*>(binExpr->right.get());
+    if (leftCol && rightLit) {
+        column = leftCol->column;
+        value = rightLit->value;
+        isLower = greater;
+        return !value.isNull();
+    }
+
+    auto* rightCol = dynamic_cast<ast::ColumnExpression*>(binExpr->right.get());
+    auto* leftLit = dynamic_cast<ast::LiteralExpression*>(binExpr->left.get());
+    if (rightCol && leftLit) {
+        column = rightCol->column;
+        value = leftLit->value;
+        isLower = !greater;
+        return !value.isNull();
+    }
+
+    return false;
+}
+
+double CostOptimizer::estimateConjunctionSelectivity(const QVector<ast::Expression*>& conjuncts,
+                                                     const QString& tableName) {
+    const TableStats* stats = getTableStats(tableName);
+
+    // 同一列上的下界和上界合并成一个区间估算（x >= a AND x <= b 不是两个独立事件），
+    // 有列组统计的两列上的等值条件按函数依赖合并，其余条件按独立性假设相乘：P(A AND B) = P(A) * P(B)
+    struct ColumnRange {
+        QString column;
+        QVariant lower;
+        QVariant upper;
+    };
+    struct ColumnEquality {
+        QString column;
+        double selectivity;
+    };
+    QVector<ColumnRange> ranges;
+    QVector<ColumnEquality> equalities;
+
+    double selectivity = 1.0;
+    for (ast::Expression* conjunct : conjuncts) {
+        QString column;
+        QVariant value;
+        bool isLower = false;
+        if (stats && extractEquality(conjunct, column, value)) {
+            equalities.append({column, stats->estimateSelectivity(column, value)});
+            continue;
+        }
+        if (stats && extractRangeBound(conjunct, column, value, isLower)) {
+            auto it = std::find_if(ranges.begin(), ranges.end(), [&column](const ColumnRange& range) {
+                return range.column.compare(column, Qt::CaseInsensitive) == 0;
+            });
+            if (it == ranges.end()) {
+                ranges.append({column, QVariant(), QVariant()});
+                it = ranges.end() - 1;
+            }
+            QVariant& bound = isLower ? it->lower : it->upper;
+            if (!bound.isValid()) {
+                bound = value;
+                continue;
+            }
+        }
+        selectivity *= estimateSelectivity(conjunct, tableName);
+    }
+
+    for (const ColumnRange& range : ranges) {
+        selectivity *= stats->estimateRangeSelectivity(range.column, range.lower, range.upper);
+    }
+
+    // 相关列（如城市和邮编）：决定列的选择率乘上 d + (1 - d) × 被决定列的选择率，d 为函数依赖程度
+    QVector<bool> combined(equalities.size(), false);
+    for (int i = 0; i < equalities.size(); ++i) {
+        if (combined[i]) {
+            continue;
+        }
+        for (int j = i + 1; j < equalities.size(); ++j) {
+            bool reversed = false;
+            const ColumnGroupStats* group = combined[j] ? nullptr
+                : stats->getColumnGroupStats(equalities[i].column, equalities[j].column, &reversed);
+            if (!group) {
+                continue;
+            }
+
+            const double forward = reversed ? group->reverseDependency : group->dependency;    // i → j
+            const double backward = reversed ? group->dependency : group->reverseDependency;   // j → i
+            const bool iDetermines = forward >= backward;
+            const double degree = std::max(forward, backward);
+            const double determining = iDetermines ? equalities[i].selectivity : equalities[j].selectivity;
+            const double dependent = iDetermines ? equalities[j].selectivity : equalities[i].selectivity;
+            selectivity *= determining * (degree + (1.0 - degree) * dependent);
+            combined[i] = true;
+            combined[j] = true;
+            break;
+        }
+        if (!combined[i]) {
+            selectivity *= equalities[i].selectivity;
+        }
+    }
+    return selectivity;
+}
+
+bool CostOptimizer::extractLikePrefix(ast::Expression* expr, QString& column, QString& prefix, bool& exact) {
+    auto* binExpr = dynamic_cast<ast::BinaryExpression*>(expr);
+    if (!binExpr || binExpr->op != ast::BinaryOp::LIKE) {
+        return false;
+    }
+
+    auto* leftCol = dynamic_cast<ast::ColumnExpression*>(binExpr->left.get());
+    auto* rightLit = dynamic_cast<ast::LiteralExpression*>(binExpr->right.get());
+    if (!leftCol || !rightLit || rightLit->value.userType() != QMetaType::QString) {
+        return false;
+    }
+
+    prefix = ExpressionEvaluator::likePrefix(rightLit->value.toString(), &exact);
+    if (prefix.isEmpty()) {
+        return false;
+    }
+    column = leftCol->column;
+    return true;
+}
+
+bool CostOptimizer::extractInList(ast::Expression* expr, QString& column, QVector<QVariant>& values) {
+    auto* binExpr = dynamic_cast<ast::BinaryExpression*>(expr);
+    if (!binExpr || binExpr->op != ast::BinaryOp::IN) {
+        return false;
+    }
+
+    auto* colExpr = dynamic_cast<ast::ColumnExpression*>(binExpr->left.get());
+    auto* listExpr = dynamic_cast<ast::ListExpression*>(binExpr->right.get());
+    if (!colExpr || !listExpr || listExpr->elements.empty()) {
+        return false;
+    }
+
+    // 只接受字面值列表
+    values.clear();
+    for (const auto& element : listExpr->elements) {
+        auto* lit = dynamic_cast<ast::LiteralExpression*>(element.get());
+        if (!lit) {
+            return false;
+        }
+        values.append(lit->value);
+    }
+
+    column = colExpr->column;
+    return true;
+}
+
+bool CostOptimizer::findEqualityIndex(ast::Expression* expr,
+                                      const QString& tableName,
+                                      IndexDef& index,
+                                      size_t& numProbes) {
+    if (!expr) {
+        return false;
+    }
+
+    // AND：任一侧可以走索引，另一侧在取回的行上过滤
+    auto* binExpr = dynamic_cast<ast::BinaryExpression*>(expr);
+    if (binExpr && binExpr->op == ast::BinaryOp::AND) {
+        return findEqualityIndex(binExpr->left.get(), tableName, index, numProbes) ||
+               findEqualityIndex(binExpr->right.get(), tableName, index, numProbes);
+    }
+
+    // 等值条件 column = value 或 column IN (v1, v2, ...)
+    QString column;
+    QVariant value;
+    QVector<QVariant> values;
+    if (extractEquality(expr, column, value)) {
+        numProbes = 1;
+    } else if (extractInList(expr, column, values)) {
+        numProbes = static_cast<size_t>(values.size());
+    } else {
+        return false;
+    }
+
+    // 检查该列是否有索引：单列哈希索引优先（O(1) 探测），其次是以该列开头的有序索引
+    QVector<IndexDef> indexes = catalog_->getTableIndexes(tableName);
+    const IndexDef* best = nullptr;
+
+    for (const IndexDef& candidate : indexes) {
+        if (candidate.columns.isEmpty() || candidate.columns[0] != column) {
+            continue;
+        }
+
+        // 部分索引和表达式索引由 findCompositeIndex 匹配
+        if (candidate.isPartial() || candidate.isKeyExpression(0)) {
+            continue;
+        }
+
+        if (candidate.indexType == IndexType::HASH) {
+            // 哈希索引只能按完整键探测
+            if (candidate.columns.size() == 1) {
+                best = &candidate;
+                break;
+            }
+            continue;
+        }
+
+        // 单列 B+ 树索引的重复键互相覆盖（插入时不检查唯一性），不能按键取回全部匹配行，
+        // 执行器不用它回答查询
+        if (candidate.indexType == IndexType::BTREE && candidate.columns.size() == 1 &&
+            candidate.includeColumns.isEmpty()) {
+            continue;
+        }
+
+        // 倒排索引只服务 MATCH ... AGAINST；块范围索引只能排除数据页，不能定位行；
+        // 位图索引由 findBitmapIndexes、TRIE 索引由 findTrieIndex 单独估算；R 树索引只回答空间谓词
+        if (candidate.indexType == IndexType::INVERTED || candidate.indexType == IndexType::BRIN ||
+            candidate.indexType == IndexType::BITMAP || candidate.indexType == IndexType::RTREE ||
+            candidate.indexType == IndexType::TRIE) {
+            continue;
+        }
+
+        // 复合索引的第一列也可以使用
+        if (!best) {
+            best = &candidate;
+        }
+    }
+
+    if (!best) {
+        return false;
+    }
+
+    index = *best;
+    return true;
+}
+
+/**
+ * @brief 展开 AND 连接的条件，只保留二元表达式的合取项（拆分见 IndexExpression::splitConjuncts）
+ */
+static void collectConjuncts(ast::Expression* expr, QVector<ast::BinaryExpression*>& conjuncts) {
+    QVector<const ast::Expression*> parts;
+    IndexExpression::splitConjuncts(expr, parts);
+    for (const ast::Expression* part : parts) {
+        // 合取项都是 expr 的子树，这里的提取函数接受非 const 指针
+        if (auto* binExpr = dynamic_cast<ast::BinaryExpression*>(const_cast<ast::Expression*>(part))) {
+            conjuncts.append(binExpr);
+        }
+    }
+}
+
+/**
+ * @brief 条件是否为 索引第 i 个键 op 常量（常量可以在左侧）
+ *
+ * 普通列按列名匹配（不区分大小写），表达式键按规范化 SQL 逐字匹配。
+ * @param equality true 匹配 =，false 匹配 </<=/>/>=
+ */
+static bool isComparisonOnKey(ast::BinaryExpression* binExpr, const IndexDef& index, int i, bool equality) {
+    const bool isRange = binExpr->op == ast::BinaryOp::GT || binExpr->op == ast::BinaryOp::GE ||
+                         binExpr->op == ast::BinaryOp::LT || binExpr->op == ast::BinaryOp::LE;
+    if (equality ? binExpr->op != ast::BinaryOp::EQ : !isRange) {
+        return false;
+    }
+
+    ast::Expression* keyExpr = binExpr->left.get();
+    auto* litExpr = dynamic_cast<ast::LiteralExpression*>(binExpr->right.get());
+    if (!litExpr || dynamic_cast<ast::LiteralExpression*>(keyExpr)) {
+        keyExpr = binExpr->right.get();
+        litExpr = dynamic_cast<ast::LiteralExpression*>(binExpr->left.get());
+    }
+    if (!litExpr || litExpr->value.isNull() || dynamic_cast<ast::LiteralExpression*>(keyExpr)) {
+        return false;
+    }
+
+    if (index.isKeyExpression(i)) {
+        return IndexExpression::toSql(keyExpr) == index.keyExpressions[i];
+    }
+    auto* colExpr = dynamic_cast<ast::ColumnExpression*>(keyExpr);
+    return colExpr && colExpr->column.compare(index.columns[i], Qt::CaseInsensitive) == 0;
+}
+
+bool CostOptimizer::findCompositeIndex(ast::Expression* expr,
+                                       const QString& tableName,
+                                       IndexDef& index,
+                                       double& indexSelectivity,
+                                       const QSet<QString>* requiredColumns) {
+    if (!expr) {
+        return false;
+    }
+
+    QVector<ast::BinaryExpression*> conjuncts;
+    collectConjuncts(expr, conjuncts);
+
+    int bestScore = 0;
+    bool bestCovers = false;
+    QVector<IndexDef> indexes = catalog_->getTableIndexes(tableName);
+    for (const IndexDef& candidate : indexes) {
+        if (candidate.indexType != IndexType::BTREE ||
+            (candidate.columns.size() < 2 && candidate.includeColumns.isEmpty() &&
+             !candidate.hasKeyExpressions() && !candidate.isPartial())) {
+            continue;
+        }
+
+        // 部分索引：查询条件必须蕴含索引谓词，否则索引里缺行
+        if (candidate.isPartial()) {
+            auto predicate = IndexExpression::parseCached(candidate.predicate);
+            if (!predicate || !IndexExpression::implies(expr, predicate.get())) {
+                continue;
+            }
+        }
+
+        // 前 k 键等值（索引只含部分行时，取回的行再乘上这个比例）
+        double selectivity = estimateIndexFraction(tableName, candidate);
+        int matched = 0;
+        while (matched < candidate.columns.size()) {
+            ast::BinaryExpression* equality = nullptr;
+            for (ast::BinaryExpression* conjunct : conjuncts) {
+                if (isComparisonOnKey(conjunct, candidate, matched, true)) {
+                    equality = conjunct;
+                    break;
+                }
+            }
+            if (!equality) {
+                break;
+            }
+            selectivity *= estimateBinaryOpSelectivity(equality, tableName);
+            ++matched;
+        }
+
+        // 第 k+1 键的范围（上下界一起估算）
+        bool hasRange = false;
+        if (matched < candidate.columns.size()) {
+            QVector<ast::Expression*> rangeConjuncts;
+            for (ast::BinaryExpression* conjunct : conjuncts) {
+                if (isComparisonOnKey(conjunct, candidate, matched, false)) {
+                    rangeConjuncts.append(conjunct);
+                }
+            }
+            if (!rangeConjuncts.isEmpty()) {
+                selectivity *= estimateConjunctionSelectivity(rangeConjuncts, tableName);
+                hasRange = true;
+            }
+        }
+
+        // 可用的部分索引即使没有键条件，扫描整个索引也只读满足谓词的行
+        const int score = matched * 2 + (hasRange ? 1 : 0) + (candidate.isPartial() ? 1 : 0);
+        const bool covers = requiredColumns && indexCovers(candidate, *requiredColumns);
+        if (score > bestScore || (score > 0 && score == bestScore && covers && !bestCovers)) {
+            bestScore = score;
+            bestCovers = covers;
+            index = candidate;
+            indexSelectivity = selectivity;
+        }
+    }
+
+    return bestScore > 0;
+}
+
+bool CostOptimizer::findBlockRangeIndex(ast::Expression* expr,
+                                        const QString& tableName,
+                                        IndexDef& index,
+                                        double& indexSelectivity) {
+    if (!expr) {
+        return false;
+    }
+
+    QVector<ast::BinaryExpression*> conjuncts;
+    collectConjuncts(expr, conjuncts);
+
+    bool found = false;
+    QVector<IndexDef> indexes = catalog_->getTableIndexes(tableName);
+    for (const IndexDef& candidate : indexes) {
+        if (candidate.indexType != IndexType::BRIN || candidate.columns.size() != 1) {
+            continue;
+        }
+
+        double selectivity = 1.0;
+        bool restricted = false;
+        for (ast::BinaryExpression* conjunct : conjuncts) {
+            QString column;
+            QVector<QVariant> values;
+            if (isComparisonOnKey(conjunct, candidate, 0, true) ||
+                isComparisonOnKey(conjunct, candidate, 0, false) ||
+                (extractInList(conjunct, column, values) &&
+                 column.compare(candidate.columns[0], Qt::CaseInsensitive) == 0)) {
+                selectivity *= estimateBinaryOpSelectivity(conjunct, tableName);
+                restricted = true;
+            }
+        }
+
+        if (restricted && (!found || selectivity < indexSelectivity)) {
+            index = candidate;
+            indexSelectivity = selectivity;
+            found = true;
+        }
+    }
+
+    return found;
+}
+
+bool CostOptimizer::findBitmapIndexes(ast::Expression* expr,
+                                      const QString& tableName,
+                                      IndexDef& index,
+                                      double& indexSelectivity,
+                                      size_t& numBitmaps) {
+    if (!expr) {
+        return false;
+    }
+
+    QVector<ast::BinaryExpression*> conjuncts;
+    collectConjuncts(expr, conjuncts);
+
+    bool found = false;
+    indexSelectivity = 1.0;
+    numBitmaps = 0;
+    QVector<IndexDef> indexes = catalog_->getTableIndexes(tableName);
+    for (ast::BinaryExpression* conjunct : conjuncts) {
+        QString column;
+        QVariant value;
+        QVector<QVariant> values;
+        if (extractEquality(conjunct, column, value)) {
+            values.append(value);
+        } else if (!extractInList(conjunct, column, values)) {
+            continue;
+        }
+
+        for (const IndexDef& candidate : indexes) {
+            if (candidate.indexType != IndexType::BITMAP || candidate.columns.size() != 1 ||
+                candidate.columns[0].compare(column, Qt::CaseInsensitive) != 0) {
+                continue;
+            }
+            if (!found) {
+                index = candidate;
+                found = true;
+            }
+            indexSelectivity *= estimateBinaryOpSelectivity(conjunct, tableName);
+            numBitmaps += std::max<qsizetype>(values.size(), 1);
+            break;
+        }
+    }
+
+    return found;
+}
+
+bool CostOptimizer::findTrieIndex(ast::Expression* expr, const QString& tableName,
+                                  IndexDef& index, double& indexSelectivity) {
+    if (!expr) {
+        return false;
+    }
+
+    QVector<ast::BinaryExpression*> conjuncts;
+    collectConjuncts(expr, conjuncts);
+
+    bool found = false;
+    indexSelectivity = 1.0;
+    QVector<IndexDef> indexes = catalog_->getTableIndexes(tableName);
+    for (ast::BinaryExpression* conjunct : conjuncts) {
+        QString column;
+        QString prefix;
+        QVariant value;
+        bool exact = false;
+        if (!extractLikePrefix(conjunct, column, prefix, exact) &&
+            !(extractEquality(conjunct, column, value) && value.userType() == QMetaType::QString)) {
+            continue;
+        }
+
+        for (const IndexDef& candidate : indexes) {
+            if (candidate.indexType != IndexType::TRIE || candidate.columns.size() != 1 ||
+                candidate.columns[0].compare(column, Qt::CaseInsensitive) != 0) {
+                continue;
+            }
+            if (!found) {
+                index = candidate;
+                found = true;
+            }
+            indexSelectivity *= estimateBinaryOpSelectivity(conjunct, tableName);
+            break;
+        }
+    }
+
+    return found;
+}
+
+double CostOptimizer::estimateIndexFraction(const QString& tableName, const IndexDef& index) {
+    if (!index.isPartial()) {
+        return 1.0;
+    }
+    std::unique_ptr<ast::Expression> predicate = IndexExpression::parse(index.predicate);
+    return predicate ? estimateSelectivity(predicate.get(), tableName) : 1.0;
+}
+
+bool CostOptimizer::indexCovers(const IndexDef& index, const QSet<QString>& requiredColumns) {
+    QSet<QString> available;
+    for (int i = 0; i < index.columns.size(); ++i) {
+        // 表达式键的值不是列值
+        if (!index.isKeyExpression(i)) {
+            available.insert(index.columns[i].toLower());
+        }
+    }
+    for (const QString& column : index.includeColumns) {
+        available.insert(column.toLower());
+    }
+    for (const QString& column : requiredColumns) {
+        if (!available.contains(column)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+size_t CostOptimizer::estimateIndexEntryWidth(const QString& tableName, const IndexDef& index,
+                                              const TableStats& stats) const {
+    const TableDef* table = catalog_ ? catalog_->getTable(tableName) : nullptr;
+    const size_t columnCount = table && !table->columns.isEmpty() ? table->columns.size() : 1;
+
+    // 变长列按平均行宽均摊到每列估算
+    const size_t variableWidth = std::max<size_t>(8, stats.avgRowSize / columnCount);
+
+    size_t width = sizeof(RowId);
+    auto addColumn = [&](const QString& name) {
+        int columnIndex = table ? table->getColumnIndex(name) : -1;
+        DataType type = columnIndex >= 0 ? table->columns[columnIndex].type : DataType::VARCHAR;
+        // 每列一个 NULL 标记字节
+        width += 1 + ((isIntegerType(type) || isFloatType(type)) ? 8 : variableWidth);
+    };
+    for (const QString& column : index.columns) {
+        addColumn(column);
+    }
+    for (const QString& column : index.includeColumns) {
+        addColumn(column);
+    }
+    return width;
+}
+
 bool CostOptimizer::referencesColumn(ast::Expression* expr, const QString& columnName) {
     if (!expr) {
         return false;
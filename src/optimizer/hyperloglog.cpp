@@ -0,0 +1,131 @@
+#include "qindb/hyperloglog.h"
+#include "qindb/hash_util.h"
+#include <algorithm>
+#include <bit>
+#include <cmath>
+
+namespace qindb {
+
+HyperLogLog::HyperLogLog(int precision)
+    : precision_(std::clamp(precision, MIN_PRECISION, MAX_PRECISION))
+    , registers_(1 << precision_, '\0') {
+}
+
+uint64_t HyperLogLog::hashValue(const QVariant& value, DataType type) {
+    if (isIntegerType(type)) {
+        return HashUtil::hashInt(static_cast<uint64_t>(value.toLongLong()));
+    }
+
+    if (isFloatType(type)) {
+        // 整数值按整数哈希，INT 列和 DOUBLE 列的相同值得到相同哈希（连接键的重叠估计要用）
+        const double d = value.toDouble();
+        if (std::isfinite(d) && std::floor(d) == d && std::fabs(d) < 9.2e18) {
+            return HashUtil::hashInt(static_cast<uint64_t>(static_cast<qint64>(d)));
+        }
+        return HashUtil::hashBytes(&d, sizeof(d));
+    }
+
+    return HashUtil::hashBytes(value.toString().toUtf8());
+}
+
+void HyperLogLog::add(uint64_t hash) {
+    const uint32_t index = static_cast<uint32_t>(hash >> (64 - precision_));
+
+    // 低位补一个哨兵位，秩最大为 64 - precision + 1
+    const uint64_t rest = (hash << precision_) | (uint64_t(1) << (precision_ - 1));
+    const char rank = static_cast<char>(std::countl_zero(rest) + 1);
+
+    if (rank > registers_[index]) {
+        registers_[index] = rank;
+    }
+}
+
+void HyperLogLog::addValue(const QVariant& value, DataType type) {
+    if (!value.isNull()) {
+        add(hashValue(value, type));
+    }
+}
+
+bool HyperLogLog::merge(const HyperLogLog& other) {
+    if (other.precision_ != precision_) {
+        return false;
+    }
+
+    char* regs = registers_.data();
+    const char* otherRegs = other.registers_.constData();
+    for (qsizetype i = 0; i < registers_.size(); ++i) {
+        regs[i] = std::max(regs[i], otherRegs[i]);
+    }
+    return true;
+}
+
+HyperLogLog HyperLogLog::reduced(int precision) const {
+    precision = std::max(precision, MIN_PRECISION);
+    if (precision >= precision_) {
+        return *this;
+    }
+
+    // 去掉的低位成为剩余位的最高位：不全为零时秩由它们决定，全为零时在原秩上加去掉的位数
+    const int dropped = precision_ - precision;
+    const uint32_t droppedMask = (uint32_t(1) << dropped) - 1;
+    HyperLogLog result(precision);
+    char* regs = result.registers_.data();
+    for (qsizetype i = 0; i < registers_.size(); ++i) {
+        const char reg = registers_[i];
+        if (reg == 0) {
+            continue;
+        }
+        const uint32_t low = static_cast<uint32_t>(i) & droppedMask;
+        const char rank = static_cast<char>(low != 0 ? dropped - std::bit_width(low) + 1 : dropped + reg);
+        const qsizetype index = i >> dropped;
+        regs[index] = std::max(regs[index], rank);
+    }
+    return result;
+}
+
+double HyperLogLog::estimate() const {
+    const double m = static_cast<double>(registers_.size());
+
+    double sum = 0.0;
+    int zeros = 0;
+    for (char reg : registers_) {
+        sum += std::ldexp(1.0, -static_cast<int>(reg));
+        if (reg == 0) {
+            ++zeros;
+        }
+    }
+
+    double alpha;
+    switch (registers_.size()) {
+        case 16: alpha = 0.673; break;
+        case 32: alpha = 0.697; break;
+        case 64: alpha = 0.709; break;
+        default: alpha = 0.7213 / (1.0 + 1.079 / m); break;
+    }
+
+    const double raw = alpha * m * m / sum;
+
+    // 小基数：线性计数更准
+    if (raw <= 2.5 * m && zeros > 0) {
+        return m * std::log(m / zeros);
+    }
+    return raw;
+}
+
+bool HyperLogLog::fromRegisters(const QByteArray& registers, HyperLogLog& sketch) {
+    const qsizetype size = registers.size();
+    if (size <= 0 || !std::has_single_bit(static_cast<uint64_t>(size))) {
+        return false;
+    }
+
+    const int precision = std::countr_zero(static_cast<uint64_t>(size));
+    if (precision < MIN_PRECISION || precision > MAX_PRECISION) {
+        return false;
+    }
+
+    sketch.precision_ = precision;
+    sketch.registers_ = registers;
+    return true;
+}
+
+} // namespace qindb
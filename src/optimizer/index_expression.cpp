@@ -0,0 +1,596 @@
+#include "qindb/index_expression.h"
+#include "qindb/expression_evaluator.h"
+#include "qindb/parser.h"
+#include <QHash>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QStringList>
+
+namespace qindb {
+
+namespace {
+
+QString canonicalFunctionName(const QString& name) {
+    const QString upper = name.toUpper();
+    if (upper == "LCASE") return "lower";
+    if (upper == "UCASE") return "upper";
+    if (upper == "CHAR_LENGTH") return "length";
+    if (upper == "SUBSTR") return "substring";
+    if (upper == "IFNULL") return "coalesce";
+    if (upper == "ST_MAKEPOINT") return "st_point";
+    return name.toLower();
+}
+
+QString literalToSql(const QVariant& value) {
+    if (value.isNull()) {
+        return "NULL";
+    }
+    switch (value.userType()) {
+        case QMetaType::Bool:
+            return value.toBool() ? "TRUE" : "FALSE";
+        case QMetaType::Int:
+        case QMetaType::UInt:
+        case QMetaType::LongLong:
+        case QMetaType::ULongLong:
+        case QMetaType::Short:
+        case QMetaType::UShort:
+            return value.toString();
+        case QMetaType::Double:
+        case QMetaType::Float: {
+            // 保证重新解析后仍是浮点字面值
+            QString text = QString::number(value.toDouble(), 'g', 17);
+            if (!text.contains('.') && !text.contains('e') && !text.contains("inf") && !text.contains("nan")) {
+                text += ".0";
+            }
+            return text;
+        }
+        default:
+            break;
+    }
+
+    QString text = value.toString();
+    text.replace("\\", "\\\\");
+    text.replace("'", "\\'");
+    text.replace("\n", "\\n");
+    text.replace("\r", "\\r");
+    text.replace("\t", "\\t");
+    return "'" + text + "'";
+}
+
+QString binaryOpToSql(ast::BinaryOp op) {
+    switch (op) {
+        case ast::BinaryOp::ADD: return "+";
+        case ast::BinaryOp::SUB: return "-";
+        case ast::BinaryOp::MUL: return "*";
+        case ast::BinaryOp::DIV: return "/";
+        case ast::BinaryOp::MOD: return "%";
+        case ast::BinaryOp::EQ: return "=";
+        case ast::BinaryOp::NE: return "<>";
+        case ast::BinaryOp::LT: return "<";
+        case ast::BinaryOp::LE: return "<=";
+        case ast::BinaryOp::GT: return ">";
+        case ast::BinaryOp::GE: return ">=";
+        case ast::BinaryOp::AND: return "AND";
+        case ast::BinaryOp::OR: return "OR";
+        case ast::BinaryOp::LIKE: return "LIKE";
+        case ast::BinaryOp::IN: return "IN";
+    }
+    return "?";
+}
+
+bool isComparison(ast::BinaryOp op) {
+    return op == ast::BinaryOp::EQ || op == ast::BinaryOp::NE ||
+           op == ast::BinaryOp::LT || op == ast::BinaryOp::LE ||
+           op == ast::BinaryOp::GT || op == ast::BinaryOp::GE;
+}
+
+ast::BinaryOp flipComparison(ast::BinaryOp op) {
+    switch (op) {
+        case ast::BinaryOp::LT: return ast::BinaryOp::GT;
+        case ast::BinaryOp::LE: return ast::BinaryOp::GE;
+        case ast::BinaryOp::GT: return ast::BinaryOp::LT;
+        case ast::BinaryOp::GE: return ast::BinaryOp::LE;
+        default: return op;
+    }
+}
+
+bool isNumericVariant(const QVariant& value) {
+    switch (value.userType()) {
+        case QMetaType::Bool:
+        case QMetaType::Int:
+        case QMetaType::UInt:
+        case QMetaType::LongLong:
+        case QMetaType::ULongLong:
+        case QMetaType::Short:
+        case QMetaType::UShort:
+        case QMetaType::Double:
+        case QMetaType::Float:
+            return true;
+        default:
+            return false;
+    }
+}
+
+bool isIntegralVariant(const QVariant& value) {
+    switch (value.userType()) {
+        case QMetaType::Bool:
+        case QMetaType::Int:
+        case QMetaType::UInt:
+        case QMetaType::LongLong:
+        case QMetaType::Short:
+        case QMetaType::UShort:
+            return true;
+        default:
+            return false;
+    }
+}
+
+/**
+ * @brief 比较两个字面值，类型不可比较时返回 false
+ */
+bool compareLiterals(const QVariant& a, const QVariant& b, int& result) {
+    if (a.isNull() || b.isNull()) {
+        return false;
+    }
+    if (isNumericVariant(a) && isNumericVariant(b)) {
+        // 两侧都是整数时按 qint64 比较：超过 2^53 的整数转成 double 会丢精度而被误判为相等
+        if (isIntegralVariant(a) && isIntegralVariant(b)) {
+            const qint64 x = a.toLongLong();
+            const qint64 y = b.toLongLong();
+            result = x < y ? -1 : (x > y ? 1 : 0);
+            return true;
+        }
+        const double x = a.toDouble();
+        const double y = b.toDouble();
+        result = x < y ? -1 : (x > y ? 1 : 0);
+        return true;
+    }
+    if (a.userType() == QMetaType::QString && b.userType() == QMetaType::QString) {
+        result = QString::compare(a.toString(), b.toString());
+        result = result < 0 ? -1 : (result > 0 ? 1 : 0);
+        return true;
+    }
+    return false;
+}
+
+/**
+ * @brief "表达式 op 字面值" 形式的比较（字面值在左侧时翻转运算符）
+ */
+struct Comparison {
+    QString subject;
+    ast::BinaryOp op;
+    QVariant value;
+};
+
+bool asComparison(const ast::Expression* expr, Comparison& out) {
+    auto* binary = dynamic_cast<const ast::BinaryExpression*>(expr);
+    if (!binary || !isComparison(binary->op)) {
+        return false;
+    }
+    auto* leftLiteral = dynamic_cast<const ast::LiteralExpression*>(binary->left.get());
+    auto* rightLiteral = dynamic_cast<const ast::LiteralExpression*>(binary->right.get());
+    if (rightLiteral && !leftLiteral) {
+        out.subject = IndexExpression::toSql(binary->left.get());
+        out.op = binary->op;
+        out.value = rightLiteral->value;
+    } else if (leftLiteral && !rightLiteral) {
+        out.subject = IndexExpression::toSql(binary->right.get());
+        out.op = flipComparison(binary->op);
+        out.value = leftLiteral->value;
+    } else {
+        return false;
+    }
+    return !out.value.isNull();
+}
+
+/**
+ * @brief w: x wop a 是否蕴含 p: x pop b
+ */
+bool comparisonImplies(const Comparison& w, const Comparison& p) {
+    int c = 0;  // a 与 b 的比较结果
+    if (!compareLiterals(w.value, p.value, c)) {
+        return false;
+    }
+
+    switch (p.op) {
+        case ast::BinaryOp::EQ:
+            return w.op == ast::BinaryOp::EQ && c == 0;
+        case ast::BinaryOp::NE:
+            switch (w.op) {
+                case ast::BinaryOp::EQ: return c != 0;
+                case ast::BinaryOp::NE: return c == 0;
+                case ast::BinaryOp::LT: return c <= 0;
+                case ast::BinaryOp::LE: return c < 0;
+                case ast::BinaryOp::GT: return c >= 0;
+                case ast::BinaryOp::GE: return c > 0;
+                default: return false;
+            }
+        case ast::BinaryOp::LT:
+            return (w.op == ast::BinaryOp::EQ && c < 0) ||
+                   (w.op == ast::BinaryOp::LT && c <= 0) ||
+                   (w.op == ast::BinaryOp::LE && c < 0);
+        case ast::BinaryOp::LE:
+            return (w.op == ast::BinaryOp::EQ || w.op == ast::BinaryOp::LT ||
+                    w.op == ast::BinaryOp::LE) && c <= 0;
+        case ast::BinaryOp::GT:
+            return (w.op == ast::BinaryOp::EQ && c > 0) ||
+                   (w.op == ast::BinaryOp::GT && c >= 0) ||
+                   (w.op == ast::BinaryOp::GE && c > 0);
+        case ast::BinaryOp::GE:
+            return (w.op == ast::BinaryOp::EQ || w.op == ast::BinaryOp::GT ||
+                    w.op == ast::BinaryOp::GE) && c >= 0;
+        default:
+            return false;
+    }
+}
+
+bool conjunctImplies(const ast::Expression* w, const QString& wSql, const ast::Expression* p, const QString& pSql) {
+    if (wSql == pSql) {
+        return true;
+    }
+
+    // x IS NOT NULL：x 上的任意比较（比较 NULL 结果不为真）
+    if (auto* unary = dynamic_cast<const ast::UnaryExpression*>(p)) {
+        if (unary->op != ast::UnaryOp::IS_NOT_NULL) {
+            return false;
+        }
+        const QString subject = IndexExpression::toSql(unary->expr.get());
+        Comparison wc;
+        return asComparison(w, wc) && wc.subject == subject;
+    }
+
+    Comparison wc;
+    Comparison pc;
+    if (!asComparison(w, wc) || !asComparison(p, pc) || wc.subject != pc.subject) {
+        return false;
+    }
+    return comparisonImplies(wc, pc);
+}
+
+/**
+ * @brief 连接条件中的列引用属于该表时返回列下标，否则返回 -1
+ */
+int resolveJoinColumn(const ast::ColumnExpression* column, const ast::TableReference* ref,
+                      const TableDef* table) {
+    if (!column->table.isEmpty() &&
+        column->table.compare(ref->tableName, Qt::CaseInsensitive) != 0 &&
+        column->table.compare(ref->alias, Qt::CaseInsensitive) != 0) {
+        return -1;
+    }
+    return table->getColumnIndex(column->column);
+}
+
+} // namespace
+
+QString IndexExpression::toSql(const ast::Expression* expr) {
+    if (!expr) {
+        return QString();
+    }
+
+    if (auto* literal = dynamic_cast<const ast::LiteralExpression*>(expr)) {
+        return literalToSql(literal->value);
+    }
+
+    if (auto* column = dynamic_cast<const ast::ColumnExpression*>(expr)) {
+        return column->column.toLower();
+    }
+
+    if (auto* binary = dynamic_cast<const ast::BinaryExpression*>(expr)) {
+        return QString("(%1 %2 %3)")
+            .arg(toSql(binary->left.get()), binaryOpToSql(binary->op), toSql(binary->right.get()));
+    }
+
+    if (auto* unary = dynamic_cast<const ast::UnaryExpression*>(expr)) {
+        const QString operand = toSql(unary->expr.get());
+        switch (unary->op) {
+            case ast::UnaryOp::NOT: return QString("(NOT %1)").arg(operand);
+            case ast::UnaryOp::MINUS: return QString("(-%1)").arg(operand);
+            case ast::UnaryOp::PLUS: return operand;
+            case ast::UnaryOp::IS_NULL: return QString("(%1 IS NULL)").arg(operand);
+            case ast::UnaryOp::IS_NOT_NULL: return QString("(%1 IS NOT NULL)").arg(operand);
+        }
+    }
+
+    if (auto* function = dynamic_cast<const ast::FunctionCallExpression*>(expr)) {
+        QStringList args;
+        for (const auto& argument : function->arguments) {
+            args.append(toSql(argument.get()));
+        }
+        return QString("%1(%2)").arg(canonicalFunctionName(function->name), args.join(", "));
+    }
+
+    if (auto* list = dynamic_cast<const ast::ListExpression*>(expr)) {
+        QStringList items;
+        for (const auto& element : list->elements) {
+            items.append(toSql(element.get()));
+        }
+        return QString("(%1)").arg(items.join(", "));
+    }
+
+    return expr->toString();
+}
+
+std::unique_ptr<ast::Expression> IndexExpression::parse(const QString& sql) {
+    Parser parser(sql);
+    return parser.parseStandaloneExpression();
+}
+
+std::shared_ptr<const ast::Expression> IndexExpression::parseCached(const QString& sql) {
+    static QMutex mutex;
+    static QHash<QString, std::shared_ptr<const ast::Expression>> cache;
+
+    QMutexLocker locker(&mutex);
+    auto it = cache.constFind(sql);
+    if (it != cache.constEnd()) {
+        return it.value();
+    }
+
+    std::shared_ptr<const ast::Expression> expr(parse(sql).release());
+    if (expr) {
+        cache.insert(sql, expr);
+    }
+    return expr;
+}
+
+bool IndexExpression::isIndexable(const ast::Expression* expr, const TableDef& table, QString* error) {
+    auto fail = [&](const QString& message) {
+        if (error) {
+            *error = message;
+        }
+        return false;
+    };
+
+    if (!expr) {
+        return fail("Empty expression");
+    }
+
+    if (dynamic_cast<const ast::LiteralExpression*>(expr)) {
+        return true;
+    }
+
+    if (auto* column = dynamic_cast<const ast::ColumnExpression*>(expr)) {
+        if (column->column == "*" || table.getColumnIndex(column->column) < 0) {
+            return fail(QString("Column '%1' does not exist in table '%2'").arg(column->column, table.name));
+        }
+        if (!column->table.isEmpty() && column->table.toLower() != table.name.toLower()) {
+            return fail(QString("Column '%1.%2' does not belong to table '%3'")
+                            .arg(column->table, column->column, table.name));
+        }
+        return true;
+    }
+
+    if (auto* binary = dynamic_cast<const ast::BinaryExpression*>(expr)) {
+        if (binary->op == ast::BinaryOp::IN) {
+            auto* list = dynamic_cast<const ast::ListExpression*>(binary->right.get());
+            if (!list) {
+                return fail("IN in an index expression must use a literal list");
+            }
+            for (const auto& element : list->elements) {
+                if (!isIndexable(element.get(), table, error)) {
+                    return false;
+                }
+            }
+            return isIndexable(binary->left.get(), table, error);
+        }
+        return isIndexable(binary->left.get(), table, error) &&
+               isIndexable(binary->right.get(), table, error);
+    }
+
+    if (auto* unary = dynamic_cast<const ast::UnaryExpression*>(expr)) {
+        return isIndexable(unary->expr.get(), table, error);
+    }
+
+    if (auto* function = dynamic_cast<const ast::FunctionCallExpression*>(expr)) {
+        if (!ExpressionEvaluator::isScalarFunction(function->name)) {
+            return fail(QString("Function '%1' cannot be used in an index").arg(function->name));
+        }
+        for (const auto& argument : function->arguments) {
+            if (!isIndexable(argument.get(), table, error)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    return fail(QString("Expression '%1' cannot be used in an index").arg(expr->toString()));
+}
+
+DataType IndexExpression::inferType(const ast::Expression* expr, const TableDef& table) {
+    if (auto* literal = dynamic_cast<const ast::LiteralExpression*>(expr)) {
+        const QVariant& value = literal->value;
+        if (value.isNull()) return DataType::NULL_TYPE;
+        if (value.userType() == QMetaType::Bool) return DataType::BOOLEAN;
+        if (value.userType() == QMetaType::Double || value.userType() == QMetaType::Float) return DataType::DOUBLE;
+        if (isNumericVariant(value)) return DataType::BIGINT;
+        return DataType::VARCHAR;
+    }
+
+    if (auto* column = dynamic_cast<const ast::ColumnExpression*>(expr)) {
+        const ColumnDef* def = table.findColumn(column->column);
+        return def ? def->type : DataType::NULL_TYPE;
+    }
+
+    if (auto* binary = dynamic_cast<const ast::BinaryExpression*>(expr)) {
+        switch (binary->op) {
+            case ast::BinaryOp::ADD:
+            case ast::BinaryOp::SUB:
+            case ast::BinaryOp::MUL:
+            case ast::BinaryOp::DIV:
+            case ast::BinaryOp::MOD: {
+                const DataType left = inferType(binary->left.get(), table);
+                const DataType right = inferType(binary->right.get(), table);
+                if (isFloatType(left) || isFloatType(right) ||
+                    left == DataType::DECIMAL || left == DataType::NUMERIC ||
+                    right == DataType::DECIMAL || right == DataType::NUMERIC ||
+                    binary->op == ast::BinaryOp::DIV) {
+                    return DataType::DOUBLE;
+                }
+                return DataType::BIGINT;
+            }
+            default:
+                return DataType::BOOLEAN;
+        }
+    }
+
+    if (auto* unary = dynamic_cast<const ast::UnaryExpression*>(expr)) {
+        if (unary->op == ast::UnaryOp::MINUS || unary->op == ast::UnaryOp::PLUS) {
+            const DataType operand = inferType(unary->expr.get(), table);
+            return isFloatType(operand) ? DataType::DOUBLE : DataType::BIGINT;
+        }
+        return DataType::BOOLEAN;
+    }
+
+    if (auto* function = dynamic_cast<const ast::FunctionCallExpression*>(expr)) {
+        const QString name = canonicalFunctionName(function->name);
+        if (name == "length") {
+            return DataType::BIGINT;
+        }
+        if (name == "abs" || name == "coalesce") {
+            return function->arguments.empty() ? DataType::NULL_TYPE
+                                               : inferType(function->arguments.front().get(), table);
+        }
+        if (name == "round") {
+            return function->arguments.size() > 1 ? DataType::DOUBLE : DataType::BIGINT;
+        }
+        if (name == "st_x" || name == "st_y" || name == "st_distance") {
+            return DataType::DOUBLE;
+        }
+        if (name == "st_intersects" || name == "st_dwithin" || name == "mbrintersects") {
+            return DataType::BOOLEAN;
+        }
+        if (name.startsWith("st_") && name != "st_astext") {
+            return DataType::GEOMETRY;
+        }
+        return DataType::VARCHAR;
+    }
+
+    return DataType::NULL_TYPE;
+}
+
+bool IndexExpression::collectReferencedColumns(const ast::Expression* expr, const TableDef* table, QSet<int>& columns) {
+    if (!expr) {
+        return true;
+    }
+    if (dynamic_cast<const ast::LiteralExpression*>(expr)) {
+        return true;
+    }
+    if (const auto* colExpr = dynamic_cast<const ast::ColumnExpression*>(expr)) {
+        int index = table->getColumnIndex(colExpr->column);
+        if (index < 0) {
+            return false;
+        }
+        columns.insert(index);
+        return true;
+    }
+    if (const auto* binExpr = dynamic_cast<const ast::BinaryExpression*>(expr)) {
+        return collectReferencedColumns(binExpr->left.get(), table, columns) &&
+               collectReferencedColumns(binExpr->right.get(), table, columns);
+    }
+    if (const auto* unaryExpr = dynamic_cast<const ast::UnaryExpression*>(expr)) {
+        return collectReferencedColumns(unaryExpr->expr.get(), table, columns);
+    }
+    if (const auto* funcExpr = dynamic_cast<const ast::FunctionCallExpression*>(expr)) {
+        for (const auto& arg : funcExpr->arguments) {
+            if (!collectReferencedColumns(arg.get(), table, columns)) {
+                return false;
+            }
+        }
+        return true;
+    }
+    if (const auto* listExpr = dynamic_cast<const ast::ListExpression*>(expr)) {
+        for (const auto& element : listExpr->elements) {
+            if (!collectReferencedColumns(element.get(), table, columns)) {
+                return false;
+            }
+        }
+        return true;
+    }
+    if (const auto* caseExpr = dynamic_cast<const ast::CaseExpression*>(expr)) {
+        for (const auto& when : caseExpr->whenClauses) {
+            if (!collectReferencedColumns(when.condition.get(), table, columns) ||
+                !collectReferencedColumns(when.result.get(), table, columns)) {
+                return false;
+            }
+        }
+        return collectReferencedColumns(caseExpr->elseExpression.get(), table, columns);
+    }
+    return false;
+}
+
+bool IndexExpression::matchEquiJoinColumns(const ast::Expression* condition,
+                                           const ast::TableReference* leftRef, const TableDef* leftTable,
+                                           const ast::TableReference* rightRef, const TableDef* rightTable,
+                                           int& leftColumnIndex, int& rightColumnIndex) {
+    const auto* binExpr = dynamic_cast<const ast::BinaryExpression*>(condition);
+    if (!binExpr || binExpr->op != ast::BinaryOp::EQ || !leftRef || !rightRef || !leftTable || !rightTable) {
+        return false;
+    }
+
+    const auto* first = dynamic_cast<const ast::ColumnExpression*>(binExpr->left.get());
+    const auto* second = dynamic_cast<const ast::ColumnExpression*>(binExpr->right.get());
+    if (!first || !second) {
+        return false;
+    }
+
+    // 两种写法都接受：left.a = right.b 和 right.b = left.a
+    for (int attempt = 0; attempt < 2; ++attempt) {
+        const auto* leftCol = attempt == 0 ? first : second;
+        const auto* rightCol = attempt == 0 ? second : first;
+
+        const int leftIndex = resolveJoinColumn(leftCol, leftRef, leftTable);
+        const int rightIndex = resolveJoinColumn(rightCol, rightRef, rightTable);
+        if (leftIndex >= 0 && rightIndex >= 0) {
+            leftColumnIndex = leftIndex;
+            rightColumnIndex = rightIndex;
+            return true;
+        }
+    }
+    return false;
+}
+
+void IndexExpression::splitConjuncts(const ast::Expression* expr, QVector<const ast::Expression*>& conjuncts) {
+    if (!expr) {
+        return;
+    }
+    auto* binary = dynamic_cast<const ast::BinaryExpression*>(expr);
+    if (binary && binary->op == ast::BinaryOp::AND) {
+        splitConjuncts(binary->left.get(), conjuncts);
+        splitConjuncts(binary->right.get(), conjuncts);
+        return;
+    }
+    conjuncts.append(expr);
+}
+
+bool IndexExpression::implies(const ast::Expression* where, const ast::Expression* predicate) {
+    if (!predicate) {
+        return true;
+    }
+    if (!where) {
+        return false;
+    }
+
+    QVector<const ast::Expression*> whereConjuncts;
+    QVector<const ast::Expression*> predicateConjuncts;
+    splitConjuncts(where, whereConjuncts);
+    splitConjuncts(predicate, predicateConjuncts);
+
+    QVector<QString> whereSql;
+    whereSql.reserve(whereConjuncts.size());
+    for (const auto* conjunct : whereConjuncts) {
+        whereSql.append(toSql(conjunct));
+    }
+
+    for (const auto* p : predicateConjuncts) {
+        const QString pSql = toSql(p);
+        bool matched = false;
+        for (int i = 0; i < whereConjuncts.size() && !matched; ++i) {
+            matched = conjunctImplies(whereConjuncts[i], whereSql[i], p, pSql);
+        }
+        if (!matched) {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace qindb
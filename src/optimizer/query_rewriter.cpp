@@ -712,6 +712,15 @@ std::unique_ptr<ast::Expression> QueryRewriter::cloneExpression(const ast::Expre
         );
     }
 
+    // IN 值列表
+    if (auto* listExpr = dynamic_cast<const ast::ListExpression*>(expr)) {
+        std::vector<std::unique_ptr<ast::Expression>> clonedItems;
+        for (const auto& item : listExpr->elements) {
+            clonedItems.push_back(cloneExpression(item.get()));
+        }
+        return std::make_unique<ast::ListExpression>(std::move(clonedItems));
+    }
+
     // 子查询
     if (auto* subqueryExpr = dynamic_cast<const ast::SubqueryExpression*>(expr)) {
         return std::make_unique<ast::SubqueryExpression>(
@@ -3,42 +3,148 @@
 #include "qindb/buffer_pool_manager.h"
 #include "qindb/table_page.h"
 #include "qindb/logger.h"
-#include "qindb/key_comparator.h"
+#include "qindb/hyperloglog.h"
+#include "qindb/hash_util.h"
+#include "qindb/cardinality_feedback.h"
 #include <QFile>
 #include <QJsonDocument>
 #include <QJsonObject>
 #include <QJsonArray>
-#include <QSet>
+#include <QRandomGenerator>
 #include <algorithm>
 #include <cmath>
+#include <thread>
+#include <vector>
 
 namespace qindb {
 
+namespace {
+
+/**
+ * @brief 按列类型比较两个统计值：数值按数值比较，其余按字符串比较
+ */
+int compareStatValues(const QVariant& a, const QVariant& b, DataType type) {
+    if (isNumericType(type)) {
+        const double x = a.toDouble();
+        const double y = b.toDouble();
+        return (x < y) ? -1 : ((x > y) ? 1 : 0);
+    }
+    return QString::compare(a.toString(), b.toString());
+}
+
+/**
+ * @brief 列的值能否排序（记录最小/最大值、构建直方图）
+ */
+bool isOrderedStatType(DataType type) {
+    return isNumericType(type) || isStringType(type);
+}
+
+/**
+ * @brief 统计值的规范形式：数值统一为 double、字符串为 QString，和 JSON 往返后的类型一致
+ */
+QVariant normalizeStatValue(const QVariant& value, DataType type) {
+    if (value.isNull()) {
+        return QVariant();
+    }
+    if (isNumericType(type)) {
+        return value.toDouble();
+    }
+    return value.toString();
+}
+
+} // anonymous namespace
+
+// ========== ColumnStats 实现 ==========
+
+size_t ColumnStats::mcvRows() const {
+    size_t total = 0;
+    for (auto it = mcv.constBegin(); it != mcv.constEnd(); ++it) {
+        total += it.value();
+    }
+    return total;
+}
+
+double ColumnStats::histogramFraction(const QVariant& value) const {
+    const qsizetype numBounds = histogramBounds.size();
+    if (numBounds < 2) {
+        return 0.5;
+    }
+    if (compareStatValues(value, histogramBounds.first(), dataType) <= 0) {
+        return 0.0;
+    }
+    if (compareStatValues(value, histogramBounds.last(), dataType) >= 0) {
+        return 1.0;
+    }
+
+    // 找到 bounds[bucket] <= value < bounds[bucket + 1]
+    auto it = std::upper_bound(histogramBounds.constBegin(), histogramBounds.constEnd(), value,
+                               [this](const QVariant& v, const QVariant& bound) {
+                                   return compareStatValues(v, bound, dataType) < 0;
+                               });
+    const qsizetype bucket = (it - histogramBounds.constBegin()) - 1;
+
+    // 桶内位置：数值按线性插值，字符串取桶的一半
+    double within = 0.5;
+    if (isNumericType(dataType)) {
+        const double low = histogramBounds[bucket].toDouble();
+        const double high = histogramBounds[bucket + 1].toDouble();
+        if (high > low) {
+            within = (value.toDouble() - low) / (high - low);
+        }
+    }
+    return (static_cast<double>(bucket) + within) / static_cast<double>(numBounds - 1);
+}
+
 // ========== TableStats 实现 ==========
 
+const ColumnGroupStats* TableStats::getColumnGroupStats(const QString& a, const QString& b,
+                                                        bool* reversed) const {
+    for (const ColumnGroupStats& group : columnGroups) {
+        const bool forward = group.firstColumn.compare(a, Qt::CaseInsensitive) == 0 &&
+                             group.secondColumn.compare(b, Qt::CaseInsensitive) == 0;
+        const bool backward = group.firstColumn.compare(b, Qt::CaseInsensitive) == 0 &&
+                              group.secondColumn.compare(a, Qt::CaseInsensitive) == 0;
+        if (forward || backward) {
+            if (reversed) {
+                *reversed = !forward;
+            }
+            return &group;
+        }
+    }
+    return nullptr;
+}
+
 double TableStats::estimateSelectivity(const QString& columnName, const QVariant& value) const {
     const ColumnStats* colStats = getColumnStats(columnName);
     if (!colStats) {
         return 0.1;  // 默认选择率
     }
+    if (numRows == 0) {
+        return 0.0;
+    }
 
     // 如果值为 NULL
     if (value.isNull()) {
-        if (numRows == 0) return 0.0;
         return static_cast<double>(colStats->numNulls) / numRows;
     }
 
     // 如果在 MCV (Most Common Values) 中
-    QString valueStr = value.toString();
-    auto it = colStats->mcv.find(valueStr);
+    auto it = colStats->mcv.find(value.toString());
     if (it != colStats->mcv.end()) {
-        if (numRows == 0) return 0.0;
-        return static_cast<double>(it.value()) / numRows;
+        return std::min(1.0, static_cast<double>(it.value()) / numRows);
     }
 
-    // 使用基数估算
+    // 不在 MCV 中：除去 NULL 和 MCV 的行平均分给其余的不同值
     if (colStats->numDistinctValues > 0) {
-        return 1.0 / colStats->numDistinctValues;
+        const size_t restDistinct = colStats->numDistinctValues > static_cast<size_t>(colStats->mcv.size())
+                                        ? colStats->numDistinctValues - colStats->mcv.size()
+                                        : 0;
+        if (restDistinct == 0) {
+            return 1.0 / numRows;  // MCV 已覆盖所有不同值，按最多一行计
+        }
+        const double restFraction = 1.0
+            - static_cast<double>(colStats->numNulls + colStats->mcvRows()) / numRows;
+        return std::max(restFraction, 0.0) / restDistinct;
     }
 
     return 0.1;  // 默认选择率
@@ -51,52 +157,467 @@ double TableStats::estimateRangeSelectivity(const QString& columnName,
     if (!colStats) {
         return 0.3;  // 默认范围选择率
     }
+    if (numRows == 0) {
+        return 0.0;
+    }
+
+    const DataType type = colStats->dataType;
+    const bool hasLower = minVal.isValid() && !minVal.isNull();
+    const bool hasUpper = maxVal.isValid() && !maxVal.isNull();
+    auto inRange = [&](const QVariant& value) {
+        return (!hasLower || compareStatValues(value, minVal, type) >= 0) &&
+               (!hasUpper || compareStatValues(value, maxVal, type) <= 0);
+    };
+
+    // MCV 中落在范围内的值按出现次数精确累加
+    double mcvSelectivity = 0.0;
+    for (auto it = colStats->mcv.constBegin(); it != colStats->mcv.constEnd(); ++it) {
+        const QVariant value = isNumericType(type) ? QVariant(it.key().toDouble()) : QVariant(it.key());
+        if (inRange(value)) {
+            mcvSelectivity += static_cast<double>(it.value()) / numRows;
+        }
+    }
+
+    // 其余非 NULL 行中落在范围内的比例
+    const double restFraction = std::max(
+        0.0, 1.0 - static_cast<double>(colStats->numNulls + colStats->mcvRows()) / numRows);
+    double restSelectivity;
+    if (colStats->histogramBounds.size() >= 2) {
+        // 等深直方图：每个桶的行数大致相同
+        const double lowFraction = hasLower ? colStats->histogramFraction(minVal) : 0.0;
+        const double highFraction = hasUpper ? colStats->histogramFraction(maxVal) : 1.0;
+        restSelectivity = std::max(0.0, highFraction - lowFraction);
+    } else if (!hasLower && !hasUpper) {
+        restSelectivity = 1.0;
+    } else if (isNumericType(type) && !colStats->minValue.isNull() && !colStats->maxValue.isNull()) {
+        // 没有直方图：按最小/最大值之间均匀分布估算
+        const double colMin = colStats->minValue.toDouble();
+        const double colMax = colStats->maxValue.toDouble();
+        const double rangeStart = hasLower ? std::max(minVal.toDouble(), colMin) : colMin;
+        const double rangeEnd = hasUpper ? std::min(maxVal.toDouble(), colMax) : colMax;
+        if (rangeEnd < rangeStart) {
+            restSelectivity = 0.0;  // 没有重叠
+        } else if (colMax == colMin) {
+            restSelectivity = 1.0;  // 所有值相同
+        } else {
+            restSelectivity = (rangeEnd - rangeStart) / (colMax - colMin);
+        }
+    } else {
+        restSelectivity = 0.3;  // 对于其他类型，返回估算值
+    }
+
+    return std::clamp(mcvSelectivity + restSelectivity * restFraction, 0.0, 1.0);
+}
+
+double TableStats::estimatePrefixSelectivity(const QString& columnName, const QString& prefix) const {
+    const ColumnStats* colStats = getColumnStats(columnName);
+    if (!colStats || numRows == 0) {
+        return 0.1;  // 默认选择率
+    }
+
+    // 有直方图时按字符串区间 [prefix, prefix + U+FFFF] 估算（MCV 部分在其中精确累加）
+    if (isStringType(colStats->dataType) && colStats->histogramBounds.size() >= 2) {
+        return estimateRangeSelectivity(columnName, prefix, QString(prefix + QChar(0xFFFF)));
+    }
 
-    // 如果列的值范围未知
-    if (colStats->minValue.isNull() || colStats->maxValue.isNull()) {
-        return 0.3;
+    // 没有直方图：MCV 中以前缀开头的值按出现次数计，其余的值每多一个前缀字符比例缩小为 1/5
+    size_t mcvMatches = 0;
+    for (auto it = colStats->mcv.constBegin(); it != colStats->mcv.constEnd(); ++it) {
+        if (it.key().startsWith(prefix)) {
+            mcvMatches += it.value();
+        }
     }
+    const double rest = std::pow(0.2, prefix.size());
+    return std::clamp(static_cast<double>(mcvMatches) / numRows + rest, 0.0, 1.0);
+}
 
-    // 计算范围重叠比例
-    KeyComparator comparator;
+void TableStats::applyModifications(size_t rowsInserted, size_t rowsDeleted, size_t rowsUpdated) {
+    numRows += rowsInserted;
+    numRows = numRows >= rowsDeleted ? numRows - rowsDeleted : 0;
+    modifiedRows += rowsInserted + rowsDeleted + rowsUpdated;
 
-    // 检查是否有重叠
-    if (comparator.compare(maxVal, colStats->minValue, colStats->dataType) < 0 ||
-        comparator.compare(minVal, colStats->maxValue, colStats->dataType) > 0) {
-        return 0.0;  // 没有重叠
+    // 行数增长后按平均行大小估计页数（删除不会释放页，页数只增不减）
+    if (avgRowSize > 0) {
+        const size_t neededPages = (numRows * avgRowSize + PAGE_SIZE - 1) / PAGE_SIZE;
+        numPages = std::max(numPages, neededPages);
     }
+}
+
+bool TableStats::needsReanalyze() const {
+    const double threshold = StatisticsCollector::AUTO_ANALYZE_BASE +
+                             StatisticsCollector::AUTO_ANALYZE_SCALE * static_cast<double>(numRows);
+    return static_cast<double>(modifiedRows) > threshold;
+}
+
+QJsonObject TableStats::toJson() const {
+    QJsonObject tableObj;
+
+    tableObj["tableName"] = tableName;
+    tableObj["numRows"] = static_cast<qint64>(numRows);
+    tableObj["numPages"] = static_cast<qint64>(numPages);
+    tableObj["avgRowSize"] = static_cast<qint64>(avgRowSize);
+    tableObj["modifiedRows"] = static_cast<qint64>(modifiedRows);
+
+    // 保存列统计
+    QJsonArray columnsArray;
+    for (auto colIt = columnStats.begin(); colIt != columnStats.end(); ++colIt) {
+        const ColumnStats& colStats = colIt.value();
+        QJsonObject colObj;
+
+        colObj["columnName"] = colStats.columnName;
+        colObj["dataType"] = static_cast<int>(colStats.dataType);
+        colObj["numDistinctValues"] = static_cast<qint64>(colStats.numDistinctValues);
+        colObj["numNulls"] = static_cast<qint64>(colStats.numNulls);
+
+        // 保存 min/max（数值类型和字符串类型）
+        auto boundToJson = [&colStats](const QVariant& value) -> QJsonValue {
+            if (value.isNull()) return QJsonValue();
+            if (isNumericType(colStats.dataType)) return value.toDouble();
+            if (isStringType(colStats.dataType)) return value.toString();
+            return QJsonValue();
+        };
+        QJsonValue minJson = boundToJson(colStats.minValue);
+        QJsonValue maxJson = boundToJson(colStats.maxValue);
+        if (!minJson.isNull()) colObj["minValue"] = minJson;
+        if (!maxJson.isNull()) colObj["maxValue"] = maxJson;
+
+        // 最常见值及出现次数
+        if (!colStats.mcv.isEmpty()) {
+            QJsonObject mcvObj;
+            for (auto it = colStats.mcv.constBegin(); it != colStats.mcv.constEnd(); ++it) {
+                mcvObj[it.key()] = static_cast<qint64>(it.value());
+            }
+            colObj["mcv"] = mcvObj;
+        }
+
+        // 直方图边界
+        if (!colStats.histogramBounds.isEmpty()) {
+            QJsonArray boundsArray;
+            for (const QVariant& bound : colStats.histogramBounds) {
+                boundsArray.append(boundToJson(bound));
+            }
+            colObj["histogram"] = boundsArray;
+        }
 
-    // 计算重叠区间
-    QVariant actualMin = minVal;
-    QVariant actualMax = maxVal;
+        colObj["correlation"] = colStats.correlation;
+        if (!colStats.distinctSketch.isEmpty()) {
+            colObj["sketch"] = QString::fromLatin1(colStats.distinctSketch.toBase64());
+        }
+
+        columnsArray.append(colObj);
+    }
+    tableObj["columns"] = columnsArray;
 
-    if (comparator.compare(minVal, colStats->minValue, colStats->dataType) < 0) {
-        actualMin = colStats->minValue;
+    // 保存列组统计
+    QJsonArray groupsArray;
+    for (const ColumnGroupStats& group : columnGroups) {
+        QJsonObject groupObj;
+        groupObj["first"] = group.firstColumn;
+        groupObj["second"] = group.secondColumn;
+        groupObj["numDistinctValues"] = static_cast<qint64>(group.numDistinctValues);
+        groupObj["dependency"] = group.dependency;
+        groupObj["reverseDependency"] = group.reverseDependency;
+        groupsArray.append(groupObj);
     }
-    if (comparator.compare(maxVal, colStats->maxValue, colStats->dataType) > 0) {
-        actualMax = colStats->maxValue;
+    if (!groupsArray.isEmpty()) {
+        tableObj["columnGroups"] = groupsArray;
     }
 
-    // 对于数值类型，计算精确比例
-    if (isNumericType(colStats->dataType)) {
-        double rangeStart = actualMin.toDouble();
-        double rangeEnd = actualMax.toDouble();
-        double colMin = colStats->minValue.toDouble();
-        double colMax = colStats->maxValue.toDouble();
+    return tableObj;
+}
+
+TableStats TableStats::fromJson(const QJsonObject& tableObj) {
+    TableStats stats(tableObj["tableName"].toString());
+    stats.numRows = static_cast<size_t>(tableObj["numRows"].toInteger());
+    stats.numPages = static_cast<size_t>(tableObj["numPages"].toInteger());
+    stats.avgRowSize = static_cast<size_t>(tableObj["avgRowSize"].toInteger());
+    stats.modifiedRows = static_cast<size_t>(tableObj["modifiedRows"].toInteger());
+
+    // 加载列统计
+    QJsonArray columnsArray = tableObj["columns"].toArray();
+    for (const QJsonValue& colVal : columnsArray) {
+        QJsonObject colObj = colVal.toObject();
+
+        ColumnStats colStats;
+        colStats.columnName = colObj["columnName"].toString();
+        colStats.dataType = static_cast<DataType>(colObj["dataType"].toInt());
+        colStats.numDistinctValues = static_cast<size_t>(colObj["numDistinctValues"].toInteger());
+        colStats.numNulls = static_cast<size_t>(colObj["numNulls"].toInteger());
+
+        if (colObj.contains("minValue")) {
+            colStats.minValue = colObj["minValue"].toVariant();
+        }
+        if (colObj.contains("maxValue")) {
+            colStats.maxValue = colObj["maxValue"].toVariant();
+        }
 
-        if (colMax == colMin) {
-            return 1.0;  // 所有值相同
+        const QJsonObject mcvObj = colObj["mcv"].toObject();
+        for (auto it = mcvObj.constBegin(); it != mcvObj.constEnd(); ++it) {
+            colStats.mcv[it.key()] = static_cast<size_t>(it.value().toInteger());
         }
 
-        return (rangeEnd - rangeStart) / (colMax - colMin);
+        const QJsonArray boundsArray = colObj["histogram"].toArray();
+        for (const QJsonValue& bound : boundsArray) {
+            colStats.histogramBounds.append(bound.toVariant());
+        }
+
+        colStats.correlation = colObj["correlation"].toDouble();
+        colStats.distinctSketch = QByteArray::fromBase64(colObj["sketch"].toString().toLatin1());
+
+        stats.columnStats[colStats.columnName] = colStats;
+    }
+
+    // 加载列组统计
+    const QJsonArray groupsArray = tableObj["columnGroups"].toArray();
+    for (const QJsonValue& groupVal : groupsArray) {
+        const QJsonObject groupObj = groupVal.toObject();
+        ColumnGroupStats group(groupObj["first"].toString(), groupObj["second"].toString());
+        group.numDistinctValues = static_cast<size_t>(groupObj["numDistinctValues"].toInteger());
+        group.dependency = groupObj["dependency"].toDouble();
+        group.reverseDependency = groupObj["reverseDependency"].toDouble();
+        stats.columnGroups.append(group);
     }
 
-    // 对于其他类型，返回估算值
-    return 0.3;
+    return stats;
 }
 
 // ========== StatisticsCollector 实现 ==========
 
+namespace {
+
+constexpr int ACCUMULATE_BATCH_ROWS = 8192;   // 每攒够这么多行按列累加一次
+constexpr qsizetype MIN_PARALLEL_VALUES = 4096;  // 每列至少这么多值才分线程，避免线程开销大于收益
+
+/**
+ * @brief ANALYZE 时一列的全表累加器
+ */
+struct ColumnAccumulator {
+    HyperLogLog sketch;      // 不同值草图
+    size_t numNulls = 0;     // NULL 值的数量
+    QVariant minValue;       // 最小值
+    QVariant maxValue;       // 最大值
+};
+
+/**
+ * @brief 对每一列调用 fn(列号)；值足够多时分给多个线程，每个线程处理互不相交的列
+ */
+template <typename Fn>
+void forEachColumn(int numColumns, qsizetype valuesPerColumn, Fn fn) {
+    int numThreads = std::min(static_cast<int>(std::thread::hardware_concurrency()), numColumns);
+    if (numThreads <= 1 || valuesPerColumn < MIN_PARALLEL_VALUES) {
+        for (int column = 0; column < numColumns; ++column) {
+            fn(column);
+        }
+        return;
+    }
+
+    std::vector<std::thread> workers;
+    for (int t = 0; t < numThreads; ++t) {
+        workers.emplace_back([t, numThreads, numColumns, &fn]() {
+            for (int column = t; column < numColumns; column += numThreads) {
+                fn(column);
+            }
+        });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+/**
+ * @brief 值是否为 NULL（行中没有这一列也按 NULL 处理）
+ */
+bool isNullAt(const QVector<QVariant>& row, int column) {
+    return column >= row.size() || row[column].isNull();
+}
+
+/**
+ * @brief 把一批行中某一列的值累加进该列的累加器
+ * @param hashes 非空时输出每行的值哈希（供列组草图使用，NULL 行不写）
+ */
+void accumulateColumn(DataType type, const QVector<QVector<QVariant>>& rows, int column,
+                      ColumnAccumulator& acc, uint64_t* hashes) {
+    const bool ordered = isOrderedStatType(type);
+    for (qsizetype r = 0; r < rows.size(); ++r) {
+        const QVector<QVariant>& row = rows[r];
+        if (isNullAt(row, column)) {
+            ++acc.numNulls;
+            continue;
+        }
+
+        const QVariant& value = row[column];
+        const uint64_t hash = HyperLogLog::hashValue(value, type);
+        acc.sketch.add(hash);
+        if (hashes) {
+            hashes[r] = hash;
+        }
+        if (ordered) {
+            if (acc.minValue.isNull() || compareStatValues(value, acc.minValue, type) < 0) {
+                acc.minValue = value;
+            }
+            if (acc.maxValue.isNull() || compareStatValues(value, acc.maxValue, type) > 0) {
+                acc.maxValue = value;
+            }
+        }
+    }
+}
+
+/**
+ * @brief 样本中一列的物理顺序相关系数（Spearman 秩相关）
+ *
+ * 行的物理秩按扫描序号排，值的秩按值排序（值相同按物理顺序），两组秩的相关系数即为结果
+ */
+double physicalCorrelation(DataType type, const QVector<QVector<QVariant>>& sample,
+                           const QVector<size_t>& ordinals, int column) {
+    QVector<QPair<QVariant, size_t>> items;
+    for (qsizetype i = 0; i < sample.size(); ++i) {
+        if (!isNullAt(sample[i], column)) {
+            items.append(qMakePair(sample[i][column], ordinals[i]));
+        }
+    }
+    const double n = static_cast<double>(items.size());
+    if (items.size() < 2) {
+        return 0.0;
+    }
+
+    // 扫描序号换成物理秩
+    std::sort(items.begin(), items.end(), [](const QPair<QVariant, size_t>& a, const QPair<QVariant, size_t>& b) {
+        return a.second < b.second;
+    });
+    for (qsizetype i = 0; i < items.size(); ++i) {
+        items[i].second = static_cast<size_t>(i);
+    }
+
+    std::stable_sort(items.begin(), items.end(), [type](const QPair<QVariant, size_t>& a,
+                                                        const QPair<QVariant, size_t>& b) {
+        return compareStatValues(a.first, b.first, type) < 0;
+    });
+    double sumSquaredDiff = 0.0;
+    for (qsizetype i = 0; i < items.size(); ++i) {
+        const double diff = static_cast<double>(i) - static_cast<double>(items[i].second);
+        sumSquaredDiff += diff * diff;
+    }
+    return std::clamp(1.0 - 6.0 * sumSquaredDiff / (n * (n * n - 1.0)), -1.0, 1.0);
+}
+
+/**
+ * @brief 样本中 from → to 的函数依赖程度
+ *
+ * 按 from 的值分组，每组取 to 最常见的值，这些行占两列都非 NULL 的行的比例。
+ * 为 1.0 时 from 的值完全决定 to 的值
+ */
+double functionalDependency(const QVector<QVector<QVariant>>& sample, int from, int to) {
+    QHash<QString, QHash<QString, int>> groups;
+    int total = 0;
+    for (const QVector<QVariant>& row : sample) {
+        if (isNullAt(row, from) || isNullAt(row, to)) {
+            continue;
+        }
+        ++groups[row[from].toString()][row[to].toString()];
+        ++total;
+    }
+    if (total == 0) {
+        return 0.0;
+    }
+
+    int consistent = 0;
+    for (auto groupIt = groups.constBegin(); groupIt != groups.constEnd(); ++groupIt) {
+        int best = 0;
+        for (auto it = groupIt.value().constBegin(); it != groupIt.value().constEnd(); ++it) {
+            best = std::max(best, it.value());
+        }
+        consistent += best;
+    }
+    return static_cast<double>(consistent) / total;
+}
+
+/**
+ * @brief 由全表累加器和样本生成一列的统计信息
+ *
+ * NDV 取 HyperLogLog 估计值（不少于样本中的不同值个数、不多于非 NULL 行数）。
+ * 样本中的不同值不超过 MCV_TARGET 个时全部作为 MCV；否则只保留出现至少两次且明显
+ * 比平均值常见的值。MCV 的次数按全表行数 / 样本行数放大。其余样本值排序后按等深取直方图边界。
+ */
+void buildColumnStats(const ColumnAccumulator& acc, const QVector<QVector<QVariant>>& sample,
+                      const QVector<size_t>& ordinals, int column, size_t numRows, ColumnStats& stats) {
+    const DataType type = stats.dataType;
+    stats.numNulls = acc.numNulls;
+    stats.minValue = normalizeStatValue(acc.minValue, type);
+    stats.maxValue = normalizeStatValue(acc.maxValue, type);
+    stats.distinctSketch = acc.sketch.reduced(StatisticsCollector::SKETCH_PRECISION).registers();
+
+    // 样本中的非 NULL 值及各值出现次数
+    QVector<QVariant> values;
+    QHash<QString, int> counts;
+    for (const QVector<QVariant>& row : sample) {
+        if (isNullAt(row, column)) {
+            continue;
+        }
+        values.append(row[column]);
+        ++counts[row[column].toString()];
+    }
+
+    const size_t nonNullRows = (numRows > acc.numNulls) ? numRows - acc.numNulls : 0;
+    const size_t sampleDistinct = static_cast<size_t>(counts.size());
+    const size_t ndv = static_cast<size_t>(std::llround(acc.sketch.estimate()));
+    stats.numDistinctValues = std::min(std::max(ndv, sampleDistinct), nonNullRows);
+
+    if (values.isEmpty()) {
+        return;
+    }
+
+    if (isOrderedStatType(type)) {
+        stats.correlation = physicalCorrelation(type, sample, ordinals, column);
+    }
+
+    // 最常见值：按样本中的次数从高到低（次数相同时按值排序，结果与哈希顺序无关）
+    QVector<QPair<QString, int>> ranked;
+    ranked.reserve(counts.size());
+    for (auto it = counts.constBegin(); it != counts.constEnd(); ++it) {
+        ranked.append(qMakePair(it.key(), it.value()));
+    }
+    std::sort(ranked.begin(), ranked.end(), [](const QPair<QString, int>& a, const QPair<QString, int>& b) {
+        return (a.second != b.second) ? (a.second > b.second) : (a.first < b.first);
+    });
+
+    const double scale = static_cast<double>(numRows) / sample.size();
+    const double avgCount = static_cast<double>(values.size()) / counts.size();
+    const bool keepAll = counts.size() <= StatisticsCollector::MCV_TARGET;
+    for (const auto& entry : ranked) {
+        if (stats.mcv.size() >= StatisticsCollector::MCV_TARGET) {
+            break;
+        }
+        if (!keepAll && (entry.second < 2 || entry.second <= 1.25 * avgCount)) {
+            break;
+        }
+        stats.mcv[entry.first] = static_cast<size_t>(std::llround(entry.second * scale));
+    }
+
+    // 等深直方图：不属于 MCV 的样本值排序后等间隔取边界
+    if (!isOrderedStatType(type)) {
+        return;
+    }
+    QVector<QVariant> rest;
+    for (const QVariant& value : values) {
+        if (!stats.mcv.contains(value.toString())) {
+            rest.append(normalizeStatValue(value, type));
+        }
+    }
+    if (rest.size() < 2) {
+        return;
+    }
+    std::sort(rest.begin(), rest.end(), [type](const QVariant& a, const QVariant& b) {
+        return compareStatValues(a, b, type) < 0;
+    });
+
+    const qsizetype numBounds = std::min<qsizetype>(StatisticsCollector::HISTOGRAM_BUCKETS + 1, rest.size());
+    for (qsizetype i = 0; i < numBounds; ++i) {
+        stats.histogramBounds.append(rest[i * (rest.size() - 1) / (numBounds - 1)]);
+    }
+}
+
+} // anonymous namespace
+
 StatisticsCollector::StatisticsCollector(Catalog* catalog, BufferPoolManager* bufferPool)
     : catalog_(catalog), bufferPool_(bufferPool) {
 }
@@ -113,14 +634,56 @@ bool StatisticsCollector::collectTableStats(const QString& tableName) {
         return false;
     }
 
-    TableStats stats(tableName);
+    const int numColumns = tableDef->columns.size();
+    QVector<ColumnAccumulator> accumulators(numColumns);
+    QVector<QVector<QVariant>> sample;   // 蓄水池采样保留的行
+    QVector<size_t> sampleOrdinals;      // 样本行的扫描序号（物理顺序）
+    QVector<QVector<QVariant>> batch;    // 待按列累加的一批行
+    batch.reserve(ACCUMULATE_BATCH_ROWS);
+
+    // 列组：前 MAX_GROUP_COLUMNS 列两两一组，组合值的草图由两列的值哈希组合得到
+    const int numGroupColumns = std::min(numColumns, MAX_GROUP_COLUMNS);
+    QVector<QPair<int, int>> groups;
+    for (int first = 0; first < numGroupColumns; ++first) {
+        for (int second = first + 1; second < numGroupColumns; ++second) {
+            groups.append(qMakePair(first, second));
+        }
+    }
+    QVector<HyperLogLog> groupSketches(groups.size());
+    std::vector<std::vector<uint64_t>> batchHashes(numGroupColumns);
+
+    // 固定种子：同样的数据得到同样的统计信息
+    QRandomGenerator rng(static_cast<quint32>(qHash(tableName.toLower())));
 
-    // 收集行数和页面数
     size_t numRows = 0;
+    size_t numPages = 0;
     size_t totalRowSize = 0;
-    QVector<PageId> pageIds;
 
-    // 遍历所有页面
+    // 一批行按列累加：每个线程负责互不相交的列，之后列组同样分给各线程
+    auto flushBatch = [&]() {
+        ColumnAccumulator* accs = accumulators.data();  // 先 detach，避免多线程下隐式共享拷贝
+        for (auto& hashes : batchHashes) {
+            hashes.resize(static_cast<size_t>(batch.size()));
+        }
+        forEachColumn(numColumns, batch.size(), [&](int column) {
+            uint64_t* hashes = column < numGroupColumns ? batchHashes[column].data() : nullptr;
+            accumulateColumn(tableDef->columns[column].type, batch, column, accs[column], hashes);
+        });
+
+        HyperLogLog* sketches = groupSketches.data();
+        forEachColumn(groups.size(), batch.size(), [&](int group) {
+            const int first = groups.at(group).first;
+            const int second = groups.at(group).second;
+            for (qsizetype r = 0; r < batch.size(); ++r) {
+                if (!isNullAt(batch.at(r), first) && !isNullAt(batch.at(r), second)) {
+                    sketches[group].add(HashUtil::combine(batchHashes[first][r], batchHashes[second][r]));
+                }
+            }
+        });
+        batch.clear();
+    };
+
+    // 沿页链扫描一遍（跳过已删除的版本）
     PageId currentPageId = tableDef->firstPageId;
     while (currentPageId != INVALID_PAGE_ID) {
         Page* page = bufferPool_->fetchPage(currentPageId);
@@ -129,43 +692,94 @@ bool StatisticsCollector::collectTableStats(const QString& tableName) {
             break;
         }
 
-        // 统计该页面的记录数
-        uint16_t slotCount = TablePage::getSlotCount(page);
-        for (uint16_t i = 0; i < slotCount; i++) {
-            QByteArray recordData;
-            if (TablePage::getTuple(page, i, recordData)) {
-                numRows++;
-                totalRowSize += recordData.size();
+        QVector<QVector<QVariant>> records;
+        QVector<RecordHeader> headers;
+        if (TablePage::getAllRecords(page, tableDef, records, headers)) {
+            for (int i = 0; i < records.size(); ++i) {
+                if (i < headers.size() && headers[i].deleteTxnId != INVALID_TXN_ID) {
+                    continue;
+                }
+                ++numRows;
+                totalRowSize += TablePage::calculateRecordSize(tableDef, records[i]);
+
+                // 蓄水池采样（Algorithm R）：第 n 行以 SAMPLE_ROWS / n 的概率替换样本中随机的一行
+                if (sample.size() < SAMPLE_ROWS) {
+                    sample.append(records[i]);
+                    sampleOrdinals.append(numRows);
+                } else {
+                    const quint64 slot = rng.generate64() % numRows;
+                    if (slot < static_cast<quint64>(SAMPLE_ROWS)) {
+                        sample[static_cast<qsizetype>(slot)] = records[i];
+                        sampleOrdinals[static_cast<qsizetype>(slot)] = numRows;
+                    }
+                }
+
+                batch.append(std::move(records[i]));
             }
         }
-
-        pageIds.append(currentPageId);
+        ++numPages;
 
         // 获取下一个页面
         PageHeader* header = page->getHeader();
         currentPageId = header->nextPageId;
 
         bufferPool_->unpinPage(page->getPageId(), false);
+
+        if (batch.size() >= ACCUMULATE_BATCH_ROWS) {
+            flushBatch();
+        }
     }
+    flushBatch();
 
+    TableStats stats(tableName);
     stats.numRows = numRows;
-    stats.numPages = pageIds.size();
+    stats.numPages = numPages;
     stats.avgRowSize = (numRows > 0) ? (totalRowSize / numRows) : 0;
 
-    // 收集每列的统计信息
-    for (const ColumnDef& colDef : tableDef->columns) {
-        ColumnStats colStats(colDef.name, colDef.type);
+    // 各列的 NDV、MCV、直方图和相关系数同样按列并行计算
+    QVector<ColumnStats> columnResults(numColumns);
+    ColumnStats* results = columnResults.data();
+    const ColumnAccumulator* accs = accumulators.constData();
+    forEachColumn(numColumns, sample.size(), [&](int column) {
+        const ColumnDef& colDef = tableDef->columns[column];
+        results[column] = ColumnStats(colDef.name, colDef.type);
+        buildColumnStats(accs[column], sample, sampleOrdinals, column, numRows, results[column]);
+    });
+    for (int column = 0; column < numColumns; ++column) {
+        stats.columnStats[tableDef->columns[column].name] = columnResults[column];
+    }
+
+    // 列组：组合 NDV 不少于任一列的 NDV、不多于两者之积，函数依赖程度由样本计算
+    stats.columnGroups.resize(groups.size());
+    ColumnGroupStats* groupResults = stats.columnGroups.data();
+    forEachColumn(groups.size(), sample.size(), [&](int group) {
+        const int first = groups.at(group).first;
+        const int second = groups.at(group).second;
+        ColumnGroupStats& groupStats = groupResults[group];
+        groupStats = ColumnGroupStats(tableDef->columns[first].name, tableDef->columns[second].name);
+
+        const double firstDistinct = static_cast<double>(results[first].numDistinctValues);
+        const double secondDistinct = static_cast<double>(results[second].numDistinctValues);
+        const double lowest = std::max(firstDistinct, secondDistinct);
+        const double estimate = std::clamp(groupSketches.at(group).estimate(), lowest,
+                                           std::max(firstDistinct * secondDistinct, lowest));
+        groupStats.numDistinctValues = static_cast<size_t>(std::llround(std::min(estimate, static_cast<double>(numRows))));
+        groupStats.dependency = functionalDependency(sample, first, second);
+        groupStats.reverseDependency = functionalDependency(sample, second, first);
+    });
+
+    // 保存统计信息，并发布到 Catalog 供之后的查询使用
+    tableStats_[tableName] = stats;
+    catalogStats_.remove(tableName.toLower());
+    catalog_->setTableStats(stats);
 
-        if (collectColumnStats(tableName, colDef.name, colStats)) {
-            stats.columnStats[colDef.name] = colStats;
-        }
+    // 统计信息已更新，之前按旧统计信息得到的基数修正不再适用
+    if (CardinalityFeedback* feedback = catalog_->getCardinalityFeedback()) {
+        feedback->invalidateTable(tableName);
     }
 
-    // 保存统计信息
-    tableStats_[tableName] = stats;
-
-    LOG_INFO(QString("Collected statistics for table '%1': %2 rows, %3 pages")
-                 .arg(tableName).arg(numRows).arg(pageIds.size()));
+    LOG_INFO(QString("Collected statistics for table '%1': %2 rows, %3 pages, %4 sampled")
+                 .arg(tableName).arg(numRows).arg(numPages).arg(sample.size()));
 
     return true;
 }
@@ -185,32 +799,54 @@ bool StatisticsCollector::collectAllStats() {
 
 const TableStats* StatisticsCollector::getTableStats(const QString& tableName) const {
     auto it = tableStats_.find(tableName);
-    return (it != tableStats_.end()) ? &it.value() : nullptr;
+    if (it != tableStats_.end()) {
+        return &it.value();
+    }
+
+    // 取 Catalog 中的共享快照（每个表只取一次）
+    const QString lowerName = tableName.toLower();
+    auto cached = catalogStats_.constFind(lowerName);
+    if (cached != catalogStats_.constEnd()) {
+        return cached.value().get();
+    }
+    if (!catalog_) {
+        return nullptr;
+    }
+
+    std::shared_ptr<const TableStats> snapshot = catalog_->getTableStats(tableName);
+    if (!snapshot) {
+        return nullptr;
+    }
+    catalogStats_.insert(lowerName, snapshot);
+    return snapshot.get();
 }
 
-void StatisticsCollector::updateTableStats(const QString& tableName,
+bool StatisticsCollector::updateTableStats(const QString& tableName,
                                            size_t rowsInserted,
-                                           size_t rowsDeleted) {
-    auto it = tableStats_.find(tableName);
-    if (it != tableStats_.end()) {
-        TableStats& stats = it.value();
-        stats.numRows += rowsInserted;
-        if (stats.numRows >= rowsDeleted) {
-            stats.numRows -= rowsDeleted;
-        } else {
-            stats.numRows = 0;
-        }
+                                           size_t rowsDeleted,
+                                           size_t rowsUpdated) {
+    // 只维护收集过统计信息的表；从未 ANALYZE 的表仍由执行器按规则选择访问路径。
+    // 在 Catalog 的锁内读-改-写，并发的 DML 不会互相覆盖改动
+    std::shared_ptr<const TableStats> stats =
+        catalog_->applyTableModifications(tableName, rowsInserted, rowsDeleted, rowsUpdated);
+    tableStats_.remove(tableName);
+    catalogStats_.remove(tableName.toLower());
+    if (!stats) {
+        return false;
+    }
 
-        // 简单更新：如果变化超过10%，重新收集
-        size_t threshold = stats.numRows / 10;
-        if (rowsInserted > threshold || rowsDeleted > threshold) {
-            collectTableStats(tableName);
-        }
+    // 改动累计超过阈值时需要重新收集（列统计随之更新，改动计数清零）
+    if (stats->needsReanalyze()) {
+        LOG_INFO(QString("Table '%1' changed by %2 rows since last analyze, scheduling refresh")
+                     .arg(tableName).arg(stats->modifiedRows));
+        return true;
     }
+    return false;
 }
 
 void StatisticsCollector::clearStats() {
     tableStats_.clear();
+    catalogStats_.clear();
 }
 
 bool StatisticsCollector::saveStats(const QString& filePath) {
@@ -218,40 +854,7 @@ bool StatisticsCollector::saveStats(const QString& filePath) {
     QJsonArray tablesArray;
 
     for (auto it = tableStats_.begin(); it != tableStats_.end(); ++it) {
-        const TableStats& stats = it.value();
-        QJsonObject tableObj;
-
-        tableObj["tableName"] = stats.tableName;
-        tableObj["numRows"] = static_cast<qint64>(stats.numRows);
-        tableObj["numPages"] = static_cast<qint64>(stats.numPages);
-        tableObj["avgRowSize"] = static_cast<qint64>(stats.avgRowSize);
-
-        // 保存列统计
-        QJsonArray columnsArray;
-        for (auto colIt = stats.columnStats.begin(); colIt != stats.columnStats.end(); ++colIt) {
-            const ColumnStats& colStats = colIt.value();
-            QJsonObject colObj;
-
-            colObj["columnName"] = colStats.columnName;
-            colObj["dataType"] = static_cast<int>(colStats.dataType);
-            colObj["numDistinctValues"] = static_cast<qint64>(colStats.numDistinctValues);
-            colObj["numNulls"] = static_cast<qint64>(colStats.numNulls);
-
-            // 保存 min/max (仅对数值类型)
-            if (isNumericType(colStats.dataType)) {
-                if (!colStats.minValue.isNull()) {
-                    colObj["minValue"] = colStats.minValue.toDouble();
-                }
-                if (!colStats.maxValue.isNull()) {
-                    colObj["maxValue"] = colStats.maxValue.toDouble();
-                }
-            }
-
-            columnsArray.append(colObj);
-        }
-        tableObj["columns"] = columnsArray;
-
-        tablesArray.append(tableObj);
+        tablesArray.append(it.value().toJson());
     }
 
     root["tables"] = tablesArray;
@@ -292,34 +895,7 @@ bool StatisticsCollector::loadStats(const QString& filePath) {
     clearStats();
 
     for (const QJsonValue& val : tablesArray) {
-        QJsonObject tableObj = val.toObject();
-
-        TableStats stats(tableObj["tableName"].toString());
-        stats.numRows = tableObj["numRows"].toInt();
-        stats.numPages = tableObj["numPages"].toInt();
-        stats.avgRowSize = tableObj["avgRowSize"].toInt();
-
-        // 加载列统计
-        QJsonArray columnsArray = tableObj["columns"].toArray();
-        for (const QJsonValue& colVal : columnsArray) {
-            QJsonObject colObj = colVal.toObject();
-
-            ColumnStats colStats;
-            colStats.columnName = colObj["columnName"].toString();
-            colStats.dataType = static_cast<DataType>(colObj["dataType"].toInt());
-            colStats.numDistinctValues = colObj["numDistinctValues"].toInt();
-            colStats.numNulls = colObj["numNulls"].toInt();
-
-            if (colObj.contains("minValue")) {
-                colStats.minValue = colObj["minValue"].toDouble();
-            }
-            if (colObj.contains("maxValue")) {
-                colStats.maxValue = colObj["maxValue"].toDouble();
-            }
-
-            stats.columnStats[colStats.columnName] = colStats;
-        }
-
+        TableStats stats = TableStats::fromJson(val.toObject());
         tableStats_[stats.tableName] = stats;
     }
 
@@ -327,185 +903,87 @@ bool StatisticsCollector::loadStats(const QString& filePath) {
     return true;
 }
 
-// ========== 私有辅助方法 ==========
-
-bool StatisticsCollector::collectColumnStats(const QString& tableName,
-                                             const QString& columnName,
-                                             ColumnStats& stats) {
-    const TableDef* tableDef = catalog_->getTable(tableName);
-    if (!tableDef) {
-        return false;
-    }
-
-    // 找到列的索引
-    int colIndex = -1;
-    for (int i = 0; i < tableDef->columns.size(); i++) {
-        if (tableDef->columns[i].name == columnName) {
-            colIndex = i;
-            break;
-        }
-    }
-
-    if (colIndex == -1) {
-        return false;
-    }
-
-    const ColumnDef& colDef = tableDef->columns[colIndex];
-    stats.dataType = colDef.type;
-
-    // 采样数据
-    QVector<QVariant> sampleValues = sampleColumn(tableName, columnName, 1000);
+// ========== AutoAnalyzeWorker ==========
 
-    if (sampleValues.isEmpty()) {
-        return true;
-    }
+AutoAnalyzeWorker::AutoAnalyzeWorker(Catalog* catalog, BufferPoolManager* bufferPool)
+    : catalog_(catalog)
+    , bufferPool_(bufferPool)
+    , workerThread_(nullptr)
+    , busy_(false)
+    , stopping_(false) {
+}
 
-    // 统计 NULL 值
-    stats.numNulls = 0;
-    QVector<QVariant> nonNullValues;
-    for (const QVariant& val : sampleValues) {
-        if (val.isNull()) {
-            stats.numNulls++;
-        } else {
-            nonNullValues.append(val);
-        }
+AutoAnalyzeWorker::~AutoAnalyzeWorker() {
+    {
+        QMutexLocker locker(&mutex_);
+        stopping_ = true;
+        queue_.clear();
+        workAvailable_.wakeAll();
     }
 
-    // 估算基数
-    stats.numDistinctValues = estimateCardinality(nonNullValues);
-
-    // 计算 min/max (仅对数值类型)
-    if (!nonNullValues.isEmpty()) {
-        if (isNumericType(colDef.type)) {
-            QVector<double> numericValues;
-            for (const QVariant& val : nonNullValues) {
-                numericValues.append(val.toDouble());
-            }
-
-            std::sort(numericValues.begin(), numericValues.end());
-            stats.minValue = numericValues.first();
-            stats.maxValue = numericValues.last();
-        } else if (isStringType(colDef.type)) {
-            QVector<QString> stringValues;
-            for (const QVariant& val : nonNullValues) {
-                stringValues.append(val.toString());
-            }
-
-            std::sort(stringValues.begin(), stringValues.end());
-            stats.minValue = stringValues.first();
-            stats.maxValue = stringValues.last();
-        }
+    // 正在进行的收集做完才退出，之后 Catalog 和缓冲池才会析构
+    if (workerThread_) {
+        workerThread_->wait();
+        delete workerThread_;
+        workerThread_ = nullptr;
     }
+}
 
-    // 构建 MCV (Most Common Values) - 使用QString作为键
-    QHash<QString, size_t> valueCounts;
-    for (const QVariant& val : nonNullValues) {
-        QString key = val.toString();
-        valueCounts[key]++;
+void AutoAnalyzeWorker::schedule(const QString& tableName) {
+    QMutexLocker locker(&mutex_);
+    if (stopping_) {
+        return;
     }
 
-    // 选择前10个最常见值
-    QVector<QPair<QString, size_t>> sortedCounts;
-    for (auto it = valueCounts.begin(); it != valueCounts.end(); ++it) {
-        sortedCounts.append(qMakePair(it.key(), it.value()));
+    const QString lowerName = tableName.toLower();
+    if (!queue_.contains(lowerName)) {
+        queue_.append(lowerName);
     }
 
-    std::sort(sortedCounts.begin(), sortedCounts.end(),
-              [](const QPair<QString, size_t>& a, const QPair<QString, size_t>& b) {
-                  return a.second > b.second;
-              });
-
-    for (int i = 0; i < qMin(10, sortedCounts.size()); i++) {
-        stats.mcv[sortedCounts[i].first] = sortedCounts[i].second;
+    if (!workerThread_) {
+        workerThread_ = QThread::create([this]() {
+            this->run();
+        });
+        workerThread_->start();
     }
-
-    return true;
+    workAvailable_.wakeOne();
 }
 
-QVector<QVariant> StatisticsCollector::sampleColumn(const QString& tableName,
-                                                    const QString& columnName,
-                                                    size_t sampleSize) {
-    QVector<QVariant> samples;
-
-    const TableDef* tableDef = catalog_->getTable(tableName);
-    if (!tableDef) {
-        return samples;
+void AutoAnalyzeWorker::waitIdle() {
+    QMutexLocker locker(&mutex_);
+    while (!queue_.isEmpty() || busy_) {
+        idle_.wait(&mutex_);
     }
+}
 
-    // 找到列的索引
-    int colIndex = -1;
-    for (int i = 0; i < tableDef->columns.size(); i++) {
-        if (tableDef->columns[i].name == columnName) {
-            colIndex = i;
+void AutoAnalyzeWorker::run() {
+    QMutexLocker locker(&mutex_);
+    while (true) {
+        while (queue_.isEmpty() && !stopping_) {
+            workAvailable_.wait(&mutex_);
+        }
+        if (stopping_) {
             break;
         }
-    }
-
-    if (colIndex == -1) {
-        return samples;
-    }
 
-    // 遍历表，采样数据
-    size_t sampledCount = 0;
-    size_t totalCount = 0;
+        const QString tableName = queue_.takeFirst();
+        busy_ = true;
+        locker.unlock();
 
-    PageId currentPageId = tableDef->firstPageId;
-    while (currentPageId != INVALID_PAGE_ID && sampledCount < sampleSize) {
-        Page* page = bufferPool_->fetchPage(currentPageId);
-        if (!page) {
-            break;
+        // 表可能已被删除，收集失败只记日志
+        if (!StatisticsCollector(catalog_, bufferPool_).collectTableStats(tableName)) {
+            LOG_WARN(QString("Background analyze of table '%1' failed").arg(tableName));
         }
 
-        // 获取页面中的所有记录
-        QVector<QVector<QVariant>> records;
-        if (TablePage::getAllRecords(page, tableDef, records)) {
-            for (const auto& record : records) {
-                totalCount++;
-
-                // 采样策略：每N条记录采样1条
-                size_t samplingRate = qMax(1ULL, totalCount / sampleSize);
-                if (totalCount % samplingRate == 0) {
-                    if (colIndex < record.size()) {
-                        samples.append(record[colIndex]);
-                        sampledCount++;
-
-                        if (sampledCount >= sampleSize) {
-                            break;
-                        }
-                    }
-                }
-            }
+        locker.relock();
+        busy_ = false;
+        if (queue_.isEmpty()) {
+            idle_.wakeAll();
         }
-
-        PageHeader* header = page->getHeader();
-        currentPageId = header->nextPageId;
-
-        bufferPool_->unpinPage(page->getPageId(), false);
     }
 
-    return samples;
-}
-
-size_t StatisticsCollector::estimateCardinality(const QVector<QVariant>& samples) {
-    if (samples.isEmpty()) {
-        return 0;
-    }
-
-    // 使用 HyperLogLog 的简化版本：统计不同值的数量
-    QSet<QString> distinctValues;
-
-    for (const QVariant& val : samples) {
-        // 将 QVariant 转换为字符串用于去重
-        distinctValues.insert(val.toString());
-    }
-
-    return distinctValues.size();
-}
-
-void StatisticsCollector::buildHistogram(ColumnStats& stats, const QVector<QVariant>& allValues) {
-    // 简化实现：存储采样值
-    // 完整实现需要构建等深或等宽直方图
-    stats.sampleValues = allValues;
+    busy_ = false;
+    idle_.wakeAll();
 }
 
 } // namespace qindb
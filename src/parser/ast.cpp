@@ -106,6 +106,16 @@ QString SubqueryExpression::toString() const {
     return "(" + subquery->toString() + ")";
 }
 
+QString ListExpression::toString() const {
+    QString result = "(";
+    for (size_t i = 0; i < elements.size(); ++i) {
+        if (i > 0) result += ", ";
+        result += elements[i]->toString();
+    }
+    result += ")";
+    return result;
+}
+
 QString MatchExpression::toString() const {
     QString result = "MATCH(";
     for (int i = 0; i < columns.size(); ++i) {
@@ -303,6 +313,29 @@ QString CreateIndexStatement::toString() const {
         result += columns[i];
     }
     result += ")";
+    if (!includeColumns.isEmpty()) {
+        result += " INCLUDE (" + includeColumns.join(", ") + ")";
+    }
+    if (type == IndexType::BRIN) {
+        result += " USING BRIN";
+    } else if (type == IndexType::BITMAP) {
+        result += " USING BITMAP";
+    } else if (type == IndexType::RTREE) {
+        result += " USING RTREE";
+    } else if (type == IndexType::TRIE) {
+        result += " USING TRIE";
+    }
+    if (!options.isEmpty()) {
+        QStringList optionList;
+        for (auto it = options.constBegin(); it != options.constEnd(); ++it) {
+            optionList.append(it.key() + " = " + it.value());
+        }
+        optionList.sort();
+        result += " WITH (" + optionList.join(", ") + ")";
+    }
+    if (where) {
+        result += " WHERE " + where->toString();
+    }
     return result;
 }
 
@@ -386,12 +419,18 @@ QString AnalyzeStatement::toString() const {
     return "ANALYZE TABLE " + tableName;
 }
 
+// CalibrateStatement
+QString CalibrateStatement::toString() const {
+    return "CALIBRATE";
+}
+
 // ExplainStatement
 QString ExplainStatement::toString() const {
+    const QString keyword = analyze ? "EXPLAIN ANALYZE" : "EXPLAIN";
     if (query) {
-        return "EXPLAIN " + query->toString();
+        return keyword + " " + query->toString();
     }
-    return "EXPLAIN";
+    return keyword;
 }
 
 // CreateUserStatement
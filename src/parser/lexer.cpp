@@ -99,6 +99,7 @@ static QHash<QString, TokenType> createKeywordMap() {
     map["analyze"] = TokenType::ANALYZE;
     map["save"] = TokenType::SAVE;
     map["vacuum"] = TokenType::VACUUM;
+    map["calibrate"] = TokenType::CALIBRATE;
     map["grant"] = TokenType::GRANT;
     map["revoke"] = TokenType::REVOKE;
     map["to"] = TokenType::TO;
@@ -515,6 +516,7 @@ QString tokenTypeToString(TokenType type) {
         case TokenType::EXPLAIN: return "EXPLAIN";
         case TokenType::SAVE: return "SAVE";
         case TokenType::VACUUM: return "VACUUM";
+        case TokenType::CALIBRATE: return "CALIBRATE";
 
         // 权限
         case TokenType::GRANT: return "GRANT";
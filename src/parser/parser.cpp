@@ -85,6 +85,26 @@ std::unique_ptr<ast::ASTNode> Parser::parse() {
     return stmt;
 }
 
+std::unique_ptr<ast::Expression> Parser::parseStandaloneExpression() {
+    if (check(TokenType::EOF_TOKEN)) {
+        setError(ErrorCode::SYNTAX_ERROR, "Empty expression", "");
+        return nullptr;
+    }
+
+    auto expr = parseExpression();
+    if (!expr) {
+        return nullptr;
+    }
+
+    if (!check(TokenType::EOF_TOKEN)) {
+        setError(ErrorCode::SYNTAX_ERROR, "Unexpected tokens after expression",
+                 QString("Extra token: '%1'").arg(m_currentToken.lexeme));
+        return nullptr;
+    }
+
+    return expr;
+}
+
 std::unique_ptr<ast::ASTNode> Parser::parseStatement() {
     switch (m_currentToken.type) {
         case TokenType::SELECT:
@@ -99,7 +119,10 @@ std::unique_ptr<ast::ASTNode> Parser::parseStatement() {
             // 需要查看下一个 Token 来区分 CREATE TABLE、CREATE INDEX、CREATE DATABASE、CREATE USER
             if (peek().type == TokenType::TABLE) {
                 return parseCreateTable();
-            } else if (peek().type == TokenType::INDEX || peek().type == TokenType::UNIQUE) {
+            } else if (peek().type == TokenType::INDEX || peek().type == TokenType::UNIQUE ||
+                       (peek().type == TokenType::IDENTIFIER &&
+                        (peek().lexeme.compare("BITMAP", Qt::CaseInsensitive) == 0 ||
+                         peek().lexeme.compare("SPATIAL", Qt::CaseInsensitive) == 0))) {
                 return parseCreateIndex();
             } else if (peek().type == TokenType::DATABASE || peek().type == TokenType::DATABASES) {
                 return parseCreateDatabase();
@@ -161,6 +184,8 @@ std::unique_ptr<ast::ASTNode> Parser::parseStatement() {
             return parseVacuum();
         case TokenType::ANALYZE:
             return parseAnalyze();
+        case TokenType::CALIBRATE:
+            return parseCalibrate();
         case TokenType::EXPLAIN:
             return parseExplain();
         case TokenType::GRANT:
@@ -691,7 +716,7 @@ std::unique_ptr<ast::Expression> Parser::parseComparisonExpression() {
         return std::make_unique<ast::BinaryExpression>(
             std::move(left), ast::BinaryOp::LIKE, std::move(right));
     } else if (match(TokenType::IN)) {
-        auto right = parseAdditiveExpression();
+        auto right = parseInList();
         if (!right) return nullptr;
         return std::make_unique<ast::BinaryExpression>(
             std::move(left), ast::BinaryOp::IN, std::move(right));
@@ -708,6 +733,26 @@ std::unique_ptr<ast::Expression> Parser::parseComparisonExpression() {
     return left;
 }
 
+std::unique_ptr<ast::Expression> Parser::parseInList() {
+    // IN (SELECT ...) 仍按子查询处理
+    if (!check(TokenType::LPAREN) || peek().type == TokenType::SELECT) {
+        return parseAdditiveExpression();
+    }
+    advance();
+
+    std::vector<std::unique_ptr<ast::Expression>> items;
+    do {
+        auto item = parseExpression();
+        if (!item) return nullptr;
+        items.push_back(std::move(item));
+    } while (match(TokenType::COMMA));
+
+    if (!consume(TokenType::RPAREN, "Expected ')' after IN list")) {
+        return nullptr;
+    }
+    return std::make_unique<ast::ListExpression>(std::move(items));
+}
+
 std::unique_ptr<ast::Expression> Parser::parseAdditiveExpression() {
     auto left = parseMultiplicativeExpression();
     if (!left) return nullptr;
@@ -1091,6 +1136,13 @@ DataType Parser::parseDataType() {
         type = DataType::BOOLEAN;
     } else if (match(TokenType::BLOB)) {
         type = DataType::BLOB;
+    } else if (check(TokenType::IDENTIFIER) && m_currentToken.lexeme.toUpper() == "GEOMETRY") {
+        // 空间类型不是保留字，按标识符识别
+        advance();
+        type = DataType::GEOMETRY;
+    } else if (check(TokenType::IDENTIFIER) && m_currentToken.lexeme.toUpper() == "GEOGRAPHY") {
+        advance();
+        type = DataType::GEOGRAPHY;
     } else {
         setError(ErrorCode::SYNTAX_ERROR, "Unknown data type", m_currentToken.lexeme);
     }
@@ -1161,6 +1213,19 @@ std::unique_ptr<ast::CreateIndexStatement> Parser::parseCreateIndex() {
         stmt->unique = true;
     }
 
+    // CREATE BITMAP INDEX / CREATE SPATIAL INDEX（都不是保留字，按标识符识别），
+    // 分别等价于 USING BITMAP / USING RTREE
+    QString typeKeyword;
+    ast::IndexType keywordType = ast::IndexType::BTREE;
+    if (check(TokenType::IDENTIFIER)) {
+        const QString word = m_currentToken.lexeme.toUpper();
+        if (word == "BITMAP" || word == "SPATIAL") {
+            typeKeyword = word;
+            keywordType = word == "BITMAP" ? ast::IndexType::BITMAP : ast::IndexType::RTREE;
+            advance();
+        }
+    }
+
     consume(TokenType::INDEX, "Expected INDEX");
 
     if (match(TokenType::IF)) {
@@ -1187,17 +1252,50 @@ std::unique_ptr<ast::CreateIndexStatement> Parser::parseCreateIndex() {
 
     consume(TokenType::LPAREN, "Expected '(' after table name");
 
+    // 键可以是列名，也可以是表达式（如 lower(email)）；表达式键的 columns 项为表达式文本
     do {
-        if (!check(TokenType::IDENTIFIER)) {
-            setError(ErrorCode::SYNTAX_ERROR, "Expected column name", "");
+        if (check(TokenType::IDENTIFIER) &&
+            (peek().type == TokenType::COMMA || peek().type == TokenType::RPAREN)) {
+            stmt->columns.append(m_currentToken.lexeme);
+            stmt->expressions.push_back(nullptr);
+            advance();
+            continue;
+        }
+
+        auto expr = parseExpression();
+        if (!expr) {
             return nullptr;
         }
-        stmt->columns.append(m_currentToken.lexeme);
-        advance();
+        stmt->columns.append(expr->toString());
+        stmt->expressions.push_back(std::move(expr));
     } while (match(TokenType::COMMA));
 
     consume(TokenType::RPAREN, "Expected ')' after column list");
 
+    // 可选的 INCLUDE (col, ...)：覆盖索引的非键列（INCLUDE 不是保留字，按标识符识别）
+    auto parseIncludeColumns = [this, &stmt]() -> bool {
+        if (!check(TokenType::IDENTIFIER) || m_currentToken.lexeme.compare("INCLUDE", Qt::CaseInsensitive) != 0) {
+            return true;
+        }
+        advance();
+        if (!consume(TokenType::LPAREN, "Expected '(' after INCLUDE")) {
+            return false;
+        }
+        do {
+            if (!check(TokenType::IDENTIFIER)) {
+                setError(ErrorCode::SYNTAX_ERROR, "Expected column name in INCLUDE list", "");
+                return false;
+            }
+            stmt->includeColumns.append(m_currentToken.lexeme);
+            advance();
+        } while (match(TokenType::COMMA));
+        return consume(TokenType::RPAREN, "Expected ')' after INCLUDE column list");
+    };
+
+    if (!parseIncludeColumns()) {
+        return nullptr;
+    }
+
     // Parse optional USING clause (e.g., USING HASH, USING BTREE)
     if (match(TokenType::USING)) {
         if (check(TokenType::IDENTIFIER)) {
@@ -1210,9 +1308,23 @@ std::unique_ptr<ast::CreateIndexStatement> Parser::parseCreateIndex() {
                 stmt->type = ast::IndexType::HASH;
             } else if (indexTypeStr == "FULLTEXT") {
                 stmt->type = ast::IndexType::FULLTEXT;
+            } else if (indexTypeStr == "BRIN") {
+                stmt->type = ast::IndexType::BRIN;
+            } else if (indexTypeStr == "BITMAP") {
+                stmt->type = ast::IndexType::BITMAP;
+            } else if (indexTypeStr == "RTREE") {
+                stmt->type = ast::IndexType::RTREE;
+            } else if (indexTypeStr == "TRIE") {
+                stmt->type = ast::IndexType::TRIE;
             } else {
                 setError(ErrorCode::SYNTAX_ERROR, "Invalid index type",
-                         QString("Expected BTREE, HASH, or FULLTEXT, got '%1'").arg(indexTypeStr));
+                         QString("Expected BTREE, HASH, FULLTEXT, BRIN, BITMAP, RTREE, or TRIE, got '%1'").arg(indexTypeStr));
+                return nullptr;
+            }
+
+            if (!typeKeyword.isEmpty() && stmt->type != keywordType) {
+                setError(ErrorCode::SYNTAX_ERROR, "Conflicting index type",
+                         QString("CREATE %1 INDEX cannot use USING %2").arg(typeKeyword, indexTypeStr));
                 return nullptr;
             }
         } else {
@@ -1222,7 +1334,49 @@ std::unique_ptr<ast::CreateIndexStatement> Parser::parseCreateIndex() {
     }
     // Default to BTREE if not specified
     else {
-        stmt->type = ast::IndexType::BTREE;
+        stmt->type = typeKeyword.isEmpty() ? ast::IndexType::BTREE : keywordType;
+    }
+
+    // INCLUDE 也可以写在 USING 之后
+    if (stmt->includeColumns.isEmpty() && !parseIncludeColumns()) {
+        return nullptr;
+    }
+
+    // 可选的 WITH (name = value, ...) 索引选项（如 BRIN 的 bloom = true）
+    if (match(TokenType::WITH)) {
+        if (!consume(TokenType::LPAREN, "Expected '(' after WITH")) {
+            return nullptr;
+        }
+        do {
+            if (!check(TokenType::IDENTIFIER)) {
+                setError(ErrorCode::SYNTAX_ERROR, "Expected option name in WITH list", "");
+                return nullptr;
+            }
+            QString name = m_currentToken.lexeme.toLower();
+            advance();
+            if (!consume(TokenType::EQ, "Expected '=' after option name")) {
+                return nullptr;
+            }
+            if (!check(TokenType::IDENTIFIER) && !check(TokenType::INTEGER) && !check(TokenType::FLOAT) &&
+                !check(TokenType::STRING) && !check(TokenType::TRUE_KW) && !check(TokenType::FALSE_KW)) {
+                setError(ErrorCode::SYNTAX_ERROR, "Expected option value",
+                         QString("Option '%1' needs a literal or identifier value").arg(name));
+                return nullptr;
+            }
+            stmt->options.insert(name, m_currentToken.lexeme.toLower());
+            advance();
+        } while (match(TokenType::COMMA));
+        if (!consume(TokenType::RPAREN, "Expected ')' after WITH options")) {
+            return nullptr;
+        }
+    }
+
+    // 可选的 WHERE 谓词：部分索引只包含满足谓词的行
+    if (match(TokenType::WHERE)) {
+        stmt->where = parseExpression();
+        if (!stmt->where) {
+            return nullptr;
+        }
     }
 
     return stmt;
@@ -1421,11 +1575,25 @@ std::unique_ptr<ast::AnalyzeStatement> Parser::parseAnalyze() {
     return stmt;
 }
 
+std::unique_ptr<ast::CalibrateStatement> Parser::parseCalibrate() {
+    auto stmt = std::make_unique<ast::CalibrateStatement>();
+
+    consume(TokenType::CALIBRATE, "Expected CALIBRATE");
+
+    return stmt;
+}
+
 std::unique_ptr<ast::ExplainStatement> Parser::parseExplain() {
     auto stmt = std::make_unique<ast::ExplainStatement>();
 
     consume(TokenType::EXPLAIN, "Expected EXPLAIN");
 
+    // EXPLAIN ANALYZE SELECT ...：执行查询并报告实际行数和耗时
+    if (m_currentToken.type == TokenType::ANALYZE) {
+        stmt->analyze = true;
+        advance();
+    }
+
     // EXPLAIN SELECT ...
     if (m_currentToken.type == TokenType::SELECT) {
         stmt->query = parseSelect();
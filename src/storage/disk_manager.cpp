@@ -2,6 +2,11 @@
 #include "qindb/logger.h"
 #include <QFileInfo>
 
+#if defined(Q_OS_LINUX)
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
 namespace qindb {
 
 DiskManager::DiskManager(const QString& dbFile)
@@ -180,6 +185,24 @@ void DiskManager::flush() {
     }
 }
 
+bool DiskManager::dropOSCache() {
+    QMutexLocker locker(&mutex_);
+
+    if (!dbFile_.isOpen() || !dbFile_.flush()) {
+        return false;
+    }
+#if defined(Q_OS_LINUX)
+    // POSIX_FADV_DONTNEED 只丢弃干净页，先把脏页写回
+    const int fd = dbFile_.handle();
+    if (fd < 0 || ::fdatasync(fd) != 0) {
+        return false;
+    }
+    return ::posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED) == 0;
+#else
+    return false;
+#endif
+}
+
 void DiskManager::close() {
     QMutexLocker locker(&mutex_);
 
@@ -1,4 +1,5 @@
 #include "qindb/table_page.h"
+#include "qindb/geometry.h"
 #include "qindb/logger.h"
 #include <QDataStream>
 #include <QByteArray>
@@ -500,6 +501,19 @@ bool TablePage::serializeField(const ColumnDef& colDef, const QVariant& value,
             break;
         }
 
+        case DataType::GEOMETRY:
+        case DataType::GEOGRAPHY: {
+            // 空间类型：WKT 转为 WKB 存储
+            Geometry geometry;
+            if (!Geometry::fromValue(value, geometry)) {
+                LOG_ERROR(QString("Invalid geometry value for field %1: %2")
+                              .arg(colDef.name).arg(value.toString()));
+                return false;
+            }
+            stream << geometry.toWkb();
+            break;
+        }
+
         default:
             LOG_ERROR(QString("Unsupported data type: %1").arg(static_cast<int>(colDef.type)));
             return false;
@@ -644,6 +658,19 @@ bool TablePage::deserializeField(const ColumnDef& colDef, QVariant& value,
             break;
         }
 
+        case DataType::GEOMETRY:
+        case DataType::GEOGRAPHY: {
+            QByteArray wkb;
+            stream >> wkb;
+            Geometry geometry;
+            if (stream.status() != QDataStream::Ok || !Geometry::fromWkb(wkb, geometry)) {
+                LOG_ERROR(QString("Failed to read GEOMETRY value for field %1").arg(colDef.name));
+                return false;
+            }
+            value = geometry.toWkt();
+            break;
+        }
+
         default:
             LOG_ERROR(QString("Unsupported data type: %1 for field %2")
                 .arg(static_cast<int>(colDef.type)).arg(colDef.name));
@@ -1,4 +1,5 @@
 #include "qindb/type_serializer.h"
+#include "qindb/geometry.h"
 #include "qindb/logger.h"
 #include <QDateTime>
 #include <QUuid>
@@ -617,6 +618,9 @@ bool TypeSerializer::serializeSpecial(const QVariant& value, DataType type, QDat
             // 空间类型: 存储为 WKB (Well-Known Binary)
             QString wkt = value.toString();
             QByteArray wkb = parseWKB(wkt);
+            if (wkb.isEmpty()) {
+                return false;
+            }
             uint32_t len = static_cast<uint32_t>(wkb.size());
             stream << len;
             stream.writeRawData(wkb.constData(), len);
@@ -675,6 +679,9 @@ bool TypeSerializer::deserializeSpecial(QDataStream& stream, DataType type, QVar
             }
 
             QString wkt = formatWKT(wkb);
+            if (wkt.isEmpty()) {
+                return false;
+            }
             value = wkt;
             return true;
         }
@@ -750,32 +757,10 @@ QString TypeSerializer::formatUUID(const QByteArray& uuidData) {
 // ============ WKB 辅助函数（空间类型）============
 
 QByteArray TypeSerializer::parseWKB(const QString& wktStr) {
-    // 简化实现：仅支持 POINT 类型
-    // 生产环境应使用完整的 WKT/WKB 解析库（如 GEOS）
-
-    // 示例 WKT: "POINT(1.0 2.0)"
-    if (wktStr.startsWith("POINT", Qt::CaseInsensitive)) {
-        // 解析坐标
-        QString coords = wktStr.mid(6); // 跳过 "POINT("
-        coords = coords.remove('(').remove(')').trimmed();
-
-        QStringList parts = coords.split(' ', Qt::SkipEmptyParts);
-        if (parts.size() == 2) {
-            double x = parts[0].toDouble();
-            double y = parts[1].toDouble();
-
-            // WKB 格式: [byte order][type][x][y]
-            QByteArray wkb;
-            QDataStream stream(&wkb, QIODevice::WriteOnly);
-            stream.setByteOrder(QDataStream::LittleEndian);
-
-            stream << static_cast<uint8_t>(1); // Little Endian
-            stream << static_cast<uint32_t>(1); // Point type
-            stream << x;
-            stream << y;
-
-            return wkb;
-        }
+    // 支持 POINT、LINESTRING、POLYGON，示例 WKT: "POINT(1.0 2.0)"
+    Geometry geometry;
+    if (Geometry::fromWkt(wktStr, geometry)) {
+        return geometry.toWkb();
     }
 
     // 其他类型：返回空数组
@@ -784,32 +769,12 @@ QByteArray TypeSerializer::parseWKB(const QString& wktStr) {
 }
 
 QString TypeSerializer::formatWKT(const QByteArray& wkbData) {
-    // 简化实现：仅支持 POINT 类型
-    if (wkbData.size() < 21) {
-        return QString();
-    }
-
-    QDataStream stream(wkbData);
-
-    uint8_t byteOrder;
-    stream >> byteOrder;
-
-    if (byteOrder == 1) {
-        stream.setByteOrder(QDataStream::LittleEndian);
-    } else {
-        stream.setByteOrder(QDataStream::BigEndian);
-    }
-
-    uint32_t geomType;
-    stream >> geomType;
-
-    if (geomType == 1) { // Point
-        double x, y;
-        stream >> x >> y;
-        return QString("POINT(%1 %2)").arg(x).arg(y);
+    Geometry geometry;
+    if (Geometry::fromWkb(wkbData, geometry)) {
+        return geometry.toWkt();
     }
 
-    LOG_WARN(QString("Unsupported WKB geometry type: %1").arg(geomType));
+    LOG_WARN(QString("Unsupported or corrupt WKB geometry (%1 bytes)").arg(wkbData.size()));
     return QString();
 }
 
@@ -0,0 +1,43 @@
+#include "qindb/cpu_features.h"
+
+#if defined(QINDB_HAS_AVX2) && defined(_MSC_VER) && !defined(__clang__)
+#include <immintrin.h>
+#include <intrin.h>
+#endif
+
+namespace qindb {
+
+namespace {
+
+bool detectAvx2() {
+#if !defined(QINDB_HAS_AVX2)
+    return false;
+#elif defined(_MSC_VER) && !defined(__clang__)
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) {
+        return false;
+    }
+    // 还要确认操作系统会保存 YMM 寄存器（OSXSAVE 且 XCR0 的 SSE/AVX 位都置上）
+    __cpuid(info, 1);
+    const bool osxsave = (info[2] & (1 << 27)) != 0;
+    const bool avx = (info[2] & (1 << 28)) != 0;
+    if (!osxsave || !avx || (_xgetbv(0) & 0x6) != 0x6) {
+        return false;
+    }
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+
+} // namespace
+
+bool CpuFeatures::hasAvx2() {
+    static const bool supported = detectAvx2();
+    return supported;
+}
+
+} // namespace qindb
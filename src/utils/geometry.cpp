@@ -0,0 +1,454 @@
+#include "qindb/geometry.h"
+#include <QDataStream>
+#include <QIODevice>
+#include <QLocale>
+#include <QPair>
+#include <QStringList>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace qindb {
+
+namespace {
+
+/**
+ * @brief 解析 "x y, x y, ..." 形式的坐标序列
+ */
+bool parseCoordinates(const QString& text, QVector<GeoPoint>& points) {
+    const QStringList items = text.split(',');
+    for (const QString& item : items) {
+        const QStringList parts = item.trimmed().split(' ', Qt::SkipEmptyParts);
+        if (parts.size() != 2) {
+            return false;
+        }
+        bool okX = false;
+        bool okY = false;
+        GeoPoint p;
+        p.x = parts[0].toDouble(&okX);
+        p.y = parts[1].toDouble(&okY);
+        if (!okX || !okY || !std::isfinite(p.x) || !std::isfinite(p.y)) {
+            return false;
+        }
+        points.append(p);
+    }
+    return true;
+}
+
+/**
+ * @brief 去掉首尾空白后，要求以 '(' 开头、以 ')' 结尾，返回括号内的部分
+ */
+bool stripParens(const QString& text, QString& inner) {
+    const QString trimmed = text.trimmed();
+    if (trimmed.size() < 2 || !trimmed.startsWith('(') || !trimmed.endsWith(')')) {
+        return false;
+    }
+    inner = trimmed.mid(1, trimmed.size() - 2);
+    return true;
+}
+
+bool isClosedRing(const QVector<GeoPoint>& ring) {
+    return ring.size() >= 4 && ring.first().x == ring.last().x && ring.first().y == ring.last().y;
+}
+
+QString formatCoordinate(double value) {
+    return QString::number(value, 'g', QLocale::FloatingPointShortest);
+}
+
+QString formatPoints(const QVector<GeoPoint>& points) {
+    QStringList items;
+    items.reserve(points.size());
+    for (const GeoPoint& p : points) {
+        items.append(QString("%1 %2").arg(formatCoordinate(p.x), formatCoordinate(p.y)));
+    }
+    return items.join(", ");
+}
+
+double pointSegmentDistance(const GeoPoint& p, const GeoPoint& a, const GeoPoint& b) {
+    const double dx = b.x - a.x;
+    const double dy = b.y - a.y;
+    const double lengthSq = dx * dx + dy * dy;
+    double t = 0.0;
+    if (lengthSq > 0.0) {
+        t = std::clamp(((p.x - a.x) * dx + (p.y - a.y) * dy) / lengthSq, 0.0, 1.0);
+    }
+    return std::hypot(p.x - (a.x + t * dx), p.y - (a.y + t * dy));
+}
+
+/**
+ * @brief 叉积的符号：c 在 ab 的左侧为 1，右侧为 -1，共线为 0
+ */
+int orientation(const GeoPoint& a, const GeoPoint& b, const GeoPoint& c) {
+    const double cross = (b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x);
+    return cross > 0.0 ? 1 : (cross < 0.0 ? -1 : 0);
+}
+
+/**
+ * @brief 与 a、b 共线的点 p 是否落在线段 ab 上
+ */
+bool onSegment(const GeoPoint& a, const GeoPoint& b, const GeoPoint& p) {
+    return std::min(a.x, b.x) <= p.x && p.x <= std::max(a.x, b.x) &&
+           std::min(a.y, b.y) <= p.y && p.y <= std::max(a.y, b.y);
+}
+
+bool segmentsIntersect(const GeoPoint& a, const GeoPoint& b, const GeoPoint& c, const GeoPoint& d) {
+    const int o1 = orientation(a, b, c);
+    const int o2 = orientation(a, b, d);
+    const int o3 = orientation(c, d, a);
+    const int o4 = orientation(c, d, b);
+    if (o1 != o2 && o3 != o4) {
+        return true;
+    }
+    return (o1 == 0 && onSegment(a, b, c)) || (o2 == 0 && onSegment(a, b, d)) ||
+           (o3 == 0 && onSegment(c, d, a)) || (o4 == 0 && onSegment(c, d, b));
+}
+
+double segmentDistance(const GeoPoint& a, const GeoPoint& b, const GeoPoint& c, const GeoPoint& d) {
+    if (segmentsIntersect(a, b, c, d)) {
+        return 0.0;
+    }
+    return std::min(std::min(pointSegmentDistance(a, c, d), pointSegmentDistance(b, c, d)),
+                    std::min(pointSegmentDistance(c, a, b), pointSegmentDistance(d, a, b)));
+}
+
+/**
+ * @brief 几何对象的全部线段（点退化为长度为 0 的线段）
+ */
+QVector<QPair<GeoPoint, GeoPoint>> segmentsOf(const QVector<QVector<GeoPoint>>& parts) {
+    QVector<QPair<GeoPoint, GeoPoint>> segments;
+    for (const QVector<GeoPoint>& part : parts) {
+        if (part.size() == 1) {
+            segments.append(qMakePair(part[0], part[0]));
+            continue;
+        }
+        for (int i = 1; i < part.size(); ++i) {
+            segments.append(qMakePair(part[i - 1], part[i]));
+        }
+    }
+    return segments;
+}
+
+} // namespace
+
+// ============ BoundingBox ============
+
+BoundingBox::BoundingBox(double x1, double y1, double x2, double y2)
+    : minX(std::min(x1, x2))
+    , minY(std::min(y1, y2))
+    , maxX(std::max(x1, x2))
+    , maxY(std::max(y1, y2)) {
+}
+
+BoundingBox BoundingBox::united(const BoundingBox& other) const {
+    BoundingBox result = *this;
+    result.expand(other);
+    return result;
+}
+
+void BoundingBox::expand(const BoundingBox& other) {
+    minX = std::min(minX, other.minX);
+    minY = std::min(minY, other.minY);
+    maxX = std::max(maxX, other.maxX);
+    maxY = std::max(maxY, other.maxY);
+}
+
+BoundingBox BoundingBox::grown(double distance) const {
+    return BoundingBox(minX - distance, minY - distance, maxX + distance, maxY + distance);
+}
+
+bool BoundingBox::intersects(const BoundingBox& other) const {
+    return minX <= other.maxX && other.minX <= maxX && minY <= other.maxY && other.minY <= maxY;
+}
+
+bool BoundingBox::contains(const BoundingBox& other) const {
+    return minX <= other.minX && other.maxX <= maxX && minY <= other.minY && other.maxY <= maxY;
+}
+
+double BoundingBox::overlap(const BoundingBox& other) const {
+    const double width = std::min(maxX, other.maxX) - std::max(minX, other.minX);
+    const double height = std::min(maxY, other.maxY) - std::max(minY, other.minY);
+    return (width > 0.0 && height > 0.0) ? width * height : 0.0;
+}
+
+double BoundingBox::distanceTo(const BoundingBox& other) const {
+    const double dx = std::max(0.0, std::max(other.minX - maxX, minX - other.maxX));
+    const double dy = std::max(0.0, std::max(other.minY - maxY, minY - other.maxY));
+    return std::hypot(dx, dy);
+}
+
+bool BoundingBox::operator==(const BoundingBox& other) const {
+    return minX == other.minX && minY == other.minY && maxX == other.maxX && maxY == other.maxY;
+}
+
+// ============ Geometry ============
+
+Geometry Geometry::point(double x, double y) {
+    Geometry geometry;
+    geometry.type_ = Type::POINT;
+    geometry.parts_.append(QVector<GeoPoint>{GeoPoint{x, y}});
+    return geometry;
+}
+
+Geometry Geometry::envelope(const BoundingBox& box) {
+    Geometry geometry;
+    geometry.type_ = Type::POLYGON;
+    geometry.parts_.append(QVector<GeoPoint>{
+        GeoPoint{box.minX, box.minY}, GeoPoint{box.maxX, box.minY},
+        GeoPoint{box.maxX, box.maxY}, GeoPoint{box.minX, box.maxY},
+        GeoPoint{box.minX, box.minY}});
+    return geometry;
+}
+
+bool Geometry::fromWkt(const QString& wkt, Geometry& out) {
+    const QString text = wkt.trimmed();
+    int nameEnd = 0;
+    while (nameEnd < text.size() && text[nameEnd].isLetter()) {
+        ++nameEnd;
+    }
+    const QString typeName = text.left(nameEnd).toUpper();
+
+    QString body;
+    if (!stripParens(text.mid(nameEnd), body)) {
+        return false;
+    }
+
+    Geometry geometry;
+    if (typeName == "POINT") {
+        QVector<GeoPoint> points;
+        if (!parseCoordinates(body, points) || points.size() != 1) {
+            return false;
+        }
+        geometry.type_ = Type::POINT;
+        geometry.parts_.append(points);
+    } else if (typeName == "LINESTRING") {
+        QVector<GeoPoint> points;
+        if (!parseCoordinates(body, points) || points.size() < 2) {
+            return false;
+        }
+        geometry.type_ = Type::LINESTRING;
+        geometry.parts_.append(points);
+    } else if (typeName == "POLYGON") {
+        // 每个环是一对括号；环之间只能有逗号和空白
+        geometry.type_ = Type::POLYGON;
+        int pos = 0;
+        while (pos < body.size()) {
+            const QChar c = body[pos];
+            if (c.isSpace() || (c == ',' && !geometry.parts_.isEmpty())) {
+                ++pos;
+                continue;
+            }
+            if (c != '(') {
+                return false;
+            }
+            const int close = body.indexOf(')', pos);
+            if (close < 0) {
+                return false;
+            }
+            QVector<GeoPoint> ring;
+            if (!parseCoordinates(body.mid(pos + 1, close - pos - 1), ring) || !isClosedRing(ring)) {
+                return false;
+            }
+            geometry.parts_.append(ring);
+            pos = close + 1;
+        }
+        if (geometry.parts_.isEmpty()) {
+            return false;
+        }
+    } else {
+        return false;
+    }
+
+    out = geometry;
+    return true;
+}
+
+bool Geometry::fromWkb(const QByteArray& wkb, Geometry& out) {
+    if (wkb.size() < 5) {
+        return false;
+    }
+
+    QDataStream stream(wkb);
+    uint8_t byteOrder = 0;
+    stream >> byteOrder;
+    stream.setByteOrder(byteOrder == 1 ? QDataStream::LittleEndian : QDataStream::BigEndian);
+
+    uint32_t typeCode = 0;
+    stream >> typeCode;
+
+    // 每个点 16 字节，按剩余字节数限制点数，损坏的数据不会触发巨大的分配
+    auto readPoints = [&](QVector<GeoPoint>& points) {
+        uint32_t count = 0;
+        stream >> count;
+        if (stream.status() != QDataStream::Ok || count > static_cast<uint32_t>(wkb.size() / 16)) {
+            return false;
+        }
+        points.reserve(static_cast<int>(count));
+        for (uint32_t i = 0; i < count; ++i) {
+            GeoPoint p;
+            stream >> p.x >> p.y;
+            points.append(p);
+        }
+        return stream.status() == QDataStream::Ok;
+    };
+
+    Geometry geometry;
+    switch (typeCode) {
+        case static_cast<uint32_t>(Type::POINT): {
+            GeoPoint p;
+            stream >> p.x >> p.y;
+            geometry.type_ = Type::POINT;
+            geometry.parts_.append(QVector<GeoPoint>{p});
+            break;
+        }
+        case static_cast<uint32_t>(Type::LINESTRING): {
+            QVector<GeoPoint> points;
+            if (!readPoints(points) || points.size() < 2) {
+                return false;
+            }
+            geometry.type_ = Type::LINESTRING;
+            geometry.parts_.append(points);
+            break;
+        }
+        case static_cast<uint32_t>(Type::POLYGON): {
+            uint32_t ringCount = 0;
+            stream >> ringCount;
+            if (stream.status() != QDataStream::Ok || ringCount == 0 ||
+                ringCount > static_cast<uint32_t>(wkb.size() / 4)) {
+                return false;
+            }
+            geometry.type_ = Type::POLYGON;
+            for (uint32_t i = 0; i < ringCount; ++i) {
+                QVector<GeoPoint> ring;
+                if (!readPoints(ring) || !isClosedRing(ring)) {
+                    return false;
+                }
+                geometry.parts_.append(ring);
+            }
+            break;
+        }
+        default:
+            return false;
+    }
+
+    if (stream.status() != QDataStream::Ok) {
+        return false;
+    }
+    out = geometry;
+    return true;
+}
+
+bool Geometry::fromValue(const QVariant& value, Geometry& out) {
+    if (value.isNull()) {
+        return false;
+    }
+    return fromWkt(value.toString(), out);
+}
+
+QString Geometry::toWkt() const {
+    switch (type_) {
+        case Type::POINT:
+            return QString("POINT(%1)").arg(formatPoints(parts_.value(0)));
+        case Type::LINESTRING:
+            return QString("LINESTRING(%1)").arg(formatPoints(parts_.value(0)));
+        case Type::POLYGON: {
+            QStringList rings;
+            for (const QVector<GeoPoint>& ring : parts_) {
+                rings.append(QString("(%1)").arg(formatPoints(ring)));
+            }
+            return QString("POLYGON(%1)").arg(rings.join(", "));
+        }
+    }
+    return QString();
+}
+
+QByteArray Geometry::toWkb() const {
+    QByteArray wkb;
+    QDataStream stream(&wkb, QIODevice::WriteOnly);
+    stream.setByteOrder(QDataStream::LittleEndian);
+
+    stream << static_cast<uint8_t>(1);  // Little Endian
+    stream << static_cast<uint32_t>(type_);
+
+    auto writePoints = [&stream](const QVector<GeoPoint>& points, bool withCount) {
+        if (withCount) {
+            stream << static_cast<uint32_t>(points.size());
+        }
+        for (const GeoPoint& p : points) {
+            stream << p.x << p.y;
+        }
+    };
+
+    if (type_ == Type::POLYGON) {
+        stream << static_cast<uint32_t>(parts_.size());
+        for (const QVector<GeoPoint>& ring : parts_) {
+            writePoints(ring, true);
+        }
+    } else {
+        writePoints(parts_.value(0), type_ == Type::LINESTRING);
+    }
+    return wkb;
+}
+
+BoundingBox Geometry::bounds() const {
+    bool first = true;
+    BoundingBox box;
+    for (const QVector<GeoPoint>& part : parts_) {
+        for (const GeoPoint& p : part) {
+            if (first) {
+                box = BoundingBox::ofPoint(p.x, p.y);
+                first = false;
+            } else {
+                box.expand(BoundingBox::ofPoint(p.x, p.y));
+            }
+        }
+    }
+    return box;
+}
+
+bool Geometry::containsPoint(const GeoPoint& p) const {
+    if (type_ != Type::POLYGON) {
+        return false;
+    }
+
+    // 射线法：向 +x 方向的射线与所有环的交点个数为奇数时在内部（洞内为偶数）
+    bool inside = false;
+    for (const QVector<GeoPoint>& ring : parts_) {
+        for (int i = 1; i < ring.size(); ++i) {
+            const GeoPoint& a = ring[i - 1];
+            const GeoPoint& b = ring[i];
+            if ((a.y > p.y) != (b.y > p.y)) {
+                const double xCross = a.x + (p.y - a.y) * (b.x - a.x) / (b.y - a.y);
+                if (p.x < xCross) {
+                    inside = !inside;
+                }
+            }
+        }
+    }
+    return inside;
+}
+
+double Geometry::distance(const Geometry& other) const {
+    if (parts_.isEmpty() || other.parts_.isEmpty()) {
+        return std::numeric_limits<double>::infinity();
+    }
+
+    // 一个在另一个多边形内部（不与边界相交时只需检查任一顶点）
+    if (containsPoint(other.parts_[0][0]) || other.containsPoint(parts_[0][0])) {
+        return 0.0;
+    }
+
+    const auto segments = segmentsOf(parts_);
+    const auto otherSegments = segmentsOf(other.parts_);
+    double best = std::numeric_limits<double>::infinity();
+    for (const auto& s : segments) {
+        for (const auto& t : otherSegments) {
+            best = std::min(best, segmentDistance(s.first, s.second, t.first, t.second));
+            if (best == 0.0) {
+                return 0.0;
+            }
+        }
+    }
+    return best;
+}
+
+} // namespace qindb
@@ -0,0 +1,161 @@
+#include "qindb/hash_util.h"
+#include <QCryptographicHash>
+#include <QRandomGenerator>
+#include <bit>
+#include <cstring>
+
+#if defined(_MSC_VER) && defined(_M_X64) && !defined(__clang__)
+#include <intrin.h>
+#endif
+
+namespace qindb {
+
+namespace {
+
+// wyhash 的默认密钥
+constexpr uint64_t WY_SECRET[4] = {
+    0x2d358dccaa6c78a5ULL, 0x8bb84b93962eacc9ULL, 0x4b33a62ed433d4a3ULL, 0x4d5a2da51de1aa47ULL
+};
+
+/**
+ * @brief 64x64→128 位乘法，*a 得到低 64 位，*b 得到高 64 位
+ */
+inline void wyMum(uint64_t* a, uint64_t* b) {
+#if defined(__SIZEOF_INT128__)
+    __uint128_t r = static_cast<__uint128_t>(*a) * *b;
+    *a = static_cast<uint64_t>(r);
+    *b = static_cast<uint64_t>(r >> 64);
+#elif defined(_MSC_VER) && defined(_M_X64) && !defined(__clang__)
+    *a = _umul128(*a, *b, b);
+#else
+    const uint64_t ha = *a >> 32, hb = *b >> 32;
+    const uint64_t la = static_cast<uint32_t>(*a), lb = static_cast<uint32_t>(*b);
+    const uint64_t rh = ha * hb, rm0 = ha * lb, rm1 = hb * la, rl = la * lb;
+    const uint64_t t = rl + (rm0 << 32);
+    uint64_t carry = t < rl ? 1 : 0;
+    const uint64_t lo = t + (rm1 << 32);
+    carry += lo < t ? 1 : 0;
+    *a = lo;
+    *b = rh + (rm0 >> 32) + (rm1 >> 32) + carry;
+#endif
+}
+
+inline uint64_t wyMix(uint64_t a, uint64_t b) {
+    wyMum(&a, &b);
+    return a ^ b;
+}
+
+inline uint64_t byteSwap64(uint64_t v) {
+    v = ((v & 0x00FF00FF00FF00FFULL) << 8) | ((v >> 8) & 0x00FF00FF00FF00FFULL);
+    v = ((v & 0x0000FFFF0000FFFFULL) << 16) | ((v >> 16) & 0x0000FFFF0000FFFFULL);
+    return (v << 32) | (v >> 32);
+}
+
+// 按小端读取，保证持久化的哈希值与平台无关
+inline uint64_t read64(const uint8_t* p) {
+    uint64_t v;
+    std::memcpy(&v, p, sizeof(v));
+    if constexpr (std::endian::native == std::endian::big) {
+        v = byteSwap64(v);
+    }
+    return v;
+}
+
+inline uint64_t read32(const uint8_t* p) {
+    uint32_t v;
+    std::memcpy(&v, p, sizeof(v));
+    if constexpr (std::endian::native == std::endian::big) {
+        v = static_cast<uint32_t>(byteSwap64(v) >> 32);
+    }
+    return v;
+}
+
+inline uint64_t read3(const uint8_t* p, size_t k) {
+    return (static_cast<uint64_t>(p[0]) << 16) | (static_cast<uint64_t>(p[k >> 1]) << 8) | p[k - 1];
+}
+
+} // namespace
+
+uint64_t HashUtil::hashBytes(const void* data, size_t len, uint64_t seed) {
+    const uint8_t* p = static_cast<const uint8_t*>(data);
+    seed ^= wyMix(seed ^ WY_SECRET[0], WY_SECRET[1]);
+    uint64_t a;
+    uint64_t b;
+
+    if (len <= 16) {
+        if (len >= 4) {
+            a = (read32(p) << 32) | read32(p + ((len >> 3) << 2));
+            b = (read32(p + len - 4) << 32) | read32(p + len - 4 - ((len >> 3) << 2));
+        } else if (len > 0) {
+            a = read3(p, len);
+            b = 0;
+        } else {
+            a = b = 0;
+        }
+    } else {
+        size_t i = len;
+        if (i >= 48) {
+            uint64_t see1 = seed;
+            uint64_t see2 = seed;
+            do {
+                seed = wyMix(read64(p) ^ WY_SECRET[1], read64(p + 8) ^ seed);
+                see1 = wyMix(read64(p + 16) ^ WY_SECRET[2], read64(p + 24) ^ see1);
+                see2 = wyMix(read64(p + 32) ^ WY_SECRET[3], read64(p + 40) ^ see2);
+                p += 48;
+                i -= 48;
+            } while (i >= 48);
+            seed ^= see1 ^ see2;
+        }
+        while (i > 16) {
+            seed = wyMix(read64(p) ^ WY_SECRET[1], read64(p + 8) ^ seed);
+            i -= 16;
+            p += 16;
+        }
+        a = read64(p + i - 16);
+        b = read64(p + i - 8);
+    }
+
+    a ^= WY_SECRET[1];
+    b ^= seed;
+    wyMum(&a, &b);
+    return wyMix(a ^ WY_SECRET[0] ^ len, b ^ WY_SECRET[1]);
+}
+
+uint64_t HashUtil::hashInt(uint64_t value, uint64_t seed) {
+    uint64_t a = value ^ WY_SECRET[0];
+    uint64_t b = seed ^ WY_SECRET[1];
+    wyMum(&a, &b);
+    return wyMix(a ^ WY_SECRET[0], b ^ WY_SECRET[1]);
+}
+
+uint64_t HashUtil::combine(uint64_t h1, uint64_t h2) {
+    return wyMix(h1 ^ WY_SECRET[2], h2 ^ WY_SECRET[3]);
+}
+
+uint32_t HashUtil::hash32(HashFunction function, const QByteArray& data, uint64_t seed) {
+    switch (function) {
+        case HashFunction::SHA256: {
+            QByteArray digest = QCryptographicHash::hash(data, QCryptographicHash::Sha256);
+            uint32_t value;
+            std::memcpy(&value, digest.constData(), sizeof(value));
+            return value;
+        }
+        case HashFunction::WYHASH:
+        default: {
+            // 高低 32 位折叠，桶地址只取低位
+            uint64_t h = hashBytes(data, seed);
+            return static_cast<uint32_t>(h ^ (h >> 32));
+        }
+    }
+}
+
+bool HashUtil::isKnownFunction(uint32_t id) {
+    return id == static_cast<uint32_t>(HashFunction::SHA256) ||
+           id == static_cast<uint32_t>(HashFunction::WYHASH);
+}
+
+uint64_t HashUtil::randomSeed() {
+    return QRandomGenerator::global()->generate64();
+}
+
+} // namespace qindb
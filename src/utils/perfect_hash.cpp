@@ -0,0 +1,143 @@
+#include "qindb/perfect_hash.h"
+#include "qindb/hash_util.h"
+#include "qindb/logger.h"
+#include <QSet>
+#include <algorithm>
+#include <bit>
+
+namespace qindb {
+
+PerfectHash::PerfectHash()
+    : seed_(HashUtil::DEFAULT_SEED)
+    , slotMask_(0)
+{
+}
+
+uint64_t PerfectHash::hash(const QChar* data, qsizetype length) const {
+    return HashUtil::hashBytes(data, static_cast<size_t>(length) * sizeof(QChar), seed_);
+}
+
+uint32_t PerfectHash::bucketOf(uint64_t h) const {
+    // 桶号与槽位参数 (f1, f2) 取自同一个哈希值，再混合一次避免相关
+    uint64_t mixed = (h ^ (h >> 29)) * 0xBF58476D1CE4E5B9ULL;
+    return static_cast<uint32_t>(mixed >> 32) % static_cast<uint32_t>(displacements_.size());
+}
+
+bool PerfectHash::build(const QStringList& keys) {
+    pool_.clear();
+    keys_.clear();
+
+    QSet<QString> seen;
+    for (const QString& key : keys) {
+        if (seen.contains(key)) {
+            continue;
+        }
+        seen.insert(key);
+        keys_.append(qMakePair(static_cast<uint32_t>(pool_.size()), static_cast<uint32_t>(key.size())));
+        pool_.append(key);
+    }
+
+    if (keys_.size() >= static_cast<qsizetype>(EMPTY_SLOT / 2)) {
+        LOG_ERROR(QString("Too many keys for perfect hash: %1").arg(keys_.size()));
+        return false;
+    }
+
+    seed_ = HashUtil::DEFAULT_SEED;
+    for (int attempt = 0; attempt < MAX_ATTEMPTS; ++attempt) {
+        if (tryBuild()) {
+            return true;
+        }
+        seed_ = HashUtil::hashInt(seed_ + static_cast<uint64_t>(attempt) + 1);
+    }
+
+    LOG_ERROR(QString("Failed to build perfect hash for %1 keys").arg(keys_.size()));
+    displacements_.clear();
+    slots_.clear();
+    return false;
+}
+
+bool PerfectHash::tryBuild() {
+    const uint32_t n = static_cast<uint32_t>(keys_.size());
+
+    // 装载因子不超过 0.8，平均每桶 4 个键
+    const uint32_t slotCount = std::bit_ceil(std::max<uint32_t>(8, n + n / 4 + 1));
+    const uint32_t bucketCount = std::max<uint32_t>(1, n / 4);
+    slotMask_ = slotCount - 1;
+    slots_.fill(EMPTY_SLOT, static_cast<qsizetype>(slotCount));
+    displacements_.fill(0, static_cast<qsizetype>(bucketCount));
+
+    QVector<uint64_t> hashes(static_cast<qsizetype>(n));
+    QVector<QVector<uint32_t>> buckets(static_cast<qsizetype>(bucketCount));
+    for (uint32_t i = 0; i < n; ++i) {
+        hashes[i] = hash(pool_.constData() + keys_[i].first, keys_[i].second);
+        buckets[bucketOf(hashes[i])].append(i);
+    }
+
+    QVector<uint32_t> order(static_cast<qsizetype>(bucketCount));
+    for (uint32_t b = 0; b < bucketCount; ++b) {
+        order[b] = b;
+    }
+    std::stable_sort(order.begin(), order.end(), [&buckets](uint32_t a, uint32_t b) {
+        return buckets[a].size() > buckets[b].size();
+    });
+
+    QVector<uint32_t> placed;
+    for (uint32_t b : order) {
+        const QVector<uint32_t>& bucket = buckets[b];
+        if (bucket.isEmpty()) {
+            break;
+        }
+
+        bool found = false;
+        for (uint32_t d = 0; d < slotCount && !found; ++d) {
+            placed.clear();
+            bool ok = true;
+            for (uint32_t key : bucket) {
+                const uint64_t h = hashes[key];
+                const uint32_t f1 = static_cast<uint32_t>(h);
+                const uint32_t f2 = static_cast<uint32_t>(h >> 32) | 1u;
+                const uint32_t slot = (f1 + d * f2) & slotMask_;
+                if (slots_[slot] != EMPTY_SLOT || placed.contains(slot)) {
+                    ok = false;
+                    break;
+                }
+                placed.append(slot);
+            }
+            if (ok) {
+                for (int k = 0; k < bucket.size(); ++k) {
+                    slots_[placed[k]] = bucket[k];
+                }
+                displacements_[b] = d;
+                found = true;
+            }
+        }
+        if (!found) {
+            return false;
+        }
+    }
+    return true;
+}
+
+int PerfectHash::find(const QChar* data, qsizetype length) const {
+    if (slots_.isEmpty()) {
+        return -1;
+    }
+
+    const uint64_t h = hash(data, length);
+    const uint32_t f1 = static_cast<uint32_t>(h);
+    const uint32_t f2 = static_cast<uint32_t>(h >> 32) | 1u;
+    const uint32_t slot = (f1 + displacements_[bucketOf(h)] * f2) & slotMask_;
+
+    const uint32_t key = slots_[slot];
+    if (key == EMPTY_SLOT || keys_[key].second != static_cast<uint32_t>(length)) {
+        return -1;
+    }
+    const QChar* stored = pool_.constData() + keys_[key].first;
+    return std::equal(data, data + length, stored) ? static_cast<int>(key) : -1;
+}
+
+QStringView PerfectHash::keyAt(int index) const {
+    return QStringView(pool_.constData() + keys_[index].first, static_cast<qsizetype>(keys_[index].second));
+}
+
+} // namespace qindb
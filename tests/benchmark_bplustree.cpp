@@ -62,6 +62,7 @@ public:
         benchmarkRandomSearch();     // 随机查询性能测试
         benchmarkRangeSearch();      // 范围查询性能测试
         benchmarkMixedOperations();  // 混合操作性能测试
+        benchmarkStringKeys();       // 字符串键（前缀压缩）性能测试
     }
 
 private:
@@ -186,6 +187,59 @@ private:
         });
     }
 
+    /**
+     * @brief 字符串键性能测试
+     * 使用带长公共前缀的 URL/邮箱键，观察前缀压缩和后缀截断后的树规模
+     */
+    void benchmarkStringKeys() {
+        const int COUNT = 20000;
+        std::vector<QString> urls;
+        std::vector<QString> emails;
+        urls.reserve(COUNT);
+        emails.reserve(COUNT);
+        for (int i = 0; i < COUNT; ++i) {
+            urls.push_back(QString("https://www.example-shop.com/catalog/products/electronics/category-%1/detail/item-%2.html")
+                               .arg(i % 50, 3, 10, QChar('0')).arg(i, 8, 10, QChar('0')));
+            emails.push_back(QString("user.%1@mail.example-corporation.com").arg(i, 8, 10, QChar('0')));
+        }
+
+        std::random_device rd;
+        std::mt19937 g(rd());
+        std::shuffle(urls.begin(), urls.end(), g);
+
+        GenericBPlusTree urlTree(bufferPool_, DataType::VARCHAR);
+        runBatchBenchmark("String Insert (20K URL keys)", COUNT, [&]() {
+            for (int i = 0; i < COUNT; ++i) {
+                urlTree.insert(QVariant(urls[i]), i + 1);
+            }
+        });
+        GenericBPlusTree::Stats urlStats = urlTree.getStats();
+        addInfo(QString("leaf pages: %1, internal pages: %2, height: %3, raw key bytes: %4")
+                    .arg(urlStats.numLeafPages).arg(urlStats.numInternalPages)
+                    .arg(urlStats.treeHeight).arg(urlStats.totalKeySize));
+
+        runBatchBenchmark("String Search (20K URL keys)", COUNT, [&]() {
+            for (int i = 0; i < COUNT; ++i) {
+                RowId value;
+                urlTree.search(QVariant(urls[i]), value);
+            }
+        });
+
+        GenericBPlusTree emailTree(bufferPool_, DataType::VARCHAR);
+        QVector<QPair<QVariant, RowId>> entries;
+        entries.reserve(COUNT);
+        for (int i = 0; i < COUNT; ++i) {
+            entries.append(qMakePair(QVariant(emails[i]), static_cast<RowId>(i + 1)));
+        }
+        runBatchBenchmark("String Bulk Load (20K email keys)", COUNT, [&]() {
+            emailTree.bulkLoad(entries, 1.0);
+        });
+        GenericBPlusTree::Stats emailStats = emailTree.getStats();
+        addInfo(QString("leaf pages: %1, internal pages: %2, height: %3, raw key bytes: %4")
+                    .arg(emailStats.numLeafPages).arg(emailStats.numInternalPages)
+                    .arg(emailStats.treeHeight).arg(emailStats.totalKeySize));
+    }
+
     QTemporaryFile* tempFile_;
     QString dbPath_;
     DiskManager* diskMgr_;
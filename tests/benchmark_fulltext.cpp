@@ -0,0 +1,217 @@
+#include "benchmark_framework.h"
+#include "qindb/logger.h"
+#include "qindb/inverted_index.h"
+#include "qindb/buffer_pool_manager.h"
+#include "qindb/disk_manager.h"
+#include <QTemporaryFile>
+#include <cmath>
+#include <random>
+#include <vector>
+
+namespace qindb {
+namespace benchmark {
+
+/**
+ * @brief 全文检索 top-k 性能测试
+ *
+ * 按 Zipf 分布生成词表和文档写成段，同一组查询分别用 limit = 10（Block-Max WAND）
+ * 和 limit = 0（对所有倒排项打分后排序）执行，另测同一组查询的 AND 求交
+ */
+class FullTextBenchmark : public Benchmark {
+public:
+    FullTextBenchmark() : Benchmark("Full-Text Top-K Search") {}
+
+    void run() override {
+        const int NUM_DOCS = 200000;
+        const int VOCABULARY = 5000;
+        const int QUERIES = 50;
+
+        QTemporaryFile tempFile;
+        tempFile.setAutoRemove(true);
+        if (!tempFile.open()) {
+            LOG_ERROR("Failed to open temporary file");
+            return;
+        }
+        QString dbPath = tempFile.fileName();
+        tempFile.close();
+
+        DiskManager diskMgr(dbPath);
+        BufferPoolManager bufferPool(8192, &diskMgr);
+        InvertedIndex index("bench_fulltext", &bufferPool);
+
+        // 词表：纯字母（分词器只把连续字母当作词），按 Zipf 分布抽样
+        QStringList vocabulary;
+        for (int i = 0; i < VOCABULARY; ++i) {
+            QString word = "w";
+            int n = i;
+            do {
+                word += QChar('a' + n % 26);
+                n /= 26;
+            } while (n > 0);
+            vocabulary.append(word);
+        }
+        std::vector<double> weights(VOCABULARY);
+        for (int i = 0; i < VOCABULARY; ++i) {
+            weights[i] = 1.0 / std::pow(i + 1.0, 0.9);
+        }
+        std::discrete_distribution<int> zipf(weights.begin(), weights.end());
+
+        std::mt19937 rng(42);
+        for (int docId = 1; docId <= NUM_DOCS; ++docId) {
+            int length = 20 + static_cast<int>(rng() % 180);
+            QStringList words;
+            for (int i = 0; i < length; ++i) {
+                words.append(vocabulary[zipf(rng)]);
+            }
+            index.insert(static_cast<RowId>(docId), words.join(' '));
+        }
+        index.flush();
+
+        // 查询由一个高频词和一到两个中低频词组成
+        std::vector<QStringList> queries;
+        for (int i = 0; i < QUERIES; ++i) {
+            QStringList terms;
+            terms.append(vocabulary[rng() % 10]);
+            terms.append(vocabulary[10 + rng() % 200]);
+            if (i % 2 == 0) {
+                terms.append(vocabulary[200 + rng() % 2000]);
+            }
+            queries.push_back(terms);
+        }
+
+        int found = 0;
+        runBatchBenchmark("Top-10 OR search, Block-Max WAND (200K docs, 50 queries)", QUERIES, [&]() {
+            for (const QStringList& terms : queries) {
+                found += index.searchOr(terms, 10).size();
+            }
+        });
+        addInfo(QString("results=%1").arg(found));
+
+        found = 0;
+        runBatchBenchmark("Top-10 OR search, exhaustive scoring (200K docs, 50 queries)", QUERIES, [&]() {
+            for (const QStringList& terms : queries) {
+                QVector<SearchResult> results = index.searchOr(terms);
+                found += std::min<int>(10, static_cast<int>(results.size()));
+            }
+        });
+
+        // AND：按文档频率从低到高求交，长列表靠跳表和galloping跳过
+        found = 0;
+        runBatchBenchmark("AND search, skip tables + galloping (200K docs, 50 queries)", QUERIES, [&]() {
+            for (const QStringList& terms : queries) {
+                found += index.searchAnd(terms).size();
+            }
+        });
+        addInfo(QString("results=%1").arg(found));
+
+        InvertedIndex::Statistics stats = index.getStatistics();
+        addInfo(QString("results=%1, segments=%2, postings=%3")
+                    .arg(found).arg(stats.numSegments).arg(stats.totalPostings));
+    }
+};
+
+/**
+ * @brief 分词吞吐和索引规模
+ *
+ * 中英文混合的文档分别走 tokenizeSpans（复用缓冲区，不为词项分配 QString）
+ * 和 tokenizeWithDuplicates，按输入的 UTF-16 字节数计算 MB/s；
+ * 再对比开启和关闭中文切词时同一批文档的词项数和倒排项数
+ */
+class TokenizerBenchmark : public Benchmark {
+public:
+    TokenizerBenchmark() : Benchmark("Tokenizer Throughput") {}
+
+    void run() override {
+        const int NUM_DOCS = 20000;
+
+        const QStringList chineseWords = {
+            "数据库", "查询", "优化", "存储", "引擎", "索引", "事务", "日志", "缓存", "内存",
+            "磁盘", "页面", "记录", "并发", "性能", "系统", "用户", "数据", "分析", "的",
+            "是", "一个", "我们", "可以", "通过", "支持", "实现", "全文检索", "分词", "压缩"
+        };
+        const QStringList englishWords = {
+            "btree", "page", "buffer", "query", "index", "the", "of", "join", "scan", "cost"
+        };
+
+        std::mt19937 rng(7);
+        QStringList documents;
+        qint64 totalBytes = 0;
+        for (int i = 0; i < NUM_DOCS; ++i) {
+            QString text;
+            int length = 20 + static_cast<int>(rng() % 60);
+            for (int w = 0; w < length; ++w) {
+                if (rng() % 4 == 0) {
+                    text += ' ';
+                    text += englishWords[rng() % englishWords.size()];
+                    text += ' ';
+                } else {
+                    text += chineseWords[rng() % chineseWords.size()];
+                }
+                if (rng() % 10 == 0) {
+                    text += QString::fromUtf8("，");
+                }
+            }
+            totalBytes += text.size() * static_cast<qint64>(sizeof(QChar));
+            documents.append(text);
+        }
+        const double megabytes = totalBytes / (1024.0 * 1024.0);
+
+        Tokenizer tokenizer;
+        qint64 tokenCount = 0;
+
+        QString folded;
+        QVector<Tokenizer::TokenSpan> spans;
+        runBatchBenchmark("Tokenize to spans (mixed text)", NUM_DOCS, [&]() {
+            for (const QString& text : documents) {
+                tokenizer.tokenizeSpans(text, folded, spans);
+                tokenCount += spans.size();
+            }
+        });
+        addInfo(throughput(megabytes, tokenCount));
+
+        tokenCount = 0;
+        runBatchBenchmark("Tokenize to QStringList (mixed text)", NUM_DOCS, [&]() {
+            for (const QString& text : documents) {
+                tokenCount += tokenizer.tokenizeWithDuplicates(text).size();
+            }
+        });
+        addInfo(throughput(megabytes, tokenCount));
+
+        tokenizer.setSegmentationEnabled(false);
+        tokenCount = 0;
+        runBatchBenchmark("Tokenize to spans, single-character Chinese", NUM_DOCS, [&]() {
+            for (const QString& text : documents) {
+                tokenizer.tokenizeSpans(text, folded, spans);
+                tokenCount += spans.size();
+            }
+        });
+        addInfo(throughput(megabytes, tokenCount));
+
+        // 切词后一个词一个词项，倒排项和位置都随之减少
+        for (bool segmentation : {true, false}) {
+            tokenizer.setSegmentationEnabled(segmentation);
+            InvertedIndex index("bench_tokenizer", nullptr, &tokenizer);
+            runBatchBenchmark(segmentation ? "Index mixed text, dictionary segmentation"
+                                           : "Index mixed text, single-character Chinese",
+                              NUM_DOCS, [&]() {
+                for (int i = 0; i < documents.size(); ++i) {
+                    index.insert(static_cast<RowId>(i + 1), documents[i]);
+                }
+            });
+            InvertedIndex::Statistics stats = index.getStatistics();
+            addInfo(QString("terms=%1, postings=%2, avgDocLength=%3")
+                        .arg(stats.numTerms).arg(stats.totalPostings).arg(stats.avgDocLength, 0, 'f', 1));
+        }
+    }
+
+private:
+    QString throughput(double megabytes, qint64 tokens) const {
+        const double seconds = getResults().last().totalTimeMs / 1000.0;
+        return QString("%1 MB/s, tokens=%2")
+            .arg(seconds > 0 ? megabytes / seconds : 0.0, 0, 'f', 1)
+            .arg(tokens);
+    }
+};
+
+} // namespace benchmark
+} // namespace qindb
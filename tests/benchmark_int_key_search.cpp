@@ -0,0 +1,137 @@
+#include "benchmark_framework.h"
+#include "qindb/logger.h"
+#include "qindb/bplus_tree.h"
+#include "qindb/int_key_search.h"
+#include "qindb/buffer_pool_manager.h"
+#include "qindb/disk_manager.h"
+#include <QTemporaryFile>
+#include <random>
+#include <vector>
+
+namespace qindb {
+namespace benchmark {
+
+/**
+ * @brief 整数键节点内查找性能测试
+ *
+ * 1. 节点内查找：在与 BPlusTree 叶子页相同布局（16 字节条目）的数组上，
+ *    对比原来的线性扫描、标量二分查找和 IntKeySearch（无分支二分 + AVX2 窗口计数）
+ * 2. 整树查找：在 BPlusTree 上做随机点查
+ *    树的规模由环境变量 QINDB_BENCH_TREE_SIZES 指定（逗号分隔，默认 1000000），
+ *    例如 QINDB_BENCH_TREE_SIZES=1000000,10000000,100000000；
+ *    1 亿个键约需 2GB 页面，缓冲池按树的大小分配，请确认内存足够
+ */
+class IntKeySearchBenchmark : public Benchmark {
+public:
+    IntKeySearchBenchmark() : Benchmark("Integer Key Node Search") {}
+
+    void run() override {
+        benchmarkNodeSearch(200);   // BPlusTree 默认阶
+        benchmarkNodeSearch(509);   // 一页能放下的最多条目数：(8192 - 48) / 16
+        benchmarkTreeLookups();
+    }
+
+private:
+    void benchmarkNodeSearch(int nodeKeys) {
+        const int QUERIES = 1000000;
+
+        std::vector<BPlusTreeEntry> node(nodeKeys);
+        for (int i = 0; i < nodeKeys; ++i) {
+            node[i] = BPlusTreeEntry(static_cast<int64_t>(i) * 16, i + 1);
+        }
+        const char* base = reinterpret_cast<const char*>(node.data());
+
+        std::mt19937_64 rng(42);
+        std::vector<int64_t> queries(QUERIES);
+        for (auto& q : queries) {
+            q = static_cast<int64_t>(rng() % (static_cast<uint64_t>(nodeKeys) * 16));
+        }
+
+        // 防止编译器把查找优化掉
+        volatile int64_t sink = 0;
+
+        runBatchBenchmark(QString("Linear scan (%1 keys/node, 1M queries)").arg(nodeKeys), QUERIES, [&]() {
+            int64_t total = 0;
+            for (int64_t q : queries) {
+                int pos = 0;
+                while (pos < nodeKeys && node[pos].key < q) {
+                    ++pos;
+                }
+                total += pos;
+            }
+            sink = total;
+        });
+
+        runBatchBenchmark(QString("Scalar binary search (%1 keys/node, 1M queries)").arg(nodeKeys), QUERIES, [&]() {
+            int64_t total = 0;
+            for (int64_t q : queries) {
+                total += IntKeySearch::lowerBoundScalar(base, nodeKeys, sizeof(BPlusTreeEntry), q);
+            }
+            sink = total;
+        });
+
+        runBatchBenchmark(QString("IntKeySearch (%1 keys/node, 1M queries)").arg(nodeKeys), QUERIES, [&]() {
+            int64_t total = 0;
+            for (int64_t q : queries) {
+                total += IntKeySearch::lowerBound(base, nodeKeys, sizeof(BPlusTreeEntry), q);
+            }
+            sink = total;
+        });
+        addInfo(QString("AVX2 %1").arg(IntKeySearch::isAvx2Enabled() ? "enabled" : "not available"));
+        Q_UNUSED(sink);
+    }
+
+    void benchmarkTreeLookups() {
+        QList<qint64> sizes;
+        const QString env = qEnvironmentVariable("QINDB_BENCH_TREE_SIZES", "1000000");
+        for (const QString& part : env.split(',', Qt::SkipEmptyParts)) {
+            bool ok = false;
+            qint64 n = part.trimmed().toLongLong(&ok);
+            if (ok && n > 0) {
+                sizes.append(n);
+            }
+        }
+
+        for (qint64 n : sizes) {
+            QTemporaryFile tempFile;
+            tempFile.setAutoRemove(true);
+            if (!tempFile.open()) {
+                LOG_ERROR("Failed to open temporary file");
+                return;
+            }
+            QString dbPath = tempFile.fileName();
+            tempFile.close();
+
+            // 缓冲池容纳整棵树，测量的是节点内查找而不是磁盘 I/O
+            const int order = 200;
+            size_t poolPages = static_cast<size_t>(n / (order / 2) + n / (order * order) + 1024);
+            DiskManager diskMgr(dbPath);
+            BufferPoolManager bufferPool(poolPages, &diskMgr);
+            BPlusTree tree(&bufferPool, INVALID_PAGE_ID, order);
+
+            for (qint64 i = 0; i < n; ++i) {
+                tree.insert(i * 2, static_cast<RowId>(i + 1));
+            }
+
+            const int QUERIES = 1000000;
+            std::mt19937_64 rng(7);
+            std::vector<int64_t> queries(QUERIES);
+            for (auto& q : queries) {
+                q = static_cast<int64_t>(rng() % static_cast<uint64_t>(n * 2));
+            }
+
+            int found = 0;
+            runBatchBenchmark(QString("BPlusTree random lookup (%1 keys, 1M queries)").arg(n), QUERIES, [&]() {
+                for (int64_t q : queries) {
+                    RowId value;
+                    found += tree.search(q, value) ? 1 : 0;
+                }
+            });
+            addInfo(QString("hits=%1, AVX2 %2").arg(found)
+                        .arg(IntKeySearch::isAvx2Enabled() ? "enabled" : "not available"));
+        }
+    }
+};
+
+} // namespace benchmark
+} // namespace qindb
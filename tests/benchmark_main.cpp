@@ -1,6 +1,9 @@
 #include "benchmark_framework.h"
 #include "benchmark_bplustree.cpp"
 #include "benchmark_buffer_pool.cpp"
+#include "benchmark_int_key_search.cpp"
+#include "benchmark_hash_index.cpp"
+#include "benchmark_fulltext.cpp"
 #include <QCoreApplication>
 
 using namespace qindb::benchmark;
@@ -14,9 +17,17 @@ int main(int argc, char *argv[]) {
     // 注册性能测试
     BPlusTreeBenchmark bptreeBench;
     BufferPoolBenchmark bufferPoolBench;
+    IntKeySearchBenchmark intKeySearchBench;
+    HashIndexBenchmark hashIndexBench;
+    FullTextBenchmark fullTextBench;
+    TokenizerBenchmark tokenizerBench;
 
     BenchmarkRunner::instance().registerBenchmark(&bptreeBench);
     BenchmarkRunner::instance().registerBenchmark(&bufferPoolBench);
+    BenchmarkRunner::instance().registerBenchmark(&intKeySearchBench);
+    BenchmarkRunner::instance().registerBenchmark(&hashIndexBench);
+    BenchmarkRunner::instance().registerBenchmark(&fullTextBench);
+    BenchmarkRunner::instance().registerBenchmark(&tokenizerBench);
 
     // 运行所有性能测试
     BenchmarkRunner::instance().runAll();
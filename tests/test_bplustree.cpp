@@ -1,9 +1,15 @@
 #include "test_framework.h"
 #include "qindb/generic_bplustree.h"
+#include "qindb/composite_index.h"
+#include "qindb/int_key_search.h"
 #include "qindb/buffer_pool_manager.h"
 #include "qindb/disk_manager.h"
 #include "qindb/config.h"
 #include <QTemporaryFile>
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <vector>
 
 namespace qindb {
 namespace test {
@@ -22,6 +28,12 @@ public:
         try { testRemove(); } catch (...) {}
         try { testRangeSearch(); } catch (...) {}
         try { testLargeDataset(); } catch (...) {}
+        try { testBulkLoad(); } catch (...) {}
+        try { testLongStringKeys(); } catch (...) {}
+        try { testNormalizedKeyOrder(); } catch (...) {}
+        try { testCompositeIndex(); } catch (...) {}
+        try { testCoveringIndex(); } catch (...) {}
+        try { testIntKeySearch(); } catch (...) {}
     }
 
 private:
@@ -261,6 +273,498 @@ private:
         addResult("testLargeDataset", true,
                  QString("Inserted and searched %1 keys").arg(COUNT), elapsed);
     }
+
+    /**
+     * @brief 测试自底向上批量构建
+     */
+    void testBulkLoad() {
+        startTimer();
+
+        QTemporaryFile tempFile;
+        tempFile.setAutoRemove(true);
+        assertTrue(tempFile.open());
+        QString dbPath = tempFile.fileName();
+        tempFile.close();
+
+        DiskManager diskMgr(dbPath);
+        Config& config = Config::instance();
+        BufferPoolManager bufferPool(config.getBufferPoolSize(), &diskMgr);
+
+        // 乱序输入，并包含一个重复键（保留最后出现的值）
+        const int COUNT = 10000;
+        QVector<QPair<QVariant, RowId>> entries;
+        for (int i = 0; i < COUNT; ++i) {
+            int key = (i * 7919) % COUNT + 1;
+            entries.append(qMakePair(QVariant(key), static_cast<RowId>(key)));
+        }
+        entries.append(qMakePair(QVariant(1), static_cast<RowId>(COUNT + 1)));
+
+        GenericBPlusTree bulkTree(&bufferPool, DataType::INT);
+        assertTrue(bulkTree.bulkLoad(entries, 1.0), "Bulk load failed");
+
+        // 点查
+        for (int i = 2; i <= COUNT; i += 37) {
+            RowId foundRowId = INVALID_ROW_ID;
+            assertTrue(bulkTree.search(QVariant(i), foundRowId),
+                       QString("Failed to find key %1 after bulk load").arg(i));
+            assertEqual(static_cast<RowId>(i), foundRowId);
+        }
+        RowId dupRowId = INVALID_ROW_ID;
+        assertTrue(bulkTree.search(QVariant(1), dupRowId));
+        assertEqual(static_cast<RowId>(COUNT + 1), dupRowId, "Duplicate key should keep last value");
+
+        // 叶子链表完整且有序
+        QVector<QPair<QVariant, RowId>> range;
+        assertTrue(bulkTree.rangeSearch(QVariant(1), QVariant(COUNT), range));
+        assertEqual(COUNT, static_cast<int>(range.size()), "Range scan should return all keys");
+        for (int i = 0; i < range.size(); ++i) {
+            assertEqual(i + 1, range[i].first.toInt());
+        }
+
+        // 批量构建后仍可继续插入和删除
+        assertTrue(bulkTree.insert(QVariant(COUNT + 5), 42));
+        assertTrue(bulkTree.remove(QVariant(500)));
+        RowId foundRowId = INVALID_ROW_ID;
+        assertTrue(bulkTree.search(QVariant(COUNT + 5), foundRowId));
+        assertFalse(bulkTree.search(QVariant(500), foundRowId));
+
+        // 与逐条插入相比，叶子页更少
+        GenericBPlusTree insertTree(&bufferPool, DataType::INT);
+        for (const auto& entry : entries) {
+            insertTree.insert(entry.first, entry.second);
+        }
+        GenericBPlusTree::Stats bulkStats = bulkTree.getStats();
+        GenericBPlusTree::Stats insertStats = insertTree.getStats();
+        assertTrue(bulkStats.numLeafPages < insertStats.numLeafPages,
+                   QString("Bulk loaded tree should be smaller (%1 vs %2 leaf pages)")
+                       .arg(bulkStats.numLeafPages).arg(insertStats.numLeafPages));
+
+        double elapsed = stopTimer();
+        addResult("testBulkLoad", true,
+                 QString("Bulk loaded %1 keys into %2 leaf pages").arg(COUNT).arg(bulkStats.numLeafPages),
+                 elapsed);
+    }
+
+    /**
+     * @brief 测试带长公共前缀的字符串键（前缀压缩 + 后缀截断）
+     */
+    void testLongStringKeys() {
+        startTimer();
+
+        QTemporaryFile tempFile;
+        tempFile.setAutoRemove(true);
+        assertTrue(tempFile.open());
+        QString dbPath = tempFile.fileName();
+        tempFile.close();
+
+        DiskManager diskMgr(dbPath);
+        Config& config = Config::instance();
+        BufferPoolManager bufferPool(config.getBufferPoolSize(), &diskMgr);
+
+        GenericBPlusTree tree(&bufferPool, DataType::VARCHAR);
+
+        // 每个键约 110 字节，不压缩时 100 个键放不下一页
+        const QString base = "https://www.example-shop.com/catalog/products/electronics/detail/";
+        const int COUNT = 3000;
+        for (int i = 0; i < COUNT; ++i) {
+            int n = (i * 7) % COUNT;
+            QString key = base + QString("item-%1-description.html").arg(n, 8, 10, QChar('0'));
+            assertTrue(tree.insert(QVariant(key), n + 1), QString("Failed to insert %1").arg(key));
+        }
+
+        for (int n = 0; n < COUNT; n += 13) {
+            QString key = base + QString("item-%1-description.html").arg(n, 8, 10, QChar('0'));
+            RowId foundRowId = INVALID_ROW_ID;
+            assertTrue(tree.search(QVariant(key), foundRowId), QString("Failed to find %1").arg(key));
+            assertEqual(static_cast<RowId>(n + 1), foundRowId);
+        }
+
+        // 截断后的分隔键不能影响范围查询的正确性
+        QVector<QPair<QVariant, RowId>> results;
+        QString minKey = base + "item-00000100";
+        QString maxKey = base + "item-00000200";
+        assertTrue(tree.rangeSearch(QVariant(minKey), QVariant(maxKey), results));
+        assertEqual(100, static_cast<int>(results.size()), "Range over truncated separators");
+
+        // 截断后的分隔键仍是完整的值编码，能按键类型解码
+        QVector<QVariant> separators;
+        assertTrue(tree.getSeparatorKeys(separators), "Separators should decode");
+        assertTrue(!separators.isEmpty(), "Tree should have internal nodes");
+        const int fullLength = (base + "item-00000000-description.html").size();
+        bool truncated = false;
+        for (const QVariant& separator : separators) {
+            const QString text = separator.toString();
+            assertTrue(text.startsWith(base + "item-"), QString("Unexpected separator %1").arg(text));
+            truncated = truncated || text.size() < fullLength;
+        }
+        assertTrue(truncated, "Separators should be suffix-truncated");
+
+        // 删除后仍能正确查找
+        for (int n = 0; n < COUNT; n += 2) {
+            QString key = base + QString("item-%1-description.html").arg(n, 8, 10, QChar('0'));
+            tree.remove(QVariant(key));
+        }
+        for (int n = 1; n < COUNT; n += 17) {
+            QString key = base + QString("item-%1-description.html").arg(n, 8, 10, QChar('0'));
+            RowId foundRowId = INVALID_ROW_ID;
+            assertTrue(tree.search(QVariant(key), foundRowId), QString("Failed to find %1 after removals").arg(key));
+        }
+
+        double elapsed = stopTimer();
+        addResult("testLongStringKeys", true, "", elapsed);
+    }
+
+    /**
+     * @brief 测试保序键编码：memcmp 顺序与值顺序一致，且可以无损解码
+     */
+    void testNormalizedKeyOrder() {
+        startTimer();
+
+        auto checkOrder = [this](DataType type, const QVector<QVariant>& ascending) {
+            for (int i = 0; i + 1 < ascending.size(); ++i) {
+                QByteArray a, b;
+                assertTrue(KeyEncoder::encode(ascending[i], type, a));
+                assertTrue(KeyEncoder::encode(ascending[i + 1], type, b));
+                assertTrue(KeyEncoder::compare(a, b) < 0,
+                           QString("%1 should sort before %2 (%3)")
+                               .arg(ascending[i].toString(), ascending[i + 1].toString(), getDataTypeName(type)));
+            }
+        };
+
+        checkOrder(DataType::INT, {QVariant(), INT32_MIN, -1000, -1, 0, 1, 255, 256, INT32_MAX});
+        checkOrder(DataType::BIGINT, {qint64(INT64_MIN), qint64(-1), qint64(0), qint64(1) << 40, qint64(INT64_MAX)});
+        checkOrder(DataType::DOUBLE, {-std::numeric_limits<double>::infinity(), -1e300, -2.5, -1e-300,
+                                      0.0, 1e-300, 2.5, 1e300, std::numeric_limits<double>::infinity(),
+                                      std::numeric_limits<double>::quiet_NaN()});
+        checkOrder(DataType::DECIMAL, {"-1000", "-99.5", "-1.55", "-1.5", "-0.001", "0",
+                                       "0.0015", "0.5", "1.5", "1.55", "10", "99.99", "1e3"});
+        checkOrder(DataType::VARCHAR, {QString(""), QString("a"), QString("a") + QChar(0),
+                                       QString("a") + QChar(0) + "b", QString("ab"), QString("b")});
+        checkOrder(DataType::DATE, {QDate(1969, 12, 31), QDate(1970, 1, 1), QDate(2024, 2, 29)});
+
+        // 相等的值编码相同
+        QByteArray a, b;
+        assertTrue(KeyEncoder::encode(QVariant(-0.0), DataType::DOUBLE, a));
+        assertTrue(KeyEncoder::encode(QVariant(0.0), DataType::DOUBLE, b));
+        assertEqual(a, b, "-0.0 and 0.0 should encode identically");
+        assertTrue(KeyEncoder::encode(QVariant("1.50"), DataType::DECIMAL, a));
+        assertTrue(KeyEncoder::encode(QVariant("001.5"), DataType::DECIMAL, b));
+        assertEqual(a, b, "DECIMAL trailing/leading zeros should not affect equality");
+
+        // 解码
+        QVariant decoded;
+        assertTrue(KeyEncoder::encode(QVariant("-123.045"), DataType::DECIMAL, a));
+        assertTrue(KeyEncoder::decode(a, DataType::DECIMAL, decoded));
+        assertEqual(QString("-123.045"), decoded.toString());
+        QString withNul = QString("x") + QChar(0) + "y";
+        assertTrue(KeyEncoder::encode(QVariant(withNul), DataType::VARCHAR, a));
+        assertTrue(KeyEncoder::decode(a, DataType::VARCHAR, decoded));
+        assertEqual(withNul, decoded.toString());
+
+        // 复合键：按列字典序，短字符串列不会越过列边界
+        QVector<DataType> types = {DataType::VARCHAR, DataType::INT};
+        QByteArray k1, k2, k3;
+        assertTrue(KeyEncoder::encodeComposite({QString("ab"), 100}, types, k1));
+        assertTrue(KeyEncoder::encodeComposite({QString("ab"), 200}, types, k2));
+        assertTrue(KeyEncoder::encodeComposite({QString("abc"), -5}, types, k3));
+        assertTrue(KeyEncoder::compare(k1, k2) < 0, "('ab',100) < ('ab',200)");
+        assertTrue(KeyEncoder::compare(k2, k3) < 0, "('ab',200) < ('abc',-5)");
+        QVector<QVariant> values;
+        assertTrue(KeyEncoder::decodeComposite(k3, types, values));
+        assertEqual(QString("abc"), values[0].toString());
+        assertEqual(-5, values[1].toInt());
+
+        // 负数键的范围查询（旧的小端编码按字节比较会出错）
+        QTemporaryFile tempFile;
+        tempFile.setAutoRemove(true);
+        assertTrue(tempFile.open());
+        QString dbPath = tempFile.fileName();
+        tempFile.close();
+
+        DiskManager diskMgr(dbPath);
+        Config& config = Config::instance();
+        BufferPoolManager bufferPool(config.getBufferPoolSize(), &diskMgr);
+
+        GenericBPlusTree tree(&bufferPool, DataType::INT);
+        assertTrue(tree.usesNormalizedKeys());
+        for (int i = -500; i <= 500; ++i) {
+            assertTrue(tree.insert(QVariant(i), i + 1000));
+        }
+        QVector<QPair<QVariant, RowId>> results;
+        assertTrue(tree.rangeSearch(QVariant(-50), QVariant(49), results));
+        assertEqual(100, static_cast<int>(results.size()), "Range across zero");
+        assertEqual(-50, results.first().first.toInt());
+        assertEqual(49, results.last().first.toInt());
+
+        double elapsed = stopTimer();
+        addResult("testNormalizedKeyOrder", true, "", elapsed);
+    }
+
+    /**
+     * @brief 测试复合索引：重复值、前缀扫描、前缀 + 范围扫描、按行删除和批量构建
+     */
+    void testCompositeIndex() {
+        startTimer();
+
+        QTemporaryFile tempFile;
+        tempFile.setAutoRemove(true);
+        assertTrue(tempFile.open());
+        QString dbPath = tempFile.fileName();
+        tempFile.close();
+
+        DiskManager diskMgr(dbPath);
+        Config& config = Config::instance();
+        BufferPoolManager bufferPool(config.getBufferPoolSize(), &diskMgr);
+
+        const QVector<DataType> types = {DataType::INT, DataType::VARCHAR};
+        auto makeKey = [&types](const QVariant& a, const QVariant& b) {
+            return CompositeKey({a, b}, types);
+        };
+        auto prefixOf = [](int a) {
+            CompositeKey prefix;
+            prefix.addValue(a, DataType::INT);
+            return prefix;
+        };
+
+        // a = 0..49，b = "k00".."k19"，每个 (a, b) 有两行
+        QVector<QPair<CompositeKey, RowId>> entries;
+        RowId nextRowId = 1;
+        for (int a = 0; a < 50; ++a) {
+            for (int b = 0; b < 20; ++b) {
+                QString text = QString("k%1").arg(b, 2, 10, QChar('0'));
+                entries.append(qMakePair(makeKey(a, text), nextRowId++));
+                entries.append(qMakePair(makeKey(a, text), nextRowId++));
+            }
+        }
+        entries.append(qMakePair(makeKey(7, QVariant()), nextRowId++));  // NULL 也进索引
+        std::reverse(entries.begin(), entries.end());
+
+        CompositeIndex index(&bufferPool, types);
+        assertTrue(index.bulkLoad(entries, 1.0), "Composite bulk load failed");
+
+        // 前缀扫描：a = 7 的 40 行 + 1 个 NULL，NULL 排在最前
+        QVector<QPair<CompositeKey, RowId>> results;
+        CompositeIndex::ColumnRange unbounded;
+        assertTrue(index.scan(prefixOf(7), unbounded, results));
+        assertEqual(41, static_cast<int>(results.size()), "Prefix scan a = 7");
+        assertTrue(results.first().first.getValue(1).isNull(), "NULL sorts first within the prefix");
+        for (const auto& entry : results) {
+            assertEqual(7, entry.first.getValue(0).toInt());
+        }
+
+        // 前缀 + 范围：a = 7 AND b > 'k04' AND b <= 'k10'，不含 NULL
+        CompositeIndex::ColumnRange range;
+        range.hasLower = true;
+        range.lower = QString("k04");
+        range.lowerInclusive = false;
+        range.hasUpper = true;
+        range.upper = QString("k10");
+        assertTrue(index.scan(prefixOf(7), range, results));
+        assertEqual(12, static_cast<int>(results.size()), "Prefix + range scan");
+        assertEqual(QString("k05"), results.first().first.getValue(1).toString());
+        assertEqual(QString("k10"), results.last().first.getValue(1).toString());
+
+        // 只有上界：排除 NULL
+        CompositeIndex::ColumnRange upperOnly;
+        upperOnly.hasUpper = true;
+        upperOnly.upper = QString("k01");
+        upperOnly.upperInclusive = false;
+        assertTrue(index.scan(prefixOf(7), upperOnly, results));
+        assertEqual(2, static_cast<int>(results.size()), "Upper-bound-only scan excludes NULL");
+
+        // 首列范围（空前缀）：a >= 48
+        CompositeIndex::ColumnRange leading;
+        leading.hasLower = true;
+        leading.lower = 48;
+        assertTrue(index.scan(CompositeKey(), leading, results));
+        assertEqual(80, static_cast<int>(results.size()), "Leading column range");
+
+        // 重复键按 rowId 删除，只删掉其中一行
+        CompositeKey dupKey = makeKey(3, QString("k03"));
+        assertTrue(index.scan(dupKey, CompositeIndex::ColumnRange(), results));
+        assertEqual(2, static_cast<int>(results.size()), "Duplicate keys are kept");
+        RowId removed = results.first().second;
+        RowId kept = results.last().second;
+        assertTrue(index.remove(dupKey, removed));
+        assertFalse(index.remove(dupKey, removed), "Removing the same row twice should fail");
+        RowId found = INVALID_ROW_ID;
+        assertTrue(index.search(dupKey, found));
+        assertEqual(kept, found);
+
+        // 批量构建后继续插入
+        assertTrue(index.insert(makeKey(100, QString("z")), 999999));
+        assertTrue(index.search(makeKey(100, QString("z")), found));
+        assertEqual(static_cast<RowId>(999999), found);
+
+        double elapsed = stopTimer();
+        addResult("testCompositeIndex", true,
+                 QString("%1 composite entries").arg(entries.size()), elapsed);
+    }
+
+    /**
+     * @brief 测试带包含列（INCLUDE）的索引：包含列和创建事务随条目存取
+     */
+    void testCoveringIndex() {
+        startTimer();
+
+        QTemporaryFile tempFile;
+        tempFile.setAutoRemove(true);
+        assertTrue(tempFile.open());
+        QString dbPath = tempFile.fileName();
+        tempFile.close();
+
+        DiskManager diskMgr(dbPath);
+        Config& config = Config::instance();
+        BufferPoolManager bufferPool(config.getBufferPoolSize(), &diskMgr);
+
+        const QVector<DataType> keyTypes = {DataType::INT};
+        const QVector<DataType> includeTypes = {DataType::VARCHAR, DataType::DOUBLE};
+        auto keyOf = [](int a) {
+            CompositeKey key;
+            key.addValue(a, DataType::INT);
+            return key;
+        };
+
+        // 键 a = row % 100，包含列 (name, score)，创建事务 = rowId % 7 + 1
+        QVector<CompositeIndex::Entry> entries;
+        for (int row = 1; row <= 1000; ++row) {
+            CompositeIndex::Entry entry;
+            entry.key = keyOf(row % 100);
+            entry.rowId = row;
+            entry.included = {QString("name-%1").arg(row), row * 0.5};
+            entry.createTxnId = row % 7 + 1;
+            entries.append(entry);
+        }
+
+        CompositeIndex index(&bufferPool, keyTypes, INVALID_PAGE_ID, includeTypes);
+        assertTrue(index.bulkLoad(entries, 1.0), "Covering bulk load failed");
+
+        QVector<CompositeIndex::Entry> results;
+        assertTrue(index.scanEntries(keyOf(42), CompositeIndex::ColumnRange(), results));
+        assertEqual(10, static_cast<int>(results.size()), "Prefix scan a = 42");
+        for (const auto& entry : results) {
+            assertEqual(42, entry.key.getValue(0).toInt());
+            assertEqual(QString("name-%1").arg(entry.rowId), entry.included.value(0).toString());
+            assertEqual(entry.rowId * 0.5, entry.included.value(1).toDouble());
+            assertEqual(static_cast<TransactionId>(entry.rowId % 7 + 1), entry.createTxnId);
+        }
+
+        // 按 (键, rowId) 删除，不需要知道包含列的值
+        const RowId removed = results.first().rowId;
+        assertTrue(index.remove(keyOf(42), removed));
+        assertFalse(index.remove(keyOf(42), removed), "Removing the same row twice should fail");
+        assertTrue(index.scanEntries(keyOf(42), CompositeIndex::ColumnRange(), results));
+        assertEqual(9, static_cast<int>(results.size()), "One entry removed");
+
+        // 插入新条目（包含列为 NULL）
+        assertTrue(index.insert(keyOf(42), 5000, {QVariant(), 1.25}, 99));
+        assertTrue(index.scanEntries(keyOf(42), CompositeIndex::ColumnRange(), results));
+        assertEqual(10, static_cast<int>(results.size()));
+        const auto& inserted = results.last();
+        assertEqual(static_cast<RowId>(5000), inserted.rowId);
+        assertTrue(inserted.included.value(0).isNull(), "NULL included value round-trips");
+        assertEqual(1.25, inserted.included.value(1).toDouble());
+        assertEqual(static_cast<TransactionId>(99), inserted.createTxnId);
+
+        // 超过条目上限的包含列被拒绝
+        QString huge(CompositeIndex::MAX_ENTRY_SIZE, QChar('x'));
+        assertFalse(index.insert(keyOf(1), 6000, {huge, 0.0}, 1), "Oversized entry should be rejected");
+
+        // 重新打开：根页上的标志说明值槽位是创建事务ID
+        CompositeIndex reopened(&bufferPool, keyTypes, index.getRootPageId(), includeTypes);
+        assertTrue(reopened.storesCreateTxnIds(), "Reopened covering index keeps its value format");
+
+        // 旧格式（值槽位为 rowId、没有格式标志）的树不能把值当作创建事务ID
+        GenericBPlusTree legacyTree(&bufferPool, DataType::BINARY);
+        for (RowId row = 1; row <= 3; ++row) {
+            QByteArray encoded = keyOf(7).encode();
+            for (int shift = 56; shift >= 0; shift -= 8) {
+                encoded.append(static_cast<char>((row >> shift) & 0xFF));
+            }
+            assertTrue(legacyTree.insertEncoded(encoded, row));
+        }
+        CompositeIndex legacy(&bufferPool, keyTypes, legacyTree.getRootPageId());
+        assertFalse(legacy.storesCreateTxnIds(), "Legacy tree must not report transaction ids");
+        assertTrue(legacy.scanEntries(keyOf(7), CompositeIndex::ColumnRange(), results));
+        assertEqual(3, static_cast<int>(results.size()));
+        for (const auto& entry : results) {
+            assertEqual(INVALID_TXN_ID, entry.createTxnId, "Legacy value slot is not a transaction id");
+        }
+
+        double elapsed = stopTimer();
+        addResult("testCoveringIndex", true,
+                 QString("%1 covering entries").arg(entries.size()), elapsed);
+    }
+
+    /**
+     * @brief 测试整数键节点内查找：AVX2 路径与标量路径结果一致
+     *
+     * 覆盖重复键、键数不是通道数整数倍的窗口、8/16/24 字节步长和极值键
+     */
+    void testIntKeySearch() {
+        startTimer();
+
+        // 断言失败抛出异常时也要恢复 AVX2 开关
+        struct Avx2Reset {
+            ~Avx2Reset() { IntKeySearch::setAvx2Allowed(true); }
+        } avx2Reset;
+
+        uint32_t seed = 777;
+        int cases = 0;
+        for (size_t stride : {size_t(8), size_t(16), size_t(24)}) {
+            for (int count = 0; count <= 70; ++count) {
+                // 升序键，约一半与前一个相同；条目中键以外的字节填无关数据
+                std::vector<int64_t> keys;
+                int64_t key = std::numeric_limits<int64_t>::min() + 2;
+                for (int i = 0; i < count; ++i) {
+                    seed = seed * 1103515245u + 12345u;
+                    if (i > 0 && (seed >> 16) % 2 == 0) {
+                        key += static_cast<int64_t>((seed >> 8) % 5) + 1;
+                    }
+                    if (i == count - 1 && count > 3) {
+                        key = std::numeric_limits<int64_t>::max();
+                    }
+                    keys.push_back(key);
+                }
+                QByteArray buffer(static_cast<int>(count * stride), static_cast<char>(0xA5));
+                for (int i = 0; i < count; ++i) {
+                    memcpy(buffer.data() + i * stride, &keys[i], sizeof(int64_t));
+                }
+                const char* base = buffer.constData();
+
+                std::vector<int64_t> probes = {std::numeric_limits<int64_t>::min(),
+                                               std::numeric_limits<int64_t>::max()};
+                for (int64_t k : keys) {
+                    probes.push_back(k);
+                    if (k != std::numeric_limits<int64_t>::min()) probes.push_back(k - 1);
+                    if (k != std::numeric_limits<int64_t>::max()) probes.push_back(k + 1);
+                }
+
+                for (int64_t probe : probes) {
+                    const int lower = static_cast<int>(std::lower_bound(keys.begin(), keys.end(), probe) - keys.begin());
+                    const int upper = static_cast<int>(std::upper_bound(keys.begin(), keys.end(), probe) - keys.begin());
+                    const QString where = QString("stride %1, %2 keys, probe %3").arg(stride).arg(count).arg(probe);
+
+                    IntKeySearch::setAvx2Allowed(true);
+                    assertEqual(lower, IntKeySearch::lowerBound(base, count, stride, probe), "lowerBound: " + where);
+                    assertEqual(upper, IntKeySearch::upperBound(base, count, stride, probe), "upperBound: " + where);
+                    IntKeySearch::setAvx2Allowed(false);
+                    assertEqual(lower, IntKeySearch::lowerBound(base, count, stride, probe), "scalar lowerBound: " + where);
+                    assertEqual(upper, IntKeySearch::upperBound(base, count, stride, probe), "scalar upperBound: " + where);
+                    assertEqual(lower, IntKeySearch::lowerBoundScalar(base, count, stride, probe), "lowerBoundScalar: " + where);
+                    assertEqual(upper, IntKeySearch::upperBoundScalar(base, count, stride, probe), "upperBoundScalar: " + where);
+                    ++cases;
+                }
+            }
+        }
+        IntKeySearch::setAvx2Allowed(true);
+
+        double elapsed = stopTimer();
+        addResult("testIntKeySearch", true,
+                 QString("%1 probes, AVX2 %2").arg(cases)
+                     .arg(IntKeySearch::isAvx2Enabled() ? "compared with scalar" : "not available, scalar only"),
+                 elapsed);
+    }
 };
 
 } // namespace test
@@ -3,12 +3,29 @@
 #include "qindb/parser.h"
 #include "qindb/database_manager.h"
 #include "qindb/catalog.h"
+#include "qindb/catalog_db_backend.h"
 #include "qindb/buffer_pool_manager.h"
 #include "qindb/disk_manager.h"
+#include "qindb/block_range_index.h"
+#include "qindb/bitmap_index.h"
+#include "qindb/rtree_index.h"
+#include "qindb/trie_index.h"
+#include "qindb/statistics.h"
+#include "qindb/hyperloglog.h"
+#include "qindb/cost_optimizer.h"
+#include "qindb/cardinality_feedback.h"
+#include "qindb/cost_calibrator.h"
+#include "qindb/config.h"
+#include "qindb/expression_evaluator.h"
+#include "qindb/index_expression.h"
 #include <QCoreApplication>
 #include <iostream>
 #include <QFile>
 #include <QDir>
+#include <QSet>
+#include <QSettings>
+#include <cmath>
+#include <random>
 
 using namespace qindb;
 using namespace qindb::test;
@@ -33,6 +50,25 @@ public:
         testUpdateAndSelectIntegration();
         testWhereClauseFiltering();
         testMultipleInserts();
+        testHashIndexEqualityAndIn();
+        testHashIndexMaintenance();
+        testHashIndexJoin();
+        testFullTextIndexMaintenance();
+        testCompositeIndexScan();
+        testCoveringIndexScan();
+        testPartialAndExpressionIndexes();
+        testBlockRangeIndex();
+        testBitmapIndex();
+        testRoaringBitmapAvx2();
+        testRTreeIndex();
+        testTrieIndex();
+        testPlanDrivenSelect();
+        testPersistedStatistics();
+        testCatalogStatisticsPages();
+        testSampledStatistics();
+        testExtendedStatistics();
+        testCardinalityFeedback();
+        testCostCalibration();
     }
 
 private:
@@ -362,6 +398,1474 @@ private:
             addResult("testMultipleInserts", false, QString("Exception: %1").arg(e.what()), stopTimer());
         }
     }
+
+    void testHashIndexEqualityAndIn() {
+        startTimer();
+        try {
+            auto ctx = createTestContext();
+
+            ctx.executor->execute(Parser("CREATE TABLE accounts (id INT, owner VARCHAR(50));").parse());
+            for (int i = 1; i <= 20; ++i) {
+                ctx.executor->execute(Parser(QString("INSERT INTO accounts VALUES (%1, 'user%2');")
+                                                 .arg(i).arg(i % 5)).parse());
+            }
+
+            QueryResult indexResult = ctx.executor->execute(
+                Parser("CREATE INDEX idx_owner ON accounts(owner) USING HASH;").parse());
+            assertTrue(indexResult.success, "CREATE HASH INDEX should succeed");
+
+            QueryResult eqResult = ctx.executor->execute(
+                Parser("SELECT * FROM accounts WHERE owner = 'user3';").parse());
+            assertTrue(eqResult.success, "Equality lookup should succeed");
+            assertEqual(qsizetype(4), eqResult.rows.size(), "user3 owns 4 accounts");
+
+            QueryResult inResult = ctx.executor->execute(
+                Parser("SELECT * FROM accounts WHERE owner IN ('user1', 'user2', 'nobody');").parse());
+            assertTrue(inResult.success, "IN lookup should succeed");
+            assertEqual(qsizetype(8), inResult.rows.size(), "user1 and user2 own 8 accounts");
+
+            // 其余条件在索引候选行上重新评估
+            QueryResult andResult = ctx.executor->execute(
+                Parser("SELECT * FROM accounts WHERE owner = 'user3' AND id > 10;").parse());
+            assertTrue(andResult.success, "Equality with extra filter should succeed");
+            assertEqual(qsizetype(2), andResult.rows.size(), "Only accounts 13 and 18 match");
+
+            // 建索引之后插入的行也能查到
+            ctx.executor->execute(Parser("INSERT INTO accounts VALUES (21, 'user3');").parse());
+            eqResult = ctx.executor->execute(Parser("SELECT * FROM accounts WHERE owner = 'user3';").parse());
+            assertEqual(qsizetype(5), eqResult.rows.size(), "Newly inserted row should be indexed");
+
+            addResult("testHashIndexEqualityAndIn", true, "Hash index answers = and IN", stopTimer());
+        } catch (const std::exception& e) {
+            addResult("testHashIndexEqualityAndIn", false, QString("Exception: %1").arg(e.what()), stopTimer());
+        }
+    }
+
+    void testHashIndexMaintenance() {
+        startTimer();
+        try {
+            auto ctx = createTestContext();
+
+            // 在空表上建索引，后续 INSERT 负责填充
+            ctx.executor->execute(Parser("CREATE TABLE tickets (id INT, state VARCHAR(20));").parse());
+            QueryResult indexResult = ctx.executor->execute(
+                Parser("CREATE INDEX idx_state ON tickets(state) USING HASH;").parse());
+            assertTrue(indexResult.success, "CREATE HASH INDEX on empty table should succeed");
+
+            for (int i = 1; i <= 6; ++i) {
+                ctx.executor->execute(Parser(QString("INSERT INTO tickets VALUES (%1, 'open');").arg(i)).parse());
+            }
+
+            ctx.executor->execute(Parser("UPDATE tickets SET state = 'closed' WHERE id <= 2;").parse());
+            QueryResult openResult = ctx.executor->execute(
+                Parser("SELECT * FROM tickets WHERE state = 'open';").parse());
+            assertEqual(qsizetype(4), openResult.rows.size(), "Updated rows should leave the old key");
+            QueryResult closedResult = ctx.executor->execute(
+                Parser("SELECT * FROM tickets WHERE state = 'closed';").parse());
+            assertEqual(qsizetype(2), closedResult.rows.size(), "Updated rows should be found by the new key");
+
+            ctx.executor->execute(Parser("DELETE FROM tickets WHERE state = 'open';").parse());
+            openResult = ctx.executor->execute(Parser("SELECT * FROM tickets WHERE state = 'open';").parse());
+            assertEqual(qsizetype(0), openResult.rows.size(), "Deleted rows should not be returned");
+            QueryResult allResult = ctx.executor->execute(Parser("SELECT * FROM tickets;").parse());
+            assertEqual(qsizetype(2), allResult.rows.size(), "DELETE through the index should remove 4 rows");
+
+            // 旧版本在空列上建的哈希索引目录中根页为 INVALID：第一次修改补建目录并写回，之后不再新建
+            ctx.executor->execute(Parser("CREATE TABLE legacy_tickets (id INT, state VARCHAR(20));").parse());
+            indexResult = ctx.executor->execute(
+                Parser("CREATE INDEX idx_legacy_state ON legacy_tickets(state) USING HASH;").parse());
+            assertTrue(indexResult.success, "CREATE HASH INDEX on empty table should succeed");
+            Catalog* catalog = ctx.dbManager->getCurrentCatalog();
+            assertTrue(catalog->setIndexRootPageId("idx_legacy_state", INVALID_PAGE_ID),
+                       "Root page should be reset to INVALID");
+
+            ctx.executor->execute(Parser("INSERT INTO legacy_tickets VALUES (1, 'open');").parse());
+            const IndexDef* legacyIndex = catalog->getIndex("idx_legacy_state");
+            assertNotNull(legacyIndex, "Hash index should stay in the catalog");
+            const PageId directoryPageId = legacyIndex->rootPageId;
+            assertTrue(directoryPageId != INVALID_PAGE_ID, "First insert should write the new directory to the catalog");
+
+            ctx.executor->execute(Parser("INSERT INTO legacy_tickets VALUES (2, 'open');").parse());
+            ctx.executor->execute(Parser("INSERT INTO legacy_tickets VALUES (3, 'closed');").parse());
+            assertEqual(directoryPageId, catalog->getIndex("idx_legacy_state")->rootPageId,
+                        "Later inserts should reuse the same directory");
+            openResult = ctx.executor->execute(Parser("SELECT * FROM legacy_tickets WHERE state = 'open';").parse());
+            assertEqual(qsizetype(2), openResult.rows.size(), "Rows inserted after the repair should be indexed");
+
+            addResult("testHashIndexMaintenance", true, "UPDATE/DELETE keep hash index in sync", stopTimer());
+        } catch (const std::exception& e) {
+            addResult("testHashIndexMaintenance", false, QString("Exception: %1").arg(e.what()), stopTimer());
+        }
+    }
+
+    void testHashIndexJoin() {
+        startTimer();
+        try {
+            auto ctx = createTestContext();
+
+            ctx.executor->execute(Parser("CREATE TABLE customers (cid INT, cname VARCHAR(50));").parse());
+            ctx.executor->execute(Parser("CREATE TABLE purchases (pid INT, customer INT);").parse());
+            for (int i = 1; i <= 5; ++i) {
+                ctx.executor->execute(Parser(QString("INSERT INTO customers VALUES (%1, 'c%1');").arg(i)).parse());
+            }
+            // 顾客 1 两单、顾客 2 一单、顾客 9 不存在
+            ctx.executor->execute(Parser("INSERT INTO purchases VALUES (100, 1);").parse());
+            ctx.executor->execute(Parser("INSERT INTO purchases VALUES (101, 1);").parse());
+            ctx.executor->execute(Parser("INSERT INTO purchases VALUES (102, 2);").parse());
+            ctx.executor->execute(Parser("INSERT INTO purchases VALUES (103, 9);").parse());
+
+            QueryResult indexResult = ctx.executor->execute(
+                Parser("CREATE INDEX idx_cid ON customers(cid) USING HASH;").parse());
+            assertTrue(indexResult.success, "CREATE HASH INDEX should succeed");
+
+            QueryResult joinResult = ctx.executor->execute(Parser(
+                "SELECT * FROM purchases JOIN customers ON purchases.customer = customers.cid;").parse());
+            assertTrue(joinResult.success, "Equi-join should succeed");
+            assertEqual(qsizetype(3), joinResult.rows.size(), "Three purchases have a matching customer");
+            for (const auto& row : joinResult.rows) {
+                assertEqual(row[1].toInt(), row[2].toInt(), "Joined rows should have equal keys");
+            }
+
+            addResult("testHashIndexJoin", true, "Hash index drives the inner side of equi-joins", stopTimer());
+        } catch (const std::exception& e) {
+            addResult("testHashIndexJoin", false, QString("Exception: %1").arg(e.what()), stopTimer());
+        }
+    }
+
+    void testFullTextIndexMaintenance() {
+        startTimer();
+        try {
+            auto ctx = createTestContext();
+
+            ctx.executor->execute(Parser("CREATE TABLE articles (id INT, body VARCHAR(200));").parse());
+            ctx.executor->execute(Parser("INSERT INTO articles VALUES (1, 'database storage engine');").parse());
+            ctx.executor->execute(Parser("INSERT INTO articles VALUES (2, 'database query optimizer');").parse());
+            ctx.executor->execute(Parser("INSERT INTO articles VALUES (3, 'cooking with garlic');").parse());
+
+            QueryResult indexResult = ctx.executor->execute(
+                Parser("CREATE INDEX idx_body ON articles(body) USING FULLTEXT;").parse());
+            assertTrue(indexResult.success, "CREATE FULLTEXT INDEX should succeed");
+
+            // 建索引之后的 INSERT / UPDATE / DELETE 都要反映到倒排索引
+            ctx.executor->execute(Parser("INSERT INTO articles VALUES (4, 'distributed database replication');").parse());
+            QueryResult searchResult = ctx.executor->execute(
+                Parser("SELECT * FROM articles WHERE MATCH(body) AGAINST('database');").parse());
+            assertTrue(searchResult.success, "MATCH query should succeed");
+            assertEqual(qsizetype(3), searchResult.rows.size(), "Inserted row should be searchable");
+
+            ctx.executor->execute(Parser("UPDATE articles SET body = 'garlic bread' WHERE id = 1;").parse());
+            ctx.executor->execute(Parser("DELETE FROM articles WHERE id = 2;").parse());
+
+            searchResult = ctx.executor->execute(
+                Parser("SELECT * FROM articles WHERE MATCH(body) AGAINST('database');").parse());
+            assertEqual(qsizetype(1), searchResult.rows.size(), "Updated and deleted rows should leave the index");
+            assertEqual(4, searchResult.rows[0][0].toInt(), "Only the inserted article should still match");
+
+            searchResult = ctx.executor->execute(
+                Parser("SELECT * FROM articles WHERE MATCH(body) AGAINST('garlic');").parse());
+            assertEqual(qsizetype(2), searchResult.rows.size(), "Updated text should be searchable");
+
+            addResult("testFullTextIndexMaintenance", true, "DML keeps the on-disk inverted index in sync", stopTimer());
+        } catch (const std::exception& e) {
+            addResult("testFullTextIndexMaintenance", false, QString("Exception: %1").arg(e.what()), stopTimer());
+        }
+    }
+
+    void testCompositeIndexScan() {
+        startTimer();
+        try {
+            auto ctx = createTestContext();
+
+            ctx.executor->execute(Parser("CREATE TABLE orders (id INT, customer INT, amount INT);").parse());
+            for (int i = 1; i <= 30; ++i) {
+                ctx.executor->execute(Parser(QString("INSERT INTO orders VALUES (%1, %2, %3);")
+                                                 .arg(i).arg(i % 3).arg(i * 10)).parse());
+            }
+
+            QueryResult indexResult = ctx.executor->execute(
+                Parser("CREATE INDEX idx_customer_amount ON orders(customer, amount);").parse());
+            assertTrue(indexResult.success, "CREATE composite INDEX should succeed");
+
+            QueryResult hashResult = ctx.executor->execute(
+                Parser("CREATE INDEX idx_bad ON orders(customer, amount) USING HASH;").parse());
+            assertFalse(hashResult.success, "Composite HASH index should be rejected");
+
+            // 前缀等值
+            QueryResult prefixResult = ctx.executor->execute(
+                Parser("SELECT * FROM orders WHERE customer = 1;").parse());
+            assertTrue(prefixResult.success, "Prefix lookup should succeed");
+            assertEqual(qsizetype(10), prefixResult.rows.size(), "customer 1 has 10 orders");
+
+            // 前缀等值 + 下一列范围（常量在左侧也可以）
+            QueryResult rangeResult = ctx.executor->execute(
+                Parser("SELECT * FROM orders WHERE customer = 1 AND amount > 100 AND 250 >= amount;").parse());
+            assertTrue(rangeResult.success, "Prefix + range lookup should succeed");
+            assertEqual(qsizetype(5), rangeResult.rows.size(), "Orders 13, 16, 19, 22, 25 match");
+
+            // 全部列等值
+            QueryResult exactResult = ctx.executor->execute(
+                Parser("SELECT * FROM orders WHERE amount = 70 AND customer = 1;").parse());
+            assertEqual(qsizetype(1), exactResult.rows.size(), "Exact composite key lookup");
+            assertEqual(7, exactResult.rows[0][0].toInt());
+
+            // DML 维护：UPDATE 改索引列、DELETE 走索引
+            ctx.executor->execute(Parser("UPDATE orders SET amount = 5 WHERE customer = 2 AND amount >= 200;").parse());
+            QueryResult updatedResult = ctx.executor->execute(
+                Parser("SELECT * FROM orders WHERE customer = 2 AND amount < 10;").parse());
+            assertEqual(qsizetype(4), updatedResult.rows.size(), "Updated rows should be found by the new key");
+
+            ctx.executor->execute(Parser("DELETE FROM orders WHERE customer = 0 AND amount <= 150;").parse());
+            QueryResult deletedResult = ctx.executor->execute(
+                Parser("SELECT * FROM orders WHERE customer = 0;").parse());
+            assertEqual(qsizetype(5), deletedResult.rows.size(), "Deleted rows should leave the index");
+
+            ctx.executor->execute(Parser("INSERT INTO orders VALUES (31, 0, 1);").parse());
+            QueryResult insertedResult = ctx.executor->execute(
+                Parser("SELECT * FROM orders WHERE customer = 0 AND amount < 100;").parse());
+            assertEqual(qsizetype(1), insertedResult.rows.size(), "Inserted row should be indexed");
+
+            QueryResult allResult = ctx.executor->execute(Parser("SELECT * FROM orders;").parse());
+            assertEqual(qsizetype(26), allResult.rows.size(), "DELETE should remove exactly 5 rows");
+
+            addResult("testCompositeIndexScan", true, "Composite index answers prefix and range predicates", stopTimer());
+        } catch (const std::exception& e) {
+            addResult("testCompositeIndexScan", false, QString("Exception: %1").arg(e.what()), stopTimer());
+        }
+    }
+
+    void testCoveringIndexScan() {
+        startTimer();
+        try {
+            auto ctx = createTestContext();
+
+            ctx.executor->execute(Parser("CREATE TABLE orders (id INT, customer INT, amount INT, note VARCHAR(20));").parse());
+            for (int i = 1; i <= 30; ++i) {
+                ctx.executor->execute(Parser(QString("INSERT INTO orders VALUES (%1, %2, %3, 'n%1');")
+                                                 .arg(i).arg(i % 3).arg(i * 10)).parse());
+            }
+
+            QueryResult indexResult = ctx.executor->execute(
+                Parser("CREATE INDEX idx_customer_cover ON orders(customer) INCLUDE (amount);").parse());
+            assertTrue(indexResult.success, "CREATE INDEX ... INCLUDE should succeed");
+
+            QueryResult dupResult = ctx.executor->execute(
+                Parser("CREATE INDEX idx_bad ON orders(customer) INCLUDE (customer);").parse());
+            assertFalse(dupResult.success, "Key column repeated in INCLUDE should be rejected");
+
+            QueryResult hashResult = ctx.executor->execute(
+                Parser("CREATE INDEX idx_bad ON orders(customer) INCLUDE (amount) USING HASH;").parse());
+            assertFalse(hashResult.success, "INCLUDE on a HASH index should be rejected");
+
+            // 只用到 customer 和 amount：由索引直接回答（amount 130..280，共 6 行）
+            QueryResult coveredResult = ctx.executor->execute(
+                Parser("SELECT amount FROM orders WHERE customer = 1 AND amount > 100;").parse());
+            assertTrue(coveredResult.success, "Covered query should succeed");
+            assertEqual(qsizetype(6), coveredResult.rows.size(), "Six orders of customer 1 above 100");
+            int total = 0;
+            for (const auto& row : coveredResult.rows) {
+                assertEqual(qsizetype(1), row.size(), "Projection keeps only the selected column");
+                total += row[0].toInt();
+            }
+            assertEqual(1230, total, "Amounts come from the index entries");
+
+            // 用到未覆盖的列时回表
+            QueryResult heapResult = ctx.executor->execute(
+                Parser("SELECT note FROM orders WHERE customer = 1 AND amount = 40;").parse());
+            assertEqual(qsizetype(1), heapResult.rows.size(), "Uncovered column is read from the table");
+            assertEqual(QString("n4"), heapResult.rows[0][0].toString());
+
+            // 原地更新包含列后，索引条目里的值也要更新
+            ctx.executor->execute(Parser("UPDATE orders SET amount = 1000 WHERE id = 4;").parse());
+            QueryResult updatedResult = ctx.executor->execute(
+                Parser("SELECT amount FROM orders WHERE customer = 1 AND amount >= 1000;").parse());
+            assertEqual(qsizetype(1), updatedResult.rows.size(), "Updated INCLUDE value is visible");
+            assertEqual(1000, updatedResult.rows[0][0].toInt());
+
+            ctx.executor->execute(Parser("DELETE FROM orders WHERE id = 4;").parse());
+            QueryResult deletedResult = ctx.executor->execute(
+                Parser("SELECT customer, amount FROM orders WHERE customer = 1;").parse());
+            assertEqual(qsizetype(9), deletedResult.rows.size(), "Deleted row should leave the covering index");
+
+            addResult("testCoveringIndexScan", true, "Covering index answers queries without heap reads", stopTimer());
+        } catch (const std::exception& e) {
+            addResult("testCoveringIndexScan", false, QString("Exception: %1").arg(e.what()), stopTimer());
+        }
+    }
+
+    void testPartialAndExpressionIndexes() {
+        startTimer();
+        try {
+            auto ctx = createTestContext();
+
+            ctx.executor->execute(Parser("CREATE TABLE accounts (id INT, email VARCHAR(40), active INT);").parse());
+            for (int i = 1; i <= 40; ++i) {
+                ctx.executor->execute(Parser(QString("INSERT INTO accounts VALUES (%1, 'User%1@Example.com', %2);")
+                                                 .arg(i).arg(i % 10 == 0 ? 1 : 0)).parse());
+            }
+
+            QueryResult exprResult = ctx.executor->execute(
+                Parser("CREATE INDEX idx_email_lower ON accounts(lower(email));").parse());
+            assertTrue(exprResult.success, "Expression index should be created");
+
+            QueryResult partialResult = ctx.executor->execute(
+                Parser("CREATE INDEX idx_active ON accounts(id) WHERE active = 1;").parse());
+            assertTrue(partialResult.success, "Partial index should be created");
+
+            Catalog* catalog = ctx.dbManager->getCurrentCatalog();
+            const IndexDef* exprIndex = catalog->getIndex("idx_email_lower");
+            assertNotNull(exprIndex, "Expression index should be in the catalog");
+            assertEqual(QString("lower(email)"), exprIndex->keyExpressions.value(0), "Expression is stored canonically");
+            const IndexDef* partialIndex = catalog->getIndex("idx_active");
+            assertNotNull(partialIndex, "Partial index should be in the catalog");
+            assertEqual(QString("(active = 1)"), partialIndex->predicate, "Predicate is stored canonically");
+
+            QueryResult badResult = ctx.executor->execute(
+                Parser("CREATE INDEX idx_bad ON accounts(lower(missing));").parse());
+            assertFalse(badResult.success, "Expression on an unknown column should be rejected");
+            QueryResult hashResult = ctx.executor->execute(
+                Parser("CREATE INDEX idx_bad ON accounts(id) USING HASH WHERE active = 1;").parse());
+            assertFalse(hashResult.success, "Partial HASH index should be rejected");
+
+            // 大小写不同的写法匹配同一个表达式键
+            QueryResult lookup = ctx.executor->execute(
+                Parser("SELECT id FROM accounts WHERE LCASE(Email) = 'user7@example.com';").parse());
+            assertTrue(lookup.success, "Lookup through expression index should succeed");
+            assertEqual(qsizetype(1), lookup.rows.size(), "One account matches lower(email)");
+            assertEqual(7, lookup.rows[0][0].toInt());
+
+            // WHERE 蕴含谓词时走部分索引：4 个活跃账号
+            QueryResult activeResult = ctx.executor->execute(
+                Parser("SELECT id FROM accounts WHERE active = 1;").parse());
+            assertEqual(qsizetype(4), activeResult.rows.size(), "Four active accounts");
+            QueryResult rangeResult = ctx.executor->execute(
+                Parser("SELECT id FROM accounts WHERE active = 1 AND id > 15;").parse());
+            assertEqual(qsizetype(3), rangeResult.rows.size(), "Active accounts above id 15");
+
+            // 不蕴含谓词的查询不能用部分索引
+            QueryResult inactiveResult = ctx.executor->execute(
+                Parser("SELECT id FROM accounts WHERE id > 35;").parse());
+            assertEqual(qsizetype(5), inactiveResult.rows.size(), "Inactive rows are still found");
+
+            // 行进入、离开谓词范围时维护部分索引；表达式键随列更新
+            ctx.executor->execute(Parser("UPDATE accounts SET active = 1 WHERE id = 3;").parse());
+            ctx.executor->execute(Parser("UPDATE accounts SET active = 0 WHERE id = 10;").parse());
+            ctx.executor->execute(Parser("UPDATE accounts SET email = 'NEW@example.com' WHERE id = 7;").parse());
+            ctx.executor->execute(Parser("INSERT INTO accounts VALUES (41, 'Late@Example.com', 1);").parse());
+
+            QueryResult maintained = ctx.executor->execute(
+                Parser("SELECT id FROM accounts WHERE active = 1;").parse());
+            QSet<int> activeIds;
+            for (const auto& row : maintained.rows) {
+                activeIds.insert(row[0].toInt());
+            }
+            assertTrue(activeIds == QSet<int>({3, 20, 30, 40, 41}), "Partial index follows UPDATE and INSERT");
+
+            QueryResult oldEmail = ctx.executor->execute(
+                Parser("SELECT id FROM accounts WHERE lower(email) = 'user7@example.com';").parse());
+            assertEqual(qsizetype(0), oldEmail.rows.size(), "Old expression key should be removed");
+            QueryResult newEmail = ctx.executor->execute(
+                Parser("SELECT id FROM accounts WHERE lower(email) = 'new@example.com';").parse());
+            assertEqual(qsizetype(1), newEmail.rows.size(), "New expression key should be indexed");
+
+            ctx.executor->execute(Parser("DELETE FROM accounts WHERE id = 20;").parse());
+            QueryResult afterDelete = ctx.executor->execute(
+                Parser("SELECT id FROM accounts WHERE active = 1;").parse());
+            assertEqual(qsizetype(4), afterDelete.rows.size(), "Deleted row should leave the partial index");
+
+            // 函数结果的类型与 inferType 推断的键类型一致
+            const TableDef* accounts = catalog->getTable("accounts");
+            assertNotNull(accounts, "Table should be in the catalog");
+            ExpressionEvaluator evaluator(catalog);
+            const QVector<QVariant> row = {QVariant(1234), QVariant("a@b.c"), QVariant(1)};
+            for (const QString& sql : {QString("round(id)"), QString("round(id, -2)"), QString("round(id, 1)")}) {
+                auto expr = IndexExpression::parse(sql);
+                assertNotNull(expr.get(), sql + " should parse");
+                const QVariant value = evaluator.evaluateWithRow(expr.get(), accounts, row);
+                const bool isDouble = value.userType() == QMetaType::Double;
+                assertEqual(IndexExpression::inferType(expr.get(), *accounts) == DataType::DOUBLE, isDouble,
+                            sql + " result type matches the inferred key type");
+            }
+
+            // 超过 2^53 的整数按 qint64 比较：相邻的两个值不能互相蕴含
+            auto bigPredicate = IndexExpression::parse("id = 9007199254740992");
+            auto bigWhere = IndexExpression::parse("id = 9007199254740993");
+            auto sameWhere = IndexExpression::parse("id = 9007199254740992");
+            assertFalse(IndexExpression::implies(bigWhere.get(), bigPredicate.get()),
+                        "Distinct integers above 2^53 should not imply each other");
+            assertTrue(IndexExpression::implies(sameWhere.get(), bigPredicate.get()),
+                       "Equal large integers should still imply the predicate");
+
+            addResult("testPartialAndExpressionIndexes", true, "Partial and expression indexes are matched and maintained", stopTimer());
+        } catch (const std::exception& e) {
+            addResult("testPartialAndExpressionIndexes", false, QString("Exception: %1").arg(e.what()), stopTimer());
+        }
+    }
+
+    void testBlockRangeIndex() {
+        startTimer();
+        try {
+            auto ctx = createTestContext();
+
+            // 时间戳随插入顺序递增，每页约几十行，表跨多个数据页
+            ctx.executor->execute(Parser("CREATE TABLE events (id INT, ts BIGINT, tag VARCHAR(120));").parse());
+            const QString padding(80, 'x');
+            for (int i = 1; i <= 400; ++i) {
+                ctx.executor->execute(Parser(QString("INSERT INTO events VALUES (%1, %2, 'tag-%1-%3');")
+                                                 .arg(i).arg(1000 + i).arg(padding)).parse());
+            }
+
+            QueryResult tsResult = ctx.executor->execute(
+                Parser("CREATE INDEX idx_ts ON events(ts) USING BRIN;").parse());
+            assertTrue(tsResult.success, "BRIN index should be created");
+            QueryResult tagResult = ctx.executor->execute(
+                Parser("CREATE INDEX idx_tag ON events(tag) USING BRIN WITH (bloom = true);").parse());
+            assertTrue(tagResult.success, "BRIN index with bloom filters should be created");
+
+            QueryResult badOption = ctx.executor->execute(
+                Parser("CREATE INDEX idx_bad ON events(id) USING BRIN WITH (pages = 4);").parse());
+            assertFalse(badOption.success, "Unknown BRIN option should be rejected");
+            QueryResult uniqueBrin = ctx.executor->execute(
+                Parser("CREATE UNIQUE INDEX idx_bad ON events(id) USING BRIN;").parse());
+            assertFalse(uniqueBrin.success, "UNIQUE BRIN index should be rejected");
+
+            Catalog* catalog = ctx.dbManager->getCurrentCatalog();
+            const IndexDef* tsIndex = catalog->getIndex("idx_ts");
+            assertNotNull(tsIndex, "BRIN index should be in the catalog");
+            assertTrue(tsIndex->indexType == IndexType::BRIN, "Index type should be BRIN");
+
+            // 一个窄范围只会落在一两个页的摘要里
+            BlockRangeIndex summaries(ctx.dbManager->getCurrentBufferPool(), tsIndex->keyType, tsIndex->rootPageId);
+            assertTrue(summaries.load(), "BRIN summaries should load");
+            assertTrue(summaries.summaryCount() > 2, "Every data page should have a summary");
+            BlockRangeIndex::Filter filter;
+            filter.hasLower = true;
+            filter.lower = 1100;
+            filter.hasUpper = true;
+            filter.upper = 1110;
+            filter.upperInclusive = false;
+            QVector<PageId> candidates = summaries.candidatePages(filter);
+            assertTrue(!candidates.isEmpty() && candidates.size() <= 2, "Range should prune most pages");
+
+            QueryResult range = ctx.executor->execute(
+                Parser("SELECT id FROM events WHERE ts >= 1100 AND ts < 1110;").parse());
+            assertEqual(qsizetype(10), range.rows.size(), "Range over BRIN returns every matching row");
+            QueryResult point = ctx.executor->execute(
+                Parser("SELECT id FROM events WHERE ts = 1250;").parse());
+            assertEqual(qsizetype(1), point.rows.size(), "Equality over BRIN");
+            assertEqual(250, point.rows[0][0].toInt());
+            QueryResult inList = ctx.executor->execute(
+                Parser("SELECT id FROM events WHERE ts IN (1001, 1400, 7);").parse());
+            assertEqual(qsizetype(2), inList.rows.size(), "IN list over BRIN");
+
+            // 布隆过滤器 + 截断的字符串边界
+            QueryResult tagLookup = ctx.executor->execute(
+                Parser(QString("SELECT id FROM events WHERE tag = 'tag-77-%1';").arg(padding)).parse());
+            assertEqual(qsizetype(1), tagLookup.rows.size(), "Long string equality through bloom summaries");
+            assertEqual(77, tagLookup.rows[0][0].toInt());
+
+            // 乱序插入、原地更新都会放宽所在页的摘要
+            ctx.executor->execute(Parser("INSERT INTO events VALUES (401, 5, NULL);").parse());
+            ctx.executor->execute(Parser("UPDATE events SET ts = 9999 WHERE id = 3;").parse());
+            QueryResult early = ctx.executor->execute(Parser("SELECT id FROM events WHERE ts < 100;").parse());
+            assertEqual(qsizetype(1), early.rows.size(), "Out-of-order insert widens the last summary");
+            assertEqual(401, early.rows[0][0].toInt());
+            QueryResult updated = ctx.executor->execute(Parser("SELECT id FROM events WHERE ts = 9999;").parse());
+            assertEqual(qsizetype(1), updated.rows.size(), "Updated value is found through BRIN");
+            QueryResult oldValue = ctx.executor->execute(Parser("SELECT id FROM events WHERE ts = 1003;").parse());
+            assertEqual(qsizetype(0), oldValue.rows.size(), "Old value no longer matches");
+            QueryResult nullTags = ctx.executor->execute(Parser("SELECT id FROM events WHERE tag IS NULL;").parse());
+            assertEqual(qsizetype(1), nullTags.rows.size(), "IS NULL uses the null counts");
+
+            // UPDATE / DELETE 也只扫描候选页
+            QueryResult updateResult = ctx.executor->execute(
+                Parser("UPDATE events SET tag = 'late' WHERE ts > 1390 AND ts <= 1400;").parse());
+            assertTrue(updateResult.success, "UPDATE with BRIN pruning should succeed");
+            QueryResult late = ctx.executor->execute(Parser("SELECT id FROM events WHERE tag = 'late';").parse());
+            assertEqual(qsizetype(10), late.rows.size(), "UPDATE touched every matching row");
+            ctx.executor->execute(Parser("DELETE FROM events WHERE ts <= 1050;").parse());
+            QueryResult remaining = ctx.executor->execute(Parser("SELECT id FROM events WHERE ts < 1100;").parse());
+            assertEqual(qsizetype(49), remaining.rows.size(), "DELETE removed every matching row");
+
+            addResult("testBlockRangeIndex", true, "BRIN summaries prune pages and stay conservative", stopTimer());
+        } catch (const std::exception& e) {
+            addResult("testBlockRangeIndex", false, QString("Exception: %1").arg(e.what()), stopTimer());
+        }
+    }
+
+    void testBitmapIndex() {
+        startTimer();
+        try {
+            // 容器转换：稠密的桶变为位图容器，稀疏的保持数组容器，运算结果与逐个判断一致
+            RoaringBitmap evens;
+            RoaringBitmap threes;
+            for (RowId rowId = 0; rowId < 30000; ++rowId) {
+                if (rowId % 2 == 0) evens.add(rowId);
+                if (rowId % 3 == 0) threes.add(rowId);
+            }
+            threes.add(RowId(1) << 40);
+            assertEqual(uint64_t(15000), evens.cardinality(), "Dense container keeps every value");
+            RoaringBitmap sixes = RoaringBitmap::intersect(evens, threes);
+            assertEqual(uint64_t(5000), sixes.cardinality(), "AND of two bitset containers");
+            assertTrue(sixes.contains(29994) && !sixes.contains(29995), "AND keeps only common values");
+            RoaringBitmap either = RoaringBitmap::unite(evens, threes);
+            assertEqual(uint64_t(20001), either.cardinality(), "OR across containers");
+            assertTrue(either.contains(RowId(1) << 40), "OR keeps the sparse high container");
+            RoaringBitmap restored;
+            assertTrue(restored.deserialize(either.serialize()), "Serialized bitmap should load");
+            assertTrue(restored == either, "Serialization round-trips");
+            for (RowId rowId = 0; rowId < 30000; rowId += 2) {
+                evens.remove(rowId);
+            }
+            assertTrue(evens.isEmpty(), "Removing every value empties the bitmap");
+
+            auto ctx = createTestContext();
+            ctx.executor->execute(Parser("CREATE TABLE orders (id INT, status INT, region INT, note VARCHAR(20));").parse());
+            for (int i = 1; i <= 300; ++i) {
+                ctx.executor->execute(Parser(QString("INSERT INTO orders VALUES (%1, %2, %3, 'n%1');")
+                                                 .arg(i).arg(i % 4).arg(i % 7)).parse());
+            }
+
+            QueryResult statusResult = ctx.executor->execute(
+                Parser("CREATE BITMAP INDEX idx_status ON orders(status);").parse());
+            assertTrue(statusResult.success, "CREATE BITMAP INDEX should succeed");
+            QueryResult regionResult = ctx.executor->execute(
+                Parser("CREATE INDEX idx_region ON orders(region) USING BITMAP;").parse());
+            assertTrue(regionResult.success, "USING BITMAP should succeed");
+            QueryResult uniqueBitmap = ctx.executor->execute(
+                Parser("CREATE UNIQUE BITMAP INDEX idx_bad ON orders(id);").parse());
+            assertFalse(uniqueBitmap.success, "UNIQUE BITMAP index should be rejected");
+
+            Catalog* catalog = ctx.dbManager->getCurrentCatalog();
+            const IndexDef* statusIndex = catalog->getIndex("idx_status");
+            assertNotNull(statusIndex, "Bitmap index should be in the catalog");
+            assertTrue(statusIndex->indexType == IndexType::BITMAP, "Index type should be BITMAP");
+            BitmapIndex bitmaps(ctx.dbManager->getCurrentBufferPool(), statusIndex->keyType, statusIndex->rootPageId);
+            assertTrue(bitmaps.load(), "Bitmap index should load");
+            assertEqual(4, bitmaps.distinctCount(), "One bitmap per distinct status");
+            assertEqual(uint64_t(300), bitmaps.totalCardinality(), "Every row is indexed");
+
+            // 多个条件在位图上求交
+            auto countMatches = [](int status, const QSet<int>& regions) {
+                int count = 0;
+                for (int i = 1; i <= 300; ++i) {
+                    if (i % 4 == status && regions.contains(i % 7)) count++;
+                }
+                return count;
+            };
+            QueryResult combined = ctx.executor->execute(
+                Parser("SELECT id FROM orders WHERE status = 1 AND region IN (3, 5);").parse());
+            assertTrue(combined.success, "Bitmap AND/OR query should succeed");
+            assertEqual(qsizetype(countMatches(1, {3, 5})), combined.rows.size(), "AND of EQ and IN bitmaps");
+            for (const auto& row : combined.rows) {
+                const int id = row[0].toInt();
+                assertTrue(id % 4 == 1 && (id % 7 == 3 || id % 7 == 5), "Only matching rows are returned");
+            }
+            QueryResult none = ctx.executor->execute(
+                Parser("SELECT id FROM orders WHERE status = 9 AND region = 3;").parse());
+            assertEqual(qsizetype(0), none.rows.size(), "Missing value yields an empty bitmap");
+
+            // INSERT / UPDATE / DELETE 维护位图
+            ctx.executor->execute(Parser("INSERT INTO orders VALUES (301, 1, 3, 'new');").parse());
+            ctx.executor->execute(Parser("UPDATE orders SET status = 2 WHERE id = 5;").parse());
+            ctx.executor->execute(Parser("DELETE FROM orders WHERE status = 1 AND region = 5;").parse());
+            QueryResult afterDml = ctx.executor->execute(
+                Parser("SELECT id FROM orders WHERE status = 1 AND region IN (3, 5);").parse());
+            int expected = 1;  // 新插入的 301
+            for (int i = 1; i <= 300; ++i) {
+                if (i != 5 && i % 4 == 1 && i % 7 == 3) expected++;
+            }
+            assertEqual(qsizetype(expected), afterDml.rows.size(), "Bitmaps follow INSERT, UPDATE and DELETE");
+            QueryResult moved = ctx.executor->execute(
+                Parser("SELECT id FROM orders WHERE status = 2 AND region = 5;").parse());
+            bool foundMoved = false;
+            for (const auto& row : moved.rows) {
+                foundMoved = foundMoved || row[0].toInt() == 5;
+            }
+            assertTrue(foundMoved, "Updated row is found under its new value");
+
+            addResult("testBitmapIndex", true, "Bitmap indexes answer multi-predicate filters", stopTimer());
+        } catch (const std::exception& e) {
+            addResult("testBitmapIndex", false, QString("Exception: %1").arg(e.what()), stopTimer());
+        }
+    }
+
+    void testRoaringBitmapAvx2() {
+        startTimer();
+
+        // 断言失败抛出异常时也要恢复 AVX2 开关
+        struct Avx2Reset {
+            ~Avx2Reset() { RoaringBitmap::setAvx2Allowed(true); }
+        } avx2Reset;
+
+        try {
+            // 随机的稠密位图：前三个桶都是位图容器，最后一个桶保持数组容器
+            std::mt19937_64 rng(92);
+            int cases = 0;
+            for (int round = 0; round < 8; ++round) {
+                RoaringBitmap a;
+                RoaringBitmap b;
+                QSet<RowId> setA;
+                QSet<RowId> setB;
+                const uint64_t density = 2 + round % 4;
+                for (RowId rowId = 0; rowId < 3 * 65536; ++rowId) {
+                    if (rng() % density == 0) { a.add(rowId); setA.insert(rowId); }
+                    if (rng() % density == 0) { b.add(rowId); setB.insert(rowId); }
+                }
+                for (int i = 0; i < 100; ++i) {
+                    const RowId rowId = 3 * 65536 + rng() % 65536;
+                    a.add(rowId);
+                    setA.insert(rowId);
+                }
+
+                RoaringBitmap::setAvx2Allowed(true);
+                const RoaringBitmap andAvx2 = RoaringBitmap::intersect(a, b);
+                const RoaringBitmap orAvx2 = RoaringBitmap::unite(a, b);
+                RoaringBitmap::setAvx2Allowed(false);
+                const RoaringBitmap andScalar = RoaringBitmap::intersect(a, b);
+                const RoaringBitmap orScalar = RoaringBitmap::unite(a, b);
+
+                const QString where = QString("round %1").arg(round);
+                assertTrue(andAvx2 == andScalar, "AND matches the scalar path: " + where);
+                assertTrue(orAvx2 == orScalar, "OR matches the scalar path: " + where);
+                assertEqual(andScalar.cardinality(), uint64_t((setA & setB).size()), "AND cardinality: " + where);
+                assertEqual(orScalar.cardinality(), uint64_t((setA | setB).size()), "OR cardinality: " + where);
+                assertEqual(andAvx2.cardinality(), andScalar.cardinality(), "AND popcount: " + where);
+                assertEqual(orAvx2.cardinality(), orScalar.cardinality(), "OR popcount: " + where);
+                ++cases;
+            }
+            RoaringBitmap::setAvx2Allowed(true);
+
+            addResult("testRoaringBitmapAvx2", true,
+                      QString("%1 random bitmap pairs, AVX2 %2").arg(cases)
+                          .arg(RoaringBitmap::isAvx2Enabled() ? "compared with scalar" : "not available, scalar only"),
+                      stopTimer());
+        } catch (const std::exception& e) {
+            addResult("testRoaringBitmapAvx2", false, QString("Exception: %1").arg(e.what()), stopTimer());
+        }
+    }
+
+    void testRTreeIndex() {
+        startTimer();
+        try {
+            auto ctx = createTestContext();
+            BufferPoolManager* bufferPool = ctx.dbManager->getCurrentBufferPool();
+
+            // 小节点让树长到好几层：插入、强制重插、分裂、删除后的收缩都要保持结构正确
+            QVector<BoundingBox> boxes;
+            uint32_t seed = 12345;
+            auto nextCoord = [&seed]() {
+                seed = seed * 1103515245u + 12345u;
+                return double((seed >> 8) % 100000) / 100.0;
+            };
+            RTreeIndex rtree(bufferPool);
+            assertTrue(rtree.create(8), "R-tree should be created");
+            for (int i = 0; i < 600; ++i) {
+                const double x = nextCoord();
+                const double y = nextCoord();
+                boxes.append(BoundingBox(x, y, x + (i % 5), y + (i % 3)));
+                assertTrue(rtree.insert(boxes[i], RowId(i + 1)), "Insert into R-tree");
+            }
+            assertTrue(rtree.height() > 2, "Small nodes should give a multi-level tree");
+            assertTrue(rtree.checkStructure(), "R-tree structure after inserts");
+
+            auto bruteForce = [&boxes](const BoundingBox& query, const QSet<int>& removed) {
+                QSet<RowId> expected;
+                for (int i = 0; i < boxes.size(); ++i) {
+                    if (!removed.contains(i) && boxes[i].intersects(query)) expected.insert(RowId(i + 1));
+                }
+                return expected;
+            };
+            const BoundingBox window(200, 300, 450, 520);
+            QVector<RowId> found;
+            assertTrue(rtree.search(window, found), "Window search");
+            assertTrue(QSet<RowId>(found.begin(), found.end()) == bruteForce(window, {}),
+                       "Window search matches brute force");
+
+            const BoundingBox probe = BoundingBox::ofPoint(500, 500);
+            QVector<RowId> nearest;
+            assertTrue(rtree.nearest(probe, 10, nearest), "Nearest-neighbour search");
+            assertEqual(qsizetype(10), nearest.size(), "k nearest entries");
+            QVector<double> distances;
+            for (const BoundingBox& box : boxes) distances.append(box.distanceTo(probe));
+            std::sort(distances.begin(), distances.end());
+            for (int i = 0; i < nearest.size(); ++i) {
+                assertTrue(boxes[int(nearest[i]) - 1].distanceTo(probe) == distances[i],
+                           "Nearest entries come back in distance order");
+            }
+
+            QSet<int> removed;
+            for (int i = 0; i < boxes.size(); i += 3) {
+                assertTrue(rtree.remove(boxes[i], RowId(i + 1)), "Remove from R-tree");
+                removed.insert(i);
+            }
+            assertFalse(rtree.remove(boxes[0], RowId(1)), "Removing a missing entry fails");
+            assertTrue(rtree.checkStructure(), "R-tree structure after deletes");
+            assertEqual(uint64_t(boxes.size() - removed.size()), rtree.size(), "Entry count after deletes");
+            found.clear();
+            assertTrue(rtree.search(window, found), "Window search after deletes");
+            assertTrue(QSet<RowId>(found.begin(), found.end()) == bruteForce(window, removed),
+                       "Window search after deletes matches brute force");
+            rtree.destroy();
+
+            // SQL：CREATE INDEX ... USING RTREE / CREATE SPATIAL INDEX，空间谓词和最近邻查询
+            ctx.executor->execute(Parser("CREATE TABLE places (id INT, geom GEOMETRY NOT NULL, name VARCHAR(20));").parse());
+            seed = 777;
+            for (int i = 1; i <= 400; ++i) {
+                ctx.executor->execute(Parser(QString("INSERT INTO places VALUES (%1, 'POINT(%2 %3)', 'p%1');")
+                                                 .arg(i).arg(nextCoord()).arg(nextCoord())).parse());
+            }
+            ctx.executor->execute(Parser(
+                "INSERT INTO places VALUES (401, 'POLYGON((10 10, 20 10, 20 20, 10 20, 10 10))', 'park');").parse());
+
+            const QString knnQuery =
+                "SELECT * FROM places ORDER BY ST_Distance(geom, ST_Point(512.5, 488.25)) LIMIT 7;";
+            const QString windowQuery =
+                "SELECT id FROM places WHERE MBRIntersects(geom, ST_MakeEnvelope(100, 100, 300, 250));";
+            const QString withinQuery =
+                "SELECT id FROM places WHERE ST_DWithin(geom, ST_Point(15, 25), 6);";
+            auto ids = [](const QueryResult& result) {
+                QVector<int> values;
+                for (const auto& row : result.rows) values.append(row[0].toInt());
+                return values;
+            };
+            auto sortedIds = [&ids](const QueryResult& result) {
+                QVector<int> values = ids(result);
+                std::sort(values.begin(), values.end());
+                return values;
+            };
+            const QVector<int> knnBaseline = ids(ctx.executor->execute(Parser(knnQuery).parse()));
+            const QVector<int> windowBaseline = sortedIds(ctx.executor->execute(Parser(windowQuery).parse()));
+            assertEqual(qsizetype(7), knnBaseline.size(), "Full scan returns k rows");
+            assertFalse(windowBaseline.isEmpty(), "Window should contain some points");
+
+            QueryResult badType = ctx.executor->execute(
+                Parser("CREATE INDEX idx_bad ON places(id) USING RTREE;").parse());
+            assertFalse(badType.success, "RTREE on an INT column should be rejected");
+            QueryResult uniqueRtree = ctx.executor->execute(
+                Parser("CREATE UNIQUE INDEX idx_bad ON places(geom) USING RTREE;").parse());
+            assertFalse(uniqueRtree.success, "UNIQUE RTREE index should be rejected");
+            QueryResult btreeGeom = ctx.executor->execute(
+                Parser("CREATE INDEX idx_bad ON places(geom);").parse());
+            assertFalse(btreeGeom.success, "GEOMETRY columns need USING RTREE");
+            QueryResult created = ctx.executor->execute(
+                Parser("CREATE SPATIAL INDEX idx_geom ON places(geom);").parse());
+            assertTrue(created.success, "CREATE SPATIAL INDEX should succeed");
+            const IndexDef* geomIndex = ctx.dbManager->getCurrentCatalog()->getIndex("idx_geom");
+            assertNotNull(geomIndex, "R-tree index should be in the catalog");
+            assertTrue(geomIndex->indexType == IndexType::RTREE, "Index type should be RTREE");
+
+            assertTrue(ids(ctx.executor->execute(Parser(knnQuery).parse())) == knnBaseline,
+                       "Nearest-neighbour ORDER BY matches the full scan");
+            assertTrue(sortedIds(ctx.executor->execute(Parser(windowQuery).parse())) == windowBaseline,
+                       "MBRIntersects over the index matches the full scan");
+            QueryResult within = ctx.executor->execute(Parser(withinQuery).parse());
+            assertTrue(sortedIds(within).contains(401), "ST_DWithin finds the polygon within distance");
+            QueryResult polygon = ctx.executor->execute(Parser("SELECT geom FROM places WHERE id = 401;").parse());
+            assertEqual(QString("POLYGON((10 10, 20 10, 20 20, 10 20, 10 10))"), polygon.rows[0][0].toString(),
+                        "Polygon round-trips through WKB");
+
+            // INSERT / UPDATE / DELETE 维护 R 树
+            ctx.executor->execute(Parser("INSERT INTO places VALUES (402, 'POINT(512 488)', 'near');").parse());
+            QueryResult afterInsert = ctx.executor->execute(Parser(knnQuery).parse());
+            assertEqual(402, afterInsert.rows[0][0].toInt(), "Inserted point becomes the nearest");
+            ctx.executor->execute(Parser("UPDATE places SET geom = 'POINT(900 900)' WHERE id = 402;").parse());
+            assertTrue(ids(ctx.executor->execute(Parser(knnQuery).parse())) == knnBaseline,
+                       "Moved point no longer appears near the probe");
+            QueryResult moved = ctx.executor->execute(Parser(
+                "SELECT id FROM places WHERE MBRIntersects(geom, ST_MakeEnvelope(899, 899, 901, 901));").parse());
+            assertTrue(ids(moved).contains(402), "Updated point is found at its new location");
+            ctx.executor->execute(Parser(QString("DELETE FROM places WHERE id = %1;").arg(knnBaseline[0])).parse());
+            const QVector<int> afterDelete = ids(ctx.executor->execute(Parser(knnQuery).parse()));
+            assertTrue(afterDelete.mid(0, 6) == knnBaseline.mid(1), "Deleted row drops out of the nearest rows");
+
+            RTreeIndex stored(bufferPool, geomIndex->rootPageId);
+            assertTrue(stored.load() && stored.checkStructure(), "Index structure after DML");
+            assertEqual(uint64_t(401), stored.size(), "One entry per live row");
+
+            addResult("testRTreeIndex", true, "R-tree answers window and nearest-neighbour queries", stopTimer());
+        } catch (const std::exception& e) {
+            addResult("testRTreeIndex", false, QString("Exception: %1").arg(e.what()), stopTimer());
+        }
+    }
+
+    void testTrieIndex() {
+        startTimer();
+        try {
+            auto ctx = createTestContext();
+            BufferPoolManager* bufferPool = ctx.dbManager->getCurrentBufferPool();
+
+            // 小字母表让键大量共享前缀：节点分裂、路径压缩和删除后的合并都要保持结构正确
+            QVector<QPair<QString, RowId>> entries;
+            uint32_t seed = 4242;
+            const QString alphabet = QString::fromUtf8("abcé中");
+            for (int i = 0; i < 800; ++i) {
+                QString value;
+                seed = seed * 1103515245u + 12345u;
+                const int length = (seed >> 8) % 7;
+                for (int j = 0; j < length; ++j) {
+                    seed = seed * 1103515245u + 12345u;
+                    value.append(alphabet[(seed >> 8) % alphabet.size()]);
+                }
+                entries.append(qMakePair(value, RowId(i + 1)));
+            }
+            auto expectedPrefix = [&entries](const QString& prefix, const QSet<RowId>& removed) {
+                QVector<QPair<QString, RowId>> expected;
+                for (const auto& entry : entries) {
+                    if (!removed.contains(entry.second) && entry.first.startsWith(prefix)) expected.append(entry);
+                }
+                std::sort(expected.begin(), expected.end());
+                QVector<RowId> rowIds;
+                for (const auto& entry : expected) rowIds.append(entry.second);
+                return rowIds;
+            };
+
+            TrieIndex trie(bufferPool);
+            assertTrue(trie.create(), "Trie should be created");
+            for (const auto& entry : entries) {
+                assertTrue(trie.insert(entry.first, entry.second), "Insert into trie");
+            }
+            assertTrue(trie.checkStructure(), "Trie structure after inserts");
+            assertEqual(uint64_t(entries.size()), trie.size(), "Entry count after inserts");
+
+            QVector<RowId> found;
+            QStringList values;
+            assertTrue(trie.prefixSearch("ab", 0, found, &values), "Prefix search");
+            assertTrue(found == expectedPrefix("ab", {}), "Prefix search returns rows in value order");
+            for (const QString& value : values) {
+                assertTrue(value.startsWith("ab"), "Prefix search returns the stored values");
+            }
+            found.clear();
+            assertTrue(trie.prefixSearch("a", 5, found), "Prefix search with limit");
+            assertTrue(found == expectedPrefix("a", {}).mid(0, 5), "Limit keeps the first rows in order");
+            found.clear();
+            assertTrue(trie.lookup("ab", found), "Exact lookup");
+            for (RowId rowId : found) {
+                assertEqual(QString("ab"), entries[int(rowId) - 1].first, "Exact lookup excludes longer values");
+            }
+
+            QSet<RowId> removed;
+            for (int i = 0; i < entries.size(); i += 3) {
+                assertTrue(trie.remove(entries[i].first, entries[i].second), "Remove from trie");
+                removed.insert(entries[i].second);
+            }
+            assertFalse(trie.remove(entries[0].first, entries[0].second), "Removing a missing entry fails");
+            assertTrue(trie.checkStructure(), "Trie structure after deletes");
+            found.clear();
+            assertTrue(trie.prefixSearch(QString::fromUtf8("中"), 0, found), "Prefix search after deletes");
+            assertTrue(found == expectedPrefix(QString::fromUtf8("中"), removed),
+                       "Prefix search after deletes matches brute force");
+            trie.destroy();
+
+            TrieIndex bulk(bufferPool);
+            assertTrue(bulk.create() && bulk.bulkLoad(entries), "Bulk load trie");
+            assertTrue(bulk.checkStructure(), "Trie structure after bulk load");
+            found.clear();
+            assertTrue(bulk.prefixSearch(QString(), 0, found), "Ordered iteration over the whole trie");
+            assertTrue(found == expectedPrefix(QString(), {}), "Bulk-loaded trie iterates in value order");
+            bulk.destroy();
+
+            // 删除叶子空出的页挂到空闲页链表，之后的插入复用它们而不是一直分配新页
+            DiskManager* diskManager = ctx.dbManager->getCurrentDiskManager();
+            TrieIndex reuse(bufferPool);
+            assertTrue(reuse.create(), "Trie should be created");
+            const QString padding(300, QLatin1Char('x'));
+            for (int i = 0; i < 200; ++i) {
+                assertTrue(reuse.insert(QString("%1%2").arg(i, 4, 10, QLatin1Char('0')).arg(padding), RowId(i + 1)),
+                           "Insert long value");
+            }
+            for (int i = 0; i < 200; i += 2) {
+                assertTrue(reuse.remove(QString("%1%2").arg(i, 4, 10, QLatin1Char('0')).arg(padding), RowId(i + 1)),
+                           "Remove long value");
+            }
+            const size_t pagesBefore = diskManager->getNumPages();
+            for (int i = 0; i < 200; i += 2) {
+                assertTrue(reuse.insert(QString("r%1%2").arg(i, 4, 10, QLatin1Char('0')).arg(padding.left(250)),
+                                        RowId(i + 1001)),
+                           "Reinsert long value");
+            }
+            assertTrue(diskManager->getNumPages() <= pagesBefore + 1, "Freed space is reused for new leaves");
+            TrieIndex reloaded(bufferPool, reuse.getMetaPageId());
+            assertTrue(reloaded.load() && reloaded.checkStructure(), "Trie structure after reusing freed pages");
+            assertEqual(uint64_t(200), reloaded.size(), "Entry count after reusing freed pages");
+            reuse.destroy();
+
+            // SQL：CREATE INDEX ... USING TRIE，LIKE 前缀查询和 DML 维护
+            ctx.executor->execute(Parser("CREATE TABLE words (id INT, word VARCHAR(40), note VARCHAR(20));").parse());
+            const QStringList stems = {"apple", "apply", "banana", "band"};
+            for (int i = 1; i <= 300; ++i) {
+                ctx.executor->execute(Parser(QString("INSERT INTO words VALUES (%1, '%2%1', 'n%1');")
+                                                 .arg(i).arg(stems[i % 4])).parse());
+            }
+
+            const QString prefixQuery = "SELECT id FROM words WHERE word LIKE 'appl%';";
+            const QString patternQuery = "SELECT id FROM words WHERE word LIKE 'ban_na1%' AND id > 100;";
+            auto sortedIds = [](const QueryResult& result) {
+                QVector<int> values;
+                for (const auto& row : result.rows) values.append(row[0].toInt());
+                std::sort(values.begin(), values.end());
+                return values;
+            };
+            const QVector<int> prefixBaseline = sortedIds(ctx.executor->execute(Parser(prefixQuery).parse()));
+            const QVector<int> patternBaseline = sortedIds(ctx.executor->execute(Parser(patternQuery).parse()));
+            assertEqual(qsizetype(150), prefixBaseline.size(), "LIKE prefix matches apple% and apply%");
+            assertEqual(qsizetype(25), patternBaseline.size(), "LIKE with '_' matches banana1xx rows");
+
+            QueryResult badType = ctx.executor->execute(
+                Parser("CREATE INDEX idx_bad ON words(id) USING TRIE;").parse());
+            assertFalse(badType.success, "TRIE on an INT column should be rejected");
+            QueryResult uniqueTrie = ctx.executor->execute(
+                Parser("CREATE UNIQUE INDEX idx_bad ON words(word) USING TRIE;").parse());
+            assertFalse(uniqueTrie.success, "UNIQUE TRIE index should be rejected");
+            QueryResult created = ctx.executor->execute(
+                Parser("CREATE INDEX idx_word ON words(word) USING TRIE;").parse());
+            assertTrue(created.success, "CREATE INDEX ... USING TRIE should succeed");
+            const IndexDef* wordIndex = ctx.dbManager->getCurrentCatalog()->getIndex("idx_word");
+            assertNotNull(wordIndex, "Trie index should be in the catalog");
+            assertTrue(wordIndex->indexType == IndexType::TRIE, "Index type should be TRIE");
+
+            assertTrue(sortedIds(ctx.executor->execute(Parser(prefixQuery).parse())) == prefixBaseline,
+                       "LIKE prefix over the index matches the full scan");
+            assertTrue(sortedIds(ctx.executor->execute(Parser(patternQuery).parse())) == patternBaseline,
+                       "LIKE with wildcards after the prefix matches the full scan");
+            QueryResult limited = ctx.executor->execute(
+                Parser("SELECT word FROM words WHERE word LIKE 'apple%' LIMIT 5;").parse());
+            assertEqual(qsizetype(5), limited.rows.size(), "LIMIT over the index returns k rows");
+            for (const auto& row : limited.rows) {
+                assertTrue(row[0].toString().startsWith("apple"), "Limited rows satisfy the prefix");
+            }
+
+            // INSERT / UPDATE / DELETE 维护 TRIE
+            ctx.executor->execute(Parser("INSERT INTO words VALUES (301, 'applesauce', 'new');").parse());
+            QueryResult inserted = ctx.executor->execute(
+                Parser("SELECT id FROM words WHERE word LIKE 'applesa%';").parse());
+            assertTrue(sortedIds(inserted) == QVector<int>{301}, "Inserted word is found by prefix");
+            ctx.executor->execute(Parser("UPDATE words SET word = 'zebra' WHERE id = 301;").parse());
+            assertTrue(ctx.executor->execute(Parser("SELECT id FROM words WHERE word LIKE 'applesa%';").parse())
+                           .rows.isEmpty(), "Updated word no longer matches the old prefix");
+            QueryResult renamed = ctx.executor->execute(Parser("SELECT id FROM words WHERE word = 'zebra';").parse());
+            assertTrue(sortedIds(renamed) == QVector<int>{301}, "Updated word is found by equality");
+            ctx.executor->execute(Parser("DELETE FROM words WHERE word LIKE 'band%';").parse());
+            assertTrue(ctx.executor->execute(Parser("SELECT id FROM words WHERE word LIKE 'band%';").parse())
+                           .rows.isEmpty(), "Deleted rows drop out of the index");
+
+            TrieIndex stored(bufferPool, wordIndex->rootPageId);
+            assertTrue(stored.load() && stored.checkStructure(), "Index structure after DML");
+            assertEqual(uint64_t(226), stored.size(), "One entry per live row");
+
+            // CHAR 的填充空格不进索引：插入时带空格的值与表页读出的值是同一个键
+            ctx.executor->execute(Parser("CREATE TABLE codes (id INT, code CHAR(8));").parse());
+            ctx.executor->execute(Parser("CREATE INDEX idx_code ON codes(code) USING TRIE;").parse());
+            ctx.executor->execute(Parser("INSERT INTO codes VALUES (1, 'ab  ');").parse());
+            ctx.executor->execute(Parser("INSERT INTO codes VALUES (2, 'abc');").parse());
+            QueryResult padded = ctx.executor->execute(Parser("SELECT id FROM codes WHERE code = 'ab';").parse());
+            assertTrue(sortedIds(padded) == QVector<int>{1}, "Padded CHAR value is found by equality");
+            ctx.executor->execute(Parser("DELETE FROM codes WHERE id = 1;").parse());
+            const IndexDef* codeIndex = ctx.dbManager->getCurrentCatalog()->getIndex("idx_code");
+            assertNotNull(codeIndex, "CHAR trie index should be in the catalog");
+            TrieIndex codes(bufferPool, codeIndex->rootPageId);
+            assertTrue(codes.load(), "CHAR trie index should load");
+            assertEqual(uint64_t(1), codes.size(), "Deleting a padded CHAR row removes its entry");
+
+            addResult("testTrieIndex", true, "Trie answers prefix LIKE and equality queries", stopTimer());
+        } catch (const std::exception& e) {
+            addResult("testTrieIndex", false, QString("Exception: %1").arg(e.what()), stopTimer());
+        }
+    }
+
+    void testPlanDrivenSelect() {
+        startTimer();
+        try {
+            auto ctx = createTestContext();
+
+            ctx.executor->execute(Parser("CREATE TABLE depts (did INT, dname VARCHAR(20));").parse());
+            ctx.executor->execute(Parser("CREATE TABLE staff (sid INT, dept INT, salary INT);").parse());
+            for (int i = 1; i <= 10; ++i) {
+                ctx.executor->execute(Parser(QString("INSERT INTO depts VALUES (%1, 'd%1');").arg(i)).parse());
+            }
+            // 部门 11、12 不存在；37 与 1000 互素，工资两两不同
+            for (int i = 1; i <= 200; ++i) {
+                ctx.executor->execute(Parser(QString("INSERT INTO staff VALUES (%1, %2, %3);")
+                                                 .arg(i).arg(i % 12 + 1).arg(i * 37 % 1000)).parse());
+            }
+            // 两侧的 NULL 键：NULL = NULL 不成立，嵌套循环和哈希连接都不匹配它们
+            ctx.executor->execute(Parser("INSERT INTO depts VALUES (NULL, 'unassigned');").parse());
+            ctx.executor->execute(Parser("INSERT INTO staff VALUES (201, NULL, 5);").parse());
+
+            const QString joinQuery = "SELECT * FROM staff JOIN depts ON staff.dept = depts.did;";
+            const QString topQuery = "SELECT * FROM staff ORDER BY salary DESC LIMIT 5;";
+            const QString fullQuery = "SELECT * FROM staff ORDER BY salary DESC;";
+            auto sortedIds = [](const QueryResult& result) {
+                QVector<int> values;
+                for (const auto& row : result.rows) values.append(row[0].toInt());
+                std::sort(values.begin(), values.end());
+                return values;
+            };
+
+            // 没有统计信息：执行器按规则选择连接方式
+            QueryResult ruleJoin = ctx.executor->execute(Parser(joinQuery).parse());
+            assertTrue(ruleJoin.success, "Join without statistics should succeed");
+            assertEqual(qsizetype(168), ruleJoin.rows.size(), "Staff in departments 1-10 join");
+
+            QueryResult analyzeResult = ctx.executor->execute(Parser("ANALYZE;").parse());
+            assertTrue(analyzeResult.success, "ANALYZE should succeed");
+
+            // 有统计信息：按优化器选出的连接算法和构建侧执行，结果不变
+            QueryResult planJoin = ctx.executor->execute(Parser(joinQuery).parse());
+            assertTrue(planJoin.success, "Planned join should succeed");
+            assertTrue(sortedIds(planJoin) == sortedIds(ruleJoin), "Planned join returns the same rows");
+            for (const auto& row : planJoin.rows) {
+                assertEqual(qsizetype(5), row.size(), "Joined rows keep left columns before right columns");
+                assertEqual(row[1].toInt(), row[3].toInt(), "Joined rows should have equal keys");
+            }
+
+            QueryResult nullCompare = ctx.executor->execute(Parser("SELECT * FROM staff WHERE dept = NULL;").parse());
+            assertTrue(nullCompare.success, "Comparison with NULL should succeed");
+            assertEqual(qsizetype(0), nullCompare.rows.size(), "dept = NULL is unknown, not true");
+            QueryResult isNull = ctx.executor->execute(Parser("SELECT * FROM staff WHERE dept IS NULL;").parse());
+            assertEqual(qsizetype(1), isNull.rows.size(), "IS NULL finds the NULL key");
+
+            // LIMIT 之上的排序只排出前 k 行
+            QueryResult top = ctx.executor->execute(Parser(topQuery).parse());
+            QueryResult full = ctx.executor->execute(Parser(fullQuery).parse());
+            assertEqual(qsizetype(5), top.rows.size(), "ORDER BY ... LIMIT returns k rows");
+            assertEqual(qsizetype(201), full.rows.size(), "ORDER BY without LIMIT returns every row");
+            for (int i = 0; i < top.rows.size(); ++i) {
+                assertEqual(full.rows[i][0].toInt(), top.rows[i][0].toInt(), "Top-N matches the full sort");
+            }
+
+            // EXPLAIN ANALYZE：执行查询并在每个节点上报告实际行数和耗时
+            QueryResult explained = ctx.executor->execute(Parser("EXPLAIN " + fullQuery).parse());
+            assertTrue(explained.success, "EXPLAIN should succeed");
+            assertFalse(explained.rows[0][0].toString().contains("actual"), "EXPLAIN does not execute the query");
+
+            QueryResult analyzed = ctx.executor->execute(Parser("EXPLAIN ANALYZE " + topQuery).parse());
+            assertTrue(analyzed.success, "EXPLAIN ANALYZE should succeed");
+            const QString planText = analyzed.rows[0][0].toString();
+            assertTrue(planText.contains("Limit") && planText.contains("Sort") && planText.contains("SeqScan"),
+                       "Plan shows limit, sort and scan nodes");
+            assertTrue(planText.contains("actual time=") && planText.contains("rows=5)"),
+                       "Plan reports actual rows per node");
+            assertTrue(planText.contains("rows=201)"), "Scan node reports the rows it produced");
+            assertTrue(planText.contains("Execution time:"), "Plan reports total execution time");
+            assertTrue(analyzed.message.contains("5 rows returned"), "Message reports the returned rows");
+
+            addResult("testPlanDrivenSelect", true, "SELECT follows the optimizer plan; EXPLAIN ANALYZE reports actuals",
+                      stopTimer());
+        } catch (const std::exception& e) {
+            addResult("testPlanDrivenSelect", false, QString("Exception: %1").arg(e.what()), stopTimer());
+        }
+    }
+
+    void testPersistedStatistics() {
+        startTimer();
+        try {
+            auto ctx = createTestContext();
+            Catalog* catalog = ctx.dbManager->getCurrentCatalog();
+
+            ctx.executor->execute(Parser("CREATE TABLE metrics (id INT, tag VARCHAR(10));").parse());
+            for (int i = 1; i <= 20; ++i) {
+                ctx.executor->execute(Parser(QString("INSERT INTO metrics VALUES (%1, 't%2');")
+                                                 .arg(i).arg(i % 3)).parse());
+            }
+            assertTrue(catalog->getTableStats("metrics") == nullptr, "No statistics before ANALYZE");
+
+            QueryResult analyzeResult = ctx.executor->execute(Parser("ANALYZE TABLE metrics;").parse());
+            assertTrue(analyzeResult.success, "ANALYZE should succeed");
+            auto stats = catalog->getTableStats("METRICS");
+            assertNotNull(stats.get(), "ANALYZE publishes statistics to the catalog");
+            assertEqual(size_t(20), stats->numRows, "Row count after ANALYZE");
+            const ColumnStats* tagStats = stats->getColumnStats("tag");
+            assertNotNull(tagStats, "Column statistics are collected");
+            assertEqual(size_t(3), tagStats->numDistinctValues, "Distinct tags");
+
+            // DML 增量维护行数；改动超过 50 + 10% 行数时自动重新收集
+            ctx.executor->execute(Parser("DELETE FROM metrics WHERE id <= 5;").parse());
+            stats = catalog->getTableStats("metrics");
+            assertEqual(size_t(15), stats->numRows, "DELETE decrements the row count");
+            assertEqual(size_t(5), stats->modifiedRows, "DELETE counts as modification");
+            ctx.executor->execute(Parser("UPDATE metrics SET tag = 't9' WHERE id = 6;").parse());
+            assertEqual(size_t(6), catalog->getTableStats("metrics")->modifiedRows, "UPDATE counts as modification");
+
+            // 显式事务中的改动在 COMMIT 时才计入，ROLLBACK 的改动不计入
+            ctx.executor->execute(Parser("BEGIN;").parse());
+            ctx.executor->execute(Parser("DELETE FROM metrics WHERE id > 10;").parse());
+            assertEqual(size_t(15), catalog->getTableStats("metrics")->numRows, "Uncommitted DELETE is not counted");
+            ctx.executor->execute(Parser("ROLLBACK;").parse());
+            stats = catalog->getTableStats("metrics");
+            assertEqual(size_t(15), stats->numRows, "Rolled back DELETE is not counted");
+            assertEqual(size_t(6), stats->modifiedRows, "Rolled back DELETE is not a modification");
+
+            ctx.executor->execute(Parser("BEGIN;").parse());
+            for (int i = 21; i <= 80; ++i) {
+                ctx.executor->execute(Parser(QString("INSERT INTO metrics VALUES (%1, 'x%1');").arg(i)).parse());
+            }
+            assertEqual(size_t(15), catalog->getTableStats("metrics")->numRows, "Uncommitted INSERT is not counted");
+            ctx.executor->execute(Parser("COMMIT;").parse());
+
+            // 超过阈值后在后台重新收集
+            ctx.dbManager->getCurrentAutoAnalyzer()->waitIdle();
+            stats = catalog->getTableStats("metrics");
+            assertEqual(size_t(75), stats->numRows, "Committed INSERT increments the row count");
+            assertTrue(stats->modifiedRows < 58, "Statistics were refreshed after enough modifications");
+            assertTrue(stats->getColumnStats("tag")->numDistinctValues > 3, "Refreshed column statistics");
+
+            // 统计信息随 Catalog 持久化
+            Catalog reloaded;
+            const QString catalogPath = ctx.dbManager->getDatabasePath("testdb") + "/catalog.json";
+            assertTrue(reloaded.loadFromDisk(catalogPath), "Catalog should reload");
+            auto persisted = reloaded.getTableStats("metrics");
+            assertNotNull(persisted.get(), "Statistics are persisted with the catalog");
+            assertEqual(stats->numRows, persisted->numRows, "Persisted row count");
+            assertEqual(stats->getColumnStats("tag")->numDistinctValues,
+                        persisted->getColumnStats("tag")->numDistinctValues, "Persisted column statistics");
+
+            // 删除表时统计信息一并删除
+            ctx.executor->execute(Parser("DROP TABLE metrics;").parse());
+            assertTrue(catalog->getTableStats("metrics") == nullptr, "DROP TABLE removes statistics");
+
+            addResult("testPersistedStatistics", true, "ANALYZE results live in the catalog and track DML", stopTimer());
+        } catch (const std::exception& e) {
+            addResult("testPersistedStatistics", false, QString("Exception: %1").arg(e.what()), stopTimer());
+        }
+    }
+
+    void testCatalogStatisticsPages() {
+        startTimer();
+        try {
+            const QString dbFile = "test_executor_catalog_stats.db";
+            QFile::remove(dbFile);
+            {
+                DiskManager diskManager(dbFile);
+                BufferPoolManager bufferPool(64, &diskManager);
+                CatalogDbBackend backend(&bufferPool, &diskManager);
+                assertTrue(backend.initialize(), "System tables are created");
+
+                // 20 个表，每个表 3 列、每列 1 KB 草图：统计信息合计远超 sys_tables 的一页
+                QHash<QString, std::shared_ptr<TableDef>> tables;
+                QHash<QString, IndexDef> indexes;
+                QHash<QString, std::shared_ptr<const TableStats>> stats;
+                for (int t = 0; t < 20; ++t) {
+                    auto table = std::make_shared<TableDef>(QString("t%1").arg(t));
+                    TableStats tableStats(table->name);
+                    tableStats.numRows = 1000 + t;
+                    for (int c = 0; c < 3; ++c) {
+                        ColumnDef column;
+                        column.name = QString("c%1").arg(c);
+                        column.type = DataType::INT;
+                        table->columns.append(column);
+
+                        ColumnStats columnStats(column.name, column.type);
+                        columnStats.numDistinctValues = 100 + c;
+                        columnStats.distinctSketch = QByteArray(1024, static_cast<char>(t + c + 1));
+                        tableStats.columnStats.insert(column.name, columnStats);
+                    }
+                    tables.insert(table->name, table);
+                    stats.insert(table->name, std::make_shared<const TableStats>(tableStats));
+                }
+                assertTrue(backend.saveCatalog(tables, indexes, stats), "Catalog with large statistics is saved");
+                assertTrue(backend.saveCatalog(tables, indexes, stats), "Saving unchanged statistics again");
+
+                QHash<QString, std::shared_ptr<TableDef>> loadedTables;
+                QHash<QString, IndexDef> loadedIndexes;
+                QHash<QString, std::shared_ptr<const TableStats>> loadedStats;
+                assertTrue(backend.loadCatalog(loadedTables, loadedIndexes, loadedStats), "Catalog reloads");
+                assertEqual(20, static_cast<int>(loadedTables.size()), "Every table definition is kept");
+                assertEqual(20, static_cast<int>(loadedStats.size()), "Every table keeps its statistics");
+                auto lastStats = loadedStats.value("t19");
+                assertNotNull(lastStats.get(), "Statistics of the last table are loaded");
+                assertEqual(size_t(1019), lastStats->numRows, "Row count round-trips");
+                assertTrue(lastStats->getColumnStats("c2")->distinctSketch == QByteArray(1024, static_cast<char>(22)),
+                           "Sketches round-trip through the statistics pages");
+            }
+            QFile::remove(dbFile);
+
+            addResult("testCatalogStatisticsPages", true, "Statistics live in their own page chains", stopTimer());
+        } catch (const std::exception& e) {
+            addResult("testCatalogStatisticsPages", false, QString("Exception: %1").arg(e.what()), stopTimer());
+        }
+    }
+
+    void testSampledStatistics() {
+        startTimer();
+        try {
+            // HyperLogLog：10000 个不同值（每个加两次）的估计误差在 5% 以内，合并等于并集
+            HyperLogLog sketch;
+            HyperLogLog other;
+            for (int i = 0; i < 10000; ++i) {
+                sketch.addValue(i, DataType::INT);
+                sketch.addValue(static_cast<qint64>(i), DataType::BIGINT);
+                other.addValue(i + 5000, DataType::INT);
+            }
+            assertTrue(std::fabs(sketch.estimate() - 10000.0) < 500.0, "HyperLogLog estimate within 5%");
+            assertTrue(sketch.merge(other), "Sketches of equal precision merge");
+            assertTrue(std::fabs(sketch.estimate() - 15000.0) < 750.0, "Merged sketch estimates the union");
+            HyperLogLog restored(HyperLogLog::MIN_PRECISION);
+            assertTrue(HyperLogLog::fromRegisters(sketch.registers(), restored), "Registers round-trip");
+            assertEqual(sketch.estimate(), restored.estimate(), "Restored sketch gives the same estimate");
+
+            auto ctx = createTestContext();
+            Catalog* catalog = ctx.dbManager->getCurrentCatalog();
+
+            ctx.executor->execute(Parser("CREATE TABLE events (id INT, kind VARCHAR(16));").parse());
+            for (int i = 1; i <= 1000; ++i) {
+                const QString kind = (i % 2 == 0) ? QString("hot") : QString("k%1").arg(i);
+                ctx.executor->execute(Parser(QString("INSERT INTO events VALUES (%1, '%2');")
+                                                 .arg(i).arg(kind)).parse());
+            }
+            assertTrue(ctx.executor->execute(Parser("ANALYZE TABLE events;").parse()).success,
+                       "ANALYZE should succeed");
+
+            auto stats = catalog->getTableStats("events");
+            assertNotNull(stats.get(), "ANALYZE publishes statistics");
+            assertEqual(size_t(1000), stats->numRows, "Exact row count from the full pass");
+
+            const ColumnStats* idStats = stats->getColumnStats("id");
+            assertNotNull(idStats, "id statistics");
+            assertTrue(idStats->numDistinctValues >= 950 && idStats->numDistinctValues <= 1000,
+                       "NDV estimated by HyperLogLog");
+            assertEqual(1.0, idStats->minValue.toDouble(), "Exact minimum");
+            assertEqual(1000.0, idStats->maxValue.toDouble(), "Exact maximum");
+            assertEqual(qsizetype(StatisticsCollector::HISTOGRAM_BUCKETS + 1), idStats->histogramBounds.size(),
+                        "Equi-depth histogram bounds");
+
+            // 等深直方图估算范围选择率
+            const double between = stats->estimateRangeSelectivity("id", 101, 300);
+            assertTrue(std::fabs(between - 0.2) < 0.03, "Histogram range selectivity");
+            const double below = stats->estimateRangeSelectivity("id", QVariant(), 100);
+            assertTrue(std::fabs(below - 0.1) < 0.03, "Open-ended range selectivity");
+
+            // MCV 记录出现次数，不在 MCV 中的值平分其余的行
+            const ColumnStats* kindStats = stats->getColumnStats("kind");
+            assertEqual(size_t(500), kindStats->mcv.value(QString("hot")), "MCV frequency");
+            assertEqual(0.5, stats->estimateSelectivity("kind", QString("hot")), "MCV selectivity");
+            const double rare = stats->estimateSelectivity("kind", QString("k7"));
+            assertTrue(rare > 0.0005 && rare < 0.002, "Non-MCV selectivity");
+            const double prefix = stats->estimatePrefixSelectivity("kind", "k1");
+            assertTrue(prefix > 0.03 && prefix < 0.1, "Prefix selectivity from the string histogram");
+
+            // 直方图随 Catalog 持久化
+            Catalog reloaded;
+            const QString catalogPath = ctx.dbManager->getDatabasePath("testdb") + "/catalog.json";
+            assertTrue(reloaded.loadFromDisk(catalogPath), "Catalog should reload");
+            auto persisted = reloaded.getTableStats("events");
+            assertNotNull(persisted.get(), "Statistics are persisted");
+            assertEqual(idStats->histogramBounds.size(),
+                        persisted->getColumnStats("id")->histogramBounds.size(), "Persisted histogram");
+            assertEqual(between, persisted->estimateRangeSelectivity("id", 101, 300),
+                        "Persisted histogram gives the same estimate");
+
+            addResult("testSampledStatistics", true, "Single-pass ANALYZE builds NDV, MCV and histograms", stopTimer());
+        } catch (const std::exception& e) {
+            addResult("testSampledStatistics", false, QString("Exception: %1").arg(e.what()), stopTimer());
+        }
+    }
+
+    void testExtendedStatistics() {
+        startTimer();
+        try {
+            auto ctx = createTestContext();
+            Catalog* catalog = ctx.dbManager->getCurrentCatalog();
+
+            // 邮编决定城市：10 个城市各 6 个邮编
+            ctx.executor->execute(Parser("CREATE TABLE places (id INT, city VARCHAR(16), zip INT);").parse());
+            ctx.executor->execute(Parser("CREATE TABLE visits (vid INT, place INT);").parse());
+            for (int i = 1; i <= 600; ++i) {
+                const int zip = i % 60;
+                ctx.executor->execute(Parser(QString("INSERT INTO places VALUES (%1, 'c%2', %3);")
+                                                 .arg(i).arg(zip / 6).arg(zip)).parse());
+            }
+            // visits.place 取 401 - 800，与 places.id 重叠 200 个值
+            for (int i = 1; i <= 400; ++i) {
+                ctx.executor->execute(Parser(QString("INSERT INTO visits VALUES (%1, %2);")
+                                                 .arg(i).arg(i + 400)).parse());
+            }
+            assertTrue(ctx.executor->execute(Parser("ANALYZE;").parse()).success, "ANALYZE should succeed");
+
+            auto stats = catalog->getTableStats("places");
+            assertNotNull(stats.get(), "ANALYZE publishes statistics");
+            bool reversed = false;
+            const ColumnGroupStats* group = stats->getColumnGroupStats("zip", "city", &reversed);
+            assertNotNull(group, "Column group statistics for (city, zip)");
+            assertTrue(reversed, "zip is the second column of the group");
+            assertTrue(group->numDistinctValues >= 58 && group->numDistinctValues <= 62, "Multi-column NDV");
+            assertEqual(1.0, group->reverseDependency, "zip determines city");
+            assertTrue(group->dependency < 0.3, "city does not determine zip");
+
+            // 物理顺序相关系数：id 按插入顺序递增，zip 循环
+            assertTrue(stats->getColumnStats("id")->correlation > 0.99, "id follows the physical order");
+            assertTrue(std::fabs(stats->getColumnStats("zip")->correlation) < 0.3, "zip is not correlated");
+
+            StatisticsCollector collector(catalog, ctx.dbManager->getCurrentBufferPool());
+            CostOptimizer optimizer(catalog, &collector);
+
+            // 相关列上的等值条件按函数依赖合并，而不是按独立性假设相乘（1/600）
+            auto whereStmt = Parser("SELECT * FROM places WHERE city = 'c3' AND zip = 21;").parse();
+            auto* whereSelect = dynamic_cast<ast::SelectStatement*>(whereStmt.get());
+            assertNotNull(whereSelect, "Statement should be SelectStatement");
+            const double selectivity = optimizer.estimateSelectivity(whereSelect->where.get(), "places");
+            assertTrue(std::fabs(selectivity - 1.0 / 60) < 0.002, "Dependent equality selectivity");
+
+            // 按两列分组的组数取列组的 NDV
+            auto groupStmt = Parser("SELECT city, zip, COUNT(*) FROM places GROUP BY city, zip;").parse();
+            auto groupPlan = optimizer.optimizeSelect(dynamic_cast<ast::SelectStatement*>(groupStmt.get()));
+            assertNotNull(groupPlan.get(), "GROUP BY plan");
+            assertEqual(group->numDistinctValues, groupPlan->cost.estimatedRows, "Group count from column group NDV");
+
+            // 连接结果行数按连接键草图的重叠估算
+            const QString joinQuery = "SELECT * FROM places JOIN visits ON places.id = visits.place;";
+            auto joinStmt = Parser(joinQuery).parse();
+            auto joinPlan = optimizer.optimizeSelect(dynamic_cast<ast::SelectStatement*>(joinStmt.get()));
+            assertNotNull(joinPlan.get(), "Join plan");
+            assertTrue(joinPlan->cost.estimatedRows >= 150 && joinPlan->cost.estimatedRows <= 250,
+                       "Join rows from HyperLogLog overlap");
+            QueryResult joined = ctx.executor->execute(Parser(joinQuery).parse());
+            assertEqual(qsizetype(200), joined.rows.size(), "Actual join rows");
+
+            addResult("testExtendedStatistics", true, "Column groups, correlation and join overlap feed the optimizer",
+                      stopTimer());
+        } catch (const std::exception& e) {
+            addResult("testExtendedStatistics", false, QString("Exception: %1").arg(e.what()), stopTimer());
+        }
+    }
+    void testCardinalityFeedback() {
+        startTimer();
+        Config& config = Config::instance();
+        const bool slowEnabled = config.isSlowQueryEnabled();
+        const QString slowPath = config.getSlowQueryLogPath();
+        try {
+            auto ctx = createTestContext();
+            Catalog* catalog = ctx.dbManager->getCurrentCatalog();
+
+            // a < b 总成立：列之间的比较没有统计信息可用，a > b 按 1/3 估算，实际一行也没有
+            ctx.executor->execute(Parser("CREATE TABLE readings (a INT, b INT);").parse());
+            for (int i = 1; i <= 600; ++i) {
+                ctx.executor->execute(Parser(QString("INSERT INTO readings VALUES (%1, %2);")
+                                                 .arg(i).arg(i + 1)).parse());
+            }
+            assertTrue(ctx.executor->execute(Parser("ANALYZE readings;").parse()).success, "ANALYZE should succeed");
+
+            const QString query = "SELECT * FROM readings WHERE a > b;";
+            auto planRows = [&]() {
+                StatisticsCollector collector(catalog, ctx.dbManager->getCurrentBufferPool());
+                CostOptimizer optimizer(catalog, &collector);
+                auto stmt = Parser(query).parse();
+                auto plan = optimizer.optimizeSelect(dynamic_cast<ast::SelectStatement*>(stmt.get()));
+                return plan ? plan->cost.estimatedRows : size_t(0);
+            };
+            const size_t defaultRows = planRows();
+            assertTrue(defaultRows >= 190 && defaultRows <= 210, "Default estimate before feedback");
+
+            // 误估的计划记入慢查询日志
+            const QString logPath = QDir::current().absoluteFilePath("test_executor_slow.log");
+            QFile::remove(logPath);
+            config.setSlowQueryEnabled(true);
+            config.setSlowQueryLogPath(logPath);
+            QueryResult result = ctx.executor->execute(Parser(query).parse());
+            assertTrue(result.success, "Query should succeed");
+            assertEqual(qsizetype(0), result.rows.size(), "No row satisfies a > b");
+
+            QFile logFile(logPath);
+            assertTrue(logFile.open(QIODevice::ReadOnly | QIODevice::Text), "Slow query log written");
+            const QString logText = QString::fromUtf8(logFile.readAll());
+            logFile.close();
+            assertTrue(logText.contains(QString("MISESTIMATE SeqScan on readings: estimated %1 rows, actual 0")
+                                            .arg(defaultRows)), "Misestimated node flagged");
+            assertTrue(logText.contains("SELECT"), "Log entry includes the query");
+
+            // 之后的估算按实际行数修正
+            assertEqual(1, catalog->getCardinalityFeedback()->size(), "Feedback recorded for the scan");
+            assertTrue(planRows() <= 2, "Estimate corrected by feedback");
+
+            // 修正后估算准确，再次执行不再记为误估
+            logFile.remove();
+            ctx.executor->execute(Parser(query).parse());
+            assertFalse(QFile::exists(logPath), "Accurate estimate is not logged");
+
+            // 重新 ANALYZE 后旧的修正作废
+            assertTrue(ctx.executor->execute(Parser("ANALYZE readings;").parse()).success, "ANALYZE should succeed");
+            assertEqual(0, catalog->getCardinalityFeedback()->size(), "ANALYZE clears feedback for the table");
+            assertEqual(defaultRows, planRows(), "Estimate from statistics after ANALYZE");
+
+            addResult("testCardinalityFeedback", true, "Actual row counts correct later estimates; misestimates are logged",
+                      stopTimer());
+        } catch (const std::exception& e) {
+            addResult("testCardinalityFeedback", false, QString("Exception: %1").arg(e.what()), stopTimer());
+        }
+        config.setSlowQueryEnabled(slowEnabled);
+        config.setSlowQueryLogPath(slowPath);
+    }
+    void testCostCalibration() {
+        startTimer();
+        Config& config = Config::instance();
+        const CostParams originalParams = config.getCostParams();
+        const QString originalConfigPath = config.getConfigPath();
+        const QString iniPath = QDir::current().absoluteFilePath("test_executor_calibrate.ini");
+        try {
+            // 直接运行校准器：以顺序读为单位，未测量的参数保持不变，测试文件用完即删
+            CostCalibrator calibrator(QDir::currentPath(), 64);
+            CalibrationResult calibration;
+            assertTrue(calibrator.calibrate(CostParams::defaults(), calibration), "Calibration should succeed");
+            assertEqual(size_t(64), calibration.numPages, "Every page measured");
+            assertTrue(calibration.numTuples > 64, "Pages filled with rows");
+            assertEqual(1.0, calibration.params.seqPageReadCost, "Sequential read is the cost unit");
+            assertTrue(calibration.params.randomPageReadCost >= 1.0, "Random read is not cheaper than sequential");
+            assertTrue(calibration.params.tupleProcessCost > 0.0 && calibration.params.operatorCost > 0.0,
+                       "CPU costs measured");
+            assertEqual(CostParams::defaults().indexSearchCost, calibration.params.indexSearchCost,
+                        "Unmeasured parameters keep their values");
+            assertFalse(QFile::exists(QDir::current().filePath("qindb_calibrate.tmp")), "Calibration file removed");
+
+            // 启动时从 [Optimizer] 节加载成本参数
+            QFile::remove(iniPath);
+            {
+                QSettings settings(iniPath, QSettings::IniFormat);
+                settings.setValue("Optimizer/RandomPageReadCost", 1.5);
+                settings.setValue("Optimizer/IndexSearchCost", 0.05);
+            }
+            {
+                QFile file(iniPath);
+                assertTrue(file.open(QIODevice::ReadOnly | QIODevice::Text), "Config file written");
+                const QByteArray content = file.readAll();
+                file.close();
+                assertTrue(file.open(QIODevice::WriteOnly | QIODevice::Text), "Config file writable");
+                file.write("; calibration test header\n" + content);
+            }
+            assertTrue(config.load(iniPath), "Config should load");
+            assertEqual(1.5, config.getCostParams().randomPageReadCost, "Random read cost loaded");
+            assertEqual(0.05, config.getCostParams().indexSearchCost, "Index search cost loaded");
+            assertEqual(CostParams::defaults().tupleProcessCost, config.getCostParams().tupleProcessCost,
+                        "Missing keys keep defaults");
+
+            // CALIBRATE 测量后更新当前参数并写回配置文件
+            auto ctx = createTestContext();
+            QueryResult result = ctx.executor->execute(Parser("CALIBRATE;").parse());
+            assertTrue(result.success, "CALIBRATE should succeed");
+            assertEqual(qsizetype(5), result.rows.size(), "One row per measured parameter");
+            const CostParams calibrated = config.getCostParams();
+            assertEqual(0.05, calibrated.indexSearchCost, "Unmeasured parameter kept from config");
+
+            QSettings saved(iniPath, QSettings::IniFormat);
+            assertEqual(1.0, saved.value("Optimizer/SeqPageReadCost").toDouble(), "Cost unit saved");
+            assertEqual(calibrated.randomPageReadCost, saved.value("Optimizer/RandomPageReadCost").toDouble(),
+                        "Calibrated random read cost saved");
+            assertEqual(calibrated.operatorCost, saved.value("Optimizer/OperatorCost").toDouble(),
+                        "Calibrated operator cost saved");
+            {
+                QFile file(iniPath);
+                assertTrue(file.open(QIODevice::ReadOnly | QIODevice::Text), "Config file readable");
+                assertEqual(QString("; calibration test header"), QString::fromUtf8(file.readLine()).trimmed(),
+                            "Header comments kept when saving");
+            }
+
+            addResult("testCostCalibration", true, "CALIBRATE measures cost parameters and saves them to the config",
+                      stopTimer());
+        } catch (const std::exception& e) {
+            addResult("testCostCalibration", false, QString("Exception: %1").arg(e.what()), stopTimer());
+        }
+        config.setCostParams(originalParams);
+        config.setConfigPath(originalConfigPath);
+        QFile::remove(iniPath);
+    }
 };
 
 #ifndef QINDB_TEST_MAIN_INCLUDED
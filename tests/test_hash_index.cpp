@@ -1,5 +1,6 @@
 #include "test_framework.h"
 #include "qindb/hash_index.h"
+#include "qindb/hash_util.h"
 #include "qindb/buffer_pool_manager.h"
 #include "qindb/disk_manager.h"
 #include "qindb/config.h"
@@ -25,6 +26,9 @@ public:
         testDifferentTypes();
         testDuplicateKeys();
         testNotFound();
+        testLinearHashingGrowAndShrink();
+        testReopenDirectory();
+        testHashFunctionPersisted();
     }
 
 private:
@@ -235,6 +239,148 @@ private:
             addResult("testNotFound", false, QString("Exception: %1").arg(e.what()), stopTimer());
         }
     }
+
+    void testLinearHashingGrowAndShrink() {
+        startTimer();
+        try {
+            QString dbFile = "test_hash_index.db";
+            QFile::remove(dbFile);
+
+            DiskManager diskManager(dbFile);
+            BufferPoolManager bufferPool(200, &diskManager);
+            HashIndex index("test_index", DataType::INT, &bufferPool, 4);
+
+            // 4 个固定桶放 20000 个键需要很长的溢出链；线性哈希应随数据增长逐个分裂桶
+            const int numKeys = 20000;
+            for (int i = 1; i <= numKeys; ++i) {
+                assertTrue(index.insert(QVariant(i), static_cast<RowId>(i)),
+                           QString("Should insert key %1").arg(i));
+            }
+
+            HashIndex::Statistics grown = index.getStatistics();
+            assertTrue(grown.numBuckets > 4, "Buckets should split as load grows");
+            assertEqual(static_cast<uint32_t>(numKeys), grown.numEntries, "All entries should be counted");
+            assertTrue(grown.loadFactor <= 0.75 + 1e-9, "Load factor should stay under the split threshold");
+            assertTrue(grown.maxChainLength <= 3, "Overflow chains should stay short");
+
+            for (int i = 1; i <= numKeys; ++i) {
+                RowId value = INVALID_ROW_ID;
+                assertTrue(index.search(QVariant(i), value), QString("Should find key %1 after splits").arg(i));
+                assertEqual(static_cast<RowId>(i), value, QString("Should return correct RowId for key %1").arg(i));
+            }
+
+            // 删除大部分键，桶应合并回去
+            for (int i = 1; i <= numKeys - 100; ++i) {
+                assertTrue(index.remove(QVariant(i), static_cast<RowId>(i)),
+                           QString("Should remove key %1").arg(i));
+            }
+
+            HashIndex::Statistics shrunk = index.getStatistics();
+            assertTrue(shrunk.numBuckets < grown.numBuckets, "Buckets should merge as load shrinks");
+            assertTrue(shrunk.numBuckets >= 4, "Should not shrink below the initial bucket count");
+            assertEqual(static_cast<uint32_t>(100), shrunk.numEntries, "Remaining entries should be counted");
+
+            for (int i = numKeys - 99; i <= numKeys; ++i) {
+                std::vector<RowId> results;
+                assertTrue(index.searchAll(QVariant(i), results), QString("Should find key %1 after merges").arg(i));
+                assertEqual(static_cast<size_t>(1), results.size(), "Should have exactly 1 result");
+            }
+
+            addResult("testLinearHashingGrowAndShrink", true,
+                      QString("buckets 4 -> %1 -> %2, max chain %3 -> %4 pages")
+                          .arg(grown.numBuckets).arg(shrunk.numBuckets)
+                          .arg(grown.maxChainLength).arg(shrunk.maxChainLength),
+                      stopTimer());
+        } catch (const std::exception& e) {
+            addResult("testLinearHashingGrowAndShrink", false, QString("Exception: %1").arg(e.what()), stopTimer());
+        }
+    }
+
+    void testReopenDirectory() {
+        startTimer();
+        try {
+            QString dbFile = "test_hash_index.db";
+            QFile::remove(dbFile);
+
+            DiskManager diskManager(dbFile);
+            BufferPoolManager bufferPool(200, &diskManager);
+
+            PageId directoryPageId = INVALID_PAGE_ID;
+            uint32_t numBuckets = 0;
+            double loadFactor = 0.0;
+            {
+                HashIndex index("test_index", DataType::INT, &bufferPool, 4);
+                for (int i = 1; i <= 5000; ++i) {
+                    index.insert(QVariant(i), static_cast<RowId>(i));
+                }
+                // 最后几次删除不触发合并：条目计数只在析构时写回目录页
+                for (int i = 4991; i <= 5000; ++i) {
+                    index.remove(QVariant(i), static_cast<RowId>(i));
+                }
+                directoryPageId = index.getDirectoryPageId();
+                numBuckets = index.getNumBuckets();
+                loadFactor = index.getStatistics().loadFactor;
+            }
+
+            // 用目录页重新打开：桶数、条目计数和数据都来自持久化的目录
+            HashIndex reopened("test_index", DataType::INT, &bufferPool, 256);
+            assertTrue(reopened.setDirectoryPageId(directoryPageId), "Should load persisted directory");
+            assertEqual(numBuckets, reopened.getNumBuckets(), "Bucket count should be restored");
+            assertEqual(loadFactor, reopened.getStatistics().loadFactor, "Entry bytes should be restored");
+            RowId removedValue = INVALID_ROW_ID;
+            assertFalse(reopened.search(QVariant(5000), removedValue), "Removed key should stay removed");
+
+            for (int i = 1; i <= 5000; i += 7) {
+                RowId value = INVALID_ROW_ID;
+                assertTrue(reopened.search(QVariant(i), value), QString("Should find key %1 after reopen").arg(i));
+                assertEqual(static_cast<RowId>(i), value, "Should return correct RowId after reopen");
+            }
+
+            addResult("testReopenDirectory", true, "Persisted directory reloads", stopTimer());
+        } catch (const std::exception& e) {
+            addResult("testReopenDirectory", false, QString("Exception: %1").arg(e.what()), stopTimer());
+        }
+    }
+
+    void testHashFunctionPersisted() {
+        startTimer();
+        try {
+            QString dbFile = "test_hash_index.db";
+            QFile::remove(dbFile);
+
+            DiskManager diskManager(dbFile);
+            BufferPoolManager bufferPool(200, &diskManager);
+
+            // 同一输入、同一种子的哈希值必须稳定（写入磁盘的桶分布依赖它）
+            QByteArray sample("qindb-hash");
+            assertEqual(HashUtil::hashBytes(sample, 1), HashUtil::hashBytes(sample, 1), "Hash should be deterministic");
+            assertNotEqual(HashUtil::hashBytes(sample, 1), HashUtil::hashBytes(sample, 2), "Seed should change the hash");
+
+            // 以 SHA-256 建的索引，用默认参数重新打开时应沿用目录中记录的哈希函数和种子
+            PageId directoryPageId = INVALID_PAGE_ID;
+            {
+                HashIndex index("test_index", DataType::INT, &bufferPool, 4, HashFunction::SHA256);
+                for (int i = 1; i <= 3000; ++i) {
+                    index.insert(QVariant(i), static_cast<RowId>(i));
+                }
+                directoryPageId = index.getDirectoryPageId();
+            }
+
+            HashIndex reopened("test_index", DataType::INT, &bufferPool);
+            assertEqual(static_cast<uint32_t>(HashFunction::WYHASH), static_cast<uint32_t>(reopened.getHashFunction()), "New indexes should default to wyhash");
+            assertTrue(reopened.setDirectoryPageId(directoryPageId), "Should load persisted directory");
+            assertEqual(static_cast<uint32_t>(HashFunction::SHA256), static_cast<uint32_t>(reopened.getHashFunction()), "Hash function should come from the directory");
+
+            for (int i = 1; i <= 3000; ++i) {
+                RowId value = INVALID_ROW_ID;
+                assertTrue(reopened.search(QVariant(i), value), QString("Should find key %1 after reopen").arg(i));
+            }
+
+            addResult("testHashFunctionPersisted", true, "Hash function id and seed are persisted", stopTimer());
+        } catch (const std::exception& e) {
+            addResult("testHashFunctionPersisted", false, QString("Exception: %1").arg(e.what()), stopTimer());
+        }
+    }
 };
 
 #ifndef QINDB_TEST_MAIN_INCLUDED
@@ -0,0 +1,599 @@
+#include "test_framework.h"
+#include "qindb/inverted_index.h"
+#include "qindb/posting_intersection.h"
+#include "qindb/perfect_hash.h"
+#include "qindb/chinese_segmenter.h"
+#include "qindb/buffer_pool_manager.h"
+#include "qindb/disk_manager.h"
+#include <QCoreApplication>
+#include <QFile>
+#include <algorithm>
+#include <random>
+#include <vector>
+
+using namespace qindb;
+using namespace qindb::test;
+
+/**
+ * @brief InvertedIndex 测试套件
+ */
+class InvertedIndexTests : public TestCase {
+public:
+    InvertedIndexTests() : TestCase("InvertedIndexTests") {}
+
+    void run() override {
+        testInsertAndSearch();
+        testFlushAndReopen();
+        testRemoveAndUpdateAcrossSegments();
+        testSegmentMerge();
+        testSmallSegmentsMerge();
+        testLongPostingLists();
+        testTopKMatchesExhaustive();
+        testIntersectionKernels();
+        testBooleanAndAcrossSegments();
+        testPhraseAndNearQueries();
+        testPerfectHash();
+        testTokenizerSegmentation();
+    }
+
+private:
+    /**
+     * @brief 把整数编码成纯字母（分词器只把连续字母当作词）
+     */
+    static QString letterCode(int n) {
+        QString code;
+        do {
+            code.prepend(QChar('a' + n % 26));
+            n /= 26;
+        } while (n > 0);
+        return code;
+    }
+
+    static QString makeDocument(int i) {
+        QString text = "common";
+        if (i % 2 == 0) text += " even";
+        if (i % 3 == 0) text += " three";
+        if (i % 7 == 0) text += " seven seven";
+        return text + " word" + letterCode(i);
+    }
+
+    void testInsertAndSearch() {
+        startTimer();
+        try {
+            InvertedIndex index("test_fulltext", nullptr);
+
+            assertTrue(index.insert(1, "database storage engine"), "Should insert document 1");
+            assertTrue(index.insert(2, "database query optimizer"), "Should insert document 2");
+            assertTrue(index.insert(3, "cooking with garlic"), "Should insert document 3");
+            assertFalse(index.insert(1, "duplicate"), "Duplicate document should be rejected");
+
+            assertEqual(qsizetype(2), index.search("database").size(), "Two documents contain 'database'");
+            assertEqual(qsizetype(1), index.searchAnd({"database", "optimizer"}).size(), "AND should intersect");
+            assertEqual(qsizetype(3), index.searchOr({"database", "garlic"}).size(), "OR should union");
+            assertEqual(static_cast<uint32_t>(2), index.getDocumentFrequency("database"), "df of 'database'");
+
+            addResult("testInsertAndSearch", true, "In-memory insert and search works", stopTimer());
+        } catch (const std::exception& e) {
+            addResult("testInsertAndSearch", false, QString("Exception: %1").arg(e.what()), stopTimer());
+        }
+    }
+
+    void testFlushAndReopen() {
+        startTimer();
+        try {
+            QString dbFile = "test_inverted_index.db";
+            QFile::remove(dbFile);
+
+            DiskManager diskManager(dbFile);
+            BufferPoolManager bufferPool(200, &diskManager);
+
+            PageId rootPageId = INVALID_PAGE_ID;
+            QVector<SearchResult> before;
+            {
+                InvertedIndex index("test_fulltext", &bufferPool);
+                for (int i = 1; i <= 1000; ++i) {
+                    assertTrue(index.insert(i, makeDocument(i)), QString("Should insert document %1").arg(i));
+                }
+                assertTrue(index.flush(), "Flush should succeed");
+                rootPageId = index.getRootPageId();
+                assertTrue(rootPageId != INVALID_PAGE_ID, "Flush should allocate the meta page");
+                before = index.search("seven");
+            }
+
+            InvertedIndex reopened("test_fulltext", &bufferPool);
+            assertTrue(reopened.setRootPageId(rootPageId), "Should load persisted index");
+            assertEqual(static_cast<uint32_t>(1000), reopened.getTotalDocuments(), "Document count should persist");
+
+            QVector<SearchResult> after = reopened.search("seven");
+            assertEqual(qsizetype(1000 / 7), after.size(), "All 'seven' documents should be found");
+            assertEqual(before.size(), after.size(), "Results should match before and after reopen");
+            for (int i = 0; i < after.size(); ++i) {
+                assertEqual(before[i].docId, after[i].docId, "Ranking should be identical after reopen");
+            }
+            assertEqual(qsizetype(1000 / 6), reopened.searchAnd({"even", "three"}).size(), "AND across terms");
+
+            InvertedIndex::Statistics stats = reopened.getStatistics();
+            assertEqual(static_cast<uint32_t>(1), stats.numSegments, "One flush should write one segment");
+            assertEqual(static_cast<uint32_t>(0), stats.numBufferedDocuments, "Nothing should be buffered");
+
+            addResult("testFlushAndReopen", true, "Segments are served from disk after reopen", stopTimer());
+        } catch (const std::exception& e) {
+            addResult("testFlushAndReopen", false, QString("Exception: %1").arg(e.what()), stopTimer());
+        }
+    }
+
+    void testRemoveAndUpdateAcrossSegments() {
+        startTimer();
+        try {
+            QString dbFile = "test_inverted_index.db";
+            QFile::remove(dbFile);
+
+            DiskManager diskManager(dbFile);
+            BufferPoolManager bufferPool(200, &diskManager);
+
+            PageId rootPageId = INVALID_PAGE_ID;
+            {
+                InvertedIndex index("test_fulltext", &bufferPool);
+                for (int i = 1; i <= 300; ++i) {
+                    index.insert(i, makeDocument(i));
+                }
+                assertTrue(index.flush(), "First flush should succeed");
+
+                // 段中的文档：删除只做标记；缓冲区中的文档：直接删除
+                assertTrue(index.remove(7), "Should remove document from segment");
+                assertTrue(index.update(14, "rewritten text"), "Should update document from segment");
+                assertTrue(index.insert(301, "seven fresh"), "Should insert new document");
+                assertTrue(index.remove(301), "Should remove buffered document");
+                assertFalse(index.remove(7), "Removing twice should fail");
+                assertTrue(index.flush(), "Second flush should succeed");
+                rootPageId = index.getRootPageId();
+            }
+
+            InvertedIndex reopened("test_fulltext", &bufferPool);
+            assertTrue(reopened.setRootPageId(rootPageId), "Should load persisted index");
+            assertEqual(static_cast<uint32_t>(299), reopened.getTotalDocuments(), "Deletes should persist");
+            assertEqual(qsizetype(300 / 7 - 2), reopened.search("seven").size(), "Removed and updated documents should not match");
+            assertEqual(qsizetype(1), reopened.search("rewritten").size(), "Updated text should match");
+            assertEqual(static_cast<uint32_t>(2), reopened.getStatistics().numDeletedDocuments,
+                        "Both segment documents should be marked deleted");
+
+            addResult("testRemoveAndUpdateAcrossSegments", true, "Deletes and updates persist across segments", stopTimer());
+        } catch (const std::exception& e) {
+            addResult("testRemoveAndUpdateAcrossSegments", false, QString("Exception: %1").arg(e.what()), stopTimer());
+        }
+    }
+
+    void testSegmentMerge() {
+        startTimer();
+        try {
+            QString dbFile = "test_inverted_index.db";
+            QFile::remove(dbFile);
+
+            DiskManager diskManager(dbFile);
+            BufferPoolManager bufferPool(200, &diskManager);
+            InvertedIndex index("test_fulltext", &bufferPool);
+
+            // 每 100 个文档写一个段，段数超过上限时自动合并
+            for (int i = 1; i <= 2000; ++i) {
+                index.insert(i, makeDocument(i));
+                if (i % 100 == 0) {
+                    assertTrue(index.flush(), "Flush should succeed");
+                }
+            }
+            for (int i = 3; i <= 2000; i += 3) {
+                index.remove(i);
+            }
+            assertTrue(index.flush(), "Flush after deletes should succeed");
+
+            InvertedIndex::Statistics stats = index.getStatistics();
+            assertTrue(stats.numSegments <= 8, "Tiered merge should bound the number of segments");
+            assertEqual(qsizetype(0), index.search("three").size(), "Deleted documents should not match");
+
+            assertTrue(index.compact(), "Compaction should succeed");
+            stats = index.getStatistics();
+            assertEqual(static_cast<uint32_t>(1), stats.numSegments, "Compaction should leave one segment");
+            assertEqual(static_cast<uint32_t>(0), stats.numDeletedDocuments, "Compaction should drop deleted documents");
+            assertEqual(static_cast<uint32_t>(2000 - 666), stats.numDocuments, "Live documents should survive compaction");
+            assertEqual(qsizetype(1000 - 333), index.search("even").size(), "Search should work after compaction");
+
+            addResult("testSegmentMerge", true, "Segments merge and drop deleted documents", stopTimer());
+        } catch (const std::exception& e) {
+            addResult("testSegmentMerge", false, QString("Exception: %1").arg(e.what()), stopTimer());
+        }
+    }
+
+    void testSmallSegmentsMerge() {
+        startTimer();
+        try {
+            QString dbFile = "test_inverted_index.db";
+            QFile::remove(dbFile);
+
+            DiskManager diskManager(dbFile);
+            BufferPoolManager bufferPool(200, &diskManager);
+
+            // 模拟逐条 DML 语句刷新：每次只写一两个文档
+            PageId rootPageId = INVALID_PAGE_ID;
+            {
+                InvertedIndex index("test_fulltext", &bufferPool);
+                for (int i = 1; i <= 100; ++i) {
+                    index.insert(i, makeDocument(i));
+                    if (i % 10 == 0) {
+                        index.remove(i - 1);
+                    }
+                    assertTrue(index.flush(), "Flush should succeed");
+                }
+                assertEqual(static_cast<uint32_t>(1), index.getStatistics().numSegments,
+                            "Small segments should be merged into one");
+                rootPageId = index.getRootPageId();
+            }
+
+            // 被合并掉的段已释放，元数据页只引用合并后的段
+            InvertedIndex reopened("test_fulltext", &bufferPool);
+            assertTrue(reopened.setRootPageId(rootPageId), "Should load persisted index");
+            assertEqual(static_cast<uint32_t>(90), reopened.getTotalDocuments(), "Live documents should persist");
+            assertEqual(qsizetype(50), reopened.search("even").size(), "Search should work after merging");
+
+            addResult("testSmallSegmentsMerge", true, "Per-statement segments merge eagerly", stopTimer());
+        } catch (const std::exception& e) {
+            addResult("testSmallSegmentsMerge", false, QString("Exception: %1").arg(e.what()), stopTimer());
+        }
+    }
+
+    void testLongPostingLists() {
+        startTimer();
+        try {
+            QString dbFile = "test_inverted_index.db";
+            QFile::remove(dbFile);
+
+            DiskManager diskManager(dbFile);
+            BufferPoolManager bufferPool(64, &diskManager);
+            InvertedIndex index("test_fulltext", &bufferPool);
+
+            // 倒排列表跨越多个块和多个页，缓冲池只有 64 页
+            const int numDocs = 20000;
+            for (int i = 1; i <= numDocs; ++i) {
+                index.insert(static_cast<RowId>(i) * 3, "alpha beta group" + letterCode(i % 50));
+            }
+            assertTrue(index.flush(), "Flush should succeed");
+
+            InvertedIndex reopened("test_fulltext", &bufferPool);
+            assertTrue(reopened.setRootPageId(index.getRootPageId()), "Should load persisted index");
+            assertEqual(qsizetype(numDocs), reopened.search("alpha").size(), "Every document contains 'alpha'");
+            assertEqual(qsizetype(numDocs / 50), reopened.searchAnd({"alpha", "group" + letterCode(7)}).size(), "AND on a long list");
+            assertEqual(qsizetype(10), reopened.search("beta", 10).size(), "LIMIT should truncate results");
+
+            addResult("testLongPostingLists", true, "Long posting lists stream block by block", stopTimer());
+        } catch (const std::exception& e) {
+            addResult("testLongPostingLists", false, QString("Exception: %1").arg(e.what()), stopTimer());
+        }
+    }
+
+    void testTopKMatchesExhaustive() {
+        startTimer();
+        try {
+            QString dbFile = "test_inverted_index.db";
+            QFile::remove(dbFile);
+
+            DiskManager diskManager(dbFile);
+            BufferPoolManager bufferPool(200, &diskManager);
+            InvertedIndex index("test_fulltext", &bufferPool);
+
+            // 词频和文档长度各不相同，分布在多个段、删除集和缓冲区中
+            for (int i = 1; i <= 6000; ++i) {
+                QString text = makeDocument(i);
+                for (int j = 0; j < i % 5; ++j) {
+                    text += " even";
+                }
+                for (int j = 0; j < i % 11; ++j) {
+                    text += " filler" + letterCode(j);
+                }
+                index.insert(i, text);
+                if (i % 1500 == 0) {
+                    assertTrue(index.flush(), "Flush should succeed");
+                }
+            }
+            for (int i = 10; i <= 6000; i += 10) {
+                index.remove(i);
+            }
+            for (int i = 21; i <= 6000; i += 50) {
+                index.update(i, "seven seven seven even");
+            }
+
+            const QVector<QStringList> queries = {
+                {"common"}, {"even"}, {"seven", "three"}, {"even", "three", "seven"}, {"missing", "seven"}
+            };
+            for (const QStringList& query : queries) {
+                QVector<SearchResult> all = index.searchOr(query);
+                for (int limit : {1, 10, 100}) {
+                    QVector<SearchResult> top = index.searchOr(query, limit);
+                    assertEqual(std::min<qsizetype>(limit, all.size()), top.size(), "Top-k size should match");
+                    for (int i = 0; i < top.size(); ++i) {
+                        assertEqual(all[i].docId, top[i].docId, "Top-k ranking should equal exhaustive ranking");
+                    }
+                }
+            }
+
+            // 短文档、高词频的得分更高
+            QVector<SearchResult> best = index.search("seven", 1);
+            assertEqual(qsizetype(1), best.size(), "Should return the best document");
+            assertEqual(static_cast<RowId>(21), best[0].docId, "Rewritten short document should rank first");
+
+            addResult("testTopKMatchesExhaustive", true, "Block-Max WAND returns the exact top-k", stopTimer());
+        } catch (const std::exception& e) {
+            addResult("testTopKMatchesExhaustive", false, QString("Exception: %1").arg(e.what()), stopTimer());
+        }
+    }
+
+    void testIntersectionKernels() {
+        startTimer();
+        try {
+            std::mt19937_64 rng(11);
+            for (int trial = 0; trial < 500; ++trial) {
+                // 长度相近走归并（AVX2 或标量），相差悬殊走galloping
+                const size_t na = 1 + rng() % 200;
+                const size_t nb = (trial % 3 == 0) ? 1 + rng() % 20000 : 1 + rng() % 200;
+                const RowId range = 1 + rng() % 4000;
+
+                auto makeList = [&](size_t n) {
+                    std::vector<RowId> list;
+                    for (size_t i = 0; i < n; ++i) {
+                        list.push_back(1 + rng() % range);
+                    }
+                    std::sort(list.begin(), list.end());
+                    list.erase(std::unique(list.begin(), list.end()), list.end());
+                    return list;
+                };
+                std::vector<RowId> a = makeList(na);
+                std::vector<RowId> b = makeList(nb);
+
+                const size_t capacity = std::min(a.size(), b.size());
+                std::vector<uint32_t> outA(capacity), outB(capacity), expectA(capacity), expectB(capacity);
+                size_t count = PostingIntersection::intersect(a.data(), a.size(), b.data(), b.size(),
+                                                              outA.data(), outB.data());
+                size_t expected = PostingIntersection::intersectScalar(a.data(), a.size(), b.data(), b.size(),
+                                                                       expectA.data(), expectB.data());
+                assertEqual(expected, count, "Intersection size should match scalar merge");
+                for (size_t i = 0; i < count; ++i) {
+                    assertTrue(outA[i] == expectA[i] && outB[i] == expectB[i], "Matched positions should agree");
+                }
+
+                RowId target = rng() % (range + 2);
+                size_t from = rng() % b.size();
+                size_t position = PostingIntersection::gallop(b.data(), from, b.size(), target);
+                size_t expectedPosition = std::lower_bound(b.begin() + from, b.end(), target) - b.begin();
+                assertEqual(expectedPosition, position, "Galloping should find the lower bound");
+            }
+
+            addResult("testIntersectionKernels", true,
+                      QString("Galloping and block intersection agree (AVX2: %1)")
+                          .arg(PostingIntersection::isAvx2Enabled() ? "yes" : "no"),
+                      stopTimer());
+        } catch (const std::exception& e) {
+            addResult("testIntersectionKernels", false, QString("Exception: %1").arg(e.what()), stopTimer());
+        }
+    }
+
+    void testBooleanAndAcrossSegments() {
+        startTimer();
+        try {
+            QString dbFile = "test_inverted_index.db";
+            QFile::remove(dbFile);
+
+            DiskManager diskManager(dbFile);
+            BufferPoolManager bufferPool(200, &diskManager);
+            InvertedIndex index("test_fulltext", &bufferPool);
+
+            // 每个段的 common/even 列表都超过 SKIP_INTERVAL 个块，会写跳表
+            const int numDocs = 12000;
+            for (int i = 1; i <= numDocs; ++i) {
+                index.insert(i, makeDocument(i));
+                if (i % 4000 == 0) {
+                    assertTrue(index.flush(), "Flush should succeed");
+                }
+            }
+            for (int i = 5; i <= numDocs; i += 5) {
+                index.remove(i);
+            }
+            index.insert(numDocs + 1, "even three seven");
+
+            auto expected = [&](int modulus) {
+                int count = 0;
+                for (int i = 1; i <= numDocs; ++i) {
+                    count += (i % modulus == 0 && i % 5 != 0) ? 1 : 0;
+                }
+                return count + 1;
+            };
+
+            assertEqual(qsizetype(expected(6)), index.searchAnd({"even", "three"}).size(), "even AND three");
+            assertEqual(qsizetype(expected(42)), index.searchAnd({"three", "seven", "even"}).size(),
+                        "Three-way AND");
+            assertEqual(qsizetype(expected(14) - 1), index.searchAnd({"common", "seven", "even"}).size(),
+                        "AND with the longest list");
+            assertEqual(qsizetype(0), index.searchAnd({"even", "missing"}).size(), "Missing term empties AND");
+
+            // AND 的得分与 OR 中同一文档的得分一致，limit 只截断
+            QVector<SearchResult> all = index.searchAnd({"even", "seven"});
+            QVector<SearchResult> top = index.searchAnd({"even", "seven"}, 5);
+            assertEqual(qsizetype(5), top.size(), "LIMIT should truncate AND results");
+            for (int i = 0; i < top.size(); ++i) {
+                assertEqual(all[i].docId, top[i].docId, "Truncated AND results should keep the ranking");
+            }
+
+            addResult("testBooleanAndAcrossSegments", true, "AND intersects segments via skip tables", stopTimer());
+        } catch (const std::exception& e) {
+            addResult("testBooleanAndAcrossSegments", false, QString("Exception: %1").arg(e.what()), stopTimer());
+        }
+    }
+
+    void testPhraseAndNearQueries() {
+        startTimer();
+        try {
+            QString dbFile = "test_inverted_index.db";
+            QFile::remove(dbFile);
+
+            DiskManager diskManager(dbFile);
+            BufferPoolManager bufferPool(200, &diskManager);
+            PageId rootPageId = INVALID_PAGE_ID;
+
+            auto checkQueries = [this](InvertedIndex& index, const QString& stage) {
+                auto ids = [](const QVector<SearchResult>& results) {
+                    QVector<RowId> docIds;
+                    for (const SearchResult& result : results) {
+                        docIds.append(result.docId);
+                    }
+                    std::sort(docIds.begin(), docIds.end());
+                    return docIds;
+                };
+
+                // 停用词不占位置，"the" 不影响相邻关系
+                assertTrue(ids(index.searchMatch("\"storage engine\"", false)) == QVector<RowId>({1, 4}),
+                           stage + ": phrase should require adjacent terms in order");
+                assertTrue(ids(index.searchPhrase("engine storage")) == QVector<RowId>({2}),
+                           stage + ": phrase order matters");
+                assertTrue(ids(index.searchMatch("\"query optimizer rules\"", false)) == QVector<RowId>({3}),
+                           stage + ": three-term phrase");
+                assertTrue(ids(index.searchMatch("storage NEAR/2 engine", true)) == QVector<RowId>({1, 2, 4}),
+                           stage + ": NEAR ignores order");
+                assertTrue(ids(index.searchMatch("database NEAR/3 engine", true)) == QVector<RowId>({1}),
+                           stage + ": NEAR limits the distance");
+                assertTrue(ids(index.searchMatch("storage near engine", true)) ==
+                               ids(index.searchMatch("storage NEAR engine", true)),
+                           stage + ": NEAR is case-insensitive");
+                assertFalse(index.searchMatch("storage near engine", true).isEmpty(),
+                            stage + ": lowercase near is an operator");
+                assertTrue(ids(index.searchMatch("\"storage engine\" tuning", true)) == QVector<RowId>({4}),
+                           stage + ": boolean mode requires plain terms too");
+
+                // 自然语言模式下普通词只影响排序
+                QVector<SearchResult> ranked = index.searchMatch("\"storage engine\" tuning", false);
+                assertEqual(qsizetype(2), ranked.size(), stage + ": plain terms should not filter");
+                assertEqual(RowId(4), ranked[0].docId, stage + ": plain terms should add to the score");
+            };
+
+            {
+                InvertedIndex index("test_fulltext", &bufferPool);
+                index.insert(1, "the database storage engine");
+                index.insert(2, "engine for storage of blobs");
+                assertTrue(index.flush(), "Flush should succeed");
+                index.insert(3, "query optimizer rules and storage");
+                index.insert(4, "storage engine tuning guide");
+                index.insert(5, "storage layer with a pluggable query engine");
+
+                checkQueries(index, "Buffer and segment");
+                assertTrue(index.flush(), "Flush should succeed");
+                assertTrue(index.compact(), "Compaction should keep positions");
+                rootPageId = index.getRootPageId();
+            }
+
+            InvertedIndex reopened("test_fulltext", &bufferPool);
+            assertTrue(reopened.setRootPageId(rootPageId), "Should load persisted index");
+            checkQueries(reopened, "Reopened");
+
+            addResult("testPhraseAndNearQueries", true, "Phrase and NEAR queries use stored positions", stopTimer());
+        } catch (const std::exception& e) {
+            addResult("testPhraseAndNearQueries", false, QString("Exception: %1").arg(e.what()), stopTimer());
+        }
+    }
+    void testPerfectHash() {
+        startTimer();
+        try {
+            QStringList keys;
+            for (int i = 0; i < 5000; ++i) {
+                keys.append(letterCode(i * 7919));
+            }
+            keys.append(keys[42]);  // 重复的键只保留第一个
+
+            PerfectHash table;
+            assertTrue(table.build(keys), "Perfect hash should build");
+            assertEqual(5000, table.size(), "Duplicate keys should be dropped");
+            for (int i = 0; i < 5000; ++i) {
+                assertEqual(i, table.find(keys[i]), QString("Key %1 should map to its index").arg(keys[i]));
+                assertTrue(table.keyAt(i) == keys[i], "keyAt should return the key");
+            }
+            assertEqual(-1, table.find(QStringLiteral("missing")), "Absent key should not be found");
+            assertEqual(-1, table.find(QStringView()), "Empty key should not be found");
+
+            PerfectHash empty;
+            assertTrue(empty.build({}), "Empty table should build");
+            assertFalse(empty.contains(QStringLiteral("a")), "Empty table contains nothing");
+
+            addResult("testPerfectHash", true, "Perfect hash finds every key exactly once", stopTimer());
+        } catch (const std::exception& e) {
+            addResult("testPerfectHash", false, QString("Exception: %1").arg(e.what()), stopTimer());
+        }
+    }
+
+    void testTokenizerSegmentation() {
+        startTimer();
+        try {
+            Tokenizer tokenizer;
+            auto tokens = [&tokenizer](const QString& text) {
+                return tokenizer.tokenizeWithDuplicates(text);
+            };
+
+            // 词典切词选概率最大的路径
+            assertTrue(tokens("数据库查询优化") == QStringList({"数据库", "查询", "优化"}), "Should segment dictionary words");
+            assertTrue(tokens("南京市长江大桥") == QStringList({"南京市", "长江大桥"}), "Should prefer the likelier path");
+            assertTrue(tokens("研究生命起源") == QStringList({"研究", "生命", "起源"}), "Should resolve overlapping words");
+
+            // 停用词（含多字停用词）被过滤，中英文按原文顺序输出
+            assertTrue(tokens("这是一个数据库") == QStringList({"数据库"}), "Stop words should be removed");
+            assertTrue(tokens("QinDB 的存储Engine, v2 and 索引") == QStringList({"qindb", "存储", "engine", "索引"}),
+                       "Mixed text should keep the original order");
+
+            // 区间指向归一化后的文本
+            QString folded;
+            QVector<Tokenizer::TokenSpan> spans;
+            tokenizer.tokenizeSpans(u"Fast 全文检索", folded, spans);
+            assertEqual(qsizetype(2), spans.size(), "Should produce two spans");
+            assertTrue(QStringView(folded).mid(spans[0].offset, spans[0].length) == u"fast", "Span should be lowercased");
+            assertTrue(QStringView(folded).mid(spans[1].offset, spans[1].length) == u"全文检索", "Span should cover the word");
+
+            tokenizer.setSegmentationEnabled(false);
+            assertTrue(tokens("数据库") == QStringList({"数", "据", "库"}), "Disabled segmentation falls back to characters");
+            tokenizer.setSegmentationEnabled(true);
+
+            tokenizer.addStopWord("查询");
+            assertTrue(tokens("查询优化") == QStringList({"优化"}), "Added stop word should be removed");
+            tokenizer.removeStopWord("查询");
+            assertTrue(tokens("查询优化") == QStringList({"查询", "优化"}), "Removed stop word should be kept");
+
+            ChineseSegmenter custom;
+            assertFalse(custom.containsWord(u"查询优化"), "Builtin dictionary should not contain the compound");
+            custom.addWord("查询优化", 100000);
+            assertTrue(custom.rebuild(), "Rebuild should succeed");
+            tokenizer.setSegmenter(&custom);
+            assertTrue(tokens("查询优化") == QStringList({"查询优化"}), "Custom dictionary word should be kept whole");
+            tokenizer.setSegmenter(nullptr);
+
+            // 全文检索使用同一分词器，词位置按切词结果计算
+            InvertedIndex index("test_fulltext_zh", nullptr);
+            index.insert(1, "数据库查询优化");
+            index.insert(2, "南京市长江大桥");
+            index.insert(3, "查询引擎的存储优化");
+            assertEqual(qsizetype(2), index.search("查询").size(), "Two documents contain 查询");
+            assertEqual(qsizetype(1), index.search("长江大桥").size(), "Whole words should match");
+            QVector<SearchResult> phrase = index.searchMatch("\"数据库查询\"", false);
+            assertEqual(qsizetype(1), phrase.size(), "Phrase should match adjacent words");
+            assertEqual(RowId(1), phrase[0].docId, "Phrase should match document 1");
+
+            addResult("testTokenizerSegmentation", true, "Chinese text is segmented into dictionary words", stopTimer());
+        } catch (const std::exception& e) {
+            addResult("testTokenizerSegmentation", false, QString("Exception: %1").arg(e.what()), stopTimer());
+        }
+    }
+};
+
+#ifndef QINDB_TEST_MAIN_INCLUDED
+int main(int argc, char *argv[]) {
+    QCoreApplication app(argc, argv);
+
+    TestSuite suite("Inverted Index Tests");
+    suite.addTest(new InvertedIndexTests());
+
+    TestRunner::instance().registerSuite(&suite);
+    int result = TestRunner::instance().runAll();
+
+    return result;
+}
+#endif
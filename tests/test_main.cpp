@@ -8,6 +8,7 @@
 #include "test_lexer.cpp"
 #include "test_parser.cpp"
 #include "test_hash_index.cpp"
+#include "test_inverted_index.cpp"
 #include "test_catalog.cpp"
 #include "test_transaction.cpp"
 #include "test_auth_permission.cpp"
@@ -28,6 +29,7 @@ int main(int argc, char *argv[]) {
     TestSuite lexerSuite("Lexer Tests");
     TestSuite parserSuite("Parser Tests");
     TestSuite hashIndexSuite("Hash Index Tests");
+    TestSuite invertedIndexSuite("Inverted Index Tests");
     TestSuite catalogSuite("Catalog Tests");
     TestSuite transactionSuite("Transaction Tests");
     TestSuite authPermissionSuite("Auth & Permission Tests");
@@ -51,6 +53,9 @@ int main(int argc, char *argv[]) {
     // 添加哈希索引测试
     hashIndexSuite.addTest(new HashIndexTests());
 
+    // 添加倒排索引测试
+    invertedIndexSuite.addTest(new InvertedIndexTests());
+
     // 添加目录测试
     catalogSuite.addTest(new CatalogTests());
 
@@ -78,6 +83,7 @@ int main(int argc, char *argv[]) {
     TestRunner::instance().registerSuite(&lexerSuite);
     TestRunner::instance().registerSuite(&parserSuite);
     TestRunner::instance().registerSuite(&hashIndexSuite);
+    TestRunner::instance().registerSuite(&invertedIndexSuite);
     TestRunner::instance().registerSuite(&catalogSuite);
     TestRunner::instance().registerSuite(&transactionSuite);
     TestRunner::instance().registerSuite(&authPermissionSuite);
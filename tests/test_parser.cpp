@@ -18,9 +18,11 @@ public:
     void run() override {
         testSelectBasic();
         testSelectWithWhere();
+        testSelectWithInList();
         testSelectWithJoin();
         testSelectIntoOutfile();
         testSelectIntoOutfileWithFormat();
+        testExplainAnalyze();
         testInsertBasic();
         testUpdateBasic();
         testDeleteBasic();
@@ -71,6 +73,30 @@ private:
         }
     }
 
+    void testSelectWithInList() {
+        startTimer();
+        try {
+            QString sql = "SELECT * FROM users WHERE id IN (1, 2, 3);";
+            Parser parser(sql);
+            auto stmt = parser.parse();
+
+            auto selectStmt = dynamic_cast<SelectStatement*>(stmt.get());
+            assertNotNull(selectStmt, "Statement should be SelectStatement");
+
+            auto inExpr = dynamic_cast<BinaryExpression*>(selectStmt->where.get());
+            assertNotNull(inExpr, "WHERE should be a binary expression");
+            assertTrue(inExpr->op == BinaryOp::IN, "Operator should be IN");
+
+            auto listExpr = dynamic_cast<ListExpression*>(inExpr->right.get());
+            assertNotNull(listExpr, "Right side should be a value list");
+            assertEqual(3, (int)listExpr->elements.size(), "List should have 3 values");
+
+            addResult("testSelectWithInList", true, "IN list parsing works", stopTimer());
+        } catch (const std::exception& e) {
+            addResult("testSelectWithInList", false, QString("Exception: %1").arg(e.what()), stopTimer());
+        }
+    }
+
     void testSelectWithJoin() {
         startTimer();
         try {
@@ -124,6 +150,29 @@ private:
         }
     }
 
+    void testExplainAnalyze() {
+        startTimer();
+        try {
+            Parser plainParser("EXPLAIN SELECT * FROM users WHERE id = 1;");
+            auto plainStmt = plainParser.parse();
+            auto plain = dynamic_cast<ExplainStatement*>(plainStmt.get());
+            assertNotNull(plain, "Statement should be ExplainStatement");
+            assertFalse(plain->analyze, "Plain EXPLAIN should not execute the query");
+
+            Parser analyzeParser("EXPLAIN ANALYZE SELECT * FROM users ORDER BY id LIMIT 5;");
+            auto analyzeStmt = analyzeParser.parse();
+            auto analyze = dynamic_cast<ExplainStatement*>(analyzeStmt.get());
+            assertNotNull(analyze, "Statement should be ExplainStatement");
+            assertTrue(analyze->analyze, "EXPLAIN ANALYZE should set the analyze flag");
+            assertNotNull(analyze->query.get(), "EXPLAIN ANALYZE should wrap a SELECT");
+            assertEqual(5, analyze->query->limit, "LIMIT should be parsed");
+
+            addResult("testExplainAnalyze", true, "EXPLAIN ANALYZE parsing works", stopTimer());
+        } catch (const std::exception& e) {
+            addResult("testExplainAnalyze", false, QString("Exception: %1").arg(e.what()), stopTimer());
+        }
+    }
+
     void testInsertBasic() {
         startTimer();
         try {
@@ -190,6 +239,14 @@ private:
             assertEqual(QString("users"), createStmt->tableName, "Table name should be 'users'");
             assertEqual(2, (int)createStmt->columns.size(), "Should have 2 columns");
 
+            Parser spatialParser("CREATE TABLE places (id INT, geom GEOMETRY NOT NULL, area GEOGRAPHY);");
+            auto spatialStmt = spatialParser.parse();
+            auto spatialTable = dynamic_cast<CreateTableStatement*>(spatialStmt.get());
+            assertNotNull(spatialTable, "Spatial column types should parse");
+            assertTrue(spatialTable->columns[1].type == DataType::GEOMETRY, "GEOMETRY column type");
+            assertTrue(spatialTable->columns[1].notNull, "GEOMETRY NOT NULL");
+            assertTrue(spatialTable->columns[2].type == DataType::GEOGRAPHY, "GEOGRAPHY column type");
+
             addResult("testCreateTable", true, "CREATE TABLE parsing works", stopTimer());
         } catch (const std::exception& e) {
             addResult("testCreateTable", false, QString("Exception: %1").arg(e.what()), stopTimer());
@@ -225,6 +282,60 @@ private:
             assertEqual(QString("idx_name"), createIndexStmt->indexName, "Index name should be 'idx_name'");
             assertEqual(QString("users"), createIndexStmt->tableName, "Table name should be 'users'");
 
+            Parser coveringParser("CREATE INDEX idx_cover ON users(name, age) INCLUDE (email, city) USING BTREE;");
+            auto coveringStmt = coveringParser.parse();
+            auto coveringIndexStmt = dynamic_cast<CreateIndexStatement*>(coveringStmt.get());
+            assertNotNull(coveringIndexStmt, "INCLUDE statement should be CreateIndexStatement");
+            assertEqual(qsizetype(2), coveringIndexStmt->columns.size(), "Two key columns");
+            assertEqual(QStringList({"email", "city"}), coveringIndexStmt->includeColumns, "INCLUDE columns");
+
+            Parser partialParser("CREATE INDEX idx_active_email ON users(lower(email), id) WHERE active = 1;");
+            auto partialStmt = partialParser.parse();
+            auto partialIndexStmt = dynamic_cast<CreateIndexStatement*>(partialStmt.get());
+            assertNotNull(partialIndexStmt, "Partial index statement should be CreateIndexStatement");
+            assertEqual(qsizetype(2), partialIndexStmt->columns.size(), "Two index keys");
+            assertEqual(size_t(2), partialIndexStmt->expressions.size(), "One expression slot per key");
+            assertNotNull(partialIndexStmt->expressions[0].get(), "lower(email) is an expression key");
+            assertTrue(partialIndexStmt->expressions[1] == nullptr, "id is a plain column key");
+            assertNotNull(partialIndexStmt->where.get(), "WHERE predicate should be parsed");
+
+            Parser brinParser("CREATE INDEX idx_ts ON events(ts) USING BRIN WITH (bloom = TRUE);");
+            auto brinStmt = brinParser.parse();
+            auto brinIndexStmt = dynamic_cast<CreateIndexStatement*>(brinStmt.get());
+            assertNotNull(brinIndexStmt, "BRIN statement should be CreateIndexStatement");
+            assertTrue(brinIndexStmt->type == ast::IndexType::BRIN, "USING BRIN sets the index type");
+            assertEqual(QString("true"), brinIndexStmt->options.value("bloom"), "WITH options are parsed");
+
+            Parser bitmapParser("CREATE BITMAP INDEX idx_status ON orders(status);");
+            auto bitmapStmt = bitmapParser.parse();
+            auto bitmapIndexStmt = dynamic_cast<CreateIndexStatement*>(bitmapStmt.get());
+            assertNotNull(bitmapIndexStmt, "CREATE BITMAP INDEX should be CreateIndexStatement");
+            assertTrue(bitmapIndexStmt->type == ast::IndexType::BITMAP, "BITMAP keyword sets the index type");
+            assertEqual(QString("idx_status"), bitmapIndexStmt->indexName, "Bitmap index name");
+
+            Parser conflictParser("CREATE BITMAP INDEX idx_status ON orders(status) USING HASH;");
+            assertTrue(conflictParser.parse() == nullptr, "BITMAP keyword conflicts with USING HASH");
+
+            Parser spatialParser("CREATE SPATIAL INDEX idx_geom ON places(geom);");
+            auto spatialStmt = spatialParser.parse();
+            auto spatialIndexStmt = dynamic_cast<CreateIndexStatement*>(spatialStmt.get());
+            assertNotNull(spatialIndexStmt, "CREATE SPATIAL INDEX should be CreateIndexStatement");
+            assertTrue(spatialIndexStmt->type == ast::IndexType::RTREE, "SPATIAL keyword selects an R-tree");
+            Parser rtreeParser("CREATE INDEX idx_geom ON places(geom) USING RTREE;");
+            auto rtreeStmt = rtreeParser.parse();
+            auto rtreeIndexStmt = dynamic_cast<CreateIndexStatement*>(rtreeStmt.get());
+            assertNotNull(rtreeIndexStmt, "USING RTREE statement should be CreateIndexStatement");
+            assertTrue(rtreeIndexStmt->type == ast::IndexType::RTREE, "USING RTREE sets the index type");
+            Parser spatialConflict("CREATE SPATIAL INDEX idx_geom ON places(geom) USING BTREE;");
+            assertTrue(spatialConflict.parse() == nullptr, "SPATIAL keyword conflicts with USING BTREE");
+
+            Parser trieParser("CREATE INDEX idx_word ON words(word) USING TRIE;");
+            auto trieStmt = trieParser.parse();
+            auto trieIndexStmt = dynamic_cast<CreateIndexStatement*>(trieStmt.get());
+            assertNotNull(trieIndexStmt, "USING TRIE statement should be CreateIndexStatement");
+            assertTrue(trieIndexStmt->type == ast::IndexType::TRIE, "USING TRIE sets the index type");
+            assertTrue(trieIndexStmt->toString().endsWith("USING TRIE"), "TRIE index prints its type");
+
             addResult("testCreateIndex", true, "CREATE INDEX parsing works", stopTimer());
         } catch (const std::exception& e) {
             addResult("testCreateIndex", false, QString("Exception: %1").arg(e.what()), stopTimer());